@@ -0,0 +1,1069 @@
+// bootflashvscp.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+#include <register.h>
+
+#include "bootflashvscp.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include <ctype.h>
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+// Boot loader frames added in later versions of the specification
+#ifndef VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE_ACK
+#define VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE_ACK 48
+#endif
+#ifndef VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE_NACK
+#define VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE_NACK 49
+#endif
+#ifndef VSCP_TYPE_PROTOCOL_START_BLOCK_ACK
+#define VSCP_TYPE_PROTOCOL_START_BLOCK_ACK 50
+#endif
+#ifndef VSCP_TYPE_PROTOCOL_START_BLOCK_NACK
+#define VSCP_TYPE_PROTOCOL_START_BLOCK_NACK 51
+#endif
+#ifndef VSCP_TYPE_PROTOCOL_BLOCK_CHUNK_ACK
+#define VSCP_TYPE_PROTOCOL_BLOCK_CHUNK_ACK 52
+#endif
+#ifndef VSCP_TYPE_PROTOCOL_BLOCK_CHUNK_NACK
+#define VSCP_TYPE_PROTOCOL_BLOCK_CHUNK_NACK 53
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// hexValue
+//
+
+static int
+hexValue(char c)
+{
+  if ((c >= '0') && (c <= '9')) {
+    return c - '0';
+  }
+  if ((c >= 'a') && (c <= 'f')) {
+    return c - 'a' + 10;
+  }
+  if ((c >= 'A') && (c <= 'F')) {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// msSince
+//
+
+static int64_t
+msSince(std::chrono::steady_clock::time_point tp)
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tp).count();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CBootFlashVSCP::CBootFlashVSCP(CVscpClient& client)
+  : m_client(client)
+{
+  m_options.m_nodeid  = 0;
+  m_options.m_timeout = 1000;
+  m_options.m_window  = 1;
+  m_options.m_retries = 3;
+  m_bInterface        = false;
+  m_window            = 1;
+  m_limit             = 1;
+  m_imageCrc          = 0xffff;
+  m_bRunning          = false;
+  m_bCancel           = false;
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CBootFlashVSCP::~CBootFlashVSCP()
+{
+  cancel();
+  wait();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// crcCCITT
+//
+
+uint16_t
+CBootFlashVSCP::crcCCITT(const uint8_t* pdata, size_t len, uint16_t crc)
+{
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)pdata[i] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// loadIntelHexFile
+//
+
+int
+CBootFlashVSCP::loadIntelHexFile(const std::string& path)
+{
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    spdlog::error("Boot flash: Failed to open hex file {0}", path);
+    return VSCP_ERROR_READ_ERROR;
+  }
+
+  m_memory.clear();
+
+  uint32_t base = 0; // Extended segment or linear address
+  int lineno    = 0;
+  std::string line;
+  std::vector<uint8_t> rec;
+  while (std::getline(file, line)) {
+    lineno++;
+    while (line.size() && isspace((unsigned char)line.back())) {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      continue;
+    }
+
+    // ':' followed by length, address, type, data and checksum as hex pairs
+    if ((':' != line[0]) || (line.size() < 11) || !(line.size() & 1)) {
+      spdlog::error("Boot flash: Invalid record on line {0} in {1}", lineno, path);
+      m_memory.clear();
+      return VSCP_ERROR_PARSING;
+    }
+
+    rec.clear();
+    for (size_t i = 1; i < line.size(); i += 2) {
+      int hi = hexValue(line[i]);
+      int lo = hexValue(line[i + 1]);
+      if ((hi < 0) || (lo < 0)) {
+        spdlog::error("Boot flash: Invalid hex digit on line {0} in {1}", lineno, path);
+        m_memory.clear();
+        return VSCP_ERROR_PARSING;
+      }
+      rec.push_back((uint8_t)((hi << 4) + lo));
+    }
+
+    uint8_t sum = 0;
+    for (auto b : rec) {
+      sum += b;
+    }
+    if ((rec.size() != ((size_t)rec[0] + 5)) || sum) {
+      spdlog::error("Boot flash: Invalid length or checksum on line {0} in {1}", lineno, path);
+      m_memory.clear();
+      return VSCP_ERROR_PARSING;
+    }
+
+    uint32_t addr = ((uint32_t)rec[1] << 8) + rec[2];
+    switch (rec[3]) {
+
+      case 0x00: // Data
+        for (uint8_t i = 0; i < rec[0]; i++) {
+          m_memory[base + addr + i] = rec[4 + i];
+        }
+        break;
+
+      case 0x01: // End of file
+        spdlog::debug("Boot flash: Loaded {0} bytes from {1}", m_memory.size(), path);
+        return VSCP_ERROR_SUCCESS;
+
+      case 0x02: // Extended segment address
+        if (2 == rec[0]) {
+          base = (((uint32_t)rec[4] << 8) + rec[5]) << 4;
+        }
+        break;
+
+      case 0x04: // Extended linear address
+        if (2 == rec[0]) {
+          base = (((uint32_t)rec[4] << 8) + rec[5]) << 16;
+        }
+        break;
+
+      default: // Start address records are of no use here
+        break;
+    }
+  }
+
+  spdlog::debug("Boot flash: Loaded {0} bytes from {1} (no end of file record)", m_memory.size(), path);
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getMinMaxForRange
+//
+
+int
+CBootFlashVSCP::getMinMaxForRange(uint32_t start, uint32_t end, uint32_t* pmin, uint32_t* pmax) const
+{
+  if ((nullptr == pmin) || (nullptr == pmax)) {
+    return VSCP_ERROR_PARAMETER;
+  }
+
+  *pmin = 0;
+  *pmax = 0;
+
+  auto itFirst = m_memory.lower_bound(start);
+  auto itLast  = m_memory.upper_bound(end);
+  if ((itFirst == m_memory.end()) || (itFirst == itLast)) {
+    return VSCP_ERROR_SUCCESS;
+  }
+
+  *pmin = itFirst->first;
+  *pmax = std::prev(itLast)->first;
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// addRange
+//
+
+void
+CBootFlashVSCP::addRange(uint32_t start, uint32_t end, uint8_t type)
+{
+  memrange range;
+  range.m_start = start;
+  range.m_end   = end;
+  range.m_type  = type;
+  m_ranges.push_back(range);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+int
+CBootFlashVSCP::start(const options& opt, statuscallback cbStatus, donecallback cbDone)
+{
+  if (m_bRunning) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  // Join a previous update
+  wait();
+
+  if (m_memory.empty() || m_ranges.empty() || !opt.m_timeout) {
+    return VSCP_ERROR_PARAMETER;
+  }
+
+  m_options          = opt;
+  m_options.m_window = std::min(std::max(opt.m_window, (uint16_t)1), MAX_WINDOW);
+  m_window           = m_options.m_window;
+  m_limit            = m_options.m_window;
+
+  // A non zero interface GUID means we talk to the node through an interface
+  m_bInterface = false;
+  for (int i = 0; i < 16; i++) {
+    if (m_options.m_guidInterface.getGUID()[i]) {
+      m_bInterface = true;
+      break;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.m_window = m_options.m_window;
+  }
+
+  m_bCancel  = false;
+  m_bRunning = true;
+  m_thread   = std::thread(&CBootFlashVSCP::worker, this, cbStatus, cbDone);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// wait
+//
+
+void
+CBootFlashVSCP::wait(void)
+{
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getStats
+//
+
+CBootFlashVSCP::flashstats
+CBootFlashVSCP::getStats(void)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// send
+//
+
+int
+CBootFlashVSCP::send(uint8_t type, const uint8_t* pdata, uint8_t size)
+{
+  vscpEventEx ex;
+  memset(&ex, 0, sizeof(ex));
+  ex.head      = VSCP_PRIORITY_NORMAL;
+  ex.timestamp = vscp_makeTimeStamp();
+  vscp_setEventExDateTimeBlockToNow(&ex);
+
+  // Frames to a node on an interface are sent as Level I over Level II
+  // with the interface GUID first in the data.
+  uint8_t pos = 0;
+  if (m_bInterface) {
+    ex.vscp_class = VSCP_CLASS2_LEVEL1_PROTOCOL;
+    memcpy(ex.data, m_options.m_guidInterface.getGUID(), 16);
+    pos = 16;
+  }
+  else {
+    ex.vscp_class = VSCP_CLASS1_PROTOCOL;
+  }
+
+  ex.vscp_type = type;
+  if (size) {
+    memcpy(ex.data + pos, pdata, size);
+  }
+  ex.sizeData = pos + size;
+
+  int rv;
+  if (VSCP_ERROR_SUCCESS != (rv = m_client.send(ex))) {
+    spdlog::error("Boot flash: Failed to send frame type {0} to node {1} rv={2}", type, m_options.m_nodeid, rv);
+  }
+
+  return rv;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// receive
+//
+
+bool
+CBootFlashVSCP::receive(frame& frm)
+{
+  vscpEventEx ex;
+  while (VSCP_ERROR_SUCCESS == m_client.receive(ex)) {
+
+    uint16_t vscp_class  = ex.vscp_class;
+    const uint8_t* pdata = ex.data;
+    uint16_t sizeData    = ex.sizeData;
+
+    // Level I over Level II have the interface GUID first in data
+    if (VSCP_CLASS2_LEVEL1_PROTOCOL == vscp_class) {
+      if (sizeData < 16) {
+        continue;
+      }
+      vscp_class = VSCP_CLASS1_PROTOCOL;
+      pdata += 16;
+      sizeData -= 16;
+    }
+
+    // Responding node is in the LSB of the GUID
+    if ((VSCP_CLASS1_PROTOCOL != vscp_class) || (m_options.m_nodeid != ex.GUID[15])) {
+      continue;
+    }
+
+    frm.m_type = (uint8_t)ex.vscp_type;
+    frm.m_size = (uint8_t)std::min(sizeData, (uint16_t)sizeof(frm.m_data));
+    memcpy(frm.m_data, pdata, frm.m_size);
+    return true;
+  }
+
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// waitResponse
+//
+
+int
+CBootFlashVSCP::waitResponse(uint8_t typeAck, uint8_t typeNack, frame& response, uint32_t timeout)
+{
+  auto start = std::chrono::steady_clock::now();
+  while (!m_bCancel) {
+    frame frm;
+    if (receive(frm)) {
+      if (typeAck == frm.m_type) {
+        response = frm;
+        return VSCP_ERROR_SUCCESS;
+      }
+      if (typeNack == frm.m_type) {
+        response = frm;
+        return VSCP_ERROR_ERROR;
+      }
+      continue;
+    }
+    if (msSince(start) >= (int64_t)timeout) {
+      return VSCP_ERROR_TIMEOUT;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  return VSCP_ERROR_ERROR;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// request
+//
+
+int
+CBootFlashVSCP::request(uint8_t type,
+                        const uint8_t* pdata,
+                        uint8_t size,
+                        uint8_t typeAck,
+                        uint8_t typeNack,
+                        frame& response,
+                        bool bResend)
+{
+  // Requests that must not be repeated get the time all retries would have had
+  unsigned attempts = bResend ? (m_options.m_retries + 1u) : 1u;
+  uint32_t timeout  = bResend ? m_options.m_timeout : m_options.m_timeout * (m_options.m_retries + 1u);
+
+  int rv = VSCP_ERROR_TIMEOUT;
+  for (unsigned i = 0; (i < attempts) && !m_bCancel; i++) {
+    if (i) {
+      spdlog::debug("Boot flash: No response to frame type {0}, resending", type);
+    }
+    if (VSCP_ERROR_SUCCESS != (rv = send(type, pdata, size))) {
+      return rv;
+    }
+    if (VSCP_ERROR_TIMEOUT != (rv = waitResponse(typeAck, typeNack, response, timeout))) {
+      return rv;
+    }
+  }
+
+  return m_bCancel ? VSCP_ERROR_ERROR : rv;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// enterBootMode
+//
+
+int
+CBootFlashVSCP::enterBootMode(uint32_t& blockSize, uint32_t& numBlocks)
+{
+  int rv;
+  cguid guidNode;
+  guidNode.setNicknameID(m_options.m_nodeid);
+
+  // The node only enters boot mode if the request holds part of its
+  // GUID and the content of its page select registers
+  std::map<uint8_t, uint8_t> guidRegs;
+  if (VSCP_ERROR_SUCCESS != (rv = vscp_readLevel1RegisterBlock(m_client,
+                                                               guidNode,
+                                                               m_options.m_guidInterface,
+                                                               0,
+                                                               0xd0,
+                                                               16,
+                                                               guidRegs,
+                                                               nullptr,
+                                                               m_options.m_timeout))) {
+    spdlog::error("Boot flash: Failed to read GUID of node {0} rv={1}", m_options.m_nodeid, rv);
+    return rv;
+  }
+
+  std::map<uint8_t, uint8_t> pageRegs;
+  if (VSCP_ERROR_SUCCESS != (rv = vscp_readLevel1RegisterBlock(m_client,
+                                                               guidNode,
+                                                               m_options.m_guidInterface,
+                                                               0,
+                                                               0x92,
+                                                               2,
+                                                               pageRegs,
+                                                               nullptr,
+                                                               m_options.m_timeout))) {
+    spdlog::error("Boot flash: Failed to read page select registers of node {0} rv={1}", m_options.m_nodeid, rv);
+    return rv;
+  }
+
+  uint8_t data[8];
+  data[0] = m_options.m_nodeid;
+  data[1] = VSCP_BOOTLOADER_VSCP;
+  data[2] = guidRegs[0xd0];
+  data[3] = guidRegs[0xd3];
+  data[4] = guidRegs[0xd5];
+  data[5] = guidRegs[0xd7];
+  data[6] = pageRegs[0x92];
+  data[7] = pageRegs[0x93];
+
+  frame response = {};
+  rv = request(VSCP_TYPE_PROTOCOL_ENTER_BOOT_LOADER,
+               data,
+               sizeof(data),
+               VSCP_TYPE_PROTOCOL_ACK_BOOT_LOADER,
+               VSCP_TYPE_PROTOCOL_NACK_BOOT_LOADER,
+               response);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    spdlog::error("Boot flash: Node {0} did not enter boot mode rv={1} error={2}",
+                  m_options.m_nodeid,
+                  rv,
+                  response.m_size ? response.m_data[0] : 0);
+    return rv;
+  }
+
+  if (response.m_size < 8) {
+    spdlog::error("Boot flash: Invalid boot mode ACK from node {0}", m_options.m_nodeid);
+    return VSCP_ERROR_PARSING;
+  }
+
+  blockSize = ((uint32_t)response.m_data[0] << 24) + ((uint32_t)response.m_data[1] << 16) +
+              ((uint32_t)response.m_data[2] << 8) + response.m_data[3];
+  numBlocks = ((uint32_t)response.m_data[4] << 24) + ((uint32_t)response.m_data[5] << 16) +
+              ((uint32_t)response.m_data[6] << 8) + response.m_data[7];
+  if (!blockSize) {
+    spdlog::error("Boot flash: Node {0} reported a zero block size", m_options.m_nodeid);
+    return VSCP_ERROR_PARSING;
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// buildBlocks
+//
+
+int
+CBootFlashVSCP::buildBlocks(uint32_t blockSize, uint32_t numBlocks, std::deque<block>& blocks)
+{
+  blocks.clear();
+
+  // Only blocks that hold data from the image are sent. Unused bytes
+  // in a block are set to the erased value.
+  for (const auto& range : m_ranges) {
+    bool bFirst = true;
+    for (auto it = m_memory.lower_bound(range.m_start); (it != m_memory.end()) && (it->first <= range.m_end);
+         ++it) {
+      uint32_t offset = it->first - range.m_start;
+      uint32_t number = offset / blockSize;
+      if (bFirst || (blocks.back().m_number != number)) {
+        if ((MEM_TYPE_PROGRAM == range.m_type) && (number >= numBlocks)) {
+          spdlog::error("Boot flash: Address 0x{0:08X} is outside of the {1} blocks of the node",
+                        it->first,
+                        numBlocks);
+          return VSCP_ERROR_PARAMETER;
+        }
+        block blk;
+        blk.m_type   = range.m_type;
+        blk.m_number = number;
+        blk.m_data.assign(blockSize, 0xff);
+        blk.m_crc = 0;
+        blocks.push_back(blk);
+        bFirst = false;
+      }
+      blocks.back().m_data[offset % blockSize] = it->second;
+    }
+  }
+
+  uint64_t total = 0;
+  m_imageCrc     = 0xffff;
+  for (auto& blk : blocks) {
+    blk.m_crc = crcCCITT(blk.m_data.data(), blk.m_data.size());
+    if (MEM_TYPE_PROGRAM == blk.m_type) {
+      m_imageCrc = crcCCITT(blk.m_data.data(), blk.m_data.size(), m_imageCrc);
+    }
+    total += blk.m_data.size();
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.m_blockSize   = blockSize;
+  m_stats.m_totalBlocks = (uint32_t)blocks.size();
+  m_stats.m_totalBytes  = total;
+
+  return blocks.empty() ? VSCP_ERROR_PARAMETER : VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// shrinkWindow
+//
+
+void
+CBootFlashVSCP::shrinkWindow(void)
+{
+  if (m_window <= 1) {
+    return;
+  }
+
+  m_limit = m_window - 1;
+  m_window /= 2;
+  if (1 == m_window) {
+    spdlog::warn("Boot flash: Node {0} keeps losing chunks, using stop-and-wait", m_options.m_nodeid);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.m_window = m_window;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// growWindow
+//
+
+void
+CBootFlashVSCP::growWindow(void)
+{
+  if (m_window >= m_limit) {
+    return;
+  }
+
+  m_window++;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.m_window = m_window;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// settle
+//
+
+void
+CBootFlashVSCP::settle(void)
+{
+  frame frm;
+  auto quiet = std::chrono::steady_clock::now();
+  while (!m_bCancel && (msSince(quiet) < (int64_t)SETTLE_TIME)) {
+    if (receive(frm)) {
+      quiet = std::chrono::steady_clock::now();
+    }
+    else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sendChunks
+//
+
+int
+CBootFlashVSCP::sendChunks(const block& blk, uint32_t& sent, frame& ack, bool& bAck, statuscallback& cbStatus)
+{
+  const uint32_t size  = (uint32_t)blk.m_data.size();
+  const uint32_t count = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  uint32_t next   = 0; // Next chunk to send
+  uint32_t acked  = 0; // Chunks acknowledged by the node
+  uint8_t retries = 0; // Refused chunks in a row (stop-and-wait)
+  auto lastAck    = std::chrono::steady_clock::now();
+  bAck            = false;
+
+  auto chunkSize = [size](uint32_t chunk) {
+    return (uint8_t)std::min((uint32_t)CHUNK_SIZE, size - chunk * CHUNK_SIZE);
+  };
+
+  while (acked < count) {
+
+    if (m_bCancel) {
+      return VSCP_ERROR_ERROR;
+    }
+
+    bool bIdle = true;
+
+    // Fill the window. The timeout for the oldest chunk runs from when
+    // it was sent or from the last ACK.
+    while ((next < count) && ((next - acked) < m_window)) {
+      int rv;
+      if (VSCP_ERROR_SUCCESS !=
+          (rv = send(VSCP_TYPE_PROTOCOL_BLOCK_DATA, blk.m_data.data() + next * CHUNK_SIZE, chunkSize(next)))) {
+        return rv;
+      }
+      if (next == acked) {
+        lastAck = std::chrono::steady_clock::now();
+      }
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.m_chunks++;
+      if (next < sent) {
+        m_stats.m_retransmits++;
+      }
+      next++;
+      sent  = std::max(sent, next);
+      bIdle = false;
+    }
+
+    // Chunks carry no offset, the node acknowledges them in order
+    frame frm;
+    while (receive(frm)) {
+      bIdle = false;
+      switch (frm.m_type) {
+
+        case VSCP_TYPE_PROTOCOL_BLOCK_CHUNK_ACK:
+          if (acked < next) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.m_bytes += chunkSize(acked);
+            acked++;
+            retries = 0;
+            lastAck = std::chrono::steady_clock::now();
+          }
+          break;
+
+        case VSCP_TYPE_PROTOCOL_BLOCK_CHUNK_NACK:
+          // With more than one chunk in flight the chunks after the
+          // refused one may or may not have been taken by the node
+          if (m_window > 1) {
+            spdlog::debug("Boot flash: Chunk {0} of block {1} refused, starting block over", acked, blk.m_number);
+            return VSCP_ERROR_TIMEOUT;
+          }
+          // Stop-and-wait. The node still waits for the refused chunk.
+          if (retries++ >= m_options.m_retries) {
+            spdlog::error("Boot flash: Giving up on chunk {0} of block {1}", acked, blk.m_number);
+            return VSCP_ERROR_ERROR;
+          }
+          spdlog::debug("Boot flash: Chunk {0} of block {1} refused, resending", acked, blk.m_number);
+          next = acked;
+          break;
+
+        case VSCP_TYPE_PROTOCOL_BLOCK_DATA_ACK:
+          // The node has the whole block even if the last chunk ACKs
+          // have not been seen
+          if (next == count) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (; acked < count; acked++) {
+              m_stats.m_bytes += chunkSize(acked);
+            }
+            ack  = frm;
+            bAck = true;
+          }
+          break;
+
+        case VSCP_TYPE_PROTOCOL_BLOCK_DATA_NACK:
+          spdlog::warn("Boot flash: Block {0} refused by node error={1}",
+                       blk.m_number,
+                       frm.m_size ? frm.m_data[0] : 0);
+          return VSCP_ERROR_ERROR;
+
+        default:
+          break;
+      }
+
+      // A refused chunk is sent again before anything else is read
+      if (next == acked) {
+        break;
+      }
+    }
+
+    if (acked >= count) {
+      break;
+    }
+
+    // A chunk that is not acknowledged may still have reached the node
+    if ((acked < next) && (msSince(lastAck) >= (int64_t)m_options.m_timeout)) {
+      spdlog::debug("Boot flash: Timeout for chunk {0} of block {1}, starting block over", acked, blk.m_number);
+      return VSCP_ERROR_TIMEOUT;
+    }
+
+    report(cbStatus);
+
+    if (bIdle) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sendBlock
+//
+
+int
+CBootFlashVSCP::sendBlock(const block& blk, statuscallback& cbStatus)
+{
+  int rv = VSCP_ERROR_ERROR;
+
+  uint64_t bytes;
+  uint32_t retransmits;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bytes       = m_stats.m_bytes;
+    retransmits = m_stats.m_retransmits;
+  }
+
+  uint32_t sent     = 0;     // Chunks of the block sent at least once
+  unsigned failures = 0;     // Attempts that count against the retries
+  bool bRestart     = false; // Block is started over
+
+  while ((failures <= m_options.m_retries) && !m_bCancel) {
+
+    if (bRestart) {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_blockRetries++;
+        m_stats.m_bytes = bytes;
+      }
+
+      // ACKs for chunks that were in flight would be taken for ACKs of
+      // the chunks sent again. Drop them before starting over.
+      settle();
+    }
+    bRestart = true;
+
+    // Block number, memory type and memory bank
+    uint8_t data[6];
+    data[0] = (blk.m_number >> 24) & 0xff;
+    data[1] = (blk.m_number >> 16) & 0xff;
+    data[2] = (blk.m_number >> 8) & 0xff;
+    data[3] = blk.m_number & 0xff;
+    data[4] = blk.m_type;
+    data[5] = 0;
+
+    frame response = {};
+    if (VSCP_ERROR_SUCCESS != (rv = request(VSCP_TYPE_PROTOCOL_START_BLOCK,
+                                            data,
+                                            sizeof(data),
+                                            VSCP_TYPE_PROTOCOL_START_BLOCK_ACK,
+                                            VSCP_TYPE_PROTOCOL_START_BLOCK_NACK,
+                                            response))) {
+      spdlog::error("Boot flash: Start of block {0} failed rv={1}", blk.m_number, rv);
+      return rv;
+    }
+
+    frame ack = {};
+    bool bAck = false;
+    rv        = sendChunks(blk, sent, ack, bAck, cbStatus);
+
+    // A lost chunk with more than one chunk in flight only costs a
+    // smaller window
+    if ((VSCP_ERROR_TIMEOUT == rv) && (m_window > 1)) {
+      shrinkWindow();
+      continue;
+    }
+
+    if ((VSCP_ERROR_SUCCESS == rv) && !bAck) {
+      rv = waitResponse(VSCP_TYPE_PROTOCOL_BLOCK_DATA_ACK,
+                        VSCP_TYPE_PROTOCOL_BLOCK_DATA_NACK,
+                        ack,
+                        m_options.m_timeout);
+    }
+
+    // The CRC was calculated when the blocks were built so the check
+    // costs nothing here
+    if ((VSCP_ERROR_SUCCESS == rv) && (ack.m_size >= 2)) {
+      uint16_t crc = ((uint16_t)ack.m_data[0] << 8) + ack.m_data[1];
+      if (crc == blk.m_crc) {
+        if (retransmits == getStats().m_retransmits) {
+          growWindow();
+        }
+        return VSCP_ERROR_SUCCESS;
+      }
+      spdlog::warn("Boot flash: CRC error for block {0}, node 0x{1:04X} expected 0x{2:04X}",
+                   blk.m_number,
+                   crc,
+                   blk.m_crc);
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.m_crcErrors++;
+      rv = VSCP_ERROR_ERROR;
+    }
+    else if (VSCP_ERROR_SUCCESS == rv) {
+      spdlog::warn("Boot flash: Invalid block data ACK for block {0}", blk.m_number);
+      rv = VSCP_ERROR_PARSING;
+    }
+
+    failures++;
+    shrinkWindow();
+  }
+
+  if (!m_bCancel) {
+    spdlog::error("Boot flash: Failed to send block {0} rv={1}", blk.m_number, rv);
+  }
+  return m_bCancel ? VSCP_ERROR_ERROR : rv;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// report
+//
+
+void
+CBootFlashVSCP::report(statuscallback& cbStatus, bool bForce)
+{
+  if (!bForce && (msSince(m_lastReport) < (int64_t)REPORT_INTERVAL)) {
+    return;
+  }
+  m_lastReport = std::chrono::steady_clock::now();
+
+  flashstats stats;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.m_elapsed = (uint32_t)msSince(m_start);
+    if (m_stats.m_elapsed) {
+      m_stats.m_rate = (uint32_t)((m_stats.m_bytes * 1000) / m_stats.m_elapsed);
+    }
+    stats = m_stats;
+  }
+
+  if (nullptr == cbStatus) {
+    return;
+  }
+
+  int progress    = stats.m_totalBytes ? (int)((stats.m_bytes * 100) / stats.m_totalBytes) : 0;
+  std::string str = vscp_str_format("Block %u of %u programmed, %.1f kB/s, %u chunk(s) resent, "
+                                    "%u block(s) resent, window %u",
+                                    stats.m_blocks,
+                                    stats.m_totalBlocks,
+                                    stats.m_rate / 1024.0,
+                                    stats.m_retransmits,
+                                    stats.m_blockRetries,
+                                    (unsigned)stats.m_window);
+  cbStatus(std::min(progress, 99), str.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// worker
+//
+
+void
+CBootFlashVSCP::worker(statuscallback cbStatus, donecallback cbDone)
+{
+  spdlog::debug("Boot flash: Updating node {0} window={1}", m_options.m_nodeid, m_options.m_window);
+
+  // Discard anything old in the receive queue
+  vscpEventEx ex;
+  while (VSCP_ERROR_SUCCESS == m_client.receive(ex)) {
+    ;
+  }
+
+  if (nullptr != cbStatus) {
+    cbStatus(0, "Set node in boot mode.");
+  }
+
+  uint32_t blockSize = 0;
+  uint32_t numBlocks = 0;
+  std::deque<block> blocks;
+  int rv = enterBootMode(blockSize, numBlocks);
+  if (VSCP_ERROR_SUCCESS == rv) {
+    rv = buildBlocks(blockSize, numBlocks, blocks);
+  }
+
+  if ((VSCP_ERROR_SUCCESS == rv) && (nullptr != cbStatus)) {
+    std::string str = vscp_str_format("Node in boot mode, block size %u, %u block(s) to program.",
+                                      blockSize,
+                                      (unsigned)blocks.size());
+    cbStatus(0, str.c_str());
+  }
+
+  m_start      = std::chrono::steady_clock::now();
+  m_lastReport = m_start;
+
+  for (const auto& blk : blocks) {
+    if (VSCP_ERROR_SUCCESS != rv) {
+      break;
+    }
+    if (m_bCancel) {
+      rv = VSCP_ERROR_ERROR;
+      break;
+    }
+
+    if (VSCP_ERROR_SUCCESS != (rv = sendBlock(blk, cbStatus))) {
+      break;
+    }
+
+    // Programming is not repeated, it gets the time all retries would have had
+    uint8_t data[4];
+    data[0] = (blk.m_number >> 24) & 0xff;
+    data[1] = (blk.m_number >> 16) & 0xff;
+    data[2] = (blk.m_number >> 8) & 0xff;
+    data[3] = blk.m_number & 0xff;
+
+    frame response = {};
+    if (VSCP_ERROR_SUCCESS != (rv = request(VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA,
+                                            data,
+                                            sizeof(data),
+                                            VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA_ACK,
+                                            VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA_NACK,
+                                            response,
+                                            false))) {
+      spdlog::error("Boot flash: Failed to program block {0} rv={1} error={2}",
+                    blk.m_number,
+                    rv,
+                    response.m_size ? response.m_data[0] : 0);
+      break;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.m_blocks++;
+    }
+    report(cbStatus);
+  }
+
+  if ((VSCP_ERROR_SUCCESS == rv) && !m_bCancel) {
+    uint8_t data[2];
+    data[0] = (m_imageCrc >> 8) & 0xff;
+    data[1] = m_imageCrc & 0xff;
+
+    frame response = {};
+    rv = request(VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE,
+                 data,
+                 sizeof(data),
+                 VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE_ACK,
+                 VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE_NACK,
+                 response,
+                 false);
+    if (VSCP_ERROR_TIMEOUT == rv) {
+      // The node may have started the new image without confirming it
+      // but that can not be told from a node that is stuck
+      spdlog::error("Boot flash: Activation of new image not confirmed by node {0}", m_options.m_nodeid);
+    }
+    else if (VSCP_ERROR_SUCCESS != rv) {
+      spdlog::error("Boot flash: Node {0} refused new image crc=0x{1:04X}", m_options.m_nodeid, m_imageCrc);
+    }
+  }
+
+  report(cbStatus, true);
+
+  flashstats stats = getStats();
+  spdlog::debug("Boot flash: Done rv={0} in {1} ms, {2} bytes, {3} B/s, {4} chunks, {5} resent, {6} CRC errors",
+                rv,
+                stats.m_elapsed,
+                stats.m_bytes,
+                stats.m_rate,
+                stats.m_chunks,
+                stats.m_retransmits,
+                stats.m_crcErrors);
+
+  m_bRunning = false;
+  if (nullptr != cbDone) {
+    cbDone(rv, stats);
+  }
+}
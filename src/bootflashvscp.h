@@ -0,0 +1,359 @@
+// bootflashvscp.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef BOOTFLASHVSCP_H
+#define BOOTFLASHVSCP_H
+
+#include <guid.h>
+#include <vscp-client-base.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*!
+  Firmware update of a node with the VSCP boot loader algorithm.
+
+  The node is set in boot mode and the image is sent block by block.
+  Block data is sent in chunks of eight bytes and the node acknowledges
+  each chunk. Up to "window" chunks are kept in flight so the transfer
+  is not limited by the round trip time of a gateway. Block CRCs are
+  calculated before the transfer starts and are checked against the CRC
+  the node reports when a block is complete. Only a block that fails
+  the check is sent again.
+
+  Chunks carry no offset. After a loss with more than one chunk in
+  flight it is not known how far the node got, so the window is halved
+  and the whole block is started over with a new start block request.
+  These restarts do not count as retries as the window bounds them. A
+  window of the size that lost a chunk is not used again. For every
+  block that is sent without losses the window grows by one chunk up to
+  that limit. A node that can not cope with chunks sent back to back
+  thus ends up with one chunk at the time (stop-and-wait). A window of
+  one gives the classic stop-and-wait transfer from the start. Only then
+  is a refused chunk sent again in place. A chunk that is not
+  acknowledged in time may still have reached the node so that also
+  starts the block over.
+
+  The update runs on its own thread. Callbacks are called from that
+  thread.
+*/
+
+class CBootFlashVSCP {
+
+public:
+  /// Number of block data bytes in a chunk
+  static const uint8_t CHUNK_SIZE = 8;
+
+  /// Largest number of chunks in flight
+  static constexpr uint16_t MAX_WINDOW = 64;
+
+  /// Least time in milliseconds between two progress reports
+  static constexpr uint32_t REPORT_INTERVAL = 500;
+
+  /// Quiet time in milliseconds before a block is started over after a loss
+  static constexpr uint32_t SETTLE_TIME = 50;
+
+  /// Memory types for start block
+  enum { MEM_TYPE_PROGRAM = 0, MEM_TYPE_DATA, MEM_TYPE_CONFIG, MEM_TYPE_RAM };
+
+  /*!
+    Flash options
+  */
+  struct options {
+    uint8_t m_nodeid;        // Node to update
+    cguid m_guidInterface;   // Interface the node is on or all zero
+    uint32_t m_timeout;      // Response timeout in milliseconds
+    uint16_t m_window;       // Most chunks in flight, one for stop-and-wait
+    uint8_t m_retries;       // Resends of a request or block before giving up
+  };
+
+  /*!
+    Flash statistics
+  */
+  struct flashstats {
+    uint32_t m_blockSize;    // Block size reported by the node
+    uint32_t m_blocks;       // Blocks programmed
+    uint32_t m_totalBlocks;  // Blocks to program
+    uint64_t m_bytes;        // Block bytes acknowledged by the node
+    uint64_t m_totalBytes;   // Block bytes to send
+    uint32_t m_chunks;       // Chunk frames sent
+    uint32_t m_retransmits;  // Chunk frames sent again
+    uint32_t m_crcErrors;    // Blocks with a CRC that did not match
+    uint32_t m_blockRetries; // Blocks sent again
+    uint16_t m_window;       // Window in use
+    uint32_t m_rate;         // Transfer rate in bytes per second
+    uint32_t m_elapsed;      // Transfer time in ms
+  };
+
+  /// Progress callback (percent or -1, message)
+  typedef std::function<void(int, const char*)> statuscallback;
+
+  /// Called when the update ends (result, statistics), also when cancelled
+  typedef std::function<void(int, const flashstats&)> donecallback;
+
+  /*!
+    @param client Connected client. Must not be used by anyone else
+                  while the update is running.
+  */
+  CBootFlashVSCP(CVscpClient& client);
+  ~CBootFlashVSCP();
+
+  /*!
+    Load an Intel HEX file into the memory image
+    @param path Path to file
+    @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_READ_ERROR if the
+            file can not be read and VSCP_ERROR_PARSING if it is invalid.
+  */
+  int loadIntelHexFile(const std::string& path);
+
+  /*!
+    Get the lowest and highest address with data in a memory range
+    @param start First address of range
+    @param end Last address of range
+    @param pmin Set to lowest address or zero if there is no data
+    @param pmax Set to highest address or zero if there is no data
+    @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_PARAMETER if a
+            pointer is null.
+  */
+  int getMinMaxForRange(uint32_t start, uint32_t end, uint32_t* pmin, uint32_t* pmax) const;
+
+  /*!
+    Add a memory range to program. Blocks are numbered from the start
+    of the range they are in.
+    @param start First address of range
+    @param end Last address of range
+    @param type Memory type (MEM_TYPE_*)
+  */
+  void addRange(uint32_t start, uint32_t end, uint8_t type);
+
+  /*!
+    Start the update on a worker thread
+    @param opt Flash options
+    @param cbStatus Called with progress
+    @param cbDone Called when the update ends
+    @return VSCP_ERROR_SUCCESS if started, VSCP_ERROR_PARAMETER if there
+            is nothing to program, VSCP_ERROR_ERROR if an update is running.
+  */
+  int start(const options& opt, statuscallback cbStatus, donecallback cbDone = nullptr);
+
+  /*!
+    Cancel a running update. The done callback is still called.
+  */
+  void cancel(void) { m_bCancel = true; };
+
+  /*!
+    Wait for the update to end
+  */
+  void wait(void);
+
+  /*!
+    Check if an update is running
+    @return True if running
+  */
+  bool isRunning(void) const { return m_bRunning; };
+
+  /*!
+    Get statistics for the running or last update
+    @return Statistics
+  */
+  flashstats getStats(void);
+
+  /*!
+    Calculate CRC-CCITT (polynomial 0x1021) the way the boot loader does
+    @param pdata Data to calculate CRC for
+    @param len Number of bytes
+    @param crc Start value, or the CRC so far to continue a calculation
+    @return CRC
+  */
+  static uint16_t crcCCITT(const uint8_t* pdata, size_t len, uint16_t crc = 0xffff);
+
+private:
+  /// A memory range to program
+  struct memrange {
+    uint32_t m_start;
+    uint32_t m_end;
+    uint8_t m_type;
+  };
+
+  /// A block to program
+  struct block {
+    uint8_t m_type;
+    uint32_t m_number;
+    std::vector<uint8_t> m_data;
+    uint16_t m_crc;
+  };
+
+  /// A Level I protocol frame from the node
+  struct frame {
+    uint8_t m_type;
+    uint8_t m_size;
+    uint8_t m_data[8];
+  };
+
+  /// Update sequence
+  void worker(statuscallback cbStatus, donecallback cbDone);
+
+  /*!
+    Set the node in boot mode
+    @param blockSize Set to block size reported by the node
+    @param numBlocks Set to number of blocks reported by the node
+    @return VSCP_ERROR_SUCCESS if the node is in boot mode
+  */
+  int enterBootMode(uint32_t& blockSize, uint32_t& numBlocks);
+
+  /*!
+    Split the memory image in blocks
+    @param blockSize Block size
+    @param numBlocks Number of program blocks in the node
+    @param blocks Filled with blocks that hold data
+    @return VSCP_ERROR_SUCCESS, VSCP_ERROR_PARAMETER if the image does not
+            fit the node.
+  */
+  int buildBlocks(uint32_t blockSize, uint32_t numBlocks, std::deque<block>& blocks);
+
+  /*!
+    Send a block and check its CRC. The block is sent again if it fails.
+    @param blk Block to send
+    @param cbStatus Progress callback
+    @return VSCP_ERROR_SUCCESS if the node holds the block
+  */
+  int sendBlock(const block& blk, statuscallback& cbStatus);
+
+  /*!
+    Send the chunks of a block with a window of chunks in flight
+    @param blk Block to send
+    @param sent Chunks of the block sent before, updated. Chunks below
+                it are counted as sent again.
+    @param ack Set to the block data ACK if it arrives with the chunk ACKs
+    @param bAck Set to true if ack is set
+    @param cbStatus Progress callback
+    @return VSCP_ERROR_SUCCESS if all chunks were acknowledged,
+            VSCP_ERROR_TIMEOUT if a chunk was lost and the block must be
+            started over, other error code on failure.
+  */
+  int sendChunks(const block& blk, uint32_t& sent, frame& ack, bool& bAck, statuscallback& cbStatus);
+
+  /*!
+    Send a request and wait for its response. The request is sent
+    again when no response is received in time.
+    @param type Request type
+    @param pdata Request data
+    @param size Request data size
+    @param typeAck Response type for success
+    @param typeNack Response type for failure
+    @param response Set to the response
+    @param bResend Send the request again on timeout
+    @return VSCP_ERROR_SUCCESS on ACK, VSCP_ERROR_ERROR on NACK and
+            VSCP_ERROR_TIMEOUT if there is no response.
+  */
+  int request(uint8_t type,
+              const uint8_t* pdata,
+              uint8_t size,
+              uint8_t typeAck,
+              uint8_t typeNack,
+              frame& response,
+              bool bResend = true);
+
+  /*!
+    Wait for a response from the node. Other frames are dropped.
+    @param typeAck Response type for success
+    @param typeNack Response type for failure
+    @param response Set to the response
+    @param timeout Time to wait in milliseconds
+    @return VSCP_ERROR_SUCCESS on ACK, VSCP_ERROR_ERROR on NACK or cancel
+            and VSCP_ERROR_TIMEOUT if there is no response.
+  */
+  int waitResponse(uint8_t typeAck, uint8_t typeNack, frame& response, uint32_t timeout);
+
+  /*!
+    Send a Level I protocol frame to the node
+    @param type Frame type
+    @param pdata Data
+    @param size Data size (0-8)
+    @return VSCP_ERROR_SUCCESS if sent
+  */
+  int send(uint8_t type, const uint8_t* pdata, uint8_t size);
+
+  /*!
+    Get the next protocol frame from the node without waiting
+    @param frm Set to received frame
+    @return True if a frame was received
+  */
+  bool receive(frame& frm);
+
+  /// Drop frames until the node has been quiet for SETTLE_TIME
+  void settle(void);
+
+  /// Halve the window after a loss
+  void shrinkWindow(void);
+
+  /// Grow the window by one chunk after a block without losses
+  void growWindow(void);
+
+  /// Report progress if the report interval has passed or bForce is set
+  void report(statuscallback& cbStatus, bool bForce = false);
+
+  CVscpClient& m_client;
+  options m_options;
+  bool m_bInterface;
+
+  /// Chunks in flight in use
+  uint16_t m_window;
+
+  /// Largest window not known to lose chunks
+  uint16_t m_limit;
+
+  /// Memory image from the hex file (address, value)
+  std::map<uint32_t, uint8_t> m_memory;
+
+  /// Ranges to program
+  std::deque<memrange> m_ranges;
+
+  /// CRC for all program memory blocks
+  uint16_t m_imageCrc;
+
+  std::chrono::steady_clock::time_point m_start;
+  std::chrono::steady_clock::time_point m_lastReport;
+
+  std::thread m_thread;
+  std::atomic<bool> m_bRunning;
+  std::atomic<bool> m_bCancel;
+
+  std::mutex m_mutex;
+  flashstats m_stats;
+};
+
+#endif // BOOTFLASHVSCP_H
@@ -131,11 +131,44 @@ CWizardPageNickname::initializePage(void)
   // pNodeIdSpinBox->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
   // pNodeIdSpinBox->setMaximumWidth(100);
 
+  // Show what is known about the node from earlier scans without
+  // asking the node
+  QLabel* pKnownNode = new QLabel();
+  pKnownNode->setWordWrap(true);
+  auto showKnownNode = [this, pKnownNode](const QString& str) {
+    vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+    const json& conn  = ((CBootLoadWizard*)wizard())->getConnObject();
+
+    std::string interface = "00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00";
+    if (conn.contains("selected-interface") && conn["selected-interface"].is_string()) {
+      interface = conn["selected-interface"].get<std::string>();
+    }
+
+    CNodeInventory::noderecord record;
+    if (!conn.contains("uuid") || !conn["uuid"].is_string() ||
+        !pworks->m_nodeInventory.lookup(conn["uuid"].get<std::string>(),
+                                        cguid(interface).getAsString(),
+                                        vscp_readStringValue(str.toStdString()),
+                                        record)) {
+      pKnownNode->clear();
+      return;
+    }
+
+    pKnownNode->setText(tr("Known node: %1\nGUID: %2\nFirmware: %3\nLast seen: %4")
+                          .arg(QString::fromStdString(record.m_name))
+                          .arg(QString::fromStdString(record.m_guid))
+                          .arg(QString::fromStdString(record.m_firmware))
+                          .arg(QString::fromStdString(record.m_lastSeen)));
+  };
+  connect(pNodeId, &QLineEdit::textChanged, this, showKnownNode);
+  showKnownNode(pNodeId->text());
+
   QVBoxLayout* layout = new QVBoxLayout;
   layout->addWidget(label);
   QFormLayout* layoutForm = new QFormLayout;
   layoutForm->addRow("", pSetInBootMode);
   layoutForm->addRow(tr("node id: "), pNodeId);
+  layoutForm->addRow("", pKnownNode);
   layout->addLayout(layoutForm);
   layout->addWidget(pSetInBootMode);
   setLayout(layout);
@@ -1096,6 +1129,9 @@ CWizardPageFlash::CWizardPageFlash(QWidget* parent, CVscpClient* vscpClient)
 {
   vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
   m_vscpClient      = vscpClient;
+  m_flasher         = nullptr;
+  m_spinWindow      = nullptr;
+  m_btnFlash        = nullptr;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1104,7 +1140,8 @@ CWizardPageFlash::CWizardPageFlash(QWidget* parent, CVscpClient* vscpClient)
 
 CWizardPageFlash::~CWizardPageFlash(void)
 {
-  ;
+  // Stops a running update
+  delete m_flasher;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1126,18 +1163,30 @@ CWizardPageFlash::initializePage(void)
   m_infomsg->setReadOnly(true);
   m_infomsg->setStyleSheet("background-color:rgb(252, 250, 210);");
 
-  QPushButton* btnFlash = new QPushButton(tr("Flash device"));
-  btnFlash->setMaximumWidth(200);
+  m_spinWindow = new QSpinBox();
+  m_spinWindow->setRange(1, CBootFlashVSCP::MAX_WINDOW);
+  m_spinWindow->setValue(8);
+  m_spinWindow->setMaximumWidth(100);
+  m_spinWindow->setToolTip(tr("Number of block data frames sent before the node must acknowledge "
+                              "them (VSCP algorithm). Use 1 (stop-and-wait) for nodes that can not "
+                              "keep up. The window is made smaller automatically if frames are lost."));
+
+  QFormLayout* formLayout = new QFormLayout;
+  formLayout->addRow(tr("Chunks in flight:"), m_spinWindow);
+
+  m_btnFlash = new QPushButton(tr("Flash device"));
+  m_btnFlash->setMaximumWidth(200);
 
   QVBoxLayout* layout = new QVBoxLayout;
   layout->addWidget(label);
   layout->addWidget(m_progress);
   layout->addWidget(m_infomsg);
-  layout->addWidget(btnFlash);
+  layout->addLayout(formLayout);
+  layout->addWidget(m_btnFlash);
 
   setLayout(layout);
 
-  connect(btnFlash, &QPushButton::clicked, this, &CWizardPageFlash::flashDevice);
+  connect(m_btnFlash, &QPushButton::clicked, this, &CWizardPageFlash::flashDevice);
   // m_bootDev = new CBootDevice(m_vscpClient,vscp_readStringValue(field("boot.nickname").toString().toStdString()));
 }
 
@@ -1191,19 +1240,25 @@ CWizardPageFlash::flashDeviceVSCP(void)
 
   addStatusMessage("VSCP Bootloader.");
   guid.setNicknameID(vscp_readStringValue(field("boot.nickname").toString().toStdString()));
-  using namespace std::placeholders;
-
-  // auto callback = std::bind(&CWizardPageLoadMdf::statusCallback, this, _1, _2);
-  // lambda version for reference
-  auto callback = [this](auto a, auto b) { this->statusCallback(a, b); };
 
-  CBootDevice_VSCP boot(m_vscpClient, vscp_readStringValue(field("boot.nickname").toString().toStdString()), callback);
+  // The hex file is loaded once, by the flasher that will send it. The
+  // memory ranges below are read from its image.
+  delete m_flasher;
+  m_flasher = new CBootFlashVSCP(*m_vscpClient);
 
   addStatusMessage("Downloaded Hex file path: " + field("boot.firmware.path").toString());
-  boot.loadIntelHexFile(field("boot.firmware.path").toString().toStdString());
+  if (VSCP_ERROR_SUCCESS != (rv = m_flasher->loadIntelHexFile(field("boot.firmware.path").toString().toStdString()))) {
+    spdlog::error("Failed to load firmware file rv={}", rv);
+    addStatusMessage(QString("Failed to load firmware file: rv = %1.").arg(rv));
+    QMessageBox::critical(this,
+                          tr(APPNAME),
+                          tr("Failed to load firmware file"),
+                          QMessageBox::Ok);
+    return;
+  }
 
   uint32_t min, max;
-  rv = boot.getMinMaxForRange(CBootDevice_VSCP::MEM_CODE_START, CBootDevice_VSCP::MEM_CODE_END, &min, &max);
+  rv = m_flasher->getMinMaxForRange(CBootDevice_VSCP::MEM_CODE_START, CBootDevice_VSCP::MEM_CODE_END, &min, &max);
   if (VSCP_ERROR_SUCCESS == rv) {
     spdlog::info("Flash code range: {0:X}. {1:X}", min, max);
     if (min || max) {
@@ -1217,7 +1272,7 @@ CWizardPageFlash::flashDeviceVSCP(void)
     spdlog::error("getMinMaxForRange: failed rv={0}", rv);
   }
 
-  rv = boot.getMinMaxForRange(CBootDevice_VSCP::MEM_RAM_START, CBootDevice_VSCP::MEM_RAM_END, &min, &max);
+  rv = m_flasher->getMinMaxForRange(CBootDevice_VSCP::MEM_RAM_START, CBootDevice_VSCP::MEM_RAM_END, &min, &max);
   if (VSCP_ERROR_SUCCESS == rv) {
     spdlog::info("Ram code range: {0:X}. {1:X}", min, max);
     if (min || max) {
@@ -1231,7 +1286,7 @@ CWizardPageFlash::flashDeviceVSCP(void)
     spdlog::error("getMinMaxForRange: failed rv={0}", rv);
   }
 
-  rv = boot.getMinMaxForRange(CBootDevice_VSCP::MEM_USERID_START, CBootDevice_VSCP::MEM_USERID_END, &min, &max);
+  rv = m_flasher->getMinMaxForRange(CBootDevice_VSCP::MEM_USERID_START, CBootDevice_VSCP::MEM_USERID_END, &min, &max);
   if (VSCP_ERROR_SUCCESS == rv) {
     spdlog::info("User id: {0:X}. {1:X}", min, max);
     if (min || max) {
@@ -1245,7 +1300,7 @@ CWizardPageFlash::flashDeviceVSCP(void)
     spdlog::error("getMinMaxForRange: failed rv={0}", rv);
   }
 
-  rv = boot.getMinMaxForRange(CBootDevice_VSCP::MEM_CONFIG_START, CBootDevice_VSCP::MEM_CONFIG_END, &min, &max);
+  rv = m_flasher->getMinMaxForRange(CBootDevice_VSCP::MEM_CONFIG_START, CBootDevice_VSCP::MEM_CONFIG_END, &min, &max);
   if (VSCP_ERROR_SUCCESS == rv) {
     spdlog::info("Config: {0:X}. {1:X}", min, max);
     if (min || max) {
@@ -1259,7 +1314,7 @@ CWizardPageFlash::flashDeviceVSCP(void)
     spdlog::error("getMinMaxForRange: failed rv={0}", rv);
   }
 
-  rv = boot.getMinMaxForRange(CBootDevice_VSCP::MEM_EEPROM_START, CBootDevice_VSCP::MEM_EEPROM_END, &min, &max);
+  rv = m_flasher->getMinMaxForRange(CBootDevice_VSCP::MEM_EEPROM_START, CBootDevice_VSCP::MEM_EEPROM_END, &min, &max);
   if (VSCP_ERROR_SUCCESS == rv) {
     spdlog::info("EEPROM: {0:X}. {1:X}", min, max);
     if (min || max) {
@@ -1273,7 +1328,7 @@ CWizardPageFlash::flashDeviceVSCP(void)
     spdlog::error("getMinMaxForRange: failed rv={0}", rv);
   }
 
-  rv = boot.getMinMaxForRange(CBootDevice_VSCP::MEM_USER0_START, CBootDevice_VSCP::MEM_USER0_END, &min, &max);
+  rv = m_flasher->getMinMaxForRange(CBootDevice_VSCP::MEM_USER0_START, CBootDevice_VSCP::MEM_USER0_END, &min, &max);
   if (VSCP_ERROR_SUCCESS == rv) {
     spdlog::info("User 0: {0:X}. {1:X}", min, max);
     if (min || max) {
@@ -1287,7 +1342,7 @@ CWizardPageFlash::flashDeviceVSCP(void)
     spdlog::error("getMinMaxForRange: failed rv={0}", rv);
   }
 
-  rv = boot.getMinMaxForRange(CBootDevice_VSCP::MEM_USER1_START, CBootDevice_VSCP::MEM_USER1_END, &min, &max);
+  rv = m_flasher->getMinMaxForRange(CBootDevice_VSCP::MEM_USER1_START, CBootDevice_VSCP::MEM_USER1_END, &min, &max);
   if (VSCP_ERROR_SUCCESS == rv) {
     spdlog::info("User 1: {0:X}. {1:X}", min, max);
     if (min || max) {
@@ -1301,7 +1356,7 @@ CWizardPageFlash::flashDeviceVSCP(void)
     spdlog::error("getMinMaxForRange: failed rv={0}", rv);
   }
 
-  rv = boot.getMinMaxForRange(CBootDevice_VSCP::MEM_USER2_START, CBootDevice_VSCP::MEM_USER2_END, &min, &max);
+  rv = m_flasher->getMinMaxForRange(CBootDevice_VSCP::MEM_USER2_START, CBootDevice_VSCP::MEM_USER2_END, &min, &max);
   if (VSCP_ERROR_SUCCESS == rv) {
     spdlog::info("User 2: {0:X}. {1:X}", min, max);
     if (min || max) {
@@ -1315,26 +1370,90 @@ CWizardPageFlash::flashDeviceVSCP(void)
     spdlog::error("getMinMaxForRange: failed rv={0}", rv);
   }
 
-  spdlog::info("Init remote device");
-  addStatusMessage("Init remote device.");
-  QApplication::setOverrideCursor(Qt::WaitCursor);
-  cguid our_guid;
-  if (VSCP_ERROR_SUCCESS != (rv = boot.deviceInit(our_guid, 0, pworks->m_firmware_devicecode_required))) {
-    QApplication::restoreOverrideCursor();
-    spdlog::error("Failed to set device into boot mode rv={}", rv);
-    addStatusMessage(QString("Failed to init remote device: rv = {%0}.").arg(rv));
+  // The firmware must be built for the device when the settings ask for it
+  if (pworks->m_firmware_devicecode_required &&
+      (field("boot.firmware.code").toInt() != field("boot.firmware.targetcode").toInt())) {
+    spdlog::error("Firmware device code {0} does not match device {1}",
+                  field("boot.firmware.targetcode").toInt(),
+                  field("boot.firmware.code").toInt());
+    addStatusMessage(QString("Firmware is not built for this device."));
     QMessageBox::critical(this,
                           tr(APPNAME),
-                          tr("Failed to set the device in boot mode"),
+                          tr("The firmware device code does not match the device"),
                           QMessageBox::Ok);
     return;
   }
-  addStatusMessage("Remote device initiated and in bootmode.");
 
-  spdlog::info("Load firmware to remote device");
-  addStatusMessage("Load firmware to remote device.");
-  if (VSCP_ERROR_SUCCESS != (rv = boot.deviceLoad())) {
-    QApplication::restoreOverrideCursor();
+  // Blocks are sent with a window of chunks in flight on a worker thread
+  // so the GUI stays alive during the update
+  m_flasher->addRange(CBootDevice_VSCP::MEM_CODE_START, CBootDevice_VSCP::MEM_CODE_END, CBootFlashVSCP::MEM_TYPE_PROGRAM);
+  m_flasher->addRange(CBootDevice_VSCP::MEM_EEPROM_START, CBootDevice_VSCP::MEM_EEPROM_END, CBootFlashVSCP::MEM_TYPE_DATA);
+
+  CBootFlashVSCP::options opt;
+  opt.m_nodeid  = vscp_readStringValue(field("boot.nickname").toString().toStdString());
+  opt.m_timeout = pworks->m_config_timeout;
+  opt.m_window  = m_spinWindow->value();
+  opt.m_retries = 3;
+  opt.m_guidInterface.clear();
+
+  spdlog::info("Load firmware to remote device window={}", opt.m_window);
+  addStatusMessage("Init remote device and load firmware.");
+  rv = m_flasher->start(
+    opt,
+    [this](int progress, const char* str) {
+      QMetaObject::invokeMethod(
+        this,
+        [this, progress, msg = std::string(str)]() { statusCallback(progress, msg.c_str()); },
+        Qt::QueuedConnection);
+    },
+    [this](int rv, const CBootFlashVSCP::flashstats& stats) {
+      QMetaObject::invokeMethod(
+        this,
+        [this, rv, stats]() { onFlashDone(rv, stats); },
+        Qt::QueuedConnection);
+    });
+  if (VSCP_ERROR_SUCCESS != rv) {
+    spdlog::error("Failed to start firmware load rv={}", rv);
+    addStatusMessage(QString("Failed to start firmware load: rv = %1.").arg(rv));
+    return;
+  }
+
+  m_btnFlash->setEnabled(false);
+  m_spinWindow->setEnabled(false);
+  emit completeChanged();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onFlashDone
+//
+
+void
+CWizardPageFlash::onFlashDone(int rv, CBootFlashVSCP::flashstats stats)
+{
+  m_btnFlash->setEnabled(true);
+  m_spinWindow->setEnabled(true);
+  emit completeChanged();
+
+  addStatusMessage(QString("%1 bytes in %2 ms (%3 bytes/s), %4 chunk(s) resent, %5 block(s) with CRC error.")
+                     .arg(stats.m_bytes)
+                     .arg(stats.m_elapsed)
+                     .arg(stats.m_rate)
+                     .arg(stats.m_retransmits)
+                     .arg(stats.m_crcErrors));
+
+  // All blocks are programmed but the node did not confirm the new image
+  if ((VSCP_ERROR_TIMEOUT == rv) && stats.m_totalBlocks && (stats.m_blocks == stats.m_totalBlocks)) {
+    spdlog::error("Device did not confirm activation of the new firmware");
+    addStatusMessage(QString("Firmware programmed but the device did not confirm the new image."));
+    QMessageBox::warning(this,
+                         tr(APPNAME),
+                         tr("The firmware was programmed but the device did not confirm that it started "
+                            "the new image. Check that the device is running the new firmware."),
+                         QMessageBox::Ok);
+    return;
+  }
+
+  if (VSCP_ERROR_SUCCESS != rv) {
     spdlog::error("Failed to load firmware to device rv={}", rv);
     addStatusMessage(QString("Failed to load firmware to device: rv = {%0}.").arg(rv));
     QMessageBox::critical(this,
@@ -1345,32 +1464,8 @@ CWizardPageFlash::flashDeviceVSCP(void)
   }
   addStatusMessage("Firmware loaded to remote device.");
 
-  /*
-    spdlog::info("Restart remote device");
-    addStatusMessage("Restart remote device.");
-    if (VSCP_ERROR_SUCCESS != (rv = boot.deviceRestart())) {
-      spdlog::warn("Failed to confirm restart of device. (Usually not indicating an error) rv={}", rv);
-      addStatusMessage(QString("Failed to confirm restart of device. (Usually not indicating an error): rv = {%0}.").arg(rv));
-    }
-    addStatusMessage("Remote device restarted.");
-
-    spdlog::info("Reboot remote device");
-    addStatusMessage("Reboot remote device.");
-    if (VSCP_ERROR_SUCCESS != (rv = boot.deviceReboot())) {
-      QApplication::restoreOverrideCursor();
-      spdlog::error("Failed to confirm reboot of device rv={}", rv);
-      addStatusMessage(QString("Failed to confirm reboot of device: rv = {%0}.").arg(rv));
-      QMessageBox::information(this,
-                               tr(APPNAME),
-                               tr("Failed to reboot remote device"),
-                               QMessageBox::Ok);
-      return;
-    }
-    addStatusMessage("Remote device rebooted.");*/
-
   m_progress->setValue(100);
   addStatusMessage(QString("Success."));
-  QApplication::restoreOverrideCursor();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1571,6 +1666,11 @@ CWizardPageFlash::flashDevice(void)
 void
 CWizardPageFlash::cleanupPage(void)
 {
+  // Leaving the page stops an update so the client is free for the other pages
+  if (nullptr != m_flasher) {
+    m_flasher->cancel();
+    m_flasher->wait();
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1580,7 +1680,7 @@ CWizardPageFlash::cleanupPage(void)
 bool
 CWizardPageFlash::isComplete(void) const
 {
-  return true;
+  return (nullptr == m_flasher) || !m_flasher->isRunning();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -35,6 +35,8 @@
 #include <vscp-client-base.h>
 #include <vscp-bootdevice.h>
 
+#include "bootflashvscp.h"
+
 #include <QCheckBox>
 #include <QFormLayout>
 #include <QHBoxLayout>
@@ -364,6 +366,13 @@ public:
   /// Flash device using VSCP algorithm
   void flashDeviceVSCP(void);
 
+  /*!
+    Called in the GUI thread when a VSCP algorithm update has ended
+    @param rv Result of the update
+    @param stats Transfer statistics
+  */
+  void onFlashDone(int rv, CBootFlashVSCP::flashstats stats);
+
 public slots:
 
   /// Flash the device
@@ -376,6 +385,15 @@ private:
   /// Pointer to the boot device
   CBootDevice* m_bootDev;
 
+  /// Windowed VSCP algorithm update running on a worker thread
+  CBootFlashVSCP* m_flasher;
+
+  /// Number of block data chunks in flight for the VSCP algorithm
+  QSpinBox* m_spinWindow;
+
+  /// Button that starts the update
+  QPushButton* m_btnFlash;
+
   /// Boot progress
   QProgressBar* m_progress;
 
@@ -411,6 +429,12 @@ public:
   */
   int initBootLoaderWizard(void);
 
+  /*!
+    Get the connection the wizard works on
+    @return Connection configuration
+  */
+  const json& getConnObject(void) const { return m_connObject; };
+
 private slots:
 
   /// Show help
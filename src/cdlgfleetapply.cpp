@@ -0,0 +1,736 @@
+// cdlgfleetapply.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "vscpworks.h"
+
+#include "cdlgfleetapply.h"
+
+#include <QAbstractItemView>
+#include <QCheckBox>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPlainTextEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QRegularExpression>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QTableWidgetItem>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+// Result table columns
+enum {
+  FLEET_COL_NODE = 0,
+  FLEET_COL_STATUS,
+  FLEET_COL_REGISTERS,
+  FLEET_COL_VERIFIED,
+  FLEET_COL_FAILED,
+  FLEET_COL_TIME,
+  FLEET_COL_COUNT
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CTor
+//
+
+CDlgFleetApply::CDlgFleetApply(QWidget* parent,
+                               CVscpClient* client,
+                               const cguid& guidInterface,
+                               const std::map<uint32_t, uint8_t>& regs,
+                               const QString& setName,
+                               uint32_t timeout)
+  : QDialog(parent)
+  , m_vscpClient(client)
+  , m_timeout(timeout)
+  , m_regs(regs)
+  , m_pipeline(nullptr)
+  , m_finished(0)
+  , m_bVerify(true)
+  , m_bRollback(true)
+{
+  m_guidInterface = guidInterface;
+
+  setWindowTitle(tr("Apply register set to nodes"));
+  resize(800, 640);
+
+  setupUi();
+  m_setLabel->setText(tr("%1 (%2 registers)").arg(setName).arg(m_regs.size()));
+
+  buildChunks(255, m_readChunks);
+  buildChunks(CRegisterPipeline::MAX_WRITE_COUNT, m_writeChunks);
+
+  m_timer = new QTimer(this);
+  connect(m_timer, &QTimer::timeout, this, &CDlgFleetApply::onTimer);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTor
+//
+
+CDlgFleetApply::~CDlgFleetApply()
+{
+  m_timer->stop();
+  if (nullptr != m_pipeline) {
+    delete m_pipeline;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setupUi
+//
+
+void
+CDlgFleetApply::setupUi(void)
+{
+  QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+  QGroupBox* setupGroup   = new QGroupBox(tr("Setup"), this);
+  QFormLayout* formLayout = new QFormLayout(setupGroup);
+
+  m_setLabel = new QLabel("-", setupGroup);
+  formLayout->addRow(tr("Register set:"), m_setLabel);
+
+  m_targetsEdit = new QPlainTextEdit(setupGroup);
+  m_targetsEdit->setPlaceholderText(tr("Node ids, ranges or GUIDs, e.g. 1,2,5-10,0x20"));
+  m_targetsEdit->setMaximumHeight(80);
+  formLayout->addRow(tr("Target nodes:"), m_targetsEdit);
+
+  m_windowSpin = new QSpinBox(setupGroup);
+  m_windowSpin->setRange(1, 64);
+  m_windowSpin->setValue(8);
+  m_windowSpin->setToolTip(tr("Max number of nodes with a request in flight at the same time"));
+  formLayout->addRow(tr("Concurrent nodes:"), m_windowSpin);
+
+  m_retriesSpin = new QSpinBox(setupGroup);
+  m_retriesSpin->setRange(0, 10);
+  m_retriesSpin->setValue(2);
+  m_retriesSpin->setToolTip(tr("Number of times a request is resent before it times out"));
+  formLayout->addRow(tr("Retries:"), m_retriesSpin);
+
+  m_verifyCheck = new QCheckBox(tr("Verify written values"), setupGroup);
+  m_verifyCheck->setChecked(true);
+  formLayout->addRow("", m_verifyCheck);
+
+  m_rollbackCheck = new QCheckBox(tr("Restore old values on a node if any register fails"), setupGroup);
+  m_rollbackCheck->setChecked(true);
+  formLayout->addRow("", m_rollbackCheck);
+
+  mainLayout->addWidget(setupGroup);
+
+  m_resultTable = new QTableWidget(this);
+  m_resultTable->setColumnCount(FLEET_COL_COUNT);
+  m_resultTable->setHorizontalHeaderLabels(QStringList() << tr("Node") << tr("Status") << tr("Registers")
+                                                         << tr("Verified") << tr("Failed") << tr("Time (ms)"));
+  m_resultTable->horizontalHeader()->setSectionResizeMode(FLEET_COL_STATUS, QHeaderView::Stretch);
+  m_resultTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_resultTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_resultTable->verticalHeader()->setVisible(false);
+  mainLayout->addWidget(m_resultTable, 1);
+
+  m_progress = new QProgressBar(this);
+  m_progress->setRange(0, 100);
+  m_progress->setValue(0);
+  mainLayout->addWidget(m_progress);
+
+  m_summaryLabel = new QLabel("", this);
+  mainLayout->addWidget(m_summaryLabel);
+
+  QHBoxLayout* buttonLayout = new QHBoxLayout();
+  m_startButton             = new QPushButton(tr("Start"), this);
+  m_cancelButton            = new QPushButton(tr("Cancel"), this);
+  m_closeButton             = new QPushButton(tr("Close"), this);
+  m_cancelButton->setEnabled(false);
+  buttonLayout->addStretch(1);
+  buttonLayout->addWidget(m_startButton);
+  buttonLayout->addWidget(m_cancelButton);
+  buttonLayout->addWidget(m_closeButton);
+  mainLayout->addLayout(buttonLayout);
+
+  connect(m_startButton, &QPushButton::clicked, this, &CDlgFleetApply::start);
+  connect(m_cancelButton, &QPushButton::clicked, this, &CDlgFleetApply::cancel);
+  connect(m_closeButton, &QPushButton::clicked, this, &CDlgFleetApply::reject);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readNodeId
+//
+// Strict node id conversion. Decimal or "0x" prefixed hex, -1 if the
+// string is not a number in the range 0-255.
+//
+
+static int
+readNodeId(const QString& str)
+{
+  bool bOk = false;
+  int id;
+
+  if (str.startsWith("0x", Qt::CaseInsensitive)) {
+    id = str.mid(2).toInt(&bOk, 16);
+  }
+  else {
+    id = str.toInt(&bOk, 10);
+  }
+
+  if (!bOk || (id < 0) || (id > 255)) {
+    return -1;
+  }
+
+  return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// parseTargets
+//
+
+bool
+CDlgFleetApply::parseTargets(const QString& str,
+                             const cguid& guidInterface,
+                             std::deque<uint8_t>& nodes,
+                             QString& err)
+{
+  std::set<uint8_t> found;
+  cguid guidIf = guidInterface;
+
+  nodes.clear();
+  const QStringList tokens = str.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+  for (const QString& token : tokens) {
+
+    int first;
+    int last;
+
+    if (token.contains(':')) {
+      // GUID - node id is the LSB, the rest must be the interface
+      cguid guid;
+      if (!guid.getFromString(token.toStdString())) {
+        err = tr("Invalid GUID: %1").arg(token);
+        return false;
+      }
+      bool bNullIf = true;
+      for (int i = 0; i < 15; i++) {
+        if (guid.getGUID()[i]) {
+          bNullIf = false;
+        }
+      }
+      if (!bNullIf && memcmp(guid.getGUID(), guidIf.getGUID(), 15)) {
+        err = tr("GUID %1 is not on the selected interface").arg(token);
+        return false;
+      }
+      first = last = guid.getGUID()[15];
+    }
+    else {
+      // Node id or range, a leading '-' can't start a range
+      int pos = token.indexOf('-', 1);
+      if (pos > 0) {
+        first = readNodeId(token.left(pos));
+        last  = readNodeId(token.mid(pos + 1));
+      }
+      else {
+        first = last = readNodeId(token);
+      }
+      if ((first < 0) || (last < 0) || (last < first)) {
+        err = tr("Invalid node id or range: %1").arg(token);
+        return false;
+      }
+    }
+
+    for (int id = first; id <= last; id++) {
+      if (found.insert((uint8_t)id).second) {
+        nodes.push_back((uint8_t)id);
+      }
+    }
+  }
+
+  if (nodes.empty()) {
+    err = tr("No target nodes given");
+    return false;
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// buildChunks
+//
+
+void
+CDlgFleetApply::buildChunks(uint8_t maxCount, std::deque<regchunk>& chunks) const
+{
+  chunks.clear();
+  for (auto const& item : m_regs) {
+    uint16_t page  = item.first >> 8;
+    uint8_t offset = item.first & 0xff;
+    if (chunks.size()) {
+      regchunk& last = chunks.back();
+      if ((last.m_page == page) && ((last.m_offset + last.m_count) == offset) && (last.m_count < maxCount)) {
+        last.m_count++;
+        continue;
+      }
+    }
+    regchunk chunk;
+    chunk.m_page   = page;
+    chunk.m_offset = offset;
+    chunk.m_count  = 1;
+    chunks.push_back(chunk);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+void
+CDlgFleetApply::start(void)
+{
+  if ((nullptr == m_vscpClient) || !m_vscpClient->isConnected()) {
+    QMessageBox::warning(this, tr(APPNAME), tr("Not connected."));
+    return;
+  }
+
+  if (m_regs.empty()) {
+    QMessageBox::warning(this, tr(APPNAME), tr("The register set is empty."));
+    return;
+  }
+
+  std::deque<uint8_t> targets;
+  QString err;
+  if (!parseTargets(m_targetsEdit->toPlainText(), m_guidInterface, targets, err)) {
+    QMessageBox::warning(this, tr(APPNAME), err);
+    return;
+  }
+
+  if (nullptr != m_pipeline) {
+    delete m_pipeline;
+  }
+  m_pipeline = new CRegisterPipeline(*m_vscpClient,
+                                     m_guidInterface,
+                                     m_timeout,
+                                     m_windowSpin->value(),
+                                     m_retriesSpin->value());
+
+  m_bVerify   = m_verifyCheck->isChecked();
+  m_bRollback = m_rollbackCheck->isChecked();
+  m_finished  = 0;
+  m_nodes.clear();
+
+  m_resultTable->clearContents();
+  m_resultTable->setRowCount((int)targets.size());
+
+  int row = 0;
+  for (auto nodeid : targets) {
+    fleetnode& node    = m_nodes[nodeid];
+    node.m_nodeid      = nodeid;
+    node.m_row         = row++;
+    node.m_state       = nodestate::WAITING;
+    node.m_outstanding = 0;
+    node.m_bError      = false;
+    node.m_verified    = 0;
+    node.m_failed      = 0;
+    for (int col = 0; col < FLEET_COL_COUNT; col++) {
+      m_resultTable->setItem(node.m_row, col, new QTableWidgetItem());
+    }
+    m_resultTable->item(node.m_row, FLEET_COL_NODE)->setText(QString::number(nodeid));
+    m_resultTable->item(node.m_row, FLEET_COL_REGISTERS)->setText(QString::number(m_regs.size()));
+    updateRow(node);
+  }
+
+  spdlog::info("Fleet apply: Writing {0} registers to {1} nodes", m_regs.size(), m_nodes.size());
+
+  // Everything is queued up front, the pipeline window decides how many
+  // nodes are worked on at the same time.
+  for (auto& item : m_nodes) {
+    item.second.m_timer.start();
+    if (m_bRollback) {
+      startSnapshot(item.second);
+    }
+    else {
+      startWrite(item.second);
+    }
+  }
+
+  m_progress->setValue(0);
+  m_summaryLabel->clear();
+  m_runTimer.start();
+  setRunning(true);
+  m_timer->start(2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// startSnapshot
+//
+
+void
+CDlgFleetApply::startSnapshot(fleetnode& node)
+{
+  node.m_state  = nodestate::SNAPSHOT;
+  node.m_bError = false;
+  updateRow(node);
+
+  uint8_t nodeid = node.m_nodeid;
+  for (auto const& chunk : m_readChunks) {
+    node.m_outstanding++;
+    m_pipeline->read(nodeid, chunk.m_page, chunk.m_offset, chunk.m_count, [this, nodeid](const CRegisterPipeline::regop& op) {
+      fleetnode& node = m_nodes[nodeid];
+      node.m_outstanding--;
+      if (CRegisterPipeline::opstatus::DONE == op.m_status) {
+        for (uint8_t i = 0; i < op.m_count; i++) {
+          node.m_old[makeKey(op.m_page, op.m_offset + i)] = op.m_data[i];
+        }
+      }
+      else if (nodestate::CANCELLED != node.m_state) {
+        node.m_bError = true;
+        if (CRegisterPipeline::opstatus::CANCELLED == op.m_status) {
+          node.m_state = nodestate::CANCELLED;
+        }
+      }
+
+      if (node.m_outstanding) {
+        return;
+      }
+
+      if (nodestate::CANCELLED == node.m_state) {
+        finishNode(node, nodestate::CANCELLED);
+      }
+      else if (node.m_bError) {
+        // Nothing has been written so the node is left as it was
+        node.m_failed = m_regs.size();
+        finishNode(node, nodestate::FAILED);
+      }
+      else {
+        startWrite(node);
+      }
+    });
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// startWrite
+//
+
+void
+CDlgFleetApply::startWrite(fleetnode& node)
+{
+  node.m_state  = nodestate::WRITING;
+  node.m_bError = false;
+  updateRow(node);
+
+  uint8_t nodeid = node.m_nodeid;
+  for (size_t idx = 0; idx < m_writeChunks.size(); idx++) {
+    const regchunk& chunk = m_writeChunks[idx];
+    std::vector<uint8_t> values;
+    for (uint8_t i = 0; i < chunk.m_count; i++) {
+      values.push_back(m_regs[makeKey(chunk.m_page, chunk.m_offset + i)]);
+    }
+    node.m_outstanding++;
+    m_pipeline->write(nodeid, chunk.m_page, chunk.m_offset, values, [this, nodeid, idx](const CRegisterPipeline::regop& op) {
+      fleetnode& node = m_nodes[nodeid];
+      node.m_outstanding--;
+      if (CRegisterPipeline::opstatus::DONE == op.m_status) {
+        node.m_touched.insert(idx);
+        for (uint8_t i = 0; i < op.m_count; i++) {
+          if (!m_bVerify || (op.m_response[i] == op.m_data[i])) {
+            node.m_verified++;
+          }
+          else {
+            spdlog::warn("Fleet apply: Node {0} register {1}:{2} read back {3} expected {4}",
+                         nodeid,
+                         op.m_page,
+                         op.m_offset + i,
+                         op.m_response[i],
+                         op.m_data[i]);
+            node.m_failed++;
+          }
+        }
+      }
+      else {
+        // A request that timed out may still have been written
+        if (CRegisterPipeline::opstatus::CANCELLED != op.m_status) {
+          node.m_touched.insert(idx);
+        }
+        else {
+          node.m_state = nodestate::CANCELLED;
+        }
+        node.m_failed += op.m_count;
+      }
+
+      updateRow(node);
+      if (node.m_outstanding) {
+        return;
+      }
+
+      if (nodestate::CANCELLED == node.m_state) {
+        finishNode(node, nodestate::CANCELLED);
+      }
+      else if (node.m_failed && m_bRollback) {
+        startRollback(node);
+      }
+      else {
+        finishNode(node, node.m_failed ? nodestate::FAILED : nodestate::DONE);
+      }
+    });
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// startRollback
+//
+
+void
+CDlgFleetApply::startRollback(fleetnode& node)
+{
+  node.m_state  = nodestate::ROLLBACK;
+  node.m_bError = false;
+  updateRow(node);
+
+  spdlog::info("Fleet apply: Restoring old values on node {0}", node.m_nodeid);
+
+  uint8_t nodeid = node.m_nodeid;
+  for (auto idx : node.m_touched) {
+    const regchunk& chunk = m_writeChunks[idx];
+    std::vector<uint8_t> values;
+    for (uint8_t i = 0; i < chunk.m_count; i++) {
+      values.push_back(node.m_old[makeKey(chunk.m_page, chunk.m_offset + i)]);
+    }
+    node.m_outstanding++;
+    m_pipeline->write(nodeid, chunk.m_page, chunk.m_offset, values, [this, nodeid](const CRegisterPipeline::regop& op) {
+      fleetnode& node = m_nodes[nodeid];
+      node.m_outstanding--;
+      if ((CRegisterPipeline::opstatus::DONE != op.m_status) || (op.m_response != op.m_data)) {
+        node.m_bError = true;
+      }
+      if (!node.m_outstanding) {
+        finishNode(node, node.m_bError ? nodestate::FAILED : nodestate::ROLLED_BACK);
+      }
+    });
+  }
+
+  // Nothing was touched so there is nothing to restore
+  if (!node.m_outstanding) {
+    finishNode(node, nodestate::ROLLED_BACK);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// finishNode
+//
+
+void
+CDlgFleetApply::finishNode(fleetnode& node, nodestate state)
+{
+  node.m_state = state;
+  m_finished++;
+  updateRow(node);
+
+  m_progress->setValue((int)((m_finished * 100) / m_nodes.size()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onTimer
+//
+
+void
+CDlgFleetApply::onTimer(void)
+{
+  if (nullptr == m_pipeline) {
+    m_timer->stop();
+    return;
+  }
+
+  if (m_pipeline->step()) {
+    return;
+  }
+
+  // All done
+  m_timer->stop();
+  setRunning(false);
+
+  size_t ok       = 0;
+  size_t failed   = 0;
+  size_t restored = 0;
+  for (auto const& item : m_nodes) {
+    switch (item.second.m_state) {
+      case nodestate::DONE:
+        ok++;
+        break;
+      case nodestate::ROLLED_BACK:
+        restored++;
+        break;
+      default:
+        failed++;
+        break;
+    }
+  }
+
+  const CRegisterPipeline::pipelinestats& stats = m_pipeline->getStats();
+  m_summaryLabel->setText(tr("%1 nodes OK, %2 restored, %3 failed in %4 ms (%5 requests, %6 resent, %7 timeouts)")
+                            .arg(ok)
+                            .arg(restored)
+                            .arg(failed)
+                            .arg(m_runTimer.elapsed())
+                            .arg(stats.m_sent)
+                            .arg(stats.m_retransmits)
+                            .arg(stats.m_timeouts));
+  spdlog::info("Fleet apply: {0}", m_summaryLabel->text().toStdString());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cancel
+//
+
+void
+CDlgFleetApply::cancel(void)
+{
+  if ((nullptr == m_pipeline) || m_pipeline->isIdle()) {
+    return;
+  }
+
+  // Nodes waiting to be worked on are cancelled through their callbacks.
+  // Operations already sent are still answered but no longer matched.
+  m_pipeline->cancel();
+  onTimer();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reject
+//
+
+void
+CDlgFleetApply::reject(void)
+{
+  if ((nullptr != m_pipeline) && !m_pipeline->isIdle()) {
+    if (QMessageBox::Yes != QMessageBox::question(this,
+                                                  tr(APPNAME),
+                                                  tr("Apply is in progress. Cancel and close?"),
+                                                  QMessageBox::Yes | QMessageBox::No,
+                                                  QMessageBox::No)) {
+      return;
+    }
+    cancel();
+  }
+
+  QDialog::reject();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setRunning
+//
+
+void
+CDlgFleetApply::setRunning(bool bRunning)
+{
+  m_startButton->setEnabled(!bRunning);
+  m_cancelButton->setEnabled(bRunning);
+  m_targetsEdit->setEnabled(!bRunning);
+  m_windowSpin->setEnabled(!bRunning);
+  m_retriesSpin->setEnabled(!bRunning);
+  m_verifyCheck->setEnabled(!bRunning);
+  m_rollbackCheck->setEnabled(!bRunning);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// updateRow
+//
+
+void
+CDlgFleetApply::updateRow(const fleetnode& node)
+{
+  QTableWidgetItem* itemStatus = m_resultTable->item(node.m_row, FLEET_COL_STATUS);
+  if (nullptr == itemStatus) {
+    return;
+  }
+
+  itemStatus->setText(stateToString(node.m_state));
+  switch (node.m_state) {
+    case nodestate::DONE:
+      itemStatus->setForeground(QBrush(Qt::darkGreen));
+      break;
+    case nodestate::ROLLED_BACK:
+      itemStatus->setForeground(QBrush(QColor("darkorange")));
+      break;
+    case nodestate::FAILED:
+    case nodestate::CANCELLED:
+      itemStatus->setForeground(QBrush(Qt::red));
+      break;
+    default:
+      itemStatus->setForeground(QBrush(Qt::black));
+      break;
+  }
+
+  m_resultTable->item(node.m_row, FLEET_COL_VERIFIED)->setText(QString::number(node.m_verified));
+  m_resultTable->item(node.m_row, FLEET_COL_FAILED)->setText(QString::number(node.m_failed));
+  if (node.m_timer.isValid()) {
+    m_resultTable->item(node.m_row, FLEET_COL_TIME)->setText(QString::number(node.m_timer.elapsed()));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// stateToString
+//
+
+QString
+CDlgFleetApply::stateToString(nodestate state)
+{
+  switch (state) {
+    case nodestate::WAITING:
+      return tr("Waiting");
+    case nodestate::SNAPSHOT:
+      return tr("Reading old values");
+    case nodestate::WRITING:
+      return tr("Writing");
+    case nodestate::ROLLBACK:
+      return tr("Restoring old values");
+    case nodestate::DONE:
+      return tr("OK");
+    case nodestate::FAILED:
+      return tr("Failed");
+    case nodestate::ROLLED_BACK:
+      return tr("Failed, old values restored");
+    case nodestate::CANCELLED:
+      return tr("Cancelled");
+  }
+  return tr("Unknown");
+}
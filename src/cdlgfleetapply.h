@@ -0,0 +1,219 @@
+// cdlgfleetapply.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CDLGFLEETAPPLY_H
+#define CDLGFLEETAPPLY_H
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <guid.h>
+#include <vscp-client-base.h>
+
+#include "registerpipeline.h"
+
+#include <QDialog>
+#include <QElapsedTimer>
+
+#include <deque>
+#include <map>
+#include <set>
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QLabel;
+class QPlainTextEdit;
+class QProgressBar;
+class QPushButton;
+class QSpinBox;
+class QTableWidget;
+class QTimer;
+QT_END_NAMESPACE
+
+/*!
+  Apply a register set to many Level I nodes over one connection.
+
+  The register set is written to every target node with a
+  CRegisterPipeline so that several nodes are configured at the same
+  time. Each node is optionally snapshotted first so that its old values
+  can be restored if any register fails to verify.
+*/
+
+class CDlgFleetApply : public QDialog {
+  Q_OBJECT
+
+public:
+  /*!
+    @param parent Parent widget
+    @param client Connected client to use
+    @param guidInterface Interface the nodes are on
+    @param regs Register set to apply, keyed on (page << 8) + offset
+    @param setName Name of the register set (file name) for display
+    @param timeout Response timeout in milliseconds
+  */
+  CDlgFleetApply(QWidget* parent,
+                 CVscpClient* client,
+                 const cguid& guidInterface,
+                 const std::map<uint32_t, uint8_t>& regs,
+                 const QString& setName,
+                 uint32_t timeout);
+  ~CDlgFleetApply();
+
+  /*!
+    Parse a target list. Node ids are given as decimal or hex values or as
+    ranges ("1,2,0x10,20-30"). A full GUID selects the node id in its LSB
+    and must be on the same interface as the dialog. Anything else,
+    including ids above 255, is rejected.
+    @param str Target list
+    @param guidInterface Interface nodes must be on
+    @param nodes Filled with unique node ids in the order given
+    @param err Set to a description of the first error
+    @return True on success
+  */
+  static bool parseTargets(const QString& str,
+                           const cguid& guidInterface,
+                           std::deque<uint8_t>& nodes,
+                           QString& err);
+
+public slots:
+  /// Start applying the register set
+  void start(void);
+
+  /// Cancel a running apply
+  void cancel(void);
+
+  /// Close the dialog (cancels a running apply)
+  void reject(void) override;
+
+private slots:
+  /// Drive the register pipeline
+  void onTimer(void);
+
+private:
+  /// State of a target node
+  enum class nodestate { WAITING = 0, SNAPSHOT, WRITING, ROLLBACK, DONE, FAILED, ROLLED_BACK, CANCELLED };
+
+  /// A run of registers on a page that is transferred in one request
+  struct regchunk {
+    uint16_t m_page;
+    uint8_t m_offset;
+    uint8_t m_count;
+  };
+
+  /// Work for one target node
+  struct fleetnode {
+    uint8_t m_nodeid;
+    int m_row;
+    nodestate m_state;
+    size_t m_outstanding;               // Operations queued and not completed
+    bool m_bError;                      // Communication error in current state
+    size_t m_verified;                  // Registers written and verified
+    size_t m_failed;                    // Registers that failed
+    std::map<uint32_t, uint8_t> m_old;  // Pre-write values
+    std::set<size_t> m_touched;         // Write chunks that may have changed the node
+    QElapsedTimer m_timer;
+  };
+
+  void setupUi(void);
+
+  /*!
+    Split the register set into chunks of contiguous registers
+    @param maxCount Max number of registers in a chunk
+    @param chunks Filled with chunks
+  */
+  void buildChunks(uint8_t maxCount, std::deque<regchunk>& chunks) const;
+
+  /// Queue snapshot reads for a node
+  void startSnapshot(fleetnode& node);
+
+  /// Queue writes of the register set for a node
+  void startWrite(fleetnode& node);
+
+  /// Queue writes of the pre-write values for a node
+  void startRollback(fleetnode& node);
+
+  /// Set final state for a node
+  void finishNode(fleetnode& node, nodestate state);
+
+  /// Update the table row for a node
+  void updateRow(const fleetnode& node);
+
+  /// Set the enabled state for controls
+  void setRunning(bool bRunning);
+
+  /// Get a readable string for a node state
+  static QString stateToString(nodestate state);
+
+  /// Key for the register maps
+  static uint32_t makeKey(uint16_t page, uint8_t offset)
+  {
+    return ((uint32_t)page << 8) + offset;
+  };
+
+  CVscpClient* m_vscpClient;
+  cguid m_guidInterface;
+  uint32_t m_timeout;
+
+  /// Register set to apply
+  std::map<uint32_t, uint8_t> m_regs;
+
+  /// Register set split into read and write chunks
+  std::deque<regchunk> m_readChunks;
+  std::deque<regchunk> m_writeChunks;
+
+  /// Pipeline used while running
+  CRegisterPipeline* m_pipeline;
+
+  /// Target nodes, keyed on node id
+  std::map<uint8_t, fleetnode> m_nodes;
+
+  /// Number of nodes in a final state
+  size_t m_finished;
+
+  bool m_bVerify;
+  bool m_bRollback;
+
+  QTimer* m_timer;
+  QElapsedTimer m_runTimer;
+
+  QLabel* m_setLabel;
+  QPlainTextEdit* m_targetsEdit;
+  QSpinBox* m_windowSpin;
+  QSpinBox* m_retriesSpin;
+  QCheckBox* m_verifyCheck;
+  QCheckBox* m_rollbackCheck;
+  QTableWidget* m_resultTable;
+  QProgressBar* m_progress;
+  QLabel* m_summaryLabel;
+  QPushButton* m_startButton;
+  QPushButton* m_cancelButton;
+  QPushButton* m_closeButton;
+};
+
+#endif // CDLGFLEETAPPLY_H
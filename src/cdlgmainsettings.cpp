@@ -93,6 +93,7 @@ connect(helpButton, SIGNAL(clicked()), this, SLOT(showHelp()));
   ui->spinMdfAutoSaveInterval->setValue(static_cast<int>(pworks->m_mdfAutoSaveInterval));
   ui->chkMdfCumulativeBackups->setChecked(pworks->m_mdfCumulativeBackups);
   ui->spinMdfMaxBackups->setValue(static_cast<int>(pworks->m_mdfMaxBackups));
+  ui->spinMqttHistoryBudget->setValue(static_cast<int>(pworks->m_mqttHistoryBudget));
 
   // * * * Session Window tab * * *
 
@@ -267,6 +268,7 @@ CDlgMainSettings::done(int rv)
     pworks->m_mdfAutoSaveInterval = static_cast<uint32_t>(ui->spinMdfAutoSaveInterval->value());
     pworks->m_mdfCumulativeBackups = ui->chkMdfCumulativeBackups->isChecked();
     pworks->m_mdfMaxBackups = static_cast<uint32_t>(ui->spinMdfMaxBackups->value());
+    pworks->m_mqttHistoryBudget = static_cast<uint32_t>(ui->spinMqttHistoryBudget->value());
     pworks->m_preferredLanguage = ui->editPreferredLanguage->text().toStdString();
 
     // Session window
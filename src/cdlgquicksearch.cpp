@@ -0,0 +1,200 @@
+// cdlgquicksearch.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include "cdlgquicksearch.h"
+
+#include <QComboBox>
+#include <QElapsedTimer>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTor
+//
+
+CDlgQuickSearch::CDlgQuickSearch(QWidget* parent, const CMdfSearchIndex* pindex)
+  : QDialog(parent)
+  , m_pindex(pindex)
+{
+  setWindowTitle(tr("Search registers and remote variables"));
+  resize(520, 480);
+
+  QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+  m_searchEdit = new QLineEdit(this);
+  m_searchEdit->setPlaceholderText(tr("Name, description, bit/value name or page:offset"));
+  m_searchEdit->setClearButtonEnabled(true);
+  m_searchEdit->installEventFilter(this);
+  mainLayout->addWidget(m_searchEdit);
+
+  QHBoxLayout* optLayout = new QHBoxLayout();
+  m_kindCombo            = new QComboBox(this);
+  m_kindCombo->addItem(tr("Registers"), (int)CMdfSearchIndex::entrykind::REGISTER);
+  m_kindCombo->addItem(tr("Remote variables"), (int)CMdfSearchIndex::entrykind::REMOTEVAR);
+  m_modeCombo = new QComboBox(this);
+  m_modeCombo->addItem(tr("Word starts with"), (int)CMdfSearchIndex::matchmode::PREFIX);
+  m_modeCombo->addItem(tr("Contains"), (int)CMdfSearchIndex::matchmode::SUBSTRING);
+  optLayout->addWidget(m_kindCombo);
+  optLayout->addWidget(m_modeCombo);
+  optLayout->addStretch(1);
+  mainLayout->addLayout(optLayout);
+
+  m_resultList = new QListWidget(this);
+  mainLayout->addWidget(m_resultList, 1);
+
+  m_statusLabel = new QLabel("", this);
+  mainLayout->addWidget(m_statusLabel);
+
+  connect(m_searchEdit, &QLineEdit::textChanged, this, &CDlgQuickSearch::refresh);
+  connect(m_searchEdit, &QLineEdit::returnPressed, this, &CDlgQuickSearch::selectNext);
+  connect(m_kindCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &CDlgQuickSearch::refresh);
+  connect(m_modeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &CDlgQuickSearch::refresh);
+  connect(m_resultList, &QListWidget::currentRowChanged, this, &CDlgQuickSearch::onCurrentRowChanged);
+
+  m_searchEdit->setFocus();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTor
+//
+
+CDlgQuickSearch::~CDlgQuickSearch()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setKind
+//
+
+void
+CDlgQuickSearch::setKind(CMdfSearchIndex::entrykind kind)
+{
+  m_kindCombo->setCurrentIndex(m_kindCombo->findData((int)kind));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// refresh
+//
+
+void
+CDlgQuickSearch::refresh(void)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  // Don't emit selections while the list is rebuilt
+  m_resultList->blockSignals(true);
+  m_resultList->clear();
+
+  m_pindex->find(m_searchEdit->text().toStdString(),
+                 (CMdfSearchIndex::matchmode)m_modeCombo->currentData().toInt(),
+                 (CMdfSearchIndex::entrykind)m_kindCombo->currentData().toInt(),
+                 m_results,
+                 MAX_RESULTS);
+
+  for (auto idx : m_results) {
+    const CMdfSearchIndex::entry& e = m_pindex->getEntry(idx);
+    m_resultList->addItem(QString("%1  %2")
+                            .arg(CMdfSearchIndex::makePosition(e.m_page, e.m_offset).c_str(), -10)
+                            .arg(e.m_label.c_str()));
+  }
+
+  m_resultList->blockSignals(false);
+
+  if (m_searchEdit->text().isEmpty()) {
+    m_statusLabel->setText(tr("%1 entries indexed").arg(m_pindex->getCount()));
+  }
+  else {
+    m_statusLabel->setText(tr("%1%2 matches (%3 ms)")
+                             .arg(m_results.size())
+                             .arg(((int)m_results.size() >= MAX_RESULTS) ? "+" : "")
+                             .arg(timer.elapsed()));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// selectNext
+//
+
+void
+CDlgQuickSearch::selectNext(void)
+{
+  int cnt = m_resultList->count();
+  if (!cnt) {
+    return;
+  }
+  m_resultList->setCurrentRow((m_resultList->currentRow() + 1) % cnt);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onCurrentRowChanged
+//
+
+void
+CDlgQuickSearch::onCurrentRowChanged(int row)
+{
+  if ((row < 0) || (row >= (int)m_results.size())) {
+    return;
+  }
+  emit entrySelected(m_results[row]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// eventFilter
+//
+// Up/down in the search field moves in the result list
+//
+
+bool
+CDlgQuickSearch::eventFilter(QObject* obj, QEvent* event)
+{
+  if ((obj == m_searchEdit) && (QEvent::KeyPress == event->type())) {
+    QKeyEvent* keyEvent = static_cast<QKeyEvent*>(event);
+    int cnt             = m_resultList->count();
+    if (cnt && (Qt::Key_Down == keyEvent->key())) {
+      m_resultList->setCurrentRow(std::min(m_resultList->currentRow() + 1, cnt - 1));
+      return true;
+    }
+    if (cnt && (Qt::Key_Up == keyEvent->key())) {
+      m_resultList->setCurrentRow(std::max(m_resultList->currentRow() - 1, 0));
+      return true;
+    }
+  }
+  return QDialog::eventFilter(obj, event);
+}
@@ -0,0 +1,99 @@
+// cdlgquicksearch.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CDLGQUICKSEARCH_H
+#define CDLGQUICKSEARCH_H
+
+#include "mdfsearchindex.h"
+
+#include <QDialog>
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QListWidget;
+QT_END_NAMESPACE
+
+/*!
+  Search-as-you-type over a CMdfSearchIndex.
+
+  Results are shown in a list. Moving in the list emits entrySelected()
+  so the owner can show the item, return in the search field steps to
+  the next result.
+*/
+
+class CDlgQuickSearch : public QDialog {
+  Q_OBJECT
+
+public:
+  /// Max number of results shown
+  static const int MAX_RESULTS = 1000;
+
+  /*!
+    @param parent Parent widget
+    @param pindex Index to search. Must outlive the dialog.
+  */
+  CDlgQuickSearch(QWidget* parent, const CMdfSearchIndex* pindex);
+  ~CDlgQuickSearch();
+
+  /*!
+    Select what is searched
+    @param kind Registers or remote variables
+  */
+  void setKind(CMdfSearchIndex::entrykind kind);
+
+public slots:
+  /// Run the search again, for example after the index is rebuilt
+  void refresh(void);
+
+  /// Step to the next result
+  void selectNext(void);
+
+signals:
+  /// An entry has been selected in the result list
+  void entrySelected(uint32_t idx);
+
+private slots:
+  void onCurrentRowChanged(int row);
+
+protected:
+  bool eventFilter(QObject* obj, QEvent* event) override;
+
+private:
+  const CMdfSearchIndex* m_pindex;
+  std::vector<uint32_t> m_results;
+
+  QLineEdit* m_searchEdit;
+  QComboBox* m_kindCombo;
+  QComboBox* m_modeCombo;
+  QListWidget* m_resultList;
+  QLabel* m_statusLabel;
+};
+
+#endif // CDLGQUICKSEARCH_H
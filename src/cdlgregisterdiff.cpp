@@ -0,0 +1,589 @@
+// cdlgregisterdiff.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "vscpworks.h"
+
+#include "cdlgfleetapply.h"
+#include "cfrmnodeconfig.h"
+#include "registerpipeline.h"
+
+#include "cdlgregisterdiff.h"
+
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QInputDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QMessageBox>
+#include <QProgressDialog>
+#include <QPushButton>
+#include <QSplitter>
+#include <QTabWidget>
+#include <QTableWidget>
+#include <QTableWidgetItem>
+#include <QVBoxLayout>
+
+#include <set>
+
+#include <spdlog/spdlog.h>
+
+// Fixed columns in the tables, images follow
+enum {
+  DIFF_COL_POSITION = 0,
+  DIFF_COL_NAME,
+  DIFF_COL_FIRST_IMAGE
+};
+
+// Background for values that differ from the reference
+static const QColor DIFF_COLOR(255, 210, 210);
+
+///////////////////////////////////////////////////////////////////////////////
+// CTor
+//
+
+CDlgRegisterDiff::CDlgRegisterDiff(QWidget* parent,
+                                   CVscpClient* client,
+                                   const cguid& guidInterface,
+                                   CMDF* pmdf,
+                                   uint32_t timeout)
+  : QDialog(parent)
+  , m_vscpClient(client)
+  , m_pmdf(pmdf)
+  , m_timeout(timeout)
+  , m_ref(0)
+{
+  m_guidInterface = guidInterface;
+
+  setWindowTitle(tr("Compare registers"));
+  resize(1000, 700);
+
+  setupUi();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTor
+//
+
+CDlgRegisterDiff::~CDlgRegisterDiff()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setupUi
+//
+
+void
+CDlgRegisterDiff::setupUi(void)
+{
+  QVBoxLayout* mainLayout = new QVBoxLayout(this);
+  QSplitter* splitter     = new QSplitter(Qt::Horizontal, this);
+
+  // Images
+  QWidget* imageWidget     = new QWidget(splitter);
+  QVBoxLayout* imageLayout = new QVBoxLayout(imageWidget);
+  imageLayout->setContentsMargins(0, 0, 0, 0);
+  imageLayout->addWidget(new QLabel(tr("Images (* = reference)"), imageWidget));
+
+  m_imageList = new QListWidget(imageWidget);
+  m_imageList->setSelectionMode(QAbstractItemView::ExtendedSelection);
+  imageLayout->addWidget(m_imageList, 1);
+
+  m_addNodesButton = new QPushButton(tr("Add nodes..."), imageWidget);
+  m_addNodesButton->setToolTip(tr("Read all registers from one or more nodes"));
+  m_addNodesButton->setEnabled((nullptr != m_vscpClient) && m_vscpClient->isConnected());
+  m_addFileButton = new QPushButton(tr("Add register file..."), imageWidget);
+  m_removeButton  = new QPushButton(tr("Remove"), imageWidget);
+  m_refButton     = new QPushButton(tr("Set as reference"), imageWidget);
+  imageLayout->addWidget(m_addNodesButton);
+  imageLayout->addWidget(m_addFileButton);
+  imageLayout->addWidget(m_removeButton);
+  imageLayout->addWidget(m_refButton);
+
+  m_allCheck = new QCheckBox(tr("Show equal registers"), imageWidget);
+  imageLayout->addWidget(m_allCheck);
+
+  // Result
+  m_tabs = new QTabWidget(splitter);
+
+  m_regTable = new QTableWidget(m_tabs);
+  m_regTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_regTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_regTable->verticalHeader()->setVisible(false);
+  m_tabs->addTab(m_regTable, tr("Registers"));
+
+  m_rvTable = new QTableWidget(m_tabs);
+  m_rvTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_rvTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_rvTable->verticalHeader()->setVisible(false);
+  m_tabs->addTab(m_rvTable, tr("Remote variables"));
+
+  splitter->addWidget(imageWidget);
+  splitter->addWidget(m_tabs);
+  splitter->setStretchFactor(1, 1);
+  mainLayout->addWidget(splitter, 1);
+
+  m_summaryLabel = new QLabel("", this);
+  mainLayout->addWidget(m_summaryLabel);
+
+  QHBoxLayout* buttonLayout = new QHBoxLayout();
+  QPushButton* closeButton  = new QPushButton(tr("Close"), this);
+  buttonLayout->addStretch(1);
+  buttonLayout->addWidget(closeButton);
+  mainLayout->addLayout(buttonLayout);
+
+  connect(m_addNodesButton, &QPushButton::clicked, this, &CDlgRegisterDiff::addNodes);
+  connect(m_addFileButton, &QPushButton::clicked, this, &CDlgRegisterDiff::addFile);
+  connect(m_removeButton, &QPushButton::clicked, this, &CDlgRegisterDiff::removeImage);
+  connect(m_refButton, &QPushButton::clicked, this, &CDlgRegisterDiff::setReference);
+  connect(m_allCheck, &QCheckBox::toggled, this, &CDlgRegisterDiff::refresh);
+  connect(closeButton, &QPushButton::clicked, this, &CDlgRegisterDiff::accept);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// addImage
+//
+
+bool
+CDlgRegisterDiff::addImage(const CRegisterImage& image)
+{
+  if (m_images.size() >= CRegisterDiff::MAX_IMAGES) {
+    return false;
+  }
+
+  m_images.push_back(image);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// addNodes
+//
+
+void
+CDlgRegisterDiff::addNodes(void)
+{
+  if ((nullptr == m_vscpClient) || !m_vscpClient->isConnected()) {
+    QMessageBox::information(this, tr(APPNAME), tr("Must be connected to read registers from nodes."));
+    return;
+  }
+
+  bool bOk;
+  QString targets = QInputDialog::getText(this,
+                                          tr(APPNAME),
+                                          tr("Nodes to read (ids, ranges or GUIDs, e.g. 1,2,5-10):"),
+                                          QLineEdit::Normal,
+                                          "",
+                                          &bOk);
+  if (!bOk || targets.trimmed().isEmpty()) {
+    return;
+  }
+
+  std::deque<uint8_t> nodes;
+  QString err;
+  if (!CDlgFleetApply::parseTargets(targets, m_guidInterface, nodes, err)) {
+    QMessageBox::warning(this, tr(APPNAME), err);
+    return;
+  }
+
+  if ((m_images.size() + nodes.size()) > CRegisterDiff::MAX_IMAGES) {
+    QMessageBox::warning(this,
+                         tr(APPNAME),
+                         tr("At most %1 images can be compared.").arg(CRegisterDiff::MAX_IMAGES));
+    return;
+  }
+
+  // Read the pages the MDF defines, page 0 if there is no MDF
+  std::set<uint16_t> pages;
+  if (nullptr != m_pmdf) {
+    m_pmdf->getPages(pages);
+  }
+  if (pages.empty()) {
+    pages.insert(0);
+  }
+
+  // All nodes are read at the same time, one page per request
+  CRegisterPipeline pipeline(*m_vscpClient, m_guidInterface, m_timeout);
+  std::map<uint8_t, CRegisterImage> images;
+  std::map<uint8_t, size_t> failed;
+  size_t total = nodes.size() * pages.size();
+  size_t done  = 0;
+
+  for (auto nodeid : nodes) {
+    images[nodeid].setName(QString("Node %1").arg(nodeid).toStdString());
+    for (auto page : pages) {
+      pipeline.read(nodeid, page, 0, CRegisterImage::PAGE_SIZE, [&](const CRegisterPipeline::regop& op) {
+        done++;
+        if (CRegisterPipeline::opstatus::DONE != op.m_status) {
+          failed[op.m_nodeid]++;
+          return;
+        }
+        for (size_t i = 0; i < op.m_data.size(); i++) {
+          images[op.m_nodeid].setReg(op.m_page, (uint8_t)(op.m_offset + i), op.m_data[i]);
+        }
+      });
+    }
+  }
+
+  QProgressDialog progress(tr("Reading registers..."), tr("Cancel"), 0, (int)total, this);
+  progress.setWindowModality(Qt::WindowModal);
+  progress.setMinimumDuration(0);
+
+  while (pipeline.step()) {
+    progress.setValue((int)done);
+    QApplication::processEvents();
+    if (progress.wasCanceled()) {
+      pipeline.cancel();
+      return;
+    }
+  }
+  progress.setValue((int)total);
+
+  QStringList errors;
+  for (auto nodeid : nodes) {
+    if (failed[nodeid] == pages.size()) {
+      errors << QString::number(nodeid);
+      spdlog::warn("Register diff: No response from node {0}", nodeid);
+      continue;
+    }
+    addImage(images[nodeid]);
+  }
+
+  if (errors.size()) {
+    QMessageBox::warning(this, tr(APPNAME), tr("No response from node(s) %1.").arg(errors.join(", ")));
+  }
+
+  refresh();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// addFile
+//
+
+void
+CDlgRegisterDiff::addFile(void)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  QStringList paths = QFileDialog::getOpenFileNames(this,
+                                                    tr("Load register set(s) to compare"),
+                                                    pworks->m_shareFolder,
+                                                    tr("Register Files (*.reg);;XML Files (*.xml);;JSON Files (*.json);;All Files (*.*)"));
+  for (const QString& path : paths) {
+
+    if (m_images.size() >= CRegisterDiff::MAX_IMAGES) {
+      QMessageBox::warning(this,
+                           tr(APPNAME),
+                           tr("At most %1 images can be compared.").arg(CRegisterDiff::MAX_IMAGES));
+      break;
+    }
+
+    CFrmNodeConfig::registerset set;
+    int rv = CFrmNodeConfig::readRegisterSet(path.toStdString(), set);
+    if (VSCP_ERROR_SUCCESS != rv) {
+      QMessageBox::warning(this, tr(APPNAME), tr("Failed to read register set from %1:\n%2.").arg(path).arg(rv));
+      continue;
+    }
+
+    if ((nullptr != m_pmdf) && set.m_moduleName.size() && m_pmdf->getModuleName().size() &&
+        (set.m_moduleName != m_pmdf->getModuleName())) {
+      spdlog::warn("Register diff: Module name in {0} does not match MDF", path.toStdString());
+    }
+
+    CRegisterImage image(QFileInfo(path).fileName().toStdString());
+    image.fromMap(set.m_regs);
+    addImage(image);
+  }
+
+  refresh();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// removeImage
+//
+
+void
+CDlgRegisterDiff::removeImage(void)
+{
+  std::set<int> rows;
+  for (auto item : m_imageList->selectedItems()) {
+    rows.insert(m_imageList->row(item));
+  }
+
+  // Remove from the back so indexes stay valid
+  for (auto it = rows.rbegin(); it != rows.rend(); ++it) {
+    m_images.erase(m_images.begin() + *it);
+    if ((size_t)*it < m_ref) {
+      m_ref--;
+    }
+    else if ((size_t)*it == m_ref) {
+      m_ref = 0;
+    }
+  }
+
+  refresh();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setReference
+//
+
+void
+CDlgRegisterDiff::setReference(void)
+{
+  int row = m_imageList->currentRow();
+  if (row < 0) {
+    return;
+  }
+
+  m_ref = (size_t)row;
+  refresh();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// refresh
+//
+
+void
+CDlgRegisterDiff::refresh(void)
+{
+  if (m_ref >= m_images.size()) {
+    m_ref = 0;
+  }
+
+  std::vector<const CRegisterImage*> images;
+  for (const auto& image : m_images) {
+    images.push_back(&image);
+  }
+
+  if (images.empty() || (VSCP_ERROR_SUCCESS != m_diff.compare(images, m_ref, m_allCheck->isChecked()))) {
+    m_diff = CRegisterDiff();
+  }
+
+  fillImageList();
+  fillRegisterTable();
+  fillRemoteVariableTable();
+
+  size_t nDiff = 0;
+  for (const auto& row : m_diff.getRows()) {
+    if (row.m_diffMask) {
+      nDiff++;
+    }
+  }
+  m_summaryLabel->setText(tr("%1 image(s), %2 register(s) differ from the reference")
+                            .arg(m_images.size())
+                            .arg(nDiff));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fillImageList
+//
+
+void
+CDlgRegisterDiff::fillImageList(void)
+{
+  m_imageList->clear();
+  for (size_t i = 0; i < m_images.size(); i++) {
+    QString str = QString::fromStdString(m_images[i].getName());
+    if (i == m_ref) {
+      str = "* " + str;
+    }
+    else {
+      str += tr(" (%1 differ)").arg(m_diff.getDiffCount(i));
+    }
+    m_imageList->addItem(str);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fillRegisterTable
+//
+
+void
+CDlgRegisterDiff::fillRegisterTable(void)
+{
+  QStringList headers;
+  headers << tr("Register") << tr("Name");
+  for (size_t i = 0; i < m_images.size(); i++) {
+    headers << ((i == m_ref) ? "* " : "") + QString::fromStdString(m_images[i].getName());
+  }
+
+  const std::vector<CRegisterDiff::diffrow>& rows = m_diff.getRows();
+
+  m_regTable->setUpdatesEnabled(false);
+  m_regTable->clear();
+  m_regTable->setColumnCount(headers.size());
+  m_regTable->setHorizontalHeaderLabels(headers);
+  m_regTable->setRowCount((int)rows.size());
+
+  for (size_t r = 0; r < rows.size(); r++) {
+    const CRegisterDiff::diffrow& row = rows[r];
+
+    m_regTable->setItem((int)r,
+                        DIFF_COL_POSITION,
+                        new QTableWidgetItem(QString("%1:%2").arg(row.m_page).arg(row.m_offset)));
+
+    QString name;
+    if (nullptr != m_pmdf) {
+      CMDF_Register* preg = m_pmdf->getRegister(row.m_offset, row.m_page);
+      if (nullptr != preg) {
+        name = QString::fromStdString(preg->getName());
+      }
+    }
+    m_regTable->setItem((int)r, DIFF_COL_NAME, new QTableWidgetItem(name));
+
+    for (size_t i = 0; i < m_images.size(); i++) {
+      int value               = m_images[i].getReg(row.m_page, row.m_offset);
+      QTableWidgetItem* pitem = new QTableWidgetItem((-1 == value) ? "--" : QString::number(value));
+      pitem->setTextAlignment(Qt::AlignCenter);
+      if (-1 != value) {
+        pitem->setToolTip(QString("0x%1").arg(value, 2, 16, QChar('0')));
+      }
+      if (row.m_diffMask & (1ULL << i)) {
+        pitem->setBackground(DIFF_COLOR);
+      }
+      m_regTable->setItem((int)r, (int)(DIFF_COL_FIRST_IMAGE + i), pitem);
+    }
+  }
+
+  m_regTable->resizeColumnsToContents();
+  m_regTable->setUpdatesEnabled(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fillRemoteVariableTable
+//
+
+void
+CDlgRegisterDiff::fillRemoteVariableTable(void)
+{
+  QStringList headers;
+  headers << tr("Position") << tr("Name");
+  for (size_t i = 0; i < m_images.size(); i++) {
+    headers << ((i == m_ref) ? "* " : "") + QString::fromStdString(m_images[i].getName());
+  }
+
+  m_rvTable->setUpdatesEnabled(false);
+  m_rvTable->clear();
+  m_rvTable->setColumnCount(headers.size());
+  m_rvTable->setHorizontalHeaderLabels(headers);
+  m_rvTable->setRowCount(0);
+
+  std::deque<CMDF_RemoteVariable*>* pList = (nullptr != m_pmdf) ? m_pmdf->getRemoteVariableList() : nullptr;
+  if ((nullptr == pList) || m_images.empty()) {
+    m_rvTable->setUpdatesEnabled(true);
+    return;
+  }
+
+  // Each image as a register set so remote variables are decoded the same
+  // way as in the configuration window (bit position, width, byte order)
+  std::deque<CUserRegisters> decoders(m_images.size());
+  for (size_t i = 0; i < m_images.size(); i++) {
+    m_images[i].toUserRegisters(decoders[i]);
+  }
+
+  // Rows from the register diff keyed on page:offset so that a remote
+  // variable can be checked without decoding it for every image
+  std::map<uint32_t, uint64_t> diffs;
+  for (const auto& row : m_diff.getRows()) {
+    diffs[((uint32_t)row.m_page << 8) + row.m_offset] = row.m_diffMask;
+  }
+
+  for (auto prv : *pList) {
+
+    uint16_t size = prv->getTypeByteCount();
+    if (0 == size) {
+      size = 1;
+    }
+
+    // Combined difference over all registers of the variable
+    bool bFound   = false;
+    uint64_t mask = 0;
+    for (uint32_t pos = prv->getOffset(); pos < (uint32_t)(prv->getOffset() + size); pos++) {
+      auto it = diffs.find(((uint32_t)prv->getPage() << 8) + pos);
+      if (it != diffs.end()) {
+        bFound = true;
+        mask |= it->second;
+      }
+    }
+    if (!bFound) {
+      continue;
+    }
+
+    int r = m_rvTable->rowCount();
+    m_rvTable->insertRow(r);
+    m_rvTable->setItem(r,
+                       DIFF_COL_POSITION,
+                       new QTableWidgetItem(QString("%1:%2").arg(prv->getPage()).arg(prv->getOffset())));
+    QTableWidgetItem* pnameItem = new QTableWidgetItem(QString::fromStdString(prv->getName()));
+    pnameItem->setToolTip(QString::fromStdString(prv->getTypeString()));
+    m_rvTable->setItem(r, DIFF_COL_NAME, pnameItem);
+
+    for (size_t i = 0; i < m_images.size(); i++) {
+      bool bComplete = true;
+      for (uint16_t j = 0; j < size; j++) {
+        if (-1 == m_images[i].getReg(prv->getPage(), (uint8_t)(prv->getOffset() + j))) {
+          bComplete = false;
+          break;
+        }
+      }
+
+      QString str = "--";
+      std::string strValue;
+      if (bComplete &&
+          (VSCP_ERROR_SUCCESS == decoders[i].remoteVarFromRegToString(*prv, strValue, FORMAT_REMOTEVAR_DECIMAL))) {
+        str = QString::fromStdString(strValue);
+      }
+      QTableWidgetItem* pitem = new QTableWidgetItem(str);
+      pitem->setTextAlignment(Qt::AlignCenter);
+      if (mask & (1ULL << i)) {
+        pitem->setBackground(DIFF_COLOR);
+      }
+      m_rvTable->setItem(r, (int)(DIFF_COL_FIRST_IMAGE + i), pitem);
+    }
+  }
+
+  m_rvTable->resizeColumnsToContents();
+  m_rvTable->setUpdatesEnabled(true);
+}
@@ -0,0 +1,125 @@
+// cdlgregisterdiff.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CDLGREGISTERDIFF_H
+#define CDLGREGISTERDIFF_H
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <guid.h>
+#include <mdf.h>
+#include <vscp-client-base.h>
+
+#include "registerdiff.h"
+
+#include <QDialog>
+
+#include <deque>
+
+QT_BEGIN_NAMESPACE
+class QCheckBox;
+class QLabel;
+class QListWidget;
+class QPushButton;
+class QTableWidget;
+class QTabWidget;
+QT_END_NAMESPACE
+
+/*!
+  Compare register images from nodes and saved register files.
+
+  Images are shown as columns in a matrix with one row per register that
+  differs from the reference image. Register names and remote variable
+  values are taken from the MDF of the node the window was opened for.
+*/
+
+class CDlgRegisterDiff : public QDialog {
+  Q_OBJECT
+
+public:
+  /*!
+    @param parent Parent widget
+    @param client Connected client or nullptr if not connected
+    @param guidInterface Interface nodes are on
+    @param pmdf MDF used to annotate registers
+    @param timeout Response timeout in milliseconds
+  */
+  CDlgRegisterDiff(QWidget* parent,
+                   CVscpClient* client,
+                   const cguid& guidInterface,
+                   CMDF* pmdf,
+                   uint32_t timeout);
+  ~CDlgRegisterDiff();
+
+  /*!
+    Add an image to compare
+    @param image Image to add
+    @return True if added, false if there are too many images
+  */
+  bool addImage(const CRegisterImage& image);
+
+public slots:
+  /// Compare all images and fill the matrix
+  void refresh(void);
+
+private slots:
+  void addNodes(void);
+  void addFile(void);
+  void removeImage(void);
+  void setReference(void);
+
+private:
+  void setupUi(void);
+  void fillImageList(void);
+  void fillRegisterTable(void);
+  void fillRemoteVariableTable(void);
+
+  CVscpClient* m_vscpClient;
+  cguid m_guidInterface;
+  CMDF* m_pmdf;
+  uint32_t m_timeout;
+
+  std::deque<CRegisterImage> m_images;
+  size_t m_ref;
+  CRegisterDiff m_diff;
+
+  QListWidget* m_imageList;
+  QPushButton* m_addNodesButton;
+  QPushButton* m_addFileButton;
+  QPushButton* m_removeButton;
+  QPushButton* m_refButton;
+  QCheckBox* m_allCheck;
+  QTabWidget* m_tabs;
+  QTableWidget* m_regTable;
+  QTableWidget* m_rvTable;
+  QLabel* m_summaryLabel;
+};
+
+#endif // CDLGREGISTERDIFF_H
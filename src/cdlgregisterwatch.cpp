@@ -0,0 +1,305 @@
+// cdlgregisterwatch.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "vscpworks.h"
+
+#include "cdlgregisterwatch.h"
+
+#include <QAbstractItemView>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QTableWidgetItem>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QtCharts/QChart>
+#include <QtCharts/QChartView>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QValueAxis>
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+// Value table columns
+enum {
+  WATCH_COL_REGISTER = 0,
+  WATCH_COL_NAME,
+  WATCH_COL_VALUE,
+  WATCH_COL_MIN,
+  WATCH_COL_MAX,
+  WATCH_COL_SAMPLES,
+  WATCH_COL_COUNT
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CTor
+//
+
+CDlgRegisterWatch::CDlgRegisterWatch(QWidget* parent,
+                                     CVscpClient* client,
+                                     const cguid& guidInterface,
+                                     uint8_t nodeid,
+                                     const std::deque<watchreg>& regs,
+                                     uint32_t timeout)
+  : QDialog(parent)
+  , m_watch(*client, guidInterface, nodeid, timeout)
+  , m_regs(regs)
+  , m_nodeid(nodeid)
+  , m_chart(nullptr)
+  , m_axisX(nullptr)
+  , m_axisY(nullptr)
+{
+  setWindowTitle(tr("Register watch - node %1").arg(nodeid));
+  resize(900, 700);
+
+  for (auto const& reg : m_regs) {
+    m_watch.addRegister(reg.m_page, reg.m_offset);
+  }
+
+  setupUi();
+
+  m_refreshTimer = new QTimer(this);
+  connect(m_refreshTimer, &QTimer::timeout, this, &CDlgRegisterWatch::onRefresh);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTor
+//
+
+CDlgRegisterWatch::~CDlgRegisterWatch()
+{
+  m_refreshTimer->stop();
+  m_watch.stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setupUi
+//
+
+void
+CDlgRegisterWatch::setupUi(void)
+{
+  QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+  QHBoxLayout* ctrlLayout = new QHBoxLayout();
+
+  ctrlLayout->addWidget(new QLabel(tr("Rate (Hz):"), this));
+  m_rateSpin = new QDoubleSpinBox(this);
+  m_rateSpin->setRange(0.1, 200);
+  m_rateSpin->setDecimals(1);
+  m_rateSpin->setValue(10);
+  m_rateSpin->setToolTip(tr("Number of times per second all watched registers are read"));
+  ctrlLayout->addWidget(m_rateSpin);
+
+  ctrlLayout->addWidget(new QLabel(tr("Link (kbit/s):"), this));
+  m_bitrateSpin = new QSpinBox(this);
+  m_bitrateSpin->setRange(10, 1000);
+  m_bitrateSpin->setValue(125);
+  m_bitrateSpin->setToolTip(tr("Bitrate of the bus the node is on. Used to estimate link utilization."));
+  ctrlLayout->addWidget(m_bitrateSpin);
+
+  ctrlLayout->addWidget(new QLabel(tr("History (s):"), this));
+  m_historySpin = new QSpinBox(this);
+  m_historySpin->setRange(5, 3600);
+  m_historySpin->setValue(30);
+  ctrlLayout->addWidget(m_historySpin);
+
+  ctrlLayout->addStretch(1);
+  m_runButton = new QPushButton(tr("Start"), this);
+  ctrlLayout->addWidget(m_runButton);
+  mainLayout->addLayout(ctrlLayout);
+
+  m_chart = new QChart();
+  m_chart->setTitle(tr("Register values"));
+  m_axisX = new QValueAxis();
+  m_axisX->setTitleText(tr("Time (s)"));
+  m_axisX->setRange(0, m_historySpin->value());
+  m_chart->addAxis(m_axisX, Qt::AlignBottom);
+  m_axisY = new QValueAxis();
+  m_axisY->setTitleText(tr("Value"));
+  m_axisY->setRange(0, 255);
+  m_chart->addAxis(m_axisY, Qt::AlignLeft);
+
+  for (auto const& reg : m_regs) {
+    QLineSeries* series = new QLineSeries();
+    series->setName(QString("%1:%2 %3").arg(reg.m_page).arg(reg.m_offset).arg(reg.m_name));
+    m_chart->addSeries(series);
+    series->attachAxis(m_axisX);
+    series->attachAxis(m_axisY);
+    m_series.push_back(series);
+  }
+
+  QChartView* chartView = new QChartView(m_chart, this);
+  chartView->setRenderHint(QPainter::Antialiasing);
+  chartView->setMinimumHeight(320);
+  mainLayout->addWidget(chartView, 2);
+
+  m_valueTable = new QTableWidget(this);
+  m_valueTable->setColumnCount(WATCH_COL_COUNT);
+  m_valueTable->setHorizontalHeaderLabels(QStringList() << tr("Register") << tr("Name") << tr("Value")
+                                                        << tr("Min") << tr("Max") << tr("Samples"));
+  m_valueTable->horizontalHeader()->setSectionResizeMode(WATCH_COL_NAME, QHeaderView::Stretch);
+  m_valueTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_valueTable->verticalHeader()->setVisible(false);
+  m_valueTable->setRowCount((int)m_regs.size());
+  for (int row = 0; row < (int)m_regs.size(); row++) {
+    for (int col = 0; col < WATCH_COL_COUNT; col++) {
+      m_valueTable->setItem(row, col, new QTableWidgetItem());
+    }
+    m_valueTable->item(row, WATCH_COL_REGISTER)->setText(QString("%1:%2").arg(m_regs[row].m_page).arg(m_regs[row].m_offset));
+    m_valueTable->item(row, WATCH_COL_NAME)->setText(m_regs[row].m_name);
+  }
+  mainLayout->addWidget(m_valueTable, 1);
+
+  m_statsLabel = new QLabel(tr("%1 registers in %2 read requests per cycle")
+                              .arg(m_regs.size())
+                              .arg(m_watch.getPlan().size()),
+                            this);
+  mainLayout->addWidget(m_statsLabel);
+
+  connect(m_runButton, &QPushButton::clicked, this, &CDlgRegisterWatch::toggleRun);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// toggleRun
+//
+
+void
+CDlgRegisterWatch::toggleRun(void)
+{
+  if (m_watch.isRunning()) {
+    m_watch.stop();
+    m_refreshTimer->stop();
+    onRefresh();
+    m_runButton->setText(tr("Start"));
+    m_rateSpin->setEnabled(true);
+    m_bitrateSpin->setEnabled(true);
+    return;
+  }
+
+  int rv = m_watch.start(m_rateSpin->value(), m_bitrateSpin->value() * 1000);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    spdlog::error("Register watch: Failed to start polling rv={}", rv);
+    QMessageBox::warning(this, tr(APPNAME), tr("Failed to start polling (%1).").arg(rv));
+    return;
+  }
+
+  m_runButton->setText(tr("Stop"));
+  m_rateSpin->setEnabled(false);
+  m_bitrateSpin->setEnabled(false);
+
+  // Plot at a fixed rate independent of the poll rate
+  m_refreshTimer->start(100);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onRefresh
+//
+
+void
+CDlgRegisterWatch::onRefresh(void)
+{
+  std::vector<CRegisterWatch::sample> samples;
+  double tmax = 0;
+  int ymin    = 255;
+  int ymax    = 0;
+
+  for (int row = 0; row < (int)m_regs.size(); row++) {
+    m_watch.getSamples(m_regs[row].m_page, m_regs[row].m_offset, samples);
+
+    QList<QPointF> points;
+    points.reserve((int)samples.size());
+    int vmin = 255;
+    int vmax = 0;
+    for (auto const& s : samples) {
+      points.append(QPointF(s.m_time, s.m_value));
+      vmin = std::min(vmin, (int)s.m_value);
+      vmax = std::max(vmax, (int)s.m_value);
+    }
+    m_series[row]->replace(points);
+
+    m_valueTable->item(row, WATCH_COL_SAMPLES)->setText(QString::number(samples.size()));
+    if (samples.empty()) {
+      continue;
+    }
+
+    tmax = std::max(tmax, samples.back().m_time);
+    ymin = std::min(ymin, vmin);
+    ymax = std::max(ymax, vmax);
+
+    m_valueTable->item(row, WATCH_COL_VALUE)->setText(QString::number(samples.back().m_value));
+    m_valueTable->item(row, WATCH_COL_MIN)->setText(QString::number(vmin));
+    m_valueTable->item(row, WATCH_COL_MAX)->setText(QString::number(vmax));
+  }
+
+  // Scroll time axis and fit value axis to what is visible
+  double history = m_historySpin->value();
+  m_axisX->setRange(std::max(0.0, tmax - history), std::max(history, tmax));
+  if (ymin <= ymax) {
+    m_axisY->setRange(std::max(0, ymin - 1), std::min(255, ymax + 1));
+  }
+
+  CRegisterWatch::watchstats stats = m_watch.getStats();
+  m_statsLabel->setText(tr("Poll rate %1/%2 Hz, %3 frames/s, link utilization ~%4% (overruns %5, timeouts %6)")
+                          .arg(stats.m_pollRate, 0, 'f', 1)
+                          .arg(stats.m_targetRate, 0, 'f', 1)
+                          .arg(stats.m_frameRate, 0, 'f', 0)
+                          .arg(stats.m_utilization, 0, 'f', 1)
+                          .arg(stats.m_overruns)
+                          .arg(stats.m_timeouts));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reject
+//
+
+void
+CDlgRegisterWatch::reject(void)
+{
+  m_refreshTimer->stop();
+  m_watch.stop();
+  QDialog::reject();
+}
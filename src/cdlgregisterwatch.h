@@ -0,0 +1,125 @@
+// cdlgregisterwatch.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CDLGREGISTERWATCH_H
+#define CDLGREGISTERWATCH_H
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <guid.h>
+#include <vscp-client-base.h>
+
+#include "registerwatch.h"
+
+#include <QDialog>
+
+#include <deque>
+
+QT_BEGIN_NAMESPACE
+class QChart;
+class QDoubleSpinBox;
+class QLabel;
+class QLineSeries;
+class QPushButton;
+class QSpinBox;
+class QTableWidget;
+class QTimer;
+class QValueAxis;
+QT_END_NAMESPACE
+
+/*!
+  Watch a few registers on a node change in real time.
+
+  The registers are polled by a CRegisterWatch worker and plotted
+  with one line per register. Current, min and max values and the
+  achieved poll rate and link utilization are shown while running.
+*/
+
+class CDlgRegisterWatch : public QDialog {
+  Q_OBJECT
+
+public:
+  /// A register to watch
+  struct watchreg {
+    uint16_t m_page;
+    uint8_t m_offset;
+    QString m_name;
+  };
+
+  /*!
+    @param parent Parent widget
+    @param client Connected client to use
+    @param guidInterface Interface the node is on
+    @param nodeid Node to watch
+    @param regs Registers to watch
+    @param timeout Response timeout in milliseconds
+  */
+  CDlgRegisterWatch(QWidget* parent,
+                    CVscpClient* client,
+                    const cguid& guidInterface,
+                    uint8_t nodeid,
+                    const std::deque<watchreg>& regs,
+                    uint32_t timeout);
+  ~CDlgRegisterWatch();
+
+public slots:
+  /// Start or stop polling
+  void toggleRun(void);
+
+  /// Close the dialog (stops polling)
+  void reject(void) override;
+
+private slots:
+  /// Refresh plot, values and statistics
+  void onRefresh(void);
+
+private:
+  void setupUi(void);
+
+  CRegisterWatch m_watch;
+  std::deque<watchreg> m_regs;
+  uint8_t m_nodeid;
+
+  QTimer* m_refreshTimer;
+
+  QDoubleSpinBox* m_rateSpin;
+  QSpinBox* m_bitrateSpin;
+  QSpinBox* m_historySpin;
+  QPushButton* m_runButton;
+  QTableWidget* m_valueTable;
+  QLabel* m_statsLabel;
+
+  QChart* m_chart;
+  std::deque<QLineSeries*> m_series;
+  QValueAxis* m_axisX;
+  QValueAxis* m_axisY;
+};
+
+#endif // CDLGREGISTERWATCH_H
@@ -146,130 +146,6 @@ formatIsoDate(const std::string& dateValue)
   return date.isValid() ? date.toString(Qt::ISODate) : source;
 }
 
-QString
-normalizeDateString(const QString& sourceValue)
-{
-  const QString source = sourceValue.trimmed();
-  if (source.isEmpty()) {
-    return source;
-  }
-
-  QDate date = QDate::fromString(source, Qt::ISODate);
-  if (date.isValid()) {
-    return date.toString(Qt::ISODate);
-  }
-
-  const QStringList formats = { "yyyy-MM-dd",
-                                "yy-MM-dd",
-                                "dd/MM/yyyy",
-                                "d/M/yyyy",
-                                "dd/MM/yy",
-                                "d/M/yy",
-                                "MM/dd/yyyy",
-                                "M/d/yyyy",
-                                "MM/dd/yy",
-                                "M/d/yy" };
-
-  for (const auto &fmt : formats) {
-    date = QDate::fromString(source, fmt);
-    if (date.isValid()) {
-      return date.toString(Qt::ISODate);
-    }
-  }
-
-  return source;
-}
-
-void
-normalizeJsonDateFields(json& node)
-{
-  if (node.is_object()) {
-    for (auto& item : node.items()) {
-      if (item.value().is_string()) {
-        const std::string& key = item.key();
-        if (("date" == key) || ("changed" == key)) {
-          const QString normalized = normalizeDateString(QString::fromStdString(item.value().get<std::string>()));
-          item.value()             = normalized.toStdString();
-        }
-      }
-
-      normalizeJsonDateFields(item.value());
-    }
-  }
-  else if (node.is_array()) {
-    for (auto& item : node) {
-      normalizeJsonDateFields(item);
-    }
-  }
-}
-
-bool
-normalizeSavedXmlDateFields(const QString& path)
-{
-  QFile file(path);
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    QMessageBox::warning(nullptr,
-                         APPNAME,
-                         QObject::tr("Failed to normalize MDF date fields.\n\nWhere: %1\nWhat: Unable to read saved XML.")
-                           .arg(path));
-    return false;
-  }
-
-  const QString originalContent = QString::fromUtf8(file.readAll());
-  file.close();
-
-  QString content        = originalContent;
-  QString updatedContent = content;
-  int delta              = 0;
-  const QRegularExpression attrDateRe(R"re(date\s*=\s*"([^"]*)")re");
-  auto attrIt = attrDateRe.globalMatch(content);
-  while (attrIt.hasNext()) {
-    const QRegularExpressionMatch match = attrIt.next();
-    const QString current               = match.captured(1);
-    const QString normalized            = normalizeDateString(current);
-    if (current == normalized) {
-      continue;
-    }
-
-    const int start = match.capturedStart(1) + delta;
-    updatedContent.replace(start, current.length(), normalized);
-    delta += normalized.length() - current.length();
-  }
-
-  content = updatedContent;
-  delta   = 0;
-  const QRegularExpression changedDateRe(R"(<changed>\s*([^<]*)\s*</changed>)");
-  auto changedIt = changedDateRe.globalMatch(content);
-  while (changedIt.hasNext()) {
-    const QRegularExpressionMatch match = changedIt.next();
-    const QString current               = match.captured(1).trimmed();
-    const QString normalized            = normalizeDateString(current);
-    if (current == normalized) {
-      continue;
-    }
-
-    const int start = match.capturedStart(1) + delta;
-    const int len   = match.capturedLength(1);
-    updatedContent.replace(start, len, normalized);
-    delta += normalized.length() - len;
-  }
-
-  if (updatedContent == originalContent) {
-    return true;
-  }
-
-  if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
-    QMessageBox::warning(nullptr,
-                         APPNAME,
-                         QObject::tr("Failed to normalize MDF date fields.\n\nWhere: %1\nWhat: Unable to write updated XML.")
-                           .arg(path));
-    return false;
-  }
-  file.write(updatedContent.toUtf8());
-  file.close();
-  return true;
-}
-
 } // anonymous namespace
 
 // ----------------------------------------------------------------------------
@@ -280,6 +156,7 @@ QMdfTreeWidgetItem::QMdfTreeWidgetItem(const QString& text)
   m_objType    = mdf_type_unknown;
   m_fieldIndex = 0;
   m_pMdfRecord = nullptr;
+  m_bPending   = false;
 }
 
 QMdfTreeWidgetItem::QMdfTreeWidgetItem(mdf_record_type objtype)
@@ -288,6 +165,7 @@ QMdfTreeWidgetItem::QMdfTreeWidgetItem(mdf_record_type objtype)
   m_objType    = objtype;
   m_fieldIndex = 0;
   m_pMdfRecord = nullptr;
+  m_bPending   = false;
 }
 
 QMdfTreeWidgetItem::QMdfTreeWidgetItem(CMDF_Object* pobj, mdf_record_type objtype, uint16_t index)
@@ -296,6 +174,7 @@ QMdfTreeWidgetItem::QMdfTreeWidgetItem(CMDF_Object* pobj, mdf_record_type objtyp
   m_objType    = objtype;
   m_fieldIndex = index;
   m_pMdfRecord = pobj;
+  m_bPending   = false;
 }
 
 QMdfTreeWidgetItem::QMdfTreeWidgetItem(QTreeWidgetItem* parent, mdf_record_type objtype)
@@ -304,6 +183,7 @@ QMdfTreeWidgetItem::QMdfTreeWidgetItem(QTreeWidgetItem* parent, mdf_record_type
   m_objType    = objtype;
   m_fieldIndex = 0;
   m_pMdfRecord = nullptr;
+  m_bPending   = false;
 }
 
 QMdfTreeWidgetItem::QMdfTreeWidgetItem(QTreeWidgetItem* parent,
@@ -315,6 +195,7 @@ QMdfTreeWidgetItem::QMdfTreeWidgetItem(QTreeWidgetItem* parent,
   m_objType    = objtype;
   m_fieldIndex = index;
   m_pMdfRecord = pobj;
+  m_bPending   = false;
 }
 
 QMdfTreeWidgetItem::~QMdfTreeWidgetItem()
@@ -322,6 +203,18 @@ QMdfTreeWidgetItem::~QMdfTreeWidgetItem()
   ;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// setPending
+//
+
+void
+QMdfTreeWidgetItem::setPending(bool bPending)
+{
+  m_bPending = bPending;
+  setChildIndicatorPolicy(bPending ? QTreeWidgetItem::ShowIndicator
+                                   : QTreeWidgetItem::DontShowIndicatorWhenChildless);
+}
+
 // ----------------------------------------------------------------------------
 
 // ----------------------------------------------------------------------------
@@ -349,6 +242,22 @@ CFrmMdf::CFrmMdf(QWidget* parent, const char* path)
   ui->treeMDF->installEventFilter(this);
   ui->treeMDF->viewport()->installEventFilter(this);
 
+  // Problems found by the lint are listed below the tree
+  m_treeProblems = new QTreeWidget(this);
+  m_treeProblems->setColumnCount(1);
+  m_treeProblems->setHeaderLabels(QStringList() << tr("Problems"));
+  m_treeProblems->setRootIsDecorated(false);
+  m_treeProblems->setWordWrap(true);
+
+  QSplitter* splitter = new QSplitter(Qt::Vertical, this);
+  int idxTree         = ui->horizontalLayout->indexOf(ui->treeMDF);
+  ui->horizontalLayout->removeWidget(ui->treeMDF);
+  splitter->addWidget(ui->treeMDF);
+  splitter->addWidget(m_treeProblems);
+  splitter->setStretchFactor(0, 4);
+  splitter->setStretchFactor(1, 1);
+  ui->horizontalLayout->insertWidget(idxTree, splitter);
+
   vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
   spdlog::debug(std::string(tr("Node configuration module opened").toStdString()));
 
@@ -414,6 +323,27 @@ CFrmMdf::CFrmMdf(QWidget* parent, const char* path)
           this,
           &CFrmMdf::onItemDoubleClicked);
 
+  // Sub items for registers, remote variables and events are
+  // rendered first when they are expanded.
+  connect(ui->treeMDF,
+          &QTreeWidget::itemExpanded,
+          this,
+          &CFrmMdf::onItemExpanded);
+
+  // Edits report what changed
+  connect(this, &CFrmMdf::mdfChanged, this, &CFrmMdf::onMdfChanged);
+
+  // Lint is run when no edit has been made for a while
+  m_lintTimer = new QTimer(this);
+  m_lintTimer->setSingleShot(true);
+  m_lintTimer->setInterval(500);
+  connect(m_lintTimer, &QTimer::timeout, this, &CFrmMdf::startLint);
+
+  connect(m_treeProblems,
+          &QTreeWidget::itemActivated,
+          this,
+          &CFrmMdf::onProblemActivated);
+
   m_autoSaveTimer = new QTimer(this);
   connect(m_autoSaveTimer, &QTimer::timeout, this, &CFrmMdf::onAutoSaveTimeout);
 
@@ -433,6 +363,10 @@ CFrmMdf::CFrmMdf(QWidget* parent, const char* path)
 
 CFrmMdf::~CFrmMdf()
 {
+  m_lint.cancel();
+  m_lint.wait();
+  m_saver.wait();
+
   m_bar = nullptr;
 
   m_headModule             = nullptr;
@@ -480,6 +414,19 @@ CFrmMdf::eventFilter(QObject* watched, QEvent* event)
     }
   }
 
+  // First repaint after an edit - report edit-to-repaint latency
+  if ((watched == ui->treeMDF->viewport()) &&
+      (QEvent::Paint == event->type()) &&
+      m_editTimer.isValid()) {
+    bool rv = QMainWindow::eventFilter(watched, event);
+    qint64 elapsed = m_editTimer.nsecsElapsed();
+    m_editTimer.invalidate();
+    spdlog::debug("MDF edit: tree updated in {0:.3f} ms ({1} registers)",
+                  elapsed / 1000000.0,
+                  m_mdf.getRegisterObjList()->size());
+    return rv;
+  }
+
   return QMainWindow::eventFilter(watched, event);
 }
 
@@ -553,7 +500,8 @@ CFrmMdf::openMdfFromPath(const QString& path)
   m_labelOpenedFile->setText(tr("File: %1").arg(path));
   addRecentSavedFile(path);
   loadMdf();
-  m_bChanged = false;
+  m_bChanged         = false;
+  m_savedChangeCount = m_changeCount;
 
   return true;
 }
@@ -621,12 +569,14 @@ CFrmMdf::saveMdf()
 bool
 CFrmMdf::saveMdfToPath(const QString& path, mdf_format format)
 {
-  if (!createBackupForPath(path)) {
-    return false;
-  }
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  // Let a running autosave finish first. It uses the same files.
+  m_saver.wait();
 
+  CMdfSaver::savejob job;
   const std::string pathUtf8 = path.toUtf8().toStdString();
-  const int rv               = m_mdf.save(pathUtf8, format);
+  int rv                     = CMdfSaver::prepare(m_mdf, pathUtf8, format, job);
   if (VSCP_ERROR_SUCCESS != rv) {
     spdlog::error("Failed to save MDF file {0}", pathUtf8);
     QMessageBox::warning(this,
@@ -636,240 +586,75 @@ CFrmMdf::saveMdfToPath(const QString& path, mdf_format format)
                            .arg(rv));
     return false;
   }
+  job.m_bCumulative = pworks->m_mdfCumulativeBackups;
+  job.m_maxBackups  = pworks->m_mdfMaxBackups;
+  job.m_changeCount = m_changeCount;
 
-  if ((MDF_FORMAT_JSON == format) && !enrichSavedJsonWithDecisionMatrix(path)) {
-    return false;
-  }
-  if ((MDF_FORMAT_XML == format) && !normalizeSavedXmlDateFields(path)) {
+  std::string strError;
+  rv = CMdfSaver::finish(job, strError);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    spdlog::error("Failed to save MDF file {0}: {1}", pathUtf8, strError);
+    QMessageBox::warning(this,
+                         APPNAME,
+                         tr("Failed to save MDF file.\n\nWhere: %1\nWhat: %2")
+                           .arg(path)
+                           .arg(QString::fromStdString(strError)));
     return false;
   }
 
   m_last_path = path;
   m_labelOpenedFile->setText(tr("File: %1").arg(path));
   ui->statusbar->showMessage(tr("Saved %1").arg(path), 2000);
-  m_bChanged = false;
+  m_savedChangeCount = job.m_changeCount;
+  m_bChanged         = false;
   addRecentSavedFile(path);
   return true;
 }
 
-bool
-CFrmMdf::createBackupForPath(const QString& path)
+void
+CFrmMdf::onAutoSaveTimeout()
 {
-  if (!QFile::exists(path)) {
-    return true;
-  }
-
   vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
-  if (!pworks->m_mdfCumulativeBackups) {
-    const QString backupPath = path + ".bak";
-    if (QFile::exists(backupPath) && !QFile::remove(backupPath)) {
-      QMessageBox::warning(this,
-                           APPNAME,
-                           tr("Failed to create backup.\n\nWhere: %1\nWhat: Unable to remove existing backup.")
-                             .arg(backupPath));
-      return false;
-    }
 
-    if (!QFile::copy(path, backupPath)) {
-      QMessageBox::warning(this,
-                           APPNAME,
-                           tr("Failed to create backup.\n\nWhere: %1\nWhat: Unable to copy current file.")
-                             .arg(path));
-      return false;
-    }
-
-    return true;
-  }
-
-  QFileInfo fi(path);
-  const QString backupPath = QString("%1/%2.bak.%3")
-                               .arg(fi.absolutePath(),
-                                    fi.fileName(),
-                                    QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz"));
-
-  if (!QFile::copy(path, backupPath)) {
-    QMessageBox::warning(this,
-                         APPNAME,
-                         tr("Failed to create cumulative backup.\n\nWhere: %1\nWhat: Unable to copy current file.")
-                           .arg(backupPath));
-    return false;
-  }
-
-  if (pworks->m_mdfMaxBackups > 0) {
-    QDir dir(fi.absolutePath());
-    const QStringList entries = dir.entryList(QStringList() << QString("%1.bak.*").arg(fi.fileName()),
-                                              QDir::Files,
-                                              QDir::Name);
-    const int maxBackups = static_cast<int>(pworks->m_mdfMaxBackups);
-    const int removeCount = entries.size() - maxBackups;
-    for (int i = 0; i < removeCount; ++i) {
-      dir.remove(entries.at(i));
-    }
-  }
-
-  return true;
-}
-
-bool
-CFrmMdf::enrichSavedJsonWithDecisionMatrix(const QString& path)
-{
-  QFile file(path);
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    QMessageBox::warning(this,
-                         APPNAME,
-                         tr("Failed to save MDF file.\n\nWhere: %1\nWhat: Unable to read saved JSON.")
-                           .arg(path));
-    return false;
-  }
-
-  json root;
-  try {
-    root = json::parse(file.readAll().toStdString());
-  }
-  catch (const std::exception &ex) {
-    QMessageBox::warning(this,
-                         APPNAME,
-                         tr("Failed to update JSON MDF with decision matrix data.\n\nWhere: %1\nWhat: %2")
-                           .arg(path)
-                           .arg(QString::fromUtf8(ex.what())));
-    return false;
-  }
-
-  if (!root.contains("module") || !root["module"].is_object()) {
-    QMessageBox::warning(this,
-                         APPNAME,
-                         tr("Failed to update JSON MDF with decision matrix data.\n\nWhere: %1\nWhat: Missing 'module' object.")
-                           .arg(path));
-    return false;
+  if (m_last_path.isEmpty()) {
+    return;
   }
 
-  json &module = root["module"];
-  CMDF_DecisionMatrix* pdm = m_mdf.getDM();
-  if (nullptr != pdm) {
-    json jdm;
-    jdm["level"]        = pdm->getLevel();
-    jdm["start-page"]   = pdm->getStartPage();
-    jdm["start-offset"] = pdm->getStartOffset();
-    jdm["rowcnt"]       = pdm->getRowCount();
-    jdm["rowsize"]      = pdm->getRowSize();
-
-    json actions = json::array();
-    std::deque<CMDF_Action*>* pActionList = pdm->getActionList();
-    if (nullptr != pActionList) {
-      for (CMDF_Action* pAction : *pActionList) {
-        if (nullptr == pAction) {
-          continue;
-        }
-
-        json jaction;
-        jaction["name"] = pAction->getName();
-        jaction["code"] = pAction->getCode();
-
-        json params = json::array();
-        std::deque<CMDF_ActionParameter*>* pParams = pAction->getListActionParameter();
-        if (nullptr != pParams) {
-          for (CMDF_ActionParameter* pParam : *pParams) {
-            if (nullptr == pParam) {
-              continue;
-            }
-
-            json jparam;
-            jparam["name"]   = pParam->getName();
-            jparam["offset"] = pParam->getOffset();
-            jparam["min"]    = pParam->getMin();
-            jparam["max"]    = pParam->getMax();
-
-            json bits = json::array();
-            std::deque<CMDF_Bit*>* pBits = pParam->getListBits();
-            if (nullptr != pBits) {
-              for (CMDF_Bit* pBit : *pBits) {
-                if (nullptr == pBit) {
-                  continue;
-                }
-                json jbit;
-                jbit["name"]    = pBit->getName();
-                jbit["pos"]     = pBit->getPos();
-                jbit["width"]   = pBit->getWidth();
-                jbit["default"] = pBit->getDefault();
-                jbit["min"]     = pBit->getMin();
-                jbit["max"]     = pBit->getMax();
-
-                QString access;
-                if (2 & pBit->getAccess()) {
-                  access += "r";
-                }
-                if (1 & pBit->getAccess()) {
-                  access += "w";
-                }
-                jbit["access"] = access.toStdString();
-                bits.push_back(jbit);
-              }
-            }
-            if (!bits.empty()) {
-              jparam["bit"] = bits;
-            }
-
-            json values = json::array();
-            std::deque<CMDF_Value*>* pValues = pParam->getListValues();
-            if (nullptr != pValues) {
-              for (CMDF_Value* pValue : *pValues) {
-                if (nullptr == pValue) {
-                  continue;
-                }
-                json jvalue;
-                jvalue["name"]  = pValue->getName();
-                jvalue["value"] = pValue->getValue();
-                values.push_back(jvalue);
-              }
-            }
-            if (!values.empty()) {
-              jparam["valuelist"] = values;
-            }
-
-            params.push_back(jparam);
-          }
-        }
-
-        if (!params.empty()) {
-          jaction["param"] = params;
-        }
-
-        actions.push_back(jaction);
-      }
-    }
-
-    jdm["action"] = actions;
-    module["dmatrix"] = jdm;
-  }
-  else {
-    module.erase("dmatrix");
+  // Nothing changed since last save
+  if (m_changeCount == m_savedChangeCount) {
+    return;
   }
 
-  normalizeJsonDateFields(root);
-
-  file.close();
-
-  if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
-    QMessageBox::warning(this,
-                         APPNAME,
-                         tr("Failed to save MDF file.\n\nWhere: %1\nWhat: Unable to write updated JSON.")
-                           .arg(path));
-    return false;
+  // Previous autosave still running - try again next time
+  if (m_saver.isRunning()) {
+    return;
   }
-  file.write(QString::fromStdString(root.dump(2)).toUtf8());
-  file.close();
 
-  return true;
-}
-
-void
-CFrmMdf::onAutoSaveTimeout()
-{
-  if (m_last_path.isEmpty()) {
+  // Serialize here, the rest is done on a worker thread
+  CMdfSaver::savejob job;
+  const QString path = m_last_path;
+  if (VSCP_ERROR_SUCCESS != CMdfSaver::prepare(m_mdf, path.toUtf8().toStdString(), detectMdfFormatForPath(path), job)) {
+    ui->statusbar->showMessage(tr("Autosave of %1 failed").arg(path), 3000);
     return;
   }
+  job.m_bCumulative = pworks->m_mdfCumulativeBackups;
+  job.m_maxBackups  = pworks->m_mdfMaxBackups;
+  job.m_changeCount = m_changeCount;
 
-  saveMdfToPath(m_last_path, detectMdfFormatForPath(m_last_path));
+  m_saver.start(job, [this, path](const CMdfSaver::savejob& done, int rv, const std::string& strError) {
+    QMetaObject::invokeMethod(
+      this,
+      [this, path, changeCount = done.m_changeCount, rv, strError]() {
+        if (VSCP_ERROR_SUCCESS != rv) {
+          ui->statusbar->showMessage(tr("Autosave of %1 failed: %2").arg(path).arg(QString::fromStdString(strError)), 5000);
+          return;
+        }
+        m_savedChangeCount = changeCount;
+        m_bChanged         = (m_changeCount != m_savedChangeCount);
+        ui->statusbar->showMessage(tr("Autosaved %1").arg(path), 2000);
+      },
+      Qt::QueuedConnection);
+  });
 }
 
 void
@@ -1866,15 +1651,267 @@ CFrmMdf::renderRegisters(QTreeWidgetItem* pParent)
       if (nullptr == pSubItem) {
         continue;
       }
-
-      pSubItem->setText(0, QString("Register  %1 %2").arg(preg->getOffset()).arg(preg->getName().c_str()));
-      pSubItem->setData(0,
-                        Qt::UserRole,
-                        QVariant::fromValue<quintptr>(reinterpret_cast<quintptr>(preg)));
-      pItem->addChild(pSubItem);
-      renderRegisterItem(pSubItem, preg);
+
+      pSubItem->setText(0, QString("Register  %1 %2").arg(preg->getOffset()).arg(preg->getName().c_str()));
+      pSubItem->setData(0,
+                        Qt::UserRole,
+                        QVariant::fromValue<quintptr>(reinterpret_cast<quintptr>(preg)));
+      pItem->addChild(pSubItem);
+
+      // Sub items are rendered when the register is expanded
+      pSubItem->setPending(true);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// renderPendingItem
+//
+
+void
+CFrmMdf::renderPendingItem(QMdfTreeWidgetItem* pItem)
+{
+  // Check pointers
+  if (nullptr == pItem) {
+    return;
+  }
+
+  if (!pItem->isPending()) {
+    return;
+  }
+
+  // Clear first as rendering may expand the item
+  pItem->setPending(false);
+
+  switch (pItem->getObjectType()) {
+
+    case mdf_type_register_item:
+      renderRegisterItem(pItem, (CMDF_Register*)pItem->getObject());
+      break;
+
+    case mdf_type_remotevar_item:
+      renderRemoteVariableItem(pItem, (CMDF_RemoteVariable*)pItem->getObject());
+      break;
+
+    case mdf_type_event_item:
+      renderEventItem(pItem, (CMDF_Event*)pItem->getObject());
+      break;
+
+    default:
+      break;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// findRegisterPageItem
+//
+
+QMdfTreeWidgetItem*
+CFrmMdf::findRegisterPageItem(uint16_t page, bool bCreate)
+{
+  int pos = 0;
+
+  // Check pointers
+  if (nullptr == m_headRegister) {
+    return nullptr;
+  }
+
+  // Page items are sorted on page
+  for (pos = 0; pos < m_headRegister->childCount(); pos++) {
+    QMdfTreeWidgetItem* pItem = (QMdfTreeWidgetItem*)m_headRegister->child(pos);
+    if (mdf_type_register_page != pItem->getObjectType()) {
+      continue;
+    }
+    uint16_t itempage = pItem->data(0, Qt::UserRole).toUInt();
+    if (itempage == page) {
+      return pItem;
+    }
+    if (itempage > page) {
+      break;
+    }
+  }
+
+  if (!bCreate) {
+    return nullptr;
+  }
+
+  QMdfTreeWidgetItem* pItem = new QMdfTreeWidgetItem(&m_mdf, mdf_type_register_page, page);
+  if (nullptr == pItem) {
+    return nullptr;
+  }
+
+  pItem->setText(0, QString(tr("Register page: %1")).arg(page));
+  pItem->setData(0, Qt::UserRole, page); // Save page
+  m_headRegister->insertChild(pos, pItem);
+
+  return pItem;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// insertRegisterItem
+//
+
+QMdfTreeWidgetItem*
+CFrmMdf::insertRegisterItem(CMDF_Register* preg)
+{
+  int pos = 0;
+
+  // Check pointers
+  if (nullptr == preg) {
+    return nullptr;
+  }
+
+  QMdfTreeWidgetItem* pItemPage = findRegisterPageItem(preg->getPage(), true);
+  if (nullptr == pItemPage) {
+    return nullptr;
+  }
+
+  // Register items are sorted on offset
+  for (pos = 0; pos < pItemPage->childCount(); pos++) {
+    QMdfTreeWidgetItem* pItem = (QMdfTreeWidgetItem*)pItemPage->child(pos);
+    if (((CMDF_Register*)pItem->getObject())->getOffset() > preg->getOffset()) {
+      break;
+    }
+  }
+
+  QMdfTreeWidgetItem* pSubItem = new QMdfTreeWidgetItem(preg, mdf_type_register_item);
+  if (nullptr == pSubItem) {
+    return nullptr;
+  }
+
+  pSubItem->setText(0, QString("Register  %1 %2").arg(preg->getOffset()).arg(preg->getName().c_str()));
+  pSubItem->setData(0,
+                    Qt::UserRole,
+                    QVariant::fromValue<quintptr>(reinterpret_cast<quintptr>(preg)));
+  pItemPage->insertChild(pos, pSubItem);
+  pSubItem->setPending(true);
+
+  return pSubItem;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// updateRegisterItem
+//
+
+QMdfTreeWidgetItem*
+CFrmMdf::updateRegisterItem(QMdfTreeWidgetItem* pItem, CMDF_Register* preg)
+{
+  // Check pointers
+  if ((nullptr == pItem) || (nullptr == preg)) {
+    return pItem;
+  }
+
+  QMdfTreeWidgetItem* pItemPage = (QMdfTreeWidgetItem*)pItem->parent();
+  if (nullptr == pItemPage) {
+    return pItem;
+  }
+
+  bool bExpanded = pItem->isExpanded();
+  bool bPending  = pItem->isPending();
+
+  // Check if the item still is in the right place
+  int idx                   = pItemPage->indexOfChild(pItem);
+  QMdfTreeWidgetItem* pPrev = (idx > 0) ? (QMdfTreeWidgetItem*)pItemPage->child(idx - 1) : nullptr;
+  QMdfTreeWidgetItem* pNext = (QMdfTreeWidgetItem*)pItemPage->child(idx + 1);
+  bool bMove = (pItemPage->data(0, Qt::UserRole).toUInt() != preg->getPage()) ||
+               ((nullptr != pPrev) && (((CMDF_Register*)pPrev->getObject())->getOffset() > preg->getOffset())) ||
+               ((nullptr != pNext) && (((CMDF_Register*)pNext->getObject())->getOffset() < preg->getOffset()));
+
+  if (bMove) {
+    bool bSelected = (ui->treeMDF->currentItem() == pItem);
+    pItemPage->removeChild(pItem);
+    delete pItem;
+
+    // Remove page that no longer has any registers
+    if (0 == pItemPage->childCount()) {
+      m_headRegister->removeChild(pItemPage);
+      delete pItemPage;
+    }
+
+    pItem = insertRegisterItem(preg);
+    if (nullptr == pItem) {
+      return nullptr;
+    }
+
+    if (!bPending) {
+      renderPendingItem(pItem);
+    }
+    if (bSelected) {
+      ui->treeMDF->setCurrentItem(pItem);
+    }
+  }
+  else {
+    pItem->setText(0, QString("Register  %1 %2").arg(preg->getOffset()).arg(preg->getName().c_str()));
+
+    // Only render sub items again if they has been rendered before
+    if (!bPending) {
+      QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
+      // Remove children
+      for (qsizetype i = 0; i < childrenList.size(); ++i) {
+        QMdfTreeWidgetItem* item = (QMdfTreeWidgetItem*)childrenList.at(i);
+        delete item;
+      }
+      childrenList.clear();
+      renderRegisterItem(pItem, preg);
+    }
+  }
+
+  pItem->setExpanded(bExpanded);
+
+  return pItem;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// findTreeItem
+//
+
+QMdfTreeWidgetItem*
+CFrmMdf::findTreeItem(CMDF_Object* pobj, mdf_record_type type)
+{
+  QMdfTreeWidgetItem* pHead = nullptr;
+
+  switch (type) {
+
+    case mdf_type_register_item:
+      pHead = m_headRegister;
+      break;
+
+    case mdf_type_remotevar_item:
+      pHead = m_headRemoteVariabel;
+      break;
+
+    case mdf_type_decision_matrix:
+      return m_headDecisionMatrix;
+
+    case mdf_type_event_item:
+      pHead = m_headEvent;
+      break;
+
+    default:
+      return nullptr;
+  }
+
+  if (nullptr == pHead) {
+    return nullptr;
+  }
+
+  // Registers are one level further down below their page
+  for (int i = 0; i < pHead->childCount(); i++) {
+    QMdfTreeWidgetItem* pItem = (QMdfTreeWidgetItem*)pHead->child(i);
+    if ((type == pItem->getObjectType()) && (pobj == pItem->getObject())) {
+      return pItem;
+    }
+    if (mdf_type_register_page == pItem->getObjectType()) {
+      for (int j = 0; j < pItem->childCount(); j++) {
+        QMdfTreeWidgetItem* pSubItem = (QMdfTreeWidgetItem*)pItem->child(j);
+        if (pobj == pSubItem->getObject()) {
+          return pSubItem;
+        }
+      }
     }
   }
+
+  return nullptr;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1986,6 +2023,39 @@ CFrmMdf::renderRemoteVariableItem(QTreeWidgetItem* pParent, CMDF_RemoteVariable*
   renderInfoUrlItems(pParent, prvar, prvar->getMapInfoUrl());
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// updateRemoteVariableItem
+//
+
+void
+CFrmMdf::updateRemoteVariableItem(QMdfTreeWidgetItem* pItem, CMDF_RemoteVariable* prvar)
+{
+  // Check pointers
+  if ((nullptr == pItem) || (nullptr == prvar) || (nullptr == m_headRemoteVariabel)) {
+    return;
+  }
+
+  bool bExpanded = pItem->isExpanded();
+
+  // Label holds the position in the remote variable list
+  int idx = m_headRemoteVariabel->indexOfChild(pItem);
+  pItem->setText(0, QString("%1 %2 - %3").arg(CDlgMdfRemoteVar::pre_str_remote_variable).arg(idx).arg(prvar->getName().c_str()));
+
+  // Only render sub items again if they has been rendered before
+  if (!pItem->isPending()) {
+    QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
+    // Remove children
+    for (qsizetype i = 0; i < childrenList.size(); ++i) {
+      QMdfTreeWidgetItem* item = (QMdfTreeWidgetItem*)childrenList.at(i);
+      delete item;
+    }
+    childrenList.clear();
+    renderRemoteVariableItem(pItem, prvar);
+  }
+
+  pItem->setExpanded(bExpanded);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // renderRemoteVariables
 //
@@ -2013,7 +2083,9 @@ CFrmMdf::renderRemoteVariables(QTreeWidgetItem* pParent)
         str = QString("%1 %2 - %3").arg(CDlgMdfRemoteVar::pre_str_remote_variable).arg(i).arg(pvar->getName().c_str());
         pSubItem->setText(0, str);
         pParent->addChild(pSubItem);
-        renderRemoteVariableItem(pSubItem, pvar);
+
+        // Sub items are rendered when the variable is expanded
+        pSubItem->setPending(true);
       }
     }
 
@@ -3015,7 +3087,6 @@ void
 CFrmMdf::renderEvents(QMdfTreeWidgetItem* pItemEvent)
 {
   QString str;
-  QMdfTreeWidgetItem* pItem;
   QMdfTreeWidgetItem* pSubItem;
 
   std::deque<CMDF_Event*>* pEventList = m_mdf.getEventList();
@@ -3031,104 +3102,123 @@ CFrmMdf::renderEvents(QMdfTreeWidgetItem* pItemEvent)
         pSubItem->setText(0, str);
         pItemEvent->addChild(pSubItem);
 
-        pItem = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_sub_item);
-        if (nullptr != pItem) {
-          str = QString("Name: %1").arg(pevent->getName().c_str());
-          pItem->setText(0, str);
-          pSubItem->addChild(pItem);
-        }
+        // Sub items are rendered when the event is expanded
+        pSubItem->setPending(true);
+      }
+    }
+  } // EventList
+}
 
-        pItem = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_sub_item);
-        if (nullptr != pItem) {
-          str = QString("VSCP Class: %1").arg(pevent->getClass());
-          pItem->setText(0, str);
-          pSubItem->addChild(pItem);
-        }
+///////////////////////////////////////////////////////////////////////////////
+// renderEventItem
+//
 
-        pItem = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_sub_item);
-        if (nullptr != pItem) {
-          str = QString("VSCP Type: %1").arg(pevent->getType());
-          pItem->setText(0, str);
-          pSubItem->addChild(pItem);
-        }
+void
+CFrmMdf::renderEventItem(QMdfTreeWidgetItem* pSubItem, CMDF_Event* pevent)
+{
+  QString str;
+  QMdfTreeWidgetItem* pItem;
 
-        pItem = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_sub_item);
-        if (nullptr != pItem) {
-          str = QString("VSCP Priority: %1").arg(pevent->getPriority());
-          pItem->setText(0, str);
-          pSubItem->addChild(pItem);
-        }
+  // Check pointers
+  if ((nullptr == pSubItem) || (nullptr == pevent)) {
+    return;
+  }
 
-        pItem = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_sub_item);
-        if (nullptr != pItem) {
-          str = QString("Direction: %1 (%2)").arg((MDF_EVENT_DIR_IN == pevent->getDirection()) ? "In" : "Out").arg(pevent->getDirection());
-          pItem->setText(0, str);
-          pSubItem->addChild(pItem);
-        }
+  pItem = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_sub_item);
+  if (nullptr != pItem) {
+    str = QString("Name: %1").arg(pevent->getName().c_str());
+    pItem->setText(0, str);
+    pSubItem->addChild(pItem);
+  }
+
+  pItem = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_sub_item);
+  if (nullptr != pItem) {
+    str = QString("VSCP Class: %1").arg(pevent->getClass());
+    pItem->setText(0, str);
+    pSubItem->addChild(pItem);
+  }
+
+  pItem = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_sub_item);
+  if (nullptr != pItem) {
+    str = QString("VSCP Type: %1").arg(pevent->getType());
+    pItem->setText(0, str);
+    pSubItem->addChild(pItem);
+  }
 
-        // Event Data
-        QMdfTreeWidgetItem* pItemEventData = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_data);
-        // pItemEvent->setFont(0, fontTopItem);
-        // pItemEvent->setForeground(0, greenBrush);
-        pItemEventData->setText(0, tr("Event data"));
-        pSubItem->addChild(pItemEventData);
+  pItem = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_sub_item);
+  if (nullptr != pItem) {
+    str = QString("VSCP Priority: %1").arg(pevent->getPriority());
+    pItem->setText(0, str);
+    pSubItem->addChild(pItem);
+  }
 
-        std::deque<CMDF_EventData*>* pEventDataList = pevent->getListEventData();
-        if (nullptr != pEventDataList) {
+  pItem = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_sub_item);
+  if (nullptr != pItem) {
+    str = QString("Direction: %1 (%2)").arg((MDF_EVENT_DIR_IN == pevent->getDirection()) ? "In" : "Out").arg(pevent->getDirection());
+    pItem->setText(0, str);
+    pSubItem->addChild(pItem);
+  }
 
-          QString str;
-          QMdfTreeWidgetItem* pEventSubItem;
-          QMdfTreeWidgetItem* pItem;
+  // Event Data
+  QMdfTreeWidgetItem* pItemEventData = new QMdfTreeWidgetItem(pSubItem, pevent, mdf_type_event_data);
+  // pItemEvent->setFont(0, fontTopItem);
+  // pItemEvent->setForeground(0, greenBrush);
+  pItemEventData->setText(0, tr("Event data"));
+  pSubItem->addChild(pItemEventData);
 
-          for (int j = 0; j < pEventDataList->size(); j++) {
+  std::deque<CMDF_EventData*>* pEventDataList = pevent->getListEventData();
+  if (nullptr != pEventDataList) {
 
-            CMDF_EventData* pEventData = (*pEventDataList)[j];
+    QString str;
+    QMdfTreeWidgetItem* pEventSubItem;
+    QMdfTreeWidgetItem* pItem;
 
-            pEventSubItem = new QMdfTreeWidgetItem(pItemEventData, pEventData, mdf_type_event_data_item);
-            if (nullptr != pEventSubItem) {
+    for (int j = 0; j < pEventDataList->size(); j++) {
 
-              // Event data
-              str = QString("Event data: %1 -- %2").arg(pEventData->getOffset()).arg(pEventData->getName().c_str());
-              pEventSubItem->setText(0, str);
-              pItemEventData->addChild(pEventSubItem);
+      CMDF_EventData* pEventData = (*pEventDataList)[j];
 
-              pItem = new QMdfTreeWidgetItem(pEventSubItem, pEventData, mdf_type_event_data_sub_item);
-              if (nullptr != pItem) {
-                str = QString("Name: %1").arg(pEventData->getName().c_str());
-                pItem->setText(0, str);
-                pEventSubItem->addChild(pItem);
-              }
+      pEventSubItem = new QMdfTreeWidgetItem(pItemEventData, pEventData, mdf_type_event_data_item);
+      if (nullptr != pEventSubItem) {
 
-              pItem = new QMdfTreeWidgetItem(pEventSubItem, pEventData, mdf_type_event_data_sub_item);
-              if (nullptr != pItem) {
-                str = QString("Offset: %1").arg(pEventData->getOffset());
-                pItem->setText(0, str);
-                pEventSubItem->addChild(pItem);
-              }
+        // Event data
+        str = QString("Event data: %1 -- %2").arg(pEventData->getOffset()).arg(pEventData->getName().c_str());
+        pEventSubItem->setText(0, str);
+        pItemEventData->addChild(pEventSubItem);
 
-              // Fill in bit field info
-              renderBits(pEventSubItem, *pEventData->getListBits());
+        pItem = new QMdfTreeWidgetItem(pEventSubItem, pEventData, mdf_type_event_data_sub_item);
+        if (nullptr != pItem) {
+          str = QString("Name: %1").arg(pEventData->getName().c_str());
+          pItem->setText(0, str);
+          pEventSubItem->addChild(pItem);
+        }
 
-              // Fill in valid values
-              renderValues(pEventSubItem, *pEventData->getListValues());
+        pItem = new QMdfTreeWidgetItem(pEventSubItem, pEventData, mdf_type_event_data_sub_item);
+        if (nullptr != pItem) {
+          str = QString("Offset: %1").arg(pEventData->getOffset());
+          pItem->setText(0, str);
+          pEventSubItem->addChild(pItem);
+        }
 
-              // Descriptions
-              renderDescriptionItems(pEventSubItem, pEventData, pEventData->getMapDescription());
+        // Fill in bit field info
+        renderBits(pEventSubItem, *pEventData->getListBits());
 
-              // Info URL's
-              renderInfoUrlItems(pEventSubItem, pEventData, pEventData->getMapInfoUrl());
-            }
-          } // EventDataList
-        } // list exist
+        // Fill in valid values
+        renderValues(pEventSubItem, *pEventData->getListValues());
 
         // Descriptions
-        renderDescriptionItems(pSubItem, pevent, pevent->getMapDescription());
+        renderDescriptionItems(pEventSubItem, pEventData, pEventData->getMapDescription());
 
         // Info URL's
-        renderInfoUrlItems(pSubItem, pevent, pevent->getMapInfoUrl());
+        renderInfoUrlItems(pEventSubItem, pEventData, pEventData->getMapInfoUrl());
       }
-    }
-  } // EventList
+    } // EventDataList
+  } // list exist
+
+  // Descriptions
+  renderDescriptionItems(pSubItem, pevent, pevent->getMapDescription());
+
+  // Info URL's
+  renderInfoUrlItems(pSubItem, pevent, pevent->getMapInfoUrl());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -3514,7 +3604,7 @@ CFrmMdf::loadMdf(void)
   // * * * Events * * *
 
   QMdfTreeWidgetItem* pItemEvent = new QMdfTreeWidgetItem(pItemModule, &m_mdf, mdf_type_event);
-  pItemEvent                     = pItemEvent;
+  m_headEvent                    = pItemEvent;
   pItemEvent->setFont(0, fontTopItem);
   pItemEvent->setForeground(0, greenBrush);
   pItemEvent->setText(0, tr("Events"));
@@ -3529,6 +3619,9 @@ CFrmMdf::loadMdf(void)
   // pItemRecipes->setText(0, tr("Events"));
   // ui->treeMDF->addTopLevelItem(pItemRecipes);
 
+  // Validate the loaded MDF
+  m_lintTimer->start();
+
   // ui->btnScan->setEnabled(false);
   // CFoundNodeWidgetItem *pItem;
   // QMdfTreeWidgetItemIterator it(ui->treeFound);
@@ -3607,6 +3700,161 @@ CFrmMdf::onItemDoubleClicked(QTreeWidgetItem* item, int column)
   editItem();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// onItemExpanded
+//
+
+void
+CFrmMdf::onItemExpanded(QTreeWidgetItem* item)
+{
+  QMdfTreeWidgetItem* pItem = (QMdfTreeWidgetItem*)item;
+  if (nullptr == pItem) {
+    return;
+  }
+
+  renderPendingItem(pItem);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onMdfChanged
+//
+
+void
+CFrmMdf::onMdfChanged(CMDF_Object* pobj, mdf_record_type type, CFrmMdf::mdfchange change)
+{
+  Q_UNUSED(pobj);
+
+  m_bChanged = true;
+  m_changeCount++;
+
+  // Measured until the tree viewport has been repainted
+  m_editTimer.start();
+  ui->treeMDF->viewport()->update();
+
+  spdlog::trace("MDF edit: type={0} change={1}", (int)type, (int)change);
+
+  // Validate again when edits has settled
+  m_lintTimer->start();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// startLint
+//
+
+void
+CFrmMdf::startLint(void)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  // Drop a run that is not done. The checks test the cancel flag
+  // between items so this does not wait long.
+  m_lint.cancel();
+  m_lint.wait();
+
+  uint32_t generation = ++m_lintGeneration;
+  m_findings.clear();
+  m_treeProblems->clear();
+  m_treeProblems->setHeaderLabels(QStringList() << tr("Problems (checking...)"));
+
+  CMdfLint::lintinput input;
+  CMdfLint::makeInput(m_mdf, input);
+
+  // Known classes/types from the in-memory event tables
+  CMdfLint::eventcallback cbEvent = [pworks](uint16_t vscpClass, int vscpType) -> bool {
+    QMutexLocker locker(&pworks->m_mutexVscpEventsMaps);
+    if (vscpType < 0) {
+      return (pworks->m_mapVscpClassToToken.end() != pworks->m_mapVscpClassToToken.find(vscpClass));
+    }
+    uint32_t key = ((uint32_t)vscpClass << 16) + (uint16_t)vscpType;
+    return (pworks->m_mapVscpTypeToToken.end() != pworks->m_mapVscpTypeToToken.find(key));
+  };
+
+  // Tables not loaded - skip event check
+  {
+    QMutexLocker locker(&pworks->m_mutexVscpEventsMaps);
+    if (pworks->m_mapVscpClassToToken.empty()) {
+      cbEvent = nullptr;
+    }
+  }
+
+  m_lint.start(
+    input,
+    cbEvent,
+    [this, generation](const std::deque<CMdfLint::finding>& findings) {
+      QMetaObject::invokeMethod(
+        this,
+        [this, generation, findings]() {
+          if (generation == m_lintGeneration) {
+            addLintFindings(findings);
+          }
+        },
+        Qt::QueuedConnection);
+    },
+    [this, generation](bool bCancelled) {
+      QMetaObject::invokeMethod(
+        this,
+        [this, generation, bCancelled]() {
+          if (bCancelled || (generation != m_lintGeneration)) {
+            return;
+          }
+          m_treeProblems->setHeaderLabels(QStringList() << tr("Problems (%1)").arg(m_findings.size()));
+          spdlog::debug("MDF lint: {0} problem(s) found", m_findings.size());
+        },
+        Qt::QueuedConnection);
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// addLintFindings
+//
+
+void
+CFrmMdf::addLintFindings(const std::deque<CMdfLint::finding>& findings)
+{
+  for (const CMdfLint::finding& f : findings) {
+    QTreeWidgetItem* pItem = new QTreeWidgetItem(m_treeProblems);
+    pItem->setText(0, QString::fromStdString(f.m_message));
+    pItem->setToolTip(0, QString::fromStdString(f.m_message));
+    pItem->setIcon(0,
+                   style()->standardIcon((CMdfLint::severity::ERROR == f.m_severity) ? QStyle::SP_MessageBoxCritical
+                                                                                      : QStyle::SP_MessageBoxWarning));
+    pItem->setData(0, Qt::UserRole, (int)m_findings.size()); // Index into findings
+    m_findings.push_back(f);
+  }
+
+  m_treeProblems->setHeaderLabels(QStringList() << tr("Problems (%1)").arg(m_findings.size()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onProblemActivated
+//
+
+void
+CFrmMdf::onProblemActivated(QTreeWidgetItem* item, int column)
+{
+  Q_UNUSED(column);
+
+  if (nullptr == item) {
+    return;
+  }
+
+  int idx = item->data(0, Qt::UserRole).toInt();
+  if ((idx < 0) || (idx >= (int)m_findings.size())) {
+    return;
+  }
+
+  // The object is only used as a key. It may have been removed if
+  // an edit was made after the lint run.
+  QMdfTreeWidgetItem* pItem = findTreeItem(m_findings[idx].m_pobj, m_findings[idx].m_type);
+  if (nullptr == pItem) {
+    ui->statusbar->showMessage(tr("The item for this problem no longer exist"), 3000);
+    return;
+  }
+
+  ui->treeMDF->setCurrentItem(pItem);
+  ui->treeMDF->scrollToItem(pItem);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // findMdfWidgetItem
 //
@@ -4273,6 +4521,8 @@ CFrmMdf::editModuleData()
   dlg.initDialogData(pItem->getObject(), static_cast<mdf_module_index>(pItem->getElementIndex()));
 
   if (QDialog::Accepted == dlg.exec()) {
+    emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
     // Update Module items
 
     QMdfTreeWidgetItem* piter = nullptr;
@@ -4514,6 +4764,8 @@ CFrmMdf::editDescription(void)
     dlg.initDialogData(pmap, map_type_description, &selstr);
 
     if (QDialog::Accepted == dlg.exec()) {
+      emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
       // Update Module items
       deleteMdfWidgetChildItems(pItemDescription, mdf_type_generic_description_item);
       renderDescriptionItems(pItemDescription, pItem->getObject(), pmap, true);
@@ -4527,6 +4779,8 @@ CFrmMdf::editDescription(void)
     selstr = pItem->text(0).split('_').first().left(2);
     dlg.initDialogData(pmap, &selstr);
     if (QDialog::Accepted == dlg.exec()) {
+      emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
       // Update Module items
       deleteMdfWidgetChildItems(pItemDescription, mdf_type_generic_description_item);
       renderDescriptionItems(pItemDescription, pItem->getObject(), pmap, true);
@@ -4564,6 +4818,8 @@ CFrmMdf::deleteDescription(void)
     return;
   }
 
+  emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::REMOVED);
+
   pItemDescription = (QMdfTreeWidgetItem*)pItem->parent();
 
   QMdfTreeWidgetItem* pParentToItemDescription = (QMdfTreeWidgetItem*)pItemDescription->parent();
@@ -4791,6 +5047,8 @@ CFrmMdf::editInfoUrl(void)
     dlg.initDialogData(pmap, map_type_info_url, &selstr);
 
     if (QDialog::Accepted == dlg.exec()) {
+      emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
       // Update Module items
       deleteMdfWidgetChildItems(pItemInfoUrl, mdf_type_generic_help_url_item);
       renderInfoUrlItems(pItemInfoUrl, pItem->getObject(), pmap, true);
@@ -4804,6 +5062,8 @@ CFrmMdf::editInfoUrl(void)
     selstr = pItem->text(0).split('_').first().left(2);
     dlg.initDialogData(pmap, &selstr);
     if (QDialog::Accepted == dlg.exec()) {
+      emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
       // Update Module items
       deleteMdfWidgetChildItems(pItemInfoUrl, mdf_type_generic_help_url_item);
       renderDescriptionItems(pItemInfoUrl, pItem->getObject(), pmap, true);
@@ -4841,6 +5101,8 @@ CFrmMdf::deleteInfoUrl(void)
     return;
   }
 
+  emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::REMOVED);
+
   pItemInfoUrl = (QMdfTreeWidgetItem*)pItem->parent();
 
   QMdfTreeWidgetItem* pParentToItemInfoUrl = (QMdfTreeWidgetItem*)pItemInfoUrl->parent();
@@ -4978,6 +5240,7 @@ CFrmMdf::editManufacturerData()
   dlg.initDialogData(pItem->getObject(), static_cast<mdf_manufacturer_index>(pItem->getElementIndex()));
 
   if (QDialog::Accepted == dlg.exec()) {
+    emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
     // Update Module items
 
@@ -5053,6 +5316,7 @@ CFrmMdf::showContactDialog(QMdfTreeWidgetItem* pItem, mdf_dlg_contact_type type,
   dlg.setWindowTitle(title);
   dlg.initDialogData(pContactObj, type, title);
   if (QDialog::Accepted == dlg.exec()) {
+    emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
     pItem->setText(0, dlg.getValue());
     QMdfTreeWidgetItem* pItemDescription = findMdfWidgetItem(pItem, mdf_type_generic_description); // findDocumentItem(pItemModule);
@@ -5104,6 +5368,7 @@ CFrmMdf::editContact(void)
       CDlgMdfContactList dlg(this);
       dlg.initDialogData(pManufacturer, dlg_type_contact_phone, "Edit phone contact items");
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         // Expand to make traversion possible
         pItem->setExpanded(true);
@@ -5133,6 +5398,7 @@ CFrmMdf::editContact(void)
       CDlgMdfContactList dlg(this);
       dlg.initDialogData(pManufacturer, dlg_type_contact_fax, "Edit fax contact items");
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         // Expand to make traversion possible
         pItem->setExpanded(true);
@@ -5162,6 +5428,7 @@ CFrmMdf::editContact(void)
       CDlgMdfContactList dlg(this);
       dlg.initDialogData(pManufacturer, dlg_type_contact_email, "Edit email contact items");
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         // Expand to make traversion possible
         pItem->setExpanded(true);
@@ -5191,6 +5458,7 @@ CFrmMdf::editContact(void)
       CDlgMdfContactList dlg(this);
       dlg.initDialogData(pManufacturer, dlg_type_contact_web, "Edit web contact items");
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         // Expand to make traversion possible
         pItem->setExpanded(true);
@@ -5220,6 +5488,7 @@ CFrmMdf::editContact(void)
       CDlgMdfContactList dlg(this);
       dlg.initDialogData(pManufacturer, dlg_type_contact_social, "Edit social contact items");
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         // Expand to make traversion possible
         pItem->setExpanded(true);
@@ -5272,6 +5541,8 @@ CFrmMdf::deleteContact(void)
     return;
   }
 
+  emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::REMOVED);
+
   CMDF_Manufacturer* pManufacturer = m_mdf.getManufacturer();
 
   switch (pItem->getObjectType()) {
@@ -5425,6 +5696,7 @@ CFrmMdf::editBootLoader(void)
 
   dlg.initDialogData(pBootInfo, static_cast<mdf_bootloader_index>(selectedIndex));
   if (QDialog::Accepted == dlg.exec()) {
+    emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
     QMdfTreeWidgetItem* piter = (QMdfTreeWidgetItem*)ui->treeMDF->itemBelow(pBootHeadItem);
     while (mdf_type_bootloader_item == piter->getObjectType()) {
@@ -5464,6 +5736,7 @@ CFrmMdf::editFileList(void)
   CDlgMdfFile dlg(this);
   dlg.initDialogData(pItem->getObject(), pItem->getObjectType());
   if (QDialog::Accepted == dlg.exec()) {
+    emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
     // Expand to make traversion possible
     pItem->setExpanded(true);
@@ -5574,6 +5847,8 @@ CFrmMdf::editFile(void)
       CDlgMdfFilePicture dlg(this);
       dlg.initDialogData(pobj);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         qDebug() << "Item = " << pItem->text(0) << ((CMDF_Picture*)pItem->getObject())->getName().c_str() << " type = " << ((CMDF_Picture*)pItem->getObject())->getMdfObjectType();
 
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
@@ -5605,6 +5880,7 @@ CFrmMdf::editFile(void)
       CDlgMdfFilePicture dlg(this);
       dlg.initDialogData(pobj, static_cast<mdf_file_picture_index>(pItem->getElementIndex()));
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // qDebug() << "Header = " << pItemHead->text(0) << ((CMDF_Picture*)pItemHead->getObject())->getName().c_str() << " type = " << ((CMDF_Picture*)pItemHead->getObject())->getMdfObjectType();
@@ -5630,6 +5906,8 @@ CFrmMdf::editFile(void)
       CDlgMdfFileVideo dlg(this);
       dlg.initDialogData(pobj);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         // qDebug() << "Item = " << pItem->text(0) << ((CMDF_Videoe*)pItem->getObject())->getName().c_str() << " type = " << ((CMDF_Video*)pItem->getObject())->getMdfObjectType();
 
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
@@ -5661,6 +5939,7 @@ CFrmMdf::editFile(void)
       CDlgMdfFileVideo dlg(this);
       dlg.initDialogData(pobj, static_cast<mdf_file_video_index>(pItem->getElementIndex()));
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // qDebug() << "Header = " << pItemHead->text(0) << ((CMDF_Picture*)pItemHead->getObject())->getName().c_str() << " type = " << ((CMDF_Picture*)pItemHead->getObject())->getMdfObjectType();
@@ -5686,6 +5965,8 @@ CFrmMdf::editFile(void)
       CDlgMdfFileManual dlg(this);
       dlg.initDialogData(pobj);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         // qDebug() << "Item = " << pItem->text(0) << ((CMDF_Manaul*)pItem->getObject())->getName().c_str() << " type = " << ((CMDF_Manual*)pItem->getObject())->getMdfObjectType();
 
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
@@ -5717,6 +5998,7 @@ CFrmMdf::editFile(void)
       CDlgMdfFileManual dlg(this);
       dlg.initDialogData(pobj, static_cast<mdf_file_manual_index>(pItem->getElementIndex()));
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // qDebug() << "Header = " << pItemHead->text(0) << ((CMDF_Picture*)pItemHead->getObject())->getName().c_str() << " type = " << ((CMDF_Picture*)pItemHead->getObject())->getMdfObjectType();
@@ -5742,6 +6024,8 @@ CFrmMdf::editFile(void)
       CDlgMdfFileFirmware dlg(this);
       dlg.initDialogData(pobj);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         // qDebug() << "Item = " << pItem->text(0) << ((CMDF_Firmware*)pItem->getObject())->getName().c_str() << " type = " << ((CMDF_Firmware*)pItem->getObject())->getMdfObjectType();
 
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
@@ -5773,6 +6057,7 @@ CFrmMdf::editFile(void)
       CDlgMdfFileFirmware dlg(this);
       dlg.initDialogData(pobj, static_cast<mdf_file_firmware_index>(pItem->getElementIndex()));
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // qDebug() << "Header = " << pItemHead->text(0) << ((CMDF_Picture*)pItemHead->getObject())->getName().c_str() << " type = " << ((CMDF_Picture*)pItemHead->getObject())->getMdfObjectType();
@@ -5798,6 +6083,8 @@ CFrmMdf::editFile(void)
       CDlgMdfFileDriver dlg(this);
       dlg.initDialogData(pobj);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         // qDebug() << "Item = " << pItem->text(0) << ((CMDF_Driver*)pItem->getObject())->getName().c_str() << " type = " << ((CMDF_Driver*)pItem->getObject())->getMdfObjectType();
 
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
@@ -5829,6 +6116,7 @@ CFrmMdf::editFile(void)
       CDlgMdfFileDriver dlg(this);
       dlg.initDialogData(pobj, static_cast<mdf_file_driver_index>(pItem->getElementIndex()));
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // qDebug() << "Header = " << pItemHead->text(0) << ((CMDF_Driver*)pItemHead->getObject())->getName().c_str() << " type = " << ((CMDF_Driver*)pItemHead->getObject())->getMdfObjectType();
@@ -5854,6 +6142,8 @@ CFrmMdf::editFile(void)
       CDlgMdfFileSetup dlg(this);
       dlg.initDialogData(pobj);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         // qDebug() << "Item = " << pItem->text(0) << ((CMDF_Setup*)pItem->getObject())->getName().c_str() << " type = " << ((CMDF_Setup*)pItem->getObject())->getMdfObjectType();
 
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
@@ -5885,6 +6175,7 @@ CFrmMdf::editFile(void)
       CDlgMdfFileSetup dlg(this);
       dlg.initDialogData(pobj, static_cast<mdf_file_setup_index>(pItem->getElementIndex()));
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
 
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // qDebug() << "Header = " << pItemHead->text(0) << ((CMDF_Setup*)pItemHead->getObject())->getName().c_str() << " type = " << ((CMDF_Setup*)pItemHead->getObject())->getMdfObjectType();
@@ -5937,6 +6228,8 @@ CFrmMdf::deleteFile(void)
     return;
   }
 
+  emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::REMOVED);
+
   switch (pItem->getObjectType()) {
 
       // Picture
@@ -6197,14 +6490,14 @@ CFrmMdf::addRegister(void)
           goto addregdlg1;
         }
         m_mdf.getRegisterObjList()->push_back(pregnew);
-        QList<QTreeWidgetItem*> childrenList = m_headRegister->takeChildren();
-        // Remove children
-        for (qsizetype i = 0; i < childrenList.size(); ++i) {
-          QMdfTreeWidgetItem* item = (QMdfTreeWidgetItem*)childrenList.at(i);
-          delete item;
+        QMdfTreeWidgetItem* pItemReg = insertRegisterItem(pregnew);
+        if (nullptr != pItemReg) {
+          ui->treeMDF->setCurrentItem(pItemReg);
         }
-        childrenList.clear();
-        renderRegisters(m_headRegister);
+        emit mdfChanged(pregnew, mdf_type_register_item, mdfchange::ADDED);
+      }
+      else {
+        delete pregnew;
       }
     } break;
 
@@ -6224,14 +6517,14 @@ CFrmMdf::addRegister(void)
           goto addregdlg;
         }
         m_mdf.getRegisterObjList()->push_back(pregnew);
-        QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
-        // Remove children
-        for (qsizetype i = 0; i < childrenList.size(); ++i) {
-          QMdfTreeWidgetItem* item = (QMdfTreeWidgetItem*)childrenList.at(i);
-          delete item;
+        QMdfTreeWidgetItem* pItemReg = insertRegisterItem(pregnew);
+        if (nullptr != pItemReg) {
+          ui->treeMDF->setCurrentItem(pItemReg);
         }
-        childrenList.clear();
-        renderRegisters(pItem);
+        emit mdfChanged(pregnew, mdf_type_register_item, mdfchange::ADDED);
+      }
+      else {
+        delete pregnew;
       }
     } break;
 
@@ -6279,6 +6572,7 @@ CFrmMdf::editRegister(void)
         }
         childrenList.clear();
         renderRegisters(m_headRegister);
+        emit mdfChanged(&m_mdf, mdf_type_register, mdfchange::CHANGED);
       }
     } break;
 
@@ -6298,14 +6592,14 @@ CFrmMdf::editRegister(void)
           goto addregdlg;
         }
         m_mdf.getRegisterObjList()->push_back(pregnew);
-        QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
-        // Remove children
-        for (qsizetype i = 0; i < childrenList.size(); ++i) {
-          QMdfTreeWidgetItem* item = (QMdfTreeWidgetItem*)childrenList.at(i);
-          delete item;
+        QMdfTreeWidgetItem* pItemReg = insertRegisterItem(pregnew);
+        if (nullptr != pItemReg) {
+          ui->treeMDF->setCurrentItem(pItemReg);
         }
-        childrenList.clear();
-        renderRegisters(pItem);
+        emit mdfChanged(pregnew, mdf_type_register_item, mdfchange::ADDED);
+      }
+      else {
+        delete pregnew;
       }
     } break;
 
@@ -6320,15 +6614,8 @@ CFrmMdf::editRegister(void)
       dlg.initDialogData(&m_mdf, preg, selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
         pItem->setExpanded(true);
-        QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
-        // Remove children
-        for (qsizetype i = 0; i < childrenList.size(); ++i) {
-          QMdfTreeWidgetItem* item = (QMdfTreeWidgetItem*)childrenList.at(i);
-          delete item;
-        }
-        childrenList.clear();
-        pItem->setText(0, QString("Register  %1 %2").arg(preg->getOffset()).arg(preg->getName().c_str()));
-        renderRegisterItem(pItem, preg);
+        updateRegisterItem(pItem, preg);
+        emit mdfChanged(preg, mdf_type_register_item, mdfchange::CHANGED);
       }
     } break;
 
@@ -6342,17 +6629,13 @@ CFrmMdf::editRegister(void)
       CDlgMdfRegister dlg(this);
       dlg.initDialogData(&m_mdf, preg, selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
-        pItemHead->setExpanded(true);
-        QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
-        // Remove children
-        for (qsizetype i = 0; i < childrenList.size(); ++i) {
-          QMdfTreeWidgetItem* item = (QMdfTreeWidgetItem*)childrenList.at(i);
-          // qDebug() << item->text(0);
-          delete item;
+        // The selected sub item is deleted when the register is updated
+        ui->treeMDF->setCurrentItem(pItemHead);
+        pItemHead = updateRegisterItem(pItemHead, preg);
+        if (nullptr != pItemHead) {
+          pItemHead->setExpanded(true);
         }
-        childrenList.clear();
-        pItemHead->setText(0, QString("Register %1 %2").arg(preg->getOffset()).arg(preg->getName().c_str()));
-        renderRegisterItem(pItemHead, preg);
+        emit mdfChanged(preg, mdf_type_register_item, mdfchange::CHANGED);
       }
     } break;
 
@@ -6415,11 +6698,21 @@ CFrmMdf::deleteRegister(void)
         ++it;
       }
 
+      CMDF_Object* pobj = pItem->getObject();
       pItemHead->removeChild(pItem);
+      delete pItem;
+
+      // Remove page that no longer has any registers
+      if ((mdf_type_register_page == pItemHead->getObjectType()) && (0 == pItemHead->childCount())) {
+        m_headRegister->removeChild(pItemHead);
+        delete pItemHead;
+      }
+      emit mdfChanged(pobj, mdf_type_register_item, mdfchange::REMOVED);
     } break;
 
     case mdf_type_register_sub_item: {
       QMdfTreeWidgetItem* pItemHeadHead    = (QMdfTreeWidgetItem*)pItemHead->parent();
+      CMDF_Object* pobj                    = pItemHead->getObject();
       QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
       // Remove children
       for (qsizetype i = 0; i < childrenList.size(); ++i) {
@@ -6431,7 +6724,7 @@ CFrmMdf::deleteRegister(void)
       std::deque<CMDF_Register*>* pregisters = m_mdf.getRegisterObjList();
       // Find element and delete it
       for (std::deque<CMDF_Register*>::iterator it = m_mdf.getRegisterObjList()->begin(); it != m_mdf.getRegisterObjList()->end();) {
-        if (*it == pItem->getObject()) {
+        if (*it == pobj) {
           CMDF_Register* pReg = *it;
           m_mdf.getRegisterObjList()->erase(it);
           delete pReg;
@@ -6441,6 +6734,14 @@ CFrmMdf::deleteRegister(void)
       }
 
       pItemHeadHead->removeChild(pItemHead);
+      delete pItemHead;
+
+      // Remove page that no longer has any registers
+      if ((mdf_type_register_page == pItemHeadHead->getObjectType()) && (0 == pItemHeadHead->childCount())) {
+        m_headRegister->removeChild(pItemHeadHead);
+        delete pItemHeadHead;
+      }
+      emit mdfChanged(pobj, mdf_type_register_item, mdfchange::REMOVED);
     } break;
 
     case mdf_type_register_page:
@@ -6524,6 +6825,8 @@ CFrmMdf::editBitDefinition(void)
         CDlgMdfBitList dlg(this);
         dlg.initDialogData(preg, mdf_type_register);
         if (QDialog::Accepted == dlg.exec()) {
+          emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
           // Redraw all bit items - We do not know changes
           QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
           // Remove children
@@ -6541,6 +6844,8 @@ CFrmMdf::editBitDefinition(void)
         CDlgMdfBitList dlg(this);
         dlg.initDialogData(prvar, mdf_type_remotevar);
         if (QDialog::Accepted == dlg.exec()) {
+          emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
           // Redraw all bit items - We do not know changes
           QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
           // Remove children
@@ -6557,6 +6862,8 @@ CFrmMdf::editBitDefinition(void)
         CDlgMdfBitList dlg(this);
         dlg.initDialogData(&m_mdf, mdf_type_alarm);
         if (QDialog::Accepted == dlg.exec()) {
+          emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
           // Redraw all bit items - We do not know changes
           QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
           // Remove children
@@ -6573,6 +6880,8 @@ CFrmMdf::editBitDefinition(void)
         CDlgMdfBitList dlg(this);
         dlg.initDialogData(pItem->getObject(), mdf_type_action_param);
         if (QDialog::Accepted == dlg.exec()) {
+          emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
           // Redraw all bit items - We do not know changes
           QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
           // Remove children
@@ -6589,6 +6898,8 @@ CFrmMdf::editBitDefinition(void)
         CDlgMdfBitList dlg(this);
         dlg.initDialogData(pItem->getObject(), mdf_type_event_data_item);
         if (QDialog::Accepted == dlg.exec()) {
+          emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
           // Redraw all bit items - We do not know changes
           QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
           // Remove children
@@ -6613,6 +6924,8 @@ CFrmMdf::editBitDefinition(void)
       CDlgMdfBit dlg(this);
       dlg.initDialogData(pbit, 0, getTopParentType(pItem));
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         pItemHead->setExpanded(true);
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
         // Remove children
@@ -6643,6 +6956,8 @@ CFrmMdf::editBitDefinition(void)
       CDlgMdfBit dlg(this);
       dlg.initDialogData(pbit, selectedIndex, getTopParentType(pItem));
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         pItemHead->setExpanded(true);
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // Remove children
@@ -6708,6 +7023,8 @@ CFrmMdf::deleteBitDefinition(void)
     return;
   }
 
+  emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::REMOVED);
+
   switch (pItem->getObjectType()) {
 
     case mdf_type_bit:
@@ -7045,6 +7362,8 @@ CFrmMdf::editValueDefinition(void)
         CDlgMdfValueList dlg(this);
         dlg.initDialogData(preg);
         if (QDialog::Accepted == dlg.exec()) {
+          emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
           // Redraw all register items - We do not know changes
           QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
           // Remove children
@@ -7065,6 +7384,8 @@ CFrmMdf::editValueDefinition(void)
         CDlgMdfValueList dlg(this);
         dlg.initDialogData(prvar, mdf_type_remotevar);
         if (QDialog::Accepted == dlg.exec()) {
+          emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
           // Redraw all register items - We do not know changes
           QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
           // Remove children
@@ -7080,6 +7401,8 @@ CFrmMdf::editValueDefinition(void)
         CDlgMdfValueList dlg(this);
         dlg.initDialogData(pItem->getObject(), mdf_type_bit_sub_item);
         if (QDialog::Accepted == dlg.exec()) {
+          emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
           // Redraw all bit items - We do not know changes
           QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
           // Remove children
@@ -7096,6 +7419,8 @@ CFrmMdf::editValueDefinition(void)
         CDlgMdfValueList dlg(this);
         dlg.initDialogData(pItemHead->getObject(), mdf_type_action_param);
         if (QDialog::Accepted == dlg.exec()) {
+          emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
           // Redraw all bit items - We do not know changes
           QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
           // Remove children
@@ -7112,6 +7437,8 @@ CFrmMdf::editValueDefinition(void)
         CDlgMdfValueList dlg(this);
         dlg.initDialogData(pItemHead->getObject(), mdf_type_action_param);
         if (QDialog::Accepted == dlg.exec()) {
+          emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
           // Redraw all bit items - We do not know changes
           QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
           // Remove children
@@ -7136,6 +7463,8 @@ CFrmMdf::editValueDefinition(void)
       CDlgMdfValue dlg(this);
       dlg.initDialogData(pvalue, 0);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         pItemHead->setExpanded(true);
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
         // Remove children
@@ -7161,6 +7490,8 @@ CFrmMdf::editValueDefinition(void)
       CDlgMdfValue dlg(this);
       dlg.initDialogData(pvalue, selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         pItemHead->setExpanded(true);
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // Remove children
@@ -7221,6 +7552,8 @@ CFrmMdf::deleteValueDefinition(void)
     return;
   }
 
+  emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::REMOVED);
+
   switch (pItem->getObjectType()) {
 
     case mdf_type_value:
@@ -7408,6 +7741,7 @@ CFrmMdf::editRemoteVariable(void)
         }
         childrenList.clear();
         renderRemoteVariables(m_headRemoteVariabel);
+        emit mdfChanged(&m_mdf, mdf_type_remotevar, mdfchange::CHANGED);
       }
     } break;
 
@@ -7422,17 +7756,8 @@ CFrmMdf::editRemoteVariable(void)
       dlg.initDialogData(&m_mdf, pvar, selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
         pItem->setExpanded(true);
-        QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
-        // Remove children
-        for (qsizetype i = 0; i < childrenList.size(); ++i) {
-          QMdfTreeWidgetItem* item = (QMdfTreeWidgetItem*)childrenList.at(i);
-          delete item;
-        }
-        childrenList.clear();
-        QString str = QString("%1 %2 - %3").arg(CDlgMdfRemoteVar::pre_str_remote_variable).arg(0).arg(pvar->getName().c_str());
-        // str = QString("%1 %2 - %3").arg(CDlgMdfRemoteVar::pre_str_remote_variable).arg(i).arg(pvar->getName().c_str());
-        pItem->setText(0, str);
-        renderRemoteVariableItem(pItem, pvar);
+        updateRemoteVariableItem(pItem, pvar);
+        emit mdfChanged(pvar, mdf_type_remotevar_item, mdfchange::CHANGED);
       }
     } break;
 
@@ -7446,17 +7771,11 @@ CFrmMdf::editRemoteVariable(void)
       CDlgMdfRemoteVar dlg(this);
       dlg.initDialogData(&m_mdf, prvar, selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
+        // The selected sub item is deleted when the variable is updated
+        ui->treeMDF->setCurrentItem(pItemHead);
+        updateRemoteVariableItem(pItemHead, prvar);
         pItemHead->setExpanded(true);
-        QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
-        // Remove children
-        for (qsizetype i = 0; i < childrenList.size(); ++i) {
-          QMdfTreeWidgetItem* item = (QMdfTreeWidgetItem*)childrenList.at(i);
-          // qDebug() << item->text(0);
-          delete item;
-        }
-        childrenList.clear();
-        pItemHead->setText(0, QString("%1  %2").arg(CDlgMdfRemoteVar::pre_str_remote_variable).arg(prvar->getName().c_str()));
-        renderRemoteVariableItem(pItemHead, prvar);
+        emit mdfChanged(prvar, mdf_type_remotevar_item, mdfchange::CHANGED);
       }
     } break;
 
@@ -7519,11 +7838,15 @@ CFrmMdf::deleteRemoteVariable(void)
         ++it;
       }
 
+      CMDF_Object* pobj = pItem->getObject();
       pItemHead->removeChild(pItem);
+      delete pItem;
+      emit mdfChanged(pobj, mdf_type_remotevar_item, mdfchange::REMOVED);
     } break;
 
     case mdf_type_remotevar_sub_item: {
       QMdfTreeWidgetItem* pItemHeadHead    = (QMdfTreeWidgetItem*)pItemHead->parent();
+      CMDF_Object* pobj                    = pItemHead->getObject();
       QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
       // Remove children
       for (qsizetype i = 0; i < childrenList.size(); ++i) {
@@ -7535,7 +7858,7 @@ CFrmMdf::deleteRemoteVariable(void)
       std::deque<CMDF_RemoteVariable*>* prvars = m_mdf.getRemoteVariableList();
       // Find element and delete it
       for (std::deque<CMDF_RemoteVariable*>::iterator it = m_mdf.getRemoteVariableList()->begin(); it != m_mdf.getRemoteVariableList()->end();) {
-        if (*it == pItem->getObject()) {
+        if (*it == pobj) {
           CMDF_RemoteVariable* pvar = *it;
           m_mdf.getRemoteVariableList()->erase(it);
           delete pvar;
@@ -7545,6 +7868,8 @@ CFrmMdf::deleteRemoteVariable(void)
       }
 
       pItemHeadHead->removeChild(pItemHead);
+      delete pItemHead;
+      emit mdfChanged(pobj, mdf_type_remotevar_item, mdfchange::REMOVED);
     } break;
 
     default:
@@ -7612,6 +7937,8 @@ CFrmMdf::editDM(void)
       CDlgMdfDM dlg(this);
       dlg.initDialogData(&m_mdf, (CMDF_DecisionMatrix*)pItem->getObject(), selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         pItem->setExpanded(true);
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
         // Remove children
@@ -7628,6 +7955,8 @@ CFrmMdf::editDM(void)
       CDlgMdfDM dlg(this);
       dlg.initDialogData(&m_mdf, (CMDF_DecisionMatrix*)pItem->getObject(), selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         pItemHead->setExpanded(true);
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // Remove children
@@ -7675,6 +8004,8 @@ CFrmMdf::editAction(void)
       CDlgMdfDM dlg(this);
       dlg.initDialogData(&m_mdf, (CMDF_DecisionMatrix*)pItemHead->getObject(), 0);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         pItem->setExpanded(true);
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // Remove children
@@ -7692,6 +8023,8 @@ CFrmMdf::editAction(void)
       CDlgMdfDmAction dlg(this);
       dlg.initDialogData(&m_mdf, (CMDF_Action*)pItem->getObject(), selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         pItem->setExpanded(true);
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
         // Remove children
@@ -7710,6 +8043,8 @@ CFrmMdf::editAction(void)
       CDlgMdfDmAction dlg(this);
       dlg.initDialogData(&m_mdf, (CMDF_Action*)pItemHead->getObject(), selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         pItemHeadHead->removeChild(pItemHead);
         // Remove children
@@ -7730,6 +8065,8 @@ CFrmMdf::editAction(void)
       dlg.setReadOnly();
       dlg.initDialogData(&m_mdf, (CMDF_Action*)pItemHead->getObject(), selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
         // Remove children
         for (qsizetype i = 0; i < childrenList.size(); ++i) {
@@ -7745,6 +8082,8 @@ CFrmMdf::editAction(void)
       CDlgMdfDmActionParam dlg(this);
       dlg.initDialogData(&m_mdf, (CMDF_ActionParameter*)pItem->getObject(), selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         QList<QTreeWidgetItem*> childrenList = pItem->takeChildren();
         // Remove children
         for (qsizetype i = 0; i < childrenList.size(); ++i) {
@@ -7760,6 +8099,8 @@ CFrmMdf::editAction(void)
       CDlgMdfDmActionParam dlg(this);
       dlg.initDialogData(&m_mdf, (CMDF_ActionParameter*)pItemHead->getObject(), selectedIndex);
       if (QDialog::Accepted == dlg.exec()) {
+        emit mdfChanged(pItem->getObject(), pItem->getObjectType(), mdfchange::CHANGED);
+
         QList<QTreeWidgetItem*> childrenList = pItemHead->takeChildren();
         // Remove children
         for (qsizetype i = 0; i < childrenList.size(); ++i) {
@@ -7813,6 +8154,7 @@ CFrmMdf::editEvent(void)
         }
         childrenList.clear();
         renderEvents(pItemHead);
+        emit mdfChanged(&m_mdf, mdf_type_event, mdfchange::CHANGED);
       }
     } break;
 
@@ -7835,6 +8177,7 @@ CFrmMdf::editEvent(void)
         }
         childrenList.clear();
         renderEvents(pItemHeadHead);
+        emit mdfChanged(&m_mdf, mdf_type_event, mdfchange::CHANGED);
       }
     } break;
 
@@ -7887,6 +8230,7 @@ CFrmMdf::editEvent(void)
         }
         childrenList.clear();
         renderEvents(pItemHeadHead);
+        emit mdfChanged(&m_mdf, mdf_type_event, mdfchange::CHANGED);
       }
     } break;
 
@@ -7939,6 +8283,7 @@ CFrmMdf::editEvent(void)
         }
         childrenList.clear();
         renderEvents(pItemHeadHeadHead);
+        emit mdfChanged(&m_mdf, mdf_type_event, mdfchange::CHANGED);
       }
     } break;
 
@@ -7988,6 +8333,7 @@ CFrmMdf::addEvent(void)
         }
         childrenList.clear();
         renderEvents(pItem);
+        emit mdfChanged(&m_mdf, mdf_type_event, mdfchange::CHANGED);
       }
       else {
         delete pEvent;
@@ -8034,6 +8380,7 @@ CFrmMdf::addEvent(void)
         }
         childrenList.clear();
         renderEvents(pItemHead);
+        emit mdfChanged(&m_mdf, mdf_type_event, mdfchange::CHANGED);
       }
       else {
         delete pEventDataNew;
@@ -8092,6 +8439,7 @@ CFrmMdf::deleteEvent(void)
       }
       childrenList.clear();
       renderEvents(pItemHead);
+      emit mdfChanged(&m_mdf, mdf_type_event, mdfchange::CHANGED);
     } break;
 
     case mdf_type_event_sub_item: {
@@ -8122,6 +8470,7 @@ CFrmMdf::deleteEvent(void)
       }
       childrenList.clear();
       renderEvents(pItemHeadHead);
+      emit mdfChanged(&m_mdf, mdf_type_event, mdfchange::CHANGED);
     } break;
 
     case mdf_type_event_data_item: {
@@ -8161,6 +8510,7 @@ CFrmMdf::deleteEvent(void)
 
       childrenList.clear();
       renderEvents(pItemHeadHeadHead);
+      emit mdfChanged(&m_mdf, mdf_type_event, mdfchange::CHANGED);
 
     } break;
 
@@ -8203,6 +8553,7 @@ CFrmMdf::deleteEvent(void)
       }
       childrenList.clear();
       renderEvents(pItemHeadHeadHeadHead);
+      emit mdfChanged(&m_mdf, mdf_type_event, mdfchange::CHANGED);
     } break;
 
     default:
@@ -38,10 +38,13 @@
 #include <vscp-client-base.h>
 
 #include "cdlgmdfcontact.h"
+#include "mdflint.h"
+#include "mdfsaver.h"
 
 #include <set>
 
 #include <QDialog>
+#include <QElapsedTimer>
 #include <QMenu>
 #include <QObject>
 #include <QStringList>
@@ -129,6 +132,19 @@ public:
   */
   void setObject(CMDF_Object* pobj) { m_pMdfRecord = pobj; };
 
+  /*!
+    Check if sub items still need to be rendered
+    @return True if sub items are rendered first time the item is expanded
+  */
+  bool isPending(void) { return m_bPending; };
+
+  /*!
+    Mark item as having sub items that are not rendered yet. A pending
+    item always shows an expand indicator.
+    @param bPending True to defer rendering of sub items.
+  */
+  void setPending(bool bPending);
+
 private:
   /*!
     This is a pointer to a special object for certain types
@@ -149,6 +165,11 @@ private:
     Pointer to MDF record
   */
   mdf_record_type m_objType;
+
+  /*!
+    True if sub items has not been rendered yet
+  */
+  bool m_bPending;
 };
 
 // ----------------------------------------------------------------------------
@@ -163,6 +184,15 @@ class CFrmMdf : public QMainWindow {
 public:
   explicit CFrmMdf(QWidget* parent = nullptr, const char* path = nullptr);
   virtual ~CFrmMdf();
+
+  /*!
+    Kind of change reported by mdfChanged
+  */
+  enum class mdfchange { ADDED = 0,
+                         CHANGED,
+                         REMOVED };
+  Q_ENUM(mdfchange)
+
   bool eventFilter(QObject* watched, QEvent* event) override;
 
   /*!
@@ -187,6 +217,23 @@ public slots:
   /// Item has been double clicked
   void onItemDoubleClicked(QTreeWidgetItem* item, int column);
 
+  /// Item has been expanded - render pending sub items
+  void onItemExpanded(QTreeWidgetItem* item);
+
+  /*!
+    MDF object has been added, changed or removed
+    @param pobj Pointer to MDF object that changed
+    @param type Type of the tree item for the object
+    @param change What happened to the object
+  */
+  void onMdfChanged(CMDF_Object* pobj, mdf_record_type type, CFrmMdf::mdfchange change);
+
+  /// Start a background lint run on the current MDF
+  void startLint(void);
+
+  /// Problem has been activated - select the tree item it is for
+  void onProblemActivated(QTreeWidgetItem* item, int column);
+
   /// Edit MDF data
   void editItem(void);
 
@@ -384,6 +431,70 @@ public slots:
   void
   renderRemoteVariables(QTreeWidgetItem* pParent);
 
+  /*!
+    Render sub items for an item that was rendered as pending.
+    Nothing is done if the item is not pending.
+    @param pItem Pointer to item to render sub items for
+  */
+  void
+  renderPendingItem(QMdfTreeWidgetItem* pItem);
+
+  /*!
+    Find the tree item for a register page
+    @param page Register page to find
+    @param bCreate If true the page item is created at its sorted
+      position if it does not exist.
+    @return Pointer to page item or nullptr if not found.
+  */
+  QMdfTreeWidgetItem*
+  findRegisterPageItem(uint16_t page, bool bCreate = false);
+
+  /*!
+    Insert a (pending) tree item for a register sorted on offset
+    under its page item.
+    @param preg Pointer to register
+    @return Pointer to the new item or nullptr on failure.
+  */
+  QMdfTreeWidgetItem*
+  insertRegisterItem(CMDF_Register* preg);
+
+  /*!
+    Update the tree item for a register after it has been edited. The
+    item is moved if page or offset has changed and sub items are only
+    rendered again if they have been rendered before.
+    @param pItem Pointer to register item (mdf_type_register_item)
+    @param preg Pointer to register
+    @return Pointer to the item that now holds the register.
+  */
+  QMdfTreeWidgetItem*
+  updateRegisterItem(QMdfTreeWidgetItem* pItem, CMDF_Register* preg);
+
+  /*!
+    Update the tree item for a remote variable after it has been edited.
+    The label is set again and sub items are only rendered again if they
+    have been rendered before.
+    @param pItem Pointer to remote variable item (mdf_type_remotevar_item)
+    @param prvar Pointer to remote variable
+  */
+  void
+  updateRemoteVariableItem(QMdfTreeWidgetItem* pItem, CMDF_RemoteVariable* prvar);
+
+  /*!
+    Find the tree item for an MDF object
+    @param pobj Pointer to MDF object
+    @param type Type of tree item for the object
+    @return Pointer to item or nullptr if not found.
+  */
+  QMdfTreeWidgetItem*
+  findTreeItem(CMDF_Object* pobj, mdf_record_type type);
+
+  /*!
+    Add findings from a lint run to the problem list
+    @param findings Findings to add
+  */
+  void
+  addLintFindings(const std::deque<CMdfLint::finding>& findings);
+
   /*!
     Remove all subitems of a head item that have a speciified type.
     @param pItem Pointer to head item
@@ -578,6 +689,14 @@ public slots:
   void
   renderEvents(QMdfTreeWidgetItem* pItemEvent);
 
+  /*!
+    Render sub items for one event
+    @param pSubItem Event item to render sub items under
+    @param pevent Pointer to event
+  */
+  void
+  renderEventItem(QMdfTreeWidgetItem* pSubItem, CMDF_Event* pevent);
+
   /*!
     Render one action parameter
     @param pActionParamHeadItem Pointer to header for action parameters head item
@@ -616,8 +735,6 @@ public slots:
   /// Save MDF to currently opened file
   void saveMdf(void);
   bool saveMdfToPath(const QString& path, mdf_format format);
-  bool createBackupForPath(const QString& path);
-  bool enrichSavedJsonWithDecisionMatrix(const QString& path);
   void addRecentSavedFile(const QString& path);
   void loadRecentSavedFiles();
   void rebuildRecentSavedFilesMenu();
@@ -648,7 +765,14 @@ public slots:
 
 signals:
 
-
+  /*!
+    Emitted when an MDF object has been added, changed or removed
+    by an edit so that only the affected part needs to be updated.
+    @param pobj Pointer to MDF object that changed
+    @param type Type of the tree item for the object
+    @param change What happened to the object
+  */
+  void mdfChanged(CMDF_Object* pobj, mdf_record_type type, CFrmMdf::mdfchange change);
 
 private:
   // The UI definition
@@ -694,6 +818,33 @@ private:
 
   /// True if a loadeed file has been edited
   bool m_bChanged;
+
+  /// Time from an edit is applied until the tree is repainted
+  QElapsedTimer m_editTimer;
+
+  /// Background validation of the MDF
+  CMdfLint m_lint;
+
+  /// Starts a lint run when edits has settled
+  QTimer* m_lintTimer = nullptr;
+
+  /// Incremented for each lint run so late results can be dropped
+  uint32_t m_lintGeneration = 0;
+
+  /// Findings for the last lint run
+  std::deque<CMdfLint::finding> m_findings;
+
+  /// List with lint findings below the tree
+  QTreeWidget* m_treeProblems = nullptr;
+
+  /// Finishes saves on a worker thread
+  CMdfSaver m_saver;
+
+  /// Incremented for each edit
+  uint32_t m_changeCount = 0;
+
+  /// Change count when the MDF was last saved or loaded
+  uint32_t m_savedChangeCount = 0;
 };
 
 #endif // CFrmMdf_H
@@ -1,4 +1,9 @@
 #include "cfrmmqttexplorer.h"
+#include "cfrmmeasurementview.h"
+#include "mqttvscpdecoder.h"
+
+#include <vscphelper.h>
+#include <vscpworks.h>
 
 #include <mosquitto.h>
 
@@ -14,6 +19,7 @@
 #include <QFileDialog>
 #include <QHeaderView>
 #include <QInputDialog>
+#include <QItemSelectionModel>
 #include <QGridLayout>
 #include <QToolBar>
 #include <QGroupBox>
@@ -29,10 +35,13 @@
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QMetaObject>
+#include <QMutexLocker>
 #include <QPlainTextEdit>
 #include <QPushButton>
 #include <QSplitter>
+#include <QStatusBar>
 #include <QTextStream>
+#include <QTreeView>
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
 #include <QUuid>
@@ -42,7 +51,9 @@
 #include <QXmlStreamReader>
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
+#include <iterator>
 
 namespace {
 
@@ -60,81 +71,6 @@ QString escapeHtml(const QString& text)
   return escaped;
 }
 
-QString colorizeJsonContent(const QString& text)
-{
-  QString escaped = escapeHtml(text);
-  escaped.replace('\n', "<br>");
-  escaped.replace(' ', "&nbsp;");
-
-  QString out;
-  out.reserve(escaped.size() + 64);
-  bool inString = false;
-  bool inKey = false;
-  bool escapeNext = false;
-  for (int i = 0; i < escaped.size(); ++i) {
-    const QChar ch = escaped.at(i);
-    if (escapeNext) {
-      out += ch;
-      escapeNext = false;
-      continue;
-    }
-    if (ch == '\\') {
-      out += ch;
-      escapeNext = true;
-      continue;
-    }
-    if (ch == '"') {
-      if (inString) {
-        inString = false;
-        inKey = false;
-        out += '"';
-      }
-      else {
-        inString = true;
-        inKey = false;
-        out += '"';
-      }
-      continue;
-    }
-    if (inString) {
-      out += ch;
-      continue;
-    }
-    if (ch == '{' || ch == '}' || ch == '[' || ch == ']' || ch == ':' || ch == ',') {
-      out += QString("<span style='color:#64748b'>%1</span>").arg(ch);
-      continue;
-    }
-    if (ch == 't' || ch == 'f' || ch == 'n') {
-      QString token;
-      int j = i;
-      while (j < escaped.size() && (escaped.at(j).isLetter() || escaped.at(j) == '"')) {
-        token += escaped.at(j);
-        ++j;
-      }
-      if ((token == "true") || (token == "false") || (token == "null")) {
-        out += QString("<span style='color:#16a34a'>%1</span>").arg(token);
-        i = j - 1;
-        continue;
-      }
-    }
-    if (ch.isDigit() || ch == '-' || ch == '.') {
-      QString token;
-      int j = i;
-      while (j < escaped.size() && (escaped.at(j).isDigit() || escaped.at(j) == '-' || escaped.at(j) == '.' || escaped.at(j) == 'e' || escaped.at(j) == 'E' || escaped.at(j) == '+')) {
-        token += escaped.at(j);
-        ++j;
-      }
-      if (!token.isEmpty()) {
-        out += QString("<span style='color:#2563eb'>%1</span>").arg(token);
-        i = j - 1;
-        continue;
-      }
-    }
-    out += ch;
-  }
-  return out;
-}
-
 QString colorizeXmlContent(const QString& text)
 {
   QString escaped = escapeHtml(text);
@@ -192,188 +128,45 @@ QString formatRichTextBlock(const QString& text)
   return QString("<pre style='margin:0; white-space:pre-wrap; font-family:monospace;'>%1</pre>").arg(escaped);
 }
 
-constexpr int kItemRoleKind = Qt::UserRole + 1;
-constexpr int kItemRoleTopic = Qt::UserRole + 2;
-constexpr int kItemRolePayloadRaw = Qt::UserRole + 3;
-constexpr int kItemRolePayloadFormatted = Qt::UserRole + 4;
-constexpr int kItemRoleTimestamp = Qt::UserRole + 6;
-constexpr int kItemRolePayloadFormat = Qt::UserRole + 7;
-constexpr int kItemRoleRetained = Qt::UserRole + 8;
-constexpr int kItemRoleQos = Qt::UserRole + 10;
-constexpr int kItemRoleMid = Qt::UserRole + 11;
-constexpr int kItemKindTopicNode = 1;
-constexpr int kItemKindMessage = 2;
+constexpr int kFrameInterval = 40;
 
-QString buildTopicPathFromItem(QTreeWidgetItem* item)
-{
-  QStringList parts;
-  for (QTreeWidgetItem* current = item; nullptr != current; current = current->parent()) {
-    const QString label = current->text(0).trimmed();
-    if (!label.isEmpty()) {
-      parts.prepend(label);
-    }
-  }
-  return parts.join('/');
-}
+// Number of decoded payloads kept for selection changes
+constexpr size_t kDecodedCacheSize = 16;
 
-bool wildcardMatches(const QString& text, const QString& pattern)
-{
-  int textIndex = 0;
-  int patternIndex = 0;
-  int starIndex = -1;
-  int matchIndex = 0;
+// Payloads larger than this are not decoded
+constexpr int kMaxDecodeSize = 256 * 1024;
 
-  while (textIndex < text.size()) {
-    if (patternIndex < pattern.size() && (pattern.at(patternIndex) == '*' || pattern.at(patternIndex).toLower() == text.at(textIndex).toLower())) {
-      if (pattern.at(patternIndex) == '*') {
-        starIndex = patternIndex;
-        matchIndex = textIndex;
-        ++patternIndex;
-      }
-      else {
-        ++textIndex;
-        ++patternIndex;
-      }
-    }
-    else if (starIndex >= 0) {
-      patternIndex = starIndex + 1;
-      matchIndex += 1;
-      textIndex = matchIndex;
-    }
-    else {
-      return false;
-    }
-  }
-
-  while (patternIndex < pattern.size() && pattern.at(patternIndex) == '*') {
-    ++patternIndex;
-  }
+// Time in ms typing must pause before a filter is evaluated
+constexpr int kFilterDelay = 150;
 
-  return patternIndex == pattern.size();
-}
+// Time in ms between updates of topic statistics and VSCP class/type rates
+constexpr int kStatsInterval = 1000;
 
-bool matchesTopicFilter(const QString& topic, const QString& pattern)
+QString formatTimestamp(qint64 msecs)
 {
-  const QString trimmedPattern = pattern.trimmed();
-  if (trimmedPattern.isEmpty()) {
-    return true;
-  }
-
-  const QString normalizedTopic = topic.trimmed();
-  if (normalizedTopic.isEmpty()) {
-    return false;
-  }
-
-  if (!trimmedPattern.contains('*')) {
-    return normalizedTopic.compare(trimmedPattern, Qt::CaseInsensitive) == 0;
-  }
-
-  return wildcardMatches(normalizedTopic, trimmedPattern);
+  return QDateTime::fromMSecsSinceEpoch(msecs).toString("yyyy-MM-dd HH:mm:ss.zzz");
 }
 
-bool itemMatchesQos(QTreeWidgetItem* item, int expectedQos)
+QString vscpClassToken(uint16_t vscpClass)
 {
-  if (nullptr == item) {
-    return false;
-  }
-
-  if (item->data(0, kItemRoleQos).isValid()) {
-    return item->data(0, kItemRoleQos).toInt() == expectedQos;
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+  QMutexLocker locker(&pworks->m_mutexVscpEventsMaps);
+  const auto it = pworks->m_mapVscpClassToToken.find(vscpClass);
+  if (it == pworks->m_mapVscpClassToToken.end()) {
+    return QString::number(vscpClass);
   }
-
-  for (int i = 0; i < item->childCount(); ++i) {
-    if (itemMatchesQos(item->child(i), expectedQos)) {
-      return true;
-    }
-  }
-
-  return false;
+  return it->second;
 }
 
-bool itemMatchesRetain(QTreeWidgetItem* item, bool expectedRetain)
+QString vscpTypeToken(uint16_t vscpClass, uint16_t vscpType)
 {
-  if (nullptr == item) {
-    return false;
-  }
-
-  if (item->data(0, kItemRoleRetained).isValid()) {
-    return item->data(0, kItemRoleRetained).toBool() == expectedRetain;
-  }
-
-  for (int i = 0; i < item->childCount(); ++i) {
-    if (itemMatchesRetain(item->child(i), expectedRetain)) {
-      return true;
-    }
-  }
-
-  return false;
-}
-
-bool itemMatchesFilter(QTreeWidgetItem* item,
-                       const QString& filterText,
-                       const QString& topicFilterText)
-{
-  if (nullptr == item) {
-    return false;
-  }
-
-  const QString filterLower = filterText.trimmed().toLower();
-  const QString topicFilterLower = topicFilterText.trimmed().toLower();
-  const QString search = item->data(0, Qt::UserRole + 5).toString();
-  const QString topic = item->data(0, Qt::UserRole + 2).toString();
-  const QString label = item->text(0);
-  const QString branchPath = buildTopicPathFromItem(item);
-  const QStringList clauses = filterLower.split(',', Qt::SkipEmptyParts);
-
-  bool generalMatches = true;
-  for (const QString& clause : clauses) {
-    const QString trimmedClause = clause.trimmed();
-    if (trimmedClause.isEmpty()) {
-      continue;
-    }
-
-    if (trimmedClause.startsWith("qos=", Qt::CaseInsensitive)) {
-      const QString qosValue = trimmedClause.mid(4).trimmed();
-      bool ok = false;
-      const int expectedQos = qosValue.toInt(&ok);
-      if (!ok) {
-        generalMatches = false;
-        break;
-      }
-      generalMatches = generalMatches && itemMatchesQos(item, expectedQos);
-    }
-    else if (trimmedClause.startsWith("retain=", Qt::CaseInsensitive) ||
-             trimmedClause.startsWith("bretain=", Qt::CaseInsensitive)) {
-      const QString retainValue = trimmedClause.startsWith("bretain=", Qt::CaseInsensitive)
-                                     ? trimmedClause.mid(8).trimmed().toLower()
-                                     : trimmedClause.mid(7).trimmed().toLower();
-      const bool expectedRetain = retainValue == "true";
-      if (retainValue != "true" && retainValue != "false") {
-        generalMatches = false;
-        break;
-      }
-      generalMatches = generalMatches && itemMatchesRetain(item, expectedRetain);
-    }
-    else if (trimmedClause.startsWith("topic=", Qt::CaseInsensitive)) {
-      QString topicPattern = trimmedClause.mid(6).trimmed();
-      if (topicPattern.startsWith('"') && topicPattern.endsWith('"') && topicPattern.size() >= 2) {
-        topicPattern = topicPattern.mid(1, topicPattern.size() - 2).trimmed();
-      }
-      generalMatches = generalMatches &&
-                       (matchesTopicFilter(topic, topicPattern) ||
-                        matchesTopicFilter(label, topicPattern) ||
-                        matchesTopicFilter(branchPath, topicPattern));
-    }
-    else {
-      generalMatches = generalMatches && search.contains(trimmedClause, Qt::CaseInsensitive);
-    }
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+  QMutexLocker locker(&pworks->m_mutexVscpEventsMaps);
+  const auto it = pworks->m_mapVscpTypeToToken.find(CMqttVscpDecoder::makeKey(vscpClass, vscpType));
+  if (it == pworks->m_mapVscpTypeToToken.end()) {
+    return QString::number(vscpType);
   }
-
-  const bool topicMatches = topicFilterLower.isEmpty() ||
-                            matchesTopicFilter(topic, topicFilterLower) ||
-                            matchesTopicFilter(label, topicFilterLower) ||
-                            matchesTopicFilter(branchPath, topicFilterLower);
-  return generalMatches && topicMatches;
+  return it->second;
 }
 
 } // namespace
@@ -387,7 +180,16 @@ CFrmMqttExplorer::CFrmMqttExplorer(QWidget* parent, json* pconn)
   , m_verifyPeer(true)
   , m_port(1883)
   , m_keepAlive(60)
+  , m_replayActive(false)
+  , m_bulkActive(false)
+  , m_bulkPublished(0)
+  , m_bulkTime(0)
+  , m_model(nullptr)
   , m_messageFlushTimer(nullptr)
+  , m_filterTimer(nullptr)
+  , m_selectedNode(CMqttTopicTrie::NONE)
+  , m_vscpCountsTime(0)
+  , m_statsTimer(nullptr)
   , m_messageRenderCount(0)
   , m_receivePaused(false)
   , m_lastRenderedMessageCount(0)
@@ -403,7 +205,13 @@ CFrmMqttExplorer::CFrmMqttExplorer(QWidget* parent, json* pconn)
 
 CFrmMqttExplorer::~CFrmMqttExplorer()
 {
+  // Measurement views are children and are deleted after the members
+  for (auto* pview : m_measurementViews) {
+    disconnect(pview, nullptr, this, nullptr);
+  }
+
   disconnectFromBroker();
+  m_capture.close();
 }
 
 void
@@ -438,6 +246,12 @@ CFrmMqttExplorer::setupUi()
   m_subscribeMenu->addSeparator();
   m_actSubscribeConfigured = m_subscribeMenu->addAction(tr("Subscribe configured topics"));
   m_actClearSubscriptions  = m_subscribeMenu->addAction(tr("Clear subscriptions"));
+  m_captureMenu     = m_menuBar->addMenu(tr("&Capture"));
+  m_actStartCapture = m_captureMenu->addAction(tr("Start capture..."));
+  m_actStopCapture  = m_captureMenu->addAction(tr("Stop capture"));
+  m_captureMenu->addSeparator();
+  m_actStartReplay = m_captureMenu->addAction(tr("Replay capture..."));
+  m_actStopReplay  = m_captureMenu->addAction(tr("Stop replay"));
   mainLayout->setMenuBar(m_menuBar);
 
   auto* connBox    = new QGroupBox(tr("Connection"), this);
@@ -453,7 +267,14 @@ CFrmMqttExplorer::setupUi()
   m_comboReceiveMode->addItem(tr("Replace per topic"), ReceiveReplace);
   m_comboReceiveMode->setCurrentIndex(0);
   m_comboReceiveMode->setToolTip(tr("Choose whether new messages append or replace the latest message for the same topic"));
+  m_chkDecodeVscp = new QCheckBox(tr("Decode VSCP"), connBox);
+  m_chkDecodeVscp->setChecked(true);
+  m_chkDecodeVscp->setToolTip(tr("Decode VSCP events sent as JSON, XML, string or binary frames"));
+  m_chkHeatmap = new QCheckBox(tr("Heat map"), connBox);
+  m_chkHeatmap->setToolTip(tr("Shade topics by their share of the total message rate"));
   connLayout->addWidget(m_lblStatus, 1);
+  connLayout->addWidget(m_chkDecodeVscp);
+  connLayout->addWidget(m_chkHeatmap);
   connLayout->addWidget(m_comboReceiveMode);
   connLayout->addWidget(m_btnPauseReceive);
   connLayout->addWidget(m_btnConnect);
@@ -480,7 +301,7 @@ CFrmMqttExplorer::setupUi()
   topicFilterLayout->setContentsMargins(0, 4, 0, 4);
   topicFilterLayout->addWidget(new QLabel(tr("Topic search:"), this));
   m_editTopicFilter = new QLineEdit(this);
-  m_editTopicFilter->setPlaceholderText(tr("Search by topic path (use * as wildcard)"));
+  m_editTopicFilter->setPlaceholderText(tr("Search by topic path (use * as wildcard or +/# as in a subscription)"));
   topicFilterLayout->addWidget(m_editTopicFilter, 1);
   mainLayout->addLayout(topicFilterLayout);
 
@@ -495,9 +316,9 @@ CFrmMqttExplorer::setupUi()
   mainLayout->addLayout(filterLayout);
 
   auto* splitter = new QSplitter(Qt::Horizontal, this);
-  m_tree          = new QTreeWidget(splitter);
-  m_tree->setColumnCount(2);
-  m_tree->setHeaderLabels({ tr("Topic/Message"), tr("Message data") });
+  m_model         = new CMqttTopicModel(this);
+  m_tree          = new QTreeView(splitter);
+  m_tree->setModel(m_model);
   m_tree->setSelectionMode(QAbstractItemView::SingleSelection);
   m_tree->setAlternatingRowColors(true);
   m_tree->setUniformRowHeights(true);
@@ -507,17 +328,32 @@ CFrmMqttExplorer::setupUi()
   m_tree->setRootIsDecorated(true);
   m_tree->setMouseTracking(true);
   m_tree->header()->setSectionsMovable(true);
-  m_tree->header()->setSectionResizeMode(0, QHeaderView::Interactive);
-  m_tree->header()->setSectionResizeMode(1, QHeaderView::Stretch);
-  m_tree->header()->resizeSection(0, 520);
-  m_tree->header()->setStretchLastSection(true);
-
-  m_detailsTree = new QTreeWidget(splitter);
+  m_tree->header()->setSectionResizeMode(QHeaderView::Interactive);
+  m_tree->header()->setSectionResizeMode(CMqttTopicModel::COL_DATA, QHeaderView::Stretch);
+  m_tree->header()->resizeSection(CMqttTopicModel::COL_TOPIC, 420);
+  for (int col = CMqttTopicModel::COL_RATE_1S; col < CMqttTopicModel::COL_COUNT; col++) {
+    m_tree->header()->resizeSection(col, 90);
+  }
+  m_tree->header()->setStretchLastSection(false);
+  // No sort column until a header is clicked, topics are shown in the order they are seen
+  m_tree->header()->setSortIndicator(-1, Qt::DescendingOrder);
+  m_tree->setSortingEnabled(true);
+
+  auto* detailsSplitter = new QSplitter(Qt::Vertical, splitter);
+  m_detailsTree = new QTreeWidget(detailsSplitter);
   m_detailsTree->setHeaderLabels({ tr("Field"), tr("Value") });
   m_detailsTree->setAlternatingRowColors(true);
   m_detailsTree->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
   m_detailsTree->header()->setSectionResizeMode(1, QHeaderView::Stretch);
 
+  m_vscpTree = new QTreeWidget(detailsSplitter);
+  m_vscpTree->setHeaderLabels({ tr("VSCP class"), tr("VSCP type"), tr("Events"), tr("Rate (/s)") });
+  m_vscpTree->setRootIsDecorated(false);
+  m_vscpTree->setAlternatingRowColors(true);
+  m_vscpTree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  detailsSplitter->setStretchFactor(0, 3);
+  detailsSplitter->setStretchFactor(1, 1);
+
   splitter->setStretchFactor(0, 5);
   splitter->setStretchFactor(1, 2);
   mainLayout->addWidget(splitter, 1);
@@ -558,8 +394,26 @@ CFrmMqttExplorer::setupUi()
   publishLayout->addWidget(m_btnClearPublishTopics, 2, 6);
   publishLayout->addWidget(m_btnSavePublishTopics, 3, 4);
   publishLayout->addWidget(m_btnLoadPublishTopics, 3, 5);
+  m_btnBulkPublish = new QPushButton(tr("Bulk publish..."), publishBox);
+  m_btnBulkPublish->setToolTip(tr("Publish every payload on every topic in the list a number of times at a "
+                                  "target rate. Separate payloads with a line holding only ---. Payloads "
+                                  "may contain {counter}, {timestamp} and {random}."));
+  publishLayout->addWidget(m_btnBulkPublish, 3, 6);
   mainLayout->addWidget(publishBox);
 
+  m_statusBar   = new QStatusBar(this);
+  m_statusBar->setSizeGripEnabled(false);
+  m_lblCounters = new QLabel(m_statusBar);
+  m_lblCapture  = new QLabel(m_statusBar);
+  m_lblBulk     = new QLabel(m_statusBar);
+  m_statusBar->addPermanentWidget(m_lblCapture);
+  m_statusBar->addPermanentWidget(m_lblBulk);
+  m_statusBar->addPermanentWidget(m_lblCounters);
+  mainLayout->addWidget(m_statusBar);
+  updateIngestCounters();
+  updateCaptureStatus();
+  updateBulkStatus();
+
   setStyleSheet(
     "QWidget { font-family: 'Segoe UI', 'Liberation Sans', sans-serif; color: #0f172a; }"
     "QGroupBox { background-color: #f8fafc; border: 1px solid #d4dbe5; border-radius: 10px; margin-top: 8px; "
@@ -590,6 +444,7 @@ CFrmMqttExplorer::setupUi()
           &QPushButton::clicked,
           this,
           &CFrmMqttExplorer::onPublishClicked);
+  connect(m_btnBulkPublish, &QPushButton::clicked, this, &CFrmMqttExplorer::onBulkPublishClicked);
   connect(m_btnSubscribe,
           &QPushButton::clicked,
           this,
@@ -606,22 +461,14 @@ CFrmMqttExplorer::setupUi()
           &QLineEdit::textChanged,
           this,
           &CFrmMqttExplorer::onTopicFilterChanged);
-  connect(m_tree,
-          &QTreeWidget::itemSelectionChanged,
+  connect(m_tree->selectionModel(),
+          &QItemSelectionModel::selectionChanged,
           this,
           &CFrmMqttExplorer::onTreeSelectionChanged);
   m_tree->setContextMenuPolicy(Qt::CustomContextMenu);
-  connect(m_tree,
-          &QTreeWidget::itemEntered,
-          this,
-          [&](QTreeWidgetItem* item, int column) {
-            if (nullptr != item && column == 0) {
-              const QString topic = item->data(0, RoleTopic).toString();
-              if (!topic.isEmpty()) {
-                m_tree->setToolTip(topic);
-              }
-            }
-          });
+  connect(m_tree, &QTreeView::customContextMenuRequested, this, &CFrmMqttExplorer::onTreeContextMenu);
+  connect(m_chkDecodeVscp, &QCheckBox::toggled, this, &CFrmMqttExplorer::onDecodeVscpToggled);
+  connect(m_chkHeatmap, &QCheckBox::toggled, m_model, &CMqttTopicModel::setHeatmap);
   connect(m_btnAddPublishTopic, &QPushButton::clicked, this, &CFrmMqttExplorer::onAddPublishTopic);
   connect(m_btnUsePublishTopic,
           &QPushButton::clicked,
@@ -646,9 +493,19 @@ CFrmMqttExplorer::setupUi()
   connect(m_btnSave, &QPushButton::clicked, this, &CFrmMqttExplorer::onSaveSelected);
   connect(m_btnSave, &QPushButton::clicked, this, &CFrmMqttExplorer::onSaveSelectedEvent);
   m_messageFlushTimer = new QTimer(this);
-  m_messageFlushTimer->setInterval(200);
+  m_messageFlushTimer->setInterval(kFrameInterval);
   m_messageFlushTimer->setSingleShot(false);
   connect(m_messageFlushTimer, &QTimer::timeout, this, &CFrmMqttExplorer::flushPendingMessages);
+  m_filterTimer = new QTimer(this);
+  m_filterTimer->setInterval(kFilterDelay);
+  m_filterTimer->setSingleShot(true);
+  connect(m_filterTimer, &QTimer::timeout, this, &CFrmMqttExplorer::applyFilter);
+  m_statsTimer = new QTimer(this);
+  m_statsTimer->setInterval(kStatsInterval);
+  m_statsTimer->setSingleShot(false);
+  connect(m_statsTimer, &QTimer::timeout, this, &CFrmMqttExplorer::updateStats);
+  connect(m_model, &QAbstractItemModel::modelAboutToBeReset, this, &CFrmMqttExplorer::onModelAboutToBeReset);
+  connect(m_model, &QAbstractItemModel::modelReset, this, &CFrmMqttExplorer::onModelReset);
   connect(m_actSubscribe, &QAction::triggered, this, &CFrmMqttExplorer::onMenuSubscribe);
   connect(m_actUnsubscribe, &QAction::triggered, this, &CFrmMqttExplorer::onMenuUnsubscribe);
   connect(m_actSubscribeConfigured,
@@ -659,6 +516,10 @@ CFrmMqttExplorer::setupUi()
           &QAction::triggered,
           this,
           &CFrmMqttExplorer::onMenuClearSubscriptions);
+  connect(m_actStartCapture, &QAction::triggered, this, &CFrmMqttExplorer::onStartCapture);
+  connect(m_actStopCapture, &QAction::triggered, this, &CFrmMqttExplorer::onStopCapture);
+  connect(m_actStartReplay, &QAction::triggered, this, &CFrmMqttExplorer::onStartReplay);
+  connect(m_actStopReplay, &QAction::triggered, this, &CFrmMqttExplorer::onStopReplay);
 }
 
 void
@@ -833,6 +694,10 @@ CFrmMqttExplorer::connectToBroker()
   mosquitto_disconnect_callback_set(m_mosq,
                                     &CFrmMqttExplorer::onMosquittoDisconnectStatic);
   mosquitto_message_callback_set(m_mosq, &CFrmMqttExplorer::onMosquittoMessageStatic);
+  mosquitto_publish_callback_set(m_mosq, &CFrmMqttExplorer::onMosquittoPublishStatic);
+
+  // Lets replay and bulk publishing keep a whole window of QoS 1/2 messages in flight
+  mosquitto_int_option(m_mosq, MOSQ_OPT_SEND_MAXIMUM, CMqttPublishWindow::SIZE);
 
   if (!m_user.isEmpty()) {
     const int rc = mosquitto_username_pw_set(m_mosq,
@@ -851,6 +716,16 @@ CFrmMqttExplorer::connectToBroker()
     applyTlsSettings();
   }
 
+  // Settings may have changed since last connect
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+  m_model->setBudget(static_cast<size_t>(pworks->m_mqttHistoryBudget) * 1024 * 1024);
+
+  m_ingest.setPaused(m_receivePaused);
+  m_ingest.setVscpDecoding(m_chkDecodeVscp->isChecked());
+  m_ingest.start();
+  m_messageFlushTimer->start();
+  m_statsTimer->start();
+
   const int loopRc = mosquitto_loop_start(m_mosq);
   if (MOSQ_ERR_SUCCESS != loopRc) {
     setStatus(tr("Failed to start MQTT loop: %1")
@@ -880,6 +755,10 @@ CFrmMqttExplorer::connectToBroker()
 void
 CFrmMqttExplorer::disconnectFromBroker()
 {
+  // Replay and bulk publishing use the client
+  m_replay.stop();
+  m_bulk.stop();
+
   if (nullptr != m_mosq) {
     mosquitto_disconnect(m_mosq);
     mosquitto_loop_stop(m_mosq, false);
@@ -887,6 +766,17 @@ CFrmMqttExplorer::disconnectFromBroker()
     m_mosq = nullptr;
   }
 
+  // Nothing is produced once the network loop has stopped, show what is left
+  m_ingest.stop();
+  if (nullptr != m_messageFlushTimer && m_messageFlushTimer->isActive()) {
+    m_messageFlushTimer->stop();
+    flushPendingMessages();
+  }
+  if (nullptr != m_statsTimer && m_statsTimer->isActive()) {
+    m_statsTimer->stop();
+    updateStats();
+  }
+
   m_connecting = false;
   m_connected = false;
   updateConnectionUiState();
@@ -1002,6 +892,93 @@ CFrmMqttExplorer::onPublishClicked()
   addPublishTopicIfMissing(m_editPublishTopic->text());
 }
 
+void
+CFrmMqttExplorer::onBulkPublishClicked()
+{
+  if (m_bulk.isRunning()) {
+    m_bulk.stop();
+    updateBulkStatus();
+    return;
+  }
+
+  if (!isConnected()) {
+    setStatus(tr("Not connected"), true);
+    return;
+  }
+
+  if (m_replay.isRunning()) {
+    setStatus(tr("Stop the replay before bulk publishing"), true);
+    return;
+  }
+
+  CMqttBulkPublisher::options opt;
+  for (int i = 0; i < m_listPublishTopics->count(); i++) {
+    opt.m_topics.push_back(m_listPublishTopics->item(i)->text().toStdString());
+  }
+  if (opt.m_topics.empty() && !trimmedTopic(m_editPublishTopic->text()).isEmpty()) {
+    opt.m_topics.push_back(trimmedTopic(m_editPublishTopic->text()).toStdString());
+  }
+  if (opt.m_topics.empty()) {
+    setStatus(tr("No topics to publish to"), true);
+    return;
+  }
+
+  // Payloads are separated by a line holding only ---
+  QStringList block;
+  const QStringList lines = m_editPublishPayload->toPlainText().split('\n');
+  for (const QString& line : lines) {
+    if ("---" == line.trimmed()) {
+      opt.m_templates.push_back(block.join('\n').toStdString());
+      block.clear();
+      continue;
+    }
+    block << line;
+  }
+  opt.m_templates.push_back(block.join('\n').toStdString());
+
+  bool ok;
+  opt.m_repeat = QInputDialog::getInt(this,
+                                      tr("Bulk publish"),
+                                      tr("%1 topics x %2 payloads, repetitions:")
+                                        .arg(opt.m_topics.size())
+                                        .arg(opt.m_templates.size()),
+                                      1000,
+                                      1,
+                                      100000000,
+                                      1,
+                                      &ok);
+  if (!ok) {
+    return;
+  }
+
+  opt.m_rate = QInputDialog::getInt(this,
+                                    tr("Bulk publish"),
+                                    tr("Rate (messages/s, 0 for as fast as possible):"),
+                                    1000,
+                                    0,
+                                    1000000,
+                                    100,
+                                    &ok);
+  if (!ok) {
+    return;
+  }
+
+  opt.m_qos     = m_comboPublishQos->currentText().toInt();
+  opt.m_bRetain = m_chkPublishRetain->isChecked();
+
+  if (VSCP_ERROR_SUCCESS != m_bulk.start(m_mosq, opt)) {
+    setStatus(tr("Failed to start bulk publish"), true);
+    return;
+  }
+
+  m_bulkActive    = true;
+  m_bulkPublished = 0;
+  m_bulkTime      = QDateTime::currentMSecsSinceEpoch();
+  setStatus(tr("Bulk publishing %1 messages").arg(m_bulk.getCounters().m_total));
+  updateBulkStatus();
+  updateCaptureStatus();
+}
+
 void
 CFrmMqttExplorer::onSubscribeClicked()
 {
@@ -1025,10 +1002,7 @@ CFrmMqttExplorer::onUnsubscribeClicked()
 
   QString topic = trimmedTopic(m_editSubscribeTopic->text());
   if (topic.isEmpty()) {
-    const auto selected = m_tree->selectedItems();
-    if (!selected.isEmpty()) {
-      topic = selected.first()->data(0, RoleTopic).toString();
-    }
+    topic = m_model->getTopic(selectedIndex());
   }
 
   if (topic.isEmpty()) {
@@ -1184,11 +1158,8 @@ CFrmMqttExplorer::onPauseReceiveClicked()
 {
   m_receivePaused = !m_receivePaused;
   updateReceiveUiState();
+  m_ingest.setPaused(m_receivePaused);
   setStatus(m_receivePaused ? tr("Receiving paused") : tr("Receiving resumed"));
-
-  if (!m_receivePaused && !m_pendingMessages.isEmpty()) {
-    flushPendingMessages();
-  }
 }
 
 void
@@ -1203,12 +1174,7 @@ CFrmMqttExplorer::onReceiveModeChanged(int index)
 void
 CFrmMqttExplorer::onSaveSelectedEvent()
 {
-  const auto selected = m_tree->selectedItems();
-  if (selected.isEmpty()) {
-    return;
-  }
-
-  const QString text = buildDetailsText(selected.first());
+  const QString text = buildDetailsText(selectedIndex());
   if (text.isEmpty()) {
     return;
   }
@@ -1235,323 +1201,303 @@ CFrmMqttExplorer::onSaveSelectedEvent()
 }
 
 void
-CFrmMqttExplorer::onMenuSubscribe()
+CFrmMqttExplorer::onStartCapture()
 {
-  onSubscribeClicked();
-}
+  if (m_capture.isOpen()) {
+    return;
+  }
 
-void
-CFrmMqttExplorer::onMenuUnsubscribe()
-{
-  onUnsubscribeClicked();
-}
+  const QString path = QFileDialog::getSaveFileName(this,
+                                                    tr("Capture MQTT traffic"),
+                                                    QDir::homePath() + "/mqtt-capture.vmc",
+                                                    tr("MQTT capture files (*.vmc);;All files (*)"));
+  if (path.isEmpty()) {
+    return;
+  }
 
-void
-CFrmMqttExplorer::onMenuSubscribeConfigured()
-{
-  subscribeConfiguredTopics();
+  if (VSCP_ERROR_SUCCESS != m_capture.open(path.toStdString())) {
+    QMessageBox::warning(this,
+                         tr("MQTT raw explorer"),
+                         tr("Failed to create capture file '%1'.").arg(path));
+    return;
+  }
+
+  setStatus(tr("Capturing to %1").arg(path));
+  updateCaptureStatus();
 }
 
 void
-CFrmMqttExplorer::onMenuClearSubscriptions()
+CFrmMqttExplorer::onStopCapture()
 {
-  m_subscriptions.clear();
-  setStatus(tr("Subscription tracking cleared"));
+  if (!m_capture.isOpen()) {
+    return;
+  }
+
+  m_capture.close();
+  const CMqttCaptureWriter::counters cnt = m_capture.getCounters();
+  setStatus(tr("Captured %1 messages to %2")
+              .arg(cnt.m_messages)
+              .arg(QString::fromStdString(m_capture.getPath())),
+            cnt.m_dropped > 0);
+  updateCaptureStatus();
 }
 
 void
-CFrmMqttExplorer::pruneTopicNode(QTreeWidgetItem* item)
+CFrmMqttExplorer::onStartReplay()
 {
-  if (nullptr == item) {
+  if (!isConnected()) {
+    setStatus(tr("Not connected"), true);
     return;
   }
 
-  const QString searchKey = item->data(0, RoleSearchText).toString();
-  if (!searchKey.isEmpty()) {
-    m_topicNodeByPath.remove(searchKey);
+  if (m_replay.isRunning()) {
+    return;
   }
 
-  for (int i = 0; i < item->childCount(); ++i) {
-    pruneTopicNode(item->child(i));
+  if (m_bulk.isRunning()) {
+    setStatus(tr("Stop the bulk publish before replaying"), true);
+    return;
   }
-}
 
-void
-CFrmMqttExplorer::pruneTopicNodeIndexIfNeeded()
-{
-  constexpr int kMaxTopLevelTopics = 100;
-  while (m_tree->topLevelItemCount() >= kMaxTopLevelTopics) {
-    auto* oldest = m_tree->takeTopLevelItem(0);
-    if (nullptr == oldest) {
-      break;
-    }
-    pruneTopicNode(oldest);
-    delete oldest;
+  const QString path = QFileDialog::getOpenFileName(this,
+                                                    tr("Replay MQTT capture"),
+                                                    QDir::homePath(),
+                                                    tr("MQTT capture files (*.vmc);;All files (*)"));
+  if (path.isEmpty()) {
+    return;
   }
-}
 
-QTreeWidgetItem*
-CFrmMqttExplorer::ensureTopicPath(const QString& topic)
-{
-  QString normalized = topic;
-  if (normalized.isEmpty()) {
-    normalized = "/";
+  bool ok;
+  const QStringList modes = { tr("Original timing"), tr("Scaled timing"), tr("Max rate") };
+  const QString mode =
+    QInputDialog::getItem(this, tr("Replay MQTT capture"), tr("Timing:"), modes, 0, false, &ok);
+  if (!ok) {
+    return;
   }
 
-  if (m_topicNodeByPath.contains(normalized)) {
-    return m_topicNodeByPath.value(normalized);
+  CMqttReplay::options opt;
+  opt.m_mode  = static_cast<uint8_t>(modes.indexOf(mode));
+  opt.m_speed = 1.0;
+  if (CMqttReplay::MODE_SCALED == opt.m_mode) {
+    opt.m_speed = QInputDialog::getDouble(this,
+                                          tr("Replay MQTT capture"),
+                                          tr("Speed factor (2 is twice as fast):"),
+                                          2.0,
+                                          0.01,
+                                          1000.0,
+                                          2,
+                                          &ok);
+    if (!ok) {
+      return;
+    }
   }
 
-  const QStringList parts = normalized.split('/', Qt::KeepEmptyParts);
-  QString currentPath;
-  QTreeWidgetItem* parent = nullptr;
+  const QStringList qos = { tr("As captured"), "0", "1", "2" };
+  const QString q = QInputDialog::getItem(this, tr("Replay MQTT capture"), tr("QoS:"), qos, 0, false, &ok);
+  if (!ok) {
+    return;
+  }
+  opt.m_qos = qos.indexOf(q) - 1;
 
-  for (int i = 0; i < parts.size(); ++i) {
-    const QString segment = parts.at(i).isEmpty() ? "/" : parts.at(i);
-    currentPath = currentPath.isEmpty() ? segment : currentPath + "/" + segment;
+  // Retained messages stay on the broker after the replay
+  opt.m_bRetain = (QMessageBox::Yes ==
+                   QMessageBox::question(this,
+                                         tr("Replay MQTT capture"),
+                                         tr("Keep the retain flag on captured retained messages?"),
+                                         QMessageBox::Yes | QMessageBox::No,
+                                         QMessageBox::No));
 
-    if (!m_topicNodeByPath.contains(currentPath)) {
-      auto* item = new QTreeWidgetItem({ segment, "" });
-      item->setForeground(0, QColor("#2563eb"));
-      item->setForeground(1, QColor("#64748b"));
-      item->setData(0, RoleKind, KindTopicNode);
-      item->setData(0, RoleTopic, normalized);
-      item->setData(0, RoleSearchText, currentPath.toLower());
-      item->setData(0, RoleMessageCount, 0);
-      if (nullptr == parent) {
-        pruneTopicNodeIndexIfNeeded();
-        m_tree->addTopLevelItem(item);
-      }
-      else {
-        parent->addChild(item);
-      }
-      m_topicNodeByPath.insert(currentPath, item);
-    }
-    parent = m_topicNodeByPath.value(currentPath);
+  const int rv = m_replay.start(m_mosq, path.toStdString(), opt);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    QMessageBox::warning(this,
+                         tr("MQTT raw explorer"),
+                         (VSCP_ERROR_PARSING == rv) ? tr("'%1' is not an MQTT capture file.").arg(path)
+                                                    : tr("Failed to replay '%1'.").arg(path));
+    return;
   }
 
-  m_topicNodeByPath.insert(normalized, parent);
-  return parent;
+  m_replayActive = true;
+  setStatus(tr("Replaying %1").arg(path));
+  updateCaptureStatus();
+  updateBulkStatus();
 }
 
 void
-CFrmMqttExplorer::updateTopicNodeWithMessage(QTreeWidgetItem* topicNode,
-                                             const QString& topic,
-                                             const QByteArray& payload,
-                                             const QString& formattedPayload,
-                                             const QString& format,
-                                             bool retained,
-                                             int qos,
-                                             int mid)
-{
-  if (nullptr == topicNode) {
-    return;
-  }
+CFrmMqttExplorer::onStopReplay()
+{
+  m_replay.stop();
+  updateCaptureStatus();
+}
 
+void
+CFrmMqttExplorer::onMenuSubscribe()
+{
+  onSubscribeClicked();
+}
 
-  const QString previousPayload = topicNode->data(0, RolePayloadRaw).toString();
-  const bool changed = !previousPayload.isEmpty() && previousPayload != QString::fromUtf8(payload);
-  QString preview = QString::fromUtf8(payload);
-  preview.replace('\n', " ");
-  preview.replace('\r', " ");
-  preview = preview.trimmed();
-  if (preview.size() > 140) {
-    preview = preview.left(137) + "...";
-  }
-  topicNode->setForeground(0, QColor("#2563eb"));
-  topicNode->setForeground(1, changed ? QColor("#16a34a") : QColor("#16a34a"));
-  if (topicNode->data(0, RoleKind).toInt() == KindTopicNode) {
-    topicNode->setText(1, QString());
-    topicNode->setForeground(1, QColor("#64748b"));
-  }
-  else {
-    topicNode->setText(1, preview.isEmpty() ? tr("<empty>") : preview);
-    topicNode->setForeground(1, QColor("#16a34a"));
-  }
-  topicNode->setBackground(0, QColor("#eff6ff"));
-  topicNode->setBackground(1, QColor("#f5f3ff"));
-  topicNode->setData(0, RolePayloadRaw, QString::fromUtf8(payload));
-  topicNode->setData(0, RolePayloadFormatted, formattedPayload);
-  topicNode->setData(0, RolePayloadFormat, format);
-  topicNode->setData(0, RoleRetained, retained);
-  topicNode->setData(0, RolePayloadSize, payload.size());
-  topicNode->setData(0, RoleQos, qos);
-  topicNode->setData(0, RoleMid, mid);
-  topicNode->setData(0, RoleTimestamp, QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz"));
-  topicNode->setData(0,
-                     RoleSearchText,
-                     buildSearchText(topic, payload, formattedPayload).toLower());
-
-  for (QTreeWidgetItem* current = topicNode; nullptr != current; current = current->parent()) {
-    const int count = current->data(0, RoleMessageCount).toInt();
-    current->setData(0, RoleMessageCount, count + 1);
-  }
-
-  const auto selected = m_tree->selectedItems();
-  if (!selected.isEmpty()) {
-    auto* selectedItem = selected.first();
-    const bool sameTopic = selectedItem->data(0, RoleTopic).toString() == topic ||
-                           (selectedItem == topicNode) ||
-                           (selectedItem->parent() == topicNode);
-    if (sameTopic) {
-      refreshSelectedDetails();
-    }
-  }
+void
+CFrmMqttExplorer::onMenuUnsubscribe()
+{
+  onUnsubscribeClicked();
 }
 
 void
-CFrmMqttExplorer::flashItemHighlight(QTreeWidgetItem* item)
+CFrmMqttExplorer::onMenuSubscribeConfigured()
 {
-  if (nullptr == item || nullptr == item->treeWidget()) {
-    return;
-  }
+  subscribeConfiguredTopics();
+}
 
-  const bool isTopicNode = item->data(0, RoleKind).toInt() == KindTopicNode;
-  if (isTopicNode) {
-    const QString label = item->text(0);
-    if (!label.startsWith("● ")) {
-      item->setText(0, QStringLiteral("● %1").arg(label));
-    }
-  }
+void
+CFrmMqttExplorer::onMenuClearSubscriptions()
+{
+  m_subscriptions.clear();
+  setStatus(tr("Subscription tracking cleared"));
+}
 
-  QTimer::singleShot(1200, item->treeWidget(), [item, isTopicNode]() {
-    if (nullptr == item || nullptr == item->treeWidget()) {
-      return;
+CFrmMqttExplorer::DecodedPayload
+CFrmMqttExplorer::decodePayload(const CMqttHistory::message& msg) const
+{
+  DecodedPayload decoded;
+  decoded.type = CMqttHistory::FORMAT_TEXT;
+  decoded.vscpEncoding = CMqttVscpDecoder::ENCODING_NONE;
+  decoded.vscpMeasurement = false;
+  const QByteArray payload(msg.m_payload.data(), static_cast<int>(msg.m_payload.size()));
+  decoded.raw = QString::fromUtf8(payload);
+
+  if (payload.size() > kMaxDecodeSize) {
+    decoded.type = CMqttHistory::FORMAT_BINARY;
+    decoded.format = tr("Binary");
+    decoded.formatted = tr("Payload skipped for performance");
+    return decoded;
+  }
+
+  vscp_event_t* pev = decodeVscpEvent(msg, &decoded.vscpEncoding);
+  if (nullptr != pev) {
+    decoded.vscpMeasurement = vscp_isMeasurement(pev);
+    decoded.vscpFields = buildVscpFields(pev, decoded.vscpEncoding);
+    vscp_deleteEvent(pev);
+  }
+
+  // The sniffed format tells which decoder to try so other
+  // payloads are never run through a parser
+  switch (msg.m_format) {
+    case CMqttHistory::FORMAT_JSON: {
+      QJsonParseError jsonErr;
+      decoded.json = QJsonDocument::fromJson(payload, &jsonErr);
+      if (QJsonParseError::NoError == jsonErr.error &&
+          (decoded.json.isObject() || decoded.json.isArray())) {
+        decoded.type = CMqttHistory::FORMAT_JSON;
+        decoded.format = tr("JSON");
+        decoded.formatted = QString::fromUtf8(decoded.json.toJson(QJsonDocument::Indented));
+        return decoded;
+      }
+      decoded.json = QJsonDocument();
+      break;
     }
 
-    if (isTopicNode) {
-      QString label = item->text(0);
-      if (label.startsWith("● ")) {
-        label.remove(0, 2);
+    case CMqttHistory::FORMAT_XML: {
+      const QString trimmed = decoded.raw.trimmed();
+      if (trimmed.endsWith('>')) {
+        const QString xmlDisplay = buildXmlDisplay(trimmed);
+        if (!xmlDisplay.isEmpty()) {
+          decoded.type = CMqttHistory::FORMAT_XML;
+          decoded.format = tr("XML");
+          decoded.formatted = xmlDisplay;
+          return decoded;
+        }
       }
-      item->setText(0, label);
+      break;
     }
-  });
-}
 
-void
-CFrmMqttExplorer::appendMessageNode(QTreeWidgetItem* topicNode,
-                                    const QString& topic,
-                                    const QByteArray& payload,
-                                    const QString& formattedPayload,
-                                    const QString& format,
-                                    bool retained,
-                                    int qos,
-                                    int mid)
-{
-  if (nullptr == topicNode) {
-    return;
-  }
+    case CMqttHistory::FORMAT_BINARY:
+      decoded.type = CMqttHistory::FORMAT_BINARY;
+      decoded.format = tr("Binary");
+      decoded.formatted = QString::fromLatin1(payload.toHex(' '));
+      decoded.raw = decoded.formatted;
+      return decoded;
 
-  const QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz");
-  QString preview = QString::fromUtf8(payload);
-  preview.replace('\n', " ");
-  preview.replace('\r', " ");
-  preview = preview.trimmed();
-  if (preview.size() > 140) {
-    preview = preview.left(137) + "...";
-  }
-  const QString topicDisplay = topic.isEmpty() ? tr("<empty>") : topic;
-  const QString firstLine = topicDisplay;
-  auto* msgItem = new QTreeWidgetItem({ firstLine, preview.isEmpty() ? tr("<empty>") : preview });
-
-  const QString previousPayload = topicNode->childCount() > 0
-                                    ? topicNode->child(topicNode->childCount() - 1)->data(0, RolePayloadRaw).toString()
-                                    : QString();
-  const bool valueChanged = !previousPayload.isEmpty() && previousPayload != QString::fromUtf8(payload);
-  msgItem->setData(0, RoleKind, KindMessage);
-  msgItem->setForeground(0, QColor(retained ? "#7c3aed" : "#0f766e"));
-  msgItem->setForeground(1, valueChanged ? QColor("#16a34a") : QColor("#16a34a"));
-  msgItem->setData(0, RoleTopic, topic);
-  msgItem->setData(0, RolePayloadRaw, QString::fromUtf8(payload));
-  msgItem->setData(0, RolePayloadFormatted, formattedPayload);
-  msgItem->setData(0, RoleTimestamp, timestamp);
-  msgItem->setData(0, RolePayloadFormat, format);
-  msgItem->setData(0, RoleRetained, retained);
-  msgItem->setData(0, RolePayloadSize, payload.size());
-  msgItem->setData(0, RoleQos, qos);
-  msgItem->setData(0, RoleMid, mid);
-  const QString metaText = format + "\nqos:" + QString::number(qos) + "\n" + (retained ? "retained yes" : "retained no");
-  msgItem->setData(0,
-                   RoleSearchText,
-                   (buildSearchText(topic, payload, formattedPayload) + "\n" + metaText).toLower());
-  topicNode->addChild(msgItem);
-
-  for (QTreeWidgetItem* current = topicNode; nullptr != current; current = current->parent()) {
-    const int count = current->data(0, RoleMessageCount).toInt();
-    current->setData(0, RoleMessageCount, count + 1);
-  }
-
-  if (m_comboReceiveMode->currentData().toInt() == ReceiveReplace) {
-    flashItemHighlight(topicNode);
-  }
-  else {
-    flashItemHighlight(topicNode);
+    default:
+      break;
   }
 
-  const auto selected = m_tree->selectedItems();
-  if (!selected.isEmpty()) {
-    auto* selectedItem = selected.first();
-    const bool sameTopic = selectedItem->data(0, RoleTopic).toString() == topic ||
-                           (selectedItem == topicNode) ||
-                           (selectedItem->parent() == topicNode);
-    if (sameTopic) {
-      refreshSelectedDetails();
-    }
+  decoded.format = tr("Text");
+  decoded.formatted = decoded.raw;
+  return decoded;
+}
+
+vscp_event_t*
+CFrmMqttExplorer::decodeVscpEvent(const CMqttHistory::message& msg, uint8_t* pencoding) const
+{
+  // Payloads that are not VSCP are rejected before they are copied
+  if (CMqttVscpDecoder::ENCODING_NONE == CMqttVscpDecoder::detect(msg.m_payload)) {
+    return nullptr;
   }
 
-  constexpr int kMaxMessagesPerTopic = 250;
-  if (m_comboReceiveMode->currentData().toInt() == ReceiveReplace) {
-    while (topicNode->childCount() > 0) {
-      delete topicNode->takeChild(0);
-    }
+  vscp_event_t* pev = nullptr;
+  if (!vscp_newEvent(&pev)) {
+    return nullptr;
   }
-  else {
-    while (topicNode->childCount() > kMaxMessagesPerTopic) {
-      delete topicNode->takeChild(0);
-    }
+
+  const uint8_t encoding = CMqttVscpDecoder::decode(std::string(msg.m_payload), pev);
+  if (CMqttVscpDecoder::ENCODING_NONE == encoding) {
+    vscp_deleteEvent(pev);
+    return nullptr;
   }
 
+  if (nullptr != pencoding) {
+    *pencoding = encoding;
+  }
+  return pev;
 }
 
-QString
-CFrmMqttExplorer::formatPayloadForDisplay(const QByteArray& payload,
-                                          QString* outFormat) const
+QList<QPair<QString, QString>>
+CFrmMqttExplorer::buildVscpFields(const vscp_event_t* pev, uint8_t encoding) const
 {
-  if (payload.size() > 256 * 1024) {
-    if (nullptr != outFormat) {
-      *outFormat = tr("Binary");
-    }
-    return tr("Payload skipped for performance");
+  QList<QPair<QString, QString>> fields;
+  std::string str;
+
+  fields.append({ tr("Encoding"), CMqttVscpDecoder::encodingToString(encoding) });
+  fields.append({ tr("Class"), QString("%1 (%2)").arg(vscpClassToken(pev->vscp_class)).arg(pev->vscp_class) });
+  fields.append({ tr("Type"),
+                  QString("%1 (%2)").arg(vscpTypeToken(pev->vscp_class, pev->vscp_type)).arg(pev->vscp_type) });
+  vscp_writeGuidArrayToString(str, pev->GUID);
+  fields.append({ tr("GUID"), QString::fromStdString(str) });
+  fields.append({ tr("Head"), QString("0x%1").arg(pev->head, 4, 16, QChar('0')) });
+  fields.append({ tr("OBID"), QString::number(pev->obid) });
+  fields.append({ tr("Timestamp"), QString::number(pev->timestamp) });
+  vscp_writeDataToString(str, pev);
+  fields.append({ tr("Data"), QString::fromStdString(str) });
+
+  double value = 0;
+  if (vscp_isMeasurement(pev) && vscp_getMeasurementAsDouble(&value, const_cast<vscp_event_t*>(pev))) {
+    fields.append({ tr("Measurement"), QString::number(value) });
   }
 
-  const QString raw = QString::fromUtf8(payload);
-  const QString trimmed = raw.trimmed();
+  return fields;
+}
 
-  QJsonParseError jsonErr;
-  const auto jsonDoc = QJsonDocument::fromJson(payload, &jsonErr);
-  if (QJsonParseError::NoError == jsonErr.error &&
-      (jsonDoc.isObject() || jsonDoc.isArray())) {
-    if (nullptr != outFormat) {
-      *outFormat = tr("JSON");
-    }
-    return QString::fromUtf8(jsonDoc.toJson(QJsonDocument::Indented));
+const CFrmMqttExplorer::DecodedPayload*
+CFrmMqttExplorer::decodedPayloadFor(const QModelIndex& index, CMqttHistory::message& msg) const
+{
+  uint64_t seq = 0;
+  if (!index.isValid() || !m_model->getMessage(index, msg, &seq)) {
+    return nullptr;
   }
 
-  if (trimmed.startsWith('<') && trimmed.endsWith('>')) {
-    const QString xmlDisplay = buildXmlDisplay(trimmed);
-    if (!xmlDisplay.isEmpty()) {
-      if (nullptr != outFormat) {
-        *outFormat = tr("XML");
-      }
-      return xmlDisplay;
+  // A message is identified by its topic node and sequence number
+  const auto key = std::make_pair(m_model->getNodeId(index), seq);
+  for (auto it = m_decodedCache.begin(); it != m_decodedCache.end(); ++it) {
+    if (it->first == key) {
+      m_decodedCache.splice(m_decodedCache.begin(), m_decodedCache, it);
+      return &m_decodedCache.front().second;
     }
   }
 
-  if (nullptr != outFormat) {
-    *outFormat = tr("Text");
+  m_decodedCache.emplace_front(key, decodePayload(msg));
+  while (m_decodedCache.size() > kDecodedCacheSize) {
+    m_decodedCache.pop_back();
   }
-  return raw;
+  return &m_decodedCache.front().second;
 }
 
 QString
@@ -1588,51 +1534,66 @@ CFrmMqttExplorer::buildXmlDisplay(const QString& xml) const
   return out.trimmed();
 }
 
-QString
-CFrmMqttExplorer::buildSearchText(const QString& topic,
-                                  const QByteArray& payload,
-                                  const QString& formatted) const
+void
+CFrmMqttExplorer::onFilterChanged(const QString& filter)
 {
-  return topic + "\n" + QString::fromUtf8(payload) + "\n" + formatted;
+  Q_UNUSED(filter);
+  m_filterTimer->start();
 }
 
-bool
-CFrmMqttExplorer::applyFilterRecursive(QTreeWidgetItem* item,
-                                        const QString& filterLower,
-                                        const QString& topicFilterLower)
+void
+CFrmMqttExplorer::onTopicFilterChanged(const QString& filter)
 {
-  if (nullptr == item) {
-    return false;
-  }
-
-  const bool matches = itemMatchesFilter(item, filterLower, topicFilterLower);
-  bool visible = matches;
+  Q_UNUSED(filter);
+  m_filterTimer->start();
+}
 
-  for (int i = 0; i < item->childCount(); ++i) {
-    visible = applyFilterRecursive(item->child(i), filterLower, topicFilterLower) || visible;
+void
+CFrmMqttExplorer::applyFilter()
+{
+  // The model evaluates the filter on a worker thread and resets
+  // itself when the result is ready
+  const QString filter = m_editFilter ? m_editFilter->text() : QString();
+  const QString topicFilter = m_editTopicFilter ? m_editTopicFilter->text() : QString();
+  m_model->setFilter(filter, topicFilter);
+  if (m_model->isFilterPending()) {
+    setStatus(tr("Filtering..."));
   }
-
-  item->setHidden(!visible);
-  return visible;
 }
 
 void
-CFrmMqttExplorer::onFilterChanged(const QString& filter)
+CFrmMqttExplorer::onModelAboutToBeReset()
 {
-  const QString lower = filter.trimmed().toLower();
-  const QString topicLower = m_editTopicFilter ? m_editTopicFilter->text().trimmed().toLower() : QString();
-  for (int i = 0; i < m_tree->topLevelItemCount(); ++i) {
-    applyFilterRecursive(m_tree->topLevelItem(i), lower, topicLower);
+  // Rows are rebuilt from the filter result, keep expanded topics
+  // and the selection
+  m_expandedNodes.clear();
+  for (const auto id : m_model->getExposedNodes()) {
+    if (m_tree->isExpanded(m_model->indexForNode(id))) {
+      m_expandedNodes.push_back(id);
+    }
   }
+  m_selectedNode = m_model->getNodeId(selectedIndex());
 }
 
 void
-CFrmMqttExplorer::onTopicFilterChanged(const QString& filter)
+CFrmMqttExplorer::onModelReset()
 {
-  const QString lower = filter.trimmed().toLower();
-  const QString generalLower = m_editFilter ? m_editFilter->text().trimmed().toLower() : QString();
-  for (int i = 0; i < m_tree->topLevelItemCount(); ++i) {
-    applyFilterRecursive(m_tree->topLevelItem(i), generalLower, lower);
+  for (const auto id : m_expandedNodes) {
+    const QModelIndex index = m_model->indexForNode(id);
+    if (index.isValid()) {
+      m_tree->expand(index);
+    }
+  }
+  m_expandedNodes.clear();
+
+  const QModelIndex index = m_model->indexForNode(m_selectedNode);
+  if (index.isValid()) {
+    m_tree->selectionModel()->setCurrentIndex(index,
+                                              QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+  }
+
+  if (m_model->isFiltered()) {
+    setStatus(tr("Filter applied"));
   }
 }
 
@@ -1640,12 +1601,7 @@ void
 CFrmMqttExplorer::refreshSelectedDetails()
 {
   QTimer::singleShot(0, this, [this]() {
-    const auto selected = m_tree->selectedItems();
-    if (selected.isEmpty()) {
-      return;
-    }
-
-    if (selected.first()->treeWidget() != m_tree) {
+    if (!selectedIndex().isValid()) {
       return;
     }
 
@@ -1653,51 +1609,67 @@ CFrmMqttExplorer::refreshSelectedDetails()
   });
 }
 
-QString
-CFrmMqttExplorer::buildSelectedTopicSummary(QTreeWidgetItem* item) const
+QModelIndex
+CFrmMqttExplorer::selectedIndex() const
 {
-  if (nullptr == item || item->data(0, RoleKind).toInt() != KindTopicNode) {
-    return QString();
+  if (nullptr == m_tree || nullptr == m_tree->selectionModel()) {
+    return QModelIndex();
   }
 
-  int topicCount = 0;
-  for (int i = 0; i < item->childCount(); ++i) {
-    auto* child = item->child(i);
-    if (nullptr != child && child->data(0, RoleKind).toInt() == KindTopicNode) {
-      ++topicCount;
-    }
+  const QModelIndexList selected = m_tree->selectionModel()->selectedRows(CMqttTopicModel::COL_TOPIC);
+  if (selected.isEmpty()) {
+    return QModelIndex();
   }
 
-  const int messageCount = item->data(0, RoleMessageCount).toInt();
-  return tr("Summary: %1 topics, %2 messages under this topic").arg(topicCount).arg(messageCount);
+  return selected.first();
 }
 
 QString
-CFrmMqttExplorer::buildDetailsText(QTreeWidgetItem* item) const
+CFrmMqttExplorer::buildSelectedTopicSummary(const QModelIndex& index) const
 {
-  if (nullptr == item) {
+  if (!index.isValid() || m_model->isMessage(index)) {
+    return QString();
+  }
+
+  const CMqttTopicTrie::node& node = m_model->getTrie().getNode(m_model->getNodeId(index));
+  return tr("Summary: %1 topics, %2 messages under this topic")
+    .arg(node.m_children.size())
+    .arg(node.m_subtreeCount);
+}
+
+QString
+CFrmMqttExplorer::buildDetailsText(const QModelIndex& index) const
+{
+  if (!index.isValid()) {
     return QString();
   }
 
+  CMqttHistory::message msg;
+  const DecodedPayload* decoded = decodedPayloadFor(index, msg);
+
   QString text;
   QTextStream stream(&text);
-  stream << tr("Topic") << ": " << item->data(0, RoleTopic).toString() << "\n";
-  if (!item->data(0, RoleTimestamp).toString().isEmpty()) {
-    stream << tr("Timestamp") << ": " << item->data(0, RoleTimestamp).toString() << "\n";
+  stream << tr("Topic") << ": " << m_model->getTopic(index) << "\n";
+  if (nullptr == decoded) {
+    return text.trimmed();
   }
-  if (!item->data(0, RolePayloadFormat).toString().isEmpty()) {
-    stream << tr("Format") << ": " << item->data(0, RolePayloadFormat).toString() << "\n";
-  }
-  if (item->data(0, RoleQos).isValid()) {
-    stream << tr("QoS") << ": " << item->data(0, RoleQos).toInt() << "\n";
+
+  stream << tr("Timestamp") << ": " << formatTimestamp(msg.m_timestamp) << "\n";
+  stream << tr("Format") << ": " << decoded->format << "\n";
+  stream << tr("QoS") << ": " << static_cast<int>(msg.m_qos) << "\n";
+  stream << tr("Retained") << ": " << (msg.m_retained ? tr("yes") : tr("no")) << "\n";
+  stream << tr("Bytes") << ": " << static_cast<qulonglong>(msg.m_payload.size()) << "\n";
+  if (msg.m_mid > 0) {
+    stream << tr("Message id") << ": " << msg.m_mid << "\n";
   }
-  stream << tr("Retained") << ": " << (item->data(0, RoleRetained).toBool() ? tr("yes") : tr("no")) << "\n";
-  stream << tr("Bytes") << ": " << item->data(0, RolePayloadSize).toInt() << "\n";
-  if (item->data(0, RoleMid).toInt() > 0) {
-    stream << tr("Message id") << ": " << item->data(0, RoleMid).toInt() << "\n";
+  if (!decoded->vscpFields.isEmpty()) {
+    stream << "\n" << tr("VSCP event") << ":\n";
+    for (const auto& field : decoded->vscpFields) {
+      stream << "  " << field.first << ": " << field.second << "\n";
+    }
   }
-  stream << "\n" << tr("Decoded payload") << ":\n" << item->data(0, RolePayloadFormatted).toString()
-         << "\n\n" << tr("Raw payload") << ":\n" << item->data(0, RolePayloadRaw).toString() << "\n";
+  stream << "\n" << tr("Decoded payload") << ":\n" << decoded->formatted
+         << "\n\n" << tr("Raw payload") << ":\n" << decoded->raw << "\n";
 
   return text.trimmed();
 }
@@ -1767,63 +1739,57 @@ CFrmMqttExplorer::addXmlNode(const QString& xml,
 
 void
 CFrmMqttExplorer::renderMessageTree(const QString& topic,
-                                    const QString& format,
-                                    const QString& formattedPayload,
-                                    const QString& rawPayload,
-                                    bool retained,
-                                    int payloadSize,
-                                    int qos,
-                                    int mid,
-                                    const QString& timestamp)
+                                    const CMqttHistory::message& msg,
+                                    const DecodedPayload& decoded)
 {
+  const QString timestamp = formatTimestamp(msg.m_timestamp);
+  const QString& format = decoded.format;
+
   m_detailsTree->clear();
   auto* root = new QTreeWidgetItem(m_detailsTree, { tr("Message"), "" });
   new QTreeWidgetItem(root, { tr("Topic"), topic });
   new QTreeWidgetItem(root, { tr("Timestamp"), timestamp });
   new QTreeWidgetItem(root, { tr("Receive timestamp"), timestamp });
   new QTreeWidgetItem(root, { tr("Format"), format });
-  new QTreeWidgetItem(root, { tr("QoS"), QString::number(qos) });
-  new QTreeWidgetItem(root, { tr("Retained"), retained ? "yes" : "no" });
-  new QTreeWidgetItem(root, { tr("Bytes"), QString::number(payloadSize) });
-  if (mid > 0) {
-    new QTreeWidgetItem(root, { tr("Message id"), QString::number(mid) });
+  new QTreeWidgetItem(root, { tr("QoS"), QString::number(msg.m_qos) });
+  new QTreeWidgetItem(root, { tr("Retained"), msg.m_retained ? "yes" : "no" });
+  new QTreeWidgetItem(root, { tr("Bytes"), QString::number(msg.m_payload.size()) });
+  if (msg.m_mid > 0) {
+    new QTreeWidgetItem(root, { tr("Message id"), QString::number(msg.m_mid) });
+  }
+
+  if (!decoded.vscpFields.isEmpty()) {
+    // Class and type are the second and third field
+    auto* vscpNode = new QTreeWidgetItem(root,
+                                         { tr("VSCP event"),
+                                           decoded.vscpFields.at(1).second + " / " + decoded.vscpFields.at(2).second });
+    for (const auto& field : decoded.vscpFields) {
+      new QTreeWidgetItem(vscpNode, { field.first, field.second });
+    }
   }
 
   auto* payloadNode = new QTreeWidgetItem(root, { tr("Payload"), format.isEmpty() ? tr("Text") : format });
-  if ("JSON" == format) {
-    QJsonParseError jsonErr;
-    const auto doc = QJsonDocument::fromJson(rawPayload.toUtf8(), &jsonErr);
-    if (QJsonParseError::NoError == jsonErr.error) {
-      if (doc.isObject()) {
-        const auto obj = doc.object();
-        for (auto it = obj.begin(); it != obj.end(); ++it) {
-          addJsonNode(it.key(), it.value(), payloadNode);
-        }
-      }
-      else if (doc.isArray()) {
-        const auto arr = doc.array();
-        for (int i = 0; i < arr.size(); ++i) {
-          addJsonNode(QString("[%1]").arg(i), arr.at(i), payloadNode);
-        }
-      }
-      else {
-        new QTreeWidgetItem(payloadNode, { tr("Decoded"), formatRichTextBlock(colorizeJsonContent(formattedPayload)) });
-      }
+  if (decoded.json.isObject()) {
+    const auto obj = decoded.json.object();
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+      addJsonNode(it.key(), it.value(), payloadNode);
     }
-    else {
-      new QTreeWidgetItem(payloadNode, { tr("Decoded"), formatRichTextBlock(colorizeJsonContent(formattedPayload)) });
+  }
+  else if (decoded.json.isArray()) {
+    const auto arr = decoded.json.array();
+    for (int i = 0; i < arr.size(); ++i) {
+      addJsonNode(QString("[%1]").arg(i), arr.at(i), payloadNode);
     }
   }
-  else if ("XML" == format) {
-    const QString xmlDisplay = formattedPayload.isEmpty() ? buildXmlDisplay(rawPayload) : formattedPayload;
-    new QTreeWidgetItem(payloadNode, { tr("Decoded"), formatRichTextBlock(colorizeXmlContent(xmlDisplay)) });
+  else if (CMqttHistory::FORMAT_XML == decoded.type) {
+    new QTreeWidgetItem(payloadNode, { tr("Decoded"), formatRichTextBlock(colorizeXmlContent(decoded.formatted)) });
   }
   else {
-    new QTreeWidgetItem(payloadNode, { tr("Decoded"), formatRichTextBlock(formattedPayload) });
+    new QTreeWidgetItem(payloadNode, { tr("Decoded"), formatRichTextBlock(decoded.formatted) });
   }
 
   auto* rawNode = new QTreeWidgetItem(root, { tr("Raw payload"), tr("Text") });
-  auto* rawTextNode = new QTreeWidgetItem(rawNode, { tr("Value"), formatRichTextBlock(rawPayload) });
+  auto* rawTextNode = new QTreeWidgetItem(rawNode, { tr("Value"), formatRichTextBlock(decoded.raw) });
   rawTextNode->setForeground(1, QColor("#334155"));
 
   m_detailsTree->expandToDepth(2);
@@ -1832,211 +1798,319 @@ CFrmMqttExplorer::renderMessageTree(const QString& topic,
 void
 CFrmMqttExplorer::onTreeSelectionChanged()
 {
-  const auto selected = m_tree->selectedItems();
-  if (selected.isEmpty()) {
+  const QModelIndex index = selectedIndex();
+  if (!index.isValid()) {
     m_detailsTree->clear();
     return;
   }
 
-  auto* item            = selected.first();
-  auto* displayItem     = item;
-  const int kind        = item->data(0, RoleKind).toInt();
-  const QString topic   = item->data(0, RoleTopic).toString();
-
-  if (kind != KindTopicNode && nullptr != item->parent() &&
-      item->parent()->data(0, RoleKind).toInt() == KindTopicNode) {
-    displayItem = item->parent();
-  }
-
-  if (displayItem->data(0, RoleKind).toInt() == KindTopicNode) {
-    item = displayItem;
-  }
-
-  if (item->data(0, RoleKind).toInt() == KindTopicNode) {
-    QString raw = item->data(0, RolePayloadRaw).toString();
-    QString decoded = item->data(0, RolePayloadFormatted).toString();
-    QString format = item->data(0, RolePayloadFormat).toString();
-    bool retained = item->data(0, RoleRetained).toBool();
-    int payloadSize = item->data(0, RolePayloadSize).toInt();
-    int qos = item->data(0, RoleQos).toInt();
-    int mid = item->data(0, RoleMid).toInt();
-    QString stamp = item->data(0, RoleTimestamp).toString();
-
-    if (item->childCount() > 0) {
-      auto* latestChild = item->child(item->childCount() - 1);
-      if (nullptr != latestChild) {
-        raw = latestChild->data(0, RolePayloadRaw).toString();
-        decoded = latestChild->data(0, RolePayloadFormatted).toString();
-        format = latestChild->data(0, RolePayloadFormat).toString();
-        retained = latestChild->data(0, RoleRetained).toBool();
-        payloadSize = latestChild->data(0, RolePayloadSize).toInt();
-        qos = latestChild->data(0, RoleQos).toInt();
-        mid = latestChild->data(0, RoleMid).toInt();
-        stamp = latestChild->data(0, RoleTimestamp).toString();
-      }
-    }
+  const QString topic = m_model->getTopic(index);
+  CMqttHistory::message msg;
 
-    if (!raw.isEmpty()) {
-      renderMessageTree(topic, format, decoded, raw, retained, payloadSize, qos, mid, stamp);
-      const QString summary = buildSelectedTopicSummary(item);
-      if (!summary.isEmpty()) {
-        auto* root = m_detailsTree->topLevelItem(0);
-        if (nullptr != root) {
-          auto* summaryNode = new QTreeWidgetItem(root, { tr("Summary"), summary });
-          summaryNode->setForeground(1, QColor("#64748b"));
-        }
-      }
-      return;
-    }
-
-    m_detailsTree->clear();
-    auto* root = new QTreeWidgetItem(m_detailsTree, { tr("Topic node"), "" });
-    new QTreeWidgetItem(root, { tr("Topic"), topic });
-    const QString summary = buildSelectedTopicSummary(item);
+  // Payloads are only decoded for the message that is shown
+  const DecodedPayload* decoded = decodedPayloadFor(index, msg);
+  if (nullptr != decoded) {
+    renderMessageTree(topic, msg, *decoded);
+    const QString summary = buildSelectedTopicSummary(index);
     if (!summary.isEmpty()) {
-      new QTreeWidgetItem(root, { tr("Summary"), summary });
-    }
-    if (!raw.isEmpty()) {
-      new QTreeWidgetItem(root, { tr("Last payload"), raw.left(120) });
-      new QTreeWidgetItem(root, { tr("Bytes"), QString::number(item->data(0, RolePayloadSize).toInt()) });
+      auto* root = m_detailsTree->topLevelItem(0);
+      if (nullptr != root) {
+        auto* summaryNode = new QTreeWidgetItem(root, { tr("Summary"), summary });
+        summaryNode->setForeground(1, QColor("#64748b"));
+      }
     }
-    m_detailsTree->expandToDepth(1);
     return;
   }
 
-  const QString raw     = item->data(0, RolePayloadRaw).toString();
-  const QString decoded = item->data(0, RolePayloadFormatted).toString();
-  const QString format  = item->data(0, RolePayloadFormat).toString();
-  const bool retained   = item->data(0, RoleRetained).toBool();
-  const int payloadSize = item->data(0, RolePayloadSize).toInt();
-  const int qos         = item->data(0, RoleQos).toInt();
-  const int mid         = item->data(0, RoleMid).toInt();
-  const QString stamp   = item->data(0, RoleTimestamp).toString();
+  m_detailsTree->clear();
+  auto* root = new QTreeWidgetItem(m_detailsTree, { tr("Topic node"), "" });
+  new QTreeWidgetItem(root, { tr("Topic"), topic });
+  const QString summary = buildSelectedTopicSummary(index);
+  if (!summary.isEmpty()) {
+    new QTreeWidgetItem(root, { tr("Summary"), summary });
+  }
+  m_detailsTree->expandToDepth(1);
+}
 
-  renderMessageTree(topic, format, decoded, raw, retained, payloadSize, qos, mid, stamp);
-  if (!decoded.isEmpty()) {
-    m_detailsTree->clear();
-    auto* root = new QTreeWidgetItem(m_detailsTree, { tr("Message"), decoded });
-    new QTreeWidgetItem(root, { tr("Topic"), topic });
-    new QTreeWidgetItem(root, { tr("Format"), format });
-    new QTreeWidgetItem(root, { tr("Retained"), retained ? tr("yes") : tr("no") });
-    new QTreeWidgetItem(root, { tr("Bytes"), QString::number(payloadSize) });
-    m_detailsTree->expandToDepth(1);
+void
+CFrmMqttExplorer::onTreeContextMenu(const QPoint& pos)
+{
+  const QModelIndex index = m_tree->indexAt(pos);
+  if (!index.isValid()) {
+    return;
   }
+
+  m_tree->selectionModel()->setCurrentIndex(index,
+                                            QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+
+  CMqttHistory::message msg;
+  const DecodedPayload* decoded = decodedPayloadFor(index, msg);
+
+  QMenu menu(this);
+  QAction* actMeasurement = menu.addAction(tr("Open measurement view"),
+                                           this,
+                                           &CFrmMqttExplorer::onOpenMeasurementView);
+  actMeasurement->setEnabled((nullptr != decoded) && decoded->vscpMeasurement);
+  menu.exec(m_tree->viewport()->mapToGlobal(pos));
 }
 
-QJsonArray collectMessageJson(QTreeWidgetItem* rootItem,
-                              const QString& filterText,
-                              const QString& topicFilterText)
+void
+CFrmMqttExplorer::onOpenMeasurementView()
 {
-  QJsonArray items;
-  if (nullptr == rootItem) {
-    return items;
+  const QModelIndex index = selectedIndex();
+  CMqttHistory::message msg;
+  if (!index.isValid() || !m_model->getMessage(index, msg)) {
+    return;
   }
 
-  const auto collect = [&](QTreeWidgetItem* item, auto&& self) -> void {
-    if (nullptr == item) {
-      return;
+  vscp_event_t* pev = decodeVscpEvent(msg);
+  if ((nullptr == pev) || !vscp_isMeasurement(pev)) {
+    if (nullptr != pev) {
+      vscp_deleteEvent(pev);
     }
+    setStatus(tr("The selected message is not a VSCP measurement event"), true);
+    return;
+  }
 
-    bool isVisibleInTree = !item->isHidden();
-    for (QTreeWidgetItem* ancestor = item->parent(); nullptr != ancestor; ancestor = ancestor->parent()) {
-      if (ancestor->isHidden()) {
-        isVisibleInTree = false;
-        break;
-      }
-    }
+  CMeasurementSourceSpec source;
+  source.vscpClass   = pev->vscp_class;
+  source.vscpType    = pev->vscp_type;
+  source.sensorIndex = vscp_getMeasurementSensorIndex(pev);
+  source.unit        = vscp_getMeasurementUnit(pev);
+  memcpy(source.guid.data(), pev->GUID, 16);
+
+  std::string strGuid;
+  vscp_writeGuidArrayToString(strGuid, pev->GUID);
+
+  const QString sourceDescription =
+    tr("Topic=%1, Class=%2, Type=%3, Sensor=%4, Unit=%5, GUID=%6")
+      .arg(m_model->getTopic(index))
+      .arg(vscpClassToken(pev->vscp_class))
+      .arg(vscpTypeToken(pev->vscp_class, pev->vscp_type))
+      .arg(source.sensorIndex)
+      .arg(source.unit)
+      .arg(strGuid.c_str());
+
+  CFrmMeasurementView* pview = new CFrmMeasurementView(source, sourceDescription, this);
+  m_measurementViews.push_back(pview);
+
+  connect(pview, &QObject::destroyed, this, [this, pview]() {
+    m_measurementViews.erase(std::remove(m_measurementViews.begin(), m_measurementViews.end(), pview),
+                             m_measurementViews.end());
+    m_ingest.setEventForwarding(!m_measurementViews.empty());
+  });
 
-    const int kind = item->data(0, kItemRoleKind).toInt();
-    const bool shouldExport = isVisibleInTree &&
-                              ((kind == kItemKindMessage) ||
-                               (kind == kItemKindTopicNode && item->childCount() == 0 &&
-                                !item->data(0, Qt::UserRole + 3).toString().isEmpty()));
-
-    if (shouldExport) {
-      QJsonObject entry;
-      const QString topic = item->data(0, Qt::UserRole + 2).toString();
-      const QString payload = item->data(0, Qt::UserRole + 3).toString();
-      const QString formatted = item->data(0, Qt::UserRole + 4).toString();
-      const QString format = item->data(0, Qt::UserRole + 6).toString();
-      const QString timestamp = item->data(0, Qt::UserRole + 5).toString();
-      entry["topic"] = topic.isEmpty() ? item->text(0) : topic;
-      entry["payload"] = payload.isEmpty() ? item->text(1) : payload;
-      entry["formatted"] = formatted;
-      entry["format"] = format;
-      entry["retained"] = item->data(0, kItemRoleRetained).toBool();
-      entry["qos"] = item->data(0, kItemRoleQos).toInt();
-      entry["mid"] = item->data(0, Qt::UserRole + 11).toInt();
-      entry["timestamp"] = timestamp;
-      items.append(entry);
-    }
+  // The ingest worker only queues measurement events while a view is open
+  m_ingest.setEventForwarding(true);
 
-    for (int i = 0; i < item->childCount(); ++i) {
-      self(item->child(i), self);
-    }
-  };
+  pview->appendMeasurement(pev);
+  pview->show();
+  vscp_deleteEvent(pev);
+}
 
-  collect(rootItem, collect);
-  return items;
+void
+CFrmMqttExplorer::onDecodeVscpToggled(bool checked)
+{
+  m_ingest.setVscpDecoding(checked);
+  setStatus(checked ? tr("VSCP decoding enabled") : tr("VSCP decoding disabled"));
 }
 
-QString buildVisibleMessageText(QTreeWidget* tree,
-                                 const QString& filterText,
-                                 const QString& topicFilterText)
+void
+CFrmMqttExplorer::forwardMeasurements()
 {
-  Q_UNUSED(filterText);
-  Q_UNUSED(topicFilterText);
+  std::vector<vscp_event_t*> events;
+  m_ingest.takeEvents(events);
 
-  if (nullptr == tree) {
-    return QString();
+  for (auto pev : events) {
+    for (auto* pview : m_measurementViews) {
+      pview->appendMeasurement(pev);
+    }
+    vscp_deleteEvent(pev);
   }
+}
 
-  QStringList blocks;
-  const auto collectVisible = [&](QTreeWidgetItem* item, auto&& self) -> void {
-    if (nullptr == item) {
-      return;
+void
+CFrmMqttExplorer::updateStats()
+{
+  // Rates decay also when nothing is received
+  m_model->refreshStats();
+  updateVscpStats();
+  updateCaptureStatus();
+  updateBulkStatus();
+}
+
+void
+CFrmMqttExplorer::updateVscpStats()
+{
+  std::map<uint32_t, uint64_t> counts;
+  m_ingest.getVscpCounts(counts);
+
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  const double seconds = (m_vscpCountsTime > 0) ? static_cast<double>(now - m_vscpCountsTime) / 1000 : 0;
+
+  for (const auto& item : counts) {
+    const uint16_t vscpClass = static_cast<uint16_t>(item.first >> 16);
+    const uint16_t vscpType = static_cast<uint16_t>(item.first & 0xffff);
+
+    QTreeWidgetItem*& row = m_vscpItems[item.first];
+    if (nullptr == row) {
+      row = new QTreeWidgetItem(m_vscpTree,
+                                { vscpClassToken(vscpClass), vscpTypeToken(vscpClass, vscpType), "", "" });
+      row->setToolTip(0, QString::number(vscpClass));
+      row->setToolTip(1, QString::number(vscpType));
+      row->setTextAlignment(2, Qt::AlignRight);
+      row->setTextAlignment(3, Qt::AlignRight);
     }
 
-    bool isVisibleInTree = !item->isHidden();
-    for (QTreeWidgetItem* ancestor = item->parent(); nullptr != ancestor; ancestor = ancestor->parent()) {
-      if (ancestor->isHidden()) {
-        isVisibleInTree = false;
-        break;
-      }
+    const auto last = m_vscpCounts.find(item.first);
+    const uint64_t delta = item.second - ((last != m_vscpCounts.end()) ? last->second : 0);
+    row->setText(2, QString::number(item.second));
+    row->setText(3, (seconds > 0) ? QString::number(static_cast<double>(delta) / seconds, 'f', 1) : QString());
+  }
+
+  m_vscpCounts.swap(counts);
+  m_vscpCountsTime = now;
+}
+
+void
+CFrmMqttExplorer::updateCaptureStatus()
+{
+  if (nullptr == m_lblCapture) {
+    return;
+  }
+
+  const bool replaying = m_replay.isRunning();
+  m_actStartCapture->setEnabled(!m_capture.isOpen());
+  m_actStopCapture->setEnabled(m_capture.isOpen());
+  m_actStartReplay->setEnabled(!replaying && !m_bulk.isRunning());
+  m_actStopReplay->setEnabled(replaying);
+
+  QStringList parts;
+  if (m_capture.isOpen()) {
+    const CMqttCaptureWriter::counters cnt = m_capture.getCounters();
+    QString text = tr("Capture: %1 msgs %2 MB")
+                     .arg(cnt.m_messages)
+                     .arg(static_cast<double>(cnt.m_bytes) / (1024 * 1024), 0, 'f', 1);
+    if (cnt.m_dropped) {
+      text += tr(" (%1 dropped)").arg(cnt.m_dropped);
     }
+    parts << text;
+  }
 
-    if (!isVisibleInTree) {
-      for (int i = 0; i < item->childCount(); ++i) {
-        self(item->child(i), self);
+  if (m_replayActive) {
+    const CMqttReplay::counters cnt = m_replay.getCounters();
+    if (replaying) {
+      parts << tr("Replay: %1% %2 msgs").arg(cnt.m_progress).arg(cnt.m_published);
+    }
+    else {
+      // Report a finished replay once
+      m_replayActive = false;
+      const int result = m_replay.getResult();
+      if (VSCP_ERROR_PARSING == result) {
+        setStatus(tr("Replay stopped at a damaged record, %1 messages published").arg(cnt.m_published), true);
+      }
+      else if ((VSCP_ERROR_SUCCESS == result) && (100 == cnt.m_progress)) {
+        setStatus(tr("Replay done, %1 messages published").arg(cnt.m_published), cnt.m_failed > 0);
+      }
+      else {
+        setStatus(tr("Replay stopped, %1 messages published").arg(cnt.m_published), true);
       }
-      return;
     }
+  }
+
+  m_lblCapture->setText(parts.join("   "));
+}
+
+void
+CFrmMqttExplorer::updateBulkStatus()
+{
+  if (nullptr == m_lblBulk) {
+    return;
+  }
+
+  const bool running = m_bulk.isRunning();
+  m_btnBulkPublish->setText(running ? tr("Stop bulk") : tr("Bulk publish..."));
+  m_btnBulkPublish->setEnabled(running || !m_replay.isRunning());
 
-    const QString topic = item->text(0).trimmed();
-    const QString payload = item->text(1).trimmed();
-    if (!topic.isEmpty() && (!payload.isEmpty() || item->childCount() == 0)) {
-      blocks << QString("Topic: %1\nPayload: %2")
+  if (!m_bulkActive) {
+    m_lblBulk->clear();
+    return;
+  }
+
+  // Achieved rate since the last update
+  const CMqttBulkPublisher::counters cnt = m_bulk.getCounters();
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  const double seconds = static_cast<double>(now - m_bulkTime) / 1000;
+  const double rate =
+    (seconds > 0) ? static_cast<double>(cnt.m_published - std::min(cnt.m_published, m_bulkPublished)) / seconds : 0;
+  m_bulkPublished = cnt.m_published;
+  m_bulkTime      = now;
+
+  if (running) {
+    m_lblBulk->setText(tr("Bulk: %1 of %2 msgs   %3 msg/s   In flight: %4")
+                         .arg(cnt.m_published)
+                         .arg(cnt.m_total)
+                         .arg(rate, 0, 'f', 0)
+                         .arg(cnt.m_inflight));
+    return;
+  }
+
+  // Report a finished run once
+  m_bulkActive = false;
+  m_lblBulk->clear();
+  if (VSCP_ERROR_SUCCESS != m_bulk.getResult()) {
+    setStatus(tr("Bulk publish stopped, connection lost after %1 messages").arg(cnt.m_published), true);
+  }
+  else if (cnt.m_published + cnt.m_failed < cnt.m_total) {
+    setStatus(tr("Bulk publish stopped after %1 of %2 messages").arg(cnt.m_published).arg(cnt.m_total));
+  }
+  else {
+    setStatus(tr("Bulk publish done, %1 messages published, %2 failed").arg(cnt.m_published).arg(cnt.m_failed),
+              cnt.m_failed > 0);
+  }
+}
+
+QString
+CFrmMqttExplorer::buildVisibleMessageText() const
+{
+  const CMqttTopicTrie& trie = m_model->getTrie();
+  const bool history = m_comboReceiveMode->currentData().toInt() == ReceiveAppend;
+
+  QStringList blocks;
+  const auto collectVisible = [&](uint32_t id, auto&& self) -> void {
+    const CMqttTopicTrie::node& node = trie.getNode(id);
+    if (CMqttTopicTrie::ROOT != id && !node.m_history.empty()) {
+      const QString topic = QString::fromStdString(trie.getTopic(id));
+      const size_t first = history ? 0 : node.m_history.size() - 1;
+      CMqttHistory::message value;
+      for (size_t i = first; i < node.m_history.size(); ++i) {
+        if (!node.m_history.get(i, value)) {
+          continue;
+        }
+        if (m_model->isFiltered() && !m_model->isVisible(id, value)) {
+          continue;
+        }
+        const QString payload = QString::fromUtf8(value.m_payload.data(), static_cast<int>(value.m_payload.size()));
+        blocks << QString("Topic: %1\nPayload: %2")
                     .arg(topic, payload.isEmpty() ? QStringLiteral("<empty>") : payload);
+      }
     }
 
-    for (int i = 0; i < item->childCount(); ++i) {
-      self(item->child(i), self);
+    for (const auto child : node.m_children) {
+      if (m_model->isVisible(child)) {
+        self(child, self);
+      }
     }
   };
 
-  for (int i = 0; i < tree->topLevelItemCount(); ++i) {
-    collectVisible(tree->topLevelItem(i), collectVisible);
-  }
-
+  collectVisible(CMqttTopicTrie::ROOT, collectVisible);
   return blocks.join("\n\n---\n\n");
 }
 
 void
 CFrmMqttExplorer::onSaveSelected()
 {
-  const QString filterText = m_editFilter ? m_editFilter->text() : QString();
-  const QString topicFilterText = m_editTopicFilter ? m_editTopicFilter->text() : QString();
-  const QString text = buildVisibleMessageText(m_tree, filterText, topicFilterText);
+  const QString text = buildVisibleMessageText();
   if (text.isEmpty()) {
     return;
   }
@@ -2144,85 +2218,73 @@ CFrmMqttExplorer::handleDisconnected(int rc)
 void
 CFrmMqttExplorer::flushPendingMessages()
 {
-  if (m_receivePaused) {
-    m_pendingMessages.clear();
-    return;
-  }
-
-  if (m_pendingMessages.isEmpty()) {
-    m_messageFlushTimer->stop();
-    return;
-  }
-
-  constexpr int kBatchSize = 20;
-  const bool shouldFilter = !m_editFilter->text().trimmed().isEmpty();
-
-  m_tree->setUpdatesEnabled(false);
-  m_detailsTree->setUpdatesEnabled(false);
-
-  for (int i = 0; i < kBatchSize && !m_pendingMessages.isEmpty(); ++i) {
-    const PendingMessage pending = m_pendingMessages.takeFirst();
-    QString format;
-    const QString formatted = formatPayloadForDisplay(pending.payload, &format);
-
-    QTreeWidgetItem* topicNode = ensureTopicPath(pending.topic);
-    updateTopicNodeWithMessage(topicNode,
-                                pending.topic,
-                                pending.payload,
-                                formatted,
-                                format,
-                                pending.retained,
-                                pending.qos,
-                                pending.mid);
-    appendMessageNode(topicNode,
-                      pending.topic,
-                      pending.payload,
-                      formatted,
-                      format,
-                      pending.retained,
-                      pending.qos,
-                      pending.mid);
-  }
+  std::vector<CMqttIngest::topicchange> changes;
+  m_ingest.takeChanges(changes);
+
+  if (!changes.empty()) {
+    const bool history = m_comboReceiveMode->currentData().toInt() == ReceiveAppend;
+    const uint32_t selected = m_model->isMessage(selectedIndex()) ? CMqttTopicTrie::NONE
+                                                                   : m_model->getNodeId(selectedIndex());
+    bool selectedChanged = false;
+    int rendered = 0;
+
+    // One model update per changed topic and frame
+    std::deque<CMqttTopicTrie::value> values;
+    for (auto& change : changes) {
+      for (auto& msg : change.m_messages) {
+        CMqttTopicTrie::value value;
+        value.m_payload = std::move(msg.m_payload);
+        value.m_timestamp = msg.m_timestamp;
+        value.m_mid = msg.m_mid;
+        value.m_qos = static_cast<uint8_t>(msg.m_qos);
+        value.m_retained = msg.m_retained;
+        values.push_back(std::move(value));
+      }
+      rendered += history ? static_cast<int>(values.size()) : std::min(1, static_cast<int>(values.size()));
 
-  if (shouldFilter) {
-    onFilterChanged(m_editFilter->text());
-  }
+      const uint32_t id = m_model->update(change.m_topic, change.m_count, change.m_bytes, values, history);
+      selectedChanged = selectedChanged || (id == selected);
+    }
 
-  m_tree->setUpdatesEnabled(true);
-  m_detailsTree->setUpdatesEnabled(true);
-  if (m_messageRenderCount != m_lastRenderedMessageCount) {
-    m_tree->viewport()->update();
-    m_detailsTree->viewport()->update();
-    m_lastRenderedMessageCount = m_messageRenderCount;
-  }
+    m_ingest.addRendered(rendered);
+    m_messageRenderCount += rendered;
+    if (m_messageRenderCount != m_lastRenderedMessageCount) {
+      m_tree->viewport()->update();
+      m_lastRenderedMessageCount = m_messageRenderCount;
+    }
 
-  if (m_pendingMessages.isEmpty()) {
-    m_messageFlushTimer->stop();
+    if (selectedChanged) {
+      refreshSelectedDetails();
+    }
   }
 
-  if (!m_tree->selectedItems().isEmpty()) {
-    refreshSelectedDetails();
-  }
+  forwardMeasurements();
+  m_model->expireHighlights();
+  updateIngestCounters();
 }
 
 void
-CFrmMqttExplorer::handleIncomingMessage(const QString& topic,
-                                        const QByteArray& payload,
-                                        bool retained,
-                                        int qos,
-                                        int mid)
+CFrmMqttExplorer::updateIngestCounters()
 {
-  if (m_receivePaused) {
+  if (nullptr == m_lblCounters) {
     return;
   }
 
-  m_pendingMessages.append(PendingMessage{ topic, payload, retained, qos, mid });
-  if (m_pendingMessages.size() > 300) {
-    m_pendingMessages.erase(m_pendingMessages.begin(), m_pendingMessages.begin() + 150);
-  }
-
-  if (!m_messageFlushTimer->isActive()) {
-    m_messageFlushTimer->start();
+  const CMqttIngest::counters cnt = m_ingest.getCounters();
+  const CMqttTopicTrie& trie = m_model->getTrie();
+  const QString text = tr("Received: %1   Rendered: %2   Dropped: %3   Superseded: %4   Queued: %5   Topics: %6   VSCP: %7   History: %8 of %9 MB")
+                         .arg(cnt.m_received)
+                         .arg(cnt.m_rendered)
+                         .arg(cnt.m_dropped)
+                         .arg(cnt.m_superseded)
+                         .arg(cnt.m_queued)
+                         .arg(cnt.m_topics)
+                         .arg(cnt.m_vscp)
+                         .arg(static_cast<double>(trie.getBytes()) / (1024 * 1024), 0, 'f', 1)
+                         .arg(static_cast<double>(trie.getBudget()) / (1024 * 1024), 0, 'f', 0);
+  if (m_lblCounters->text() != text) {
+    m_lblCounters->setText(text);
+    m_lblCounters->setStyleSheet((cnt.m_dropped || cnt.m_superseded) ? "QLabel { color: #c62828; }" : "QLabel { color: #475569; }");
   }
 }
 
@@ -2262,17 +2324,33 @@ CFrmMqttExplorer::onMosquittoMessageStatic(struct mosquitto*,
     return;
   }
 
-  const QString topic = QString::fromUtf8(message->topic ? message->topic : "");
-  QByteArray payload;
-  if (message->payloadlen > 0 && nullptr != message->payload) {
-    payload = QByteArray(static_cast<const char*>(message->payload), message->payloadlen);
+  // Never blocks, the frame timer picks the message up from the ingest worker
+  self->m_ingest.push(message->topic,
+                      message->payload,
+                      message->payloadlen,
+                      message->retain,
+                      message->qos,
+                      message->mid);
+
+  if (self->m_capture.isOpen()) {
+    self->m_capture.write(message->topic,
+                          message->payload,
+                          message->payloadlen,
+                          message->qos,
+                          message->retain);
+  }
+}
+
+void
+CFrmMqttExplorer::onMosquittoPublishStatic(struct mosquitto*,
+                                           void* userdata,
+                                           int mid)
+{
+  auto* self = static_cast<CFrmMqttExplorer*>(userdata);
+  if (nullptr == self) {
+    return;
   }
-  const bool retained = message->retain;
-  const int qos       = message->qos;
-  const int mid       = message->mid;
 
-  QMetaObject::invokeMethod(
-    self,
-    [self, topic, payload, retained, qos, mid]() { self->handleIncomingMessage(topic, payload, retained, qos, mid); },
-    Qt::QueuedConnection);
+  self->m_replay.onPublished(mid);
+  self->m_bulk.onPublished(mid);
 }
@@ -3,13 +3,25 @@
 
 #include "vscp-client-base.h"
 
+#include "mqttbulkpublish.h"
+#include "mqttcapture.h"
+#include "mqttingest.h"
+#include "mqttreplay.h"
+#include "mqtttopicmodel.h"
+
 #include <QByteArray>
 #include <QDialog>
-#include <QHash>
+#include <QJsonDocument>
 #include <QList>
+#include <QPair>
 #include <QSet>
 #include <QTimer>
 
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
 struct mosquitto;
 struct mosquitto_message;
 
@@ -24,8 +36,13 @@ class QJsonValue;
 class QAction;
 class QMenu;
 class QMenuBar;
+class QStatusBar;
+class QModelIndex;
+class QTreeView;
 class QTreeWidget;
 class QTreeWidgetItem;
+class QPoint;
+class CFrmMeasurementView;
 
 class CFrmMqttExplorer : public QDialog {
   Q_OBJECT
@@ -37,6 +54,7 @@ public:
 private slots:
   void onConnectClicked();
   void onPublishClicked();
+  void onBulkPublishClicked();
   void onSubscribeClicked();
   void onUnsubscribeClicked();
   void onAddPublishTopic();
@@ -51,44 +69,37 @@ private slots:
   void onFilterChanged(const QString& filter);
   void onTopicFilterChanged(const QString& filter);
   void onTreeSelectionChanged();
+  void onTreeContextMenu(const QPoint& pos);
+  void onOpenMeasurementView();
+  void onDecodeVscpToggled(bool checked);
+  void updateStats();
+  void onModelAboutToBeReset();
+  void onModelReset();
   void onSaveSelected();
   void onPauseReceiveClicked();
   void onReceiveModeChanged(int index);
   void onSaveSelectedEvent();
+  void onStartCapture();
+  void onStopCapture();
+  void onStartReplay();
+  void onStopReplay();
   void flushPendingMessages();
   void handleConnected(int rc);
   void handleDisconnected(int rc);
-  void handleIncomingMessage(const QString& topic,
-                             const QByteArray& payload,
-                             bool retained,
-                             int qos,
-                             int mid);
 
 private:
-  enum ItemRole {
-    RoleKind = Qt::UserRole + 1,
-    RoleTopic,
-    RolePayloadRaw,
-    RolePayloadFormatted,
-    RoleSearchText,
-    RoleTimestamp,
-    RolePayloadFormat,
-    RoleRetained,
-    RolePayloadSize,
-    RoleQos,
-    RoleMid,
-    RoleMessageCount
-  };
-
-  enum ItemKind { KindTopicNode = 1, KindMessage = 2 };
   enum ReceiveMode { ReceiveAppend = 0, ReceiveReplace = 1 };
 
-  struct PendingMessage {
-    QString topic;
-    QByteArray payload;
-    bool retained;
-    int qos;
-    int mid;
+  // Payload decoded for display
+  struct DecodedPayload {
+    uint8_t type; // CMqttHistory::FORMAT_*
+    QString format;
+    QString formatted;
+    QString raw;
+    QJsonDocument json;
+    uint8_t vscpEncoding; // CMqttVscpDecoder::ENCODING_*
+    bool vscpMeasurement;
+    QList<QPair<QString, QString>> vscpFields;
   };
 
   void setupUi();
@@ -105,47 +116,24 @@ private:
                       int qos,
                       bool retain);
 
-  QTreeWidgetItem* ensureTopicPath(const QString& topic);
-  void pruneTopicNode(QTreeWidgetItem* item);
-  void pruneTopicNodeIndexIfNeeded();
-  void updateTopicNodeWithMessage(QTreeWidgetItem* topicNode,
-                                  const QString& topic,
-                                  const QByteArray& payload,
-                                  const QString& formattedPayload,
-                                  const QString& format,
-                                  bool retained,
-                                  int qos,
-                                  int mid);
-  void appendMessageNode(QTreeWidgetItem* topicNode,
-                         const QString& topic,
-                         const QByteArray& payload,
-                         const QString& formattedPayload,
-                         const QString& format,
-                         bool retained,
-                         int qos,
-                         int mid);
-  QString formatPayloadForDisplay(const QByteArray& payload,
-                                  QString* outFormat = nullptr) const;
+  QModelIndex selectedIndex() const;
+  void applyFilter();
+  DecodedPayload decodePayload(const CMqttHistory::message& msg) const;
+  vscp_event_t* decodeVscpEvent(const CMqttHistory::message& msg, uint8_t* pencoding = nullptr) const;
+  QList<QPair<QString, QString>> buildVscpFields(const vscp_event_t* pev, uint8_t encoding) const;
+  void forwardMeasurements();
+  void updateVscpStats();
+  void updateCaptureStatus();
+  void updateBulkStatus();
+  const DecodedPayload* decodedPayloadFor(const QModelIndex& index, CMqttHistory::message& msg) const;
   QString buildXmlDisplay(const QString& xml) const;
-  QString buildSearchText(const QString& topic,
-                          const QByteArray& payload,
-                          const QString& formatted) const;
-  void flashItemHighlight(QTreeWidgetItem* item);
-  bool applyFilterRecursive(QTreeWidgetItem* item,
-                            const QString& filterLower,
-                            const QString& topicFilterLower);
-  QString buildDetailsText(QTreeWidgetItem* item) const;
-  QString buildSelectedTopicSummary(QTreeWidgetItem* item) const;
+  QString buildDetailsText(const QModelIndex& index) const;
+  QString buildSelectedTopicSummary(const QModelIndex& index) const;
+  QString buildVisibleMessageText() const;
   void refreshSelectedDetails();
   void renderMessageTree(const QString& topic,
-                         const QString& format,
-                         const QString& formattedPayload,
-                         const QString& rawPayload,
-                         bool retained,
-                         int payloadSize,
-                         int qos,
-                         int mid,
-                         const QString& timestamp);
+                         const CMqttHistory::message& msg,
+                         const DecodedPayload& decoded);
   void addJsonNode(const QString& key,
                    const QJsonValue& value,
                    QTreeWidgetItem* parent);
@@ -154,6 +142,7 @@ private:
   void addPublishTopicIfMissing(const QString& topic);
   void addSubscriptionIfMissing(const QString& topic);
   void setStatus(const QString& status, bool error = false);
+  void updateIngestCounters();
   void applyTlsSettings();
   void subscribeConfiguredTopics();
 
@@ -166,6 +155,9 @@ private:
   static void onMosquittoMessageStatic(struct mosquitto* mosq,
                                        void* userdata,
                                        const struct mosquitto_message* message);
+  static void onMosquittoPublishStatic(struct mosquitto* mosq,
+                                       void* userdata,
+                                       int mid);
 
   json m_conn;
   struct mosquitto* m_mosq;
@@ -188,9 +180,30 @@ private:
   QSet<QString> m_subscriptions;
   QSet<QString> m_initialSubscriptions;
   QSet<QString> m_publishTopics;
-  QHash<QString, QTreeWidgetItem*> m_topicNodeByPath;
-  QList<PendingMessage> m_pendingMessages;
+  CMqttIngest m_ingest;
+  CMqttCaptureWriter m_capture;
+  CMqttReplay m_replay;
+  // True until a finished replay has been reported
+  bool m_replayActive;
+  CMqttBulkPublisher m_bulk;
+  // True until a finished bulk publish has been reported
+  bool m_bulkActive;
+  // Bulk messages published at last rate update
+  uint64_t m_bulkPublished;
+  qint64 m_bulkTime;
+  CMqttTopicModel* m_model;
+  // Decoded payloads for (topic node, sequence number), most recently used first
+  mutable std::list<std::pair<std::pair<uint32_t, uint64_t>, DecodedPayload>> m_decodedCache;
   QTimer* m_messageFlushTimer;
+  QTimer* m_filterTimer;
+  std::vector<uint32_t> m_expandedNodes;
+  uint32_t m_selectedNode;
+  // Decoded VSCP events per class/type at last rate update
+  std::map<uint32_t, uint64_t> m_vscpCounts;
+  std::map<uint32_t, QTreeWidgetItem*> m_vscpItems;
+  qint64 m_vscpCountsTime;
+  QTimer* m_statsTimer;
+  std::vector<CFrmMeasurementView*> m_measurementViews;
   int m_messageRenderCount;
   int m_lastRenderedMessageCount;
 
@@ -199,6 +212,7 @@ private:
   QPushButton* m_btnSubscribe;
   QPushButton* m_btnUnsubscribe;
   QPushButton* m_btnPublish;
+  QPushButton* m_btnBulkPublish;
   QPushButton* m_btnSave;
   QPushButton* m_btnAddPublishTopic;
   QPushButton* m_btnUsePublishTopic;
@@ -211,21 +225,33 @@ private:
   QLineEdit* m_editPublishTopic;
   QComboBox* m_comboPublishQos;
   QCheckBox* m_chkPublishRetain;
+  QCheckBox* m_chkDecodeVscp;
+  QCheckBox* m_chkHeatmap;
   QPlainTextEdit* m_editPublishPayload;
   QLineEdit* m_editFilter;
   QLineEdit* m_editTopicFilter;
   QListWidget* m_listPublishTopics;
-  QTreeWidget* m_tree;
+  QTreeView* m_tree;
   QTreeWidget* m_detailsTree;
+  QTreeWidget* m_vscpTree;
   QMenuBar* m_menuBar;
   QMenu* m_subscribeMenu;
+  QMenu* m_captureMenu;
   QAction* m_actConnect;
   QAction* m_actPauseReceive;
   QAction* m_actSubscribe;
   QAction* m_actUnsubscribe;
   QAction* m_actSubscribeConfigured;
   QAction* m_actClearSubscriptions;
+  QAction* m_actStartCapture;
+  QAction* m_actStopCapture;
+  QAction* m_actStartReplay;
+  QAction* m_actStopReplay;
   QLabel* m_lblStatus;
+  QStatusBar* m_statusBar;
+  QLabel* m_lblCounters;
+  QLabel* m_lblCapture;
+  QLabel* m_lblBulk;
 };
 
 #endif // CFRMMQTTEXPLORER_H
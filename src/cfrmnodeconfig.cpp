@@ -56,9 +56,14 @@
 #include <vscp-client-ws2.h>
 
 #include "cdlgeditdm.h"
+#include "cdlgfleetapply.h"
 #include "cdlgknownguid.h"
 #include "cdlgmdfremotevar.h"
+#include "cdlgquicksearch.h"
+#include "cdlgregisterdiff.h"
+#include "cdlgregisterwatch.h"
 #include "cdlgtxtsearch.h"
+#include "registerbatch.h"
 
 #include "cfrmnodeconfig.h"
 #include "ui_cfrmnodeconfig.h"
@@ -199,6 +204,7 @@ CFrmNodeConfig::CFrmNodeConfig(QWidget* parent, json* pconn)
   m_bMainInfo          = false;     // No main MDF info written yet to the info area
   m_registerSearchPos  = 0;         // No search performed
   m_remoteVarSearchPos = 0;         // No search performed
+  m_dlgQuickSearch     = nullptr;   // Created on first use
 
   int cnt         = ui->session_tabWidget->count();
   QTabBar* tabBar = ui->session_tabWidget->tabBar();
@@ -623,6 +629,11 @@ CFrmNodeConfig::CFrmNodeConfig(QWidget* parent, json* pconn)
           this,
           SLOT(onSelectSearchRegisters()));
 
+  connect(ui->actionQuick_search,
+          SIGNAL(triggered()),
+          this,
+          SLOT(onQuickSearch()));
+
   connect(ui->actionSearch_remote_variable,
           SIGNAL(triggered()),
           this,
@@ -897,10 +908,13 @@ CFrmNodeConfig::CFrmNodeConfig(QWidget* parent, json* pconn)
   addOpAction(tr("Write value(s) for selected row(s)"), SLOT(writeSelectedRegisterValues()));
   addOpAction(tr("Write default value(s) for selected row(s)"), SLOT(defaultSelectedRegisterValues()));
   addOpAction(tr("Set default values for ALL rows"), SLOT(defaultRegisterAll()));
+  addOpAction(tr("Watch selected register(s)..."), SLOT(watchSelectedRegisters()));
   operationsMenu->addSeparator();
   addOpAction(tr("Save selected registers"), SLOT(saveSelectedRegisterValues()));
   addOpAction(tr("Save ALL registers"), SLOT(saveAllRegisterValues()));
   addOpAction(tr("Load registers"), SLOT(loadRegisterValues()));
+  addOpAction(tr("Apply register set to nodes..."), SLOT(fleetApply()));
+  addOpAction(tr("Compare registers with other nodes/files..."), SLOT(diffRegisters()));
   addOpAction(tr("Goto register page..."), SLOT(gotoRegisterPage()));
 
   operationsMenu->addSeparator();
@@ -1357,14 +1371,14 @@ CFrmNodeConfig::onBaseChange(int index)
 void
 CFrmNodeConfig::onInterfaceChange(int index)
 {
-  ui->treeWidgetRegisters->clear();
-  ui->treeWidgetRemoteVariables->clear();
+  clearTrees();
   ui->treeWidgetDecisionMatrix->clear();
   ui->treeWidgetMdfFiles->clear();
   for (int i = 0; i < NUMBER_OF_TABS; i++) {
     m_saveInfoArea[i].clear();
   }
   m_nUpdates = 0;
+  showKnownNode();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1374,14 +1388,82 @@ CFrmNodeConfig::onInterfaceChange(int index)
 void
 CFrmNodeConfig::onNodeIdChange(int nodeid)
 {
-  ui->treeWidgetRegisters->clear();
-  ui->treeWidgetRemoteVariables->clear();
+  clearTrees();
   ui->treeWidgetDecisionMatrix->clear();
   ui->treeWidgetMdfFiles->clear();
   for (int i = 0; i < NUMBER_OF_TABS; i++) {
     m_saveInfoArea[i].clear();
   }
   m_nUpdates = 0;
+  showKnownNode();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// showKnownNode
+//
+
+void
+CFrmNodeConfig::showKnownNode(void)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  if ((nullptr == m_nodeidConfig) || !m_connObject.contains("uuid") || !m_connObject["uuid"].is_string()) {
+    return;
+  }
+
+  cguid guidInterface;
+  if (nullptr != m_comboInterface) {
+    guidInterface.getFromString(m_comboInterface->currentText().toStdString());
+  }
+
+  CNodeInventory::noderecord record;
+  if (!pworks->m_nodeInventory.lookup(m_connObject["uuid"].get<std::string>(),
+                                      guidInterface.getAsString(),
+                                      m_nodeidConfig->value(),
+                                      record)) {
+    ui->statusBar->clearMessage();
+    return;
+  }
+
+  ui->statusBar->showMessage(tr("Known node: %1 firmware %2, last seen %3")
+                               .arg(QString::fromStdString(record.m_name.empty() ? record.m_guid : record.m_name))
+                               .arg(QString::fromStdString(record.m_firmware))
+                               .arg(QString::fromStdString(record.m_lastSeen)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// updateInventory
+//
+
+void
+CFrmNodeConfig::updateInventory(void)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  if (nullptr == m_nodeidConfig) {
+    return;
+  }
+
+  cguid guidInterface;
+  if (nullptr != m_comboInterface) {
+    guidInterface.getFromString(m_comboInterface->currentText().toStdString());
+  }
+
+  cguid guid;
+  m_stdregs.getGUID(guid);
+
+  CNodeInventory::noderecord record;
+  if (m_connObject.contains("uuid") && m_connObject["uuid"].is_string()) {
+    record.m_connection = m_connObject["uuid"].get<std::string>();
+  }
+  record.m_interface = guidInterface.getAsString();
+  record.m_nodeid    = m_nodeidConfig->value();
+  record.m_bLevel2   = false;
+  record.m_guid      = guid.getAsString();
+  record.m_mdfUrl    = m_stdregs.getMDF();
+  record.m_firmware  = m_stdregs.getFirmwareVersionString();
+  record.m_name      = m_mdf.getModuleName();
+  pworks->m_nodeInventory.update(record);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1421,16 +1503,10 @@ CFrmNodeConfig::update(void)
       renderMdfFiles();
     }
     else {
-      // Write changes
+      // Write changes. writeChanges reports per register status
+      // to the user on failure.
       if (VSCP_ERROR_SUCCESS != writeChanges()) {
-        QApplication::beep();
         spdlog::error("Update: Failed to write changes to remote device.");
-        int ret = QMessageBox::warning(this,
-                                       tr(APPNAME),
-                                       tr("Failed to write changes to remote "
-                                          "device. Please retry operation."),
-                                       QMessageBox::Ok);
-
         return;
       }
     }
@@ -1498,6 +1574,10 @@ CFrmNodeConfig::writeChanges(void)
   guidNode = guidInterface;
   guidNode.setLSB(m_nodeidConfig->value()); // Set node id
 
+  // Collect all changed registers into one batch
+  CRegisterBatchWriter batch(*m_vscpClient, guidNode, guidInterface, pworks->m_config_timeout);
+  std::map<uint32_t, CRegisterWidgetItem*> mapItems;
+
   QTreeWidgetItemIterator item(ui->treeWidgetRegisters);
   while (*item) {
 
@@ -1506,47 +1586,86 @@ CFrmNodeConfig::writeChanges(void)
       CRegisterWidgetItem* itemReg = (CRegisterWidgetItem*)(*item);
 
       // Only interested in changed registers
-      if (!m_userregs.isChanged(itemReg->m_regOffset, itemReg->m_regPage)) {
-        ++item;
-        continue;
+      if (m_userregs.isChanged(itemReg->m_regOffset, itemReg->m_regPage)) {
+        uint8_t value = vscp_readStringValue((*item)->text(REG_COL_VALUE).toStdString());
+        batch.addRegister(itemReg->m_regPage, itemReg->m_regOffset, value);
+        mapItems[((uint32_t)itemReg->m_regPage << 8) + (itemReg->m_regOffset & 0xff)] = itemReg;
       }
+    }
+    ++item;
+  }
 
-      uint8_t value = vscp_readStringValue((*item)->text(REG_COL_VALUE).toStdString());
-      if (VSCP_ERROR_SUCCESS == (rv = vscp_writeLevel1Register(*m_vscpClient,
-                                                               guidNode,
-                                                               guidInterface,
-                                                               itemReg->m_regPage,
-                                                               itemReg->m_regOffset,
-                                                               value,
-                                                               pworks->m_config_timeout))) {
+  if (!batch.getCount()) {
+    ui->statusBar->showMessage(tr("No changed registers to write"));
+    QApplication::restoreOverrideCursor();
+    return VSCP_ERROR_SUCCESS;
+  }
 
-        m_userregs.setChangedState(itemReg->m_regOffset, itemReg->m_regPage, false);
+  auto statusCallback = [this](int progress, const char* str) {
+    ui->statusBar->showMessage(QString("%1 (%2%)").arg(str).arg(progress));
+    QApplication::processEvents();
+  };
 
-        (*item)->setText(REG_COL_VALUE,
-                         pworks->decimalToStringInBase(value, m_baseComboBox->currentIndex())
-                           .toStdString()
-                           .c_str());
-        (*item)->setForeground(REG_COL_VALUE, QBrush(QColor("royalblue")));
+  rv = batch.write(statusCallback);
+  spdlog::debug("Write changes: {}", batch.getSummary());
 
-        updateChangeDM(itemReg->m_regOffset, itemReg->m_regPage);
-        updateChangeRemoteVariable(itemReg->m_regOffset, itemReg->m_regPage);
-      }
-      else {
-        QApplication::beep();
-        spdlog::error("Failed to write register(s) rv = {0}  {1}:{2}", rv, itemReg->m_regPage, itemReg->m_regOffset);
-        QString str = tr("Failed to write register(s) rv = ") + QString::number(rv);
-        str += QString("reg={}:{}").arg(itemReg->m_regPage).arg(itemReg->m_regOffset);
-        ui->statusBar->showMessage(str);
-        QApplication::restoreOverrideCursor();
-        return VSCP_ERROR_COMMUNICATION;
+  // Offer to restore the pre-write image if the device is left half written
+  if ((VSCP_ERROR_SUCCESS != rv) && batch.canRollback()) {
+    QApplication::restoreOverrideCursor();
+    QApplication::beep();
+    if (QMessageBox::Yes ==
+        QMessageBox::question(this,
+                              tr(APPNAME),
+                              tr("Failed to write and verify all changed registers.\n\n%1\n\n"
+                                 "Restore the registers on the device to the values they had "
+                                 "before the write?")
+                                .arg(batch.getSummary().c_str()),
+                              QMessageBox::Yes | QMessageBox::No)) {
+      QApplication::setOverrideCursor(Qt::WaitCursor);
+      if (VSCP_ERROR_SUCCESS != batch.rollback(statusCallback)) {
+        spdlog::error("Write changes: Failed to restore pre-write image.");
       }
+      QApplication::restoreOverrideCursor();
     }
-    ++item;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
   }
 
-  ui->statusBar->showMessage(tr("Changed registers written OK"));
+  // Mark registers that made it to the device. Everything else is still
+  // a pending change and is left red so it can be retried.
+  for (auto const& result : batch.getResults()) {
+    if (CRegisterBatchWriter::regstatus::VERIFIED != result.second.m_status) {
+      continue;
+    }
+
+    CRegisterWidgetItem* itemReg = mapItems[result.first];
+    m_userregs.setChangedState(itemReg->m_regOffset, itemReg->m_regPage, false);
+
+    itemReg->setText(REG_COL_VALUE,
+                     pworks->decimalToStringInBase(result.second.m_newValue, m_baseComboBox->currentIndex())
+                       .toStdString()
+                       .c_str());
+    itemReg->setForeground(REG_COL_VALUE, QBrush(QColor("royalblue")));
+
+    updateChangeDM(itemReg->m_regOffset, itemReg->m_regPage);
+    updateChangeRemoteVariable(itemReg->m_regOffset, itemReg->m_regPage);
+  }
+
+  ui->statusBar->showMessage(batch.getSummary().c_str());
   QApplication::restoreOverrideCursor();
 
+  if (VSCP_ERROR_SUCCESS != rv) {
+    QApplication::beep();
+    spdlog::error("Failed to write register(s) rv = {0}", rv);
+    QMessageBox msgBox(this);
+    msgBox.setIcon(QMessageBox::Warning);
+    msgBox.setWindowTitle(tr(APPNAME));
+    msgBox.setText(tr("Failed to write changed registers to the remote device.\n\n%1")
+                     .arg(batch.getSummary().c_str()));
+    msgBox.setDetailedText(batch.getReport().c_str());
+    msgBox.exec();
+    return VSCP_ERROR_COMMUNICATION;
+  }
+
   return VSCP_ERROR_SUCCESS;
 }
 
@@ -1633,39 +1752,22 @@ CFrmNodeConfig::doUpdate(std::string mdfpath)
   std::string url = m_stdregs.getMDF();
   spdlog::trace("Standard register getMDF = {}", url);
 
-  // create a temporary file name for remote MDF
-  std::string tempMdfFileName;
-  for (int i = 0; i < url.length(); i++) {
-    if ((url[i] == '/') || (url[i] == '\\')) {
-      tempMdfFileName += "_";
-    }
-    else {
-      tempMdfFileName += url[i];
-    }
-  }
-
-  // mkstemp()
-  std::string tempPath =
-    QStandardPaths::writableLocation(QStandardPaths::TempLocation)
-      .toStdString();
-  tempPath += "/";
-  tempPath += tempMdfFileName;
-
-  spdlog::debug("Temporary path: {}", tempPath);
-
   ui->statusBar->showMessage(tr("Downloading MDF file..."));
 
-  CURLcode curl_rv;
-  curl_rv = m_mdf.downLoadMDF(url, tempPath);
-  if (CURLE_OK != curl_rv) {
+  // The window edits its MDF so only the file is shared through the cache
+  std::string tempPath;
+  std::string hash;
+  if (VSCP_ERROR_SUCCESS != pworks->m_mdfCache.fetch(url, tempPath, hash)) {
     QApplication::beep();
     ui->statusBar->showMessage(tr("Failed to download MDF file for device."));
-    spdlog::error("Failed to download MDF {0} curl rv={1}", url, (int)curl_rv);
+    spdlog::error("Failed to download MDF {0}", url);
     QApplication::restoreOverrideCursor();
     ui->statusBar->removeWidget(pbar);
     return VSCP_ERROR_COMMUNICATION;
   }
 
+  spdlog::debug("MDF path: {}", tempPath);
+
   pbar->setValue(75);
   QApplication::processEvents();
 
@@ -1673,35 +1775,9 @@ CFrmNodeConfig::doUpdate(std::string mdfpath)
 
   // * * * Parse  MDF * * *
 
+  // A snapshot of the file is loaded instead if there is one
   ui->statusBar->showMessage(tr("Parsing MDF file..."));
-  try {
-    rv = m_mdf.parseMDF(tempPath);
-  }
-  catch (const std::exception& ex) {
-    QApplication::beep();
-    ui->statusBar->showMessage(tr("Failed to parse MDF file for device."));
-    spdlog::error("Failed to parse MDF {0}: {1}", tempPath, ex.what());
-    QMessageBox::warning(this,
-                         APPNAME,
-                         tr("Failed to parse MDF file.\n\nWhere: %1\nWhat: %2")
-                           .arg(QString::fromStdString(tempPath))
-                           .arg(QString::fromUtf8(ex.what())));
-    QApplication::restoreOverrideCursor();
-    ui->statusBar->removeWidget(pbar);
-    return VSCP_ERROR_PARSING;
-  }
-  catch (...) {
-    QApplication::beep();
-    ui->statusBar->showMessage(tr("Failed to parse MDF file for device."));
-    spdlog::error("Failed to parse MDF {0}: Unknown exception", tempPath);
-    QMessageBox::warning(this,
-                         APPNAME,
-                         tr("Failed to parse MDF file.\n\nWhere: %1\nWhat: Unknown exception while parsing.")
-                           .arg(QString::fromStdString(tempPath)));
-    QApplication::restoreOverrideCursor();
-    ui->statusBar->removeWidget(pbar);
-    return VSCP_ERROR_PARSING;
-  }
+  rv = pworks->m_mdfCache.load(tempPath, hash, m_mdf);
   if (VSCP_ERROR_SUCCESS != rv) {
     QApplication::beep();
     ui->statusBar->showMessage(tr("Failed to parse MDF file for device."));
@@ -1732,6 +1808,7 @@ CFrmNodeConfig::doUpdate(std::string mdfpath)
     return VSCP_ERROR_READ;
   }
   fillDeviceHtmlInfo();
+  updateInventory();
   m_bMainInfo = true;
   pbar->setValue(100);
   QApplication::processEvents();
@@ -1743,6 +1820,26 @@ CFrmNodeConfig::doUpdate(std::string mdfpath)
   return VSCP_ERROR_SUCCESS;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// loadLocalMdf
+//
+
+int
+CFrmNodeConfig::loadLocalMdf(const std::string& path)
+{
+  int rv = m_mdf.parseMDF(path);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    spdlog::error("Failed to parse local MDF {0} rv={1}", path, rv);
+    return rv;
+  }
+
+  // Values shown are not from the node so next update must be a full one
+  m_userregs.clearChanges();
+  m_nUpdates = 0;
+
+  return VSCP_ERROR_SUCCESS;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // onMainTabBarChanged
 //
@@ -2716,7 +2813,7 @@ CFrmNodeConfig::saveRegisterValues(bool bJSON, bool bAll)
 
   QString fileName = QFileDialog::getSaveFileName(this,
                                                   tr("Save registers to file"),
-                                                  /*"~/.vscpworks/device-registers.reg"*/ "/tmp/device-registers.reg",
+                                                  QDir(pworks->m_shareFolder).filePath("device-registers.reg"),
                                                   tr("Register Files (*.reg);;XML Files (*.xml);;JSON Files (*.json);;All Files (*.*)"));
   // std::cout << "Filename: |" << fileName.toStdString() << "|" << std::endl;
   if (fileName.isEmpty()) {
@@ -3087,375 +3184,410 @@ __endSetupRegisterParser(void* data, const char* name)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// loadXMLRegs
+// loadRegisterValues
 //
 
-int
-CFrmNodeConfig::loadXMLRegs(const std::string& path)
+void
+CFrmNodeConfig::loadRegisterValues(void)
 {
-  int rv = VSCP_ERROR_SUCCESS;
-  std::ifstream ifs;
-  __xml_parser_struct__ parsestruct;
-  parsestruct.errors           = 0;
-  parsestruct.depth_xml_parser = 0;
-
-  try {
-    ifs.open(path, std::ifstream::in);
-  }
-  catch (...) {
-    spdlog::error("Parse-RegisterXML: Failed to open register XML file.");
-    ui->statusBar->showMessage(tr("Failed to open register XML file %1.").arg(path.c_str()));
-    return VSCP_ERROR_PARSING;
-  }
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
 
-  XML_Parser xmlParser = XML_ParserCreate("UTF-8");
-  XML_SetUserData(xmlParser, &parsestruct);
-  XML_SetElementHandler(xmlParser, __startSetupRegisterParser, __endSetupRegisterParser);
-  XML_SetCharacterDataHandler(xmlParser, __handleRegisterParserData);
-
-  int bytes_read;
-  void* buf = XML_GetBuffer(xmlParser, XML_BUFF_SIZE);
-
-  while (ifs.good()) {
-    ifs.read((char*)buf, XML_BUFF_SIZE);
-    bytes_read = ifs.gcount();
-    if (bytes_read > 0) {
-      if (!XML_ParseBuffer(xmlParser, bytes_read, bytes_read == 0)) {
-        spdlog::error("Parse-RegisterXML: Failed parse register XML file at line {0} [{1}].",
-                      XML_GetCurrentLineNumber(xmlParser),
-                      XML_ErrorString(XML_GetErrorCode(xmlParser)));
-        ui->statusBar->showMessage(tr("Loaded registers failed due to parser error."));
-        rv = VSCP_ERROR_PARSING;
-        break;
-      }
-    }
+  QString path = QFileDialog::getOpenFileName(this,
+                                              tr("Load registers from file"),
+                                              QDir(pworks->m_shareFolder).filePath("device-registers.reg"),
+                                              tr("Register Files (*.reg);;XML Files (*.xml);;JSON Files (*.json);;All Files (*.*)"));
+  if (path.isEmpty()) {
+    return;
   }
 
-  XML_ParserFree(xmlParser);
-
-  if (parsestruct.errors) {
-    if (QMessageBox::Yes != QMessageBox::question(this, "XML Parser register load", "There was errors during load, continue anyway?")) {
-      ui->statusBar->showMessage(tr("Aborted loaded %1 registers due to errors (errors = %1).").arg(parsestruct.errors));
-      return VSCP_ERROR_SUCCESS;
-    }
+  registerset set;
+  int rv = readRegisterSet(path.toStdString(), set);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    spdlog::error("Load registers: Failed to load registers from file {}", path.toStdString());
+    QMessageBox::information(this, tr(APPNAME), tr("Failed to read register file %1:\n%2.").arg(path).arg(rv));
+    return;
   }
 
-  if (parsestruct.moduleName.size() && (parsestruct.moduleName != m_mdf.getModuleName())) {
+  if (set.m_moduleName.size() && (set.m_moduleName != m_mdf.getModuleName())) {
     int rv = QMessageBox::warning(this,
                                   tr(APPNAME),
                                   tr("Module name does not match. Continue anyway?"),
                                   QMessageBox::Yes | QMessageBox::No,
                                   QMessageBox::No);
     if (rv == QMessageBox::No) {
-      return false;
+      return;
     }
   }
 
-  if (parsestruct.moduleModel.size() && (parsestruct.moduleModel != m_mdf.getModuleModel())) {
+  if (set.m_moduleModel.size() && (set.m_moduleModel != m_mdf.getModuleModel())) {
     int rv = QMessageBox::warning(this,
                                   tr(APPNAME),
                                   tr("Module model does not match. Continue anyway?"),
                                   QMessageBox::Yes | QMessageBox::No,
                                   QMessageBox::No);
     if (rv == QMessageBox::No) {
-      return false;
+      return;
     }
   }
 
-  if (parsestruct.moduleVersion.size() && (parsestruct.moduleVersion != m_mdf.getModuleVersion())) {
+  if (set.m_moduleVersion.size() && (set.m_moduleVersion != m_mdf.getModuleVersion())) {
     int rv = QMessageBox::warning(this,
                                   tr(APPNAME),
                                   tr("Module version does not match. Continue anyway?"),
                                   QMessageBox::Yes | QMessageBox::No,
                                   QMessageBox::No);
     if (rv == QMessageBox::No) {
-      return false;
+      return;
     }
   }
 
   // If model information is missing warn about it
-  if (!parsestruct.moduleName.size() && !parsestruct.moduleModel.size() && !parsestruct.moduleVersion.size()) {
+  if (!set.m_moduleName.size() && !set.m_moduleModel.size() && !set.m_moduleVersion.size()) {
     int rv = QMessageBox::warning(this,
                                   tr(APPNAME),
                                   tr("There is no module information in the register file. Continue anyway?"),
                                   QMessageBox::Yes | QMessageBox::No,
                                   QMessageBox::No);
     if (rv == QMessageBox::No) {
-      return false;
+      return;
     }
   }
 
   // Write to registers
-  size_t regcnt       = parsestruct.registerList.size();
-  uint16_t regskipped = 0; // Regs skipped
-  for (auto& reg : parsestruct.registerList) {
+  uint16_t regcnt     = 0;             // Regs written
+  uint16_t regskipped = set.m_skipped; // Regs skipped
+  uint16_t errors     = 0;
+  for (const auto& reg : set.m_regs) {
 
-    // Invalid level I register offsets (standard registers)
-    if (reg->offset >= 0x80) {
+    uint16_t page  = reg.first >> 8;
+    uint8_t offset = reg.first & 0xff;
+
+    if (!m_mdf.isRegisterWriteable(offset, page)) {
       regskipped++;
-      spdlog::info("Parse-JSON registers: Offset ({0}:{1}) is out of range for a level I device. Skipped", reg->page, reg->offset);
+      spdlog::info("Load registers: Register is not writeable. {0}:{1}", page, offset);
       continue;
     }
 
-    if (m_mdf.isRegisterWriteable(reg->offset, reg->page)) {
-      parsestruct.errors++;
-      spdlog::error("Parse-JSON registers: Register is not writeable. {0}:{1}", reg->page, reg->offset);
-      parsestruct.errorStr += tr("Register is not writeable  %1:%2 = %3\n").arg(reg->page).arg(reg->offset).arg(reg->value).toStdString();
+    if (!m_userregs.putReg(offset, page, reg.second)) {
+      errors++;
+      spdlog::error("Load registers: Failed to write register {0}:{1}.", page, offset);
       continue;
     }
 
-    if (!m_userregs.putReg(reg->offset, reg->page, reg->value)) {
-      spdlog::error("Parse-RegisterXML: Failed to write register {0}:{1}.", reg->page, reg->offset);
-      rv = VSCP_ERROR_PARSING;
-      parsestruct.errors++;
-      parsestruct.errorStr += tr("Failed to write register  %1:%2 = %3\n").arg(reg->page).arg(reg->offset).arg(reg->value).toStdString();
-    }
-    delete reg;
+    regcnt++;
   }
 
-  ui->statusBar->showMessage(tr("Loaded %1 registers, %2 skipped (errors = %3).").arg(regcnt).arg(regskipped).arg(parsestruct.errors));
   updateVisualRegisters();
-
-  if (parsestruct.errors) {
-    spdlog::info(parsestruct.errorStr);
-  }
-
-  return rv;
+  ui->statusBar->showMessage(tr("Loaded %1 registers, %2 skipped (errors = %3).").arg(regcnt).arg(regskipped).arg(errors));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// loadJSONRegs
+// watchSelectedRegisters
 //
 
-int
-CFrmNodeConfig::loadJSONRegs(const std::string& path)
+void
+CFrmNodeConfig::watchSelectedRegisters(void)
 {
-  int rv = VSCP_ERROR_SUCCESS;
-  json j;
-  uint16_t regcnt     = 0; // Regs written
-  uint16_t regskipped = 0; // Regs skipped
-  // Module information
-  std::string moduleName;
-  std::string moduleModel;
-  std::string moduleVersion;
-  std::string moduleChangeDate;
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
 
-  try {
-    std::ifstream ifs(path, std::ifstream::in);
-    ifs >> j;
-    ifs.close();
-  }
-  catch (...) {
-    spdlog::error("Parse-JSON: Failed to load and  parse JSON register file.");
+  if (!m_vscpClient->isConnected()) {
     QMessageBox::warning(this,
                          tr(APPNAME),
-                         tr("Failed to load and parse JSON register file %1.").arg(path.c_str()),
-                         QMessageBox::Yes);
-    return false;
-  }
-
-  if (j.contains("module-name") && j["module-name"].is_string()) {
-    moduleName = j["module-name"];
-    if (moduleName.size() && (moduleName != m_mdf.getModuleName())) {
-      int rv = QMessageBox::warning(this,
-                                    tr(APPNAME),
-                                    tr("Module name does not match. Continue anyway?"),
-                                    QMessageBox::Yes | QMessageBox::No,
-                                    QMessageBox::No);
-      if (rv == QMessageBox::No) {
-        return false;
-      }
-    }
+                         tr("Need to be connected to perform this operation."),
+                         QMessageBox::Ok);
+    return;
   }
 
-  if (j.contains("module-model") && j["module-model"].is_string()) {
-    moduleModel = j["module-model"];
-    if (moduleModel.size() && (moduleModel != m_mdf.getModuleModel())) {
-      int rv = QMessageBox::warning(this,
-                                    tr(APPNAME),
-                                    tr("Module model does not match. Continue anyway?"),
-                                    QMessageBox::Yes | QMessageBox::No,
-                                    QMessageBox::No);
-      if (rv == QMessageBox::No) {
-        return false;
-      }
+  std::deque<CDlgRegisterWatch::watchreg> regs;
+  QList<QTreeWidgetItem*> listSelected = ui->treeWidgetRegisters->selectedItems();
+  for (auto item : listSelected) {
+    if (item->type() == TREE_LIST_REGISTER_TYPE) {
+      CRegisterWidgetItem* itemReg = (CRegisterWidgetItem*)item;
+      CDlgRegisterWatch::watchreg reg;
+      reg.m_page   = itemReg->m_regPage;
+      reg.m_offset = itemReg->m_regOffset;
+      reg.m_name   = item->text(REG_COL_NAME);
+      regs.push_back(reg);
     }
   }
 
-  if (j.contains("module-version") && j["module-version"].is_string()) {
-    moduleVersion = j["module-version"];
-    if (moduleVersion.size() && (moduleVersion != m_mdf.getModuleVersion())) {
-      int rv = QMessageBox::warning(this,
-                                    tr(APPNAME),
-                                    tr("Module version does not match. Continue anyway?"),
-                                    QMessageBox::Yes | QMessageBox::No,
-                                    QMessageBox::No);
-      if (rv == QMessageBox::No) {
-        return false;
-      }
-    }
+  if (regs.empty()) {
+    QMessageBox::information(this, tr(APPNAME), tr("Select the register(s) to watch first."));
+    return;
   }
 
-  if (j.contains("module-date") && j["module-date"].is_string()) {
-    moduleChangeDate = j["module-date"];
+  // CAN4VSCP interface
+  std::string str;
+  if (nullptr == m_comboInterface) {
+    str = "00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00";
   }
-
-  // If model information is missing warn about it
-  if (!moduleName.size() && !moduleModel.size() && !moduleVersion.size()) {
-    int rv = QMessageBox::warning(this,
-                                  tr(APPNAME),
-                                  tr("There is no module information in the register file. Continue anyway?"),
-                                  QMessageBox::Yes | QMessageBox::No,
-                                  QMessageBox::No);
-    if (rv == QMessageBox::No) {
-      return false;
-    }
+  else {
+    str = m_comboInterface->currentText().toStdString();
   }
+  cguid guidInterface;
+  guidInterface.getFromString(str);
 
-  if (!(j.contains("registers") && j["registers"].is_array())) {
-    spdlog::error("Parse-JSON registers: module info is not found. <<{}>>", j.dump());
-    ui->statusBar->showMessage(tr("JSON register load aborted: Parse-JSON registers: module info is not found.").arg(path.c_str()));
-    return VSCP_ERROR_PARSING;
-  }
-  else {
-    for (const auto& item : j["registers"].items()) {
+  // The watch owns the connection while it runs so the dialog is modal
+  CDlgRegisterWatch dlg(this,
+                        m_vscpClient,
+                        guidInterface,
+                        m_nodeidConfig->value(),
+                        regs,
+                        pworks->m_config_timeout);
+  dlg.exec();
+}
 
-      if (item.value().is_object()) {
+///////////////////////////////////////////////////////////////////////////////
+// readRegisterSet
+//
 
-        json jreg(item.value());
+int
+CFrmNodeConfig::readRegisterSet(const std::string& path, registerset& set)
+{
+  std::ifstream ifs;
+  std::string str;
+  bool bJSON = false;
+  bool bXML  = false;
 
-        // name is optional, page, offset, value must be present
-        if (!(jreg.contains("page") && jreg.contains("offset") && jreg.contains("value"))) {
-          spdlog::error("Parse-JSON registers: module info is not found. <<{}>>", jreg.dump());
-          ui->statusBar->showMessage(tr("JSON register load aborted: Format of JSON file is not correct."));
-          return VSCP_ERROR_PARSING;
-        }
-        else {
+  set = registerset();
 
-          int page   = jreg["page"];
-          int offset = jreg["offset"];
-          int value  = jreg["value"];
+  try {
+    ifs.open(path, std::ifstream::in);
+  }
+  catch (...) {
+    spdlog::error("Read register set: Failed to open file {}", path);
+    return VSCP_ERROR_READ;
+  }
 
-          if (offset >= 128) {
-            regskipped++;
-            spdlog::info("Parse-JSON registers: Offset ({0}:{1}) is out of range for a level I device. Skipped", page, offset);
-            continue;
-          }
+  // First non whitespace character tells the format
+  while (std::getline(ifs, str)) {
+    vscp_trim(str);
+    if (str.empty()) {
+      continue;
+    }
+    bJSON = ('{' == str[0]);
+    bXML  = ('<' == str[0]);
+    break;
+  }
+  ifs.close();
 
-          regcnt++;
+  if (bJSON) {
+    json j;
+    try {
+      std::ifstream ifsjson(path, std::ifstream::in);
+      ifsjson >> j;
+      ifsjson.close();
+    }
+    catch (...) {
+      spdlog::error("Read register set: Failed to parse JSON file {}", path);
+      return VSCP_ERROR_PARSING;
+    }
 
-          if (page < 0 || page > 0xffff) {
-            spdlog::error("Parse-JSON registers: page is out of range. <<{}>>", jreg.dump());
-            ui->statusBar->showMessage(tr("JSON register load aborted: 'page' parameter is out of range."));
-            return VSCP_ERROR_PARSING;
-          }
-          if (offset < 0 || offset > 255) {
-            spdlog::error("Parse-JSON registers: register is out of range. <<{}>>", jreg.dump());
-            ui->statusBar->showMessage(tr("JSON register load aborted: 'offset' parameter is out of range."));
-            return VSCP_ERROR_PARSING;
-          }
-          if (value < 0 || value > 255) {
-            spdlog::error("Parse-JSON registers: value is out of range. <<{}>>", jreg.dump());
-            ui->statusBar->showMessage(tr("JSON register load aborted: 'value' parameter is out of range."));
-            return VSCP_ERROR_PARSING;
-          }
+    if (j.contains("module-name") && j["module-name"].is_string()) {
+      set.m_moduleName = j["module-name"];
+    }
 
-          if (m_mdf.isRegisterWriteable(offset, page)) {
-            regskipped++;
-            spdlog::error("Parse-JSON registers: Register is not writeable. {0}:{1}", page, offset);
-            continue;
-          }
+    if (j.contains("module-model") && j["module-model"].is_string()) {
+      set.m_moduleModel = j["module-model"];
+    }
 
-          if (!m_userregs.putReg(offset, page, value)) {
-            spdlog::error("Parse-JSON registers: Failed to write register.");
-            ui->statusBar->showMessage(tr("JSON register load aborted: Unable to write register data."));
-            rv = VSCP_ERROR_PARSING;
-          }
+    if (j.contains("module-version") && j["module-version"].is_string()) {
+      set.m_moduleVersion = j["module-version"];
+    }
 
-          ui->statusBar->showMessage(tr("Loaded %1 registers. %2 skipped").arg(regcnt).arg(regskipped));
-          updateVisualRegisters();
-        }
+    if (!(j.contains("registers") && j["registers"].is_array())) {
+      spdlog::error("Read register set: No registers in JSON file {}", path);
+      return VSCP_ERROR_PARSING;
+    }
+
+    for (const auto& item : j["registers"].items()) {
+      json jreg(item.value());
+      if (!(jreg.is_object() && jreg.contains("page") && jreg.contains("offset") && jreg.contains("value"))) {
+        spdlog::error("Read register set: Invalid register object. <<{}>>", jreg.dump());
+        return VSCP_ERROR_PARSING;
       }
-      else {
-        spdlog::error("Parse-JSON registers: Register object invalid. <<{}>>", item.value().dump());
-        ui->statusBar->showMessage(tr("JSON register load aborted: Format of JSON file is not correct. Register object invalid."));
+      int page   = jreg["page"];
+      int offset = jreg["offset"];
+      int value  = jreg["value"];
+      if ((page < 0) || (page > 0xffff) || (offset < 0) || (offset > 255) || (value < 0) || (value > 255)) {
+        spdlog::error("Read register set: Register out of range. <<{}>>", jreg.dump());
         return VSCP_ERROR_PARSING;
       }
+      // Standard registers are never part of a register set
+      if (offset >= 0x80) {
+        set.m_skipped++;
+        continue;
+      }
+      set.m_regs[((uint32_t)page << 8) + offset] = value;
+    }
+  }
+  else if (bXML) {
+    int rv = VSCP_ERROR_SUCCESS;
+    __xml_parser_struct__ parsestruct;
+    parsestruct.errors           = 0;
+    parsestruct.depth_xml_parser = 0;
+
+    std::ifstream ifsxml(path, std::ifstream::in);
+    XML_Parser xmlParser = XML_ParserCreate("UTF-8");
+    XML_SetUserData(xmlParser, &parsestruct);
+    XML_SetElementHandler(xmlParser, __startSetupRegisterParser, __endSetupRegisterParser);
+    XML_SetCharacterDataHandler(xmlParser, __handleRegisterParserData);
+
+    void* buf = XML_GetBuffer(xmlParser, XML_BUFF_SIZE);
+    while (ifsxml.good()) {
+      ifsxml.read((char*)buf, XML_BUFF_SIZE);
+      int bytes_read = ifsxml.gcount();
+      if (bytes_read > 0) {
+        if (!XML_ParseBuffer(xmlParser, bytes_read, bytes_read == 0)) {
+          spdlog::error("Read register set: Failed parse XML file at line {0} [{1}].",
+                        XML_GetCurrentLineNumber(xmlParser),
+                        XML_ErrorString(XML_GetErrorCode(xmlParser)));
+          rv = VSCP_ERROR_PARSING;
+          break;
+        }
+      }
+    }
+
+    XML_ParserFree(xmlParser);
+
+    set.m_moduleName    = parsestruct.moduleName;
+    set.m_moduleModel   = parsestruct.moduleModel;
+    set.m_moduleVersion = parsestruct.moduleVersion;
+    for (auto& reg : parsestruct.registerList) {
+      if ((VSCP_ERROR_SUCCESS == rv) && !parsestruct.errors) {
+        if (reg->offset < 0x80) {
+          set.m_regs[((uint32_t)reg->page << 8) + reg->offset] = reg->value;
+        }
+        else {
+          set.m_skipped++;
+        }
+      }
+      delete reg;
+    }
+
+    if (VSCP_ERROR_SUCCESS != rv) {
+      return rv;
     }
+
+    if (parsestruct.errors) {
+      spdlog::error("Read register set: {}", parsestruct.errorStr);
+      return VSCP_ERROR_PARSING;
+    }
+  }
+  else {
+    spdlog::error("Read register set: Unknown format for file {}", path);
+    return VSCP_ERROR_INVALID_SYNTAX;
   }
 
-  return rv;
+  return VSCP_ERROR_SUCCESS;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// loadRegisterValues
+// fleetApply
 //
 
 void
-CFrmNodeConfig::loadRegisterValues(void)
+CFrmNodeConfig::fleetApply(void)
 {
-  int rv = VSCP_ERROR_SUCCESS;
-  std::ifstream ifs;
   vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
 
+  if (!m_vscpClient->isConnected()) {
+    QMessageBox::information(this, tr(APPNAME), tr("Must be connected to apply a register set to nodes."));
+    return;
+  }
+
   QString path = QFileDialog::getOpenFileName(this,
-                                              tr("Load registers from file"),
-                                              /*"~/.vscpworks/device-registers.reg"*/ "/tmp/device-registers.reg",
+                                              tr("Load register set to apply"),
+                                              QDir(pworks->m_shareFolder).filePath("device-registers.reg"),
                                               tr("Register Files (*.reg);;XML Files (*.xml);;JSON Files (*.json);;All Files (*.*)"));
-  // std::cout << "Filename: |" << fileName.toStdString() << "|" << std::endl;
   if (path.isEmpty()) {
     return;
   }
 
-  // Check format
-  // ------------
-  // If the file is a JSON file we will parse it
-  // as JSON else we will parse it as XML. The first
-  // character determines the type "{" for JSON or "<"
-  // for XML. Whitespace is ignored.
+  registerset set;
+  int rv = readRegisterSet(path.toStdString(), set);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    QMessageBox::information(this, tr(APPNAME), tr("Failed to read register set from %1:\n%2.").arg(path).arg(rv));
+    return;
+  }
+  std::map<uint32_t, uint8_t>& regs = set.m_regs;
+
+  // Only writeable registers can be applied. Without an MDF we have
+  // to trust the file.
+  if (m_mdf.getModuleName().size()) {
+    if (set.m_moduleName.size() && (set.m_moduleName != m_mdf.getModuleName())) {
+      if (QMessageBox::No == QMessageBox::warning(this,
+                                                  tr(APPNAME),
+                                                  tr("Module name does not match. Continue anyway?"),
+                                                  QMessageBox::Yes | QMessageBox::No,
+                                                  QMessageBox::No)) {
+        return;
+      }
+    }
+    for (auto it = regs.begin(); it != regs.end();) {
+      if (!m_mdf.isRegisterWriteable(it->first & 0xff, it->first >> 8)) {
+        spdlog::info("Fleet apply: Register is not writeable. {0}:{1}", it->first >> 8, it->first & 0xff);
+        it = regs.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+  }
 
-  try {
-    ifs.open(path.toStdString(), std::ifstream::in);
+  // CAN4VSCP interface
+  std::string str;
+  if (nullptr == m_comboInterface) {
+    str = "00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00";
   }
-  catch (...) {
-    spdlog::error("Load registers: Failed to open file {}", path.toStdString());
-    return;
+  else {
+    str = m_comboInterface->currentText().toStdString();
   }
+  cguid guidInterface;
+  guidInterface.getFromString(str);
+
+  CDlgFleetApply dlg(this,
+                     m_vscpClient,
+                     guidInterface,
+                     regs,
+                     QFileInfo(path).fileName(),
+                     pworks->m_config_timeout);
+  dlg.exec();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// diffRegisters
+//
+
+void
+CFrmNodeConfig::diffRegisters(void)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
 
-  size_t pos;
+  // CAN4VSCP interface
   std::string str;
+  if (nullptr == m_comboInterface) {
+    str = "00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00";
+  }
+  else {
+    str = m_comboInterface->currentText().toStdString();
+  }
+  cguid guidInterface;
+  guidInterface.getFromString(str);
 
-  while (std::getline(ifs, str)) {
+  CDlgRegisterDiff dlg(this,
+                       m_vscpClient,
+                       guidInterface,
+                       &m_mdf,
+                       pworks->m_config_timeout);
 
-    vscp_trim(str);
-    if ((pos = str.find('{')) != std::string::npos) {
-      spdlog::debug("Load registers: Register file format is JSON");
-      ifs.close();
-      rv = loadJSONRegs(path.toStdString());
-      if (VSCP_ERROR_SUCCESS != rv) {
-        spdlog::error("Load registers: Failed to load registers from file {}", path.toStdString());
-        QMessageBox::information(this, tr(APPNAME), tr("Failed to parse JSON file %1:\n%2.").arg(path).arg(rv));
-      }
-      break;
-    }
-    else if ((pos = str.find('<')) != std::string::npos) {
-      spdlog::debug("Load registers: MDF file format is XML");
-      ifs.close();
-      rv = loadXMLRegs(path.toStdString());
-      if (VSCP_ERROR_SUCCESS != rv) {
-        spdlog::error("Load registers: Failed to load registers from file {}", path.toStdString());
-        QMessageBox::information(this, tr(APPNAME), tr("Failed to parse XML file %1:\n%2.").arg(path).arg(rv));
-      }
-      break;
-    }
-    else {
-      ifs.close();
-      rv = VSCP_ERROR_INVALID_SYNTAX;
-      spdlog::error("Load registers: Failed to load registers from file {} - Invalid syntax", path.toStdString());
-      QMessageBox::information(this, tr(APPNAME), tr("Syntax error in register file %1:\n%2.").arg(path).arg(rv));
-      break;
-    }
+  // Registers already read from this node is the default reference
+  CRegisterImage image(QString("Node %1").arg(m_nodeidConfig->value()).toStdString());
+  if (image.fromUserRegisters(m_userregs)) {
+    dlg.addImage(image);
   }
+  dlg.refresh();
+  dlg.exec();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -3736,9 +3868,6 @@ CFrmNodeConfig::renderRegisters(void)
   int rv;
   vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
 
-  ui->treeWidgetRegisters->clear(); // Clear the tree
-  m_mapPageToPageHeader.clear();    // Clear the page map
-
   std::string str = "00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00";
   if (nullptr != m_comboInterface) {
     str = m_comboInterface->currentText().toStdString();
@@ -3751,6 +3880,44 @@ CFrmNodeConfig::renderRegisters(void)
   // node id
   guidNode.setLSB(m_nodeidConfig->value());
 
+  std::set<uint16_t> pages;
+  uint32_t nPages = m_mdf.getPages(pages);
+  spdlog::trace("MDF page count = {}", nPages);
+
+  // Get user registers for all pages
+  rv = m_userregs.init(*m_vscpClient, guidNode, guidInterface, pages, nullptr, pworks->m_config_timeout);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    std::cout << "Failed to read/read user regs: " << rv << std::endl;
+    QApplication::beep();
+    spdlog::error("Failed to init/read user registers rv={}", rv);
+    return rv;
+  }
+
+  if (VSCP_ERROR_SUCCESS != (rv = renderRegisterTree())) {
+    return rv;
+  }
+
+  // Clear changes and history as the registers just has been read.
+  // Not done in renderRegisterTree() as it also redraws unwritten edits.
+  m_userregs.clearChanges();
+  m_userregs.clearHistory();
+
+  m_nUpdates++; // Another update
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// renderRegisterTree
+//
+
+int
+CFrmNodeConfig::renderRegisterTree(void)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  clearTrees(true, false);
+
   // ----------------------------------------------------------
   // Fill status info
   // ----------------------------------------------------------
@@ -3767,17 +3934,7 @@ CFrmNodeConfig::renderRegisters(void)
   // Att top level pages
 
   std::set<uint16_t> pages;
-  uint32_t nPages = m_mdf.getPages(pages);
-  spdlog::trace("MDF page count = {}", nPages);
-
-  // Get user registers for all pages
-  rv = m_userregs.init(*m_vscpClient, guidNode, guidInterface, pages, nullptr, pworks->m_config_timeout);
-  if (VSCP_ERROR_SUCCESS != rv) {
-    std::cout << "Failed to read/read user regs: " << rv << std::endl;
-    QApplication::beep();
-    spdlog::error("Failed to init/read user registers rv={}", rv);
-    return rv;
-  }
+  m_mdf.getPages(pages);
 
   for (auto page : pages) {
 
@@ -3904,11 +4061,7 @@ CFrmNodeConfig::renderRegisters(void)
     }
   }
 
-  // Clear changes and history as this is the first load.
-  m_userregs.clearChanges();
-  m_userregs.clearHistory();
-
-  m_nUpdates++; // Another update
+  buildSearchIndex();
 
   return VSCP_ERROR_SUCCESS;
 }
@@ -4305,7 +4458,8 @@ CFrmNodeConfig::openRemoteVariableForRegister(uint32_t offset, uint16_t page, ui
   dlg.initDialogData(&m_mdf, pRemoteVariable);
   dlg.setReadOnly();
   if (QDialog::Accepted == dlg.exec()) {
-    renderRegisters();
+    renderRegisterTree();
+    updateVisualRegisters(); // Keep unwritten edits marked
     renderRemoteVariables();
   }
 
@@ -4355,7 +4509,8 @@ CFrmNodeConfig::addRemoteVariableForRegister(uint32_t offset, uint16_t page)
     }
 
     m_mdf.getRemoteVariableList()->push_back(pRemoteVariable);
-    renderRegisters();
+    renderRegisterTree();
+    updateVisualRegisters(); // Keep unwritten edits marked
     renderRemoteVariables();
     openRemoteVariableForRegister(offset, page);
   }
@@ -4374,7 +4529,7 @@ CFrmNodeConfig::renderRemoteVariables(void)
   // int rv;
   vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
 
-  ui->treeWidgetRemoteVariables->clear(); // Clear the tree
+  clearTrees(false, true);
   std::deque<CMDF_RemoteVariable*>* listRemoteVariables = m_mdf.getRemoteVariableList();
   for (auto const& item : *listRemoteVariables) {
 
@@ -4465,6 +4620,8 @@ CFrmNodeConfig::renderRemoteVariables(void)
     ui->treeWidgetRemoteVariables->addTopLevelItem(itemWidget);
   }
 
+  buildSearchIndex();
+
   return true;
 }
 
@@ -6000,6 +6157,180 @@ CFrmNodeConfig::fillMdfFileHtmlInfo(QTreeWidgetItem* widgetItem, int column)
 
 // ----------------------------------------------------------------------------
 
+///////////////////////////////////////////////////////////////////////////////
+// clearTrees
+//
+
+void
+CFrmNodeConfig::clearTrees(bool bRegisters, bool bRemoteVariables)
+{
+  if (bRegisters) {
+    ui->treeWidgetRegisters->clear();
+    m_mapPageToPageHeader.clear();
+  }
+
+  if (bRemoteVariables) {
+    ui->treeWidgetRemoteVariables->clear();
+  }
+
+  // The index and old results point to items that may be gone
+  m_searchIndex.clear();
+  m_searchListRegs.clear();
+  m_searchListRemoteVars.clear();
+  m_registerSearchPos  = 0;
+  m_remoteVarSearchPos = 0;
+
+  if (nullptr != m_dlgQuickSearch) {
+    m_dlgQuickSearch->refresh();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// buildSearchIndex
+//
+
+void
+CFrmNodeConfig::buildSearchIndex(void)
+{
+  m_searchIndex.clear();
+
+  // Searchable texts for an MDF object with bits and values
+  auto addBitsAndValues = [](std::vector<std::string>& fields, std::deque<CMDF_Bit*>* pbits, std::deque<CMDF_Value*>* pvalues) {
+    if (nullptr != pbits) {
+      for (auto pbit : *pbits) {
+        fields.push_back(pbit->getName());
+      }
+    }
+    if (nullptr != pvalues) {
+      for (auto pvalue : *pvalues) {
+        fields.push_back(pvalue->getName());
+      }
+    }
+  };
+
+  QTreeWidgetItemIterator it(ui->treeWidgetRegisters);
+  while (*it) {
+    if ((*it)->type() == TREE_LIST_REGISTER_TYPE) {
+      CRegisterWidgetItem* itemReg = (CRegisterWidgetItem*)(*it);
+      std::vector<std::string> fields;
+      fields.push_back(itemReg->text(REG_COL_NAME).toStdString());
+      CMDF_Register* preg = m_mdf.getRegister(itemReg->m_regOffset, itemReg->m_regPage);
+      if (nullptr != preg) {
+        fields.push_back(preg->getDescription());
+        addBitsAndValues(fields, preg->getListBits(), preg->getListValues());
+      }
+      m_searchIndex.addEntry(CMdfSearchIndex::entrykind::REGISTER,
+                             itemReg->m_regPage,
+                             itemReg->m_regOffset,
+                             itemReg->text(REG_COL_NAME).toStdString(),
+                             itemReg,
+                             fields);
+    }
+    ++it;
+  }
+
+  for (int i = 0; i < ui->treeWidgetRemoteVariables->topLevelItemCount(); i++) {
+    CRemoteVariableWidgetItem* itemRv = (CRemoteVariableWidgetItem*)ui->treeWidgetRemoteVariables->topLevelItem(i);
+    CMDF_RemoteVariable* prv          = itemRv->m_pRemoteVariable;
+    if (nullptr == prv) {
+      continue;
+    }
+    std::vector<std::string> fields;
+    fields.push_back(prv->getName());
+    fields.push_back(prv->getDescription());
+    addBitsAndValues(fields, prv->getListBits(), prv->getListValues());
+    m_searchIndex.addEntry(CMdfSearchIndex::entrykind::REMOTEVAR,
+                           prv->getPage(),
+                           prv->getOffset(),
+                           prv->getName(),
+                           itemRv,
+                           fields);
+  }
+
+  m_searchIndex.build();
+
+  if (nullptr != m_dlgQuickSearch) {
+    m_dlgQuickSearch->refresh();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// findIndexedItems
+//
+
+QList<QTreeWidgetItem*>
+CFrmNodeConfig::findIndexedItems(const std::string& text,
+                                 CMdfSearchIndex::matchmode mode,
+                                 CMdfSearchIndex::entrykind kind)
+{
+  QList<QTreeWidgetItem*> list;
+  std::vector<uint32_t> results;
+  m_searchIndex.find(text, mode, kind, results);
+  for (auto idx : results) {
+    list.append(m_searchIndex.getEntry(idx).m_pitem);
+  }
+  return list;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onQuickSearch
+//
+
+void
+CFrmNodeConfig::onQuickSearch(void)
+{
+  if (nullptr == m_dlgQuickSearch) {
+    m_dlgQuickSearch = new CDlgQuickSearch(this, &m_searchIndex);
+    connect(m_dlgQuickSearch, &CDlgQuickSearch::entrySelected, this, &CFrmNodeConfig::onQuickSearchSelected);
+  }
+
+  if (TAB_BAR_INDEX_REMOTEVARS == ui->session_tabWidget->currentIndex()) {
+    m_dlgQuickSearch->setKind(CMdfSearchIndex::entrykind::REMOTEVAR);
+  }
+  else {
+    m_dlgQuickSearch->setKind(CMdfSearchIndex::entrykind::REGISTER);
+  }
+
+  m_dlgQuickSearch->refresh();
+  m_dlgQuickSearch->show();
+  m_dlgQuickSearch->raise();
+  m_dlgQuickSearch->activateWindow();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onQuickSearchSelected
+//
+
+void
+CFrmNodeConfig::onQuickSearchSelected(uint32_t idx)
+{
+  if (idx >= m_searchIndex.getCount()) {
+    return;
+  }
+
+  const CMdfSearchIndex::entry& e = m_searchIndex.getEntry(idx);
+  if (CMdfSearchIndex::entrykind::REGISTER == e.m_kind) {
+    ui->session_tabWidget->setCurrentIndex(TAB_BAR_INDEX_REGISTERS);
+    auto itPage = m_mapPageToPageHeader.find(e.m_page);
+    if (itPage != m_mapPageToPageHeader.end()) {
+      itPage->second->setExpanded(true);
+    }
+    ui->treeWidgetRegisters->selectionModel()->clearSelection();
+    ui->treeWidgetRegisters->setCurrentItem(e.m_pitem);
+    e.m_pitem->setSelected(true);
+    ui->treeWidgetRegisters->scrollToItem(e.m_pitem);
+    onRegisterTreeWidgetItemClicked(e.m_pitem, 0);
+  }
+  else {
+    ui->session_tabWidget->setCurrentIndex(TAB_BAR_INDEX_REMOTEVARS);
+    ui->treeWidgetRemoteVariables->selectionModel()->clearSelection();
+    ui->treeWidgetRemoteVariables->setCurrentItem(e.m_pitem);
+    e.m_pitem->setSelected(true);
+    ui->treeWidgetRemoteVariables->scrollToItem(e.m_pitem);
+    onRemoteVariableTreeWidgetItemClicked(e.m_pitem, 0);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // onSearchRegister  Qt::MatchFlags(dlg.getSearchType())
 //
@@ -6047,9 +6378,16 @@ CFrmNodeConfig::onSearchRegister(void)
     }
 
     m_registerSearchPos = 0;
-    m_searchListRegs    = ui->treeWidgetRegisters->findItems(dlg.getSearchText().c_str(),
-                                                          flags,
-                                                          static_cast<int>(REG_COL_NAME));
+    if (!dlg.isCaseSensitive() && (SEARCH_TYPE_CONTAINS == dlg.getSearchType())) {
+      m_searchListRegs = findIndexedItems(dlg.getSearchText(),
+                                          CMdfSearchIndex::matchmode::NAME,
+                                          CMdfSearchIndex::entrykind::REGISTER);
+    }
+    else {
+      m_searchListRegs = ui->treeWidgetRegisters->findItems(dlg.getSearchText().c_str(),
+                                                            flags,
+                                                            static_cast<int>(REG_COL_NAME));
+    }
     std::cout << m_searchListRegs.size() << std::endl;
 
     foreach (QTreeWidgetItem* item, m_searchListRegs) {
@@ -6171,10 +6509,17 @@ CFrmNodeConfig::onSearchRemoteVariable(void)
       flags |= Qt::MatchCaseSensitive;
     }
 
-    m_registerSearchPos    = 0;
-    m_searchListRemoteVars = ui->treeWidgetRemoteVariables->findItems(dlg.getSearchText().c_str(),
-                                                                      flags,
-                                                                      static_cast<int>(REMOTEVAR_COL_NAME));
+    m_registerSearchPos = 0;
+    if (!dlg.isCaseSensitive() && (SEARCH_TYPE_CONTAINS == dlg.getSearchType())) {
+      m_searchListRemoteVars = findIndexedItems(dlg.getSearchText(),
+                                                CMdfSearchIndex::matchmode::NAME,
+                                                CMdfSearchIndex::entrykind::REMOTEVAR);
+    }
+    else {
+      m_searchListRemoteVars = ui->treeWidgetRemoteVariables->findItems(dlg.getSearchText().c_str(),
+                                                                        flags,
+                                                                        static_cast<int>(REMOTEVAR_COL_NAME));
+    }
     std::cout << m_searchListRemoteVars.size() << std::endl;
 
     foreach (QTreeWidgetItem* item, m_searchListRemoteVars) {
@@ -33,6 +33,7 @@
 #endif
 
 #include "ctxevent.h"
+#include "mdfsearchindex.h"
 #include <mdf.h>
 #include <register.h>
 #include <vscp.h>
@@ -72,6 +73,8 @@ class QTreeWidgetItem;
 class QShortcut;
 QT_END_NAMESPACE
 
+class CDlgQuickSearch;
+
 #include <QMainWindow>
 #include <QTableWidgetItem>
 
@@ -272,6 +275,15 @@ public:
   */
   int doUpdate(std::string mdfpath);
 
+  /*!
+    Parse a local MDF file into the window. Nothing is read from the
+    node so register values are unknown until the next full update.
+    Call the render methods to show the content.
+    @param path Path to local MDF file
+    @return VSCP_ERROR_SUCCESS on success or error code on failure.
+  */
+  int loadLocalMdf(const std::string& path);
+
   /*!
     Set the selected node id
     @param nodeid Value to set
@@ -282,6 +294,36 @@ public:
       m_nodeidConfig->setValue(nodeid);
   };
 
+  /// A register set as read from a register file
+  struct registerset {
+    std::map<uint32_t, uint8_t> m_regs; // Values keyed on (page << 8) + offset
+    std::string m_moduleName;           // Module info, empty if not in file
+    std::string m_moduleModel;
+    std::string m_moduleVersion;
+    uint16_t m_skipped = 0; // Standard registers left out
+  };
+
+  /*!
+    Read a register set file (JSON or XML as written by saveRegisterValues)
+    without applying it. Standard registers are skipped. This is the one
+    reader for register files, used for load, fleet apply and diff.
+    @param path Filename to read from
+    @param set Filled with the registers and module information
+    @return VSCP_ERROR_SUCCESS on success, error code on failure.
+  */
+  static int readRegisterSet(const std::string& path, registerset& set);
+
+  /*!
+    Show what the node inventory knows about the selected node in the
+    status bar. The node itself is not asked.
+  */
+  void showKnownNode(void);
+
+  /*!
+    Record what has been read from the selected node in the node inventory
+  */
+  void updateInventory(void);
+
 public slots:
 
   /// Dialog return
@@ -450,15 +492,51 @@ public slots:
   bool renderStandardRegisters(void);
 
   /*!
-    Fill register data from already loaded registers
+    Read user registers for all MDF pages from the node and
+    fill register data
+    @return VSCP_ERROR_SUCCESS on success or error code on failure.
   */
   int renderRegisters(void);
 
+  /*!
+    Fill register data from already loaded registers. Nothing
+    is read from the node and changed state is left as is.
+    @return VSCP_ERROR_SUCCESS on success or error code on failure.
+  */
+  int renderRegisterTree(void);
+
   /*!
     Fill remote variable data from already loaded MDF data
   */
   bool renderRemoteVariables(void);
 
+  /*!
+    Clear the register and/or remote variable tree. The page map,
+    the search index and search results point to items in the trees
+    so they are cleared too and an open quick search is refreshed.
+    Always use this instead of clearing the trees directly.
+    @param bRegisters Clear the register tree
+    @param bRemoteVariables Clear the remote variable tree
+  */
+  void clearTrees(bool bRegisters = true, bool bRemoteVariables = true);
+
+  /*!
+    Build the search index from the rendered register and
+    remote variable trees
+  */
+  void buildSearchIndex(void);
+
+  /*!
+    Find items in the search index
+    @param text Text to search for
+    @param mode Prefix, substring or name match
+    @param kind Registers or remote variables
+    @return List with tree items in MDF order
+  */
+  QList<QTreeWidgetItem*> findIndexedItems(const std::string& text,
+                                           CMdfSearchIndex::matchmode mode,
+                                           CMdfSearchIndex::entrykind kind);
+
   /*!
     Fill decsin matrix info from already loaded MDF data
   */
@@ -646,23 +724,25 @@ public slots:
   void saveRegisterValues(bool bJSON = true, bool bAll = false);
 
   /*!
-    Load registers from XML file
-    @param path Filename to load from
-    @return VSCP_ERROR_SUCCESS on success, error code on failure.
+    Save selected register values
   */
-  int loadXMLRegs(const std::string& path);
+  void loadRegisterValues(void);
 
   /*!
-    Load registers from JSON file
-    @param path Filename to load from
-    @return VSCP_ERROR_SUCCESS on success, error code on failure.
+    Poll selected registers at a fixed rate and plot them
   */
-  int loadJSONRegs(const std::string& path);
+  void watchSelectedRegisters(void);
 
   /*!
-    Save selected register values
+    Apply a saved register set to a list of nodes
   */
-  void loadRegisterValues(void);
+  void fleetApply(void);
+
+  /*!
+    Compare the registers of this node with other nodes and saved
+    register sets
+  */
+  void diffRegisters(void);
 
   /*!
     Load MDF default
@@ -794,6 +874,17 @@ public slots:
   */
   void onMainTabBarChanged(int index);
 
+  /*!
+    Open the search-as-you-type window
+  */
+  void onQuickSearch(void);
+
+  /*!
+    Show the item for an entry selected in the quick search window
+    @param idx Index of entry in the search index
+  */
+  void onQuickSearchSelected(uint32_t idx);
+
   /*!
     Search register with text content
   */
@@ -897,6 +988,17 @@ private:
   */
   // std::map<uint32_t, CDMWidgetItem *> m_mapReg2DM;
 
+  /*!
+    Search index for registers and remote variables. Rebuilt
+    each time they are rendered.
+  */
+  CMdfSearchIndex m_searchIndex;
+
+  /*!
+    Quick search window (created on first use)
+  */
+  CDlgQuickSearch* m_dlgQuickSearch;
+
   /*!
     List that get populated after a register search
   */
@@ -58,6 +58,8 @@
 
 #include "cfrmnodeconfig.h"
 
+#include "nodescanner.h"
+
 #include "cfrmnodescan.h"
 #include "ui_cfrmnodescan.h"
 
@@ -72,6 +74,7 @@
 #include <QStandardPaths>
 #include <QTableView>
 #include <QTableWidgetItem>
+#include <QTimer>
 #include <QXmlStreamReader>
 #include <QtWidgets>
 
@@ -81,8 +84,12 @@ CFoundNodeWidgetItem::CFoundNodeWidgetItem(QTreeWidget* parent)
   : QTreeWidgetItem(parent, TREE_LIST_FOUND_NODE_TYPE)
 {
   m_nodeid   = 0;
+  m_key      = 0;
+  m_bLevel2  = false;
   m_bStdRegs = false;
   m_bMdf     = false;
+  m_msRegs   = -1;
+  m_msMdf    = -1;
 }
 
 CFoundNodeWidgetItem::~CFoundNodeWidgetItem()
@@ -134,6 +141,31 @@ CFrmNodeScan::CFrmNodeScan(QWidget* parent, json* pconn)
 
   ui->treeFound->setContextMenuPolicy(Qt::CustomContextMenu);
   ui->treeFound->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  ui->treeFound->header()->setStretchLastSection(false);
+  ui->treeFound->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+  // Node info fetch
+  m_pipeline        = nullptr;
+  m_fetchGeneration = 0;
+  m_fetchTotal      = 0;
+  m_fetchDone       = 0;
+  m_fetchTimer      = new QTimer(this);
+  connect(m_fetchTimer, &QTimer::timeout, this, &CFrmNodeScan::onFetchTimer);
+  m_fetchClock.start();
+
+  // Node scan
+  m_scanner        = nullptr;
+  m_scanGeneration = 0;
+  m_scanTimer      = new QTimer(this);
+  connect(m_scanTimer, &QTimer::timeout, this, &CFrmNodeScan::onScanTimer);
+  m_discovery = nullptr;
+  m_nextKey   = 0x100;
+
+  m_fetchUnchanged = 0;
+
+  m_bQuitMdfThread = false;
+  m_mdfConcurrency = ui->spinConcurrency->value();
+  m_mdfThread      = std::thread(&CFrmNodeScan::mdfFetchWorker, this);
 
   // No connection set yet
   m_vscpConnType = CVscpClient::connType::NONE;
@@ -331,6 +363,30 @@ CFrmNodeScan::CFrmNodeScan(QWidget* parent, json* pconn)
 
 CFrmNodeScan::~CFrmNodeScan()
 {
+  cancelFetch();
+  flushInventory();
+
+  // Stop scan, it uses the client
+  if (nullptr != m_scanner) {
+    delete m_scanner;
+    m_scanner = nullptr;
+  }
+
+  if (nullptr != m_discovery) {
+    delete m_discovery;
+    m_discovery = nullptr;
+  }
+
+  // Stop MDF worker
+  {
+    std::lock_guard<std::mutex> lock(m_mdfMutex);
+    m_bQuitMdfThread = true;
+  }
+  m_mdfCv.notify_all();
+  if (m_mdfThread.joinable()) {
+    m_mdfThread.join();
+  }
+
   // Make sure we are disconnected
   doDisconnectFromRemoteHost();
 
@@ -692,6 +748,17 @@ CFrmNodeScan::doScan(void)
 {
   vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
 
+  // Scan again while a scan is running stops it
+  if (isScanning()) {
+    if (nullptr != m_scanner) {
+      m_scanner->cancel();
+    }
+    if (nullptr != m_discovery) {
+      m_discovery->cancel();
+    }
+    return;
+  }
+
   // ui->btnScan->setEnabled(false);
   ui->actionScan->setEnabled(false);
 
@@ -710,6 +777,24 @@ CFrmNodeScan::doScan(void)
   }
 
   ui->progressBarScan->setValue(0);
+  cancelFetch();
+  flushInventory();
+
+  // Keep what is known about the nodes so that a rescan only fetches
+  // MDF's for nodes whose standard registers have changed
+  m_previous.clear();
+  for (const auto& item : m_nodeItems) {
+    CFoundNodeWidgetItem* pItem = item.second;
+    if (pItem->m_bMdf && (nullptr != pItem->m_pmdf) && !pItem->m_hash.empty()) {
+      previousnode prev;
+      prev.m_hash                      = pItem->m_hash;
+      prev.m_pmdf                      = pItem->m_pmdf;
+      prev.m_path                      = pItem->m_tempMdfFile;
+      m_previous[getItemAddress(pItem)] = prev;
+    }
+  }
+
+  m_nodeItems.clear();
   ui->treeFound->clear();
   ui->infoArea->clear();
 
@@ -731,6 +816,12 @@ CFrmNodeScan::doScan(void)
   }
   cguid guidInterface(interface);
 
+  // LEVEL II DISCOVERY
+  if (ui->chkLevel2->isChecked()) {
+    startDiscovery(guidInterface);
+    return;
+  }
+
   ui->progressBarScan->setValue(30);
 
   // nothing found yet
@@ -739,56 +830,72 @@ CFrmNodeScan::doScan(void)
   // SLOW SCAN
   if (ui->chkSlowScan->isChecked()) {
 
-    // Slow scan
+    // Probe the nodes with a window of outstanding requests on a worker
+    // thread. Found nodes are added as they answer.
 
     uint32_t delay   = vscp_readStringValue(ui->editDelay->text().toStdString());
     uint32_t timeout = vscp_readStringValue(ui->editTimeout->text().toStdString());
 
-    if (VSCP_ERROR_SUCCESS != vscp_scanSlowForDevices(*m_vscpClient,
-                                                      guidInterface,
-                                                      nodelist,
-                                                      found,
-                                                      nullptr,
-                                                      delay,
-                                                      timeout)) {
+    if (nullptr != m_scanner) {
+      delete m_scanner;
+    }
+    m_scanner = new CNodeScanner(*m_vscpClient, guidInterface);
+    m_scanner->setWindow(ui->spinConcurrency->value());
+    m_scanner->setTimeout(SCAN_MIN_TIMEOUT, timeout);
+    m_scanner->setProbeGap(delay);
+
+    uint32_t generation = ++m_scanGeneration;
+    int rv              = m_scanner->start(
+      nodelist,
+      [this, generation](uint8_t nodeid, uint32_t rtt) {
+        QMetaObject::invokeMethod(
+          this,
+          [this, generation, nodeid, rtt]() { onScanFound(generation, nodeid, rtt); },
+          Qt::QueuedConnection);
+      },
+      [this, generation](const CNodeScanner::scanstats& stats) {
+        QMetaObject::invokeMethod(
+          this,
+          [this, generation, stats]() { onScanDone(generation, stats); },
+          Qt::QueuedConnection);
+      });
+
+    if (VSCP_ERROR_SUCCESS != rv) {
       ui->progressBarScan->setValue(0);
       spdlog::error(std::string(tr("Node Slow Scan: Failed to scan for devices").toStdString()));
       QApplication::restoreOverrideCursor();
       ui->infoArea->setText("Scan failed...");
       ui->infoArea->repaint();
-
-      // QMessageBox::information(this,
-      //                         tr(APPNAME),
-      //                         tr("Failed to scan nodes"),
-      //                         QMessageBox::Ok);
-
       ui->actionScan->setEnabled(true);
       return;
     }
+
+    ui->actionScan->setText(tr("Stop scan"));
+    ui->actionScan->setEnabled(true);
+    m_scanTimer->start(100);
+    return;
   }
+
   // NORMAL SCAN
-  else {
-    // Normal scan
 
-    ui->infoArea->setText("Scan in progress...");
-    ui->infoArea->repaint();
+  ui->infoArea->setText("Scan in progress...");
+  ui->infoArea->repaint();
 
-    if (VSCP_ERROR_SUCCESS != vscp_scanForDevices(*m_vscpClient,
-                                                  guidInterface,
-                                                  found,
-                                                  nullptr,
-                                                  pworks->m_config_timeout)) {
-      ui->progressBarScan->setValue(0);
-      spdlog::error(std::string(tr("Node Fast Scan: Failed to scan for devices").toStdString()));
-      QApplication::restoreOverrideCursor();
-      QApplication::processEvents();
-      QMessageBox::information(this,
-                               APPNAME,
-                               tr("Failed to scan nodes"),
-                               QMessageBox::Ok);
-      ui->actionScan->setEnabled(true);
-      return;
-    }
+  if (VSCP_ERROR_SUCCESS != vscp_scanForDevices(*m_vscpClient,
+                                                guidInterface,
+                                                found,
+                                                nullptr,
+                                                pworks->m_config_timeout)) {
+    ui->progressBarScan->setValue(0);
+    spdlog::error(std::string(tr("Node Fast Scan: Failed to scan for devices").toStdString()));
+    QApplication::restoreOverrideCursor();
+    QApplication::processEvents();
+    QMessageBox::information(this,
+                             APPNAME,
+                             tr("Failed to scan nodes"),
+                             QMessageBox::Ok);
+    ui->actionScan->setEnabled(true);
+    return;
   }
 
   QString str = QString("Found %1 nodes").arg(found.size());
@@ -796,38 +903,418 @@ CFrmNodeScan::doScan(void)
   ui->infoArea->repaint();
   // printf("found node count = %zu\n", found.size());
 
-  size_t additem = 70 / (found.size() + 1); // Add for the progress bar for each mdf file
-  if (!ui->chkFetchInfo->isChecked()) {
-    ui->progressBarScan->setValue(90);
-  }
-
+  std::deque<uint16_t> nodes;
   for (auto const& item : found) {
-    QString str               = "node " + QString::number(item);
     CFoundNodeWidgetItem* top = new CFoundNodeWidgetItem(ui->treeFound);
     top->setText(0, tr("Node with id = ") + QString::number(item));
-    top->m_nodeid = item; // Save nodeid
-    // Load mdf and standard registers if requested to do so
-    if (ui->chkFetchInfo->isChecked()) {
-      doLoadMdf(item);
-      // QApplication::setOverrideCursor(Qt::WaitCursor);
-      ui->progressBarScan->setValue(ui->progressBarScan->value() + (int)additem);
+    top->m_nodeid     = item; // Save nodeid
+    top->m_key        = item;
+    m_nodeItems[item] = top;
+    nodes.push_back(item);
+    queueInventoryUpdate(top);
+  }
+  flushInventory();
+
+  ui->progressBarScan->setValue(100);
+
+  QApplication::restoreOverrideCursor();
+
+  // Load mdf and standard registers if requested to do so. The
+  // result is filled in as it arrives.
+  if (ui->chkFetchInfo->isChecked()) {
+    startFetch(nodes);
+  }
+
+  ui->actionScan->setEnabled(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onScanFound
+//
+
+void
+CFrmNodeScan::onScanFound(uint32_t generation, uint8_t nodeid, uint32_t rtt)
+{
+  if ((generation != m_scanGeneration) || m_nodeItems.count(nodeid)) {
+    return;
+  }
+
+  CFoundNodeWidgetItem* top = new CFoundNodeWidgetItem(nullptr);
+  top->setText(0, tr("Node with id = ") + QString::number(nodeid));
+  top->setText(1, QString::number(rtt));
+  top->setToolTip(1, tr("Probe response time in ms"));
+  top->m_nodeid = nodeid;
+  top->m_key    = nodeid;
+  insertNodeItem(top);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// insertNodeItem
+//
+
+void
+CFrmNodeScan::insertNodeItem(CFoundNodeWidgetItem* pItem)
+{
+  // Keep the list sorted on key
+  auto it = m_nodeItems.insert(std::make_pair(pItem->m_key, pItem)).first;
+  ui->treeFound->insertTopLevelItem((int)std::distance(m_nodeItems.begin(), it), pItem);
+  queueInventoryUpdate(pItem);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getItemInterface
+//
+
+std::string
+CFrmNodeScan::getItemInterface(CFoundNodeWidgetItem* pItem)
+{
+  // Nodes on other interfaces than the selected one know their interface
+  if (pItem->m_key > 0xff) {
+    return pItem->m_guidInterface.getAsString();
+  }
+
+  std::string interface = "00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00";
+  if (m_connObject.contains("selected-interface") && m_connObject["selected-interface"].is_string()) {
+    interface = m_connObject["selected-interface"].get<std::string>();
+  }
+  return cguid(interface).getAsString();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getItemAddress
+//
+
+std::string
+CFrmNodeScan::getItemAddress(CFoundNodeWidgetItem* pItem)
+{
+  std::string address = getItemInterface(pItem) + "/";
+  address += pItem->m_bLevel2 ? pItem->m_guid.getAsString() : std::to_string(pItem->m_nodeid);
+  return address;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// lookupInventory
+//
+
+bool
+CFrmNodeScan::lookupInventory(CFoundNodeWidgetItem* pItem, CNodeInventory::noderecord& record)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  std::string connection;
+  if (m_connObject.contains("uuid") && m_connObject["uuid"].is_string()) {
+    connection = m_connObject["uuid"].get<std::string>();
+  }
+
+  if (pItem->m_bLevel2) {
+    return pworks->m_nodeInventory.lookupGuid(pItem->m_guid.getAsString(), record) && record.m_bLevel2 &&
+           (record.m_connection == connection) && (record.m_interface == getItemInterface(pItem));
+  }
+
+  return pworks->m_nodeInventory.lookup(connection, getItemInterface(pItem), pItem->m_nodeid, record);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// queueInventoryUpdate
+//
+
+void
+CFrmNodeScan::queueInventoryUpdate(CFoundNodeWidgetItem* pItem, const std::vector<uint8_t>* pregs)
+{
+  CNodeInventory::noderecord record;
+  if (m_connObject.contains("uuid") && m_connObject["uuid"].is_string()) {
+    record.m_connection = m_connObject["uuid"].get<std::string>();
+  }
+  record.m_interface = getItemInterface(pItem);
+  record.m_nodeid    = pItem->m_nodeid;
+  record.m_bLevel2   = pItem->m_bLevel2;
+
+  // What discovery told us
+  if (pItem->m_bLevel2 || !pItem->m_guid.isNULL()) {
+    record.m_guid = pItem->m_guid.getAsString();
+  }
+  record.m_mdfUrl = pItem->m_mdfUrl;
+
+  // What the standard registers tell us
+  if (nullptr != pregs) {
+    cguid guid;
+    pItem->m_stdregs.getGUID(guid);
+    if (!pItem->m_bLevel2) {
+      record.m_guid = guid.getAsString();
     }
+    record.m_mdfUrl   = pItem->m_stdregs.getMDF();
+    record.m_firmware = CNodeInventory::getFirmwareVersion(*pregs);
+    record.m_hash     = pItem->m_hash;
   }
 
-  if (ui->chkSlowScan->isChecked()) {
-    std::string str = "Found nodes : ";
-    str += QString::number(found.size()).toStdString();
-    str += "\n";
-    str += ui->infoArea->toPlainText().toStdString();
-    ui->infoArea->setText(QString::fromStdString(str));
-    ui->infoArea->repaint();
+  if (pItem->m_bMdf && (nullptr != pItem->m_pmdf)) {
+    record.m_name = pItem->m_pmdf->getModuleName();
   }
 
-  ui->progressBarScan->setValue(100);
+  m_inventoryUpdates.push_back(record);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// flushInventory
+//
+
+void
+CFrmNodeScan::flushInventory(void)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  if (m_inventoryUpdates.empty()) {
+    return;
+  }
+
+  pworks->m_nodeInventory.update(m_inventoryUpdates);
+  m_inventoryUpdates.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// isScanning
+//
+
+bool
+CFrmNodeScan::isScanning(void) const
+{
+  return ((nullptr != m_scanner) && m_scanner->isRunning()) ||
+         ((nullptr != m_discovery) && m_discovery->isRunning());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onScanTimer
+//
+
+void
+CFrmNodeScan::onScanTimer(void)
+{
+  if ((nullptr != m_discovery) && m_discovery->isRunning()) {
+    CNodeDiscovery::discoverystats stats = m_discovery->getStats();
+    ui->statusBar->showMessage(tr("Discovering, found %1 node(s) from %2 response frames")
+                                 .arg(stats.m_found)
+                                 .arg(stats.m_frames));
+    return;
+  }
+
+  if (nullptr == m_scanner) {
+    m_scanTimer->stop();
+    return;
+  }
+
+  CNodeScanner::scanstats stats = m_scanner->getStats();
+  if (stats.m_total) {
+    ui->progressBarScan->setValue((int)((100 * stats.m_done) / stats.m_total));
+  }
+  ui->statusBar->showMessage(tr("Scanning %1/%2, found %3, timeout %4 ms")
+                               .arg(stats.m_done)
+                               .arg(stats.m_total)
+                               .arg(stats.m_found)
+                               .arg(stats.m_rto));
+}
 
+///////////////////////////////////////////////////////////////////////////////
+// onScanDone
+//
+
+void
+CFrmNodeScan::onScanDone(uint32_t generation, CNodeScanner::scanstats stats)
+{
+  if (generation != m_scanGeneration) {
+    return;
+  }
+
+  m_scanTimer->stop();
   QApplication::restoreOverrideCursor();
+  ui->actionScan->setText(tr("Scan"));
+  ui->progressBarScan->setValue(100);
+  ui->statusBar->clearMessage();
 
+  QString str = tr("Found %1 nodes in %2 ms").arg(stats.m_found).arg(stats.m_elapsed);
+  if (stats.m_done < stats.m_total) {
+    str += tr(" (cancelled)");
+  }
+  str += tr("\nProbes: %1 (%2 resent), responses: %3, no answer: %4")
+           .arg(stats.m_probes)
+           .arg(stats.m_retransmits)
+           .arg(stats.m_responses)
+           .arg(stats.m_timeouts);
+  if (stats.m_srtt) {
+    str += tr("\nResponse time: %1 ms, probe timeout: %2 ms").arg(stats.m_srtt).arg(stats.m_rto);
+  }
+  ui->infoArea->setText(str);
+  spdlog::info("Node scan: {0}", str.toStdString());
+  flushInventory();
+
+  // Load mdf and standard registers if requested to do so
+  if (ui->chkFetchInfo->isChecked() && m_nodeItems.size()) {
+    std::deque<uint16_t> nodes;
+    for (const auto& item : m_nodeItems) {
+      nodes.push_back(item.first);
+    }
+    startFetch(nodes);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// startDiscovery
+//
+
+void
+CFrmNodeScan::startDiscovery(const cguid& guidInterface)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  // The connection itself, the selected interface and all interfaces
+  // known for the connection are probed at the same time
+  std::deque<cguid> interfaces;
+  std::set<std::string> added;
+  auto addInterface = [&interfaces, &added](const cguid& guid) {
+    if (added.insert(guid.getAsString()).second) {
+      interfaces.push_back(guid);
+    }
+  };
+
+  addInterface(cguid());
+  addInterface(guidInterface);
+  if (m_connObject.contains("interfaces") && m_connObject["interfaces"].is_array()) {
+    for (auto const& item : m_connObject["interfaces"]) {
+      if (item.contains("if-item") && item["if-item"].is_string()) {
+        // Interface items start with the interface GUID
+        std::string str = item["if-item"].get<std::string>();
+        vscp_trim(str);
+        cguid guid;
+        guid.getFromString(str.substr(0, str.find(' ')));
+        addInterface(guid);
+      }
+    }
+  }
+
+  if (nullptr != m_discovery) {
+    delete m_discovery;
+  }
+  m_discovery = new CNodeDiscovery(*m_vscpClient);
+  m_discovery->setInterfaces(interfaces);
+  m_discovery->setQuietTime(pworks->m_config_timeout);
+  m_guidDiscovery = guidInterface;
+  m_nextKey       = 0x100;
+
+  ui->infoArea->setText(tr("Discovering nodes on %1 interface(s)...").arg(interfaces.size()));
+
+  uint32_t generation = ++m_scanGeneration;
+  int rv              = m_discovery->start(
+    [this, generation](const CNodeDiscovery::node& n) {
+      QMetaObject::invokeMethod(
+        this,
+        [this, generation, n]() { onDiscoveryFound(generation, n); },
+        Qt::QueuedConnection);
+    },
+    [this, generation](const CNodeDiscovery::discoverystats& stats) {
+      QMetaObject::invokeMethod(
+        this,
+        [this, generation, stats]() { onDiscoveryDone(generation, stats); },
+        Qt::QueuedConnection);
+    });
+
+  if (VSCP_ERROR_SUCCESS != rv) {
+    spdlog::error("Node discovery: Failed to start rv={}", rv);
+    QApplication::restoreOverrideCursor();
+    ui->infoArea->setText(tr("Discovery failed..."));
+    ui->actionScan->setEnabled(true);
+    return;
+  }
+
+  // No known end, show busy
+  ui->progressBarScan->setRange(0, 0);
+  ui->actionScan->setText(tr("Stop scan"));
   ui->actionScan->setEnabled(true);
+  m_scanTimer->start(100);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onDiscoveryFound
+//
+
+void
+CFrmNodeScan::onDiscoveryFound(uint32_t generation, CNodeDiscovery::node n)
+{
+  if (generation != m_scanGeneration) {
+    return;
+  }
+
+  CFoundNodeWidgetItem* top = new CFoundNodeWidgetItem(nullptr);
+  top->m_nodeid        = n.m_nodeid;
+  top->m_bLevel2       = n.m_bLevel2;
+  top->m_guid          = n.m_guid;
+  top->m_guidInterface = n.m_guidInterface;
+  top->m_mdfUrl        = n.m_mdfUrl;
+
+  // Level I nodes on the selected interface work as scanned nodes. All
+  // others are kept after them.
+  bool bSelected = !n.m_bLevel2 && (n.m_guidInterface.getAsString() == m_guidDiscovery.getAsString());
+  if (bSelected && !m_nodeItems.count(n.m_nodeid)) {
+    top->m_key = n.m_nodeid;
+    top->setText(0, tr("Node with id = ") + QString::number(n.m_nodeid));
+  }
+  else if (n.m_bLevel2) {
+    top->m_key = m_nextKey++;
+    QString str = tr("Level II node ") + QString::fromStdString(n.m_guid.getAsString());
+    if (!n.m_name.empty()) {
+      str += " - " + QString::fromStdString(n.m_name);
+    }
+    top->setText(0, str);
+  }
+  else {
+    top->m_key = m_nextKey++;
+    top->setText(0,
+                 tr("Node with id = %1 on %2")
+                   .arg(n.m_nodeid)
+                   .arg(QString::fromStdString(n.m_guidInterface.getAsString())));
+  }
+
+  top->setToolTip(0, QString::fromStdString(n.m_guid.getAsString()));
+  top->setText(1, QString::number(n.m_time));
+  top->setToolTip(1, tr("Response time in ms from start of discovery"));
+  insertNodeItem(top);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onDiscoveryDone
+//
+
+void
+CFrmNodeScan::onDiscoveryDone(uint32_t generation, CNodeDiscovery::discoverystats stats)
+{
+  if (generation != m_scanGeneration) {
+    return;
+  }
+
+  m_scanTimer->stop();
+  QApplication::restoreOverrideCursor();
+  ui->actionScan->setText(tr("Scan"));
+  ui->progressBarScan->setRange(0, 100);
+  ui->progressBarScan->setValue(100);
+  ui->statusBar->clearMessage();
+
+  QString str = tr("Discovered %1 nodes in %2 ms").arg(stats.m_found).arg(stats.m_elapsed);
+  str += tr("\nRequests: %1 (%2 asked again), response frames: %3, duplicates: %4, incomplete: %5")
+           .arg(stats.m_probes)
+           .arg(stats.m_requeries)
+           .arg(stats.m_frames)
+           .arg(stats.m_duplicates)
+           .arg(stats.m_incomplete);
+  ui->infoArea->setText(str);
+  spdlog::info("Node discovery: {0}", str.toStdString());
+  flushInventory();
+
+  // Load mdf and standard registers if requested to do so
+  if (ui->chkFetchInfo->isChecked() && m_nodeItems.size()) {
+    std::deque<uint16_t> nodes;
+    for (const auto& item : m_nodeItems) {
+      nodes.push_back(item.first);
+    }
+    startFetch(nodes);
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -899,13 +1386,11 @@ CFrmNodeScan::loadSelectedMdf(void)
     return;
   }
 
-  QApplication::setOverrideCursor(Qt::WaitCursor);
-  QApplication::processEvents();
-
-  doLoadMdf(pitem->m_nodeid);
-
-  QApplication::restoreOverrideCursor();
-  QApplication::processEvents();
+  std::deque<uint16_t> nodes;
+  for (auto item : selected) {
+    nodes.push_back(((CFoundNodeWidgetItem*)item)->m_key);
+  }
+  startFetch(nodes);
 
   ui->actionScan->setEnabled(true);
 }
@@ -917,17 +1402,11 @@ CFrmNodeScan::loadSelectedMdf(void)
 void
 CFrmNodeScan::loadAllMdf(void)
 {
-  // ui->btnScan->setEnabled(false);
-  ui->actionScan->setEnabled(false);
-  CFoundNodeWidgetItem* pItem;
-  QTreeWidgetItemIterator it(ui->treeFound);
-  while (*it) {
-    pItem = (CFoundNodeWidgetItem*)(*it);
-    doLoadMdf(pItem->m_nodeid);
-    ++it;
+  std::deque<uint16_t> nodes;
+  for (const auto& item : m_nodeItems) {
+    nodes.push_back(item.first);
   }
-
-  ui->actionScan->setEnabled(true);
+  startFetch(nodes);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -937,147 +1416,439 @@ CFrmNodeScan::loadAllMdf(void)
 void
 CFrmNodeScan::doLoadMdf(uint16_t nodeid)
 {
+  std::deque<uint16_t> nodes;
+  nodes.push_back(nodeid);
+  startFetch(nodes);
+}
 
-  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+///////////////////////////////////////////////////////////////////////////////
+// setStandardRegisters
+//
+// Fill standard registers from a block read of 0x80-0xff
+//
 
-  CFoundNodeWidgetItem* pItem;
-  QTreeWidgetItemIterator it(ui->treeFound);
-  while (*it) {
-    pItem = (CFoundNodeWidgetItem*)(*it);
-    if (pItem->m_nodeid == nodeid) {
-      break;
-    }
-    pItem = nullptr;
-    ++it;
+static void
+setStandardRegisters(CStandardRegisters& stdregs, const std::vector<uint8_t>& data)
+{
+  CRegisterPage page(VSCP_LEVEL1);
+  for (size_t i = 0; i < data.size(); i++) {
+    page.putReg(0x80 + i, data[i]);
   }
+  stdregs.init(page);
+}
 
-  // Check if item found
-  if (nullptr == pItem) {
+///////////////////////////////////////////////////////////////////////////////
+// startFetch
+//
+
+void
+CFrmNodeScan::startFetch(const std::deque<uint16_t>& nodes)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  if ((nullptr == m_vscpClient) || !m_vscpClient->isConnected()) {
+    QMessageBox::information(this, tr(APPNAME), tr("Must be connected to fetch node info."), QMessageBox::Ok);
     return;
   }
 
-  pItem->m_bStdRegs = false;
-  pItem->m_bMdf     = false;
+  // The scan owns the connection while it runs
+  if (isScanning()) {
+    QMessageBox::information(this, tr(APPNAME), tr("Wait for the scan to finish."), QMessageBox::Ok);
+    return;
+  }
 
   std::string interface = "00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00";
-  if (m_connObject.contains("selected-interface") &&
-      m_connObject["selected-interface"].is_string()) {
+  if (m_connObject.contains("selected-interface") && m_connObject["selected-interface"].is_string()) {
     interface = m_connObject["selected-interface"].get<std::string>();
   }
   cguid guidInterface(interface);
 
-  cguid guidNode;
-  guidNode = guidInterface;
-  guidNode.setLSB(pItem->m_nodeid); // Set node id
+  size_t concurrency = ui->spinConcurrency->value();
+  {
+    std::lock_guard<std::mutex> lock(m_mdfMutex);
+    m_mdfConcurrency = concurrency;
+  }
 
-  // Get MDF
-  std::string str = "Fetching MDF for node " + QString::number(pItem->m_nodeid).toStdString();
-  ui->infoArea->setText(QString::fromStdString(str));
-  ui->infoArea->repaint();
-  QApplication::processEvents();
+  if (nullptr == m_pipeline) {
+    m_pipeline = new CRegisterPipeline(*m_vscpClient, guidInterface, pworks->m_config_timeout, (uint16_t)concurrency);
+  }
+  else {
+    m_pipeline->setWindow((uint16_t)concurrency);
+  }
 
-  ui->statusBar->showMessage(tr("Reading standard registers from device..."));
+  // Start counting again if nothing is outstanding
+  if (m_fetchStart.empty()) {
+    m_fetchTotal     = 0;
+    m_fetchDone      = 0;
+    m_fetchUnchanged = 0;
+  }
 
-  // Get standard registers
-  int rv = pItem->m_stdregs.init(*m_vscpClient, guidNode, guidInterface, nullptr, pworks->m_config_timeout);
-  if (VSCP_ERROR_SUCCESS != rv) {
-    ui->statusBar->showMessage(tr("Failed to read standard registers from device. rv=") + QString::number(rv));
-    spdlog::error("Failed to init standard registers {0}", rv);
+  uint32_t generation = m_fetchGeneration;
+  bool bMdfJobs       = false;
+  for (auto key : nodes) {
+
+    auto it = m_nodeItems.find(key);
+    if ((it == m_nodeItems.end()) || m_fetchStart.count(key)) {
+      continue; // Not found or already fetching
+    }
+
+    CFoundNodeWidgetItem* pItem = it->second;
+    pItem->m_bStdRegs           = false;
+    pItem->m_bMdf               = false;
+    pItem->m_msRegs             = -1;
+    pItem->m_msMdf              = -1;
+    pItem->setText(1, tr("..."));
+
+    m_fetchStart[key] = m_fetchClock.elapsed();
+    m_fetchTotal++;
+
+    auto cb = [this, generation, key](const CRegisterPipeline::regop& op) { onStdRegsRead(generation, key, op); };
+
+    // All standard registers in one request
+    if (key <= 0xff) {
+      m_pipeline->read((uint8_t)key, 0, 0x80, 128, cb);
+    }
+    else if (pItem->m_bLevel2) {
+      m_pipeline->readLevel2(pItem->m_guid, CRegisterPipeline::LEVEL2_STDREG_BASE, 128, cb);
+    }
+    else {
+      // Registers on other interfaces can not be read on this connection.
+      // Go straight for the MDF the node reported.
+      std::lock_guard<std::mutex> lock(m_mdfMutex);
+      mdfjob job;
+      job.m_generation = generation;
+      job.m_key        = key;
+      job.m_url        = pItem->m_mdfUrl;
+      job.m_bCached    = false;
+      m_mdfJobs.push_back(job);
+      bMdfJobs = true;
+    }
+  }
+
+  if (bMdfJobs) {
+    m_mdfCv.notify_one();
+  }
+
+  updateFetchProgress();
+  ui->statusBar->showMessage(tr("Fetching node info..."));
+  if (!m_fetchTimer->isActive()) {
+    m_fetchTimer->start(2);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cancelFetch
+//
+
+void
+CFrmNodeScan::cancelFetch(void)
+{
+  m_fetchTimer->stop();
+  m_fetchGeneration++;
+
+  if (nullptr != m_pipeline) {
+    m_pipeline->cancel();
+    delete m_pipeline;
+    m_pipeline = nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mdfMutex);
+    m_mdfJobs.clear();
+  }
+
+  m_fetchStart.clear();
+  m_fetchTotal     = 0;
+  m_fetchDone      = 0;
+  m_fetchUnchanged = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onFetchTimer
+//
+
+void
+CFrmNodeScan::onFetchTimer(void)
+{
+  if (nullptr == m_pipeline) {
+    m_fetchTimer->stop();
+    return;
+  }
+
+  // The bus part is done when the pipeline is empty, MDF's may still
+  // be on their way
+  if (0 == m_pipeline->step()) {
+    m_fetchTimer->stop();
+    delete m_pipeline;
+    m_pipeline = nullptr;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// onStdRegsRead
+//
+
+void
+CFrmNodeScan::onStdRegsRead(uint32_t generation, uint16_t key, const CRegisterPipeline::regop& op)
+{
+  if ((generation != m_fetchGeneration) || (CRegisterPipeline::opstatus::CANCELLED == op.m_status)) {
     return;
   }
 
+  auto it = m_nodeItems.find(key);
+  if (it == m_nodeItems.end()) {
+    return;
+  }
+  CFoundNodeWidgetItem* pItem = it->second;
+  pItem->m_msRegs             = (int)(m_fetchClock.elapsed() - m_fetchStart[key]);
+
+  if ((CRegisterPipeline::opstatus::DONE != op.m_status) || (op.m_data.size() < 128)) {
+    spdlog::error("Node scan: Failed to read standard registers from node {0} ({1})",
+                  op.m_nodeid,
+                  CRegisterPipeline::statusToString(op.m_status));
+    pItem->setText(1, tr("No response"));
+    m_fetchStart.erase(key);
+    m_fetchDone++;
+    updateFetchProgress();
+    return;
+  }
+
+  setStandardRegisters(pItem->m_stdregs, op.m_data);
+  pItem->m_hash = CNodeInventory::hashStandardRegisters(op.m_data);
+
+  // Not scanned in this window before, compare with the hash stored
+  // the last time the node was seen, also in an earlier session
+  bool bUnchanged = false;
+  auto itPrev     = m_previous.find(getItemAddress(pItem));
+  if (itPrev == m_previous.end()) {
+    CNodeInventory::noderecord record;
+    bUnchanged = lookupInventory(pItem, record) && !pItem->m_hash.empty() && (record.m_hash == pItem->m_hash);
+  }
+
+  queueInventoryUpdate(pItem, &op.m_data);
+
   // Standard registers downloaded
   pItem->m_bStdRegs = false;
 
-  // Get GUID
-  cguid guid;
-  pItem->m_stdregs.getGUID(guid);
-  spdlog::trace("Standard register getGUID = {}", guid.toString());
+  // Nothing has changed since the previous scan, keep the MDF
+  if ((itPrev != m_previous.end()) && (itPrev->second.m_hash == pItem->m_hash)) {
+    pItem->m_pmdf        = itPrev->second.m_pmdf;
+    pItem->m_tempMdfFile = itPrev->second.m_path;
+    pItem->m_bMdf        = true;
+    pItem->m_msMdf       = pItem->m_msRegs;
+    m_fetchStart.erase(key);
+    m_fetchDone++;
+    m_fetchUnchanged++;
+    showNodeItem(pItem);
+    updateFetchProgress();
+    return;
+  }
+
+  showNodeItem(pItem);
 
   std::string url = pItem->m_stdregs.getMDF();
-  spdlog::trace("Standard register getMDF = {}", url);
+  spdlog::trace("Node scan: Node {0} MDF {1}", op.m_nodeid, url);
+
+  // Hand over the download to the worker
+  {
+    std::lock_guard<std::mutex> lock(m_mdfMutex);
+    mdfjob job;
+    job.m_generation = generation;
+    job.m_key        = key;
+    job.m_url        = url;
+    job.m_bCached    = bUnchanged;
+    m_mdfJobs.push_back(job);
+  }
+  m_mdfCv.notify_one();
+
+  if (bUnchanged) {
+    m_fetchUnchanged++;
+  }
+}
 
-  // create a temporary file name for remote MDF
-  std::string tempMdfFileName;
-  for (int i = 0; i < url.length(); i++) {
-    if ((url[i] == '/') || (url[i] == '\\')) {
-      tempMdfFileName += "_";
+///////////////////////////////////////////////////////////////////////////////
+// mdfFetchWorker
+//
+
+void
+CFrmNodeScan::mdfFetchWorker(void)
+{
+  vscpworks* pworks = (vscpworks*)QCoreApplication::instance();
+
+  while (true) {
+
+    std::deque<mdfjob> jobs;
+    size_t concurrency;
+    {
+      std::unique_lock<std::mutex> lock(m_mdfMutex);
+      m_mdfCv.wait(lock, [this] { return m_bQuitMdfThread || m_mdfJobs.size(); });
+      if (m_bQuitMdfThread) {
+        return;
+      }
+      jobs.swap(m_mdfJobs);
+      concurrency = m_mdfConcurrency;
     }
-    else {
-      tempMdfFileName += url[i];
+
+    // The MDF of a node that has not changed since it was last seen
+    // is loaded from the local copy without asking the server
+    std::deque<mdfjob> remaining;
+    for (const auto& job : jobs) {
+      std::shared_ptr<CMDF> pmdf;
+      std::string mdfpath;
+      if (m_bQuitMdfThread) {
+        return;
+      }
+      if (!job.m_bCached || (VSCP_ERROR_SUCCESS != pworks->m_mdfCache.getCached(job.m_url, pmdf, mdfpath))) {
+        remaining.push_back(job);
+        continue;
+      }
+
+      uint32_t generation = job.m_generation;
+      uint16_t key        = job.m_key;
+      QMetaObject::invokeMethod(
+        this,
+        [this, generation, key, pmdf, mdfpath]() {
+          onMdfFetched(generation, key, VSCP_ERROR_SUCCESS, pmdf, mdfpath);
+        },
+        Qt::QueuedConnection);
+    }
+    jobs.swap(remaining);
+    if (jobs.empty()) {
+      continue;
     }
-  }
 
-  // mkstemp()
-  std::string tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation).toStdString();
-  tempPath += "/";
-  tempPath += tempMdfFileName;
-  pItem->m_tempMdfFile = tempPath;
+    std::deque<std::string> urls;
+    for (const auto& job : jobs) {
+      urls.push_back(job.m_url);
+    }
 
-  spdlog::debug("Temporary path: {}", tempPath);
+    // Nodes that share an MDF are served by the same download and parse
+    pworks->m_mdfCache.fetchMany(urls,
+                                 concurrency,
+                                 [&](const std::string& url, int rv, const std::string& path, const std::string& hash) {
+      std::string key = CMdfCache::normalizeUrl(url);
+      for (const auto& job : jobs) {
+        if (m_bQuitMdfThread) {
+          return;
+        }
+        if (CMdfCache::normalizeUrl(job.m_url) != key) {
+          continue;
+        }
 
-  ui->statusBar->showMessage(tr("Downloading MDF file..."));
+        std::shared_ptr<CMDF> pmdf;
+        std::string mdfpath = path;
+        int result          = rv;
+        if (VSCP_ERROR_SUCCESS == result) {
+          result = pworks->m_mdfCache.get(job.m_url, pmdf, mdfpath);
+        }
 
-  CURLcode curl_rv;
-  curl_rv = pItem->m_mdf.downLoadMDF(url, tempPath);
-  if (CURLE_OK != curl_rv) {
-    ui->statusBar->showMessage(tr("Failed to download MDF file for device."));
-    spdlog::error("Failed to download MDF {0} curl rv={1}", url, (int)curl_rv);
-    return;
+        uint32_t generation = job.m_generation;
+        uint16_t key        = job.m_key;
+        QMetaObject::invokeMethod(
+          this,
+          [this, generation, key, result, pmdf, mdfpath]() {
+            onMdfFetched(generation, key, result, pmdf, mdfpath);
+          },
+          Qt::QueuedConnection);
+      }
+    });
   }
+}
 
-  // * * * Parse  MDF * * *
+///////////////////////////////////////////////////////////////////////////////
+// onMdfFetched
+//
 
-  ui->statusBar->showMessage(tr("Parsing MDF file..."));
-  try {
-    rv = pItem->m_mdf.parseMDF(tempPath);
-  }
-  catch (const std::exception &ex) {
-    ui->statusBar->showMessage(tr("Failed to parse MDF file for device."));
-    spdlog::error("Failed to parse MDF {0}: {1}", tempPath, ex.what());
-    QMessageBox::warning(this,
-                         APPNAME,
-                         tr("Failed to parse MDF file.\n\nWhere: %1\nWhat: %2")
-                           .arg(QString::fromStdString(tempPath))
-                           .arg(QString::fromUtf8(ex.what())));
+void
+CFrmNodeScan::onMdfFetched(uint32_t generation, uint16_t key, int rv, std::shared_ptr<CMDF> pmdf, std::string path)
+{
+  if (generation != m_fetchGeneration) {
     return;
   }
-  catch (...) {
-    ui->statusBar->showMessage(tr("Failed to parse MDF file for device."));
-    spdlog::error("Failed to parse MDF {0}: Unknown exception", tempPath);
-    QMessageBox::warning(this,
-                         APPNAME,
-                         tr("Failed to parse MDF file.\n\nWhere: %1\nWhat: Unknown exception while parsing.")
-                           .arg(QString::fromStdString(tempPath)));
+
+  auto it = m_nodeItems.find(key);
+  if (it == m_nodeItems.end()) {
     return;
   }
+  CFoundNodeWidgetItem* pItem = it->second;
+  pItem->m_msMdf              = (int)(m_fetchClock.elapsed() - m_fetchStart[key]);
+  m_fetchStart.erase(key);
+  m_fetchDone++;
+
   if (VSCP_ERROR_SUCCESS != rv) {
-    ui->statusBar->showMessage(tr("Failed to parse MDF file for device."));
-    spdlog::error("Failed to parse MDF {0} rv={1}", tempPath, rv);
-    QMessageBox::warning(this,
-                         APPNAME,
-                         tr("Failed to parse MDF file.\n\nWhere: %1\nWhat: Parser returned error code %2.")
-                           .arg(QString::fromStdString(tempPath))
-                           .arg(rv));
+    spdlog::error("Node scan: Failed to fetch MDF for node {0} rv={1}", pItem->m_nodeid, rv);
+    pItem->setText(1, (VSCP_ERROR_PARSING == rv) ? tr("MDF parse error") : tr("MDF download failed"));
+    updateFetchProgress();
     return;
   }
 
   // MDF downloaded & parsed
-  pItem->m_bMdf = true;
-
-  // Replace item string
-  std::string strItem = tr("Node: ").toStdString();
-  strItem += QString::number(pItem->m_nodeid).toStdString();
-  strItem += " - ";
-  strItem += pItem->m_mdf.getModuleName();
-  strItem += ", Ver: ";
-  strItem += pItem->m_mdf.getModuleVersion();
-  pItem->setText(0, QString::fromStdString(strItem));
-
-  // Set the HTML
-  std::string html = vscp_getDeviceInfoHtml(pItem->m_mdf, pItem->m_stdregs);
-  ui->infoArea->setHtml(html.c_str());
-  ui->infoArea->repaint();
+  pItem->m_pmdf        = pmdf;
+  pItem->m_tempMdfFile = path;
+  pItem->m_bMdf        = true;
+  showNodeItem(pItem);
+  queueInventoryUpdate(pItem);
+
+  // Show info if this is the node the user is looking at
+  if (pItem == ui->treeFound->currentItem()) {
+    std::string html = vscp_getDeviceInfoHtml(*pItem->m_pmdf, pItem->m_stdregs);
+    ui->infoArea->setHtml(html.c_str());
+  }
+
+  updateFetchProgress();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// showNodeItem
+//
+
+void
+CFrmNodeScan::showNodeItem(CFoundNodeWidgetItem* pItem)
+{
+  if (pItem->m_bMdf && (nullptr != pItem->m_pmdf)) {
+    std::string strItem = tr("Node: ").toStdString();
+    if (pItem->m_bLevel2) {
+      strItem += pItem->m_guid.getAsString();
+    }
+    else {
+      strItem += QString::number(pItem->m_nodeid).toStdString();
+    }
+    strItem += " - ";
+    strItem += pItem->m_pmdf->getModuleName();
+    strItem += ", Ver: ";
+    strItem += pItem->m_pmdf->getModuleVersion();
+    pItem->setText(0, QString::fromStdString(strItem));
+  }
+
+  // Register read time / total time including MDF
+  QString str = (-1 == pItem->m_msRegs) ? "-" : QString::number(pItem->m_msRegs);
+  str += " / ";
+  str += (-1 == pItem->m_msMdf) ? "..." : QString::number(pItem->m_msMdf);
+  pItem->setText(1, str);
+  pItem->setToolTip(1, tr("Standard registers read / MDF fetched, ms from start of fetch"));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// updateFetchProgress
+//
+
+void
+CFrmNodeScan::updateFetchProgress(void)
+{
+  if (!m_fetchTotal) {
+    return;
+  }
+
+  ui->progressBarScan->setValue((int)((100 * m_fetchDone) / m_fetchTotal));
+  if (m_fetchDone >= m_fetchTotal) {
+    flushInventory();
+    ui->statusBar->showMessage(tr("Node info fetched for %1 node(s), %2 unchanged since previous scan")
+                                 .arg(m_fetchTotal)
+                                 .arg(m_fetchUnchanged));
+  }
+  else {
+    ui->statusBar->showMessage(tr("Fetching node info %1/%2...").arg(m_fetchDone).arg(m_fetchTotal));
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1095,7 +1866,7 @@ CFrmNodeScan::onFindNodesTreeWidgetItemClicked(QTreeWidgetItem* item, int column
   if ((pItem->type() == TREE_LIST_FOUND_NODE_TYPE) && pItem->m_bMdf && !pItem->m_bStdRegs) {
 
     // Set the HTML
-    std::string html = vscp_getDeviceInfoHtml(pItem->m_mdf, pItem->m_stdregs);
+    std::string html = vscp_getDeviceInfoHtml(*pItem->m_pmdf, pItem->m_stdregs);
     ui->infoArea->setHtml(html.c_str());
   }
   else {
@@ -1150,7 +1921,21 @@ CFrmNodeScan::goConfig(void)
     return;
   }
 
-  CFrmNodeConfig* w = new CFrmNodeConfig(parentWidget(), &m_connObject);
+  if (pitem->m_bLevel2) {
+    QMessageBox::information(this,
+                             tr(APPNAME),
+                             tr("Full level II configuration is not implemented yet."),
+                             QMessageBox::Ok);
+    return;
+  }
+
+  // Nodes found on another interface are configured on that interface
+  json connObject = m_connObject;
+  if (pitem->m_key > 0xff) {
+    connObject["selected-interface"] = pitem->m_guidInterface.getAsString();
+  }
+
+  CFrmNodeConfig* w = new CFrmNodeConfig(parentWidget(), &connObject);
   w->setAttribute(Qt::WA_DeleteOnClose, true); // Make window close on exit
   w->setWindowState((windowState() & ~Qt::WindowMinimized) | Qt::WindowActive);
   w->setWindowFlags(Qt::Window);
@@ -1192,7 +1977,21 @@ CFrmNodeScan::goFirmwareUpdate(void)
     return;
   }
 
-  CBootLoadWizard wiz(parentWidget(), &m_connObject);
+  if (pitem->m_bLevel2) {
+    QMessageBox::information(this,
+                             tr(APPNAME),
+                             tr("Firmware update of Level II nodes is not supported."),
+                             QMessageBox::Ok);
+    return;
+  }
+
+  // Nodes found on another interface are updated on that interface
+  json connObject = m_connObject;
+  if (pitem->m_key > 0xff) {
+    connObject["selected-interface"] = pitem->m_guidInterface.getAsString();
+  }
+
+  CBootLoadWizard wiz(parentWidget(), &connObject);
 
   if (VSCP_ERROR_SUCCESS != (rv = wiz.initBootLoaderWizard())) {
     spdlog::error("Aborting bootloader wizard (initBootLoaderWizard) rv={}", rv);
@@ -37,7 +37,18 @@
 #include <vscp.h>
 #include <vscp-client-base.h>
 
+#include "nodeinventory.h"
+#include "nodescanner.h"
+#include "registerpipeline.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <thread>
 
 #include <QDialog>
 #include <QObject>
@@ -56,6 +67,7 @@ class QMenuBar;
 class QPushButton;
 class QTextEdit;
 class QTextBrowser;
+class QTimer;
 class QToolBar;
 class QVBoxLayout;
 class QAction;
@@ -64,6 +76,7 @@ class QTreeWidget;
 class QToolBox;
 QT_END_NAMESPACE
 
+#include <QElapsedTimer>
 #include <QMainWindow>
 #include <QTableWidgetItem>
 
@@ -73,6 +86,9 @@ class CFrmNodeScan;
 
 #define TREE_LIST_FOUND_NODE_TYPE (QTreeWidgetItem::UserType + 1)
 
+// Lowest probe timeout (ms) for slow scan
+#define SCAN_MIN_TIMEOUT 20
+
 // ----------------------------------------------------------------------------
 
 /*!
@@ -89,6 +105,25 @@ public:
   */
   uint16_t m_nodeid;
 
+  /*!
+    Key in the found list. Same as the node id for Level I nodes on the
+    selected interface, above 0xff for Level II nodes and nodes on other
+    interfaces.
+  */
+  uint16_t m_key;
+
+  /// True for a Level II node, addressed on m_guid
+  bool m_bLevel2;
+
+  /// GUID reported by the node (discovery only)
+  cguid m_guid;
+
+  /// Interface the node was found on (discovery only)
+  cguid m_guidInterface;
+
+  /// MDF URL reported by the node (discovery only)
+  std::string m_mdfUrl;
+
   /*!
     True when standard registers has been loaded
   */
@@ -97,14 +132,23 @@ public:
   /// True when MDF has been loaded
   bool m_bMdf;
 
-  /// MDF definitions
-  CMDF m_mdf;
+  /// MDF definitions, shared with other nodes using the same MDF
+  std::shared_ptr<CMDF> m_pmdf;
 
   /// MDF path for downloaded file
   std::string m_tempMdfFile;
 
   /// VSCP standard registers
   CStandardRegisters m_stdregs;
+
+  /// Time in milliseconds to read standard registers or -1
+  int m_msRegs;
+
+  /// Time in milliseconds until MDF was fetched and parsed or -1
+  int m_msMdf;
+
+  /// Hash of the standard registers or empty if not read
+  std::string m_hash;
 };
 
 // ----------------------------------------------------------------------------
@@ -204,6 +248,12 @@ public slots:
   /// Load mdf for node
   void doLoadMdf(uint16_t nodeid);
 
+  /// Step the standard register reads for nodes being fetched
+  void onFetchTimer(void);
+
+  /// Show progress for a running slow scan
+  void onScanTimer(void);
+
   /// Find nodes item clicked -> Display device info
   void onFindNodesTreeWidgetItemClicked(QTreeWidgetItem* item, int column);
 
@@ -247,6 +297,160 @@ private:
   /// Queue that holds received events
   std::deque<vscp_event_t*> m_rxEvents;
 
+  /// A node answered a slow scan probe (called on GUI thread)
+  void onScanFound(uint32_t generation, uint8_t nodeid, uint32_t rtt);
+
+  /// Slow scan has ended (called on GUI thread)
+  void onScanDone(uint32_t generation, CNodeScanner::scanstats stats);
+
+  /*!
+    Start Level II discovery on the connection, the selected interface
+    and all interfaces known for the connection.
+    @param guidInterface Selected interface
+  */
+  void startDiscovery(const cguid& guidInterface);
+
+  /// Discovery found a node (called on GUI thread)
+  void onDiscoveryFound(uint32_t generation, CNodeDiscovery::node n);
+
+  /// Discovery has ended (called on GUI thread)
+  void onDiscoveryDone(uint32_t generation, CNodeDiscovery::discoverystats stats);
+
+  /// True if a scan or discovery is running
+  bool isScanning(void) const;
+
+  /// Add a found node to the list sorted on key
+  void insertNodeItem(CFoundNodeWidgetItem* pItem);
+
+  /// Interface a found node is on, GUID on string form
+  std::string getItemInterface(CFoundNodeWidgetItem* pItem);
+
+  /// Interface and address (node id or GUID) for a found node
+  std::string getItemAddress(CFoundNodeWidgetItem* pItem);
+
+  /*!
+    Look up a found node in the node inventory
+    @param pItem Node
+    @param record Filled in if found
+    @return True if the node is in the inventory for this connection
+  */
+  bool lookupInventory(CFoundNodeWidgetItem* pItem, CNodeInventory::noderecord& record);
+
+  /*!
+    Queue an inventory update for a found node
+    @param pItem Node
+    @param pregs Standard registers 0x80-0xff or nullptr if not read
+  */
+  void queueInventoryUpdate(CFoundNodeWidgetItem* pItem, const std::vector<uint8_t>* pregs = nullptr);
+
+  /// Write queued inventory updates
+  void flushInventory(void);
+
+  /*!
+    What was known about a node before a rescan
+  */
+  struct previousnode {
+    std::string m_hash;
+    std::shared_ptr<CMDF> m_pmdf;
+    std::string m_path;
+  };
+
+  /// Nodes from the previous scan on interface/address
+  std::map<std::string, previousnode> m_previous;
+
+  /// Inventory updates not yet written
+  std::deque<CNodeInventory::noderecord> m_inventoryUpdates;
+
+  /// Nodes in current fetch that had not changed since the previous scan
+  size_t m_fetchUnchanged;
+
+  /// Slow scan engine, nullptr if no scan has been made
+  CNodeScanner* m_scanner;
+
+  /// Level II discovery engine, nullptr if no discovery has been made
+  CNodeDiscovery* m_discovery;
+
+  /// Interface selected when discovery was started
+  cguid m_guidDiscovery;
+
+  /// Next key for nodes that are not Level I nodes on the selected interface
+  uint16_t m_nextKey;
+
+  /// Bumped for each slow scan so that stale results are dropped
+  uint32_t m_scanGeneration;
+
+  /// Progress for slow scan
+  QTimer* m_scanTimer;
+
+  /*!
+    MDF to fetch for a node
+  */
+  struct mdfjob {
+    uint32_t m_generation;
+    uint16_t m_key;
+    std::string m_url;
+    bool m_bCached; // Unchanged since last seen, use the local copy
+  };
+
+  /*!
+    Read standard registers and fetch MDF for nodes. Registers for up to
+    the concurrency limit nodes are read at the same time and MDF's are
+    downloaded on a worker thread while the bus is still busy. Results
+    are shown in the found list as they arrive.
+    @param nodes Nodes to fetch info for
+  */
+  void startFetch(const std::deque<uint16_t>& nodes);
+
+  /*!
+    Cancel fetch in progress. Results that arrive later are dropped.
+  */
+  void cancelFetch(void);
+
+  /// Standard registers for a node has been read
+  void onStdRegsRead(uint32_t generation, uint16_t key, const CRegisterPipeline::regop& op);
+
+  /// MDF for a node has been fetched (called on GUI thread)
+  void onMdfFetched(uint32_t generation, uint16_t key, int rv, std::shared_ptr<CMDF> pmdf, std::string path);
+
+  /// Update text and timing for a found node
+  void showNodeItem(CFoundNodeWidgetItem* pItem);
+
+  /// Set progress from number of fetched nodes
+  void updateFetchProgress(void);
+
+  /// Worker thread that download and parse MDF's
+  void mdfFetchWorker(void);
+
+  /// Found nodes on key
+  std::map<uint16_t, CFoundNodeWidgetItem*> m_nodeItems;
+
+  /// Pipeline reading standard registers, nullptr when idle
+  CRegisterPipeline* m_pipeline;
+
+  /// Drives the pipeline
+  QTimer* m_fetchTimer;
+
+  /// Bumped when a fetch is cancelled so that stale results are dropped
+  uint32_t m_fetchGeneration;
+
+  /// Nodes in current fetch and nodes completed
+  size_t m_fetchTotal;
+  size_t m_fetchDone;
+
+  /// Time base for per node timing
+  QElapsedTimer m_fetchClock;
+
+  /// Time each node in the fetch was started, on key
+  std::map<uint16_t, qint64> m_fetchStart;
+
+  /// MDF worker thread and its queue
+  std::thread m_mdfThread;
+  std::mutex m_mdfMutex;
+  std::condition_variable m_mdfCv;
+  std::deque<mdfjob> m_mdfJobs;
+  std::atomic<bool> m_bQuitMdfThread;
+  size_t m_mdfConcurrency;
+
   // The UI definition
   Ui::CFrmNodeScan* ui;
 };
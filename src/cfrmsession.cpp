@@ -4365,6 +4365,14 @@ CFrmSession::setGuidInfoForRow(QTableWidgetItem* item, const vscp_event_t* pev)
   QString guidSymbolicName = pworks->m_mapGuidToSymbolicName[strGuid.c_str()];
   pworks->m_mutexGuidMap.unlock();
 
+  // Fall back on the module name of a node seen by a scan
+  if (!guidSymbolicName.length()) {
+    CNodeInventory::noderecord record;
+    if (pworks->m_nodeInventory.lookupGuid(strGuid, record) && record.m_name.size()) {
+      guidSymbolicName = QString::fromStdString(record.m_name);
+    }
+  }
+
   pworks->m_mutexSensorIndexMap.lock();
   QString strSensorIndexSymbolic =
     pworks->m_mapSensorIndexToSymbolicName
@@ -18,6 +18,8 @@
 #include "mainwindow.h"
 #include "vscpworks.h"
 
+#include <curl/curl.h>
+
 #include <spdlog/async.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -122,6 +124,13 @@ main(int argc, char* argv[])
     return EXIT_FAILURE;
   }
 
+  // Initialize libcurl here, on the main thread before any window or
+  // the MDF cache starts a download from a worker thread
+  if (CURLE_OK != curl_global_init(CURL_GLOBAL_DEFAULT)) {
+    spdlog::critical("Unable to initialize curl library.");
+    return EXIT_FAILURE;
+  }
+
   spdlog::info("Starting VSCP Works +");
 
   MainWindow mainWin;
@@ -0,0 +1,842 @@
+// mdfcache.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "mdfcache.h"
+#include "mdfsnapshot.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <curl/curl.h>
+
+#include <nlohmann/json.hpp>
+
+#include <fstream>
+
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+using json = nlohmann::json;
+
+// Name of index file in cache folder
+#define MDF_CACHE_INDEX "index.json"
+
+///////////////////////////////////////////////////////////////////////////////
+// curl callbacks
+//
+
+static size_t
+cache_write_data(void* ptr, size_t size, size_t nmemb, FILE* stream)
+{
+  return fwrite(ptr, size, nmemb, stream);
+}
+
+static size_t
+cache_header_data(char* buffer, size_t size, size_t nitems, std::map<std::string, std::string>* pheaders)
+{
+  std::string line(buffer, size * nitems);
+  size_t pos = line.find(':');
+  if (std::string::npos != pos) {
+    std::string name  = line.substr(0, pos);
+    std::string value = line.substr(pos + 1);
+    vscp_makeLower(name);
+    vscp_trim(name);
+    vscp_trim(value);
+    (*pheaders)[name] = value;
+  }
+  return size * nitems;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CTor
+//
+
+CMdfCache::CMdfCache(size_t maxParsed)
+{
+  m_maxParsed = maxParsed ? maxParsed : 1;
+  m_maxAge    = DEFAULT_MAX_AGE;
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTor
+//
+
+CMdfCache::~CMdfCache()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setCacheFolder
+//
+
+int
+CMdfCache::setCacheFolder(const std::string& path)
+{
+  QDir dir(QString::fromStdString(path));
+  if (!dir.exists() && !dir.mkpath(".")) {
+    spdlog::error("MDF cache: Failed to create cache folder {0}", path);
+    return VSCP_ERROR_ERROR;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_folder = path;
+    m_entries.clear();
+  }
+
+  loadIndex();
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getCacheFolder
+//
+
+std::string
+CMdfCache::getCacheFolder(void)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_folder;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setMaxParsed
+//
+
+void
+CMdfCache::setMaxParsed(size_t maxParsed)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_maxParsed = maxParsed ? maxParsed : 1;
+  while (m_lru.size() > m_maxParsed) {
+    m_lru.pop_back();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setMaxAge
+//
+
+void
+CMdfCache::setMaxAge(uint32_t seconds)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_maxAge = seconds;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// normalizeUrl
+//
+
+std::string
+CMdfCache::normalizeUrl(const std::string& url)
+{
+  std::string str = url;
+  vscp_trim(str);
+  if (str.size() && (std::string::npos == str.find("://"))) {
+    str = "http://" + str;
+  }
+  return str;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fetch
+//
+
+int
+CMdfCache::fetch(const std::string& url, std::string& path, std::string& hash, bool bRevalidate)
+{
+  transfer t;
+  t.m_url = url;
+  t.m_key = normalizeUrl(url);
+  if (t.m_key.empty()) {
+    return VSCP_ERROR_PARAMETER;
+  }
+
+  if (claim(t, bRevalidate, path, hash)) {
+    return VSCP_ERROR_SUCCESS;
+  }
+
+  // Download without the lock so other URL's can be fetched at the same time
+  bool bModified = true;
+  int rv         = beginTransfer(t);
+  if (VSCP_ERROR_SUCCESS == rv) {
+    CURLcode res = curl_easy_perform(t.m_curl);
+    rv           = endTransfer(t, res, bModified);
+  }
+
+  return commit(t, rv, bModified, path, hash);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fetchMany
+//
+
+void
+CMdfCache::fetchMany(const std::deque<std::string>& urls, size_t maxConcurrent, fetchcallback cb)
+{
+  std::deque<std::unique_ptr<transfer>> queue;
+  std::map<CURL*, std::unique_ptr<transfer>> active;
+  std::set<std::string> keys;
+  std::string path;
+  std::string hash;
+
+  for (const auto& url : urls) {
+    std::unique_ptr<transfer> t(new transfer);
+    t->m_url = url;
+    t->m_key = normalizeUrl(url);
+    if (t->m_key.empty()) {
+      if (nullptr != cb) {
+        cb(url, VSCP_ERROR_PARAMETER, "", "");
+      }
+      continue;
+    }
+
+    // Each URL is only transferred once
+    if (!keys.insert(t->m_key).second) {
+      continue;
+    }
+
+    if (claim(*t, false, path, hash)) {
+      if (nullptr != cb) {
+        cb(url, VSCP_ERROR_SUCCESS, path, hash);
+      }
+      continue;
+    }
+
+    queue.push_back(std::move(t));
+  }
+
+  if (queue.empty()) {
+    return;
+  }
+
+  CURLM* pmulti = curl_multi_init();
+  size_t limit  = maxConcurrent ? maxConcurrent : 1;
+
+  while (queue.size() || active.size()) {
+
+    // Start new transfers up to the limit
+    while (queue.size() && (active.size() < limit)) {
+      std::unique_ptr<transfer> t = std::move(queue.front());
+      queue.pop_front();
+      int rv = beginTransfer(*t);
+      if (VSCP_ERROR_SUCCESS != rv) {
+        rv = commit(*t, rv, true, path, hash);
+        if (nullptr != cb) {
+          cb(t->m_url, rv, path, hash);
+        }
+        continue;
+      }
+      curl_multi_add_handle(pmulti, t->m_curl);
+      active[t->m_curl] = std::move(t);
+    }
+
+    int running = 0;
+    curl_multi_perform(pmulti, &running);
+
+    // Report transfers as they complete
+    CURLMsg* pmsg;
+    int left;
+    while (nullptr != (pmsg = curl_multi_info_read(pmulti, &left))) {
+      if (CURLMSG_DONE != pmsg->msg) {
+        continue;
+      }
+      CURLcode res = pmsg->data.result;
+      auto it      = active.find(pmsg->easy_handle);
+      if (it == active.end()) {
+        continue;
+      }
+      std::unique_ptr<transfer> t = std::move(it->second);
+      active.erase(it);
+      curl_multi_remove_handle(pmulti, t->m_curl);
+
+      bool bModified = true;
+      int rv         = endTransfer(*t, res, bModified);
+      rv             = commit(*t, rv, bModified, path, hash);
+      if (nullptr != cb) {
+        cb(t->m_url, rv, path, hash);
+      }
+    }
+
+    if (active.size()) {
+      curl_multi_poll(pmulti, nullptr, 0, 100, nullptr);
+    }
+  }
+
+  curl_multi_cleanup(pmulti);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// claim
+//
+
+bool
+CMdfCache::claim(transfer& t, bool bRevalidate, std::string& path, std::string& hash)
+{
+  int64_t now = QDateTime::currentSecsSinceEpoch();
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  // Someone else is fetching this URL, wait for the result
+  m_cv.wait(lock, [this, &t] { return (0 == m_fetching.count(t.m_key)); });
+
+  auto it = m_entries.find(t.m_key);
+  if ((it != m_entries.end()) && QFileInfo::exists(QString::fromStdString(makePath(it->second.m_file)))) {
+    t.m_bCached = true;
+    t.m_entry   = it->second;
+    if (!bRevalidate && m_maxAge && ((now - t.m_entry.m_validated) < (int64_t)m_maxAge)) {
+      m_stats.m_fileHits++;
+      path = makePath(t.m_entry.m_file);
+      hash = t.m_entry.m_hash;
+      return true;
+    }
+  }
+  else {
+    t.m_bCached           = false;
+    t.m_entry             = cacheentry();
+    t.m_entry.m_url       = t.m_key;
+    t.m_entry.m_validated = 0;
+  }
+
+  t.m_oldFile = t.m_entry.m_file;
+  m_fetching.insert(t.m_key);
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// commit
+//
+
+int
+CMdfCache::commit(transfer& t, int rv, bool bModified, std::string& path, std::string& hash)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_fetching.erase(t.m_key);
+
+    if (VSCP_ERROR_SUCCESS != rv) {
+      m_stats.m_errors++;
+      if (t.m_bCached) {
+        // Server not reachable, an old copy is better than nothing
+        spdlog::warn("MDF cache: Failed to revalidate {0}, using cached copy", t.m_key);
+        t.m_entry = m_entries[t.m_key];
+        rv        = VSCP_ERROR_SUCCESS;
+      }
+    }
+    else {
+      if (bModified) {
+        m_stats.m_downloads++;
+      }
+      else {
+        m_stats.m_notModified++;
+      }
+      t.m_entry.m_validated = QDateTime::currentSecsSinceEpoch();
+      m_entries[t.m_key]    = t.m_entry;
+
+      // Remove replaced file if no other URL has the same content
+      if (t.m_oldFile.size() && (t.m_oldFile != t.m_entry.m_file)) {
+        bool bUsed = false;
+        for (const auto& item : m_entries) {
+          if (item.second.m_file == t.m_oldFile) {
+            bUsed = true;
+            break;
+          }
+        }
+        if (!bUsed) {
+          // Files are named from their hash
+          std::string oldHash = t.m_oldFile.substr(0, t.m_oldFile.find('.'));
+          QFile::remove(QString::fromStdString(makePath(t.m_oldFile)));
+          QFile::remove(QString::fromStdString(makeSnapshotPath(makePath(t.m_oldFile), oldHash)));
+        }
+      }
+
+      saveIndex();
+    }
+
+    if (VSCP_ERROR_SUCCESS == rv) {
+      path = makePath(t.m_entry.m_file);
+      hash = t.m_entry.m_hash;
+    }
+    else {
+      path.clear();
+      hash.clear();
+    }
+  }
+
+  m_cv.notify_all();
+  return rv;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// get
+//
+
+int
+CMdfCache::get(const std::string& url,
+               std::shared_ptr<CMDF>& pmdf,
+               std::string& path,
+               std::function<void(int, const char*)> statusCallback)
+{
+  std::string hash;
+
+  if (nullptr != statusCallback) {
+    statusCallback(10, "Fetching MDF file...");
+  }
+
+  int rv = fetch(url, path, hash);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    if (nullptr != statusCallback) {
+      statusCallback(10, "Failed to download MDF file for device.");
+    }
+    spdlog::error("MDF cache: Failed to fetch MDF {0} rv={1}", url, rv);
+    return VSCP_ERROR_COMMUNICATION;
+  }
+
+  if (nullptr != statusCallback) {
+    statusCallback(60, "MDF fetched.");
+  }
+
+  return getParsed(path, hash, pmdf, statusCallback);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getCached
+//
+
+int
+CMdfCache::getCached(const std::string& url, std::shared_ptr<CMDF>& pmdf, std::string& path)
+{
+  std::string hash;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(normalizeUrl(url));
+    if ((it == m_entries.end()) || !QFileInfo::exists(QString::fromStdString(makePath(it->second.m_file)))) {
+      return VSCP_ERROR_ERROR;
+    }
+    m_stats.m_fileHits++;
+    path = makePath(it->second.m_file);
+    hash = it->second.m_hash;
+  }
+
+  return getParsed(path, hash, pmdf, nullptr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getParsed
+//
+
+int
+CMdfCache::getParsed(const std::string& path,
+                     const std::string& hash,
+                     std::shared_ptr<CMDF>& pmdf,
+                     std::function<void(int, const char*)> statusCallback)
+{
+  int rv;
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // Someone else is parsing this content, wait for the result
+    m_cv.wait(lock, [this, &hash] { return (0 == m_parsing.count(hash)); });
+
+    for (auto it = m_lru.begin(); it != m_lru.end(); ++it) {
+      if (it->first == hash) {
+        m_lru.splice(m_lru.begin(), m_lru, it);
+        pmdf = m_lru.front().second;
+        m_stats.m_parsedHits++;
+        if (nullptr != statusCallback) {
+          statusCallback(100, "MDF found in cache");
+        }
+        return VSCP_ERROR_SUCCESS;
+      }
+    }
+
+    m_parsing.insert(hash);
+  }
+
+  if (nullptr != statusCallback) {
+    statusCallback(80, "Parsing MDF file...");
+  }
+
+  std::shared_ptr<CMDF> pnew = std::make_shared<CMDF>();
+  rv                         = load(path, hash, *pnew);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_parsing.erase(hash);
+    if (VSCP_ERROR_SUCCESS == rv) {
+      m_lru.emplace_front(hash, pnew);
+      while (m_lru.size() > m_maxParsed) {
+        m_lru.pop_back();
+      }
+      pmdf = pnew;
+    }
+  }
+  m_cv.notify_all();
+
+  if (VSCP_ERROR_SUCCESS != rv) {
+    if (nullptr != statusCallback) {
+      statusCallback(80, "Failed to parse MDF");
+    }
+    spdlog::error("MDF cache: Failed to parse MDF {0} rv={1}", path, rv);
+    return VSCP_ERROR_PARSING;
+  }
+
+  if (nullptr != statusCallback) {
+    statusCallback(100, "MDF downloaded and parsed");
+  }
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// load
+//
+
+int
+CMdfCache::load(const std::string& path, const std::string& hash, CMDF& mdf)
+{
+  std::string snapPath = makeSnapshotPath(path, hash);
+
+  if (VSCP_ERROR_SUCCESS == CMdfSnapshot::load(snapPath, hash, mdf)) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.m_snapshots++;
+    return VSCP_ERROR_SUCCESS;
+  }
+
+  int rv;
+  try {
+    rv = mdf.parseMDF(path);
+  }
+  catch (const std::exception& ex) {
+    spdlog::error("MDF cache: Failed to parse MDF {0}: {1}", path, ex.what());
+    rv = VSCP_ERROR_PARSING;
+  }
+  catch (...) {
+    spdlog::error("MDF cache: Failed to parse MDF {0}: Unknown exception", path);
+    rv = VSCP_ERROR_PARSING;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (VSCP_ERROR_SUCCESS == rv) {
+      m_stats.m_parses++;
+    }
+    else {
+      m_stats.m_errors++;
+    }
+  }
+
+  if (VSCP_ERROR_SUCCESS != rv) {
+    return VSCP_ERROR_PARSING;
+  }
+
+  // A failed snapshot only means the next load is a parse again
+  if (hash.size() && (VSCP_ERROR_SUCCESS != CMdfSnapshot::save(mdf, snapPath, hash))) {
+    spdlog::warn("MDF cache: Failed to write snapshot for {0}", path);
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clear
+//
+
+void
+CMdfCache::clear(void)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_lru.clear();
+  for (const auto& item : m_entries) {
+    QFile::remove(QString::fromStdString(makePath(item.second.m_file)));
+    QFile::remove(QString::fromStdString(makeSnapshotPath(makePath(item.second.m_file), item.second.m_hash)));
+  }
+  m_entries.clear();
+  saveIndex();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getStats
+//
+
+CMdfCache::cachestats
+CMdfCache::getStats(void)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// beginTransfer
+//
+
+int
+CMdfCache::beginTransfer(transfer& t)
+{
+  std::string folder;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    folder = m_folder;
+  }
+
+  if (folder.empty()) {
+    spdlog::error("MDF cache: No cache folder set");
+    return VSCP_ERROR_ERROR;
+  }
+
+  // Download to a temporary file unique for the URL
+  t.m_tempPath = folder + "/" + std::to_string(std::hash<std::string>{}(t.m_key)) + ".tmp";
+  t.m_fp       = fopen(t.m_tempPath.c_str(), "wb");
+  if (nullptr == t.m_fp) {
+    spdlog::error("MDF cache: Failed to create {0}", t.m_tempPath);
+    return VSCP_ERROR_ERROR;
+  }
+
+  t.m_curl = curl_easy_init();
+  if (nullptr == t.m_curl) {
+    fclose(t.m_fp);
+    t.m_fp = nullptr;
+    QFile::remove(QString::fromStdString(t.m_tempPath));
+    return VSCP_ERROR_ERROR;
+  }
+
+  // Conditional request if there is a copy to validate
+  if (t.m_entry.m_etag.size()) {
+    t.m_plist = curl_slist_append(t.m_plist, ("If-None-Match: " + t.m_entry.m_etag).c_str());
+  }
+  if (t.m_entry.m_lastModified.size()) {
+    t.m_plist = curl_slist_append(t.m_plist, ("If-Modified-Since: " + t.m_entry.m_lastModified).c_str());
+  }
+
+  curl_easy_setopt(t.m_curl, CURLOPT_URL, t.m_key.c_str());
+  curl_easy_setopt(t.m_curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(t.m_curl, CURLOPT_FAILONERROR, 1L);
+  curl_easy_setopt(t.m_curl, CURLOPT_WRITEFUNCTION, cache_write_data);
+  curl_easy_setopt(t.m_curl, CURLOPT_WRITEDATA, t.m_fp);
+  curl_easy_setopt(t.m_curl, CURLOPT_HEADERFUNCTION, cache_header_data);
+  curl_easy_setopt(t.m_curl, CURLOPT_HEADERDATA, &t.m_headers);
+  if (nullptr != t.m_plist) {
+    curl_easy_setopt(t.m_curl, CURLOPT_HTTPHEADER, t.m_plist);
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// endTransfer
+//
+
+int
+CMdfCache::endTransfer(transfer& t, CURLcode res, bool& bModified)
+{
+  long httpCode = 0;
+  bModified     = true;
+
+  curl_easy_getinfo(t.m_curl, CURLINFO_RESPONSE_CODE, &httpCode);
+  curl_easy_cleanup(t.m_curl);
+  t.m_curl = nullptr;
+  curl_slist_free_all(t.m_plist);
+  t.m_plist = nullptr;
+  fclose(t.m_fp);
+  t.m_fp = nullptr;
+
+  if (CURLE_OK != res) {
+    spdlog::error("MDF cache: Failed to download {0} curl rv={1}", t.m_key, (int)res);
+    QFile::remove(QString::fromStdString(t.m_tempPath));
+    return VSCP_ERROR_COMMUNICATION;
+  }
+
+  if (t.m_headers.count("etag")) {
+    t.m_entry.m_etag = t.m_headers["etag"];
+  }
+  if (t.m_headers.count("last-modified")) {
+    t.m_entry.m_lastModified = t.m_headers["last-modified"];
+  }
+
+  if (304 == httpCode) {
+    spdlog::debug("MDF cache: {0} not modified", t.m_key);
+    QFile::remove(QString::fromStdString(t.m_tempPath));
+    bModified = false;
+    return VSCP_ERROR_SUCCESS;
+  }
+
+  std::string hash = hashFile(t.m_tempPath);
+  if (hash.empty()) {
+    QFile::remove(QString::fromStdString(t.m_tempPath));
+    return VSCP_ERROR_ERROR;
+  }
+
+  // Keep the extension as the parser use it to tell XML from JSON
+  std::string ext  = ".mdf";
+  std::string name = t.m_key.substr(t.m_key.find_last_of('/') + 1);
+  size_t pos       = name.find_last_of('.');
+  if ((std::string::npos != pos) && ((name.size() - pos) <= 5)) {
+    ext = name.substr(pos);
+    vscp_makeLower(ext);
+  }
+
+  // Content addressed, identical content is stored once. The temporary
+  // file is in the cache folder so m_folder is not needed here.
+  std::string file = hash + ext;
+  QString target   = QFileInfo(QString::fromStdString(t.m_tempPath)).path() + "/" + QString::fromStdString(file);
+  if (QFileInfo::exists(target)) {
+    QFile::remove(QString::fromStdString(t.m_tempPath));
+  }
+  else if (!QFile::rename(QString::fromStdString(t.m_tempPath), target)) {
+    spdlog::error("MDF cache: Failed to store {0}", target.toStdString());
+    QFile::remove(QString::fromStdString(t.m_tempPath));
+    return VSCP_ERROR_ERROR;
+  }
+
+  spdlog::debug("MDF cache: Downloaded {0} to {1}", t.m_key, file);
+  t.m_entry.m_file = file;
+  t.m_entry.m_hash = hash;
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// makeSnapshotPath
+//
+
+std::string
+CMdfCache::makeSnapshotPath(const std::string& path, const std::string& hash)
+{
+  QFileInfo info(QString::fromStdString(path));
+  return info.path().toStdString() + "/" + hash + CMdfSnapshot::EXTENSION;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// hashFile
+//
+
+std::string
+CMdfCache::hashFile(const std::string& path)
+{
+  QFile file(QString::fromStdString(path));
+  if (!file.open(QIODevice::ReadOnly)) {
+    return "";
+  }
+
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  if (!hash.addData(&file)) {
+    return "";
+  }
+
+  return hash.result().toHex().toStdString();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// loadIndex
+//
+
+void
+CMdfCache::loadIndex(void)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::ifstream in(makePath(MDF_CACHE_INDEX));
+  if (!in.is_open()) {
+    return;
+  }
+
+  try {
+    json j;
+    in >> j;
+    for (const auto& item : j["entries"]) {
+      cacheentry entry;
+      entry.m_url          = item.value("url", "");
+      entry.m_file         = item.value("file", "");
+      entry.m_hash         = item.value("hash", "");
+      entry.m_etag         = item.value("etag", "");
+      entry.m_lastModified = item.value("last-modified", "");
+      entry.m_validated    = item.value("validated", (int64_t)0);
+      if (entry.m_url.size() && entry.m_file.size()) {
+        m_entries[entry.m_url] = entry;
+      }
+    }
+  }
+  catch (...) {
+    spdlog::warn("MDF cache: Invalid index in {0}, starting with an empty cache", m_folder);
+    m_entries.clear();
+  }
+
+  spdlog::debug("MDF cache: {0} entries in {1}", m_entries.size(), m_folder);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// saveIndex
+//
+
+void
+CMdfCache::saveIndex(void)
+{
+  if (m_folder.empty()) {
+    return;
+  }
+
+  json j;
+  j["entries"] = json::array();
+  for (const auto& item : m_entries) {
+    json e;
+    e["url"]           = item.second.m_url;
+    e["file"]          = item.second.m_file;
+    e["hash"]          = item.second.m_hash;
+    e["etag"]          = item.second.m_etag;
+    e["last-modified"] = item.second.m_lastModified;
+    e["validated"]     = item.second.m_validated;
+    j["entries"].push_back(e);
+  }
+
+  // Written to a temporary file and renamed so a crash never leaves a
+  // truncated index behind
+  QSaveFile file(QString::fromStdString(makePath(MDF_CACHE_INDEX)));
+  if (!file.open(QIODevice::WriteOnly)) {
+    spdlog::error("MDF cache: Failed to write index to {0}", m_folder);
+    return;
+  }
+  file.write(QByteArray::fromStdString(j.dump(2)));
+  if (!file.commit()) {
+    spdlog::error("MDF cache: Failed to write index to {0}", m_folder);
+  }
+}
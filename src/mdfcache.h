@@ -0,0 +1,324 @@
+// mdfcache.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef MDFCACHE_H
+#define MDFCACHE_H
+
+#include <mdf.h>
+
+#include <curl/curl.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+/*!
+  Cache for downloaded and parsed MDF files shared by all windows.
+
+  Downloaded files are kept in a persistent cache folder and are stored
+  under the SHA-256 hash of their content. An index maps each MDF URL
+  to the file and to the validators (ETag/Last-Modified) the server sent
+  so that a file is only transferred again if it has changed. A URL that
+  has been validated within the max age is used without contacting the
+  server at all.
+
+  Parsed MDF objects are held in a LRU keyed on the content hash, so
+  nodes that share an MDF, also under different URLs, share one parsed
+  object. A binary snapshot (see CMdfSnapshot) is written next to each
+  parsed file so that the next time it is needed, also after a restart,
+  the snapshot is loaded instead of parsing the file again. Parsed
+  objects are shared and must be treated as read only. Windows that
+  modify their MDF should fetch() the file and parse their own copy.
+
+  All methods are thread safe. Concurrent requests for the same URL
+  are coalesced into one download. curl_global_init() must have been
+  called before the first download (done in main()).
+*/
+
+class CMdfCache {
+
+public:
+  /// Default number of parsed MDF's to keep
+  static const size_t DEFAULT_MAX_PARSED = 16;
+
+  /// Default time in seconds a validated file is used without asking the server
+  static const uint32_t DEFAULT_MAX_AGE = 3600;
+
+  /*!
+    Cached file for an MDF URL
+  */
+  struct cacheentry {
+    std::string m_url;
+    std::string m_file;         // File name in cache folder
+    std::string m_hash;         // SHA-256 of content (hex)
+    std::string m_etag;         // ETag from server or empty
+    std::string m_lastModified; // Last-Modified from server or empty
+    int64_t m_validated;        // Time (s since epoch) file was last checked against server
+  };
+
+  /*!
+    Cache statistics
+  */
+  struct cachestats {
+    uint32_t m_parsedHits;  // Parsed MDF found in LRU
+    uint32_t m_fileHits;    // File used without contacting server
+    uint32_t m_notModified; // Server reported file as unchanged
+    uint32_t m_downloads;   // Files transferred
+    uint32_t m_parses;      // Files parsed
+    uint32_t m_snapshots;   // Files loaded from snapshot instead of parsed
+    uint32_t m_errors;      // Failed downloads/parses
+  };
+
+  /// Called for each URL handled by fetchMany (url, rv, path, hash)
+  typedef std::function<void(const std::string&, int, const std::string&, const std::string&)> fetchcallback;
+
+  CMdfCache(size_t maxParsed = DEFAULT_MAX_PARSED);
+  ~CMdfCache();
+
+  /*!
+    Set the folder used for cached files and read the index from it.
+    The folder is created if it does not exist.
+    @param path Path to cache folder
+    @return VSCP_ERROR_SUCCESS on success
+  */
+  int setCacheFolder(const std::string& path);
+
+  /*!
+    Get the cache folder
+    @return Path to cache folder
+  */
+  std::string getCacheFolder(void);
+
+  /*!
+    Set number of parsed MDF's to keep in memory
+    @param maxParsed Max number of parsed MDF's
+  */
+  void setMaxParsed(size_t maxParsed);
+
+  /*!
+    Set time a validated file is used without asking the server
+    @param seconds Max age in seconds. Zero always revalidates.
+  */
+  void setMaxAge(uint32_t seconds);
+
+  /*!
+    Get an up to date local copy of an MDF
+    @param url URL for the MDF
+    @param path Set to path of the cached file
+    @param hash Set to SHA-256 of the content
+    @param bRevalidate Ask server even if the file is within max age
+    @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_COMMUNICATION if
+            the file could not be downloaded and is not in the cache.
+  */
+  int fetch(const std::string& url, std::string& path, std::string& hash, bool bRevalidate = false);
+
+  /*!
+    Get up to date local copies of many MDF's. Files that need to be
+    transferred are downloaded concurrently and the callback is called
+    as each one completes. Duplicate URL's are only reported once.
+    @param urls URL's to fetch
+    @param maxConcurrent Max number of transfers in progress at once
+    @param cb Called with result for each URL
+  */
+  void fetchMany(const std::deque<std::string>& urls, size_t maxConcurrent, fetchcallback cb);
+
+  /*!
+    Get a parsed MDF
+    @param url URL for the MDF
+    @param pmdf Set to shared parsed MDF. Treat as read only.
+    @param path Set to path of the cached file
+    @param statusCallback Optional progress callback (percent, message)
+    @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_COMMUNICATION if
+            the MDF could not be fetched, VSCP_ERROR_PARSING if it could
+            not be parsed.
+  */
+  int get(const std::string& url,
+          std::shared_ptr<CMDF>& pmdf,
+          std::string& path,
+          std::function<void(int, const char*)> statusCallback = nullptr);
+
+  /*!
+    Get a parsed MDF from the local copy only. The server is not
+    asked even if the copy is older than the max age. For callers that
+    know from elsewhere that the MDF has not changed.
+    @param url URL for the MDF
+    @param pmdf Set to shared parsed MDF. Treat as read only.
+    @param path Set to path of the cached file
+    @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_ERROR if
+            there is no local copy, VSCP_ERROR_PARSING if it could
+            not be parsed.
+  */
+  int getCached(const std::string& url, std::shared_ptr<CMDF>& pmdf, std::string& path);
+
+  /*!
+    Load a cached MDF into an MDF object. An up to date snapshot
+    of the file is loaded if there is one. Else the file is parsed
+    and a snapshot is written for the next time.
+    @param path Path to the cached file
+    @param hash SHA-256 of the content as returned by fetch()
+    @param mdf MDF object to load into
+    @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_PARSING if the
+            file could not be parsed.
+  */
+  int load(const std::string& path, const std::string& hash, CMDF& mdf);
+
+  /*!
+    Remove all parsed MDF's and all cached files
+  */
+  void clear(void);
+
+  /*!
+    Get statistics
+    @return Statistics
+  */
+  cachestats getStats(void);
+
+  /*!
+    Add http:// to an URL that has no scheme, as MDF URL's in
+    the standard registers normally lack it.
+    @param url URL to normalize
+    @return Normalized URL
+  */
+  static std::string normalizeUrl(const std::string& url);
+
+private:
+  /*!
+    State for one download
+  */
+  struct transfer {
+    transfer() : m_bCached(false), m_fp(nullptr), m_plist(nullptr), m_curl(nullptr) {};
+    std::string m_url;                             // URL as requested
+    std::string m_key;                             // Normalized URL
+    cacheentry m_entry;                            // Entry to update
+    std::string m_oldFile;                         // File before download
+    bool m_bCached;                                // There was a copy before download
+    std::string m_tempPath;                        // File downloaded to
+    FILE* m_fp;
+    struct curl_slist* m_plist;                    // Conditional request headers
+    std::map<std::string, std::string> m_headers;  // Response headers
+    CURL* m_curl;
+  };
+
+  /*!
+    Check the cache for an URL. If a download is needed the URL is
+    marked as being fetched and commit() must be called.
+    @param t Transfer with m_url/m_key set. Filled in for download.
+    @param bRevalidate Ask server even if the file is within max age
+    @param path Set to path of the cached file if no download is needed
+    @param hash Set to hash of the cached file if no download is needed
+    @return True if the cached file can be used as is.
+  */
+  bool claim(transfer& t, bool bRevalidate, std::string& path, std::string& hash);
+
+  /*!
+    Get the parsed MDF for a cached file from the LRU or load it
+    @param path Path to the cached file
+    @param hash SHA-256 of the content
+    @param pmdf Set to shared parsed MDF
+    @param statusCallback Optional progress callback (percent, message)
+    @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_PARSING if the
+            file could not be parsed.
+  */
+  int getParsed(const std::string& path,
+                const std::string& hash,
+                std::shared_ptr<CMDF>& pmdf,
+                std::function<void(int, const char*)> statusCallback);
+
+  /*!
+    Prepare the curl handle for a transfer. A conditional request is
+    made if there is a cached copy. Called without the lock held, the
+    lock is taken to read the cache folder.
+    @param t Transfer to start
+    @return VSCP_ERROR_SUCCESS on success
+  */
+  int beginTransfer(transfer& t);
+
+  /*!
+    Clean up a completed transfer and store the file
+    @param t Transfer that completed
+    @param res Result from curl
+    @param bModified Set to false if the server reported the file unchanged
+    @return VSCP_ERROR_SUCCESS on success
+  */
+  int endTransfer(transfer& t, CURLcode res, bool& bModified);
+
+  /*!
+    Update the index with the result of a transfer and wake up waiters
+    @param t Transfer that completed
+    @param rv Result of the transfer
+    @param bModified False if the server reported the file unchanged
+    @param path Set to path of the file on success
+    @param hash Set to hash of the file on success
+    @return VSCP_ERROR_SUCCESS if there is a file to use
+  */
+  int commit(transfer& t, int rv, bool bModified, std::string& path, std::string& hash);
+
+  /// Read index from cache folder
+  void loadIndex(void);
+
+  /// Write index to cache folder (lock must be held)
+  void saveIndex(void);
+
+  /// Get full path for a file in the cache folder
+  std::string makePath(const std::string& file) const { return m_folder + "/" + file; };
+
+  /// Get path for the snapshot of a cached file
+  static std::string makeSnapshotPath(const std::string& path, const std::string& hash);
+
+  /// Calculate SHA-256 for a file (hex) or empty string on failure
+  static std::string hashFile(const std::string& path);
+
+  std::mutex m_mutex;
+
+  /// Signalled when a download or parse in progress completes
+  std::condition_variable m_cv;
+
+  /// URL's being fetched and hashes being parsed
+  std::set<std::string> m_fetching;
+  std::set<std::string> m_parsing;
+
+  std::string m_folder;
+  size_t m_maxParsed;
+  uint32_t m_maxAge;
+
+  /// Cached files keyed on normalized URL
+  std::map<std::string, cacheentry> m_entries;
+
+  /// Parsed MDF's, most recently used first
+  std::list<std::pair<std::string, std::shared_ptr<CMDF>>> m_lru;
+
+  cachestats m_stats;
+};
+
+#endif // MDFCACHE_H
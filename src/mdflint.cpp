@@ -0,0 +1,521 @@
+// mdflint.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "mdflint.h"
+
+#include <algorithm>
+
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMdfLint::CMdfLint()
+{
+  m_bRunning = false;
+  m_bCancel  = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMdfLint::~CMdfLint()
+{
+  cancel();
+  wait();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// makeInput
+//
+
+void
+CMdfLint::makeInput(CMDF& mdf, lintinput& input)
+{
+  input.m_level = mdf.getLevel();
+
+  input.m_registers.clear();
+  std::deque<CMDF_Register*>* pregs = mdf.getRegisterObjList();
+  if (nullptr != pregs) {
+    for (CMDF_Register* preg : *pregs) {
+      if (nullptr == preg) {
+        continue;
+      }
+      lintregister reg;
+      reg.m_pobj   = preg;
+      reg.m_page   = preg->getPage();
+      reg.m_offset = preg->getOffset();
+      reg.m_span   = std::max<uint32_t>(1, preg->getSpan());
+      reg.m_name   = preg->getName();
+      input.m_registers.push_back(reg);
+    }
+  }
+
+  input.m_remotevars.clear();
+  std::deque<CMDF_RemoteVariable*>* pvars = mdf.getRemoteVariableList();
+  if (nullptr != pvars) {
+    for (CMDF_RemoteVariable* pvar : *pvars) {
+      if (nullptr == pvar) {
+        continue;
+      }
+      lintremotevar rvar;
+      rvar.m_pobj   = pvar;
+      rvar.m_page   = pvar->getPage();
+      rvar.m_offset = pvar->getOffset();
+      rvar.m_size   = std::max<uint32_t>(1, pvar->getTypeByteCount());
+      rvar.m_name   = pvar->getName();
+      input.m_remotevars.push_back(rvar);
+    }
+  }
+
+  CMDF_DecisionMatrix* pdm = mdf.getDM();
+  input.m_pdm              = pdm;
+  input.m_dmStartPage      = (nullptr != pdm) ? pdm->getStartPage() : 0;
+  input.m_dmStartOffset    = (nullptr != pdm) ? pdm->getStartOffset() : 0;
+  input.m_dmRowCount       = (nullptr != pdm) ? pdm->getRowCount() : 0;
+  input.m_dmRowSize        = (nullptr != pdm) ? pdm->getRowSize() : 0;
+
+  input.m_events.clear();
+  std::deque<CMDF_Event*>* pevents = mdf.getEventList();
+  if (nullptr != pevents) {
+    for (CMDF_Event* pevent : *pevents) {
+      if (nullptr == pevent) {
+        continue;
+      }
+      lintevent ev;
+      ev.m_pobj  = pevent;
+      ev.m_class = pevent->getClass();
+      ev.m_type  = pevent->getType();
+      ev.m_name  = pevent->getName();
+      input.m_events.push_back(ev);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+int
+CMdfLint::start(lintinput& input,
+                eventcallback cbEvent,
+                findingcallback cbFinding,
+                donecallback cbDone)
+{
+  if (m_bRunning) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  // Join a previous run
+  wait();
+
+  m_bCancel  = false;
+  m_bRunning = true;
+  m_thread   = std::thread(&CMdfLint::worker, this, std::move(input), cbEvent, cbFinding, cbDone);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// wait
+//
+
+void
+CMdfLint::wait(void)
+{
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// worker
+//
+
+void
+CMdfLint::worker(lintinput input, eventcallback cbEvent, findingcallback cbFinding, donecallback cbDone)
+{
+  bool bDone = run(input, cbEvent, cbFinding);
+
+  m_bRunning = false;
+
+  if (nullptr != cbDone) {
+    cbDone(!bDone);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// run
+//
+
+bool
+CMdfLint::run(const lintinput& input, eventcallback cbEvent, findingcallback cbFinding)
+{
+  std::deque<interval> index;
+  std::deque<interval> coverage;
+  std::deque<finding> findings;
+
+  buildIndex(input, index);
+  buildCoverage(index, coverage);
+  if (m_bCancel) {
+    return false;
+  }
+
+  checkRegisters(input, index, findings);
+  if (m_bCancel) {
+    return false;
+  }
+  if ((nullptr != cbFinding) && findings.size()) {
+    cbFinding(findings);
+  }
+  findings.clear();
+
+  checkRemoteVariables(input, coverage, findings);
+  if (m_bCancel) {
+    return false;
+  }
+  if ((nullptr != cbFinding) && findings.size()) {
+    cbFinding(findings);
+  }
+  findings.clear();
+
+  checkDecisionMatrix(input, coverage, findings);
+  if (m_bCancel) {
+    return false;
+  }
+  if ((nullptr != cbFinding) && findings.size()) {
+    cbFinding(findings);
+  }
+  findings.clear();
+
+  if (nullptr != cbEvent) {
+    checkEvents(input, cbEvent, findings);
+    if (m_bCancel) {
+      return false;
+    }
+    if ((nullptr != cbFinding) && findings.size()) {
+      cbFinding(findings);
+    }
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// buildIndex
+//
+
+void
+CMdfLint::buildIndex(const lintinput& input, std::deque<interval>& index)
+{
+  index.clear();
+  for (const lintregister& reg : input.m_registers) {
+    interval iv;
+    iv.m_page  = reg.m_page;
+    iv.m_first = reg.m_offset;
+    iv.m_last  = reg.m_offset + reg.m_span - 1;
+    iv.m_preg  = &reg;
+    index.push_back(iv);
+  }
+
+  std::sort(index.begin(), index.end(), [](const interval& a, const interval& b) {
+    if (a.m_page != b.m_page) {
+      return a.m_page < b.m_page;
+    }
+    return a.m_first < b.m_first;
+  });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// buildCoverage
+//
+
+void
+CMdfLint::buildCoverage(const std::deque<interval>& index, std::deque<interval>& coverage)
+{
+  coverage.clear();
+  for (const interval& iv : index) {
+    if (coverage.size() &&
+        (coverage.back().m_page == iv.m_page) &&
+        ((uint64_t)iv.m_first <= (uint64_t)coverage.back().m_last + 1)) {
+      coverage.back().m_last = std::max(coverage.back().m_last, iv.m_last);
+      continue;
+    }
+    interval merged = iv;
+    merged.m_preg   = nullptr;
+    coverage.push_back(merged);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// findUncovered
+//
+
+int64_t
+CMdfLint::findUncovered(const std::deque<interval>& coverage, uint16_t page, uint32_t first, uint32_t last)
+{
+  // First merged interval that starts after 'first'. The one before it
+  // is the only one that can cover 'first'.
+  auto it = std::upper_bound(coverage.begin(),
+                             coverage.end(),
+                             std::make_pair(page, first),
+                             [](const std::pair<uint16_t, uint32_t>& key, const interval& iv) {
+                               if (key.first != iv.m_page) {
+                                 return key.first < iv.m_page;
+                               }
+                               return key.second < iv.m_first;
+                             });
+
+  if (it == coverage.begin()) {
+    return first;
+  }
+
+  --it;
+  if ((it->m_page != page) || (it->m_last < first)) {
+    return first;
+  }
+
+  // Merged intervals never touch so the range must end inside this one
+  return (it->m_last >= last) ? -1 : (int64_t)it->m_last + 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// checkRegisters
+//
+
+void
+CMdfLint::checkRegisters(const lintinput& input, const std::deque<interval>& index, std::deque<finding>& findings)
+{
+  const interval* pReach = nullptr; // Interval on page that reaches furthest
+
+  for (const interval& iv : index) {
+
+    if (m_bCancel) {
+      return;
+    }
+
+    if ((VSCP_LEVEL1 == input.m_level) && (iv.m_last > LEVEL1_PAGE_END)) {
+      finding f;
+      f.m_severity = severity::ERROR;
+      f.m_pobj     = iv.m_preg->m_pobj;
+      f.m_type     = mdf_type_register_item;
+      f.m_message  = vscp_str_format("Register %d:%d '%s' extends past the end of the page (span %d).",
+                                    (int)iv.m_page,
+                                    (int)iv.m_first,
+                                    iv.m_preg->m_name.c_str(),
+                                    (int)iv.m_preg->m_span);
+      findings.push_back(f);
+    }
+
+    if ((nullptr != pReach) && (pReach->m_page == iv.m_page) && (iv.m_first <= pReach->m_last)) {
+      finding f;
+      f.m_severity = severity::ERROR;
+      f.m_pobj     = iv.m_preg->m_pobj;
+      f.m_type     = mdf_type_register_item;
+      f.m_message  = vscp_str_format("Register %d:%d '%s' overlaps register %d:%d '%s'.",
+                                    (int)iv.m_page,
+                                    (int)iv.m_first,
+                                    iv.m_preg->m_name.c_str(),
+                                    (int)pReach->m_page,
+                                    (int)pReach->m_first,
+                                    pReach->m_preg->m_name.c_str());
+      findings.push_back(f);
+    }
+
+    if ((nullptr == pReach) || (pReach->m_page != iv.m_page) || (iv.m_last > pReach->m_last)) {
+      pReach = &iv;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// checkRemoteVariables
+//
+
+void
+CMdfLint::checkRemoteVariables(const lintinput& input, const std::deque<interval>& coverage, std::deque<finding>& findings)
+{
+  for (const lintremotevar& rvar : input.m_remotevars) {
+
+    if (m_bCancel) {
+      return;
+    }
+
+    uint32_t last = rvar.m_offset + rvar.m_size - 1;
+
+    if ((VSCP_LEVEL1 == input.m_level) && (last > LEVEL1_PAGE_END)) {
+      finding f;
+      f.m_severity = severity::ERROR;
+      f.m_pobj     = rvar.m_pobj;
+      f.m_type     = mdf_type_remotevar_item;
+      f.m_message  = vscp_str_format("Remote variable '%s' at %d:%d (%d bytes) extends past the end of the page.",
+                                    rvar.m_name.c_str(),
+                                    (int)rvar.m_page,
+                                    (int)rvar.m_offset,
+                                    (int)rvar.m_size);
+      findings.push_back(f);
+      continue;
+    }
+
+    int64_t uncovered = findUncovered(coverage, rvar.m_page, rvar.m_offset, last);
+    if (uncovered >= 0) {
+      finding f;
+      f.m_severity = severity::WARNING;
+      f.m_pobj     = rvar.m_pobj;
+      f.m_type     = mdf_type_remotevar_item;
+      f.m_message  = vscp_str_format("Remote variable '%s' at %d:%d (%d bytes) uses register %d:%d that is not defined.",
+                                    rvar.m_name.c_str(),
+                                    (int)rvar.m_page,
+                                    (int)rvar.m_offset,
+                                    (int)rvar.m_size,
+                                    (int)rvar.m_page,
+                                    (int)uncovered);
+      findings.push_back(f);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// checkDecisionMatrix
+//
+
+void
+CMdfLint::checkDecisionMatrix(const lintinput& input, const std::deque<interval>& coverage, std::deque<finding>& findings)
+{
+  if ((nullptr == input.m_pdm) || !input.m_dmRowCount || !input.m_dmRowSize) {
+    return;
+  }
+
+  int firstRow      = -1; // First row with undefined registers
+  int64_t firstByte = -1; // First undefined register in that row
+  int nRows         = 0;  // Number of rows with undefined registers
+
+  for (uint16_t row = 0; row < input.m_dmRowCount; row++) {
+
+    if (m_bCancel) {
+      return;
+    }
+
+    uint32_t first = input.m_dmStartOffset + (uint32_t)row * input.m_dmRowSize;
+    uint32_t last  = first + input.m_dmRowSize - 1;
+
+    if ((VSCP_LEVEL1 == input.m_level) && (last > LEVEL1_PAGE_END)) {
+      finding f;
+      f.m_severity = severity::ERROR;
+      f.m_pobj     = input.m_pdm;
+      f.m_type     = mdf_type_decision_matrix;
+      f.m_message  = vscp_str_format("Decision matrix row %d at %d:%d is outside the page (%d rows of %d bytes from offset %d).",
+                                    (int)row,
+                                    (int)input.m_dmStartPage,
+                                    (int)first,
+                                    (int)input.m_dmRowCount,
+                                    (int)input.m_dmRowSize,
+                                    (int)input.m_dmStartOffset);
+      findings.push_back(f);
+      break; // Rest of the rows is outside as well
+    }
+
+    int64_t uncovered = findUncovered(coverage, input.m_dmStartPage, first, last);
+    if (uncovered >= 0) {
+      if (firstRow < 0) {
+        firstRow  = row;
+        firstByte = uncovered;
+      }
+      nRows++;
+    }
+  }
+
+  // One finding for all rows that use undefined registers
+  if (nRows) {
+    finding f;
+    f.m_severity = severity::WARNING;
+    f.m_pobj     = input.m_pdm;
+    f.m_type     = mdf_type_decision_matrix;
+    f.m_message  = vscp_str_format("Decision matrix uses registers that are not defined in %d row(s), first in row %d at %d:%d.",
+                                  nRows,
+                                  firstRow,
+                                  (int)input.m_dmStartPage,
+                                  (int)firstByte);
+    findings.push_back(f);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// checkEvents
+//
+
+void
+CMdfLint::checkEvents(const lintinput& input, eventcallback cbEvent, std::deque<finding>& findings)
+{
+  for (const lintevent& ev : input.m_events) {
+
+    if (m_bCancel) {
+      return;
+    }
+
+    // Level I events sent over Level II (class 512-1023) use the Level I tables
+    uint16_t vscpClass = ev.m_class;
+    if ((vscpClass >= 512) && (vscpClass < 1024) && !cbEvent(vscpClass, -1)) {
+      vscpClass -= 512;
+    }
+
+    if (!cbEvent(vscpClass, -1)) {
+      finding f;
+      f.m_severity = severity::ERROR;
+      f.m_pobj     = ev.m_pobj;
+      f.m_type     = mdf_type_event_item;
+      f.m_message  = vscp_str_format("Event '%s' uses unknown VSCP class %d.",
+                                    ev.m_name.c_str(),
+                                    (int)ev.m_class);
+      findings.push_back(f);
+    }
+    else if (!cbEvent(vscpClass, ev.m_type)) {
+      finding f;
+      f.m_severity = severity::ERROR;
+      f.m_pobj     = ev.m_pobj;
+      f.m_type     = mdf_type_event_item;
+      f.m_message  = vscp_str_format("Event '%s' uses unknown VSCP type %d for class %d.",
+                                    ev.m_name.c_str(),
+                                    (int)ev.m_type,
+                                    (int)ev.m_class);
+      findings.push_back(f);
+    }
+  }
+}
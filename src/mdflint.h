@@ -0,0 +1,238 @@
+// mdflint.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MDFLINT_H
+#define MDFLINT_H
+
+#include <mdf.h>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+
+/*!
+  Validation of an MDF beyond what the parser checks.
+
+  The MDF is copied into a light lint input on the calling (GUI) thread
+  with makeInput() and the checks then run on a worker thread so the
+  editor never waits for them. Findings are reported in batches, one
+  batch per check, as the checks complete.
+
+  The checks are
+    - registers that overlap on a page
+    - registers, remote variables and decision matrix rows that
+      extend past the end of a Level I page
+    - remote variables and decision matrix rows that are not
+      covered by defined registers
+    - events with a class or type that is not known
+
+  Overlap and coverage checks use an index of register intervals
+  sorted on page and offset, so a run is O(n log n).
+*/
+
+class CMdfLint {
+
+public:
+  /// Last offset for a register on a Level I page
+  static const uint32_t LEVEL1_PAGE_END = 0x7f;
+
+  /*!
+    Severity of a finding
+  */
+  enum class severity { WARNING = 0,
+                        ERROR };
+
+  /*!
+    One problem found in the MDF
+  */
+  struct finding {
+    severity m_severity;
+    CMDF_Object* m_pobj;    // Object the finding is for (only used as a key)
+    mdf_record_type m_type; // Tree item type for the object
+    std::string m_message;
+  };
+
+  /*!
+    Register as seen by the checks
+  */
+  struct lintregister {
+    CMDF_Object* m_pobj;
+    uint16_t m_page;
+    uint32_t m_offset;
+    uint32_t m_span;
+    std::string m_name;
+  };
+
+  /*!
+    Remote variable as seen by the checks
+  */
+  struct lintremotevar {
+    CMDF_Object* m_pobj;
+    uint16_t m_page;
+    uint32_t m_offset;
+    uint32_t m_size;
+    std::string m_name;
+  };
+
+  /*!
+    Event as seen by the checks
+  */
+  struct lintevent {
+    CMDF_Object* m_pobj;
+    uint16_t m_class;
+    uint16_t m_type;
+    std::string m_name;
+  };
+
+  /*!
+    Everything the checks need, copied from the MDF so that the
+    worker never touches the MDF while it is edited.
+  */
+  struct lintinput {
+    int m_level;
+    std::deque<lintregister> m_registers;
+    std::deque<lintremotevar> m_remotevars;
+    CMDF_Object* m_pdm;
+    uint16_t m_dmStartPage;
+    uint32_t m_dmStartOffset;
+    uint16_t m_dmRowCount;
+    uint16_t m_dmRowSize;
+    std::deque<lintevent> m_events;
+  };
+
+  /// Called with the findings for each completed check
+  typedef std::function<void(const std::deque<finding>&)> findingcallback;
+
+  /// Called when the run ends (true if cancelled)
+  typedef std::function<void(bool)> donecallback;
+
+  /*!
+    Called to check if an event is known. Type is -1 when only
+    the class should be checked. Called from the worker thread.
+  */
+  typedef std::function<bool(uint16_t, int)> eventcallback;
+
+  CMdfLint();
+  ~CMdfLint();
+
+  /*!
+    Copy what the checks need from an MDF. Must be called on the
+    thread that owns the MDF.
+    @param mdf MDF to copy from
+    @param input Filled with lint input
+  */
+  static void makeInput(CMDF& mdf, lintinput& input);
+
+  /*!
+    Start a run on a worker thread. A running check must be
+    cancelled and waited for first.
+    @param input Lint input from makeInput
+    @param cbEvent Lookup for known classes/types or nullptr to skip the event check
+    @param cbFinding Called with the findings for each check
+    @param cbDone Called when the run ends
+    @return VSCP_ERROR_SUCCESS if started, VSCP_ERROR_ERROR if a run is active.
+  */
+  int start(lintinput& input,
+            eventcallback cbEvent,
+            findingcallback cbFinding,
+            donecallback cbDone = nullptr);
+
+  /*!
+    Cancel a running check. The done callback is still called.
+  */
+  void cancel(void) { m_bCancel = true; };
+
+  /*!
+    Wait for the run to end
+  */
+  void wait(void);
+
+  /*!
+    Check if a run is active
+    @return True if running
+  */
+  bool isRunning(void) const { return m_bRunning; };
+
+  /*!
+    Run all checks on the calling thread
+    @param input Lint input from makeInput
+    @param cbEvent Lookup for known classes/types or nullptr to skip the event check
+    @param cbFinding Called with the findings for each check
+    @return True if all checks was run, false if cancelled.
+  */
+  bool run(const lintinput& input, eventcallback cbEvent, findingcallback cbFinding);
+
+private:
+  /// Register interval in the index
+  struct interval {
+    uint16_t m_page;
+    uint32_t m_first;
+    uint32_t m_last;
+    const lintregister* m_preg;
+  };
+
+  /// Worker thread
+  void worker(lintinput input, eventcallback cbEvent, findingcallback cbFinding, donecallback cbDone);
+
+  /// Build the register interval index sorted on page/offset
+  void buildIndex(const lintinput& input, std::deque<interval>& index);
+
+  /// Merge overlapping and adjacent intervals in the index per page
+  void buildCoverage(const std::deque<interval>& index, std::deque<interval>& coverage);
+
+  /*!
+    Find the first byte in a range that no register covers
+    @param coverage Merged register intervals
+    @param page Page for range
+    @param first First offset in range
+    @param last Last offset in range
+    @return Offset for the first byte not covered or -1 if all is covered
+  */
+  int64_t findUncovered(const std::deque<interval>& coverage, uint16_t page, uint32_t first, uint32_t last);
+
+  /// Check for registers that overlap or extend past the page
+  void checkRegisters(const lintinput& input, const std::deque<interval>& index, std::deque<finding>& findings);
+
+  /// Check remote variables against page end and defined registers
+  void checkRemoteVariables(const lintinput& input, const std::deque<interval>& coverage, std::deque<finding>& findings);
+
+  /// Check decision matrix rows against page end and defined registers
+  void checkDecisionMatrix(const lintinput& input, const std::deque<interval>& coverage, std::deque<finding>& findings);
+
+  /// Check that event classes and types are known
+  void checkEvents(const lintinput& input, eventcallback cbEvent, std::deque<finding>& findings);
+
+  std::thread m_thread;
+  std::atomic<bool> m_bRunning;
+  std::atomic<bool> m_bCancel;
+};
+
+#endif // MDFLINT_H
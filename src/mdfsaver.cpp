@@ -0,0 +1,494 @@
+// mdfsaver.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "mdfsaver.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStringList>
+
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+const char* CMdfSaver::TMP_EXTENSION = ".save~";
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMdfSaver::CMdfSaver()
+{
+  m_bRunning = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMdfSaver::~CMdfSaver()
+{
+  wait();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// prepare
+//
+
+int
+CMdfSaver::prepare(CMDF& mdf, const std::string& path, mdf_format format, savejob& job)
+{
+  job.m_path    = path;
+  job.m_tmpPath = path + TMP_EXTENSION;
+  job.m_format  = format;
+  job.m_bDm     = false;
+  job.m_dm      = json();
+
+  int rv = mdf.save(job.m_tmpPath, format);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    spdlog::error("MDF save: Failed to serialize MDF to {0} rv={1}", job.m_tmpPath, rv);
+    QFile::remove(QString::fromStdString(job.m_tmpPath));
+    return VSCP_ERROR_WRITE_ERROR;
+  }
+
+  // The decision matrix is not written by the library for JSON
+  if ((MDF_FORMAT_JSON == format) && (nullptr != mdf.getDM())) {
+    job.m_bDm = true;
+    job.m_dm  = makeDecisionMatrixJson(mdf.getDM());
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// finish
+//
+
+int
+CMdfSaver::finish(const savejob& job, std::string& strError)
+{
+  const QString tmpPath = QString::fromStdString(job.m_tmpPath);
+  const QString path    = QString::fromStdString(job.m_path);
+
+  QFile tmpFile(tmpPath);
+  if (!tmpFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    strError = "Unable to read serialized MDF.";
+    return VSCP_ERROR_READ_ERROR;
+  }
+  QByteArray content = tmpFile.readAll();
+  tmpFile.close();
+  QFile::remove(tmpPath);
+
+  // Post process. The library serialized the MDF without the decision
+  // matrix so for JSON the tree is parsed and dumped a second time.
+  if (MDF_FORMAT_JSON == job.m_format) {
+    json root;
+    try {
+      root = json::parse(content.constData(), content.constData() + content.size());
+    }
+    catch (const std::exception& ex) {
+      strError = std::string("Serialized JSON is invalid: ") + ex.what();
+      return VSCP_ERROR_PARSING;
+    }
+
+    if (!root.contains("module") || !root["module"].is_object()) {
+      strError = "Serialized JSON is missing the 'module' object.";
+      return VSCP_ERROR_PARSING;
+    }
+
+    json& module = root["module"];
+    if (job.m_bDm) {
+      module["dmatrix"] = job.m_dm;
+    }
+    else {
+      module.erase("dmatrix");
+    }
+
+    normalizeJsonDateFields(root);
+    content = QByteArray::fromStdString(root.dump(2));
+  }
+  else {
+    content = normalizeXmlDateFields(QString::fromUtf8(content)).toUtf8();
+  }
+
+  int rv = backup(job, strError);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    return rv;
+  }
+
+  // Written to a temporary file that is renamed to the target on commit
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    strError = "Unable to open file for write.";
+    return VSCP_ERROR_WRITE_ERROR;
+  }
+
+  if ((content.size() != file.write(content)) || !file.commit()) {
+    strError = "Unable to write file.";
+    return VSCP_ERROR_WRITE_ERROR;
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// backup
+//
+
+int
+CMdfSaver::backup(const savejob& job, std::string& strError)
+{
+  const QString path = QString::fromStdString(job.m_path);
+
+  if (!QFile::exists(path)) {
+    return VSCP_ERROR_SUCCESS;
+  }
+
+  if (!job.m_bCumulative) {
+    const QString backupPath = path + ".bak";
+    if (QFile::exists(backupPath) && !QFile::remove(backupPath)) {
+      strError = "Unable to remove existing backup " + backupPath.toStdString();
+      return VSCP_ERROR_WRITE_ERROR;
+    }
+
+    if (!QFile::copy(path, backupPath)) {
+      strError = "Unable to copy current file to backup " + backupPath.toStdString();
+      return VSCP_ERROR_WRITE_ERROR;
+    }
+
+    return VSCP_ERROR_SUCCESS;
+  }
+
+  QFileInfo fi(path);
+  const QString backupPath = QString("%1/%2.bak.%3")
+                               .arg(fi.absolutePath(),
+                                    fi.fileName(),
+                                    QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz"));
+
+  if (!QFile::copy(path, backupPath)) {
+    strError = "Unable to copy current file to cumulative backup " + backupPath.toStdString();
+    return VSCP_ERROR_WRITE_ERROR;
+  }
+
+  if (job.m_maxBackups > 0) {
+    QDir dir(fi.absolutePath());
+    const QStringList entries = dir.entryList(QStringList() << QString("%1.bak.*").arg(fi.fileName()),
+                                              QDir::Files,
+                                              QDir::Name);
+    const int removeCount = entries.size() - static_cast<int>(job.m_maxBackups);
+    for (int i = 0; i < removeCount; ++i) {
+      dir.remove(entries.at(i));
+    }
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+int
+CMdfSaver::start(const savejob& job, donecallback cbDone)
+{
+  if (m_bRunning) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  // Join a previous save
+  wait();
+
+  m_bRunning = true;
+  m_thread   = std::thread(&CMdfSaver::worker, this, job, cbDone);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// wait
+//
+
+void
+CMdfSaver::wait(void)
+{
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// worker
+//
+
+void
+CMdfSaver::worker(savejob job, donecallback cbDone)
+{
+  std::string strError;
+  int rv = finish(job, strError);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    spdlog::error("MDF save: Failed to save {0}: {1}", job.m_path, strError);
+  }
+
+  m_bRunning = false;
+
+  if (nullptr != cbDone) {
+    cbDone(job, rv, strError);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// makeDecisionMatrixJson
+//
+
+json
+CMdfSaver::makeDecisionMatrixJson(CMDF_DecisionMatrix* pdm)
+{
+  json jdm;
+
+  if (nullptr == pdm) {
+    return jdm;
+  }
+
+  jdm["level"]        = pdm->getLevel();
+  jdm["start-page"]   = pdm->getStartPage();
+  jdm["start-offset"] = pdm->getStartOffset();
+  jdm["rowcnt"]       = pdm->getRowCount();
+  jdm["rowsize"]      = pdm->getRowSize();
+
+  json actions = json::array();
+  std::deque<CMDF_Action*>* pActionList = pdm->getActionList();
+  if (nullptr != pActionList) {
+    for (CMDF_Action* pAction : *pActionList) {
+      if (nullptr == pAction) {
+        continue;
+      }
+
+      json jaction;
+      jaction["name"] = pAction->getName();
+      jaction["code"] = pAction->getCode();
+
+      json params = json::array();
+      std::deque<CMDF_ActionParameter*>* pParams = pAction->getListActionParameter();
+      if (nullptr != pParams) {
+        for (CMDF_ActionParameter* pParam : *pParams) {
+          if (nullptr == pParam) {
+            continue;
+          }
+
+          json jparam;
+          jparam["name"]   = pParam->getName();
+          jparam["offset"] = pParam->getOffset();
+          jparam["min"]    = pParam->getMin();
+          jparam["max"]    = pParam->getMax();
+
+          json bits = json::array();
+          std::deque<CMDF_Bit*>* pBits = pParam->getListBits();
+          if (nullptr != pBits) {
+            for (CMDF_Bit* pBit : *pBits) {
+              if (nullptr == pBit) {
+                continue;
+              }
+              json jbit;
+              jbit["name"]    = pBit->getName();
+              jbit["pos"]     = pBit->getPos();
+              jbit["width"]   = pBit->getWidth();
+              jbit["default"] = pBit->getDefault();
+              jbit["min"]     = pBit->getMin();
+              jbit["max"]     = pBit->getMax();
+
+              std::string access;
+              if (2 & pBit->getAccess()) {
+                access += "r";
+              }
+              if (1 & pBit->getAccess()) {
+                access += "w";
+              }
+              jbit["access"] = access;
+              bits.push_back(jbit);
+            }
+          }
+          if (!bits.empty()) {
+            jparam["bit"] = bits;
+          }
+
+          json values = json::array();
+          std::deque<CMDF_Value*>* pValues = pParam->getListValues();
+          if (nullptr != pValues) {
+            for (CMDF_Value* pValue : *pValues) {
+              if (nullptr == pValue) {
+                continue;
+              }
+              json jvalue;
+              jvalue["name"]  = pValue->getName();
+              jvalue["value"] = pValue->getValue();
+              values.push_back(jvalue);
+            }
+          }
+          if (!values.empty()) {
+            jparam["valuelist"] = values;
+          }
+
+          params.push_back(jparam);
+        }
+      }
+
+      if (!params.empty()) {
+        jaction["param"] = params;
+      }
+
+      actions.push_back(jaction);
+    }
+  }
+
+  jdm["action"] = actions;
+
+  return jdm;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// normalizeDateString
+//
+
+QString
+CMdfSaver::normalizeDateString(const QString& sourceValue)
+{
+  const QString source = sourceValue.trimmed();
+  if (source.isEmpty()) {
+    return source;
+  }
+
+  QDate date = QDate::fromString(source, Qt::ISODate);
+  if (date.isValid()) {
+    return date.toString(Qt::ISODate);
+  }
+
+  const QStringList formats = { "yyyy-MM-dd",
+                                "yy-MM-dd",
+                                "dd/MM/yyyy",
+                                "d/M/yyyy",
+                                "dd/MM/yy",
+                                "d/M/yy",
+                                "MM/dd/yyyy",
+                                "M/d/yyyy",
+                                "MM/dd/yy",
+                                "M/d/yy" };
+
+  for (const auto& fmt : formats) {
+    date = QDate::fromString(source, fmt);
+    if (date.isValid()) {
+      return date.toString(Qt::ISODate);
+    }
+  }
+
+  return source;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// normalizeJsonDateFields
+//
+
+void
+CMdfSaver::normalizeJsonDateFields(json& node)
+{
+  if (node.is_object()) {
+    for (auto& item : node.items()) {
+      if (item.value().is_string()) {
+        const std::string& key = item.key();
+        if (("date" == key) || ("changed" == key)) {
+          const QString normalized = normalizeDateString(QString::fromStdString(item.value().get<std::string>()));
+          item.value()             = normalized.toStdString();
+        }
+      }
+
+      normalizeJsonDateFields(item.value());
+    }
+  }
+  else if (node.is_array()) {
+    for (auto& item : node) {
+      normalizeJsonDateFields(item);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// normalizeXmlDateFields
+//
+
+QString
+CMdfSaver::normalizeXmlDateFields(const QString& content)
+{
+  QString updatedContent = content;
+  int delta              = 0;
+  const QRegularExpression attrDateRe(R"re(date\s*=\s*"([^"]*)")re");
+  auto attrIt = attrDateRe.globalMatch(content);
+  while (attrIt.hasNext()) {
+    const QRegularExpressionMatch match = attrIt.next();
+    const QString current               = match.captured(1);
+    const QString normalized            = normalizeDateString(current);
+    if (current == normalized) {
+      continue;
+    }
+
+    const int start = match.capturedStart(1) + delta;
+    updatedContent.replace(start, current.length(), normalized);
+    delta += normalized.length() - current.length();
+  }
+
+  const QString attrContent = updatedContent;
+  delta                     = 0;
+  const QRegularExpression changedDateRe(R"(<changed>\s*([^<]*)\s*</changed>)");
+  auto changedIt = changedDateRe.globalMatch(attrContent);
+  while (changedIt.hasNext()) {
+    const QRegularExpressionMatch match = changedIt.next();
+    const QString current               = match.captured(1).trimmed();
+    const QString normalized            = normalizeDateString(current);
+    if (current == normalized) {
+      continue;
+    }
+
+    const int start = match.capturedStart(1) + delta;
+    const int len   = match.capturedLength(1);
+    updatedContent.replace(start, len, normalized);
+    delta += normalized.length() - len;
+  }
+
+  return updatedContent;
+}
@@ -0,0 +1,177 @@
+// mdfsaver.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MDFSAVER_H
+#define MDFSAVER_H
+
+#include <mdf.h>
+
+#include <nlohmann/json.hpp>
+// https://github.com/nlohmann/json
+using json = nlohmann::json;
+
+#include <QString>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+/*!
+  Save pipeline for the MDF editor.
+
+  A save is done in two steps. prepare() runs on the thread that owns
+  the MDF and lets the MDF library serialize the model to a temporary
+  file next to the target. It also copies the decision matrix, which
+  the library does not write for JSON, into the job. After that the job
+  no longer depends on the MDF object and the editor can continue.
+
+  finish() reads the serialized file back. For JSON it is parsed, the
+  decision matrix is merged in and the tree is dumped again. The MDF
+  library has no way to add the decision matrix while it serializes, so
+  this second pass is needed. It is done off the GUI thread. Date fields
+  are normalized in the same pass. A backup of the previous file is made
+  and pruned. The result is then written to the target through a
+  temporary file that is renamed in place, so a crash or a full disk
+  never leaves a half written MDF. finish() can run on a worker thread
+  with start().
+*/
+
+class CMdfSaver {
+
+public:
+  /// Extension for the serialized file made by prepare()
+  static const char* TMP_EXTENSION;
+
+  /*!
+    Everything needed to finish a save
+  */
+  struct savejob {
+    std::string m_path;     // Path to save MDF to
+    std::string m_tmpPath;  // Serialized MDF made by prepare()
+    mdf_format m_format;    // Format of MDF
+    bool m_bDm;             // True if m_dm holds a decision matrix
+    json m_dm;              // Decision matrix (JSON only)
+    bool m_bCumulative;     // Keep time stamped backups
+    uint32_t m_maxBackups;  // Max number of time stamped backups (0 = no limit)
+    uint32_t m_changeCount; // Editor change count when the job was made
+  };
+
+  /// Called when a save started with start() is done (job, result code, error message)
+  typedef std::function<void(const savejob&, int, const std::string&)> donecallback;
+
+  CMdfSaver();
+  ~CMdfSaver();
+
+  /*!
+    Serialize an MDF to a temporary file and set up a save job.
+    Must be called on the thread that owns the MDF.
+    @param mdf MDF to save
+    @param path Path to save MDF to
+    @param format Format to save MDF in
+    @param job Save job that is filled in
+    @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_WRITE_ERROR if
+            the MDF could not be serialized.
+  */
+  static int prepare(CMDF& mdf, const std::string& path, mdf_format format, savejob& job);
+
+  /*!
+    Post process the serialized MDF, make a backup of the current
+    file and replace it atomically. The temporary file is always
+    removed.
+    @param job Save job from prepare()
+    @param strError Set to a description of the problem on failure
+    @return VSCP_ERROR_SUCCESS on success
+  */
+  static int finish(const savejob& job, std::string& strError);
+
+  /*!
+    Run finish() on a worker thread
+    @param job Save job from prepare()
+    @param cbDone Called from the worker thread when done
+    @return VSCP_ERROR_SUCCESS if started, VSCP_ERROR_ERROR if a save
+            is already running.
+  */
+  int start(const savejob& job, donecallback cbDone);
+
+  /*!
+    Wait for a running save to end
+  */
+  void wait(void);
+
+  /*!
+    Check if a save is running
+    @return True if running
+  */
+  bool isRunning(void) const { return m_bRunning; };
+
+  /*!
+    Make the JSON MDF representation of a decision matrix
+    @param pdm Pointer to decision matrix
+    @return JSON object for decision matrix
+  */
+  static json makeDecisionMatrixJson(CMDF_DecisionMatrix* pdm);
+
+  /*!
+    Normalize a date to ISO format (YYYY-MM-DD) if it can be parsed
+    @param sourceValue Date to normalize
+    @return Normalized date or the trimmed source if not a known format
+  */
+  static QString normalizeDateString(const QString& sourceValue);
+
+  /*!
+    Normalize all "date" and "changed" fields in a JSON tree
+    @param node JSON node to start at
+  */
+  static void normalizeJsonDateFields(json& node);
+
+  /*!
+    Normalize all date attributes and <changed> elements in XML
+    @param content XML MDF
+    @return XML MDF with normalized dates
+  */
+  static QString normalizeXmlDateFields(const QString& content);
+
+private:
+  /*!
+    Make a backup of the current file for a job
+    @param job Save job
+    @param strError Set to a description of the problem on failure
+    @return VSCP_ERROR_SUCCESS on success
+  */
+  static int backup(const savejob& job, std::string& strError);
+
+  /// Worker thread
+  void worker(savejob job, donecallback cbDone);
+
+  std::thread m_thread;
+  std::atomic<bool> m_bRunning;
+};
+
+#endif // MDFSAVER_H
@@ -0,0 +1,252 @@
+// mdfsearchindex.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscphelper.h>
+
+#include "mdfsearchindex.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <set>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMdfSearchIndex::CMdfSearchIndex()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMdfSearchIndex::~CMdfSearchIndex()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clear
+//
+
+void
+CMdfSearchIndex::clear(void)
+{
+  m_entries.clear();
+  m_words.clear();
+  m_trigrams.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// toLower
+//
+
+std::string
+CMdfSearchIndex::toLower(const std::string& str)
+{
+  std::string rv(str);
+  std::transform(rv.begin(), rv.end(), rv.begin(), [](unsigned char c) { return (char)tolower(c); });
+  return rv;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// makePosition
+//
+
+std::string
+CMdfSearchIndex::makePosition(uint16_t page, uint32_t offset)
+{
+  return vscp_str_format("%u:%lu", (unsigned)page, (unsigned long)offset);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// addEntry
+//
+
+uint32_t
+CMdfSearchIndex::addEntry(entrykind kind,
+                          uint16_t page,
+                          uint32_t offset,
+                          const std::string& label,
+                          QTreeWidgetItem* pitem,
+                          const std::vector<std::string>& fields)
+{
+  uint32_t idx = (uint32_t)m_entries.size();
+
+  entry e;
+  e.m_kind   = kind;
+  e.m_page   = page;
+  e.m_offset = offset;
+  e.m_label  = label;
+  e.m_pitem  = pitem;
+  e.m_name   = toLower(label);
+
+  // Position is always the first field
+  std::string pos = makePosition(page, offset);
+  e.m_text        = pos;
+  m_words.push_back(std::make_pair(pos, idx));
+
+  for (auto const& field : fields) {
+    if (field.empty()) {
+      continue;
+    }
+
+    std::string lower = toLower(field);
+    e.m_text += '\n';
+    e.m_text += lower;
+
+    // The whole field so that "zone s" finds "zone setup"
+    m_words.push_back(std::make_pair(lower, idx));
+
+    // And every word in it
+    size_t start = std::string::npos;
+    for (size_t i = 0; i <= lower.size(); i++) {
+      bool bWord = (i < lower.size()) && (isalnum((unsigned char)lower[i]) || ('_' == lower[i]));
+      if (bWord && (std::string::npos == start)) {
+        start = i;
+      }
+      else if (!bWord && (std::string::npos != start)) {
+        if (start > 0) { // First word is covered by the whole field
+          m_words.push_back(std::make_pair(lower.substr(start, i - start), idx));
+        }
+        start = std::string::npos;
+      }
+    }
+  }
+
+  m_entries.push_back(e);
+  return idx;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// build
+//
+
+void
+CMdfSearchIndex::build(void)
+{
+  std::sort(m_words.begin(), m_words.end());
+  m_words.erase(std::unique(m_words.begin(), m_words.end()), m_words.end());
+
+  m_trigrams.clear();
+  for (uint32_t idx = 0; idx < m_entries.size(); idx++) {
+    const std::string& text = m_entries[idx].m_text;
+    for (size_t i = 0; i + 3 <= text.size(); i++) {
+      std::vector<uint32_t>& list = m_trigrams[trigram(text.data() + i)];
+      // Entries are added in order so a duplicate can only be last
+      if (list.empty() || (list.back() != idx)) {
+        list.push_back(idx);
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// find
+//
+
+size_t
+CMdfSearchIndex::find(const std::string& query,
+                      matchmode mode,
+                      entrykind kind,
+                      std::vector<uint32_t>& results,
+                      size_t maxResults) const
+{
+  results.clear();
+
+  std::string q = toLower(query);
+  vscp_trim(q);
+  if (q.empty()) {
+    return 0;
+  }
+
+  std::set<uint32_t> found;
+
+  // page:offset
+  size_t colon = q.find(':');
+  if ((matchmode::NAME != mode) && (std::string::npos != colon) && (q.find(':', colon + 1) == std::string::npos) &&
+      colon && (colon < q.size() - 1) && isdigit((unsigned char)q[0]) && isdigit((unsigned char)q[colon + 1])) {
+    std::string pos = makePosition((uint16_t)vscp_readStringValue(q.substr(0, colon)),
+                                   vscp_readStringValue(q.substr(colon + 1)));
+    auto it         = std::lower_bound(m_words.begin(), m_words.end(), std::make_pair(pos, (uint32_t)0));
+    for (; (it != m_words.end()) && (it->first == pos); ++it) {
+      found.insert(it->second);
+    }
+  }
+  else if (matchmode::PREFIX == mode) {
+    auto it = std::lower_bound(m_words.begin(), m_words.end(), std::make_pair(q, (uint32_t)0));
+    for (; (it != m_words.end()) && (0 == it->first.compare(0, q.size(), q)); ++it) {
+      found.insert(it->second);
+    }
+  }
+  else if (q.size() < 3) {
+    // Too short for the trigram index, entries are short so just scan
+    for (uint32_t idx = 0; idx < m_entries.size(); idx++) {
+      if (std::string::npos != matchText(m_entries[idx], mode).find(q)) {
+        found.insert(idx);
+      }
+    }
+  }
+  else {
+    // Start with the rarest trigram and verify candidates
+    const std::vector<uint32_t>* pshortest = nullptr;
+    for (size_t i = 0; i + 3 <= q.size(); i++) {
+      auto it = m_trigrams.find(trigram(q.data() + i));
+      if (it == m_trigrams.end()) {
+        return 0;
+      }
+      if ((nullptr == pshortest) || (it->second.size() < pshortest->size())) {
+        pshortest = &it->second;
+      }
+    }
+    // The name is part of the text so its candidates are found too
+    for (auto idx : *pshortest) {
+      if (std::string::npos != matchText(m_entries[idx], mode).find(q)) {
+        found.insert(idx);
+      }
+    }
+  }
+
+  for (auto idx : found) {
+    if (m_entries[idx].m_kind != kind) {
+      continue;
+    }
+    results.push_back(idx);
+    if (maxResults && (results.size() >= maxResults)) {
+      break;
+    }
+  }
+
+  return results.size();
+}
@@ -0,0 +1,167 @@
+// mdfsearchindex.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef MDFSEARCHINDEX_H
+#define MDFSEARCHINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class QTreeWidgetItem;
+
+/*!
+  Search index over the registers and remote variables rendered from
+  an MDF.
+
+  The index is built once when the MDF is rendered. Every entry holds
+  the searchable text for one tree item (name, description, bit and
+  value names and its page:offset position). Words are kept in a sorted
+  list for prefix lookups and a trigram index narrows down substring
+  lookups so that a query does not have to look at every entry.
+*/
+
+class CMdfSearchIndex {
+
+public:
+  /// What an entry refers to
+  enum class entrykind { REGISTER = 0, REMOTEVAR };
+
+  /// How a query is matched (start of any word, anywhere in a field or anywhere in the name)
+  enum class matchmode { PREFIX = 0, SUBSTRING, NAME };
+
+  /// One searchable item
+  struct entry {
+    entrykind m_kind;
+    uint16_t m_page;
+    uint32_t m_offset;
+    std::string m_label;      // Text shown for the entry
+    QTreeWidgetItem* m_pitem; // Tree item the entry refers to
+    std::string m_text;       // Lowercase searchable text, fields separated by '\n'
+    std::string m_name;       // Lowercase label for name only searches
+  };
+
+  CMdfSearchIndex();
+  ~CMdfSearchIndex();
+
+  /*!
+    Remove all entries
+  */
+  void clear(void);
+
+  /*!
+    Add an entry
+    @param kind Kind of entry
+    @param page Register page
+    @param offset Register offset
+    @param label Text to show for the entry. This is what
+      matchmode::NAME searches so it should also be one of the fields.
+    @param pitem Tree item the entry refers to
+    @param fields Searchable texts (name, description, ...)
+    @return Index of the new entry
+  */
+  uint32_t addEntry(entrykind kind,
+                    uint16_t page,
+                    uint32_t offset,
+                    const std::string& label,
+                    QTreeWidgetItem* pitem,
+                    const std::vector<std::string>& fields);
+
+  /*!
+    Finalize the index after all entries are added. Must be called
+    before find().
+  */
+  void build(void);
+
+  /*!
+    Find entries matching a query. A query on the form page:offset
+    (decimal or hex) matches the register at that position.
+    @param query Text to search for (case insensitive)
+    @param mode Prefix of any word, substring of any field or substring
+      of the name. Positions are only looked up for the first two.
+    @param kind Kind of entries to return
+    @param results Filled with entry indexes in MDF order
+    @param maxResults Max number of results, zero for no limit
+    @return Number of results
+  */
+  size_t find(const std::string& query,
+              matchmode mode,
+              entrykind kind,
+              std::vector<uint32_t>& results,
+              size_t maxResults = 0) const;
+
+  /*!
+    Get an entry
+    @param idx Index of entry
+    @return Reference to entry
+  */
+  const entry& getEntry(uint32_t idx) const { return m_entries[idx]; };
+
+  /*!
+    Get number of entries
+    @return Number of entries
+  */
+  size_t getCount(void) const { return m_entries.size(); };
+
+  /*!
+    Make the searchable form of a page:offset position
+    @param page Register page
+    @param offset Register offset
+    @return Position string
+  */
+  static std::string makePosition(uint16_t page, uint32_t offset);
+
+private:
+  /// Lowercase a string (ASCII)
+  static std::string toLower(const std::string& str);
+
+  /// Text of an entry a substring query is matched against
+  static const std::string& matchText(const entry& e, matchmode mode)
+  {
+    return (matchmode::NAME == mode) ? e.m_name : e.m_text;
+  };
+
+  /// Pack three characters into a trigram key
+  static uint32_t trigram(const char* p)
+  {
+    return ((uint32_t)(uint8_t)p[0] << 16) | ((uint32_t)(uint8_t)p[1] << 8) | (uint8_t)p[2];
+  };
+
+  /// All entries in the order they were added
+  std::vector<entry> m_entries;
+
+  /// Sorted (word, entry) pairs for prefix lookups
+  std::vector<std::pair<std::string, uint32_t>> m_words;
+
+  /// Trigram to sorted list of entries containing it
+  std::unordered_map<uint32_t, std::vector<uint32_t>> m_trigrams;
+};
+
+#endif // MDFSEARCHINDEX_H
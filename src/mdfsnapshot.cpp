@@ -0,0 +1,1096 @@
+// mdfsnapshot.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "mdfsnapshot.h"
+
+#include <QFile>
+#include <QSaveFile>
+
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+// Identifies a snapshot file
+static const char SNAPSHOT_MAGIC[8] = { 'V', 'S', 'C', 'P', 'M', 'D', 'F', 'S' };
+
+const char* CMdfSnapshot::EXTENSION = ".snap";
+
+///////////////////////////////////////////////////////////////////////////////
+// writer
+//
+
+CMdfSnapshot::writer::writer()
+{
+  // Offset zero is the empty string
+  m_pool.assign(sizeof(uint32_t), '\0');
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writer::add
+//
+
+size_t
+CMdfSnapshot::writer::add(recordkind kind)
+{
+  snaprecord rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.m_kind = kind;
+  m_records.push_back(rec);
+  return m_records.size() - 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writer::setString
+//
+
+void
+CMdfSnapshot::writer::setString(size_t idx, int field, const std::string& str)
+{
+  if (str.empty()) {
+    m_records[idx].m_str[field] = 0;
+    return;
+  }
+
+  auto it = m_strings.find(str);
+  if (it != m_strings.end()) {
+    m_records[idx].m_str[field] = it->second;
+    return;
+  }
+
+  uint32_t offset = (uint32_t)m_pool.size();
+  uint32_t len    = (uint32_t)str.size();
+  m_pool.append((const char*)&len, sizeof(len));
+  m_pool.append(str);
+  m_strings[str]              = offset;
+  m_records[idx].m_str[field] = offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writer::addTexts
+//
+
+void
+CMdfSnapshot::writer::addTexts(size_t idx,
+                               std::map<std::string, std::string>* pdesc,
+                               std::map<std::string, std::string>* pinfo)
+{
+  std::map<std::string, std::string>* maps[] = { pdesc, pinfo };
+  for (int type = TEXT_DESCRIPTION; type <= TEXT_INFOURL; type++) {
+    if (nullptr == maps[type]) {
+      continue;
+    }
+    for (const auto& item : *maps[type]) {
+      size_t text = add(KIND_TEXT);
+      setNumber(text, 0, type);
+      setString(text, 0, item.first);
+      setString(text, 1, item.second);
+      m_records[idx].m_nText++;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reader
+//
+
+CMdfSnapshot::reader::reader(const snaprecord* precords, size_t count, const char* ppool, size_t poolSize)
+  : m_precords(precords)
+  , m_count(count)
+  , m_pos(0)
+  , m_ppool(ppool)
+  , m_poolSize(poolSize)
+  , m_bError(false)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reader::next
+//
+
+const CMdfSnapshot::snaprecord*
+CMdfSnapshot::reader::next(recordkind kind)
+{
+  if (m_bError || (m_pos >= m_count)) {
+    m_bError = true;
+    return nullptr;
+  }
+
+  const snaprecord* prec = m_precords + m_pos;
+  if ((0 != kind) && (kind != prec->m_kind)) {
+    m_bError = true;
+    return nullptr;
+  }
+
+  m_pos++;
+  return prec;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reader::getString
+//
+
+std::string
+CMdfSnapshot::reader::getString(const snaprecord* prec, int field)
+{
+  uint32_t offset = prec->m_str[field];
+  if (0 == offset) {
+    return std::string();
+  }
+
+  // Offset is resolved to a pointer into the mapped pool
+  uint32_t len;
+  if (((size_t)offset + sizeof(len)) > m_poolSize) {
+    m_bError = true;
+    return std::string();
+  }
+  memcpy(&len, m_ppool + offset, sizeof(len));
+  if (((size_t)offset + sizeof(len) + len) > m_poolSize) {
+    m_bError = true;
+    return std::string();
+  }
+
+  return std::string(m_ppool + offset + sizeof(len), len);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reader::readTexts
+//
+
+bool
+CMdfSnapshot::reader::readTexts(const snaprecord* prec,
+                                std::map<std::string, std::string>* pdesc,
+                                std::map<std::string, std::string>* pinfo)
+{
+  for (uint16_t i = 0; i < prec->m_nText; i++) {
+    const snaprecord* ptext = next(KIND_TEXT);
+    if (nullptr == ptext) {
+      return false;
+    }
+    std::map<std::string, std::string>* pmap = (TEXT_DESCRIPTION == ptext->m_num[0]) ? pdesc : pinfo;
+    if (nullptr != pmap) {
+      (*pmap)[getString(ptext, 0)] = getString(ptext, 1);
+    }
+  }
+
+  return !m_bError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writeBits
+//
+
+void
+CMdfSnapshot::writeBits(writer& w, size_t parent, std::deque<CMDF_Bit*>* plist, recordkind kind)
+{
+  if (nullptr == plist) {
+    return;
+  }
+
+  for (auto pbit : *plist) {
+    size_t idx = w.add(kind);
+    w.addChild(parent);
+    w.setString(idx, 0, pbit->getName());
+    w.setNumber(idx, 0, pbit->getPos());
+    w.setNumber(idx, 1, pbit->getWidth());
+    w.setNumber(idx, 2, pbit->getDefault());
+    w.setNumber(idx, 3, pbit->getMin());
+    w.setNumber(idx, 4, pbit->getMax());
+    w.setNumber(idx, 5, static_cast<uint32_t>(pbit->getAccess()));
+    w.addTexts(idx, pbit->getMapDescription(), pbit->getMapInfoUrl());
+    writeValues(w, idx, pbit->getListValues());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writeValues
+//
+
+void
+CMdfSnapshot::writeValues(writer& w, size_t parent, std::deque<CMDF_Value*>* plist)
+{
+  if (nullptr == plist) {
+    return;
+  }
+
+  for (auto pvalue : *plist) {
+    size_t idx = w.add(KIND_VALUE);
+    w.addChild(parent);
+    w.setString(idx, 0, pvalue->getName());
+    w.setString(idx, 1, pvalue->getValue());
+    w.addTexts(idx, pvalue->getMapDescription(), pvalue->getMapInfoUrl());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writeManufacturer
+//
+
+void
+CMdfSnapshot::writeManufacturer(writer& w, size_t parent, CMDF_Manufacturer* pmanufacturer)
+{
+  if (nullptr == pmanufacturer) {
+    return;
+  }
+
+  size_t idx = w.add(KIND_MANUFACTURER);
+  w.addChild(parent);
+  w.setString(idx, 0, pmanufacturer->getName());
+  w.addTexts(idx, pmanufacturer->getMapDescription(), pmanufacturer->getMapInfoUrl());
+
+  CMDF_Address* paddress = pmanufacturer->getAddressObj();
+  if (nullptr != paddress) {
+    size_t addr = w.add(KIND_ADDRESS);
+    w.addChild(idx);
+    w.setString(addr, 0, paddress->getStreet());
+    w.setString(addr, 1, paddress->getCity());
+    w.setString(addr, 2, paddress->getTown());
+    w.setString(addr, 3, paddress->getPostCode());
+    w.setString(addr, 4, paddress->getRegion());
+    w.setString(addr, 5, paddress->getState());
+    w.setString(addr, 6, paddress->getCountry());
+  }
+
+  writeContacts(w, idx, pmanufacturer->getPhoneContactList(), CONTACT_PHONE);
+  writeContacts(w, idx, pmanufacturer->getFaxContactList(), CONTACT_FAX);
+  writeContacts(w, idx, pmanufacturer->getEmailContactList(), CONTACT_EMAIL);
+  writeContacts(w, idx, pmanufacturer->getWebContactList(), CONTACT_WEB);
+  writeContacts(w, idx, pmanufacturer->getSocialContactList(), CONTACT_SOCIAL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writeContacts
+//
+
+void
+CMdfSnapshot::writeContacts(writer& w, size_t parent, std::deque<CMDF_Item*>* plist, contactkind type)
+{
+  if (nullptr == plist) {
+    return;
+  }
+
+  for (auto pitem : *plist) {
+    size_t idx = w.add(KIND_CONTACT);
+    w.addChild(parent);
+    w.setNumber(idx, 0, type);
+    w.setString(idx, 0, pitem->getValue());
+    w.addTexts(idx, pitem->getMapDescription(), pitem->getMapInfoUrl());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writeDM
+//
+
+void
+CMdfSnapshot::writeDM(writer& w, size_t parent, CMDF_DecisionMatrix* pdm)
+{
+  if (nullptr == pdm) {
+    return;
+  }
+
+  size_t idx = w.add(KIND_DM);
+  w.addChild(parent);
+  w.setNumber(idx, 0, pdm->getLevel());
+  w.setNumber(idx, 1, pdm->getStartPage());
+  w.setNumber(idx, 2, pdm->getStartOffset());
+  w.setNumber(idx, 3, pdm->getRowCount());
+  w.setNumber(idx, 4, pdm->getRowSize());
+
+  std::deque<CMDF_Action*>* pactions = pdm->getActionList();
+  if (nullptr == pactions) {
+    return;
+  }
+
+  for (auto paction : *pactions) {
+    size_t act = w.add(KIND_ACTION);
+    w.addChild(idx);
+    w.setString(act, 0, paction->getName());
+    w.setNumber(act, 0, paction->getCode());
+    w.addTexts(act, paction->getMapDescription(), paction->getMapInfoUrl());
+
+    std::deque<CMDF_ActionParameter*>* pparams = paction->getListActionParameter();
+    if (nullptr == pparams) {
+      continue;
+    }
+
+    for (auto pparam : *pparams) {
+      size_t par = w.add(KIND_ACTIONPARAM);
+      w.addChild(act);
+      w.setString(par, 0, pparam->getName());
+      w.setNumber(par, 0, pparam->getOffset());
+      w.setNumber(par, 1, pparam->getMin());
+      w.setNumber(par, 2, pparam->getMax());
+      w.addTexts(par, pparam->getMapDescription(), pparam->getMapInfoUrl());
+      writeBits(w, par, pparam->getListBits());
+      writeValues(w, par, pparam->getListValues());
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writeEvents
+//
+
+void
+CMdfSnapshot::writeEvents(writer& w, size_t parent, std::deque<CMDF_Event*>* plist)
+{
+  if (nullptr == plist) {
+    return;
+  }
+
+  for (auto pevent : *plist) {
+    size_t idx = w.add(KIND_EVENT);
+    w.addChild(parent);
+    w.setString(idx, 0, pevent->getName());
+    w.setNumber(idx, 0, pevent->getClass());
+    w.setNumber(idx, 1, pevent->getType());
+    w.setNumber(idx, 2, pevent->getPriority());
+    w.setNumber(idx, 3, static_cast<uint32_t>(pevent->getDirection()));
+    w.addTexts(idx, pevent->getMapDescription(), pevent->getMapInfoUrl());
+
+    std::deque<CMDF_EventData*>* pdatalist = pevent->getListEventData();
+    if (nullptr == pdatalist) {
+      continue;
+    }
+
+    for (auto pdata : *pdatalist) {
+      size_t data = w.add(KIND_EVENTDATA);
+      w.addChild(idx);
+      w.setString(data, 0, pdata->getName());
+      w.setNumber(data, 0, pdata->getOffset());
+      w.addTexts(data, pdata->getMapDescription(), pdata->getMapInfoUrl());
+      writeBits(w, data, pdata->getListBits());
+      writeValues(w, data, pdata->getListValues());
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writeFiles
+//
+
+void
+CMdfSnapshot::writeFiles(writer& w, size_t parent, CMDF& mdf)
+{
+  size_t idx;
+
+  for (auto pfile : *mdf.getPictureObjList()) {
+    idx = w.add(KIND_PICTURE);
+    w.addChild(parent);
+    w.setString(idx, 0, pfile->getName());
+    w.setString(idx, 1, pfile->getUrl());
+    w.setString(idx, 2, pfile->getFormat());
+    w.setString(idx, 3, pfile->getDate());
+    w.addTexts(idx, pfile->getMapDescription(), pfile->getMapInfoUrl());
+  }
+
+  for (auto pfile : *mdf.getVideoObjList()) {
+    idx = w.add(KIND_VIDEO);
+    w.addChild(parent);
+    w.setString(idx, 0, pfile->getName());
+    w.setString(idx, 1, pfile->getUrl());
+    w.setString(idx, 2, pfile->getFormat());
+    w.setString(idx, 3, pfile->getDate());
+    w.addTexts(idx, pfile->getMapDescription(), pfile->getMapInfoUrl());
+  }
+
+  for (auto pfile : *mdf.getManualObjList()) {
+    idx = w.add(KIND_MANUAL);
+    w.addChild(parent);
+    w.setString(idx, 0, pfile->getName());
+    w.setString(idx, 1, pfile->getUrl());
+    w.setString(idx, 2, pfile->getFormat());
+    w.setString(idx, 3, pfile->getDate());
+    w.setString(idx, 4, pfile->getLanguage());
+    w.addTexts(idx, pfile->getMapDescription(), pfile->getMapInfoUrl());
+  }
+
+  for (auto pfile : *mdf.getDriverObjList()) {
+    idx = w.add(KIND_DRIVER);
+    w.addChild(parent);
+    w.setString(idx, 0, pfile->getName());
+    w.setString(idx, 1, pfile->getUrl());
+    w.setString(idx, 2, pfile->getType());
+    w.setString(idx, 3, pfile->getOS());
+    w.setString(idx, 4, pfile->getOSVer());
+    w.setString(idx, 5, pfile->getArchitecture());
+    w.setString(idx, 6, pfile->getDate());
+    w.setString(idx, 7, pfile->getVersion());
+    w.addTexts(idx, pfile->getMapDescription(), pfile->getMapInfoUrl());
+  }
+
+  for (auto pfile : *mdf.getSetupObjList()) {
+    idx = w.add(KIND_SETUP);
+    w.addChild(parent);
+    w.setString(idx, 0, pfile->getName());
+    w.setString(idx, 1, pfile->getUrl());
+    w.setString(idx, 2, pfile->getFormat());
+    w.setString(idx, 3, pfile->getDate());
+    w.addTexts(idx, pfile->getMapDescription(), pfile->getMapInfoUrl());
+  }
+
+  for (auto pfile : *mdf.getFirmwareObjList()) {
+    idx = w.add(KIND_FIRMWARE);
+    w.addChild(parent);
+    w.setString(idx, 0, pfile->getName());
+    w.setString(idx, 1, pfile->getUrl());
+    w.setString(idx, 2, pfile->getTarget());
+    w.setString(idx, 3, pfile->getFormat());
+    w.setString(idx, 4, pfile->getDate());
+    w.setString(idx, 5, pfile->getVersion());
+    w.setNumber(idx, 0, pfile->getTargetCode());
+    w.setNumber(idx, 1, (uint32_t)pfile->getSize());
+    w.addTexts(idx, pfile->getMapDescription(), pfile->getMapInfoUrl());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// save
+//
+
+int
+CMdfSnapshot::save(CMDF& mdf, const std::string& path, const std::string& sourceHash)
+{
+  if (64 != sourceHash.size()) {
+    return VSCP_ERROR_PARAMETER;
+  }
+
+  writer w;
+
+  size_t mod = w.add(KIND_MODULE);
+  w.setString(mod, 0, mdf.getModuleName());
+  w.setString(mod, 1, mdf.getModuleModel());
+  w.setString(mod, 2, mdf.getModuleVersion());
+  w.setString(mod, 3, mdf.getModuleChangeDate());
+  w.setString(mod, 4, mdf.getModuleCopyright());
+  w.setNumber(mod, 0, mdf.getModuleLevel());
+  w.setNumber(mod, 1, mdf.getModuleBufferSize());
+  w.addTexts(mod, mdf.getMapDescription(), mdf.getMapInfoUrl());
+
+  writeManufacturer(w, mod, mdf.getManufacturer());
+
+  for (auto preg : *mdf.getRegisterObjList()) {
+    size_t idx = w.add(KIND_REGISTER);
+    w.addChild(mod);
+    w.setString(idx, 0, preg->getName());
+    w.setString(idx, 1, preg->getDefault());
+    w.setNumber(idx, 0, preg->getPage());
+    w.setNumber(idx, 1, preg->getOffset());
+    w.setNumber(idx, 2, preg->getSpan());
+    w.setNumber(idx, 3, preg->getWidth());
+    w.setNumber(idx, 4, static_cast<uint32_t>(preg->getType()));
+    w.setNumber(idx, 5, static_cast<uint32_t>(preg->getAccess()));
+    w.setNumber(idx, 6, preg->getMin());
+    w.setNumber(idx, 7, preg->getMax());
+    w.setNumber(idx, 8, preg->getForegroundColor());
+    w.setNumber(idx, 9, preg->getBackgroundColor());
+    w.addTexts(idx, preg->getMapDescription(), preg->getMapInfoUrl());
+    writeBits(w, idx, preg->getListBits());
+    writeValues(w, idx, preg->getListValues());
+  }
+
+  for (auto pvar : *mdf.getRemoteVariableList()) {
+    size_t idx = w.add(KIND_REMOTEVAR);
+    w.addChild(mod);
+    w.setString(idx, 0, pvar->getName());
+    w.setString(idx, 1, pvar->getDefault());
+    w.setNumber(idx, 0, pvar->getPage());
+    w.setNumber(idx, 1, pvar->getOffset());
+    w.setNumber(idx, 2, pvar->getBitPos());
+    w.setNumber(idx, 3, static_cast<uint32_t>(pvar->getType()));
+    w.setNumber(idx, 4, static_cast<uint32_t>(pvar->getAccess()));
+    w.setNumber(idx, 5, pvar->getForegroundColor());
+    w.setNumber(idx, 6, pvar->getBackgroundColor());
+    w.addTexts(idx, pvar->getMapDescription(), pvar->getMapInfoUrl());
+    writeBits(w, idx, pvar->getListBits());
+    writeValues(w, idx, pvar->getListValues());
+  }
+
+  writeBits(w, mod, mdf.getAlarmList(), KIND_ALARM);
+  writeDM(w, mod, mdf.getDM());
+  writeEvents(w, mod, mdf.getEventList());
+
+  CMDF_BootLoaderInfo* pboot = mdf.getBootLoaderObj();
+  if (nullptr != pboot) {
+    size_t idx = w.add(KIND_BOOT);
+    w.addChild(mod);
+    w.setNumber(idx, 0, pboot->getAlgorithm());
+    w.setNumber(idx, 1, pboot->getBlockSize());
+    w.setNumber(idx, 2, pboot->getBlockCount());
+  }
+
+  writeFiles(w, mod, mdf);
+
+  // Header, records and string pool in host byte order. The snapshot is
+  // a local cache and is never moved between machines.
+  snapheader hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.m_magic, SNAPSHOT_MAGIC, sizeof(hdr.m_magic));
+  hdr.m_version      = VERSION;
+  hdr.m_headerSize   = sizeof(snapheader);
+  hdr.m_recordSize   = sizeof(snaprecord);
+  hdr.m_recordCount  = (uint32_t)w.m_records.size();
+  hdr.m_recordOffset = sizeof(snapheader);
+  hdr.m_stringOffset = hdr.m_recordOffset + hdr.m_recordCount * sizeof(snaprecord);
+  hdr.m_stringSize   = (uint32_t)w.m_pool.size();
+  memcpy(hdr.m_sourceHash, sourceHash.data(), sizeof(hdr.m_sourceHash));
+
+  // Written to a temporary file that replaces the old one on commit so a
+  // reader never sees a half written snapshot
+  QSaveFile file(QString::fromStdString(path));
+  if (!file.open(QIODevice::WriteOnly)) {
+    spdlog::error("MDF snapshot: Failed to create {0}", path);
+    return VSCP_ERROR_ERROR;
+  }
+
+  file.write((const char*)&hdr, sizeof(hdr));
+  for (const auto& rec : w.m_records) {
+    file.write((const char*)&rec, sizeof(rec));
+  }
+  file.write(w.m_pool.data(), w.m_pool.size());
+
+  if (!file.commit()) {
+    spdlog::error("MDF snapshot: Failed to write {0}", path);
+    return VSCP_ERROR_ERROR;
+  }
+
+  spdlog::debug("MDF snapshot: Wrote {0} records, {1} bytes of strings to {2}",
+                hdr.m_recordCount,
+                hdr.m_stringSize,
+                path);
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readBits
+//
+
+bool
+CMdfSnapshot::readBits(reader& r, const snaprecord* prec, std::deque<CMDF_Bit*>* pbits, std::deque<CMDF_Value*>* pvalues)
+{
+  for (uint32_t i = 0; i < prec->m_nChild; i++) {
+    const snaprecord* pchild = r.next((recordkind)0);
+    if (nullptr == pchild) {
+      return false;
+    }
+
+    if ((KIND_BIT == pchild->m_kind) && (nullptr != pbits)) {
+      CMDF_Bit* pbit = new CMDF_Bit();
+      pbits->push_back(pbit);
+      if (!readBit(r, pchild, pbit)) {
+        return false;
+      }
+    }
+    else if ((KIND_VALUE == pchild->m_kind) && (nullptr != pvalues)) {
+      CMDF_Value* pvalue = new CMDF_Value();
+      pvalues->push_back(pvalue);
+      if (!readValue(r, pchild, pvalue)) {
+        return false;
+      }
+    }
+    else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readBit
+//
+
+bool
+CMdfSnapshot::readBit(reader& r, const snaprecord* prec, CMDF_Bit* pbit)
+{
+  pbit->setName(r.getString(prec, 0));
+  pbit->setPos(prec->m_num[0]);
+  pbit->setWidth(prec->m_num[1]);
+  pbit->setDefault(prec->m_num[2]);
+  pbit->setMin(prec->m_num[3]);
+  pbit->setMax(prec->m_num[4]);
+  pbit->setAccess(static_cast<mdf_access_mode>(prec->m_num[5]));
+
+  if (!r.readTexts(prec, pbit->getMapDescription(), pbit->getMapInfoUrl())) {
+    return false;
+  }
+
+  return readBits(r, prec, nullptr, pbit->getListValues());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readValue
+//
+
+bool
+CMdfSnapshot::readValue(reader& r, const snaprecord* prec, CMDF_Value* pvalue)
+{
+  pvalue->setName(r.getString(prec, 0));
+  pvalue->setValue(r.getString(prec, 1));
+
+  return (0 == prec->m_nChild) && r.readTexts(prec, pvalue->getMapDescription(), pvalue->getMapInfoUrl());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readManufacturer
+//
+
+bool
+CMdfSnapshot::readManufacturer(reader& r, const snaprecord* prec, CMDF_Manufacturer* pmanufacturer)
+{
+  pmanufacturer->setName(r.getString(prec, 0));
+  if (!r.readTexts(prec, pmanufacturer->getMapDescription(), pmanufacturer->getMapInfoUrl())) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < prec->m_nChild; i++) {
+    const snaprecord* pchild = r.next((recordkind)0);
+    if (nullptr == pchild) {
+      return false;
+    }
+
+    if (KIND_ADDRESS == pchild->m_kind) {
+      CMDF_Address* paddress = pmanufacturer->getAddressObj();
+      paddress->setStreet(r.getString(pchild, 0));
+      paddress->setCity(r.getString(pchild, 1));
+      paddress->setTown(r.getString(pchild, 2));
+      paddress->setPostCode(r.getString(pchild, 3));
+      paddress->setRegion(r.getString(pchild, 4));
+      paddress->setState(r.getString(pchild, 5));
+      paddress->setCountry(r.getString(pchild, 6));
+    }
+    else if (KIND_CONTACT == pchild->m_kind) {
+      std::deque<CMDF_Item*>* plist;
+      switch (pchild->m_num[0]) {
+        case CONTACT_PHONE:
+          plist = pmanufacturer->getPhoneContactList();
+          break;
+        case CONTACT_FAX:
+          plist = pmanufacturer->getFaxContactList();
+          break;
+        case CONTACT_EMAIL:
+          plist = pmanufacturer->getEmailContactList();
+          break;
+        case CONTACT_WEB:
+          plist = pmanufacturer->getWebContactList();
+          break;
+        case CONTACT_SOCIAL:
+          plist = pmanufacturer->getSocialContactList();
+          break;
+        default:
+          return false;
+      }
+
+      CMDF_Item* pitem = new CMDF_Item();
+      plist->push_back(pitem);
+      pitem->setValue(r.getString(pchild, 0));
+      if (!r.readTexts(pchild, pitem->getMapDescription(), pitem->getMapInfoUrl())) {
+        return false;
+      }
+    }
+    else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readRegister
+//
+
+bool
+CMdfSnapshot::readRegister(reader& r, const snaprecord* prec, CMDF_Register* preg)
+{
+  preg->setName(r.getString(prec, 0));
+  preg->setDefault(r.getString(prec, 1));
+  preg->setPage(prec->m_num[0]);
+  preg->setOffset(prec->m_num[1]);
+  preg->setSpan(prec->m_num[2]);
+  preg->setWidth(prec->m_num[3]);
+  preg->setType(static_cast<mdf_register_type>(prec->m_num[4]));
+  preg->setAccess(static_cast<mdf_access_mode>(prec->m_num[5]));
+  preg->setMin(prec->m_num[6]);
+  preg->setMax(prec->m_num[7]);
+  preg->setForegroundColor(prec->m_num[8]);
+  preg->setBackgroundColor(prec->m_num[9]);
+
+  if (!r.readTexts(prec, preg->getMapDescription(), preg->getMapInfoUrl())) {
+    return false;
+  }
+
+  return readBits(r, prec, preg->getListBits(), preg->getListValues());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readRemoteVariable
+//
+
+bool
+CMdfSnapshot::readRemoteVariable(reader& r, const snaprecord* prec, CMDF_RemoteVariable* pvar)
+{
+  pvar->setName(r.getString(prec, 0));
+  pvar->setDefault(r.getString(prec, 1));
+  pvar->setPage(prec->m_num[0]);
+  pvar->setOffset(prec->m_num[1]);
+  pvar->setBitPos(prec->m_num[2]);
+  pvar->setType(static_cast<vscp_remote_variable_type>(prec->m_num[3]));
+  pvar->setAccess(static_cast<mdf_access_mode>(prec->m_num[4]));
+  pvar->setForegroundColor(prec->m_num[5]);
+  pvar->setBackgroundColor(prec->m_num[6]);
+
+  if (!r.readTexts(prec, pvar->getMapDescription(), pvar->getMapInfoUrl())) {
+    return false;
+  }
+
+  return readBits(r, prec, pvar->getListBits(), pvar->getListValues());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readDM
+//
+
+bool
+CMdfSnapshot::readDM(reader& r, const snaprecord* prec, CMDF_DecisionMatrix* pdm)
+{
+  pdm->setLevel(prec->m_num[0]);
+  pdm->setStartPage(prec->m_num[1]);
+  pdm->setStartOffset(prec->m_num[2]);
+  pdm->setRowCount(prec->m_num[3]);
+  pdm->setRowSize(prec->m_num[4]);
+
+  for (uint32_t i = 0; i < prec->m_nChild; i++) {
+    const snaprecord* pact = r.next(KIND_ACTION);
+    if (nullptr == pact) {
+      return false;
+    }
+
+    CMDF_Action* paction = new CMDF_Action();
+    pdm->getActionList()->push_back(paction);
+    paction->setName(r.getString(pact, 0));
+    paction->setCode(pact->m_num[0]);
+    if (!r.readTexts(pact, paction->getMapDescription(), paction->getMapInfoUrl())) {
+      return false;
+    }
+
+    for (uint32_t j = 0; j < pact->m_nChild; j++) {
+      const snaprecord* ppar = r.next(KIND_ACTIONPARAM);
+      if (nullptr == ppar) {
+        return false;
+      }
+
+      CMDF_ActionParameter* pparam = new CMDF_ActionParameter();
+      paction->getListActionParameter()->push_back(pparam);
+      pparam->setName(r.getString(ppar, 0));
+      pparam->setOffset(ppar->m_num[0]);
+      pparam->setMin(ppar->m_num[1]);
+      pparam->setMax(ppar->m_num[2]);
+      if (!r.readTexts(ppar, pparam->getMapDescription(), pparam->getMapInfoUrl()) ||
+          !readBits(r, ppar, pparam->getListBits(), pparam->getListValues())) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readEvent
+//
+
+bool
+CMdfSnapshot::readEvent(reader& r, const snaprecord* prec, CMDF_Event* pevent)
+{
+  pevent->setName(r.getString(prec, 0));
+  pevent->setClass(prec->m_num[0]);
+  pevent->setType(prec->m_num[1]);
+  pevent->setPriority(prec->m_num[2]);
+  pevent->setDirection(static_cast<mdf_event_direction>(prec->m_num[3]));
+
+  if (!r.readTexts(prec, pevent->getMapDescription(), pevent->getMapInfoUrl())) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < prec->m_nChild; i++) {
+    const snaprecord* pchild = r.next(KIND_EVENTDATA);
+    if (nullptr == pchild) {
+      return false;
+    }
+
+    CMDF_EventData* pdata = new CMDF_EventData();
+    pevent->getListEventData()->push_back(pdata);
+    pdata->setName(r.getString(pchild, 0));
+    pdata->setOffset(pchild->m_num[0]);
+    if (!r.readTexts(pchild, pdata->getMapDescription(), pdata->getMapInfoUrl()) ||
+        !readBits(r, pchild, pdata->getListBits(), pdata->getListValues())) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readFile
+//
+
+bool
+CMdfSnapshot::readFile(reader& r, const snaprecord* prec, CMDF& mdf)
+{
+  if (0 != prec->m_nChild) {
+    return false;
+  }
+
+  std::map<std::string, std::string>* pdesc;
+  std::map<std::string, std::string>* pinfo;
+
+  switch (prec->m_kind) {
+
+    case KIND_PICTURE: {
+      CMDF_Picture* pfile = new CMDF_Picture();
+      mdf.getPictureObjList()->push_back(pfile);
+      pfile->setName(r.getString(prec, 0));
+      pfile->setUrl(r.getString(prec, 1));
+      pfile->setFormat(r.getString(prec, 2));
+      pfile->setDate(r.getString(prec, 3));
+      pdesc = pfile->getMapDescription();
+      pinfo = pfile->getMapInfoUrl();
+    } break;
+
+    case KIND_VIDEO: {
+      CMDF_Video* pfile = new CMDF_Video();
+      mdf.getVideoObjList()->push_back(pfile);
+      pfile->setName(r.getString(prec, 0));
+      pfile->setUrl(r.getString(prec, 1));
+      pfile->setFormat(r.getString(prec, 2));
+      pfile->setDate(r.getString(prec, 3));
+      pdesc = pfile->getMapDescription();
+      pinfo = pfile->getMapInfoUrl();
+    } break;
+
+    case KIND_MANUAL: {
+      CMDF_Manual* pfile = new CMDF_Manual();
+      mdf.getManualObjList()->push_back(pfile);
+      pfile->setName(r.getString(prec, 0));
+      pfile->setUrl(r.getString(prec, 1));
+      pfile->setFormat(r.getString(prec, 2));
+      pfile->setDate(r.getString(prec, 3));
+      pfile->setLanguage(r.getString(prec, 4));
+      pdesc = pfile->getMapDescription();
+      pinfo = pfile->getMapInfoUrl();
+    } break;
+
+    case KIND_DRIVER: {
+      CMDF_Driver* pfile = new CMDF_Driver();
+      mdf.getDriverObjList()->push_back(pfile);
+      pfile->setName(r.getString(prec, 0));
+      pfile->setUrl(r.getString(prec, 1));
+      pfile->setType(r.getString(prec, 2));
+      pfile->setOS(r.getString(prec, 3));
+      pfile->setOSVer(r.getString(prec, 4));
+      pfile->setArchitecture(r.getString(prec, 5));
+      pfile->setDate(r.getString(prec, 6));
+      pfile->setVersion(r.getString(prec, 7));
+      pdesc = pfile->getMapDescription();
+      pinfo = pfile->getMapInfoUrl();
+    } break;
+
+    case KIND_SETUP: {
+      CMDF_Setup* pfile = new CMDF_Setup();
+      mdf.getSetupObjList()->push_back(pfile);
+      pfile->setName(r.getString(prec, 0));
+      pfile->setUrl(r.getString(prec, 1));
+      pfile->setFormat(r.getString(prec, 2));
+      pfile->setDate(r.getString(prec, 3));
+      pdesc = pfile->getMapDescription();
+      pinfo = pfile->getMapInfoUrl();
+    } break;
+
+    case KIND_FIRMWARE: {
+      CMDF_Firmware* pfile = new CMDF_Firmware();
+      mdf.getFirmwareObjList()->push_back(pfile);
+      pfile->setName(r.getString(prec, 0));
+      pfile->setUrl(r.getString(prec, 1));
+      pfile->setTarget(r.getString(prec, 2));
+      pfile->setFormat(r.getString(prec, 3));
+      pfile->setDate(r.getString(prec, 4));
+      pfile->setVersion(r.getString(prec, 5));
+      pfile->setTargetCode(prec->m_num[0]);
+      pfile->setSize(prec->m_num[1]);
+      pdesc = pfile->getMapDescription();
+      pinfo = pfile->getMapInfoUrl();
+    } break;
+
+    default:
+      return false;
+  }
+
+  return r.readTexts(prec, pdesc, pinfo);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// load
+//
+
+int
+CMdfSnapshot::load(const std::string& path, const std::string& sourceHash, CMDF& mdf)
+{
+  QFile file(QString::fromStdString(path));
+  if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+    return VSCP_ERROR_READ;
+  }
+
+  const qint64 size = file.size();
+  if (size < (qint64)sizeof(snapheader)) {
+    spdlog::warn("MDF snapshot: {0} is truncated", path);
+    return VSCP_ERROR_PARSING;
+  }
+
+  const uchar* pbase = file.map(0, size);
+  if (nullptr == pbase) {
+    spdlog::warn("MDF snapshot: Failed to map {0}", path);
+    return VSCP_ERROR_READ;
+  }
+
+  snapheader hdr;
+  memcpy(&hdr, pbase, sizeof(hdr));
+
+  if (memcmp(hdr.m_magic, SNAPSHOT_MAGIC, sizeof(hdr.m_magic)) ||
+      (VERSION != hdr.m_version) ||
+      (sizeof(snapheader) != hdr.m_headerSize) ||
+      (sizeof(snaprecord) != hdr.m_recordSize)) {
+    spdlog::debug("MDF snapshot: {0} has another format or version", path);
+    return VSCP_ERROR_PARSING;
+  }
+
+  if ((64 != sourceHash.size()) || memcmp(hdr.m_sourceHash, sourceHash.data(), sizeof(hdr.m_sourceHash))) {
+    spdlog::debug("MDF snapshot: {0} is for another source", path);
+    return VSCP_ERROR_PARSING;
+  }
+
+  if (((uint64_t)hdr.m_recordOffset + (uint64_t)hdr.m_recordCount * sizeof(snaprecord) > (uint64_t)size) ||
+      ((uint64_t)hdr.m_stringOffset + hdr.m_stringSize > (uint64_t)size) ||
+      !hdr.m_recordCount) {
+    spdlog::warn("MDF snapshot: {0} is damaged", path);
+    return VSCP_ERROR_PARSING;
+  }
+
+  reader r((const snaprecord*)(pbase + hdr.m_recordOffset),
+           hdr.m_recordCount,
+           (const char*)(pbase + hdr.m_stringOffset),
+           hdr.m_stringSize);
+
+  mdf.clearStorage();
+
+  bool bOk = false;
+  const snaprecord* pmod = r.next(KIND_MODULE);
+  if (nullptr != pmod) {
+    mdf.setModuleName(r.getString(pmod, 0));
+    mdf.setModuleModel(r.getString(pmod, 1));
+    mdf.setModuleVersion(r.getString(pmod, 2));
+    mdf.setModuleChangeDate(r.getString(pmod, 3));
+    mdf.setModuleCopyright(r.getString(pmod, 4));
+    mdf.setModuleLevel(pmod->m_num[0]);
+    mdf.setModuleBufferSize(pmod->m_num[1]);
+    bOk = r.readTexts(pmod, mdf.getMapDescription(), mdf.getMapInfoUrl());
+  }
+
+  for (uint32_t i = 0; bOk && (i < pmod->m_nChild); i++) {
+    const snaprecord* prec = r.next((recordkind)0);
+    if (nullptr == prec) {
+      bOk = false;
+      break;
+    }
+
+    // Objects are added to the MDF before they are filled in so that
+    // they are freed with it if the snapshot turns out to be damaged
+    switch (prec->m_kind) {
+
+      case KIND_MANUFACTURER:
+        bOk = readManufacturer(r, prec, mdf.getManufacturer());
+        break;
+
+      case KIND_REGISTER: {
+        CMDF_Register* preg = new CMDF_Register();
+        mdf.getRegisterObjList()->push_back(preg);
+        bOk = readRegister(r, prec, preg);
+      } break;
+
+      case KIND_REMOTEVAR: {
+        CMDF_RemoteVariable* pvar = new CMDF_RemoteVariable();
+        mdf.getRemoteVariableList()->push_back(pvar);
+        bOk = readRemoteVariable(r, prec, pvar);
+      } break;
+
+      case KIND_ALARM: {
+        CMDF_Bit* pbit = new CMDF_Bit();
+        mdf.getAlarmList()->push_back(pbit);
+        bOk = readBit(r, prec, pbit);
+      } break;
+
+      case KIND_DM:
+        bOk = readDM(r, prec, mdf.getDM());
+        break;
+
+      case KIND_EVENT: {
+        CMDF_Event* pevent = new CMDF_Event();
+        mdf.getEventList()->push_back(pevent);
+        bOk = readEvent(r, prec, pevent);
+      } break;
+
+      case KIND_BOOT: {
+        CMDF_BootLoaderInfo* pboot = mdf.getBootLoaderObj();
+        pboot->setAlgorithm(prec->m_num[0]);
+        pboot->setBlocksize(prec->m_num[1]);
+        pboot->setBlockCount(prec->m_num[2]);
+        bOk = (0 == prec->m_nChild) && (0 == prec->m_nText);
+      } break;
+
+      default:
+        bOk = readFile(r, prec, mdf);
+        break;
+    }
+  }
+
+  if (!bOk || !r.isDone()) {
+    spdlog::warn("MDF snapshot: {0} is damaged", path);
+    mdf.clearStorage();
+    return VSCP_ERROR_PARSING;
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
@@ -0,0 +1,255 @@
+// mdfsnapshot.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef MDFSNAPSHOT_H
+#define MDFSNAPSHOT_H
+
+#include <mdf.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+/*!
+  Binary snapshot of a parsed MDF.
+
+  Parsing an MDF means reading XML or JSON, converting every value from
+  text and building the object graph. A snapshot holds the result of a
+  parse in a form that can be loaded without any of that. It is stored
+  next to the cached MDF source and is only used if the SHA-256 of the
+  source it was made from matches, so a changed source always causes a
+  full parse.
+
+  The file is a header, a table of fixed size records and a pool of
+  strings. Records are written in depth first order, each one followed
+  by its description/info URL texts and then by its children. Strings
+  are referenced by their offset in the pool and identical strings are
+  stored once. On load the file is memory mapped, the string offsets are
+  resolved to pointers into the mapping and the MDF objects are created
+  directly from the records.
+
+  The snapshot holds module info, manufacturer, registers, remote
+  variables, alarm bits, decision matrix, events, boot loader info and
+  file lists with their bits, values, descriptions and info URL's. It is
+  meant for read only use of the MDF. An MDF that is edited and saved
+  should always be parsed from its source.
+*/
+
+class CMdfSnapshot {
+
+public:
+  /// Format version. Change when the layout or the content changes.
+  static const uint32_t VERSION = 1;
+
+  /// File extension for snapshot files
+  static const char* EXTENSION;
+
+  /*!
+    Write a snapshot of a parsed MDF
+    @param mdf Parsed MDF
+    @param path Path to snapshot file
+    @param sourceHash SHA-256 (hex) of the MDF source
+    @return VSCP_ERROR_SUCCESS on success
+  */
+  static int save(CMDF& mdf, const std::string& path, const std::string& sourceHash);
+
+  /*!
+    Load a snapshot into an MDF object. The MDF is cleared first.
+    @param path Path to snapshot file
+    @param sourceHash SHA-256 (hex) of the MDF source the snapshot
+                should be made from.
+    @param mdf MDF to load into
+    @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_READ if there is
+            no snapshot, VSCP_ERROR_PARSING if it is for another source,
+            another version or is damaged.
+  */
+  static int load(const std::string& path, const std::string& sourceHash, CMDF& mdf);
+
+private:
+  /// Kind of record
+  enum recordkind : uint8_t {
+    KIND_MODULE = 1,
+    KIND_TEXT,
+    KIND_MANUFACTURER,
+    KIND_ADDRESS,
+    KIND_CONTACT,
+    KIND_REGISTER,
+    KIND_BIT,
+    KIND_VALUE,
+    KIND_REMOTEVAR,
+    KIND_ALARM,
+    KIND_DM,
+    KIND_ACTION,
+    KIND_ACTIONPARAM,
+    KIND_EVENT,
+    KIND_EVENTDATA,
+    KIND_BOOT,
+    KIND_PICTURE,
+    KIND_VIDEO,
+    KIND_MANUAL,
+    KIND_DRIVER,
+    KIND_SETUP,
+    KIND_FIRMWARE
+  };
+
+  /// Type of text record
+  enum textkind : uint8_t { TEXT_DESCRIPTION = 0, TEXT_INFOURL };
+
+  /// Type of contact record
+  enum contactkind : uint8_t { CONTACT_PHONE = 0, CONTACT_FAX, CONTACT_EMAIL, CONTACT_WEB, CONTACT_SOCIAL };
+
+  /// Number of string and number fields in a record
+  static const int RECORD_STRINGS = 8;
+  static const int RECORD_NUMBERS = 10;
+
+#pragma pack(push, 1)
+
+  /*!
+    File header
+  */
+  struct snapheader {
+    char m_magic[8];
+    uint32_t m_version;
+    uint32_t m_headerSize;
+    uint32_t m_recordSize;
+    uint32_t m_recordCount;
+    uint32_t m_recordOffset;
+    uint32_t m_stringOffset;
+    uint32_t m_stringSize;
+    uint32_t m_reserved;
+    char m_sourceHash[64];
+  };
+
+  /*!
+    One object. Strings are offsets into the string pool where
+    zero is the empty string.
+  */
+  struct snaprecord {
+    uint8_t m_kind;
+    uint8_t m_reserved;
+    uint16_t m_nText;   // Text records that follow
+    uint32_t m_nChild;  // Child records that follow the texts
+    uint32_t m_str[RECORD_STRINGS];
+    uint32_t m_num[RECORD_NUMBERS];
+  };
+
+#pragma pack(pop)
+
+  /*!
+    Collects records and strings while a snapshot is written
+  */
+  class writer {
+
+  public:
+    writer();
+
+    /// Add a record and return its index
+    size_t add(recordkind kind);
+
+    /// Set a string field of a record
+    void setString(size_t idx, int field, const std::string& str);
+
+    /// Set a number field of a record
+    void setNumber(size_t idx, int field, uint32_t value) { m_records[idx].m_num[field] = value; };
+
+    /// Add description and info URL texts to the record just added
+    void addTexts(size_t idx, std::map<std::string, std::string>* pdesc, std::map<std::string, std::string>* pinfo);
+
+    /// Count one more child for a record
+    void addChild(size_t idx) { m_records[idx].m_nChild++; };
+
+    std::deque<snaprecord> m_records;
+    std::string m_pool;
+
+  private:
+    /// Pool offset for strings already in the pool
+    std::unordered_map<std::string, uint32_t> m_strings;
+  };
+
+  /*!
+    Walks the records of a mapped snapshot while it is loaded
+  */
+  class reader {
+
+  public:
+    reader(const snaprecord* precords, size_t count, const char* ppool, size_t poolSize);
+
+    /*!
+      Get the next record
+      @param kind Record kind that is expected or zero for any kind
+      @return Pointer to record or nullptr if there is no record of this
+              kind at the current position.
+    */
+    const snaprecord* next(recordkind kind);
+
+    /// Get a string field of a record
+    std::string getString(const snaprecord* prec, int field);
+
+    /// Read the texts of a record into maps
+    bool readTexts(const snaprecord* prec, std::map<std::string, std::string>* pdesc, std::map<std::string, std::string>* pinfo);
+
+    /// True if all records have been read and no error was found
+    bool isDone(void) const { return !m_bError && (m_pos == m_count); };
+
+    /// True if an invalid record or string was found
+    bool isError(void) const { return m_bError; };
+
+  private:
+    const snaprecord* m_precords;
+    size_t m_count;
+    size_t m_pos;
+    const char* m_ppool;
+    size_t m_poolSize;
+    bool m_bError;
+  };
+
+  // Writing
+
+  static void writeBits(writer& w, size_t parent, std::deque<CMDF_Bit*>* plist, recordkind kind = KIND_BIT);
+  static void writeValues(writer& w, size_t parent, std::deque<CMDF_Value*>* plist);
+  static void writeManufacturer(writer& w, size_t parent, CMDF_Manufacturer* pmanufacturer);
+  static void writeContacts(writer& w, size_t parent, std::deque<CMDF_Item*>* plist, contactkind type);
+  static void writeDM(writer& w, size_t parent, CMDF_DecisionMatrix* pdm);
+  static void writeEvents(writer& w, size_t parent, std::deque<CMDF_Event*>* plist);
+  static void writeFiles(writer& w, size_t parent, CMDF& mdf);
+
+  // Reading
+
+  static bool readBits(reader& r, const snaprecord* prec, std::deque<CMDF_Bit*>* pbits, std::deque<CMDF_Value*>* pvalues);
+  static bool readBit(reader& r, const snaprecord* prec, CMDF_Bit* pbit);
+  static bool readValue(reader& r, const snaprecord* prec, CMDF_Value* pvalue);
+  static bool readManufacturer(reader& r, const snaprecord* prec, CMDF_Manufacturer* pmanufacturer);
+  static bool readRegister(reader& r, const snaprecord* prec, CMDF_Register* preg);
+  static bool readRemoteVariable(reader& r, const snaprecord* prec, CMDF_RemoteVariable* pvar);
+  static bool readDM(reader& r, const snaprecord* prec, CMDF_DecisionMatrix* pdm);
+  static bool readEvent(reader& r, const snaprecord* prec, CMDF_Event* pevent);
+  static bool readFile(reader& r, const snaprecord* prec, CMDF& mdf);
+};
+
+#endif // MDFSNAPSHOT_H
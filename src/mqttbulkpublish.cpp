@@ -0,0 +1,323 @@
+// mqttbulkpublish.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+
+#include "mqttbulkpublish.h"
+
+#include <mosquitto.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+#include <spdlog/spdlog.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// appendNumber
+//
+
+template<typename T>
+static void
+appendNumber(std::string& out, T value)
+{
+  char buf[24];
+  const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+  out.append(buf, res.ptr - buf);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttBulkPublisher::CMqttBulkPublisher()
+{
+  m_mosq     = nullptr;
+  m_bRunning = false;
+  m_bStop    = false;
+  m_result   = VSCP_ERROR_SUCCESS;
+  m_total    = 0;
+  m_failed   = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttBulkPublisher::~CMqttBulkPublisher()
+{
+  stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+int
+CMqttBulkPublisher::start(struct mosquitto* mosq, const options& opt)
+{
+  if (m_bRunning) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  if ((nullptr == mosq) || opt.m_topics.empty() || opt.m_templates.empty() || !opt.m_repeat ||
+      (opt.m_qos < 0) || (opt.m_qos > 2)) {
+    return VSCP_ERROR_PARAMETER;
+  }
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  m_mosq    = mosq;
+  m_options = opt;
+  m_result  = VSCP_ERROR_SUCCESS;
+  m_total   = static_cast<uint64_t>(opt.m_repeat) * opt.m_topics.size() * opt.m_templates.size();
+  m_failed  = 0;
+  m_window.open();
+
+  m_bStop    = false;
+  m_bRunning = true;
+  m_thread   = std::thread(&CMqttBulkPublisher::worker, this);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// stop
+//
+
+void
+CMqttBulkPublisher::stop(void)
+{
+  m_bStop = true;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// parseTemplate
+//
+
+void
+CMqttBulkPublisher::parseTemplate(const std::string& tmpl, std::vector<segment>& segments)
+{
+  static const struct {
+    const char* m_token;
+    uint8_t m_type;
+  } tokens[] = { { "{counter}", SEGMENT_COUNTER },
+                 { "{timestamp}", SEGMENT_TIMESTAMP },
+                 { "{random}", SEGMENT_RANDOM } };
+
+  segments.clear();
+
+  size_t pos = 0;
+  std::string text;
+  while (pos < tmpl.size()) {
+
+    uint8_t type = SEGMENT_TEXT;
+    size_t len   = 0;
+    if ('{' == tmpl[pos]) {
+      for (const auto& token : tokens) {
+        len = strlen(token.m_token);
+        if (0 == tmpl.compare(pos, len, token.m_token)) {
+          type = token.m_type;
+          break;
+        }
+      }
+    }
+
+    if (SEGMENT_TEXT == type) {
+      text.push_back(tmpl[pos++]);
+      continue;
+    }
+
+    if (text.size()) {
+      segments.push_back({ SEGMENT_TEXT, std::move(text) });
+      text.clear();
+    }
+    segments.push_back({ type, std::string() });
+    pos += len;
+  }
+
+  if (text.size()) {
+    segments.push_back({ SEGMENT_TEXT, std::move(text) });
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// render
+//
+
+void
+CMqttBulkPublisher::render(const std::vector<segment>& segments,
+                           uint64_t counter,
+                           int64_t timestamp,
+                           uint32_t random,
+                           std::string& payload)
+{
+  payload.clear();
+  for (const auto& seg : segments) {
+    switch (seg.m_type) {
+      case SEGMENT_COUNTER:
+        appendNumber(payload, counter);
+        break;
+      case SEGMENT_TIMESTAMP:
+        appendNumber(payload, timestamp);
+        break;
+      case SEGMENT_RANDOM:
+        appendNumber(payload, random);
+        break;
+      default:
+        payload.append(seg.m_text);
+        break;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// worker
+//
+
+void
+CMqttBulkPublisher::worker(void)
+{
+  const uint64_t total  = m_total;
+  const uint64_t rate   = m_options.m_rate;
+  const size_t nTopics  = m_options.m_topics.size();
+  const size_t nTmpl    = m_options.m_templates.size();
+  const uint64_t maxLag = std::max<uint64_t>(1, (rate * MAX_LAG) / 1000);
+
+  // Templates are parsed once and payloads rendered into one buffer
+  // that only grows until it fits the largest payload
+  std::vector<std::vector<segment>> templates(nTmpl);
+  size_t maxSize = 0;
+  for (size_t i = 0; i < nTmpl; i++) {
+    parseTemplate(m_options.m_templates[i], templates[i]);
+    maxSize = std::max(maxSize, m_options.m_templates[i].size());
+  }
+  std::string payload;
+  payload.reserve(maxSize + 64);
+
+  std::mt19937 rng(std::random_device{}());
+  std::uniform_int_distribution<uint32_t> dist(0, 65535);
+
+  spdlog::debug("MQTT bulk publish: Started, {0} messages at {1}/s", total, rate);
+
+  auto startTime = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; (i < total) && !m_bStop; i++) {
+
+    // Message i is due i/rate seconds after the start
+    if (rate) {
+      while (!m_bStop) {
+        const auto now     = std::chrono::steady_clock::now();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - startTime).count();
+        const uint64_t due = (static_cast<uint64_t>(elapsed) * rate) / 1000000;
+        if (due > (i + maxLag)) {
+          // Too far behind (window full, slow broker), continue from
+          // here at the target rate instead of catching up in a burst
+          startTime = now - std::chrono::microseconds((i * 1000000) / rate);
+          break;
+        }
+        if (due >= i) {
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+
+    if (!m_window.wait(CMqttPublishWindow::SIZE - 1, 0, m_bStop)) {
+      break;
+    }
+
+    const std::string& topic = m_options.m_topics[(i / nTmpl) % nTopics];
+    render(templates[i % nTmpl],
+           i + 1,
+           std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+             .count(),
+           dist(rng),
+           payload);
+
+    // Counted before the call as the callback may run before it returns
+    m_window.addPublished();
+    const int rc = mosquitto_publish(m_mosq,
+                                     nullptr,
+                                     topic.c_str(),
+                                     static_cast<int>(payload.size()),
+                                     payload.data(),
+                                     m_options.m_qos,
+                                     m_options.m_bRetain);
+    if (MOSQ_ERR_SUCCESS != rc) {
+      m_window.removePublished();
+      m_failed.fetch_add(1, std::memory_order_relaxed);
+      if ((MOSQ_ERR_NO_CONN == rc) || (MOSQ_ERR_CONN_LOST == rc) || (MOSQ_ERR_NOMEM == rc)) {
+        spdlog::error("MQTT bulk publish: Publish failed, {0}", mosquitto_strerror(rc));
+        m_result = VSCP_ERROR_CONNECTION;
+        break;
+      }
+    }
+  }
+
+  // Let the last window go out before the run is reported done
+  if (!m_bStop && (VSCP_ERROR_SUCCESS == m_result) &&
+      !m_window.wait(0, CMqttPublishWindow::DRAIN_TIMEOUT, m_bStop)) {
+    spdlog::warn("MQTT bulk publish: {0} messages not completed", m_window.getOutstanding());
+  }
+
+  m_window.close();
+
+  spdlog::debug("MQTT bulk publish: Stopped, {0} messages published, {1} failed",
+                m_window.getPublished(),
+                m_failed.load());
+  m_bRunning = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getCounters
+//
+
+CMqttBulkPublisher::counters
+CMqttBulkPublisher::getCounters(void) const
+{
+  counters cnt;
+  cnt.m_total     = m_total.load(std::memory_order_relaxed);
+  cnt.m_published = m_window.getPublished();
+  cnt.m_completed = m_window.getCompleted();
+  cnt.m_failed    = m_failed.load(std::memory_order_relaxed);
+  cnt.m_inflight  = m_window.getOutstanding();
+  return cnt;
+}
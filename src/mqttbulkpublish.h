@@ -0,0 +1,187 @@
+// mqttbulkpublish.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MQTTBULKPUBLISH_H
+#define MQTTBULKPUBLISH_H
+
+#include "mqttpublishwindow.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct mosquitto;
+
+/*!
+  Publishes a large set of messages for load testing.
+
+  Every payload template is published on every topic, and the whole
+  set is repeated a number of times. A worker thread keeps a target
+  rate and publishes with mosquitto_publish on a client that is
+  already connected. Publishing is pipelined through a
+  CMqttPublishWindow.
+
+  Templates may contain these tokens:
+    {counter}   - Number of the message in the run, from 1
+    {timestamp} - Time of publish in ms since epoch
+    {random}    - Random integer 0-65535
+  Templates are split into text and tokens once, and payloads are
+  rendered into a reused buffer, so publishing does not allocate.
+  Other text in braces, such as JSON, is left as is.
+
+  onPublished() must be called from the publish callback of the
+  client.
+*/
+
+class CMqttBulkPublisher {
+
+public:
+  /// Template segment types
+  enum { SEGMENT_TEXT = 0, SEGMENT_COUNTER, SEGMENT_TIMESTAMP, SEGMENT_RANDOM };
+
+  /// Max time in milliseconds the publisher may fall behind before
+  /// the missed messages are skipped instead of sent in a burst
+  static const uint32_t MAX_LAG = 100;
+
+  /*!
+    A part of a payload template
+  */
+  struct segment {
+    uint8_t m_type;     // SEGMENT_*
+    std::string m_text; // Text for SEGMENT_TEXT
+  };
+
+  /*!
+    Bulk publish options
+  */
+  struct options {
+    std::vector<std::string> m_topics;
+    std::vector<std::string> m_templates;
+    uint32_t m_repeat; // Number of times the set is published
+    uint32_t m_rate;   // Messages per second, 0 for as fast as possible
+    int m_qos;
+    bool m_bRetain;
+  };
+
+  /*!
+    Bulk publish counters
+  */
+  struct counters {
+    uint64_t m_total;     // Messages in the run
+    uint64_t m_published; // Messages handed to the client
+    uint64_t m_completed; // Messages sent (QoS 0) or acknowledged
+    uint64_t m_failed;    // Messages the client refused
+    uint64_t m_inflight;  // Messages published but not completed
+  };
+
+  CMqttBulkPublisher();
+  ~CMqttBulkPublisher();
+
+  /*!
+    Start publishing
+    @param mosq Connected client to publish on
+    @param opt Bulk publish options
+    @return VSCP_ERROR_SUCCESS if started, VSCP_ERROR_ERROR if already
+            running and VSCP_ERROR_PARAMETER if there are no topics,
+            templates or repetitions or the QoS is invalid.
+  */
+  int start(struct mosquitto* mosq, const options& opt);
+
+  /*!
+    Stop publishing. Returns when the worker has stopped.
+  */
+  void stop(void);
+
+  /*!
+    Check if publishing is running
+    @return True if running
+  */
+  bool isRunning(void) const { return m_bRunning; };
+
+  /*!
+    Get result of the last run
+    @return VSCP_ERROR_SUCCESS if all messages were published,
+            VSCP_ERROR_CONNECTION if the client lost the connection.
+  */
+  int getResult(void) const { return m_result; };
+
+  /*!
+    Count a completed publish. Called from the publish callback of
+    the client.
+    @param mid Message id
+  */
+  void onPublished(int /*mid*/) { m_window.addCompleted(); };
+
+  /*!
+    Get bulk publish counters
+    @return Counters
+  */
+  counters getCounters(void) const;
+
+  /*!
+    Split a payload template into text and tokens
+    @param tmpl Template
+    @param segments Receives the segments
+  */
+  static void parseTemplate(const std::string& tmpl, std::vector<segment>& segments);
+
+  /*!
+    Render a payload from a parsed template
+    @param segments Parsed template
+    @param counter Value for {counter}
+    @param timestamp Value for {timestamp}
+    @param random Value for {random}
+    @param payload Receives the payload, its buffer is reused
+  */
+  static void render(const std::vector<segment>& segments,
+                     uint64_t counter,
+                     int64_t timestamp,
+                     uint32_t random,
+                     std::string& payload);
+
+private:
+  /// Publish loop
+  void worker(void);
+
+  struct mosquitto* m_mosq;
+  options m_options;
+  CMqttPublishWindow m_window;
+
+  std::thread m_thread;
+  std::atomic<bool> m_bRunning;
+  std::atomic<bool> m_bStop;
+  std::atomic<int> m_result;
+
+  std::atomic<uint64_t> m_total;
+  std::atomic<uint64_t> m_failed;
+};
+
+#endif // MQTTBULKPUBLISH_H
@@ -0,0 +1,527 @@
+// mqttcapture.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+
+#include "mqttcapture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#include <spdlog/spdlog.h>
+
+// Record types
+#define MQTT_CAPTURE_REC_TOPIC   1
+#define MQTT_CAPTURE_REC_MESSAGE 2
+
+// Magic (8) + version (1) + reserved (3) + start time (8)
+#define MQTT_CAPTURE_HEADER_SIZE 20
+
+// Message as queued by write(): timestamp (8) + topic length (4) +
+// payload length (4) + flags (1) followed by topic and payload
+#define MQTT_CAPTURE_PENDING_SIZE 17
+
+// Flags of a message record
+#define MQTT_CAPTURE_FLAG_QOS_MASK 0x03
+#define MQTT_CAPTURE_FLAG_RETAIN   0x04
+
+///////////////////////////////////////////////////////////////////////////////
+// putVarint
+//
+
+static void
+putVarint(std::string& out, uint64_t value)
+{
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttCaptureWriter::CMqttCaptureWriter()
+{
+  m_fp            = nullptr;
+  m_bOpen         = false;
+  m_bStop         = false;
+  m_messages      = 0;
+  m_dropped       = 0;
+  m_bytes         = 0;
+  m_topicCount    = 0;
+  m_lastTimestamp = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttCaptureWriter::~CMqttCaptureWriter()
+{
+  close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// open
+//
+
+int
+CMqttCaptureWriter::open(const std::string& path)
+{
+  if (m_bOpen) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  m_fp = fopen(path.c_str(), "wb");
+  if (nullptr == m_fp) {
+    spdlog::error("MQTT capture: Failed to create {0}", path);
+    return VSCP_ERROR_WRITE_ERROR;
+  }
+
+  const int64_t start = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+
+  uint8_t header[MQTT_CAPTURE_HEADER_SIZE];
+  memset(header, 0, sizeof(header));
+  memcpy(header, MQTT_CAPTURE_MAGIC, 8);
+  header[8] = MQTT_CAPTURE_VERSION;
+  for (int i = 0; i < 8; i++) {
+    header[12 + i] = static_cast<uint8_t>((static_cast<uint64_t>(start) >> (8 * i)) & 0xff);
+  }
+
+  if (sizeof(header) != fwrite(header, 1, sizeof(header), m_fp)) {
+    spdlog::error("MQTT capture: Failed to write header to {0}", path);
+    fclose(m_fp);
+    m_fp = nullptr;
+    return VSCP_ERROR_WRITE_ERROR;
+  }
+
+  m_path = path;
+  m_topics.clear();
+  m_pending.clear();
+  m_lastTimestamp = start;
+  m_messages      = 0;
+  m_dropped       = 0;
+  m_bytes         = sizeof(header);
+  m_topicCount    = 0;
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  m_bStop  = false;
+  m_bOpen  = true;
+  m_thread = std::thread(&CMqttCaptureWriter::worker, this);
+
+  spdlog::debug("MQTT capture: Capturing to {0}", path);
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// close
+//
+
+void
+CMqttCaptureWriter::close(void)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bOpen = false;
+    m_bStop = true;
+  }
+  m_cond.notify_one();
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  if (nullptr != m_fp) {
+    fclose(m_fp);
+    m_fp = nullptr;
+    spdlog::debug("MQTT capture: Closed {0}, {1} messages", m_path, m_messages.load());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write
+//
+
+bool
+CMqttCaptureWriter::write(const char* topic, const void* payload, int len, int qos, bool retained)
+{
+  if (!m_bOpen) {
+    return false;
+  }
+
+  const int64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::system_clock::now().time_since_epoch())
+                              .count();
+  const uint32_t topicLen   = (nullptr != topic) ? static_cast<uint32_t>(strlen(topic)) : 0;
+  const uint32_t payloadLen = ((nullptr != payload) && (len > 0)) ? static_cast<uint32_t>(len) : 0;
+  const uint8_t flags       = static_cast<uint8_t>((qos & MQTT_CAPTURE_FLAG_QOS_MASK) |
+                                             (retained ? MQTT_CAPTURE_FLAG_RETAIN : 0));
+
+  bool bWake;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_bOpen) {
+      return false;
+    }
+
+    const size_t size = m_pending.size();
+    if ((size + MQTT_CAPTURE_PENDING_SIZE + topicLen + payloadLen) > MAX_PENDING) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    // The buffer keeps its capacity between swaps so in steady state
+    // this does not allocate
+    m_pending.resize(size + MQTT_CAPTURE_PENDING_SIZE);
+    char* p = &m_pending[size];
+    memcpy(p, &timestamp, 8);
+    memcpy(p + 8, &topicLen, 4);
+    memcpy(p + 12, &payloadLen, 4);
+    p[16] = static_cast<char>(flags);
+    m_pending.append(topic, topicLen);
+    m_pending.append(static_cast<const char*>(payload), payloadLen);
+
+    bWake = (size < WAKE_SIZE) && (m_pending.size() >= WAKE_SIZE);
+  }
+
+  if (bWake) {
+    m_cond.notify_one();
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// encode
+//
+
+size_t
+CMqttCaptureWriter::encode(const std::string& pending, std::string& out)
+{
+  size_t cnt = 0;
+  size_t pos = 0;
+  while ((pos + MQTT_CAPTURE_PENDING_SIZE) <= pending.size()) {
+    int64_t timestamp;
+    uint32_t topicLen;
+    uint32_t payloadLen;
+    const char* p = pending.data() + pos;
+    memcpy(&timestamp, p, 8);
+    memcpy(&topicLen, p + 8, 4);
+    memcpy(&payloadLen, p + 12, 4);
+    const uint8_t flags = static_cast<uint8_t>(p[16]);
+    p += MQTT_CAPTURE_PENDING_SIZE;
+
+    std::string topic(p, topicLen);
+    auto it = m_topics.find(topic);
+    if (it == m_topics.end()) {
+      const uint32_t id = static_cast<uint32_t>(m_topics.size());
+      it                = m_topics.emplace(std::move(topic), id).first;
+      out.push_back(MQTT_CAPTURE_REC_TOPIC);
+      putVarint(out, id);
+      putVarint(out, topicLen);
+      out.append(p, topicLen);
+    }
+
+    // The wall clock can step back, such messages get the time of
+    // the one before
+    const int64_t delta = std::max<int64_t>(0, timestamp - m_lastTimestamp);
+    m_lastTimestamp += delta;
+
+    out.push_back(MQTT_CAPTURE_REC_MESSAGE);
+    putVarint(out, it->second);
+    putVarint(out, static_cast<uint64_t>(delta));
+    out.push_back(static_cast<char>(flags));
+    putVarint(out, payloadLen);
+    out.append(p + topicLen, payloadLen);
+
+    pos += MQTT_CAPTURE_PENDING_SIZE + topicLen + payloadLen;
+    cnt++;
+  }
+
+  return cnt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// worker
+//
+
+void
+CMqttCaptureWriter::worker(void)
+{
+  std::string pending;
+  std::string out;
+
+  while (true) {
+
+    bool bStop;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cond.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL), [this]() {
+        return m_bStop || (m_pending.size() >= WAKE_SIZE);
+      });
+      pending.swap(m_pending);
+      bStop = m_bStop;
+    }
+
+    if (pending.size()) {
+      out.clear();
+      const size_t cnt = encode(pending, out);
+      pending.clear();
+
+      if (out.size() == fwrite(out.data(), 1, out.size(), m_fp)) {
+        m_messages.fetch_add(cnt, std::memory_order_relaxed);
+        m_bytes.fetch_add(out.size(), std::memory_order_relaxed);
+        m_topicCount = m_topics.size();
+      }
+      else {
+        spdlog::error("MQTT capture: Failed to write to {0}", m_path);
+        m_dropped.fetch_add(cnt, std::memory_order_relaxed);
+      }
+    }
+
+    if (bStop) {
+      break;
+    }
+  }
+
+  fflush(m_fp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getCounters
+//
+
+CMqttCaptureWriter::counters
+CMqttCaptureWriter::getCounters(void) const
+{
+  counters cnt;
+  cnt.m_messages = m_messages.load(std::memory_order_relaxed);
+  cnt.m_dropped  = m_dropped.load(std::memory_order_relaxed);
+  cnt.m_bytes    = m_bytes.load(std::memory_order_relaxed);
+  cnt.m_topics   = m_topicCount.load(std::memory_order_relaxed);
+  return cnt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttCaptureReader::CMqttCaptureReader()
+{
+  m_fp            = nullptr;
+  m_bTruncated    = false;
+  m_startTime     = 0;
+  m_lastTimestamp = 0;
+  m_position      = 0;
+  m_size          = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttCaptureReader::~CMqttCaptureReader()
+{
+  close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// open
+//
+
+int
+CMqttCaptureReader::open(const std::string& path)
+{
+  close();
+
+  m_fp = fopen(path.c_str(), "rb");
+  if (nullptr == m_fp) {
+    spdlog::error("MQTT capture: Failed to open {0}", path);
+    return VSCP_ERROR_READ_ERROR;
+  }
+
+  std::error_code ec;
+  m_size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    m_size = 0;
+  }
+
+  uint8_t header[MQTT_CAPTURE_HEADER_SIZE];
+  if ((sizeof(header) != fread(header, 1, sizeof(header), m_fp)) ||
+      (0 != memcmp(header, MQTT_CAPTURE_MAGIC, 8)) || (MQTT_CAPTURE_VERSION != header[8])) {
+    spdlog::error("MQTT capture: {0} is not a capture file", path);
+    close();
+    return VSCP_ERROR_PARSING;
+  }
+
+  uint64_t start = 0;
+  for (int i = 0; i < 8; i++) {
+    start |= static_cast<uint64_t>(header[12 + i]) << (8 * i);
+  }
+  m_startTime     = static_cast<int64_t>(start);
+  m_lastTimestamp = m_startTime;
+  m_position      = sizeof(header);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// close
+//
+
+void
+CMqttCaptureReader::close(void)
+{
+  if (nullptr != m_fp) {
+    fclose(m_fp);
+    m_fp = nullptr;
+  }
+
+  m_topics.clear();
+  m_bTruncated = false;
+  m_position   = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readVarint
+//
+
+bool
+CMqttCaptureReader::readVarint(uint64_t& value)
+{
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const int ch = getc(m_fp);
+    if (EOF == ch) {
+      return false;
+    }
+    m_position++;
+    value |= static_cast<uint64_t>(ch & 0x7f) << shift;
+    if (!(ch & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readBytes
+//
+
+bool
+CMqttCaptureReader::readBytes(std::string& data, size_t len)
+{
+  // Lengths come from the file, do not trust them further than its size
+  if (m_size && (len > (m_size - std::min(m_size, m_position)))) {
+    return false;
+  }
+
+  data.resize(len);
+  if (len && (len != fread(&data[0], 1, len, m_fp))) {
+    return false;
+  }
+  m_position += len;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// next
+//
+
+bool
+CMqttCaptureReader::next(record& rec)
+{
+  if (nullptr == m_fp) {
+    return false;
+  }
+
+  while (true) {
+    const int type = getc(m_fp);
+    if (EOF == type) {
+      return false;
+    }
+    m_position++;
+
+    uint64_t id;
+    if (!readVarint(id)) {
+      break;
+    }
+
+    if (MQTT_CAPTURE_REC_TOPIC == type) {
+      uint64_t len;
+      std::string topic;
+      if ((id != m_topics.size()) || !readVarint(len) || !readBytes(topic, len)) {
+        break;
+      }
+      m_topics.push_back(std::move(topic));
+      continue;
+    }
+
+    if (MQTT_CAPTURE_REC_MESSAGE != type) {
+      break;
+    }
+
+    uint64_t delta;
+    uint64_t len;
+    int flags;
+    if ((id >= m_topics.size()) || !readVarint(delta) || (EOF == (flags = getc(m_fp)))) {
+      break;
+    }
+    m_position++;
+    if (!readVarint(len) || !readBytes(rec.m_payload, len)) {
+      break;
+    }
+
+    m_lastTimestamp += static_cast<int64_t>(delta);
+    rec.m_ptopic    = &m_topics[id];
+    rec.m_timestamp = m_lastTimestamp;
+    rec.m_qos       = static_cast<uint8_t>(flags & MQTT_CAPTURE_FLAG_QOS_MASK);
+    rec.m_retained  = (flags & MQTT_CAPTURE_FLAG_RETAIN) ? true : false;
+    return true;
+  }
+
+  m_bTruncated = true;
+  spdlog::warn("MQTT capture: Damaged or incomplete record at offset {0}", m_position);
+  return false;
+}
@@ -0,0 +1,268 @@
+// mqttcapture.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MQTTCAPTURE_H
+#define MQTTCAPTURE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+/*!
+  Capture files for MQTT traffic.
+
+  A capture file starts with a header holding a magic, a version and
+  the capture start time. It is followed by records of two kinds. A
+  topic record assigns the next free id to a topic and is written the
+  first time the topic is seen. A message record holds the topic id,
+  the time since the previous message in milliseconds, qos/retain
+  flags and the payload. Ids, times and lengths are stored as LEB128
+  varints so a typical sensor message costs only a few bytes on top
+  of its payload. A file that was cut short (crash, full disk) can be
+  read up to the last complete record.
+*/
+
+/// Magic at start of a capture file
+#define MQTT_CAPTURE_MAGIC "VSCPMQTT"
+
+/// Capture file version
+#define MQTT_CAPTURE_VERSION 1
+
+/*!
+  Writes MQTT messages to a capture file.
+
+  write() is called from the MQTT network thread. It only copies the
+  message into a pending buffer while holding a lock. A worker thread
+  swaps the buffer out, interns the topics, encodes the records and
+  writes them to disk. If the disk can not keep up and the pending
+  buffer grows above MAX_PENDING messages are counted as dropped
+  instead of being queued.
+*/
+
+class CMqttCaptureWriter {
+
+public:
+  /// Max bytes of messages waiting to be written
+  static const size_t MAX_PENDING = 32 * 1024 * 1024;
+
+  /// The worker is woken early when this many bytes are pending
+  static const size_t WAKE_SIZE = 1024 * 1024;
+
+  /// Max time in milliseconds messages wait before they are written
+  static constexpr uint32_t FLUSH_INTERVAL = 250;
+
+  /*!
+    Capture counters
+  */
+  struct counters {
+    uint64_t m_messages; // Messages written to the file
+    uint64_t m_dropped;  // Messages lost because the writer fell behind
+    uint64_t m_bytes;    // Size of file
+    size_t m_topics;     // Topics in the file
+  };
+
+  CMqttCaptureWriter();
+  ~CMqttCaptureWriter();
+
+  /*!
+    Create a capture file and start the writer thread. An existing
+    file is replaced.
+    @param path Path to capture file
+    @return VSCP_ERROR_SUCCESS if the file was created,
+            VSCP_ERROR_ERROR if already open and
+            VSCP_ERROR_WRITE_ERROR if the file could not be created.
+  */
+  int open(const std::string& path);
+
+  /*!
+    Write pending messages, stop the writer thread and close the file
+  */
+  void close(void);
+
+  /*!
+    Check if a capture is in progress
+    @return True if open
+  */
+  bool isOpen(void) const { return m_bOpen; };
+
+  /*!
+    Get path of the capture file
+    @return Path, empty if never opened
+  */
+  const std::string& getPath(void) const { return m_path; };
+
+  /*!
+    Add a message to the capture. Does nothing if not open. Only
+    holds the lock while the message is copied.
+    @param topic Topic of message
+    @param payload Payload data or nullptr
+    @param len Size of payload
+    @param qos Quality of service
+    @param retained True if retained message
+    @return True if queued, false if not open or dropped.
+  */
+  bool write(const char* topic, const void* payload, int len, int qos, bool retained);
+
+  /*!
+    Get capture counters
+    @return Counters
+  */
+  counters getCounters(void) const;
+
+private:
+  /// Write loop
+  void worker(void);
+
+  /*!
+    Encode the messages in a pending buffer as records
+    @param pending Messages as queued by write()
+    @param out Receives the records
+    @return Number of messages encoded
+  */
+  size_t encode(const std::string& pending, std::string& out);
+
+  /// Capture file, only used by the worker when open
+  FILE* m_fp;
+
+  /// Path of capture file
+  std::string m_path;
+
+  std::thread m_thread;
+  std::atomic<bool> m_bOpen;
+  std::atomic<bool> m_bStop;
+
+  /// Protects the pending buffer
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::string m_pending;
+
+  std::atomic<uint64_t> m_messages;
+  std::atomic<uint64_t> m_dropped;
+  std::atomic<uint64_t> m_bytes;
+  std::atomic<size_t> m_topicCount;
+
+  /// Topic to id, owned by the worker
+  std::unordered_map<std::string, uint32_t> m_topics;
+
+  /// Time of last written message, owned by the worker
+  int64_t m_lastTimestamp;
+};
+
+/*!
+  Reads a capture file record by record
+*/
+
+class CMqttCaptureReader {
+
+public:
+  /*!
+    A message read from a capture file
+  */
+  struct record {
+    const std::string* m_ptopic; // Valid until the reader is closed
+    std::string m_payload;
+    int64_t m_timestamp;         // Receive time in ms since epoch
+    uint8_t m_qos;
+    bool m_retained;
+  };
+
+  CMqttCaptureReader();
+  ~CMqttCaptureReader();
+
+  /*!
+    Open a capture file and read the header
+    @param path Path to capture file
+    @return VSCP_ERROR_SUCCESS if opened, VSCP_ERROR_READ_ERROR if the
+            file could not be opened and VSCP_ERROR_PARSING if it is not
+            a capture file.
+  */
+  int open(const std::string& path);
+
+  /*!
+    Close the file
+  */
+  void close(void);
+
+  /*!
+    Read the next message
+    @param rec Receives the message
+    @return True if a message was read, false at end of file or if
+            the rest of the file is damaged (see isTruncated()).
+  */
+  bool next(record& rec);
+
+  /*!
+    Check if reading stopped on an incomplete or invalid record
+    @return True if the file was cut short
+  */
+  bool isTruncated(void) const { return m_bTruncated; };
+
+  /*!
+    Get capture start time
+    @return Start time in ms since epoch
+  */
+  int64_t getStartTime(void) const { return m_startTime; };
+
+  /*!
+    Get read position
+    @return Bytes read from the file
+  */
+  uint64_t getPosition(void) const { return m_position; };
+
+  /*!
+    Get file size
+    @return Size of file in bytes
+  */
+  uint64_t getSize(void) const { return m_size; };
+
+private:
+  /// Read a varint, false on end of file or overflow
+  bool readVarint(uint64_t& value);
+
+  /// Read a number of bytes, false on end of file
+  bool readBytes(std::string& data, size_t len);
+
+  FILE* m_fp;
+  bool m_bTruncated;
+  int64_t m_startTime;
+  int64_t m_lastTimestamp;
+  uint64_t m_position;
+  uint64_t m_size;
+
+  /// Topics by id, a deque so records can point into it
+  std::deque<std::string> m_topics;
+};
+
+#endif // MQTTCAPTURE_H
@@ -0,0 +1,259 @@
+// mqttfilterworker.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+
+#include "mqttfilterworker.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttFilterWorker::CMqttFilterWorker(const CMqttTopicTrie& trie, std::mutex& trieMutex)
+  : m_trie(trie)
+  , m_trieMutex(trieMutex)
+{
+  m_bPending = false;
+  m_bResult  = false;
+  m_job      = 0;
+  m_bRunning = false;
+  m_bStop    = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttFilterWorker::~CMqttFilterWorker()
+{
+  stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+int
+CMqttFilterWorker::start(donecallback cbDone)
+{
+  if (m_bRunning) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  m_cbDone   = cbDone;
+  m_bStop    = false;
+  m_bRunning = true;
+  m_thread   = std::thread(&CMqttFilterWorker::worker, this);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// stop
+//
+
+void
+CMqttFilterWorker::stop(void)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bStop = true;
+    m_job++;
+  }
+  m_cv.notify_one();
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// request
+//
+
+uint64_t
+CMqttFilterWorker::request(const CMqttTopicFilter& filter)
+{
+  uint64_t job;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending  = filter;
+    m_bPending = true;
+    m_bResult  = false;
+    job        = ++m_job;
+  }
+  m_cv.notify_one();
+  return job;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cancel
+//
+
+void
+CMqttFilterWorker::cancel(void)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_bPending = false;
+  m_bResult  = false;
+  m_job++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// takeResult
+//
+
+bool
+CMqttFilterWorker::takeResult(result& res)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_bResult || (m_result.m_job != m_job)) {
+    return false;
+  }
+
+  res       = std::move(m_result);
+  m_bResult = false;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// worker
+//
+
+void
+CMqttFilterWorker::worker(void)
+{
+  spdlog::debug("MQTT filter: Worker started");
+
+  while (true) {
+
+    result res;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this]() { return m_bStop || m_bPending; });
+      if (m_bStop) {
+        break;
+      }
+      res.m_filter = m_pending;
+      res.m_job    = m_job;
+      m_bPending   = false;
+    }
+
+    if (!evaluate(res.m_job, res)) {
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (res.m_job != m_job) {
+        continue;
+      }
+      m_result  = std::move(res);
+      m_bResult = true;
+    }
+
+    if (nullptr != m_cbDone) {
+      m_cbDone();
+    }
+  }
+
+  spdlog::debug("MQTT filter: Worker stopped");
+  m_bRunning = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// markVisible
+//
+
+void
+CMqttFilterWorker::markVisible(uint32_t id, std::vector<uint8_t>& visible)
+{
+  for (uint32_t cur = id; (CMqttTopicTrie::NONE != cur) && !visible[cur]; cur = m_trie.getNode(cur).m_parent) {
+    visible[cur] = 1;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// evaluate
+//
+
+bool
+CMqttFilterWorker::evaluate(uint64_t job, result& res)
+{
+  const CMqttTopicFilter& filter = res.m_filter;
+  std::vector<uint32_t> candidates;
+
+  std::unique_lock<std::mutex> lock(m_trieMutex);
+
+  // Nodes are only ever added so ids below the count stay valid
+  res.m_nodeCount = (uint32_t)m_trie.getNodeCount();
+  res.m_visible.assign(res.m_nodeCount, 0);
+  res.m_visible[CMqttTopicTrie::ROOT] = 1;
+
+  // An MQTT pattern narrows down the nodes to look at
+  bool bCandidates = filter.isMqttPattern();
+  if (bCandidates) {
+    filter.findTopics(m_trie, candidates);
+  }
+
+  size_t count = bCandidates ? candidates.size() : res.m_nodeCount - 1;
+  size_t work  = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint32_t id = bCandidates ? candidates[i] : (uint32_t)(i + 1);
+
+    if (!res.m_visible[id] && filter.matchesNode(m_trie, id)) {
+      markVisible(id, res.m_visible);
+    }
+
+    work += filter.usesMessages() ? std::max((size_t)1, m_trie.getNode(id).m_history.size()) : 1;
+    if (work >= CHUNK_WORK) {
+      work = 0;
+      lock.unlock();
+      if (job != m_job) {
+        return false;
+      }
+      std::this_thread::yield();
+      lock.lock();
+    }
+  }
+
+  return true;
+}
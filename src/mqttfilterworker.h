@@ -0,0 +1,155 @@
+// mqttfilterworker.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef MQTTFILTERWORKER_H
+#define MQTTFILTERWORKER_H
+
+#include "mqtttopicfilter.h"
+#include "mqtttopictrie.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+  Evaluates a topic filter on a worker thread.
+
+  The trie is owned by the user interface thread which takes the trie
+  mutex while it changes the trie. The worker takes the same mutex while
+  it reads, but only for a bounded amount of work at a time so incoming
+  messages are never held up for long. A new request cancels the one
+  that is running, so only the filter the user ended up with is
+  evaluated to the end.
+
+  The result is the visibility of every node that existed when the
+  evaluation started: a node is visible if it matches or if a node
+  below it matches. Nodes added or changed later must be checked by
+  the owner.
+*/
+
+class CMqttFilterWorker {
+
+public:
+  /// Messages (or topics for topic only filters) checked per lock
+  static const size_t CHUNK_WORK = 4096;
+
+  /*!
+    Result of an evaluation
+  */
+  struct result {
+    uint64_t m_job;                // Job id from request()
+    uint32_t m_nodeCount;          // Nodes in trie when the evaluation started
+    CMqttTopicFilter m_filter;     // Filter that was evaluated
+    std::vector<uint8_t> m_visible; // Visibility for each node id below m_nodeCount
+  };
+
+  /// Called from the worker thread when a result is ready
+  typedef std::function<void(void)> donecallback;
+
+  CMqttFilterWorker(const CMqttTopicTrie& trie, std::mutex& trieMutex);
+  ~CMqttFilterWorker();
+
+  /*!
+    Start the worker thread
+    @param cbDone Called from the worker when a result is ready
+    @return VSCP_ERROR_SUCCESS if started, VSCP_ERROR_ERROR if already
+            running.
+  */
+  int start(donecallback cbDone);
+
+  /*!
+    Stop the worker thread. A running evaluation is abandoned.
+  */
+  void stop(void);
+
+  /*!
+    Check if the worker is running
+    @return True if running
+  */
+  bool isRunning(void) const { return m_bRunning; };
+
+  /*!
+    Request evaluation of a filter. Replaces a request that has not
+    been started and cancels one that is running.
+    @param filter Filter to evaluate
+    @return Job id
+  */
+  uint64_t request(const CMqttTopicFilter& filter);
+
+  /*!
+    Cancel the current request
+  */
+  void cancel(void);
+
+  /*!
+    Take the result of the latest request
+    @param res Filled with the result
+    @return True if there was a result for the latest request
+  */
+  bool takeResult(result& res);
+
+private:
+  /// Job loop
+  void worker(void);
+
+  /*!
+    Evaluate a filter
+    @param job Job id, evaluation stops if it is no longer current
+    @param res Result, m_filter must be set
+    @return True if done, false if cancelled
+  */
+  bool evaluate(uint64_t job, result& res);
+
+  /// Mark a node and the nodes above it visible. The trie mutex must be held.
+  void markVisible(uint32_t id, std::vector<uint8_t>& visible);
+
+  const CMqttTopicTrie& m_trie;
+  std::mutex& m_trieMutex;
+
+  /// Protects the members below
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_bPending;
+  CMqttTopicFilter m_pending;
+  bool m_bResult;
+  result m_result;
+
+  /// Id of the latest request
+  std::atomic<uint64_t> m_job;
+
+  donecallback m_cbDone;
+  std::thread m_thread;
+  std::atomic<bool> m_bRunning;
+  std::atomic<bool> m_bStop;
+};
+
+#endif // MQTTFILTERWORKER_H
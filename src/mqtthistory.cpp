@@ -0,0 +1,194 @@
+// mqtthistory.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include "mqtthistory.h"
+
+#include <algorithm>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttHistory::CMqttHistory()
+{
+  m_head  = 0;
+  m_first = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttHistory::~CMqttHistory()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clear
+//
+
+void
+CMqttHistory::clear(void)
+{
+  std::vector<char>().swap(m_data);
+  std::vector<uint32_t>().swap(m_offsets);
+  m_head  = 0;
+  m_first = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// push
+//
+
+void
+CMqttHistory::push(const std::string& payload, int64_t timestamp, int mid, uint8_t qos, bool bRetained)
+{
+  header hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.m_timestamp = timestamp;
+  hdr.m_mid       = mid;
+  hdr.m_size      = (uint32_t)payload.size();
+  hdr.m_qos       = qos;
+  hdr.m_retained  = bRetained ? 1 : 0;
+  hdr.m_format    = sniff(payload);
+
+  size_t pos = m_data.size();
+  m_data.resize(pos + sizeof(hdr) + payload.size());
+  memcpy(m_data.data() + pos, &hdr, sizeof(hdr));
+  if (payload.size()) {
+    memcpy(m_data.data() + pos + sizeof(hdr), payload.data(), payload.size());
+  }
+  m_offsets.push_back((uint32_t)pos);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// pop
+//
+
+void
+CMqttHistory::pop(void)
+{
+  if (empty()) {
+    return;
+  }
+
+  m_first++;
+  if (empty()) {
+    clear();
+    return;
+  }
+
+  m_head = m_offsets[m_first];
+  compact();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// compact
+//
+
+void
+CMqttHistory::compact(void)
+{
+  // Copying into new buffers also gives back the capacity a burst of
+  // messages may have left behind
+  if (m_head >= (m_data.size() - m_head)) {
+    std::vector<char> data(m_data.begin() + m_head, m_data.end());
+    m_data.swap(data);
+    for (size_t i = m_first; i < m_offsets.size(); i++) {
+      m_offsets[i] -= m_head;
+    }
+    m_head = 0;
+  }
+
+  if (m_first >= (m_offsets.size() - m_first)) {
+    std::vector<uint32_t> offsets(m_offsets.begin() + m_first, m_offsets.end());
+    m_offsets.swap(offsets);
+    m_first = 0;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// get
+//
+
+bool
+CMqttHistory::get(size_t idx, message& msg) const
+{
+  if (idx >= size()) {
+    return false;
+  }
+
+  header hdr;
+  const char* p = m_data.data() + m_offsets[m_first + idx];
+  memcpy(&hdr, p, sizeof(hdr));
+
+  msg.m_payload   = std::string_view(p + sizeof(hdr), hdr.m_size);
+  msg.m_timestamp = hdr.m_timestamp;
+  msg.m_mid       = hdr.m_mid;
+  msg.m_qos       = hdr.m_qos;
+  msg.m_retained  = (0 != hdr.m_retained);
+  msg.m_format    = hdr.m_format;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sniff
+//
+
+uint8_t
+CMqttHistory::sniff(std::string_view payload)
+{
+  size_t pos   = 0;
+  size_t limit = std::min(payload.size(), (size_t)SNIFF_LIMIT);
+  while ((pos < limit) && ((' ' == payload[pos]) || ('\t' == payload[pos]) || ('\r' == payload[pos]) ||
+                           ('\n' == payload[pos]))) {
+    pos++;
+  }
+
+  if (pos >= payload.size()) {
+    return FORMAT_TEXT;
+  }
+
+  switch (payload[pos]) {
+    case '\0':
+      return FORMAT_BINARY;
+    case '{':
+    case '[':
+      return FORMAT_JSON;
+    case '<':
+      return FORMAT_XML;
+    default:
+      return FORMAT_TEXT;
+  }
+}
@@ -0,0 +1,165 @@
+// mqtthistory.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef MQTTHISTORY_H
+#define MQTTHISTORY_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*!
+  Message history for one MQTT topic.
+
+  Messages are stored back to back in one byte buffer as a small fixed
+  header followed by the raw payload. New messages are appended at the
+  end and old ones are dropped from the front. The dead space at the
+  front is reclaimed when it is larger than the live part, so a topic
+  costs one allocation for all its messages instead of one or more per
+  message. Nothing is decoded or converted here, formatted views are
+  built from the raw payload when a message is shown. The only thing
+  looked at is the first non-whitespace byte of the payload which gives
+  the format the payload is expected to be in.
+*/
+
+class CMqttHistory {
+
+public:
+  /// Payload formats
+  enum { FORMAT_TEXT = 0, FORMAT_JSON, FORMAT_XML, FORMAT_BINARY };
+
+  /// Max leading whitespace skipped when the format is sniffed
+  static const size_t SNIFF_LIMIT = 64;
+
+  /*!
+    A message in the history. The payload refers into the history and
+    is valid until the history is changed.
+  */
+  struct message {
+    std::string_view m_payload;
+    int64_t m_timestamp; // Receive time in ms since epoch
+    int m_mid;
+    uint8_t m_qos;
+    bool m_retained;
+    uint8_t m_format; // Sniffed payload format
+  };
+
+  CMqttHistory();
+  ~CMqttHistory();
+
+  /*!
+    Append a message
+    @param payload Raw payload
+    @param timestamp Receive time in ms since epoch
+    @param mid Message id
+    @param qos QoS
+    @param bRetained True if retained
+  */
+  void push(const std::string& payload, int64_t timestamp, int mid, uint8_t qos, bool bRetained);
+
+  /*!
+    Remove the oldest message
+  */
+  void pop(void);
+
+  /*!
+    Get number of messages
+    @return Number of messages
+  */
+  size_t size(void) const { return m_offsets.size() - m_first; };
+
+  /*!
+    Check if there are no messages
+    @return True if empty
+  */
+  bool empty(void) const { return m_offsets.size() == m_first; };
+
+  /*!
+    Get a message
+    @param idx Index, 0 is the oldest message
+    @param msg Filled with the message
+    @return True on success, false if idx is out of range.
+  */
+  bool get(size_t idx, message& msg) const;
+
+  /*!
+    Get the latest message
+    @param msg Filled with the message
+    @return True on success, false if empty.
+  */
+  bool back(message& msg) const { return !empty() && get(size() - 1, msg); };
+
+  /*!
+    Get memory held by the history
+    @return Allocated bytes
+  */
+  size_t getBytes(void) const { return m_data.capacity() + m_offsets.capacity() * sizeof(uint32_t); };
+
+  /*!
+    Remove all messages and free memory
+  */
+  void clear(void);
+
+  /*!
+    Guess the format of a payload from its first non-whitespace byte.
+    0x00 is binary, '{' or '[' is JSON, '<' is XML and anything else
+    is text. Only the start of the payload is looked at.
+    @param payload Payload
+    @return Payload format
+  */
+  static uint8_t sniff(std::string_view payload);
+
+private:
+  /// Header stored in front of each payload
+  struct header {
+    int64_t m_timestamp;
+    int32_t m_mid;
+    uint32_t m_size;
+    uint8_t m_qos;
+    uint8_t m_retained;
+    uint8_t m_format;
+  };
+
+  /// Move live data to the start of the buffers if the front is mostly dead
+  void compact(void);
+
+  /// Headers and payloads, oldest first
+  std::vector<char> m_data;
+
+  /// Offset in m_data for each message
+  std::vector<uint32_t> m_offsets;
+
+  /// First live byte in m_data
+  uint32_t m_head;
+
+  /// First live entry in m_offsets
+  uint32_t m_first;
+};
+
+#endif // MQTTHISTORY_H
@@ -0,0 +1,391 @@
+// mqttingest.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "mqttingest.h"
+#include "mqttvscpdecoder.h"
+
+#include <chrono>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+static_assert((CMqttIngest::RING_SIZE & (CMqttIngest::RING_SIZE - 1)) == 0,
+              "Ring size must be a power of two");
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttIngest::CMqttIngest()
+  : m_ring(RING_SIZE)
+{
+  m_head      = 0;
+  m_tail      = 0;
+  m_received  = 0;
+  m_dropped    = 0;
+  m_superseded = 0;
+  m_processed  = 0;
+  m_rendered  = 0;
+  m_bPaused   = false;
+  m_bRunning  = false;
+  m_bStop     = false;
+
+  m_bDecodeVscp    = true;
+  m_bForwardEvents = false;
+  m_vscp           = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttIngest::~CMqttIngest()
+{
+  stop();
+
+  for (auto pev : m_events) {
+    vscp_deleteEvent(pev);
+  }
+  m_events.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+int
+CMqttIngest::start(void)
+{
+  if (m_bRunning) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  m_bStop    = false;
+  m_bRunning = true;
+  m_thread   = std::thread(&CMqttIngest::worker, this);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// stop
+//
+
+void
+CMqttIngest::stop(void)
+{
+  m_bStop = true;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// push
+//
+
+bool
+CMqttIngest::push(const char* topic, const void* payload, int len, bool retained, int qos, int mid)
+{
+  if (m_bPaused) {
+    return false;
+  }
+
+  size_t head = m_head.load(std::memory_order_relaxed);
+  if ((head - m_tail.load(std::memory_order_acquire)) >= RING_SIZE) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // The slot keeps the buffers from earlier use so in steady state
+  // this does not allocate.
+  message& slot = m_ring[head & (RING_SIZE - 1)];
+  slot.m_topic.assign((nullptr != topic) ? topic : "");
+  if ((nullptr != payload) && (len > 0)) {
+    slot.m_payload.assign(static_cast<const char*>(payload), len);
+  }
+  else {
+    slot.m_payload.clear();
+  }
+  slot.m_retained  = retained;
+  slot.m_qos       = qos;
+  slot.m_mid       = mid;
+  slot.m_timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+
+  m_head.store(head + 1, std::memory_order_release);
+  m_received.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// pop
+//
+
+bool
+CMqttIngest::pop(message& msg)
+{
+  size_t tail = m_tail.load(std::memory_order_relaxed);
+  if (tail == m_head.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  std::swap(msg, m_ring[tail & (RING_SIZE - 1)]);
+  m_tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// apply
+//
+
+void
+CMqttIngest::apply(message& msg)
+{
+  auto its = m_topics.find(msg.m_topic);
+  if (its == m_topics.end()) {
+    its = m_topics.emplace(msg.m_topic, topicstate{ 0, 0, 0 }).first;
+  }
+  topicstate& state = its->second;
+  state.m_count++;
+  state.m_bytes += msg.m_payload.size();
+  state.m_lastTimestamp = msg.m_timestamp;
+
+  topicchange* pchange;
+  auto itc = m_changeIndex.find(msg.m_topic);
+  if (itc == m_changeIndex.end()) {
+    m_changeIndex[msg.m_topic] = m_changes.size();
+    m_changes.emplace_back();
+    pchange          = &m_changes.back();
+    pchange->m_topic = msg.m_topic;
+    pchange->m_count = 0;
+    pchange->m_bytes = 0;
+  }
+  else {
+    pchange = &m_changes[itc->second];
+  }
+
+  pchange->m_count++;
+  pchange->m_bytes += msg.m_payload.size();
+  pchange->m_total = state.m_count;
+
+  // Older messages than the user interface can show for the topic are
+  // superseded, reuse the oldest entry for the new one
+  if (pchange->m_messages.size() >= MAX_PENDING_PER_TOPIC) {
+    message old = std::move(pchange->m_messages.front());
+    pchange->m_messages.pop_front();
+    std::swap(old, msg);
+    pchange->m_messages.push_back(std::move(old));
+    m_superseded.fetch_add(1, std::memory_order_relaxed);
+  }
+  else {
+    pchange->m_messages.push_back(std::move(msg));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decodeBatch
+//
+
+void
+CMqttIngest::decodeBatch(std::vector<message>& batch,
+                         size_t cnt,
+                         vscp_event_t*& pev,
+                         std::vector<vscp_event_t*>& events)
+{
+  const bool bDecode  = m_bDecodeVscp;
+  const bool bForward = m_bForwardEvents;
+
+  for (size_t i = 0; i < cnt; i++) {
+    message& msg       = batch[i];
+    msg.m_vscpEncoding = CMqttVscpDecoder::ENCODING_NONE;
+    if (!bDecode || (nullptr == pev)) {
+      continue;
+    }
+
+    msg.m_vscpEncoding = CMqttVscpDecoder::decode(msg.m_payload, pev);
+    if (CMqttVscpDecoder::ENCODING_NONE == msg.m_vscpEncoding) {
+      continue;
+    }
+
+    msg.m_vscpClass = pev->vscp_class;
+    msg.m_vscpType  = pev->vscp_type;
+
+    // The decoded event is handed over as is and a new one is
+    // used for the rest of the batch
+    if (bForward && vscp_isMeasurement(pev)) {
+      events.push_back(pev);
+      pev = nullptr;
+      if (!vscp_newEvent(&pev)) {
+        pev = nullptr;
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// worker
+//
+
+void
+CMqttIngest::worker(void)
+{
+  std::vector<message> batch(WORKER_BATCH);
+  std::vector<vscp_event_t*> events;
+
+  vscp_event_t* pev = nullptr;
+  if (!vscp_newEvent(&pev)) {
+    spdlog::error("MQTT ingest: Failed to allocate event, VSCP decoding disabled");
+    pev = nullptr;
+  }
+
+  spdlog::debug("MQTT ingest: Worker started");
+
+  while (true) {
+
+    size_t cnt = 0;
+    while ((cnt < WORKER_BATCH) && pop(batch[cnt])) {
+      cnt++;
+    }
+
+    // Stop when asked to and the ring has been drained
+    if (!cnt) {
+      if (m_bStop) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      continue;
+    }
+
+    // Parsing is done before the lock is taken so the user interface
+    // is never held up by it
+    events.clear();
+    decodeBatch(batch, cnt, pev, events);
+
+    uint64_t decoded = 0;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      for (size_t i = 0; i < cnt; i++) {
+        if (CMqttVscpDecoder::ENCODING_NONE != batch[i].m_vscpEncoding) {
+          m_vscpCounts[CMqttVscpDecoder::makeKey(batch[i].m_vscpClass, batch[i].m_vscpType)]++;
+          decoded++;
+        }
+        apply(batch[i]);
+      }
+
+      for (auto pevfwd : events) {
+        m_events.push_back(pevfwd);
+      }
+      while (m_events.size() > MAX_PENDING_EVENTS) {
+        vscp_deleteEvent(m_events.front());
+        m_events.pop_front();
+      }
+    }
+
+    m_vscp.fetch_add(decoded, std::memory_order_relaxed);
+    m_processed.fetch_add(cnt, std::memory_order_relaxed);
+  }
+
+  if (nullptr != pev) {
+    vscp_deleteEvent(pev);
+  }
+
+  spdlog::debug("MQTT ingest: Worker stopped");
+  m_bRunning = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// takeChanges
+//
+
+void
+CMqttIngest::takeChanges(std::vector<topicchange>& changes)
+{
+  changes.clear();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  changes.swap(m_changes);
+  m_changeIndex.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// takeEvents
+//
+
+void
+CMqttIngest::takeEvents(std::vector<vscp_event_t*>& events)
+{
+  events.clear();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  events.assign(m_events.begin(), m_events.end());
+  m_events.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getVscpCounts
+//
+
+void
+CMqttIngest::getVscpCounts(std::map<uint32_t, uint64_t>& counts)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  counts = m_vscpCounts;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getCounters
+//
+
+CMqttIngest::counters
+CMqttIngest::getCounters(void)
+{
+  counters cnt;
+  cnt.m_received  = m_received.load(std::memory_order_relaxed);
+  cnt.m_dropped    = m_dropped.load(std::memory_order_relaxed);
+  cnt.m_superseded = m_superseded.load(std::memory_order_relaxed);
+  cnt.m_processed  = m_processed.load(std::memory_order_relaxed);
+  cnt.m_rendered   = m_rendered.load(std::memory_order_relaxed);
+  cnt.m_queued     = m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+  cnt.m_vscp       = m_vscp.load(std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  cnt.m_topics = m_topics.size();
+  return cnt;
+}
@@ -0,0 +1,278 @@
+// mqttingest.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MQTTINGEST_H
+#define MQTTINGEST_H
+
+#include <vscp.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*!
+  Ingestion pipeline for MQTT messages at high rate.
+
+  The MQTT network thread writes incoming messages into a bounded single
+  producer/single consumer ring without taking any lock. If the ring is
+  full the message is counted as dropped instead of being queued. A
+  worker thread drains the ring and keeps per topic state up to date at
+  full rate. It also collects the topics that changed since the last
+  call to takeChanges() together with their latest messages, so a user
+  interface can refresh once per frame for each changed topic instead
+  of once for each message. Messages beyond the latest ones kept for a
+  topic are counted as superseded.
+
+  When VSCP decoding is enabled the worker also decodes each batch
+  into VSCP events before it takes the lock, counts them per
+  class/type and, if asked to, queues measurement events so they can
+  be forwarded to measurement views.
+*/
+
+class CMqttIngest {
+
+public:
+  /// Number of slots in the ring (must be a power of two)
+  static const size_t RING_SIZE = 16384;
+
+  /// Latest messages kept for a changed topic between two takes
+  static const size_t MAX_PENDING_PER_TOPIC = 250;
+
+  /// Messages moved from the ring to the topic state in one go
+  static const size_t WORKER_BATCH = 512;
+
+  /// Decoded measurement events kept between two takes
+  static const size_t MAX_PENDING_EVENTS = 1024;
+
+  /*!
+    A received message
+  */
+  struct message {
+    std::string m_topic;
+    std::string m_payload;
+    bool m_retained;
+    int m_qos;
+    int m_mid;
+    int64_t m_timestamp; // Receive time in ms since epoch
+    uint8_t m_vscpEncoding; // CMqttVscpDecoder::ENCODING_*
+    uint16_t m_vscpClass;   // Valid if m_vscpEncoding is set
+    uint16_t m_vscpType;    // Valid if m_vscpEncoding is set
+  };
+
+  /*!
+    A topic that changed since the last take
+  */
+  struct topicchange {
+    std::string m_topic;
+    uint64_t m_count;               // Messages since last take
+    uint64_t m_total;               // Messages on topic in total
+    uint64_t m_bytes;               // Payload bytes since last take
+    std::deque<message> m_messages; // Latest messages, oldest first
+  };
+
+  /*!
+    Pipeline counters
+  */
+  struct counters {
+    uint64_t m_received;   // Messages accepted into the ring
+    uint64_t m_dropped;    // Messages lost because the ring was full
+    uint64_t m_superseded; // Messages replaced by newer ones on their topic before a take
+    uint64_t m_processed;  // Messages applied to topic state
+    uint64_t m_rendered;   // Messages shown by the user interface
+    size_t m_queued;       // Messages waiting in the ring
+    size_t m_topics;       // Topics seen
+    uint64_t m_vscp;       // Messages decoded as VSCP events
+  };
+
+  CMqttIngest();
+  ~CMqttIngest();
+
+  /*!
+    Start the worker thread
+    @return VSCP_ERROR_SUCCESS if started, VSCP_ERROR_ERROR if already
+            running.
+  */
+  int start(void);
+
+  /*!
+    Stop the worker thread after the ring has been drained. The
+    producer should be stopped first.
+  */
+  void stop(void);
+
+  /*!
+    Check if the worker is running
+    @return True if running
+  */
+  bool isRunning(void) const { return m_bRunning; };
+
+  /*!
+    Add a message to the ring. Must only be called from one thread
+    (the MQTT network thread). Never blocks.
+    @param topic Topic of message
+    @param payload Payload data or nullptr
+    @param len Size of payload
+    @param retained True if retained message
+    @param qos Quality of service
+    @param mid Message id
+    @return True if queued, false if paused or dropped.
+  */
+  bool push(const char* topic, const void* payload, int len, bool retained, int qos, int mid);
+
+  /*!
+    Pause/resume ingestion. Messages received while paused are ignored
+    and not counted.
+    @param bPaused True to pause
+  */
+  void setPaused(bool bPaused) { m_bPaused = bPaused; };
+
+  /*!
+    Take the topics that changed since last call, in the order they
+    first changed.
+    @param changes Filled with changed topics
+  */
+  void takeChanges(std::vector<topicchange>& changes);
+
+  /*!
+    Count messages that has been shown by the user interface
+    @param count Number of messages
+  */
+  void addRendered(uint64_t count) { m_rendered += count; };
+
+  /*!
+    Enable/disable decoding of VSCP events on the worker
+    @param bDecode True to decode
+  */
+  void setVscpDecoding(bool bDecode) { m_bDecodeVscp = bDecode; };
+
+  /*!
+    Enable/disable queuing of decoded measurement events. Events
+    queued before forwarding was disabled are kept until taken.
+    @param bForward True to queue measurement events
+  */
+  void setEventForwarding(bool bForward) { m_bForwardEvents = bForward; };
+
+  /*!
+    Take the measurement events decoded since last call, oldest first.
+    The caller owns the events and must delete them with
+    vscp_deleteEvent.
+    @param events Filled with events
+  */
+  void takeEvents(std::vector<vscp_event_t*>& events);
+
+  /*!
+    Get number of decoded VSCP events per class/type
+    @param counts Filled with (class << 16) + type -> count
+  */
+  void getVscpCounts(std::map<uint32_t, uint64_t>& counts);
+
+  /*!
+    Get pipeline counters
+    @return Counters
+  */
+  counters getCounters(void);
+
+private:
+  /// Drain loop
+  void worker(void);
+
+  /// Apply a message to topic state, m_mutex must be held
+  void apply(message& msg);
+
+  /*!
+    Decode VSCP events for a batch. Only called from the worker and
+    without m_mutex held.
+    @param batch Messages, the VSCP fields are set
+    @param cnt Number of messages in batch
+    @param pev Event used for decoding, replaced when it is queued
+    @param events Receives measurement events to forward
+  */
+  void decodeBatch(std::vector<message>& batch,
+                   size_t cnt,
+                   vscp_event_t*& pev,
+                   std::vector<vscp_event_t*>& events);
+
+  /*!
+    Take a message from the ring. Only called from the worker.
+    @param msg Receives the message. The buffers of msg are handed
+               to the slot so they can be reused by the producer.
+    @return True if a message was taken
+  */
+  bool pop(message& msg);
+
+  /// Per topic state, updated at full rate
+  struct topicstate {
+    uint64_t m_count;
+    uint64_t m_bytes;
+    int64_t m_lastTimestamp;
+  };
+
+  /// Ring storage, slots are preallocated and reused
+  std::vector<message> m_ring;
+
+  /// Next slot to write (producer)
+  alignas(64) std::atomic<size_t> m_head;
+
+  /// Next slot to read (consumer)
+  alignas(64) std::atomic<size_t> m_tail;
+
+  alignas(64) std::atomic<uint64_t> m_received;
+  std::atomic<uint64_t> m_dropped;
+  std::atomic<uint64_t> m_superseded;
+  std::atomic<uint64_t> m_processed;
+  std::atomic<uint64_t> m_rendered;
+  std::atomic<bool> m_bPaused;
+  std::atomic<bool> m_bDecodeVscp;
+  std::atomic<bool> m_bForwardEvents;
+  std::atomic<uint64_t> m_vscp;
+
+  std::thread m_thread;
+  std::atomic<bool> m_bRunning;
+  std::atomic<bool> m_bStop;
+
+  /// Protects topic state and changes
+  std::mutex m_mutex;
+  std::unordered_map<std::string, topicstate> m_topics;
+  std::vector<topicchange> m_changes;
+  std::unordered_map<std::string, size_t> m_changeIndex;
+
+  /// Decoded events per (class << 16) + type
+  std::map<uint32_t, uint64_t> m_vscpCounts;
+
+  /// Measurement events waiting to be taken
+  std::deque<vscp_event_t*> m_events;
+};
+
+#endif // MQTTINGEST_H
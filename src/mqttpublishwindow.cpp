@@ -0,0 +1,96 @@
+// mqttpublishwindow.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include "mqttpublishwindow.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttPublishWindow::CMqttPublishWindow()
+{
+  m_bOpen     = false;
+  m_published = 0;
+  m_completed = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// open
+//
+
+void
+CMqttPublishWindow::open(void)
+{
+  m_published = 0;
+  m_completed = 0;
+  m_bOpen     = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getOutstanding
+//
+
+uint64_t
+CMqttPublishWindow::getOutstanding(void) const
+{
+  const uint64_t published = m_published.load(std::memory_order_relaxed);
+  return published - std::min(published, m_completed.load(std::memory_order_relaxed));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// wait
+//
+
+bool
+CMqttPublishWindow::wait(uint64_t limit, uint32_t timeout, const std::atomic<bool>& bStop) const
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  while (!bStop) {
+    if (getOutstanding() <= limit) {
+      return true;
+    }
+
+    if (timeout && ((std::chrono::steady_clock::now() - start) > std::chrono::milliseconds(timeout))) {
+      return false;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  return false;
+}
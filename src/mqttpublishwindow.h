@@ -0,0 +1,131 @@
+// mqttpublishwindow.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MQTTPUBLISHWINDOW_H
+#define MQTTPUBLISHWINDOW_H
+
+#include <atomic>
+#include <cstdint>
+
+/*!
+  Messages published on a mosquitto client that are not yet sent
+  (QoS 0) or acknowledged (QoS 1/2).
+
+  A publisher counts a message before it calls mosquitto_publish and
+  the publish callback of the client counts it as completed. This
+  lets publishing be pipelined: the publisher does not wait for each
+  message but only when SIZE messages are outstanding. The client
+  should have its send maximum set to at least SIZE so QoS 1/2
+  messages are not held back by the broker round trip.
+
+  Completions are only counted while the window is open so callbacks
+  for messages from an earlier run are ignored. Publishes made by
+  others on the same client while the window is open are counted
+  too, which only makes the window slightly larger.
+*/
+
+class CMqttPublishWindow {
+
+public:
+  /// Max messages published but not yet completed
+  static const uint32_t SIZE = 1000;
+
+  /// Max time in milliseconds to wait for the window to drain
+  static const uint32_t DRAIN_TIMEOUT = 5000;
+
+  CMqttPublishWindow();
+
+  /*!
+    Reset the counters and start counting completions
+  */
+  void open(void);
+
+  /*!
+    Stop counting completions
+  */
+  void close(void) { m_bOpen = false; };
+
+  /*!
+    Count a message that is about to be published. Must be called
+    before mosquitto_publish as the callback may run before it
+    returns.
+  */
+  void addPublished(void) { m_published.fetch_add(1, std::memory_order_relaxed); };
+
+  /*!
+    Take back a message that the client refused
+  */
+  void removePublished(void) { m_published.fetch_sub(1, std::memory_order_relaxed); };
+
+  /*!
+    Count a completed message. Called from the publish callback.
+  */
+  void addCompleted(void)
+  {
+    if (m_bOpen) {
+      m_completed.fetch_add(1, std::memory_order_relaxed);
+    }
+  };
+
+  /*!
+    Get number of messages handed to the client
+    @return Published messages
+  */
+  uint64_t getPublished(void) const { return m_published.load(std::memory_order_relaxed); };
+
+  /*!
+    Get number of messages sent/acknowledged
+    @return Completed messages
+  */
+  uint64_t getCompleted(void) const { return m_completed.load(std::memory_order_relaxed); };
+
+  /*!
+    Get number of messages in flight
+    @return Outstanding messages
+  */
+  uint64_t getOutstanding(void) const;
+
+  /*!
+    Wait until no more than a number of messages are outstanding
+    @param limit Max outstanding messages
+    @param timeout Max time to wait in milliseconds, 0 to wait
+                   until stopped
+    @param bStop Set by another thread to stop waiting
+    @return True when at or below the limit, false if stopped or
+            timed out
+  */
+  bool wait(uint64_t limit, uint32_t timeout, const std::atomic<bool>& bStop) const;
+
+private:
+  std::atomic<bool> m_bOpen;
+  std::atomic<uint64_t> m_published;
+  std::atomic<uint64_t> m_completed;
+};
+
+#endif // MQTTPUBLISHWINDOW_H
@@ -0,0 +1,237 @@
+// mqttreplay.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+
+#include "mqttreplay.h"
+
+#include <mosquitto.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include <spdlog/spdlog.h>
+
+// Messages between two updates of the progress
+#define MQTT_REPLAY_PROGRESS_INTERVAL 256
+
+// Longest sleep in milliseconds before a stop request is checked
+#define MQTT_REPLAY_MAX_SLEEP 100
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttReplay::CMqttReplay()
+{
+  m_mosq      = nullptr;
+  m_bRunning  = false;
+  m_bStop     = false;
+  m_result    = VSCP_ERROR_SUCCESS;
+  m_failed    = 0;
+  m_progress  = 0;
+
+  m_options.m_mode    = MODE_ORIGINAL;
+  m_options.m_speed   = 1.0;
+  m_options.m_qos     = -1;
+  m_options.m_bRetain = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttReplay::~CMqttReplay()
+{
+  stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+int
+CMqttReplay::start(struct mosquitto* mosq, const std::string& path, const options& opt)
+{
+  if (m_bRunning) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  if ((nullptr == mosq) || (opt.m_mode > MODE_MAX_RATE) || (opt.m_qos > 2) ||
+      ((MODE_SCALED == opt.m_mode) && !(opt.m_speed > 0))) {
+    return VSCP_ERROR_PARAMETER;
+  }
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  int rv = m_reader.open(path);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    return rv;
+  }
+
+  m_mosq      = mosq;
+  m_options   = opt;
+  m_result    = VSCP_ERROR_SUCCESS;
+  m_failed    = 0;
+  m_progress  = 0;
+  m_window.open();
+
+  m_bStop    = false;
+  m_bRunning = true;
+  m_thread   = std::thread(&CMqttReplay::worker, this);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// stop
+//
+
+void
+CMqttReplay::stop(void)
+{
+  m_bStop = true;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// worker
+//
+
+void
+CMqttReplay::worker(void)
+{
+  const bool bPaced  = (MODE_MAX_RATE != m_options.m_mode);
+  const double speed = (MODE_SCALED == m_options.m_mode) ? m_options.m_speed : 1.0;
+
+  spdlog::debug("MQTT replay: Started, mode {0} speed {1}", m_options.m_mode, speed);
+
+  CMqttCaptureReader::record rec;
+  std::chrono::steady_clock::time_point startTime;
+  int64_t firstTimestamp = 0;
+  uint64_t cnt           = 0;
+  bool bEnd              = false;
+
+  while (!m_bStop) {
+
+    if (!m_reader.next(rec)) {
+      bEnd = true;
+      break;
+    }
+
+    // Each message is due at its offset from the first message
+    // divided by the speed factor
+    if (bPaced) {
+      if (!cnt) {
+        firstTimestamp = rec.m_timestamp;
+        startTime      = std::chrono::steady_clock::now();
+      }
+      const auto due =
+        startTime + std::chrono::microseconds(static_cast<int64_t>(
+                      static_cast<double>(rec.m_timestamp - firstTimestamp) * 1000 / speed));
+      auto now = std::chrono::steady_clock::now();
+      while (!m_bStop && (now < due)) {
+        std::this_thread::sleep_for(
+          std::min<std::chrono::steady_clock::duration>(due - now,
+                                                        std::chrono::milliseconds(MQTT_REPLAY_MAX_SLEEP)));
+        now = std::chrono::steady_clock::now();
+      }
+    }
+
+    if (!m_window.wait(CMqttPublishWindow::SIZE - 1, 0, m_bStop)) {
+      break;
+    }
+
+    // Counted before the call as the callback may run before it returns
+    m_window.addPublished();
+    const int rc = mosquitto_publish(m_mosq,
+                                     nullptr,
+                                     rec.m_ptopic->c_str(),
+                                     static_cast<int>(rec.m_payload.size()),
+                                     rec.m_payload.data(),
+                                     (m_options.m_qos >= 0) ? m_options.m_qos : rec.m_qos,
+                                     m_options.m_bRetain && rec.m_retained);
+    if (MOSQ_ERR_SUCCESS != rc) {
+      m_window.removePublished();
+      m_failed.fetch_add(1, std::memory_order_relaxed);
+      if ((MOSQ_ERR_NO_CONN == rc) || (MOSQ_ERR_CONN_LOST == rc) || (MOSQ_ERR_NOMEM == rc)) {
+        spdlog::error("MQTT replay: Publish failed, {0}", mosquitto_strerror(rc));
+        m_result = VSCP_ERROR_CONNECTION;
+        break;
+      }
+    }
+
+    if (!(++cnt % MQTT_REPLAY_PROGRESS_INTERVAL) && m_reader.getSize()) {
+      m_progress = static_cast<int>((m_reader.getPosition() * 100) / m_reader.getSize());
+    }
+  }
+
+  if (bEnd) {
+    if (m_reader.isTruncated()) {
+      m_result = VSCP_ERROR_PARSING;
+    }
+    m_progress = 100;
+
+    // Let the last window go out before the replay is reported done
+    if (!m_window.wait(0, CMqttPublishWindow::DRAIN_TIMEOUT, m_bStop) && !m_bStop) {
+      spdlog::warn("MQTT replay: {0} messages not completed", m_window.getOutstanding());
+    }
+  }
+
+  m_reader.close();
+  m_window.close();
+
+  spdlog::debug("MQTT replay: Stopped, {0} messages published, {1} failed",
+                m_window.getPublished(),
+                m_failed.load());
+  m_bRunning = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getCounters
+//
+
+CMqttReplay::counters
+CMqttReplay::getCounters(void) const
+{
+  counters cnt;
+  cnt.m_published = m_window.getPublished();
+  cnt.m_completed = m_window.getCompleted();
+  cnt.m_failed    = m_failed.load(std::memory_order_relaxed);
+  cnt.m_progress  = m_progress.load(std::memory_order_relaxed);
+  return cnt;
+}
@@ -0,0 +1,147 @@
+// mqttreplay.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MQTTREPLAY_H
+#define MQTTREPLAY_H
+
+#include "mqttcapture.h"
+#include "mqttpublishwindow.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+struct mosquitto;
+
+/*!
+  Replays a capture file by publishing its messages again.
+
+  A worker thread reads the file and publishes each message with
+  mosquitto_publish on a client that is already connected. Messages
+  can be sent with the timing they were captured with, with the
+  timing scaled or as fast as possible. Publishing is pipelined
+  through a CMqttPublishWindow.
+
+  onPublished() must be called from the publish callback of the
+  client.
+*/
+
+class CMqttReplay {
+
+public:
+  /// Timing modes
+  enum { MODE_ORIGINAL = 0, MODE_SCALED, MODE_MAX_RATE };
+
+  /*!
+    Replay options
+  */
+  struct options {
+    uint8_t m_mode; // MODE_*
+    double m_speed; // Speed factor for MODE_SCALED, 2.0 is twice as fast
+    int m_qos;      // QoS to publish with, -1 for the captured QoS
+    bool m_bRetain; // Keep captured retain flags
+  };
+
+  /*!
+    Replay counters
+  */
+  struct counters {
+    uint64_t m_published; // Messages handed to the client
+    uint64_t m_completed; // Messages sent (QoS 0) or acknowledged
+    uint64_t m_failed;    // Messages the client refused
+    int m_progress;       // Percent of file replayed
+  };
+
+  CMqttReplay();
+  ~CMqttReplay();
+
+  /*!
+    Start replaying a capture file
+    @param mosq Connected client to publish on
+    @param path Path to capture file
+    @param opt Replay options
+    @return VSCP_ERROR_SUCCESS if started, VSCP_ERROR_ERROR if already
+            running, VSCP_ERROR_PARAMETER for invalid options and
+            the error from CMqttCaptureReader::open if the file can
+            not be read.
+  */
+  int start(struct mosquitto* mosq, const std::string& path, const options& opt);
+
+  /*!
+    Stop the replay. Returns when the worker has stopped.
+  */
+  void stop(void);
+
+  /*!
+    Check if a replay is running
+    @return True if running
+  */
+  bool isRunning(void) const { return m_bRunning; };
+
+  /*!
+    Get result of the last replay
+    @return VSCP_ERROR_SUCCESS if the whole file was replayed,
+            VSCP_ERROR_PARSING if the file was cut short and
+            VSCP_ERROR_CONNECTION if the client lost the connection.
+  */
+  int getResult(void) const { return m_result; };
+
+  /*!
+    Count a completed publish. Called from the publish callback of
+    the client.
+    @param mid Message id
+  */
+  void onPublished(int /*mid*/) { m_window.addCompleted(); };
+
+  /*!
+    Get replay counters
+    @return Counters
+  */
+  counters getCounters(void) const;
+
+private:
+  /// Replay loop
+  void worker(void);
+
+  struct mosquitto* m_mosq;
+  CMqttCaptureReader m_reader;
+  options m_options;
+  CMqttPublishWindow m_window;
+
+  std::thread m_thread;
+  std::atomic<bool> m_bRunning;
+  std::atomic<bool> m_bStop;
+  std::atomic<int> m_result;
+
+  std::atomic<uint64_t> m_failed;
+  std::atomic<int> m_progress;
+};
+
+#endif // MQTTREPLAY_H
@@ -0,0 +1,323 @@
+// mqtttopicfilter.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include "mqtttopicfilter.h"
+
+#include <algorithm>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttTopicFilter::CMqttTopicFilter()
+{
+  m_bMqttPattern  = false;
+  m_bUsesMessages = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttTopicFilter::~CMqttTopicFilter()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// set
+//
+
+void
+CMqttTopicFilter::set(const QString& filter, const QString& topicFilter)
+{
+  m_clauses.clear();
+  m_bUsesMessages = false;
+  for (const QString& clause : filter.trimmed().toLower().split(',', Qt::SkipEmptyParts)) {
+    const QString trimmed = clause.trimmed();
+    if (trimmed.isEmpty()) {
+      continue;
+    }
+    m_clauses.push_back(trimmed);
+    if (!trimmed.startsWith("topic=")) {
+      m_bUsesMessages = true;
+    }
+  }
+
+  m_topicFilter  = topicFilter.trimmed().toLower();
+  m_bMqttPattern = m_topicFilter.contains('+') || m_topicFilter.contains('#');
+  m_mqttLevels   = m_bMqttPattern ? m_topicFilter.split('/') : QStringList();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// wildcardMatches
+//
+
+bool
+CMqttTopicFilter::wildcardMatches(const QString& text, const QString& pattern)
+{
+  int textIndex    = 0;
+  int patternIndex = 0;
+  int starIndex    = -1;
+  int matchIndex   = 0;
+
+  while (textIndex < text.size()) {
+    if (patternIndex < pattern.size() &&
+        (pattern.at(patternIndex) == '*' || pattern.at(patternIndex).toLower() == text.at(textIndex).toLower())) {
+      if (pattern.at(patternIndex) == '*') {
+        starIndex  = patternIndex;
+        matchIndex = textIndex;
+        ++patternIndex;
+      }
+      else {
+        ++textIndex;
+        ++patternIndex;
+      }
+    }
+    else if (starIndex >= 0) {
+      patternIndex = starIndex + 1;
+      matchIndex += 1;
+      textIndex = matchIndex;
+    }
+    else {
+      return false;
+    }
+  }
+
+  while (patternIndex < pattern.size() && pattern.at(patternIndex) == '*') {
+    ++patternIndex;
+  }
+
+  return patternIndex == pattern.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// mqttMatches
+//
+
+bool
+CMqttTopicFilter::mqttMatches(const QString& topic, const QString& pattern)
+{
+  const QStringList levels  = topic.split('/');
+  const QStringList plevels = pattern.split('/');
+
+  int i = 0;
+  for (; i < plevels.size(); i++) {
+    if ("#" == plevels[i]) {
+      // '#' also matches the parent level
+      return true;
+    }
+    if (i >= levels.size()) {
+      return false;
+    }
+    if (("+" != plevels[i]) && (0 != levels[i].compare(plevels[i], Qt::CaseInsensitive))) {
+      return false;
+    }
+  }
+
+  return i == levels.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// matchesTopicFilter
+//
+
+bool
+CMqttTopicFilter::matchesTopicFilter(const QString& topic, const QString& pattern)
+{
+  const QString trimmedPattern = pattern.trimmed();
+  if (trimmedPattern.isEmpty()) {
+    return true;
+  }
+
+  const QString normalizedTopic = topic.trimmed();
+  if (normalizedTopic.isEmpty()) {
+    return false;
+  }
+
+  if (trimmedPattern.contains('+') || trimmedPattern.contains('#')) {
+    return mqttMatches(normalizedTopic, trimmedPattern);
+  }
+
+  if (!trimmedPattern.contains('*')) {
+    return normalizedTopic.compare(trimmedPattern, Qt::CaseInsensitive) == 0;
+  }
+
+  return wildcardMatches(normalizedTopic, trimmedPattern);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// matches
+//
+
+bool
+CMqttTopicFilter::matches(const QString& topic, const QString& segment, const CMqttHistory::message* v) const
+{
+  for (const QString& clause : m_clauses) {
+    if (clause.startsWith("qos=")) {
+      bool ok               = false;
+      const int expectedQos = clause.mid(4).trimmed().toInt(&ok);
+      if (!ok || (nullptr == v) || (v->m_qos != expectedQos)) {
+        return false;
+      }
+    }
+    else if (clause.startsWith("retain=") || clause.startsWith("bretain=")) {
+      const QString retainValue = clause.mid(clause.indexOf('=') + 1).trimmed();
+      if ((retainValue != "true") && (retainValue != "false")) {
+        return false;
+      }
+      if ((nullptr == v) || (v->m_retained != (retainValue == "true"))) {
+        return false;
+      }
+    }
+    else if (clause.startsWith("topic=")) {
+      QString topicPattern = clause.mid(6).trimmed();
+      if (topicPattern.startsWith('"') && topicPattern.endsWith('"') && topicPattern.size() >= 2) {
+        topicPattern = topicPattern.mid(1, topicPattern.size() - 2).trimmed();
+      }
+      if (!matchesPattern(topic, segment, topicPattern)) {
+        return false;
+      }
+    }
+    else {
+      if (topic.contains(clause, Qt::CaseInsensitive)) {
+        continue;
+      }
+      if ((nullptr == v) ||
+          !QString::fromUtf8(v->m_payload.data(), (int)v->m_payload.size()).contains(clause, Qt::CaseInsensitive)) {
+        return false;
+      }
+    }
+  }
+
+  return m_topicFilter.isEmpty() || matchesPattern(topic, segment, m_topicFilter);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// matchesPattern
+//
+
+bool
+CMqttTopicFilter::matchesPattern(const QString& topic, const QString& segment, const QString& pattern)
+{
+  // An MQTT pattern describes whole topics, '+' would match any segment
+  if (pattern.contains('+') || pattern.contains('#')) {
+    return matchesTopicFilter(topic, pattern);
+  }
+  return matchesTopicFilter(topic, pattern) || matchesTopicFilter(segment, pattern);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// matchesNode
+//
+
+bool
+CMqttTopicFilter::matchesNode(const CMqttTopicTrie& trie, uint32_t id, uint64_t fromSeq) const
+{
+  const QString topic   = QString::fromStdString(trie.getTopic(id));
+  const QString segment = QString::fromStdString(trie.getSegment(id));
+
+  const CMqttTopicTrie::node& n = trie.getNode(id);
+  if (!m_bUsesMessages || n.m_history.empty()) {
+    return matches(topic, segment, nullptr);
+  }
+
+  CMqttHistory::message msg;
+  for (uint64_t seq = std::max(fromSeq, n.m_firstSeq); seq < trie.getEndSeq(id); seq++) {
+    if (trie.getMessage(id, seq, msg) && matches(topic, segment, &msg)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// findTopics
+//
+
+void
+CMqttTopicFilter::findTopics(const CMqttTopicTrie& trie, std::vector<uint32_t>& ids) const
+{
+  if (!m_bMqttPattern) {
+    return;
+  }
+
+  // (node, pattern level to match its children against)
+  std::vector<std::pair<uint32_t, int>> stack;
+  stack.push_back(std::make_pair((uint32_t)CMqttTopicTrie::ROOT, 0));
+
+  while (stack.size()) {
+    uint32_t id = stack.back().first;
+    int level   = stack.back().second;
+    stack.pop_back();
+
+    if (level >= m_mqttLevels.size()) {
+      ids.push_back(id);
+      continue;
+    }
+
+    const QString& plevel = m_mqttLevels[level];
+    if ("#" == plevel) {
+      // The node itself and everything below it
+      std::vector<uint32_t> subtree;
+      if (CMqttTopicTrie::ROOT != id) {
+        subtree.push_back(id);
+      }
+      else {
+        subtree.insert(subtree.end(), trie.getNode(id).m_children.begin(), trie.getNode(id).m_children.end());
+      }
+      while (subtree.size()) {
+        uint32_t cur = subtree.back();
+        subtree.pop_back();
+        ids.push_back(cur);
+        const auto& children = trie.getNode(cur).m_children;
+        subtree.insert(subtree.end(), children.begin(), children.end());
+      }
+      continue;
+    }
+
+    for (auto child : trie.getNode(id).m_children) {
+      if ("+" == plevel) {
+        stack.push_back(std::make_pair(child, level + 1));
+        continue;
+      }
+
+      // Empty levels are stored as "/" in the trie
+      const std::string& segment = trie.getSegment(child);
+      const QString name         = ("/" == segment) ? QString() : QString::fromStdString(segment);
+      if (0 == name.compare(plevel, Qt::CaseInsensitive)) {
+        stack.push_back(std::make_pair(child, level + 1));
+      }
+    }
+  }
+}
@@ -0,0 +1,156 @@
+// mqtttopicfilter.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef MQTTTOPICFILTER_H
+#define MQTTTOPICFILTER_H
+
+#include "mqtttopictrie.h"
+
+#include <QString>
+#include <QStringList>
+
+#include <string>
+#include <vector>
+
+/*!
+  Filter for the MQTT explorer topic tree.
+
+  The filter text is a comma separated list of clauses that all must
+  match: plain text that is searched for in topic and payload, qos=n,
+  retain=true/false and topic=pattern. The topic filter is a pattern
+  that the topic must match. A pattern with '*' is a wildcard match, a
+  pattern with '+' or '#' is matched like an MQTT subscription and
+  anything else must match exactly. Patterns that are not MQTT style
+  also match if the last segment of the topic matches. All matching is
+  case insensitive.
+
+  An MQTT style topic filter can be resolved on the topic trie directly
+  with findTopics(), which only visits the branches that can match.
+*/
+
+class CMqttTopicFilter {
+
+public:
+  CMqttTopicFilter();
+  ~CMqttTopicFilter();
+
+  /*!
+    Set filter
+    @param filter Comma separated clauses
+    @param topicFilter Topic pattern
+  */
+  void set(const QString& filter, const QString& topicFilter);
+
+  /*!
+    Check if no filter is set
+    @return True if everything matches
+  */
+  bool isEmpty(void) const { return m_clauses.isEmpty() && m_topicFilter.isEmpty(); };
+
+  /*!
+    Check if the filter looks at messages (text, qos or retain clauses)
+    or only at topics
+    @return True if messages are used
+  */
+  bool usesMessages(void) const { return m_bUsesMessages; };
+
+  /*!
+    Check if the topic filter is an MQTT style pattern
+    @return True if findTopics() can be used
+  */
+  bool isMqttPattern(void) const { return m_bMqttPattern; };
+
+  /*!
+    Check a topic and optionally one of its messages
+    @param topic Full topic
+    @param segment Last segment of topic
+    @param v Message or nullptr to check the topic only
+    @return True if matched
+  */
+  bool matches(const QString& topic, const QString& segment, const CMqttHistory::message* v) const;
+
+  /*!
+    Check a node in a trie. If the filter uses messages the node
+    matches if one of its messages from fromSeq and on matches.
+    @param trie Trie with node
+    @param id Node id
+    @param fromSeq First message sequence number to check
+    @return True if matched
+  */
+  bool matchesNode(const CMqttTopicTrie& trie, uint32_t id, uint64_t fromSeq = 0) const;
+
+  /*!
+    Find the nodes that match an MQTT style topic filter
+    @param trie Trie to search
+    @param ids Matching node ids are appended to it
+  */
+  void findTopics(const CMqttTopicTrie& trie, std::vector<uint32_t>& ids) const;
+
+  /*!
+    Case insensitive match where '*' matches any number of characters
+    @param text Text to match
+    @param pattern Pattern
+    @return True if matched
+  */
+  static bool wildcardMatches(const QString& text, const QString& pattern);
+
+  /*!
+    Case insensitive match of a topic against an MQTT subscription
+    pattern where '+' matches one level and '#' the rest of the topic
+    @param topic Topic to match
+    @param pattern Pattern
+    @return True if matched
+  */
+  static bool mqttMatches(const QString& topic, const QString& pattern);
+
+  /*!
+    Match a topic against a topic filter pattern
+    @param topic Topic to match
+    @param pattern Pattern, see class description
+    @return True if matched
+  */
+  static bool matchesTopicFilter(const QString& topic, const QString& pattern);
+
+private:
+  /// Match a topic or, for other than MQTT patterns, its last segment
+  static bool matchesPattern(const QString& topic, const QString& segment, const QString& pattern);
+
+  /// Lower case clauses
+  QStringList m_clauses;
+
+  /// Lower case topic filter
+  QString m_topicFilter;
+
+  /// Topic filter split on '/' if it is an MQTT style pattern
+  QStringList m_mqttLevels;
+
+  bool m_bMqttPattern;
+  bool m_bUsesMessages;
+};
+
+#endif // MQTTTOPICFILTER_H
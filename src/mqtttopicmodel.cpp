@@ -0,0 +1,1085 @@
+// mqtttopicmodel.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include "mqtttopicmodel.h"
+
+#include <QColor>
+#include <QDateTime>
+
+#include <algorithm>
+#include <cmath>
+
+// Share of the total message rate below which a row is not shaded
+#define HEAT_MIN_SHARE 0.01
+
+///////////////////////////////////////////////////////////////////////////////
+// formatBytes
+//
+
+static QString
+formatBytes(double bytes)
+{
+  if (bytes < 1024) {
+    return QString("%1 B").arg(bytes, 0, 'f', 0);
+  }
+  if (bytes < 1024 * 1024) {
+    return QString("%1 KB").arg(bytes / 1024, 0, 'f', 1);
+  }
+  return QString("%1 MB").arg(bytes / (1024 * 1024), 0, 'f', 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// formatAge
+//
+
+static QString
+formatAge(int64_t ms)
+{
+  if (ms < 10000) {
+    return QString("%1 s").arg((double)std::max(ms, (int64_t)0) / 1000, 0, 'f', 1);
+  }
+  if (ms < 120000) {
+    return QString("%1 s").arg(ms / 1000);
+  }
+  if (ms < 7200000) {
+    return QString("%1 min").arg(ms / 60000);
+  }
+  return QString("%1 h").arg(ms / 3600000);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttTopicModel::CMqttTopicModel(QObject* parent)
+  : QAbstractItemModel(parent)
+  , m_filterWorker(m_trie, m_trieMutex)
+{
+  m_bHistory       = true;
+  m_bFiltered      = false;
+  m_bFilterPending = false;
+  m_filterJob      = 0;
+  m_sortColumn     = -1;
+  m_sortOrder      = Qt::AscendingOrder;
+  m_bHeatmap       = false;
+
+  nodestate root = {};
+  root.m_visible = true;
+  m_state.push_back(root);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttTopicModel::~CMqttTopicModel()
+{
+  m_filterWorker.stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// topicIndex
+//
+
+QModelIndex
+CMqttTopicModel::topicIndex(uint32_t id, int column) const
+{
+  if ((CMqttTopicTrie::ROOT == id) || (CMqttTopicTrie::NONE == id) || !m_state[id].m_bExposed) {
+    return QModelIndex();
+  }
+  return createIndex(m_state[id].m_row, column, (quintptr)id << 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// parentId
+//
+
+uint32_t
+CMqttTopicModel::parentId(const QModelIndex& parent) const
+{
+  if (!parent.isValid()) {
+    return CMqttTopicTrie::ROOT;
+  }
+  return (uint32_t)(parent.internalId() >> 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// isMessage
+//
+
+bool
+CMqttTopicModel::isMessage(const QModelIndex& index) const
+{
+  return index.isValid() && (index.internalId() & 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getNodeId
+//
+
+uint32_t
+CMqttTopicModel::getNodeId(const QModelIndex& index) const
+{
+  if (!index.isValid()) {
+    return CMqttTopicTrie::NONE;
+  }
+  return (uint32_t)(index.internalId() >> 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// index
+//
+
+QModelIndex
+CMqttTopicModel::index(int row, int column, const QModelIndex& parent) const
+{
+  if ((row < 0) || (column < 0) || (column >= COL_COUNT)) {
+    return QModelIndex();
+  }
+
+  if (parent.isValid() && (isMessage(parent) || (parent.column() != 0))) {
+    return QModelIndex();
+  }
+
+  uint32_t pid           = parentId(parent);
+  const nodestate& state = m_state[pid];
+  if ((size_t)row < state.m_rows.size()) {
+    return createIndex(row, column, (quintptr)state.m_rows[row] << 1);
+  }
+  if ((size_t)row < (state.m_rows.size() + state.m_messages.size())) {
+    return createIndex(row, column, ((quintptr)pid << 1) | 1);
+  }
+
+  return QModelIndex();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// parent
+//
+
+QModelIndex
+CMqttTopicModel::parent(const QModelIndex& index) const
+{
+  if (!index.isValid()) {
+    return QModelIndex();
+  }
+
+  uint32_t id = getNodeId(index);
+  if (isMessage(index)) {
+    return topicIndex(id);
+  }
+  return topicIndex(m_trie.getNode(id).m_parent);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// rowCount
+//
+
+int
+CMqttTopicModel::rowCount(const QModelIndex& parent) const
+{
+  if (parent.isValid() && (isMessage(parent) || (parent.column() != 0))) {
+    return 0;
+  }
+
+  const nodestate& state = m_state[parentId(parent)];
+  return (int)(state.m_rows.size() + state.m_messages.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// columnCount
+//
+
+int
+CMqttTopicModel::columnCount(const QModelIndex& /*parent*/) const
+{
+  return COL_COUNT;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// hasChildren
+//
+
+bool
+CMqttTopicModel::hasChildren(const QModelIndex& parent) const
+{
+  if (parent.isValid() && (isMessage(parent) || (parent.column() != 0))) {
+    return false;
+  }
+
+  uint32_t id                 = parentId(parent);
+  const nodestate& state      = m_state[id];
+  const CMqttTopicTrie::node& n = m_trie.getNode(id);
+  return !state.m_rows.empty() || !state.m_messages.empty() || !n.m_children.empty() ||
+         (m_bHistory && !n.m_history.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// canFetchMore
+//
+
+bool
+CMqttTopicModel::canFetchMore(const QModelIndex& parent) const
+{
+  if (parent.isValid() && (isMessage(parent) || (parent.column() != 0))) {
+    return false;
+  }
+
+  uint32_t id                   = parentId(parent);
+  const nodestate& state        = m_state[id];
+  const CMqttTopicTrie::node& n = m_trie.getNode(id);
+  return (state.m_cursor < n.m_children.size()) || !state.m_bMessagesFetched;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fetchMore
+//
+
+void
+CMqttTopicModel::fetchMore(const QModelIndex& parent)
+{
+  if (!canFetchMore(parent)) {
+    return;
+  }
+
+  uint32_t id                   = parentId(parent);
+  nodestate& state              = m_state[id];
+  const CMqttTopicTrie::node& n = m_trie.getNode(id);
+  state.m_bFetched              = true;
+
+  std::vector<uint32_t> batch;
+  while ((state.m_cursor < n.m_children.size()) && (batch.size() < (size_t)FETCH_BATCH)) {
+    uint32_t child = n.m_children[state.m_cursor++];
+    if (m_state[child].m_visible && !m_state[child].m_bExposed) {
+      batch.push_back(child);
+    }
+  }
+
+  if (batch.size()) {
+    int first = (int)state.m_rows.size();
+    beginInsertRows(parent, first, first + (int)batch.size() - 1);
+    for (auto child : batch) {
+      m_state[child].m_row      = (uint32_t)state.m_rows.size();
+      m_state[child].m_bExposed = true;
+      state.m_rows.push_back(child);
+    }
+    endInsertRows();
+  }
+
+  // Messages follow the child topics
+  if ((state.m_cursor >= n.m_children.size()) && !state.m_bMessagesFetched) {
+    state.m_bMessagesFetched = true;
+    state.m_nextSeq          = n.m_firstSeq;
+    updateMessageRows(id, m_bHistory);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// preview
+//
+
+QString
+CMqttTopicModel::preview(const CMqttHistory::message& msg) const
+{
+  const std::string_view& payload = msg.m_payload;
+  if (CMqttHistory::FORMAT_BINARY == msg.m_format) {
+    return tr("<binary, %1 bytes>").arg((qulonglong)payload.size());
+  }
+
+  // Only the start is shown so there is no need to convert all of it
+  QString text = QString::fromUtf8(payload.data(), (int)std::min(payload.size(), (size_t)512));
+  text.replace('\n', " ");
+  text.replace('\r', " ");
+  text = text.trimmed();
+  if (text.size() > 140) {
+    text = text.left(137) + "...";
+  }
+  return text.isEmpty() ? tr("<empty>") : text;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// data
+//
+
+QVariant
+CMqttTopicModel::data(const QModelIndex& index, int role) const
+{
+  if (!index.isValid()) {
+    return QVariant();
+  }
+
+  uint32_t id = getNodeId(index);
+
+  CMqttHistory::message msg;
+  const CMqttHistory::message* v = getMessage(index, msg) ? &msg : nullptr;
+
+  if (isMessage(index)) {
+    if (index.column() > COL_DATA) {
+      return QVariant();
+    }
+
+    switch (role) {
+      case Qt::DisplayRole:
+        if (COL_TOPIC == index.column()) {
+          QString topic = QString::fromStdString(m_trie.getTopic(id));
+          return topic.isEmpty() ? tr("<empty>") : topic;
+        }
+        return (nullptr != v) ? preview(*v) : QString();
+
+      case Qt::ForegroundRole:
+        if (COL_TOPIC == index.column()) {
+          return QColor(((nullptr != v) && v->m_retained) ? "#7c3aed" : "#0f766e");
+        }
+        return QColor("#16a34a");
+
+      case Qt::ToolTipRole:
+        return QString::fromStdString(m_trie.getTopic(id));
+
+      default:
+        return QVariant();
+    }
+  }
+
+  if (m_bHeatmap && (Qt::BackgroundRole == role)) {
+    int64_t now  = QDateTime::currentMSecsSinceEpoch();
+    double total = m_trie.getNode(CMqttTopicTrie::ROOT).m_subtreeStats.getRate(CMqttTopicStats::WINDOW_10S, now);
+    double share =
+      (total > 0) ? m_trie.getNode(id).m_subtreeStats.getRate(CMqttTopicStats::WINDOW_10S, now) / total : 0;
+    if (share >= HEAT_MIN_SHARE) {
+      // Pale orange to red, the square root makes small shares visible
+      double t = std::sqrt(std::min(share, 1.0));
+      return QColor((int)(255 - 35 * t), (int)(237 - 199 * t), (int)(213 - 175 * t));
+    }
+  }
+
+  if (index.column() > COL_DATA) {
+    return statsData(id, index.column(), role);
+  }
+
+  switch (role) {
+    case Qt::DisplayRole:
+      if (COL_TOPIC == index.column()) {
+        QString label = QString::fromStdString(m_trie.getSegment(id));
+        if (m_state[id].m_highlight > QDateTime::currentMSecsSinceEpoch()) {
+          label = QStringLiteral("● %1").arg(label);
+        }
+        return label;
+      }
+      return (nullptr != v) ? preview(*v) : QString();
+
+    case Qt::ForegroundRole:
+      return QColor((COL_TOPIC == index.column()) ? "#2563eb" : "#64748b");
+
+    case Qt::BackgroundRole:
+      if (nullptr == v) {
+        return QVariant();
+      }
+      return QColor((COL_TOPIC == index.column()) ? "#eff6ff" : "#f5f3ff");
+
+    case Qt::ToolTipRole:
+      return QString::fromStdString(m_trie.getTopic(id));
+
+    default:
+      return QVariant();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// headerData
+//
+
+QVariant
+CMqttTopicModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if ((Qt::Horizontal != orientation) || (Qt::DisplayRole != role)) {
+    return QVariant();
+  }
+
+  switch (section) {
+    case COL_TOPIC:
+      return tr("Topic/Message");
+    case COL_DATA:
+      return tr("Message data");
+    case COL_RATE_1S:
+      return tr("Msg/s 1s");
+    case COL_RATE_10S:
+      return tr("Msg/s 10s");
+    case COL_RATE_60S:
+      return tr("Msg/s 60s");
+    case COL_BYTE_RATE:
+      return tr("Bytes/s");
+    case COL_SIZE:
+      return tr("Size p50/p95");
+    case COL_AGE:
+      return tr("Age");
+    default:
+      return QVariant();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// statsData
+//
+
+QVariant
+CMqttTopicModel::statsData(uint32_t id, int column, int role) const
+{
+  const CMqttTopicTrie::node& n = m_trie.getNode(id);
+  const CMqttTopicStats& stats  = n.m_subtreeStats;
+  int64_t now                   = QDateTime::currentMSecsSinceEpoch();
+
+  switch (role) {
+    case Qt::DisplayRole:
+      if (!stats.getCount()) {
+        return QString();
+      }
+      switch (column) {
+        case COL_RATE_1S:
+          return QString::number(stats.getRate(CMqttTopicStats::WINDOW_1S, now), 'f', 1);
+        case COL_RATE_10S:
+          return QString::number(stats.getRate(CMqttTopicStats::WINDOW_10S, now), 'f', 1);
+        case COL_RATE_60S:
+          return QString::number(stats.getRate(CMqttTopicStats::WINDOW_60S, now), 'f', 1);
+        case COL_BYTE_RATE:
+          return formatBytes(stats.getByteRate(CMqttTopicStats::WINDOW_10S, now)) + "/s";
+        case COL_SIZE:
+          return QString("%1 / %2")
+            .arg(formatBytes((double)stats.getSizePercentile(50)))
+            .arg(formatBytes((double)stats.getSizePercentile(95)));
+        case COL_AGE:
+          return formatAge(now - stats.getLastTime());
+        default:
+          return QVariant();
+      }
+
+    case Qt::TextAlignmentRole:
+      return (int)(Qt::AlignRight | Qt::AlignVCenter);
+
+    case Qt::ForegroundRole:
+      return QColor("#475569");
+
+    case Qt::ToolTipRole: {
+      if (!stats.getCount()) {
+        return QVariant();
+      }
+      QString tip;
+      const CMqttTopicStats* parts[] = { &n.m_stats, &stats };
+      const QString names[]          = { tr("Topic"), tr("Topic and below") };
+      for (int i = 0; i < 2; i++) {
+        const CMqttTopicStats* p = parts[i];
+        if (!p->getCount()) {
+          continue;
+        }
+        if (!tip.isEmpty()) {
+          tip += "\n\n";
+        }
+        tip += tr("%1: %2 messages, %3").arg(names[i]).arg((qulonglong)p->getCount()).arg(formatBytes((double)p->getBytes()));
+        tip += tr("\nMsg/s: %1 (1s) %2 (10s) %3 (60s)")
+                 .arg(p->getRate(CMqttTopicStats::WINDOW_1S, now), 0, 'f', 1)
+                 .arg(p->getRate(CMqttTopicStats::WINDOW_10S, now), 0, 'f', 1)
+                 .arg(p->getRate(CMqttTopicStats::WINDOW_60S, now), 0, 'f', 1);
+        tip += tr("\nBytes/s: %1 (1s) %2 (10s) %3 (60s)")
+                 .arg(formatBytes(p->getByteRate(CMqttTopicStats::WINDOW_1S, now)))
+                 .arg(formatBytes(p->getByteRate(CMqttTopicStats::WINDOW_10S, now)))
+                 .arg(formatBytes(p->getByteRate(CMqttTopicStats::WINDOW_60S, now)));
+        tip += tr("\nPayload size p50/p95/max: %1 / %2 / %3")
+                 .arg(formatBytes((double)p->getSizePercentile(50)))
+                 .arg(formatBytes((double)p->getSizePercentile(95)))
+                 .arg(formatBytes((double)p->getMaxSize()));
+      }
+      return tip;
+    }
+
+    default:
+      return QVariant();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sort
+//
+
+void
+CMqttTopicModel::sort(int column, Qt::SortOrder order)
+{
+  // The preview column has no useful order
+  m_sortColumn = (COL_DATA == column) ? -1 : column;
+  m_sortOrder  = order;
+  sortRows();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// lessThan
+//
+
+bool
+CMqttTopicModel::lessThan(uint32_t a, uint32_t b, int64_t now) const
+{
+  const CMqttTopicStats& sa = m_trie.getNode(a).m_subtreeStats;
+  const CMqttTopicStats& sb = m_trie.getNode(b).m_subtreeStats;
+
+  double ka;
+  double kb;
+  switch (m_sortColumn) {
+    case COL_TOPIC: {
+      int rv = m_trie.getSegment(a).compare(m_trie.getSegment(b));
+      return (Qt::AscendingOrder == m_sortOrder) ? (rv < 0) : (rv > 0);
+    }
+    case COL_RATE_1S:
+      ka = sa.getRate(CMqttTopicStats::WINDOW_1S, now);
+      kb = sb.getRate(CMqttTopicStats::WINDOW_1S, now);
+      break;
+    case COL_RATE_10S:
+      ka = sa.getRate(CMqttTopicStats::WINDOW_10S, now);
+      kb = sb.getRate(CMqttTopicStats::WINDOW_10S, now);
+      break;
+    case COL_RATE_60S:
+      ka = sa.getRate(CMqttTopicStats::WINDOW_60S, now);
+      kb = sb.getRate(CMqttTopicStats::WINDOW_60S, now);
+      break;
+    case COL_BYTE_RATE:
+      ka = sa.getByteRate(CMqttTopicStats::WINDOW_10S, now);
+      kb = sb.getByteRate(CMqttTopicStats::WINDOW_10S, now);
+      break;
+    case COL_SIZE:
+      ka = (double)sa.getSizePercentile(95);
+      kb = (double)sb.getSizePercentile(95);
+      break;
+    case COL_AGE:
+      // Topics without messages are the oldest
+      ka = sa.getLastTime() ? (double)(now - sa.getLastTime()) : HUGE_VAL;
+      kb = sb.getLastTime() ? (double)(now - sb.getLastTime()) : HUGE_VAL;
+      break;
+    default:
+      return m_state[a].m_childPos < m_state[b].m_childPos;
+  }
+
+  return (Qt::AscendingOrder == m_sortOrder) ? (ka < kb) : (kb < ka);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sortRows
+//
+
+void
+CMqttTopicModel::sortRows(void)
+{
+  int64_t now = QDateTime::currentMSecsSinceEpoch();
+
+  emit layoutAboutToBeChanged();
+  const QModelIndexList from = persistentIndexList();
+
+  for (auto& state : m_state) {
+    if (state.m_rows.size() < 2) {
+      continue;
+    }
+    std::stable_sort(state.m_rows.begin(), state.m_rows.end(), [this, now](uint32_t a, uint32_t b) {
+      return lessThan(a, b, now);
+    });
+    for (uint32_t row = 0; row < state.m_rows.size(); row++) {
+      m_state[state.m_rows[row]].m_row = row;
+    }
+  }
+
+  // Message rows follow the topic rows and keep their row
+  QModelIndexList to;
+  to.reserve(from.size());
+  for (const auto& index : from) {
+    to.append(isMessage(index) ? index : topicIndex(getNodeId(index), index.column()));
+  }
+  changePersistentIndexList(from, to);
+
+  emit layoutChanged();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// refreshStats
+//
+
+void
+CMqttTopicModel::refreshStats(void)
+{
+  if ((m_sortColumn >= 0) && m_state[CMqttTopicTrie::ROOT].m_rows.size()) {
+    sortRows();
+  }
+
+  // The heat map shades all columns
+  int first = m_bHeatmap ? (int)COL_TOPIC : (int)COL_RATE_1S;
+  for (uint32_t id = 0; id < m_state.size(); id++) {
+    const nodestate& state = m_state[id];
+    if (state.m_rows.empty()) {
+      continue;
+    }
+    QModelIndex parent = topicIndex(id);
+    emit dataChanged(index(0, first, parent), index((int)state.m_rows.size() - 1, COL_AGE, parent));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setHeatmap
+//
+
+void
+CMqttTopicModel::setHeatmap(bool bHeatmap)
+{
+  if (m_bHeatmap == bHeatmap) {
+    return;
+  }
+  m_bHeatmap = bHeatmap;
+  refreshStats();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getMessage
+//
+
+bool
+CMqttTopicModel::getMessage(const QModelIndex& index, CMqttHistory::message& msg, uint64_t* seq) const
+{
+  uint32_t id = getNodeId(index);
+  if (CMqttTopicTrie::NONE == id) {
+    return false;
+  }
+
+  uint64_t msgSeq;
+  if (!isMessage(index)) {
+    msgSeq = m_trie.getEndSeq(id) - 1;
+  }
+  else {
+    const nodestate& state = m_state[id];
+    size_t pos             = index.row() - state.m_rows.size();
+    if (pos >= state.m_messages.size()) {
+      return false;
+    }
+    msgSeq = state.m_messages[pos];
+  }
+
+  if (nullptr != seq) {
+    *seq = msgSeq;
+  }
+  return m_trie.getMessage(id, msgSeq, msg);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getTopic
+//
+
+QString
+CMqttTopicModel::getTopic(const QModelIndex& index) const
+{
+  uint32_t id = getNodeId(index);
+  if (CMqttTopicTrie::NONE == id) {
+    return QString();
+  }
+  return QString::fromStdString(m_trie.getTopic(id));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// indexForNode
+//
+
+QModelIndex
+CMqttTopicModel::indexForNode(uint32_t id)
+{
+  if ((id >= m_state.size()) || (CMqttTopicTrie::ROOT == id) || !m_state[id].m_visible) {
+    return QModelIndex();
+  }
+
+  std::vector<uint32_t> path;
+  for (uint32_t cur = id; CMqttTopicTrie::ROOT != cur; cur = m_trie.getNode(cur).m_parent) {
+    path.push_back(cur);
+  }
+
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+    QModelIndex parent = topicIndex(m_trie.getNode(*it).m_parent);
+    while (!m_state[*it].m_bExposed) {
+      if (!canFetchMore(parent)) {
+        return QModelIndex();
+      }
+      fetchMore(parent);
+    }
+  }
+
+  return topicIndex(id);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getExposedNodes
+//
+
+std::vector<uint32_t>
+CMqttTopicModel::getExposedNodes(void) const
+{
+  // Children always has a higher id than their parent
+  std::vector<uint32_t> nodes;
+  for (uint32_t id = 1; id < m_state.size(); id++) {
+    if (m_state[id].m_bExposed) {
+      nodes.push_back(id);
+    }
+  }
+  return nodes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// exposeIfFetched
+//
+
+void
+CMqttTopicModel::exposeIfFetched(uint32_t id)
+{
+  nodestate& state = m_state[id];
+  if (state.m_bExposed || !state.m_visible) {
+    return;
+  }
+
+  // If the view has not populated the parent up to this child it will
+  // be picked up by fetchMore()
+  uint32_t pid      = m_trie.getNode(id).m_parent;
+  nodestate& pstate = m_state[pid];
+  if (!pstate.m_bFetched || (state.m_childPos > pstate.m_cursor)) {
+    return;
+  }
+
+  int row = (int)pstate.m_rows.size();
+  beginInsertRows(topicIndex(pid), row, row);
+  state.m_row      = row;
+  state.m_bExposed = true;
+  pstate.m_rows.push_back(id);
+  if (state.m_childPos == pstate.m_cursor) {
+    pstate.m_cursor++;
+  }
+  endInsertRows();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// updateMessageRows
+//
+
+void
+CMqttTopicModel::updateMessageRows(uint32_t id, bool bHistory)
+{
+  nodestate& state              = m_state[id];
+  const CMqttTopicTrie::node& n = m_trie.getNode(id);
+  uint64_t end                  = m_trie.getEndSeq(id);
+  if (!state.m_bMessagesFetched) {
+    return;
+  }
+
+  QModelIndex parent = topicIndex(id);
+  int base           = (int)state.m_rows.size();
+
+  // Remove rows for messages that are no longer kept
+  size_t drop = 0;
+  if (!bHistory) {
+    drop = state.m_messages.size();
+  }
+  else {
+    while ((drop < state.m_messages.size()) && (state.m_messages[drop] < n.m_firstSeq)) {
+      drop++;
+    }
+  }
+
+  if (drop) {
+    beginRemoveRows(parent, base, base + (int)drop - 1);
+    state.m_messages.erase(state.m_messages.begin(), state.m_messages.begin() + drop);
+    endRemoveRows();
+  }
+
+  uint64_t seq    = std::max(state.m_nextSeq, n.m_firstSeq);
+  state.m_nextSeq = end;
+  if (!bHistory) {
+    return;
+  }
+
+  std::vector<uint64_t> add;
+  QString topic;
+  QString segment;
+  if (m_bFiltered) {
+    topic   = QString::fromStdString(m_trie.getTopic(id));
+    segment = QString::fromStdString(m_trie.getSegment(id));
+  }
+  CMqttHistory::message msg;
+  for (; seq < end; seq++) {
+    if (!m_bFiltered || (m_trie.getMessage(id, seq, msg) && m_filter.matches(topic, segment, &msg))) {
+      add.push_back(seq);
+    }
+  }
+
+  if (add.size()) {
+    int first = base + (int)state.m_messages.size();
+    beginInsertRows(parent, first, first + (int)add.size() - 1);
+    state.m_messages.insert(state.m_messages.end(), add.begin(), add.end());
+    endInsertRows();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// markVisible
+//
+
+void
+CMqttTopicModel::markVisible(uint32_t id, std::vector<uint32_t>& changed)
+{
+  for (uint32_t cur = id; (CMqttTopicTrie::NONE != cur) && !m_state[cur].m_visible;
+       cur          = m_trie.getNode(cur).m_parent) {
+    m_state[cur].m_visible = true;
+    changed.push_back(cur);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// update
+//
+
+uint32_t
+CMqttTopicModel::update(const std::string& topic,
+                        uint64_t count,
+                        uint64_t bytes,
+                        std::deque<CMqttTopicTrie::value>& values,
+                        bool bHistory)
+{
+  std::vector<uint32_t> created;
+  std::vector<uint32_t> trimmed;
+  uint32_t id;
+  uint64_t oldEnd;
+  {
+    // The filter worker may be reading the trie
+    std::lock_guard<std::mutex> lock(m_trieMutex);
+    id     = m_trie.insert(topic, &created);
+    oldEnd = m_trie.getEndSeq(id);
+    m_trie.addMessages(id, count, bytes, values, bHistory ? (size_t)MAX_HISTORY : 1, &trimmed);
+  }
+
+  for (auto child : created) {
+    nodestate state   = {};
+    state.m_childPos  = (uint32_t)(m_trie.getNode(m_trie.getNode(child).m_parent).m_children.size() - 1);
+    state.m_visible   = !m_bFiltered;
+    m_state.push_back(state);
+  }
+
+  m_bHistory = bHistory;
+
+  // Checked again when the pending filter result is applied
+  if (m_bFilterPending) {
+    m_filterDirty.push_back(id);
+  }
+
+  if (m_bFiltered) {
+    // New messages can only make more of the tree visible
+    if (!m_state[id].m_visible) {
+      if (m_filter.matchesNode(m_trie, id, oldEnd)) {
+        std::vector<uint32_t> changed;
+        markVisible(id, changed);
+        for (auto it = changed.rbegin(); it != changed.rend(); ++it) {
+          exposeIfFetched(*it);
+        }
+      }
+    }
+  }
+  else {
+    // Parents before children
+    for (auto child : created) {
+      exposeIfFetched(child);
+    }
+  }
+
+  updateMessageRows(id, bHistory);
+  updateTrimmed(trimmed);
+
+  int64_t until            = QDateTime::currentMSecsSinceEpoch() + HIGHLIGHT_TIME;
+  m_state[id].m_highlight = until;
+  m_highlights.push_back(std::make_pair(id, until));
+
+  if (m_state[id].m_bExposed) {
+    emit dataChanged(topicIndex(id, COL_TOPIC), topicIndex(id, COL_DATA));
+  }
+
+  return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setBudget
+//
+
+void
+CMqttTopicModel::setBudget(size_t budget)
+{
+  std::vector<uint32_t> trimmed;
+  {
+    std::lock_guard<std::mutex> lock(m_trieMutex);
+    m_trie.setBudget(budget, &trimmed);
+  }
+  updateTrimmed(trimmed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// updateTrimmed
+//
+
+void
+CMqttTopicModel::updateTrimmed(const std::vector<uint32_t>& trimmed)
+{
+  for (auto id : trimmed) {
+    updateMessageRows(id, m_bHistory);
+    if (m_state[id].m_bExposed) {
+      emit dataChanged(topicIndex(id, COL_DATA), topicIndex(id, COL_DATA));
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// expireHighlights
+//
+
+void
+CMqttTopicModel::expireHighlights(void)
+{
+  int64_t now = QDateTime::currentMSecsSinceEpoch();
+  while (m_highlights.size() && (m_highlights.front().second <= now)) {
+    uint32_t id = m_highlights.front().first;
+    m_highlights.pop_front();
+    // Changed again after this entry was added
+    if (m_state[id].m_highlight > now) {
+      continue;
+    }
+    if (m_state[id].m_bExposed) {
+      QModelIndex idx = topicIndex(id, COL_TOPIC);
+      emit dataChanged(idx, idx);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// isVisible
+//
+
+bool
+CMqttTopicModel::isVisible(uint32_t id, const CMqttHistory::message& v) const
+{
+  return m_filter.matches(QString::fromStdString(m_trie.getTopic(id)),
+                          QString::fromStdString(m_trie.getSegment(id)),
+                          &v);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setFilter
+//
+
+void
+CMqttTopicModel::setFilter(const QString& filter, const QString& topicFilter)
+{
+  CMqttTopicFilter newFilter;
+  newFilter.set(filter, topicFilter);
+
+  if (newFilter.isEmpty()) {
+    m_filterWorker.cancel();
+    m_bFilterPending = false;
+    m_filterDirty.clear();
+    applyFilter(newFilter, nullptr);
+    return;
+  }
+
+  if (!m_filterWorker.isRunning()) {
+    m_filterWorker.start([this]() {
+      QMetaObject::invokeMethod(this, [this]() { applyFilterResult(); }, Qt::QueuedConnection);
+    });
+  }
+
+  m_bFilterPending = true;
+  m_filterDirty.clear();
+  m_filterJob = m_filterWorker.request(newFilter);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// applyFilterResult
+//
+
+void
+CMqttTopicModel::applyFilterResult(void)
+{
+  CMqttFilterWorker::result res;
+  if (!m_bFilterPending || !m_filterWorker.takeResult(res) || (res.m_job != m_filterJob)) {
+    return;
+  }
+
+  m_bFilterPending = false;
+  applyFilter(res.m_filter, &res);
+  m_filterDirty.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// applyFilter
+//
+
+void
+CMqttTopicModel::applyFilter(const CMqttTopicFilter& filter, const CMqttFilterWorker::result* res)
+{
+  beginResetModel();
+
+  m_filter    = filter;
+  m_bFiltered = !m_filter.isEmpty();
+
+  for (auto& state : m_state) {
+    state.m_row              = 0;
+    state.m_cursor           = 0;
+    state.m_nextSeq          = 0;
+    state.m_bExposed         = false;
+    state.m_bFetched         = false;
+    state.m_bMessagesFetched = false;
+    state.m_visible          = !m_bFiltered;
+    state.m_rows.clear();
+    state.m_messages.clear();
+  }
+  m_state[CMqttTopicTrie::ROOT].m_visible = true;
+
+  if (m_bFiltered && (nullptr != res)) {
+    for (uint32_t id = 0; id < res->m_nodeCount; id++) {
+      m_state[id].m_visible = (0 != res->m_visible[id]);
+    }
+
+    // Nodes that was added or changed while the worker was busy
+    std::vector<uint32_t> changed;
+    for (uint32_t id = res->m_nodeCount; id < m_state.size(); id++) {
+      if (m_filter.matchesNode(m_trie, id)) {
+        markVisible(id, changed);
+      }
+    }
+    for (auto id : m_filterDirty) {
+      if (!m_state[id].m_visible && m_filter.matchesNode(m_trie, id)) {
+        markVisible(id, changed);
+      }
+    }
+  }
+
+  endResetModel();
+}
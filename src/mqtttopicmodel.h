@@ -0,0 +1,328 @@
+// mqtttopicmodel.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MQTTTOPICMODEL_H
+#define MQTTTOPICMODEL_H
+
+#include "mqttfilterworker.h"
+#include "mqtttopicfilter.h"
+#include "mqtttopictrie.h"
+
+#include <QAbstractItemModel>
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*!
+  Item model for the MQTT explorer topic tree.
+
+  Rows are topic segments from a CMqttTopicTrie followed by the messages
+  kept for the topic. Children are populated lazily: nothing below a
+  node is handed to the view before the view asks for it with
+  fetchMore(), and large child lists are handed over in batches. A new
+  topic under a node the view has populated is inserted as a row, all
+  other updates only touch the trie so the cost of a message does not
+  depend on how many topics there are.
+
+  The filter is evaluated on the trie and only nodes that match, or has
+  a matching node below them, are exposed as rows. A filter is
+  evaluated by a CMqttFilterWorker and the rows are rebuilt with a
+  model reset when the result is in. Until then the previous filter
+  stays in effect.
+
+  Topic rows show the rolling traffic statistics kept by the trie for
+  the subtree below the topic. The statistics columns can be sorted on
+  and the rows can be shaded by their share of the total message rate
+  so the busiest parts of the tree stand out.
+*/
+
+class CMqttTopicModel : public QAbstractItemModel {
+  Q_OBJECT
+
+public:
+  /// Columns
+  enum { COL_TOPIC = 0,
+         COL_DATA,
+         COL_RATE_1S,   // Messages/s over 1 s
+         COL_RATE_10S,  // Messages/s over 10 s
+         COL_RATE_60S,  // Messages/s over 60 s
+         COL_BYTE_RATE, // Bytes/s over 10 s
+         COL_SIZE,      // Payload size p50/p95
+         COL_AGE,       // Time since last message
+         COL_COUNT };
+
+  /// Child rows handed to the view in one fetchMore()
+  static const int FETCH_BATCH = 256;
+
+  /// Max messages kept per topic when history is enabled
+  static const size_t MAX_HISTORY = 250;
+
+  /// Time in ms a changed topic is marked
+  static const int HIGHLIGHT_TIME = 1200;
+
+  explicit CMqttTopicModel(QObject* parent = nullptr);
+  ~CMqttTopicModel();
+
+  QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+  QModelIndex parent(const QModelIndex& index) const override;
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+  void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+  /*!
+    Add messages for a topic
+    @param topic Topic the messages was received on
+    @param count Number of messages received since last update
+    @param bytes Payload bytes received since last update
+    @param values Latest messages, oldest first. Moved into the trie.
+    @param bHistory If true keep up to MAX_HISTORY messages and show
+                    them as rows, if false keep only the latest.
+    @return Node id for topic
+  */
+  uint32_t update(const std::string& topic,
+                  uint64_t count,
+                  uint64_t bytes,
+                  std::deque<CMqttTopicTrie::value>& values,
+                  bool bHistory);
+
+  /*!
+    Set max memory for message history of all topics. Rows for messages
+    that are dropped to meet the budget are removed.
+    @param budget Budget in bytes
+  */
+  void setBudget(size_t budget);
+
+  /*!
+    Remove marks from topics that changed more than HIGHLIGHT_TIME ago
+  */
+  void expireHighlights(void);
+
+  /*!
+    Refresh the statistics columns. Rates decay when nothing is received
+    so this should be called periodically. Rows are sorted again if
+    they are sorted on a column.
+  */
+  void refreshStats(void);
+
+  /*!
+    Shade topic rows by their share of the total message rate
+    @param bHeatmap True to shade rows
+  */
+  void setHeatmap(bool bHeatmap);
+
+  /*!
+    Check if rows are shaded by message rate
+    @return True if shaded
+  */
+  bool isHeatmap(void) const { return m_bHeatmap; };
+
+  /*!
+    Set filter. The filter is evaluated on a worker thread and rows
+    are rebuilt from the result when it is ready. Clearing the filter
+    takes effect at once.
+    @param filter Comma separated clauses: text, qos=n,
+                  retain=true/false, topic=pattern
+    @param topicFilter Topic pattern, see CMqttTopicFilter
+  */
+  void setFilter(const QString& filter, const QString& topicFilter);
+
+  /*!
+    Check if a filter is set
+    @return True if a filter is set
+  */
+  bool isFiltered(void) const { return m_bFiltered; };
+
+  /*!
+    Check if a filter is being evaluated
+    @return True if a filter result is pending
+  */
+  bool isFilterPending(void) const { return m_bFilterPending; };
+
+  /*!
+    Check if a node passes the filter
+    @param id Node id
+    @return True if visible
+  */
+  bool isVisible(uint32_t id) const { return m_state[id].m_visible; };
+
+  /*!
+    Check if a message passes the filter
+    @param id Node id for topic
+    @param v Message
+    @return True if visible
+  */
+  bool isVisible(uint32_t id, const CMqttHistory::message& v) const;
+
+  /*!
+    Check if an index is a message row
+    @param index Index to check
+    @return True if message row
+  */
+  bool isMessage(const QModelIndex& index) const;
+
+  /*!
+    Get topic node for an index. For a message row this is the topic
+    the message was received on.
+    @param index Index
+    @return Node id or CMqttTopicTrie::NONE
+  */
+  uint32_t getNodeId(const QModelIndex& index) const;
+
+  /*!
+    Get message for an index
+    @param index Index
+    @param msg Filled with the message for a message row or the latest
+               message for a topic row.
+    @param seq If not nullptr set to the sequence number of the message
+    @return True on success, false if there is no message.
+  */
+  bool getMessage(const QModelIndex& index, CMqttHistory::message& msg, uint64_t* seq = nullptr) const;
+
+  /*!
+    Get full topic for an index
+    @param index Index
+    @return Topic
+  */
+  QString getTopic(const QModelIndex& index) const;
+
+  /*!
+    Get the index for a node. Rows above it are populated as needed.
+    @param id Node id
+    @return Index or invalid index if the node is not visible.
+  */
+  QModelIndex indexForNode(uint32_t id);
+
+  /*!
+    Get nodes that are shown as rows
+    @return Node ids, parents before children
+  */
+  std::vector<uint32_t> getExposedNodes(void) const;
+
+  /*!
+    Get the trie
+    @return Reference to trie
+  */
+  const CMqttTopicTrie& getTrie(void) const { return m_trie; };
+
+protected:
+  bool canFetchMore(const QModelIndex& parent) const override;
+  void fetchMore(const QModelIndex& parent) override;
+
+private:
+  /// Model state for a trie node
+  struct nodestate {
+    uint32_t m_row;                  // Row in parent when exposed
+    uint32_t m_childPos;             // Position in parent's trie children
+    uint32_t m_cursor;               // Next trie child to consider for a row
+    uint64_t m_nextSeq;              // Next message to consider for a row
+    bool m_bExposed;                 // Shown as a row in parent
+    bool m_bFetched;                 // View has asked for children
+    bool m_bMessagesFetched;         // Messages has been handed to the view
+    bool m_visible;                  // Passes the filter
+    std::vector<uint32_t> m_rows;    // Child topics shown as rows
+    std::vector<uint64_t> m_messages; // Sequence numbers of messages shown as rows
+    int64_t m_highlight;             // Marked until this time (ms)
+  };
+
+  /// Index for a topic row
+  QModelIndex topicIndex(uint32_t id, int column = 0) const;
+
+  /// Node id for parent index (root for invalid index)
+  uint32_t parentId(const QModelIndex& parent) const;
+
+  /// Show a child as a row if its parent has been populated past it
+  void exposeIfFetched(uint32_t id);
+
+  /// Sync message rows with history for a node
+  void updateMessageRows(uint32_t id, bool bHistory);
+
+  /// Sync rows for nodes that lost messages to the history budget
+  void updateTrimmed(const std::vector<uint32_t>& trimmed);
+
+  /// Apply a result from the filter worker
+  void applyFilterResult(void);
+
+  /// Rebuild rows for a filter. res is nullptr for an empty filter.
+  void applyFilter(const CMqttTopicFilter& filter, const CMqttFilterWorker::result* res);
+
+  /// Mark a node and the nodes above it visible. Returns the nodes that changed.
+  void markVisible(uint32_t id, std::vector<uint32_t>& changed);
+
+  /// Build a one line preview of a payload
+  QString preview(const CMqttHistory::message& msg) const;
+
+  /// Data for a statistics column of a topic row
+  QVariant statsData(uint32_t id, int column, int role) const;
+
+  /// Sort child topic rows of all nodes on the sort column
+  void sortRows(void);
+
+  /// Sort order for two sibling nodes
+  bool lessThan(uint32_t a, uint32_t b, int64_t now) const;
+
+  CMqttTopicTrie m_trie;
+  std::vector<nodestate> m_state;
+
+  /// Held while the trie is changed and by the filter worker while it reads
+  std::mutex m_trieMutex;
+
+  bool m_bHistory;
+
+  bool m_bFiltered;
+  CMqttTopicFilter m_filter;
+
+  CMqttFilterWorker m_filterWorker;
+
+  /// True while a filter is evaluated
+  bool m_bFilterPending;
+
+  /// Job id for the pending filter
+  uint64_t m_filterJob;
+
+  /// Nodes that changed while a filter is evaluated
+  std::vector<uint32_t> m_filterDirty;
+
+  /// Marked nodes in the order they expire
+  std::deque<std::pair<uint32_t, int64_t>> m_highlights;
+
+  /// Column rows are sorted on, -1 for the order topics was seen in
+  int m_sortColumn;
+  Qt::SortOrder m_sortOrder;
+
+  /// Shade rows by message rate
+  bool m_bHeatmap;
+};
+
+#endif // MQTTTOPICMODEL_H
@@ -0,0 +1,215 @@
+// mqtttopicstats.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include "mqtttopicstats.h"
+
+#include <cmath>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttTopicStats::CMqttTopicStats()
+{
+  clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttTopicStats::~CMqttTopicStats()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clear
+//
+
+void
+CMqttTopicStats::clear(void)
+{
+  m_lastTime  = 0;
+  m_count     = 0;
+  m_bytes     = 0;
+  m_sizeCount = 0;
+  m_maxSize   = 0;
+  for (int window = 0; window < WINDOW_COUNT; window++) {
+    m_rate[window]     = 0;
+    m_byteRate[window] = 0;
+  }
+  memset(m_sizes, 0, sizeof(m_sizes));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// windowLength
+//
+
+int64_t
+CMqttTopicStats::windowLength(int window)
+{
+  switch (window) {
+    case WINDOW_1S:
+      return 1000;
+    case WINDOW_10S:
+      return 10000;
+    default:
+      return 60000;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decay
+//
+
+double
+CMqttTopicStats::decay(int window, int64_t elapsed)
+{
+  if (elapsed <= 0) {
+    return 1.0;
+  }
+  return std::exp(-(double)elapsed / (double)windowLength(window));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sizeBucket
+//
+
+int
+CMqttTopicStats::sizeBucket(size_t size)
+{
+  int bucket = 0;
+  while (size && (bucket < (SIZE_BUCKETS - 1))) {
+    size >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// add
+//
+
+void
+CMqttTopicStats::add(int64_t now, uint64_t count, uint64_t bytes)
+{
+  // A message added at time t contributes 1/T to the rate and then
+  // decays with exp(-(now - t)/T), which for steady traffic gives the
+  // rate over the last T
+  int64_t elapsed = m_lastTime ? (now - m_lastTime) : 0;
+  for (int window = 0; window < WINDOW_COUNT; window++) {
+    double f       = decay(window, elapsed);
+    double seconds = (double)windowLength(window) / 1000;
+    m_rate[window]     = (float)(m_rate[window] * f + count / seconds);
+    m_byteRate[window] = (float)(m_byteRate[window] * f + bytes / seconds);
+  }
+
+  if (now > m_lastTime) {
+    m_lastTime = now;
+  }
+  m_count += count;
+  m_bytes += bytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// addSizes
+//
+
+void
+CMqttTopicStats::addSizes(const uint32_t* sizes, size_t maxSize)
+{
+  for (int bucket = 0; bucket < SIZE_BUCKETS; bucket++) {
+    m_sizes[bucket] += sizes[bucket];
+    m_sizeCount += sizes[bucket];
+  }
+  if (maxSize > m_maxSize) {
+    m_maxSize = maxSize;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getRate
+//
+
+double
+CMqttTopicStats::getRate(int window, int64_t now) const
+{
+  if ((window < 0) || (window >= WINDOW_COUNT)) {
+    return 0;
+  }
+  return m_rate[window] * decay(window, now - m_lastTime);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getByteRate
+//
+
+double
+CMqttTopicStats::getByteRate(int window, int64_t now) const
+{
+  if ((window < 0) || (window >= WINDOW_COUNT)) {
+    return 0;
+  }
+  return m_byteRate[window] * decay(window, now - m_lastTime);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getSizePercentile
+//
+
+size_t
+CMqttTopicStats::getSizePercentile(int percent) const
+{
+  if (!m_sizeCount) {
+    return 0;
+  }
+
+  uint64_t rank = ((uint64_t)m_sizeCount * percent + 99) / 100;
+  if (!rank) {
+    rank = 1;
+  }
+
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < SIZE_BUCKETS; bucket++) {
+    seen += m_sizes[bucket];
+    if (seen >= rank) {
+      // Bucket n holds sizes up to 2^n - 1
+      size_t upper = (bucket < (SIZE_BUCKETS - 1)) ? (((size_t)1 << bucket) - 1) : m_maxSize;
+      return (upper < m_maxSize) ? upper : m_maxSize;
+    }
+  }
+
+  return m_maxSize;
+}
@@ -0,0 +1,165 @@
+// mqtttopicstats.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MQTTTOPICSTATS_H
+#define MQTTTOPICSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+  Rolling traffic statistics for an MQTT topic or a subtree of topics.
+
+  Message and byte rates are kept as exponentially weighted averages
+  over a 1, 10 and 60 second window. Each update decays the averages to
+  the update time and adds the new traffic, so an update costs the same
+  no matter how much traffic has been seen and nothing has to be done
+  between updates. Rates read later are decayed to the time of reading.
+
+  Payload sizes are counted in power of two buckets, which gives size
+  percentiles within a factor of two without keeping the sizes.
+*/
+
+class CMqttTopicStats {
+
+public:
+  /// Rate windows
+  enum { WINDOW_1S = 0, WINDOW_10S, WINDOW_60S, WINDOW_COUNT };
+
+  /// Number of payload size buckets. Bucket n holds sizes with a bit
+  /// width of n, the last bucket also holds everything larger.
+  static const int SIZE_BUCKETS = 20;
+
+  CMqttTopicStats();
+  ~CMqttTopicStats();
+
+  /*!
+    Add traffic
+    @param now Time of traffic in ms since epoch
+    @param count Number of messages
+    @param bytes Payload bytes for the messages
+  */
+  void add(int64_t now, uint64_t count, uint64_t bytes);
+
+  /*!
+    Add payload size samples
+    @param sizes Number of samples per size bucket
+    @param maxSize Largest sample
+  */
+  void addSizes(const uint32_t* sizes, size_t maxSize);
+
+  /*!
+    Get message rate
+    @param window Rate window (WINDOW_*)
+    @param now Current time in ms since epoch
+    @return Messages per second
+  */
+  double getRate(int window, int64_t now) const;
+
+  /*!
+    Get byte rate
+    @param window Rate window (WINDOW_*)
+    @param now Current time in ms since epoch
+    @return Payload bytes per second
+  */
+  double getByteRate(int window, int64_t now) const;
+
+  /*!
+    Get a payload size percentile
+    @param percent Percentile (0-100)
+    @return Upper bound of the size bucket that holds the percentile,
+            0 if no sizes has been sampled.
+  */
+  size_t getSizePercentile(int percent) const;
+
+  /*!
+    Get the largest payload size sampled
+    @return Size in bytes
+  */
+  size_t getMaxSize(void) const { return m_maxSize; };
+
+  /*!
+    Get number of messages
+    @return Messages
+  */
+  uint64_t getCount(void) const { return m_count; };
+
+  /*!
+    Get number of payload bytes
+    @return Bytes
+  */
+  uint64_t getBytes(void) const { return m_bytes; };
+
+  /*!
+    Get time of last update
+    @return Time in ms since epoch, 0 if never updated
+  */
+  int64_t getLastTime(void) const { return m_lastTime; };
+
+  /*!
+    Get the size bucket for a payload size
+    @param size Payload size
+    @return Bucket
+  */
+  static int sizeBucket(size_t size);
+
+  /*!
+    Get the window length
+    @param window Rate window (WINDOW_*)
+    @return Length in ms
+  */
+  static int64_t windowLength(int window);
+
+  /*!
+    Remove everything
+  */
+  void clear(void);
+
+private:
+  /// Decay factor for a window over a time span
+  static double decay(int window, int64_t elapsed);
+
+  /// Time of last update in ms since epoch
+  int64_t m_lastTime;
+
+  /// Decayed message rates in messages per second
+  float m_rate[WINDOW_COUNT];
+
+  /// Decayed byte rates in bytes per second
+  float m_byteRate[WINDOW_COUNT];
+
+  uint64_t m_count;
+  uint64_t m_bytes;
+
+  uint32_t m_sizes[SIZE_BUCKETS];
+  uint64_t m_sizeCount;
+  size_t m_maxSize;
+};
+
+#endif // MQTTTOPICSTATS_H
@@ -0,0 +1,397 @@
+// mqtttopictrie.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include "mqtttopictrie.h"
+
+#include <algorithm>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CMqttTopicTrie::CMqttTopicTrie()
+{
+  m_budget = DEFAULT_BUDGET;
+  clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CMqttTopicTrie::~CMqttTopicTrie()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clear
+//
+
+void
+CMqttTopicTrie::clear(void)
+{
+  m_nodes.clear();
+  m_segments.clear();
+  m_segmentIndex.clear();
+  m_childIndex.clear();
+  m_topicIndex.clear();
+
+  for (int list = 0; list < LRU_COUNT; list++) {
+    m_lruHead[list] = NONE;
+    m_lruTail[list] = NONE;
+  }
+  m_bytes = 0;
+
+  node root;
+  root.m_parent       = NONE;
+  root.m_segment      = intern("");
+  root.m_count        = 0;
+  root.m_subtreeCount = 0;
+  root.m_firstSeq     = 0;
+  for (int list = 0; list < LRU_COUNT; list++) {
+    root.m_lru[list] = { NONE, NONE, false };
+  }
+  m_nodes.push_back(std::move(root));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// intern
+//
+
+uint32_t
+CMqttTopicTrie::intern(const std::string& segment)
+{
+  auto it = m_segmentIndex.find(segment);
+  if (it != m_segmentIndex.end()) {
+    return it->second;
+  }
+
+  uint32_t id = (uint32_t)m_segments.size();
+  m_segments.push_back(segment);
+  m_segmentIndex[segment] = id;
+  return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// find
+//
+
+uint32_t
+CMqttTopicTrie::find(const std::string& topic) const
+{
+  auto it = m_topicIndex.find(topic);
+  if (it == m_topicIndex.end()) {
+    return NONE;
+  }
+  return it->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// insert
+//
+
+uint32_t
+CMqttTopicTrie::insert(const std::string& topic, std::vector<uint32_t>* created)
+{
+  auto it = m_topicIndex.find(topic);
+  if (it != m_topicIndex.end()) {
+    return it->second;
+  }
+
+  // An empty segment (leading, trailing or double '/') is shown as "/"
+  uint32_t parent = ROOT;
+  size_t start    = 0;
+  while (true) {
+    size_t end              = topic.find('/', start);
+    std::string segmentName = topic.substr(start, (std::string::npos == end) ? std::string::npos : end - start);
+    uint32_t segment        = intern(segmentName.empty() ? "/" : segmentName);
+
+    auto itc = m_childIndex.find(childKey(parent, segment));
+    if (itc != m_childIndex.end()) {
+      parent = itc->second;
+    }
+    else {
+      uint32_t id = (uint32_t)m_nodes.size();
+      node n;
+      n.m_parent       = parent;
+      n.m_segment      = segment;
+      n.m_count        = 0;
+      n.m_subtreeCount = 0;
+      n.m_firstSeq     = 0;
+      for (int list = 0; list < LRU_COUNT; list++) {
+        n.m_lru[list] = { NONE, NONE, false };
+      }
+      m_nodes.push_back(std::move(n));
+      m_nodes[parent].m_children.push_back(id);
+      m_childIndex[childKey(parent, segment)] = id;
+      if (nullptr != created) {
+        created->push_back(id);
+      }
+      parent = id;
+    }
+
+    if (std::string::npos == end) {
+      break;
+    }
+    start = end + 1;
+  }
+
+  m_topicIndex[topic] = parent;
+  return parent;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// addMessages
+//
+
+void
+CMqttTopicTrie::addMessages(uint32_t id,
+                            uint64_t count,
+                            uint64_t bytes,
+                            std::deque<value>& values,
+                            size_t maxHistory,
+                            std::vector<uint32_t>* trimmed)
+{
+  // Payload sizes are sampled from the values, coalesced messages
+  // only count in the rates
+  int64_t now = values.empty() ? 0 : values.back().m_timestamp;
+  uint32_t sizes[CMqttTopicStats::SIZE_BUCKETS] = {};
+  size_t maxSize = 0;
+  for (const auto& v : values) {
+    sizes[CMqttTopicStats::sizeBucket(v.m_payload.size())]++;
+    maxSize = std::max(maxSize, v.m_payload.size());
+  }
+
+  node& n = m_nodes[id];
+  n.m_count += count;
+  n.m_stats.add(now, count, bytes);
+  n.m_stats.addSizes(sizes, maxSize);
+  for (uint32_t cur = id; NONE != cur; cur = m_nodes[cur].m_parent) {
+    m_nodes[cur].m_subtreeCount += count;
+    m_nodes[cur].m_subtreeStats.add(now, count, bytes);
+    m_nodes[cur].m_subtreeStats.addSizes(sizes, maxSize);
+  }
+
+  // Values that would be dropped right away are not copied
+  size_t skip = (values.size() > maxHistory) ? values.size() - maxHistory : 0;
+  n.m_firstSeq += skip;
+
+  size_t before = n.m_history.getBytes();
+  for (size_t i = skip; i < values.size(); i++) {
+    const value& v = values[i];
+    n.m_history.push(v.m_payload, v.m_timestamp, v.m_mid, v.m_qos, v.m_retained);
+  }
+  m_bytes += n.m_history.getBytes() - before;
+  values.clear();
+
+  while (n.m_history.size() > maxHistory) {
+    popMessage(id);
+  }
+
+  touch(id);
+  enforceBudget(id, trimmed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// popMessage
+//
+
+void
+CMqttTopicTrie::popMessage(uint32_t id)
+{
+  node& n       = m_nodes[id];
+  size_t before = n.m_history.getBytes();
+  n.m_history.pop();
+  n.m_firstSeq++;
+  m_bytes -= before - n.m_history.getBytes();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getMessage
+//
+
+bool
+CMqttTopicTrie::getMessage(uint32_t id, uint64_t seq, CMqttHistory::message& msg) const
+{
+  const node& n = m_nodes[id];
+  if (seq < n.m_firstSeq) {
+    return false;
+  }
+  return n.m_history.get(seq - n.m_firstSeq, msg);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setBudget
+//
+
+void
+CMqttTopicTrie::setBudget(size_t budget, std::vector<uint32_t>* trimmed)
+{
+  m_budget = budget;
+  enforceBudget(NONE, trimmed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// enforceBudget
+//
+
+void
+CMqttTopicTrie::enforceBudget(uint32_t keep, std::vector<uint32_t>* trimmed)
+{
+  while (m_bytes > m_budget) {
+    uint32_t id;
+    if (NONE != m_lruTail[LRU_HISTORY]) {
+      // Older messages go first, from the topic that was updated longest ago
+      id = m_lruTail[LRU_HISTORY];
+      while ((m_bytes > m_budget) && (m_nodes[id].m_history.size() > 1)) {
+        popMessage(id);
+      }
+      // Trimming is not an update so the node keeps its place in LRU_LATEST
+      if (m_nodes[id].m_history.size() <= 1) {
+        lruUnlink(LRU_HISTORY, id);
+      }
+    }
+    else if ((NONE != m_lruTail[LRU_LATEST]) && (keep != m_lruTail[LRU_LATEST])) {
+      id = m_lruTail[LRU_LATEST];
+      popMessage(id);
+      lruUnlink(LRU_LATEST, id);
+    }
+    else {
+      // Only the message just received is left
+      break;
+    }
+
+    if ((nullptr != trimmed) && (keep != id)) {
+      trimmed->push_back(id);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// touch
+//
+
+void
+CMqttTopicTrie::touch(uint32_t id)
+{
+  const CMqttHistory& history = m_nodes[id].m_history;
+
+  lruUnlink(LRU_HISTORY, id);
+  if (history.size() > 1) {
+    lruLink(LRU_HISTORY, id);
+  }
+
+  lruUnlink(LRU_LATEST, id);
+  if (!history.empty()) {
+    lruLink(LRU_LATEST, id);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// lruLink
+//
+
+void
+CMqttTopicTrie::lruLink(int list, uint32_t id)
+{
+  lrulink& link = m_nodes[id].m_lru[list];
+  link.m_prev   = NONE;
+  link.m_next   = m_lruHead[list];
+  link.m_bLinked = true;
+
+  if (NONE != m_lruHead[list]) {
+    m_nodes[m_lruHead[list]].m_lru[list].m_prev = id;
+  }
+  else {
+    m_lruTail[list] = id;
+  }
+  m_lruHead[list] = id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// lruUnlink
+//
+
+void
+CMqttTopicTrie::lruUnlink(int list, uint32_t id)
+{
+  lrulink& link = m_nodes[id].m_lru[list];
+  if (!link.m_bLinked) {
+    return;
+  }
+
+  if (NONE != link.m_prev) {
+    m_nodes[link.m_prev].m_lru[list].m_next = link.m_next;
+  }
+  else {
+    m_lruHead[list] = link.m_next;
+  }
+
+  if (NONE != link.m_next) {
+    m_nodes[link.m_next].m_lru[list].m_prev = link.m_prev;
+  }
+  else {
+    m_lruTail[list] = link.m_prev;
+  }
+
+  link.m_prev    = NONE;
+  link.m_next    = NONE;
+  link.m_bLinked = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getTopic
+//
+
+std::string
+CMqttTopicTrie::getTopic(uint32_t id) const
+{
+  std::vector<uint32_t> path;
+  for (uint32_t cur = id; (NONE != cur) && (ROOT != cur); cur = m_nodes[cur].m_parent) {
+    path.push_back(cur);
+  }
+
+  std::string topic;
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+    if (it != path.rbegin()) {
+      topic += '/';
+    }
+    const std::string& segment = getSegment(*it);
+    if (segment != "/") {
+      topic += segment;
+    }
+  }
+  return topic;
+}
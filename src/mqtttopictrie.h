@@ -0,0 +1,295 @@
+// mqtttopictrie.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MQTTTOPICTRIE_H
+#define MQTTTOPICTRIE_H
+
+#include "mqtthistory.h"
+#include "mqtttopicstats.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+  Trie of MQTT topics split on '/'.
+
+  Topic segments are interned so a segment that is used in many topics
+  ("vscp", "temperature", a GUID...) is stored once. Nodes are kept in a
+  vector and referred to by id, children are found through one hash on
+  (parent id, segment id) and full topics through one hash on the topic
+  string. Finding the node for a message is therefore independent of the
+  number of topics in the trie.
+
+  Each node keeps counters and rolling traffic statistics for the topic
+  itself and for the subtree below it together with the latest messages
+  on the topic. The statistics are updated on the way up from the topic
+  when messages are added. Node 0 is an
+  unnamed root that has the top level segments as children.
+
+  Memory used by message history for all topics is kept below a budget.
+  When the budget is exceeded the oldest messages are dropped from the
+  least recently updated topic that has more than one message. Only when
+  no such topic is left is the latest message of the least recently
+  updated topic dropped. Topics themselves and their counters are never
+  removed.
+*/
+
+class CMqttTopicTrie {
+
+public:
+  /// Id of the root node
+  static const uint32_t ROOT = 0;
+
+  /// Id used for "no node"
+  static const uint32_t NONE = 0xffffffff;
+
+  /// Default history budget in bytes
+  static const size_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+  /// LRU lists
+  enum { LRU_HISTORY = 0, // Topics with more than one message
+         LRU_LATEST,      // Topics with at least one message
+         LRU_COUNT };
+
+  /*!
+    A message to add to a topic
+  */
+  struct value {
+    std::string m_payload;
+    int64_t m_timestamp; // Receive time in ms since epoch
+    int m_mid;
+    uint8_t m_qos;
+    bool m_retained;
+  };
+
+  /*!
+    Links for a node in an LRU list
+  */
+  struct lrulink {
+    uint32_t m_prev; // More recently updated node or NONE
+    uint32_t m_next; // Less recently updated node or NONE
+    bool m_bLinked;
+  };
+
+  /*!
+    A topic segment
+  */
+  struct node {
+    uint32_t m_parent;               // Parent node id (NONE for root)
+    uint32_t m_segment;              // Interned segment id
+    std::vector<uint32_t> m_children; // Child node ids in creation order
+    uint64_t m_count;                // Messages on this topic
+    uint64_t m_subtreeCount;         // Messages on this topic and below
+    CMqttTopicStats m_stats;         // Traffic on this topic
+    CMqttTopicStats m_subtreeStats;  // Traffic on this topic and below
+    uint64_t m_firstSeq;             // Sequence number of oldest message in m_history
+    CMqttHistory m_history;          // Latest messages, oldest first
+    lrulink m_lru[LRU_COUNT];
+  };
+
+  CMqttTopicTrie();
+  ~CMqttTopicTrie();
+
+  /*!
+    Find a topic, creating missing nodes on the way
+    @param topic Topic to find
+    @param created If not nullptr new node ids are appended to it,
+                   parents before children.
+    @return Id of node for topic.
+  */
+  uint32_t insert(const std::string& topic, std::vector<uint32_t>* created = nullptr);
+
+  /*!
+    Find a topic
+    @param topic Topic to find
+    @return Id of node for topic or NONE if not found.
+  */
+  uint32_t find(const std::string& topic) const;
+
+  /*!
+    Add messages to a topic. Counters are updated for the topic and all
+    nodes above it.
+    @param id Node id for topic
+    @param count Number of messages received (may be more than the
+                 number of values if some were coalesced)
+    @param bytes Payload bytes for all received messages
+    @param values Latest messages, oldest first. Cleared when added.
+    @param maxHistory Max number of messages kept for the topic
+    @param trimmed If not nullptr ids of other topics that lost messages
+                   to keep the history within budget are appended to it.
+  */
+  void addMessages(uint32_t id,
+                   uint64_t count,
+                   uint64_t bytes,
+                   std::deque<value>& values,
+                   size_t maxHistory,
+                   std::vector<uint32_t>* trimmed = nullptr);
+
+  /*!
+    Get a node
+    @param id Node id
+    @return Reference to node
+  */
+  const node& getNode(uint32_t id) const { return m_nodes[id]; };
+
+  /*!
+    Get latest message for a node
+    @param id Node id
+    @param msg Filled with the message
+    @return True on success, false if the node has no messages.
+  */
+  bool getLast(uint32_t id, CMqttHistory::message& msg) const { return m_nodes[id].m_history.back(msg); };
+
+  /*!
+    Get a message for a node
+    @param id Node id
+    @param seq Sequence number of message
+    @param msg Filled with the message
+    @return True on success, false if the message is not kept.
+  */
+  bool getMessage(uint32_t id, uint64_t seq, CMqttHistory::message& msg) const;
+
+  /*!
+    Get sequence number after the latest message for a node
+    @param id Node id
+    @return Sequence number
+  */
+  uint64_t getEndSeq(uint32_t id) const { return m_nodes[id].m_firstSeq + m_nodes[id].m_history.size(); };
+
+  /*!
+    Set the history budget. History is trimmed if it is above the new
+    budget.
+    @param budget Max bytes for history of all topics
+    @param trimmed If not nullptr ids of topics that lost messages are
+                   appended to it.
+  */
+  void setBudget(size_t budget, std::vector<uint32_t>* trimmed = nullptr);
+
+  /*!
+    Get the history budget
+    @return Max bytes for history of all topics
+  */
+  size_t getBudget(void) const { return m_budget; };
+
+  /*!
+    Get memory used by history for all topics
+    @return Bytes
+  */
+  size_t getBytes(void) const { return m_bytes; };
+
+  /*!
+    Get the segment name for a node
+    @param id Node id
+    @return Segment name
+  */
+  const std::string& getSegment(uint32_t id) const { return m_segments[m_nodes[id].m_segment]; };
+
+  /*!
+    Build the full topic for a node
+    @param id Node id
+    @return Topic
+  */
+  std::string getTopic(uint32_t id) const;
+
+  /*!
+    Get number of nodes, root included
+    @return Number of nodes
+  */
+  size_t getNodeCount(void) const { return m_nodes.size(); };
+
+  /*!
+    Get number of topics that has been inserted
+    @return Number of topics
+  */
+  size_t getTopicCount(void) const { return m_topicIndex.size(); };
+
+  /*!
+    Get number of distinct segments
+    @return Number of segments
+  */
+  size_t getSegmentCount(void) const { return m_segments.size(); };
+
+  /*!
+    Remove everything
+  */
+  void clear(void);
+
+private:
+  /// Intern a segment
+  uint32_t intern(const std::string& segment);
+
+  /// Remove the oldest message of a node and keep the byte count
+  void popMessage(uint32_t id);
+
+  /// Put a node first in or remove it from its LRU lists
+  void touch(uint32_t id);
+
+  /// Link a node first in an LRU list
+  void lruLink(int list, uint32_t id);
+
+  /// Unlink a node from an LRU list
+  void lruUnlink(int list, uint32_t id);
+
+  /// Drop history until the budget is met. The latest message of keep is never dropped.
+  void enforceBudget(uint32_t keep, std::vector<uint32_t>* trimmed);
+
+  /// Key for the child index
+  static uint64_t childKey(uint32_t parent, uint32_t segment)
+  {
+    return ((uint64_t)parent << 32) | segment;
+  };
+
+  std::vector<node> m_nodes;
+
+  std::vector<std::string> m_segments;
+  std::unordered_map<std::string, uint32_t> m_segmentIndex;
+
+  /// (parent, segment) -> child
+  std::unordered_map<uint64_t, uint32_t> m_childIndex;
+
+  /// Full topic -> node
+  std::unordered_map<std::string, uint32_t> m_topicIndex;
+
+  /// Most recently updated node in each LRU list
+  uint32_t m_lruHead[LRU_COUNT];
+
+  /// Least recently updated node in each LRU list
+  uint32_t m_lruTail[LRU_COUNT];
+
+  /// Max bytes for history
+  size_t m_budget;
+
+  /// Bytes used for history
+  size_t m_bytes;
+};
+
+#endif // MQTTTOPICTRIE_H
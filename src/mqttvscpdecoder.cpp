@@ -0,0 +1,168 @@
+// mqttvscpdecoder.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "mqttvscpdecoder.h"
+
+#include <algorithm>
+
+// Binary frame layout (packet type 0)
+#define FRAME_POS_TYPE      0
+#define FRAME_POS_SIZE_MSB  34
+#define FRAME_POS_SIZE_LSB  35
+
+// Fields in the string form before the GUID
+#define STRING_MIN_COMMAS 6
+
+///////////////////////////////////////////////////////////////////////////////
+// detect
+//
+
+uint8_t
+CMqttVscpDecoder::detect(std::string_view payload)
+{
+  if (payload.empty()) {
+    return ENCODING_NONE;
+  }
+
+  // A binary frame starts with packet type 0 (event, no encryption) and
+  // the data size in the header must agree with the payload size
+  if (payload.size() >= FRAME_MIN_SIZE) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(payload.data());
+    if ((0 == p[FRAME_POS_TYPE]) &&
+        (payload.size() == FRAME_MIN_SIZE + (((size_t)p[FRAME_POS_SIZE_MSB] << 8) + p[FRAME_POS_SIZE_LSB]))) {
+      return ENCODING_BINARY;
+    }
+  }
+
+  size_t limit = std::min(payload.size(), (size_t)DETECT_LIMIT);
+  size_t pos   = 0;
+  while ((pos < limit) && ((' ' == payload[pos]) || ('\t' == payload[pos]) || ('\r' == payload[pos]) ||
+                           ('\n' == payload[pos]))) {
+    pos++;
+  }
+
+  if (pos >= limit) {
+    return ENCODING_NONE;
+  }
+
+  std::string_view head = payload.substr(pos, limit - pos);
+  switch (head[0]) {
+
+    // JSON and XML events always carry the class attribute
+    case '{':
+      return (std::string_view::npos != head.find("\"vscpClass\"")) ? ENCODING_JSON : ENCODING_NONE;
+
+    case '<':
+      return (std::string_view::npos != head.find("vscpClass")) ? ENCODING_XML : ENCODING_NONE;
+
+    // head,class,type,obid,datetime,timestamp,GUID,data
+    default:
+      if ((head[0] >= '0') && (head[0] <= '9') &&
+          (std::count(head.begin(), head.end(), ',') >= STRING_MIN_COMMAS) &&
+          (std::string_view::npos != head.find(':'))) {
+        return ENCODING_STRING;
+      }
+      return ENCODING_NONE;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decode
+//
+
+uint8_t
+CMqttVscpDecoder::decode(const std::string& payload, vscp_event_t* pev)
+{
+  if (nullptr == pev) {
+    return ENCODING_NONE;
+  }
+
+  if (nullptr != pev->pdata) {
+    delete[] pev->pdata;
+    pev->pdata = nullptr;
+  }
+  pev->sizeData = 0;
+
+  uint8_t encoding = detect(payload);
+
+  // The helpers take non const strings but do not change them
+  std::string& str = const_cast<std::string&>(payload);
+
+  bool rv = false;
+  switch (encoding) {
+    case ENCODING_JSON:
+      rv = vscp_convertJSONToEvent(pev, str);
+      break;
+
+    case ENCODING_XML:
+      rv = vscp_convertXMLToEvent(pev, str);
+      break;
+
+    case ENCODING_STRING:
+      rv = vscp_convertStringToEvent(pev, str);
+      break;
+
+    case ENCODING_BINARY:
+      rv = vscp_getEventFromFrame(pev, reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+      break;
+
+    default:
+      break;
+  }
+
+  return rv ? encoding : (uint8_t)ENCODING_NONE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// encodingToString
+//
+
+const char*
+CMqttVscpDecoder::encodingToString(uint8_t encoding)
+{
+  switch (encoding) {
+    case ENCODING_JSON:
+      return "JSON";
+    case ENCODING_XML:
+      return "XML";
+    case ENCODING_STRING:
+      return "String";
+    case ENCODING_BINARY:
+      return "Binary frame";
+    default:
+      return "None";
+  }
+}
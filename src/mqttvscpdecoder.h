@@ -0,0 +1,98 @@
+// mqttvscpdecoder.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MQTTVSCPDECODER_H
+#define MQTTVSCPDECODER_H
+
+#include <vscp.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*!
+  Decoder for VSCP events published over MQTT.
+
+  Nodes compatible with vscpClientMqtt publish events as JSON, XML,
+  the comma separated string form or as a binary frame. A payload is
+  first checked with a few byte compares so that traffic that is not
+  VSCP is rejected without being parsed. Payloads that pass are parsed
+  straight from the raw bytes into a VSCP event.
+*/
+
+class CMqttVscpDecoder {
+
+public:
+  /// Payload encodings
+  enum { ENCODING_NONE = 0, ENCODING_JSON, ENCODING_XML, ENCODING_STRING, ENCODING_BINARY };
+
+  /// Size of a binary frame without data (header + CRC)
+  static const size_t FRAME_MIN_SIZE = 38;
+
+  /// Max number of bytes looked at when the encoding is detected
+  static const size_t DETECT_LIMIT = 256;
+
+  /*!
+    Detect the VSCP encoding of a payload without parsing it
+    @param payload Raw payload
+    @return Encoding (ENCODING_*), ENCODING_NONE if the payload is
+            not a VSCP event.
+  */
+  static uint8_t detect(std::string_view payload);
+
+  /*!
+    Decode a payload into a VSCP event. Data already in the event is
+    released first so the same event can be used for many payloads.
+    @param payload Raw payload
+    @param pev Event that receives the result
+    @return Encoding the event was decoded from, ENCODING_NONE if
+            the payload is not a valid VSCP event.
+  */
+  static uint8_t decode(const std::string& payload, vscp_event_t* pev);
+
+  /*!
+    Get a readable name for an encoding
+    @param encoding Encoding (ENCODING_*)
+    @return Name of encoding
+  */
+  static const char* encodingToString(uint8_t encoding);
+
+  /*!
+    Key used for class/type maps
+    @param vscpClass VSCP class
+    @param vscpType VSCP type
+    @return (class << 16) + type
+  */
+  static uint32_t makeKey(uint16_t vscpClass, uint16_t vscpType)
+  {
+    return ((uint32_t)vscpClass << 16) + vscpType;
+  };
+};
+
+#endif // MQTTVSCPDECODER_H
@@ -0,0 +1,412 @@
+// nodeinventory.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "nodeinventory.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CNodeInventory::CNodeInventory()
+{
+  m_db = nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CNodeInventory::~CNodeInventory()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// open
+//
+
+bool
+CNodeInventory::open(sqlite3* db)
+{
+  int rv;
+  sqlite3_stmt* ppStmt;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_db = db;
+  m_nodes.clear();
+  m_guidIndex.clear();
+
+  // Create node table if it does not exist
+  if (SQLITE_OK != (rv = sqlite3_exec(m_db,
+                                      "CREATE TABLE IF NOT EXISTS node ("
+                                      "idx	INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT UNIQUE,"
+                                      "connection TEXT,"
+                                      "interface TEXT,"
+                                      "address TEXT,"
+                                      "nodeid INTEGER,"
+                                      "level INTEGER,"
+                                      "guid TEXT,"
+                                      "mdfurl TEXT,"
+                                      "firmware TEXT,"
+                                      "name TEXT,"
+                                      "stdreghash TEXT,"
+                                      "firstseen TEXT,"
+                                      "lastseen TEXT);",
+                                      NULL,
+                                      NULL,
+                                      NULL))) {
+    spdlog::error("Node inventory: Failed to create node table. rv={0} {1}", rv, sqlite3_errmsg(m_db));
+    m_db = nullptr;
+    return false;
+  }
+
+  // A node is unique on where it is
+  if (SQLITE_OK !=
+      (rv = sqlite3_exec(m_db,
+                         "CREATE UNIQUE INDEX IF NOT EXISTS \"idxNodeAddress\" ON \"node\" "
+                         "(\"connection\" ASC, \"interface\" ASC, \"address\" ASC)",
+                         NULL,
+                         NULL,
+                         NULL))) {
+    spdlog::error("Node inventory: Failed to create node index. rv={0} {1}", rv, sqlite3_errmsg(m_db));
+    m_db = nullptr;
+    return false;
+  }
+
+  if (SQLITE_OK != (rv = sqlite3_prepare_v2(m_db,
+                                            "SELECT connection, interface, nodeid, level, guid, mdfurl, "
+                                            "firmware, name, stdreghash, firstseen, lastseen FROM node",
+                                            -1,
+                                            &ppStmt,
+                                            NULL))) {
+    spdlog::error("Node inventory: Failed to query nodes. rv={0} {1}", rv, sqlite3_errmsg(m_db));
+    m_db = nullptr;
+    return false;
+  }
+
+  auto text = [&ppStmt](int col) {
+    const unsigned char* p = sqlite3_column_text(ppStmt, col);
+    return (nullptr == p) ? std::string() : std::string((const char*)p);
+  };
+
+  while (SQLITE_ROW == sqlite3_step(ppStmt)) {
+    noderecord record;
+    record.m_connection = text(0);
+    record.m_interface  = text(1);
+    record.m_nodeid     = (uint16_t)sqlite3_column_int(ppStmt, 2);
+    record.m_bLevel2    = (2 == sqlite3_column_int(ppStmt, 3));
+    record.m_guid       = text(4);
+    record.m_mdfUrl     = text(5);
+    record.m_firmware   = text(6);
+    record.m_name       = text(7);
+    record.m_hash       = text(8);
+    record.m_firstSeen  = text(9);
+    record.m_lastSeen   = text(10);
+
+    std::string key = makeKey(record);
+    m_nodes[key]    = record;
+    indexRecord(key, record);
+  }
+  sqlite3_finalize(ppStmt);
+
+  spdlog::debug("Node inventory: Loaded {0} node(s)", m_nodes.size());
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// makeKey
+//
+
+std::string
+CNodeInventory::makeKey(const noderecord& record)
+{
+  std::string key = record.m_connection + "/" + record.m_interface + "/";
+  key += record.m_bLevel2 ? record.m_guid : std::to_string(record.m_nodeid);
+  return key;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// makeOriginGuid
+//
+
+std::string
+CNodeInventory::makeOriginGuid(const std::string& interface, uint16_t nodeid)
+{
+  cguid guid;
+  guid.getFromString(interface);
+  guid.setLSB(nodeid & 0xff);
+  return guid.getAsString();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// indexRecord
+//
+
+void
+CNodeInventory::indexRecord(const std::string& key, const noderecord& record)
+{
+  cguid guid;
+  guid.getFromString(record.m_guid);
+  if (!record.m_guid.empty() && !guid.isNULL()) {
+    m_guidIndex[guid.getAsString()] = key;
+  }
+
+  if (!record.m_bLevel2) {
+    m_guidIndex[makeOriginGuid(record.m_interface, record.m_nodeid)] = key;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write
+//
+
+bool
+CNodeInventory::write(const noderecord& record)
+{
+  int rv;
+  sqlite3_stmt* ppStmt;
+
+  if (SQLITE_OK != (rv = sqlite3_prepare_v2(m_db,
+                                            "INSERT OR REPLACE INTO node (connection, interface, address, nodeid, "
+                                            "level, guid, mdfurl, firmware, name, stdreghash, firstseen, lastseen) "
+                                            "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12);",
+                                            -1,
+                                            &ppStmt,
+                                            NULL))) {
+    spdlog::error("Node inventory: Failed to prepare node update. rv={0} {1}", rv, sqlite3_errmsg(m_db));
+    return false;
+  }
+
+  std::string address = record.m_bLevel2 ? record.m_guid : std::to_string(record.m_nodeid);
+  sqlite3_bind_text(ppStmt, 1, record.m_connection.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(ppStmt, 2, record.m_interface.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(ppStmt, 3, address.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int(ppStmt, 4, record.m_nodeid);
+  sqlite3_bind_int(ppStmt, 5, record.m_bLevel2 ? 2 : 1);
+  sqlite3_bind_text(ppStmt, 6, record.m_guid.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(ppStmt, 7, record.m_mdfUrl.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(ppStmt, 8, record.m_firmware.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(ppStmt, 9, record.m_name.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(ppStmt, 10, record.m_hash.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(ppStmt, 11, record.m_firstSeen.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(ppStmt, 12, record.m_lastSeen.c_str(), -1, SQLITE_TRANSIENT);
+
+  rv = sqlite3_step(ppStmt);
+  sqlite3_finalize(ppStmt);
+  if (SQLITE_DONE != rv) {
+    spdlog::error("Node inventory: Failed to update node {0}. rv={1} {2}", address, rv, sqlite3_errmsg(m_db));
+    return false;
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// update
+//
+
+bool
+CNodeInventory::update(const std::deque<noderecord>& records)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (nullptr == m_db) {
+    return false;
+  }
+
+  std::string now = QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toStdString();
+
+  // One transaction for all so a large scan is one disk write
+  sqlite3_exec(m_db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+  bool rv = true;
+  for (const auto& item : records) {
+
+    std::string key = makeKey(item);
+    auto it         = m_nodes.find(key);
+
+    noderecord record = item;
+    if (it != m_nodes.end()) {
+      const noderecord& old = it->second;
+      if (record.m_guid.empty()) {
+        record.m_guid = old.m_guid;
+      }
+      if (record.m_mdfUrl.empty()) {
+        record.m_mdfUrl = old.m_mdfUrl;
+      }
+      if (record.m_firmware.empty()) {
+        record.m_firmware = old.m_firmware;
+      }
+      if (record.m_name.empty()) {
+        record.m_name = old.m_name;
+      }
+      if (record.m_hash.empty()) {
+        record.m_hash = old.m_hash;
+      }
+      record.m_firstSeen = old.m_firstSeen;
+    }
+    else {
+      record.m_firstSeen = now;
+    }
+    record.m_lastSeen = now;
+
+    if (!write(record)) {
+      rv = false;
+      continue;
+    }
+
+    m_nodes[key] = record;
+    indexRecord(key, record);
+  }
+
+  sqlite3_exec(m_db, "COMMIT;", NULL, NULL, NULL);
+  return rv;
+}
+
+bool
+CNodeInventory::update(const noderecord& record)
+{
+  std::deque<noderecord> records;
+  records.push_back(record);
+  return update(records);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// lookup
+//
+
+bool
+CNodeInventory::lookup(const std::string& connection,
+                       const std::string& interface,
+                       uint16_t nodeid,
+                       noderecord& record)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_nodes.find(connection + "/" + interface + "/" + std::to_string(nodeid));
+  if (it == m_nodes.end()) {
+    return false;
+  }
+
+  record = it->second;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// lookupGuid
+//
+
+bool
+CNodeInventory::lookupGuid(const std::string& guid, noderecord& record)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  cguid g;
+  g.getFromString(guid);
+  auto it = m_guidIndex.find(g.getAsString());
+  if (it == m_guidIndex.end()) {
+    return false;
+  }
+
+  auto itNode = m_nodes.find(it->second);
+  if (itNode == m_nodes.end()) {
+    return false;
+  }
+
+  record = itNode->second;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getNodes
+//
+
+std::deque<CNodeInventory::noderecord>
+CNodeInventory::getNodes(const std::string& connection)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::deque<noderecord> records;
+  for (const auto& item : m_nodes) {
+    if (connection.empty() || (connection == item.second.m_connection)) {
+      records.push_back(item.second);
+    }
+  }
+  return records;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// hashStandardRegisters
+//
+
+std::string
+CNodeInventory::hashStandardRegisters(const std::vector<uint8_t>& regs)
+{
+  if (regs.size() < 128) {
+    return std::string();
+  }
+
+  std::vector<uint8_t> data(regs.begin(), regs.begin() + 128);
+  data[0x80 - 0x80] = 0; // Alarm status, cleared on read
+  data[0x92 - 0x80] = 0; // Page select MSB
+  data[0x93 - 0x80] = 0; // Page select LSB
+
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  hash.addData(QByteArray::fromRawData((const char*)data.data(), (int)data.size()));
+  return hash.result().toHex().toStdString();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getFirmwareVersion
+//
+
+std::string
+CNodeInventory::getFirmwareVersion(const std::vector<uint8_t>& regs)
+{
+  if (regs.size() < 128) {
+    return std::string();
+  }
+
+  return vscp_str_format("%d.%d.%d", regs[0x94 - 0x80], regs[0x95 - 0x80], regs[0x96 - 0x80]);
+}
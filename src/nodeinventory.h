@@ -0,0 +1,171 @@
+// nodeinventory.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef NODEINVENTORY_H
+#define NODEINVENTORY_H
+
+#include <guid.h>
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+
+/*!
+  Nodes seen on the bus, kept in the "node" table of vscpworks.sqlite3.
+
+  A node is identified by the connection (uuid) it was seen on, the
+  interface and its address on the interface, which is the node id for
+  Level I nodes and the GUID for Level II nodes. The table is loaded
+  into memory when opened so lookups never touch the database or the
+  bus. Nodes can be looked up on their address or on a GUID, which can
+  be the GUID the node reports or the GUID its events carry (interface
+  GUID with node id in the LSB).
+
+  A hash of the standard registers is stored with each node so that a
+  rescan can tell if anything that matters for the node (GUID, MDF,
+  firmware...) has changed since it was last seen.
+*/
+
+class CNodeInventory {
+
+public:
+  /*!
+    A node in the inventory
+  */
+  struct noderecord {
+    std::string m_connection;  // Connection uuid
+    std::string m_interface;   // Interface GUID (all zero if none)
+    uint16_t m_nodeid;         // Node id on the interface
+    bool m_bLevel2;            // Level II node (address is GUID)
+    std::string m_guid;        // GUID reported by the node
+    std::string m_mdfUrl;      // MDF URL
+    std::string m_firmware;    // Firmware version "major.minor.sub"
+    std::string m_name;        // Module name from MDF
+    std::string m_hash;        // Standard register hash
+    std::string m_firstSeen;   // UTC ISO time first seen
+    std::string m_lastSeen;    // UTC ISO time last seen
+  };
+
+  CNodeInventory();
+  ~CNodeInventory();
+
+  /*!
+    Create the node table if needed and load it into memory. On failure
+    the inventory is left empty and updates are ignored.
+    @param db Open vscpworks database
+    @return True on success
+  */
+  bool open(sqlite3* db);
+
+  /*!
+    Add or update nodes. Fields that are empty in a record keep the value
+    already in the inventory. Last seen is set to now.
+    @param records Nodes to add/update
+    @return True on success
+  */
+  bool update(const std::deque<noderecord>& records);
+
+  /*!
+    Add or update a node
+    @param record Node to add/update
+    @return True on success
+  */
+  bool update(const noderecord& record);
+
+  /*!
+    Look up a Level I node on its node id
+    @param connection Connection uuid
+    @param interface Interface GUID on string form
+    @param nodeid Node id
+    @param record Filled in if found
+    @return True if found
+  */
+  bool lookup(const std::string& connection, const std::string& interface, uint16_t nodeid, noderecord& record);
+
+  /*!
+    Look up a node on GUID. Both the GUID reported by the node and the
+    GUID used in its events (interface + node id) are tried.
+    @param guid GUID on string form
+    @param record Filled in if found
+    @return True if found
+  */
+  bool lookupGuid(const std::string& guid, noderecord& record);
+
+  /*!
+    Get all nodes, optionally for one connection only
+    @param connection Connection uuid or empty for all
+    @return Nodes ordered on connection, interface and address
+  */
+  std::deque<noderecord> getNodes(const std::string& connection = "");
+
+  /*!
+    Hash the standard registers. Registers that change without the node
+    changing (alarm status and page select) are left out.
+    @param regs Register 0x80-0xff
+    @return Hash on hex string form or empty if regs is too short
+  */
+  static std::string hashStandardRegisters(const std::vector<uint8_t>& regs);
+
+  /*!
+    Get the firmware version from standard registers
+    @param regs Register 0x80-0xff
+    @return Version as "major.minor.sub"
+  */
+  static std::string getFirmwareVersion(const std::vector<uint8_t>& regs);
+
+private:
+  /// Key in the node map
+  static std::string makeKey(const noderecord& record);
+
+  /// GUID a Level I node uses in its events
+  static std::string makeOriginGuid(const std::string& interface, uint16_t nodeid);
+
+  /// Add GUID index entries for a node
+  void indexRecord(const std::string& key, const noderecord& record);
+
+  /// Write a node to the database
+  bool write(const noderecord& record);
+
+  std::mutex m_mutex;
+
+  /// The vscpworks database
+  sqlite3* m_db;
+
+  /// Nodes on key (connection/interface/address)
+  std::map<std::string, noderecord> m_nodes;
+
+  /// GUID (reported or origin) -> key
+  std::map<std::string, std::string> m_guidIndex;
+};
+
+#endif // NODEINVENTORY_H
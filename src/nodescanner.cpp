@@ -0,0 +1,780 @@
+// nodescanner.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "nodescanner.h"
+
+#include <algorithm>
+#include <map>
+
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CNodeScanner::CNodeScanner(CVscpClient& client, const cguid& guidInterface)
+  : m_client(client)
+{
+  m_guidInterface = guidInterface;
+
+  // A non zero interface GUID means we talk to nodes through an interface
+  m_bInterface = false;
+  for (int i = 0; i < 16; i++) {
+    if (m_guidInterface.getGUID()[i]) {
+      m_bInterface = true;
+      break;
+    }
+  }
+
+  m_window     = 16;
+  m_retries    = 1;
+  m_gap        = 0;
+  m_minTimeout = 20;
+  m_maxTimeout = 1000;
+  m_srtt       = -1;
+  m_rttvar     = 0;
+  m_bRunning   = false;
+  m_bCancel    = false;
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CNodeScanner::~CNodeScanner()
+{
+  cancel();
+  wait();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setTimeout
+//
+
+void
+CNodeScanner::setTimeout(uint32_t minTimeout, uint32_t maxTimeout)
+{
+  m_minTimeout = minTimeout ? minTimeout : 1;
+  m_maxTimeout = (maxTimeout < m_minTimeout) ? m_minTimeout : maxTimeout;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+int
+CNodeScanner::start(const std::set<uint16_t>& nodes, foundcallback cbFound, donecallback cbDone)
+{
+  if (m_bRunning) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  // Join a previous scan
+  wait();
+
+  std::deque<uint8_t> list;
+  for (auto nodeid : nodes) {
+    if ((nodeid > 0) && (nodeid < 0xff)) {
+      list.push_back((uint8_t)nodeid);
+    }
+  }
+  if (list.empty()) {
+    return VSCP_ERROR_PARAMETER;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.m_total = list.size();
+    m_stats.m_rto   = m_maxTimeout;
+  }
+
+  m_srtt     = -1;
+  m_rttvar   = 0;
+  m_bCancel  = false;
+  m_bRunning = true;
+  m_thread   = std::thread(&CNodeScanner::worker, this, list, cbFound, cbDone);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// wait
+//
+
+void
+CNodeScanner::wait(void)
+{
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getStats
+//
+
+CNodeScanner::scanstats
+CNodeScanner::getStats(void)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sendProbe
+//
+
+int
+CNodeScanner::sendProbe(uint8_t nodeid)
+{
+  vscpEventEx ex;
+  memset(&ex, 0, sizeof(ex));
+  ex.head      = VSCP_PRIORITY_NORMAL;
+  ex.timestamp = vscp_makeTimeStamp();
+  vscp_setEventExDateTimeBlockToNow(&ex);
+
+  // Frames to a node on an interface are sent as Level I over Level II
+  // with the interface GUID first in the data.
+  uint8_t pos = 0;
+  if (m_bInterface) {
+    ex.vscp_class = VSCP_CLASS2_LEVEL1_PROTOCOL;
+    memcpy(ex.data, m_guidInterface.getGUID(), 16);
+    pos = 16;
+  }
+  else {
+    ex.vscp_class = VSCP_CLASS1_PROTOCOL;
+  }
+
+  ex.vscp_type     = VSCP_TYPE_PROTOCOL_READ_REGISTER;
+  ex.data[pos + 0] = nodeid;
+  ex.data[pos + 1] = PROBE_REGISTER;
+  ex.sizeData      = pos + 2;
+
+  int rv;
+  if (VSCP_ERROR_SUCCESS != (rv = m_client.send(ex))) {
+    spdlog::error("Node scanner: Failed to send probe to node {0} rv={1}", nodeid, rv);
+  }
+
+  return rv;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// matchResponse
+//
+
+int
+CNodeScanner::matchResponse(const vscpEventEx& ex) const
+{
+  uint16_t vscp_class  = ex.vscp_class;
+  const uint8_t* pdata = ex.data;
+  uint16_t sizeData    = ex.sizeData;
+
+  // Level I over Level II have the interface GUID first in data
+  if (VSCP_CLASS2_LEVEL1_PROTOCOL == vscp_class) {
+    if (sizeData < 16) {
+      return -1;
+    }
+    vscp_class = VSCP_CLASS1_PROTOCOL;
+    pdata += 16;
+    sizeData -= 16;
+  }
+
+  if ((VSCP_CLASS1_PROTOCOL != vscp_class) || (VSCP_TYPE_PROTOCOL_RW_RESPONSE != ex.vscp_type) ||
+      (sizeData < 2) || (PROBE_REGISTER != pdata[0])) {
+    return -1;
+  }
+
+  // Responding node is in the LSB of the GUID
+  return ex.GUID[15];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// updateRto
+//
+
+void
+CNodeScanner::updateRto(uint32_t rtt)
+{
+  // RFC 6298
+  if (m_srtt < 0) {
+    m_srtt   = rtt;
+    m_rttvar = rtt / 2.0;
+  }
+  else {
+    double diff = m_srtt - rtt;
+    m_rttvar    = 0.75 * m_rttvar + 0.25 * ((diff < 0) ? -diff : diff);
+    m_srtt      = 0.875 * m_srtt + 0.125 * rtt;
+  }
+
+  double rto = m_srtt + 4 * m_rttvar;
+  if (rto < m_minTimeout) {
+    rto = m_minTimeout;
+  }
+  if (rto > m_maxTimeout) {
+    rto = m_maxTimeout;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.m_srtt = (uint32_t)m_srtt;
+  m_stats.m_rto  = (uint32_t)rto;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// worker
+//
+
+void
+CNodeScanner::worker(std::deque<uint8_t> nodes, foundcallback cbFound, donecallback cbDone)
+{
+  auto start    = std::chrono::steady_clock::now();
+  auto lastSent = start - std::chrono::hours(1);
+  std::map<uint8_t, probe> outstanding;
+  std::set<uint8_t> found;
+  std::set<uint8_t> probed;
+
+  spdlog::debug("Node scanner: Scanning {0} node(s) window={1}", nodes.size(), m_window);
+
+  // Discard anything old in the receive queue
+  vscpEventEx ex;
+  while (VSCP_ERROR_SUCCESS == m_client.receive(ex)) {
+    ;
+  }
+
+  while (!m_bCancel && (nodes.size() || outstanding.size())) {
+
+    auto now    = std::chrono::steady_clock::now();
+    bool bIdle  = true;
+    uint32_t rto;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      rto = m_stats.m_rto;
+    }
+
+    // Fill the window
+    while (nodes.size() && (outstanding.size() < m_window) &&
+           (std::chrono::duration_cast<std::chrono::microseconds>(now - lastSent).count() >= m_gap)) {
+      uint8_t nodeid = nodes.front();
+      nodes.pop_front();
+      probed.insert(nodeid);
+      if (VSCP_ERROR_SUCCESS != sendProbe(nodeid)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_done++;
+        continue;
+      }
+      lastSent = now;
+      probe p;
+      p.m_nodeid          = nodeid;
+      p.m_retries         = 0;
+      p.m_sent            = now;
+      outstanding[nodeid] = p;
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.m_probes++;
+      bIdle = false;
+    }
+
+    // Match replies as they arrive. A node that answers after its probe
+    // timed out is still found.
+    while (VSCP_ERROR_SUCCESS == m_client.receive(ex)) {
+      bIdle      = false;
+      int nodeid = matchResponse(ex);
+      if (-1 == nodeid) {
+        continue;
+      }
+
+      now     = std::chrono::steady_clock::now();
+      auto it = outstanding.find(nodeid);
+      if (!probed.count(nodeid)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_unmatched++;
+        continue;
+      }
+
+      uint32_t rtt = 0;
+      if (it != outstanding.end()) {
+        rtt = std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.m_sent).count();
+        // Karn: only unambiguous samples are used for the estimate
+        if (0 == it->second.m_retries) {
+          updateRto(rtt);
+        }
+        outstanding.erase(it);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_done++;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_responses++;
+      }
+
+      if (found.insert(nodeid).second) {
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_stats.m_found++;
+        }
+        spdlog::debug("Node scanner: Found node {0} rtt={1} ms", nodeid, rtt);
+        if (nullptr != cbFound) {
+          cbFound(nodeid, rtt);
+        }
+      }
+    }
+
+    // Resend or give up on probes that has not been answered in time
+    now = std::chrono::steady_clock::now();
+    for (auto it = outstanding.begin(); it != outstanding.end();) {
+      probe& p = it->second;
+      if (std::chrono::duration_cast<std::chrono::milliseconds>(now - p.m_sent).count() < (int64_t)rto) {
+        ++it;
+        continue;
+      }
+      if (p.m_retries < m_retries) {
+        p.m_retries++;
+        p.m_sent = now;
+        sendProbe(p.m_nodeid);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_probes++;
+        m_stats.m_retransmits++;
+        ++it;
+      }
+      else {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_timeouts++;
+        m_stats.m_done++;
+        it = outstanding.erase(it);
+      }
+    }
+
+    if (bIdle) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.m_elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    spdlog::debug("Node scanner: Done in {0} ms, {1} found, {2} probes, {3} responses, {4} timeouts",
+                  m_stats.m_elapsed,
+                  m_stats.m_found,
+                  m_stats.m_probes,
+                  m_stats.m_responses,
+                  m_stats.m_timeouts);
+  }
+
+  m_bRunning = false;
+  if (nullptr != cbDone) {
+    cbDone(getStats());
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+// Level II who-is-there response (CLASS2.PROTOCOL)
+#ifndef VSCP2_TYPE_PROTOCOL_WHO_IS_THERE_RESPONSE
+#define VSCP2_TYPE_PROTOCOL_WHO_IS_THERE_RESPONSE 32
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// isNullGuid
+//
+
+static bool
+isNullGuid(const uint8_t* pguid)
+{
+  for (int i = 0; i < 16; i++) {
+    if (pguid[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CNodeDiscovery::CNodeDiscovery(CVscpClient& client)
+  : m_client(client)
+{
+  m_quiet    = 1000;
+  m_retries  = 2;
+  m_bRunning = false;
+  m_bCancel  = false;
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CNodeDiscovery::~CNodeDiscovery()
+{
+  cancel();
+  wait();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+int
+CNodeDiscovery::start(foundcallback cbFound, donecallback cbDone)
+{
+  if (m_bRunning) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  // Join a previous discovery
+  wait();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    memset(&m_stats, 0, sizeof(m_stats));
+  }
+
+  m_assemblies.clear();
+  m_found.clear();
+  m_bCancel  = false;
+  m_bRunning = true;
+  m_thread   = std::thread(&CNodeDiscovery::worker, this, cbFound, cbDone);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// wait
+//
+
+void
+CNodeDiscovery::wait(void)
+{
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getStats
+//
+
+CNodeDiscovery::discoverystats
+CNodeDiscovery::getStats(void)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sendWhoIsThere
+//
+
+int
+CNodeDiscovery::sendWhoIsThere(const cguid& guidInterface, uint8_t nodeid)
+{
+  vscpEventEx ex;
+  memset(&ex, 0, sizeof(ex));
+  ex.head      = VSCP_PRIORITY_NORMAL;
+  ex.timestamp = vscp_makeTimeStamp();
+  vscp_setEventExDateTimeBlockToNow(&ex);
+
+  // On an interface it is sent as Level I over Level II with the
+  // interface GUID first in the data.
+  uint8_t pos = 0;
+  if (!isNullGuid(guidInterface.getGUID())) {
+    ex.vscp_class = VSCP_CLASS2_LEVEL1_PROTOCOL;
+    memcpy(ex.data, guidInterface.getGUID(), 16);
+    pos = 16;
+  }
+  else {
+    ex.vscp_class = VSCP_CLASS1_PROTOCOL;
+  }
+
+  ex.vscp_type     = VSCP_TYPE_PROTOCOL_WHO_IS_THERE;
+  ex.data[pos + 0] = nodeid;
+  ex.sizeData      = pos + 1;
+
+  int rv;
+  if (VSCP_ERROR_SUCCESS != (rv = m_client.send(ex))) {
+    spdlog::error("Node discovery: Failed to send who-is-there to {0} on {1} rv={2}",
+                  nodeid,
+                  guidInterface.getAsString(),
+                  rv);
+  }
+
+  return rv;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// handleEvent
+//
+
+int
+CNodeDiscovery::handleEvent(const vscpEventEx& ex, node* pnode)
+{
+  uint32_t now =
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start).count();
+
+  // Level II node: everything in one frame
+  if ((VSCP_CLASS2_PROTOCOL == ex.vscp_class) && (VSCP2_TYPE_PROTOCOL_WHO_IS_THERE_RESPONSE == ex.vscp_type)) {
+    if (ex.sizeData < 48) {
+      return -1;
+    }
+
+    char buf[65];
+    pnode->m_guid.getFromArray(ex.data);
+    pnode->m_guidInterface = cguid();
+    pnode->m_nodeid  = ex.data[15];
+    pnode->m_bLevel2 = true;
+    memcpy(buf, ex.data + 16, 32);
+    buf[32]          = 0;
+    pnode->m_mdfUrl  = buf;
+    size_t len       = (ex.sizeData > 48) ? std::min<size_t>(ex.sizeData - 48, 64) : 0;
+    memcpy(buf, ex.data + 48, len);
+    buf[len]         = 0;
+    pnode->m_name    = buf;
+    pnode->m_time    = now;
+    return 1;
+  }
+
+  // Level I node: seven frames, possibly wrapped in Level II with the
+  // interface GUID first in data
+  uint16_t vscp_class  = ex.vscp_class;
+  const uint8_t* pdata = ex.data;
+  uint16_t sizeData    = ex.sizeData;
+  if (VSCP_CLASS2_LEVEL1_PROTOCOL == vscp_class) {
+    if (sizeData < 16) {
+      return -1;
+    }
+    vscp_class = VSCP_CLASS1_PROTOCOL;
+    pdata += 16;
+    sizeData -= 16;
+  }
+
+  if ((VSCP_CLASS1_PROTOCOL != vscp_class) || (VSCP_TYPE_PROTOCOL_WHO_IS_THERE_RESPONSE != ex.vscp_type) ||
+      (sizeData < 2) || (pdata[0] >= LEVEL1_RESPONSE_FRAMES)) {
+    return -1;
+  }
+
+  // Frames are collected on the GUID of the responder. That is the
+  // interface GUID with the node id in the LSB.
+  std::string key((const char*)ex.GUID, 16);
+  auto it = m_assemblies.find(key);
+  if (it == m_assemblies.end()) {
+    uint8_t guid[16];
+    memcpy(guid, ex.GUID, 16);
+    guid[14] = 0;
+    guid[15] = 0;
+
+    assembly a;
+    a.m_guidInterface.getFromArray(guid);
+    a.m_nodeid  = ex.GUID[15];
+    a.m_mask    = 0;
+    a.m_retries = 0;
+    memset(a.m_data, 0, sizeof(a.m_data));
+    it = m_assemblies.insert(std::make_pair(key, a)).first;
+  }
+
+  assembly& a = it->second;
+  uint8_t idx = pdata[0];
+  memcpy(a.m_data + idx * 7, pdata + 1, std::min<uint16_t>(sizeData - 1, 7));
+  a.m_mask |= (1 << idx);
+  if (a.m_mask != ((1 << LEVEL1_RESPONSE_FRAMES) - 1)) {
+    return 0;
+  }
+
+  // GUID in the first 16 bytes, MDF URL in the next 32
+  char buf[33];
+  memcpy(buf, a.m_data + 16, 32);
+  buf[32] = 0;
+  pnode->m_guid.getFromArray(a.m_data);
+  pnode->m_guidInterface = a.m_guidInterface;
+  pnode->m_nodeid        = a.m_nodeid;
+  pnode->m_bLevel2       = false;
+  pnode->m_mdfUrl        = buf;
+  pnode->m_name.clear();
+  pnode->m_time = now;
+
+  // A node that answers again starts a new set of frames
+  m_assemblies.erase(it);
+  return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// report
+//
+
+void
+CNodeDiscovery::report(node& n, foundcallback& cbFound)
+{
+  // Nodes without a GUID are told apart on where they answered from
+  std::string key((const char*)n.m_guid.getGUID(), 16);
+  if (isNullGuid(n.m_guid.getGUID())) {
+    key += std::string((const char*)n.m_guidInterface.getGUID(), 16);
+    key += (char)n.m_nodeid;
+  }
+
+  if (!m_found.insert(key).second) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.m_duplicates++;
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.m_found++;
+  }
+
+  spdlog::debug("Node discovery: Found {0} node {1} id={2} on {3} after {4} ms",
+                n.m_bLevel2 ? "Level II" : "Level I",
+                n.m_guid.getAsString(),
+                n.m_nodeid,
+                n.m_guidInterface.getAsString(),
+                n.m_time);
+
+  if (nullptr != cbFound) {
+    cbFound(n);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// worker
+//
+
+void
+CNodeDiscovery::worker(foundcallback cbFound, donecallback cbDone)
+{
+  m_start = std::chrono::steady_clock::now();
+
+  std::deque<cguid> interfaces = m_interfaces;
+  if (interfaces.empty()) {
+    interfaces.push_back(cguid());
+  }
+
+  spdlog::debug("Node discovery: Probing {0} interface(s)", interfaces.size());
+
+  // Discard anything old in the receive queue
+  vscpEventEx ex;
+  while (VSCP_ERROR_SUCCESS == m_client.receive(ex)) {
+    ;
+  }
+
+  // Ask everyone at once, replies are sorted out as they arrive
+  for (const auto& guid : interfaces) {
+    if (VSCP_ERROR_SUCCESS == sendWhoIsThere(guid, 0xff)) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.m_probes++;
+    }
+  }
+
+  auto lastHeard = std::chrono::steady_clock::now();
+  while (!m_bCancel) {
+
+    // Drain everything received before sleeping so that a burst from
+    // many nodes does not pile up in the client
+    bool bIdle = true;
+    while (VSCP_ERROR_SUCCESS == m_client.receive(ex)) {
+      bIdle = false;
+      node n;
+      int rv = handleEvent(ex, &n);
+      if (-1 == rv) {
+        continue;
+      }
+      lastHeard = std::chrono::steady_clock::now();
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_frames++;
+      }
+      if (1 == rv) {
+        report(n, cbFound);
+      }
+      if (m_bCancel) {
+        break;
+      }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastHeard).count() < (int64_t)m_quiet) {
+      if (bIdle) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      continue;
+    }
+
+    // Quiet. Ask nodes that lost frames again, directly.
+    bool bRequery = false;
+    for (auto& item : m_assemblies) {
+      assembly& a = item.second;
+      if (a.m_retries >= m_retries) {
+        continue;
+      }
+      a.m_retries++;
+      spdlog::debug("Node discovery: Asking node {0} on {1} again (frames {2:x})",
+                    a.m_nodeid,
+                    a.m_guidInterface.getAsString(),
+                    a.m_mask);
+      if (VSCP_ERROR_SUCCESS == sendWhoIsThere(a.m_guidInterface, a.m_nodeid)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_requeries++;
+        bRequery = true;
+      }
+    }
+
+    if (!bRequery) {
+      break;
+    }
+    lastHeard = std::chrono::steady_clock::now();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.m_incomplete = m_assemblies.size();
+    m_stats.m_elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start).count();
+    spdlog::debug("Node discovery: Done in {0} ms, {1} found, {2} frames, {3} duplicates, {4} incomplete",
+                  m_stats.m_elapsed,
+                  m_stats.m_found,
+                  m_stats.m_frames,
+                  m_stats.m_duplicates,
+                  m_stats.m_incomplete);
+  }
+
+  m_bRunning = false;
+  if (nullptr != cbDone) {
+    cbDone(getStats());
+  }
+}
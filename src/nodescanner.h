@@ -0,0 +1,372 @@
+// nodescanner.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef NODESCANNER_H
+#define NODESCANNER_H
+
+#include <guid.h>
+#include <vscp-client-base.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+/*!
+  Level I node discovery that probes a list of node ids.
+
+  A sliding window of read register probes is kept outstanding and
+  replies are matched on the responding node as they arrive, so a node
+  that answers late is still found. The time a probe is waited for
+  (RTO) adapts from the observed response latency the same way TCP
+  does it: it starts at the max timeout and moves towards the smoothed
+  round trip time plus four times its variation once nodes answer.
+
+  The scan runs on its own thread. Callbacks are called from that
+  thread.
+*/
+
+class CNodeScanner {
+
+public:
+  /// Register read by the probe (first byte of GUID)
+  static const uint8_t PROBE_REGISTER = 0xd0;
+
+  /*!
+    Scan statistics
+  */
+  struct scanstats {
+    uint32_t m_probes;      // Probe frames sent
+    uint32_t m_responses;   // Probe responses received
+    uint32_t m_retransmits; // Probes sent again after a timeout
+    uint32_t m_timeouts;    // Nodes that did not answer
+    uint32_t m_unmatched;   // Responses from nodes not probed
+    uint32_t m_found;       // Nodes found
+    uint32_t m_done;        // Nodes probed to the end
+    uint32_t m_total;       // Nodes to probe
+    uint32_t m_srtt;        // Smoothed round trip time in ms (zero if none)
+    uint32_t m_rto;         // Current probe timeout in ms
+    uint32_t m_elapsed;     // Scan time in ms
+  };
+
+  /// Called when a node is found (nodeid, round trip time in ms)
+  typedef std::function<void(uint8_t, uint32_t)> foundcallback;
+
+  /// Called when the scan ends, also when cancelled
+  typedef std::function<void(const scanstats&)> donecallback;
+
+  /*!
+    @param client Connected client. Must not be used by anyone else
+                  while the scan is running.
+    @param guidInterface Interface to scan or all zero
+  */
+  CNodeScanner(CVscpClient& client, const cguid& guidInterface);
+  ~CNodeScanner();
+
+  /*!
+    Set number of probes that can be outstanding at the same time
+    @param window Window size (1-255)
+  */
+  void setWindow(uint16_t window) { m_window = window ? window : 1; };
+
+  /*!
+    Set the range for the adaptive probe timeout
+    @param minTimeout Lowest timeout in milliseconds
+    @param maxTimeout Timeout used until a node has answered, and
+                      highest timeout, in milliseconds
+  */
+  void setTimeout(uint32_t minTimeout, uint32_t maxTimeout);
+
+  /*!
+    Set number of times a probe is sent again before giving up
+    @param retries Number of retries
+  */
+  void setRetries(uint8_t retries) { m_retries = retries; };
+
+  /*!
+    Set least time between two probes
+    @param gap Gap in microseconds
+  */
+  void setProbeGap(uint32_t gap) { m_gap = gap; };
+
+  /*!
+    Start a scan on a worker thread
+    @param nodes Node ids to probe (1-254)
+    @param cbFound Called for each node found
+    @param cbDone Called when the scan ends
+    @return VSCP_ERROR_SUCCESS if started, VSCP_ERROR_PARAMETER if there
+            is nothing to scan, VSCP_ERROR_ERROR if a scan is running.
+  */
+  int start(const std::set<uint16_t>& nodes, foundcallback cbFound, donecallback cbDone = nullptr);
+
+  /*!
+    Cancel a running scan. The done callback is still called.
+  */
+  void cancel(void) { m_bCancel = true; };
+
+  /*!
+    Wait for the scan to end
+  */
+  void wait(void);
+
+  /*!
+    Check if a scan is running
+    @return True if running
+  */
+  bool isRunning(void) const { return m_bRunning; };
+
+  /*!
+    Get statistics for the running or last scan
+    @return Statistics
+  */
+  scanstats getStats(void);
+
+private:
+  /// Outstanding probe
+  struct probe {
+    uint8_t m_nodeid;
+    uint8_t m_retries;
+    std::chrono::steady_clock::time_point m_sent;
+  };
+
+  /// Scan loop
+  void worker(std::deque<uint8_t> nodes, foundcallback cbFound, donecallback cbDone);
+
+  /// Send a probe to a node
+  int sendProbe(uint8_t nodeid);
+
+  /*!
+    Check if an event is a probe response
+    @param ex Event to check
+    @return Node id of responder or -1 if not a probe response
+  */
+  int matchResponse(const vscpEventEx& ex) const;
+
+  /// Update the round trip estimate with a new sample
+  void updateRto(uint32_t rtt);
+
+  CVscpClient& m_client;
+  cguid m_guidInterface;
+  bool m_bInterface;
+
+  uint16_t m_window;
+  uint8_t m_retries;
+  uint32_t m_gap;
+  uint32_t m_minTimeout;
+  uint32_t m_maxTimeout;
+
+  /// Round trip estimate in ms, m_srtt < 0 until first sample
+  double m_srtt;
+  double m_rttvar;
+
+  std::thread m_thread;
+  std::atomic<bool> m_bRunning;
+  std::atomic<bool> m_bCancel;
+
+  std::mutex m_mutex;
+  scanstats m_stats;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+  Node discovery with who-is-there.
+
+  One who-is-there to all nodes is sent on each interface and on the
+  connection itself, and replies are collected from all of them at the
+  same time on a worker thread. Level II nodes answer with one frame
+  holding GUID, MDF URL and name. Level I nodes answer with seven frames
+  that are put together per responder. Nodes are reported on the GUID
+  they report so a node that answers more than once, or is seen on more
+  than one interface, is only reported once. Level I nodes that lost
+  frames on the way are asked again directly.
+
+  Discovery ends when nothing has been heard for the quiet time after
+  the last request. Callbacks are called from the worker thread.
+*/
+
+class CNodeDiscovery {
+
+public:
+  /// Number of frames in a Level I who-is-there response
+  static const uint8_t LEVEL1_RESPONSE_FRAMES = 7;
+
+  /*!
+    A discovered node
+  */
+  struct node {
+    cguid m_guid;           // GUID reported by the node
+    cguid m_guidInterface;  // Interface the node answered on (all zero if none)
+    uint8_t m_nodeid;       // Node id on the interface
+    bool m_bLevel2;         // Answered with a Level II response
+    std::string m_mdfUrl;   // MDF URL reported by the node
+    std::string m_name;     // Device name (Level II only)
+    uint32_t m_time;        // Time from start of discovery in ms
+  };
+
+  /*!
+    Discovery statistics
+  */
+  struct discoverystats {
+    uint32_t m_probes;      // who-is-there requests sent
+    uint32_t m_requeries;   // Requests sent to nodes with frames missing
+    uint32_t m_frames;      // Response frames received
+    uint32_t m_found;       // Nodes found
+    uint32_t m_duplicates;  // Responses from nodes already found
+    uint32_t m_incomplete;  // Level I nodes that never sent all frames
+    uint32_t m_elapsed;     // Discovery time in ms
+  };
+
+  /// Called for each node found
+  typedef std::function<void(const node&)> foundcallback;
+
+  /// Called when discovery ends, also when cancelled
+  typedef std::function<void(const discoverystats&)> donecallback;
+
+  /*!
+    @param client Connected client. Must not be used by anyone else
+                  while discovery is running.
+  */
+  CNodeDiscovery(CVscpClient& client);
+  ~CNodeDiscovery();
+
+  /*!
+    Set interfaces to probe. An all zero GUID probes the connection
+    itself. If no interfaces are set only the connection is probed.
+    @param interfaces Interface GUID's
+  */
+  void setInterfaces(const std::deque<cguid>& interfaces) { m_interfaces = interfaces; };
+
+  /*!
+    Set time to wait for more responses after the last request
+    @param quiet Quiet time in milliseconds
+  */
+  void setQuietTime(uint32_t quiet) { m_quiet = quiet ? quiet : 1; };
+
+  /*!
+    Set number of times a Level I node with missing frames is asked again
+    @param retries Number of retries
+  */
+  void setRetries(uint8_t retries) { m_retries = retries; };
+
+  /*!
+    Start discovery on a worker thread
+    @param cbFound Called for each node found
+    @param cbDone Called when discovery ends
+    @return VSCP_ERROR_SUCCESS if started, VSCP_ERROR_ERROR if discovery
+            is running.
+  */
+  int start(foundcallback cbFound, donecallback cbDone = nullptr);
+
+  /*!
+    Cancel discovery. The done callback is still called.
+  */
+  void cancel(void) { m_bCancel = true; };
+
+  /*!
+    Wait for discovery to end
+  */
+  void wait(void);
+
+  /*!
+    Check if discovery is running
+    @return True if running
+  */
+  bool isRunning(void) const { return m_bRunning; };
+
+  /*!
+    Get statistics for the running or last discovery
+    @return Statistics
+  */
+  discoverystats getStats(void);
+
+private:
+  /// Level I response frames from one responder
+  struct assembly {
+    cguid m_guidInterface;
+    uint8_t m_nodeid;
+    uint8_t m_mask;  // Bit set for each frame received
+    uint8_t m_data[LEVEL1_RESPONSE_FRAMES * 7];
+    uint8_t m_retries;
+  };
+
+  /// Discovery loop
+  void worker(foundcallback cbFound, donecallback cbDone);
+
+  /*!
+    Send who-is-there
+    @param guidInterface Interface to send on or all zero for the connection
+    @param nodeid Node to ask or 0xff for all
+    @return VSCP_ERROR_SUCCESS if sent
+  */
+  int sendWhoIsThere(const cguid& guidInterface, uint8_t nodeid);
+
+  /*!
+    Handle a received event
+    @param ex Event
+    @param pnode Filled in if the event completed a node
+    @return 1 if a node is complete, 0 if more frames are needed and
+            -1 if the event is not a who-is-there response.
+  */
+  int handleEvent(const vscpEventEx& ex, node* pnode);
+
+  /*!
+    Report a node unless it has been reported before
+    @param n Node
+    @param cbFound Callback
+  */
+  void report(node& n, foundcallback& cbFound);
+
+  CVscpClient& m_client;
+  std::deque<cguid> m_interfaces;
+  uint32_t m_quiet;
+  uint8_t m_retries;
+
+  /// Time discovery was started
+  std::chrono::steady_clock::time_point m_start;
+
+  /// Partial Level I responses on responder GUID
+  std::map<std::string, assembly> m_assemblies;
+
+  /// GUID's of reported nodes
+  std::set<std::string> m_found;
+
+  std::thread m_thread;
+  std::atomic<bool> m_bRunning;
+  std::atomic<bool> m_bCancel;
+
+  std::mutex m_mutex;
+  discoverystats m_stats;
+};
+
+#endif // NODESCANNER_H
@@ -0,0 +1,438 @@
+// registerbatch.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+#include <register.h>
+
+#include "registerbatch.h"
+
+#include <spdlog/spdlog.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CRegisterBatchWriter::CRegisterBatchWriter(CVscpClient& client,
+                                           const cguid& guidNode,
+                                           const cguid& guidInterface,
+                                           uint32_t timeout)
+  : m_client(client)
+{
+  m_guidNode      = guidNode;
+  m_guidInterface = guidInterface;
+  m_timeout       = timeout;
+  m_bSnapshot     = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CRegisterBatchWriter::~CRegisterBatchWriter()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// addRegister
+//
+
+void
+CRegisterBatchWriter::addRegister(uint16_t page, uint8_t offset, uint8_t value)
+{
+  regresult res;
+  res.m_page     = page;
+  res.m_offset   = offset;
+  res.m_oldValue = -1;
+  res.m_newValue = value;
+  res.m_readBack = -1;
+  res.m_status   = regstatus::PENDING;
+
+  m_results[makeKey(page, offset)] = res;
+  m_bSnapshot                      = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clear
+//
+
+void
+CRegisterBatchWriter::clear(void)
+{
+  m_results.clear();
+  m_spans.clear();
+  m_bSnapshot = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// buildSpans
+//
+
+void
+CRegisterBatchWriter::buildSpans(void)
+{
+  m_spans.clear();
+
+  // The result map is ordered on page:offset so a single pass is enough
+  for (auto const& item : m_results) {
+    const regresult& res = item.second;
+    if (!m_spans.empty()) {
+      regspan& last = m_spans.back();
+      if ((last.m_page == res.m_page) &&
+          ((uint32_t)res.m_offset <= ((uint32_t)last.m_offset + last.m_count + MAX_SPAN_GAP))) {
+        last.m_count = (uint16_t)(res.m_offset - last.m_offset + 1);
+        continue;
+      }
+    }
+
+    regspan span;
+    span.m_page   = res.m_page;
+    span.m_offset = res.m_offset;
+    span.m_count  = 1;
+    m_spans.push_back(span);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readSpan
+//
+
+int
+CRegisterBatchWriter::readSpan(const regspan& span, std::map<uint8_t, uint8_t>& values)
+{
+  values.clear();
+  return vscp_readLevel1RegisterBlock(m_client,
+                                      m_guidNode,
+                                      m_guidInterface,
+                                      span.m_page,
+                                      span.m_offset,
+                                      span.m_count,
+                                      values,
+                                      nullptr,
+                                      m_timeout);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writeSpan
+//
+
+int
+CRegisterBatchWriter::writeSpan(const regspan& span, bool bOld)
+{
+  int rv;
+  std::map<uint8_t, uint8_t> values;
+
+  // Collect the batch registers that belong to this span. Gap registers
+  // are never written.
+  for (uint16_t i = 0; i < span.m_count; i++) {
+    auto it = m_results.find(makeKey(span.m_page, (uint8_t)(span.m_offset + i)));
+    if (it == m_results.end()) {
+      continue;
+    }
+    if (bOld) {
+      if ((-1 == it->second.m_oldValue) || (regstatus::PENDING == it->second.m_status)) {
+        continue;
+      }
+      values[it->second.m_offset] = (uint8_t)it->second.m_oldValue;
+    }
+    else {
+      values[it->second.m_offset] = it->second.m_newValue;
+    }
+  }
+
+  if (values.empty()) {
+    return VSCP_ERROR_SUCCESS;
+  }
+
+  rv = vscp_writeLevel1RegisterBlock(m_client,
+                                     m_guidNode,
+                                     m_guidInterface,
+                                     span.m_page,
+                                     values,
+                                     nullptr,
+                                     m_timeout);
+  if (VSCP_ERROR_SUCCESS != rv) {
+    spdlog::error("Register batch: Failed to write span {0}:{1} count={2} rv={3}",
+                  span.m_page,
+                  span.m_offset,
+                  span.m_count,
+                  rv);
+    for (auto const& item : values) {
+      regresult& res = m_results[makeKey(span.m_page, item.first)];
+      res.m_status   = bOld ? regstatus::ROLLBACK_FAILED : regstatus::WRITE_FAILED;
+    }
+    return rv;
+  }
+
+  // Read back the whole span in one go
+  std::map<uint8_t, uint8_t> readback;
+  int rvRead = readSpan(span, readback);
+
+  int rvResult = VSCP_ERROR_SUCCESS;
+  for (auto const& item : values) {
+    regresult& res = m_results[makeKey(span.m_page, item.first)];
+    auto it        = readback.find(item.first);
+    if ((VSCP_ERROR_SUCCESS == rvRead) && (it != readback.end())) {
+      res.m_readBack = it->second;
+    }
+    else {
+      res.m_readBack = -1;
+    }
+
+    if (res.m_readBack == (int)item.second) {
+      res.m_status = bOld ? regstatus::ROLLED_BACK : regstatus::VERIFIED;
+    }
+    else {
+      res.m_status = bOld ? regstatus::ROLLBACK_FAILED : regstatus::VERIFY_FAILED;
+      rvResult     = VSCP_ERROR_ERROR;
+      spdlog::error("Register batch: Verify failed for {0}:{1} wrote={2} read={3}",
+                    res.m_page,
+                    res.m_offset,
+                    item.second,
+                    res.m_readBack);
+    }
+  }
+
+  return rvResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write
+//
+
+int
+CRegisterBatchWriter::write(std::function<void(int, const char*)> statusCallback)
+{
+  int rv;
+
+  buildSpans();
+  if (m_spans.empty()) {
+    return VSCP_ERROR_SUCCESS;
+  }
+
+  // Reset state from a previous run
+  for (auto& item : m_results) {
+    item.second.m_oldValue = -1;
+    item.second.m_readBack = -1;
+    item.second.m_status   = regstatus::PENDING;
+  }
+  m_bSnapshot = false;
+
+  // * * * Pre-write image * * *
+
+  if (nullptr != statusCallback) {
+    statusCallback(0, "Reading pre-write image");
+  }
+
+  for (auto const& span : m_spans) {
+    std::map<uint8_t, uint8_t> values;
+    if (VSCP_ERROR_SUCCESS != (rv = readSpan(span, values))) {
+      spdlog::error("Register batch: Failed to read pre-write image for span {0}:{1} rv={2}",
+                    span.m_page,
+                    span.m_offset,
+                    rv);
+      // Nothing has been written yet so the device is untouched
+      return rv;
+    }
+    for (auto const& val : values) {
+      auto it = m_results.find(makeKey(span.m_page, val.first));
+      if (it != m_results.end()) {
+        it->second.m_oldValue = val.second;
+      }
+    }
+  }
+  m_bSnapshot = true;
+
+  // * * * Write and verify * * *
+
+  size_t idx = 0;
+  for (auto const& span : m_spans) {
+    if (nullptr != statusCallback) {
+      statusCallback((int)(10 + (90 * idx) / m_spans.size()), "Writing and verifying registers");
+    }
+    idx++;
+
+    if (VSCP_ERROR_SUCCESS != (rv = writeSpan(span, false))) {
+      // Leave the rest of the batch untouched
+      if (nullptr != statusCallback) {
+        statusCallback(100, "Write failed");
+      }
+      return rv;
+    }
+  }
+
+  if (nullptr != statusCallback) {
+    statusCallback(100, "Registers written and verified");
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// canRollback
+//
+
+bool
+CRegisterBatchWriter::canRollback(void) const
+{
+  if (!m_bSnapshot) {
+    return false;
+  }
+
+  for (auto const& item : m_results) {
+    if ((regstatus::WRITE_FAILED == item.second.m_status) ||
+        (regstatus::VERIFY_FAILED == item.second.m_status)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// rollback
+//
+
+int
+CRegisterBatchWriter::rollback(std::function<void(int, const char*)> statusCallback)
+{
+  int rv       = VSCP_ERROR_SUCCESS;
+  int rvResult = VSCP_ERROR_SUCCESS;
+
+  if (!m_bSnapshot) {
+    return VSCP_ERROR_ERROR;
+  }
+
+  // Restore in reverse order so the device passes through the same
+  // intermediate states as it did when written.
+  size_t idx = 0;
+  for (auto it = m_spans.rbegin(); it != m_spans.rend(); ++it) {
+    if (nullptr != statusCallback) {
+      statusCallback((int)((100 * idx) / m_spans.size()), "Restoring pre-write image");
+    }
+    idx++;
+
+    // A failing span should not stop restore of the others
+    if (VSCP_ERROR_SUCCESS != (rv = writeSpan(*it, true))) {
+      rvResult = rv;
+    }
+  }
+
+  if (nullptr != statusCallback) {
+    statusCallback(100, "Pre-write image restored");
+  }
+
+  return rvResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getCount
+//
+
+size_t
+CRegisterBatchWriter::getCount(regstatus status) const
+{
+  size_t cnt = 0;
+  for (auto const& item : m_results) {
+    if (status == item.second.m_status) {
+      cnt++;
+    }
+  }
+  return cnt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// statusToString
+//
+
+const char*
+CRegisterBatchWriter::statusToString(regstatus status)
+{
+  switch (status) {
+    case regstatus::PENDING:
+      return "not written";
+    case regstatus::VERIFIED:
+      return "written and verified";
+    case regstatus::WRITE_FAILED:
+      return "write failed";
+    case regstatus::VERIFY_FAILED:
+      return "verify failed";
+    case regstatus::ROLLED_BACK:
+      return "rolled back";
+    case regstatus::ROLLBACK_FAILED:
+      return "rollback failed";
+  }
+  return "unknown";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getSummary
+//
+
+std::string
+CRegisterBatchWriter::getSummary(void) const
+{
+  std::string str;
+  str = vscp_str_format("%zu register(s) in %zu block(s): ", m_results.size(), m_spans.size());
+  str += vscp_str_format("%zu verified, %zu write failed, %zu verify failed, %zu not written",
+                         getCount(regstatus::VERIFIED),
+                         getCount(regstatus::WRITE_FAILED),
+                         getCount(regstatus::VERIFY_FAILED),
+                         getCount(regstatus::PENDING));
+  if (getCount(regstatus::ROLLED_BACK) || getCount(regstatus::ROLLBACK_FAILED)) {
+    str += vscp_str_format(", %zu rolled back, %zu rollback failed",
+                           getCount(regstatus::ROLLED_BACK),
+                           getCount(regstatus::ROLLBACK_FAILED));
+  }
+  return str;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getReport
+//
+
+std::string
+CRegisterBatchWriter::getReport(void) const
+{
+  std::string str;
+  for (auto const& item : m_results) {
+    const regresult& res = item.second;
+    str += vscp_str_format("%u:%u  ", res.m_page, res.m_offset);
+    str += vscp_str_format("old=%s new=%u read=%s  %s\n",
+                           (-1 == res.m_oldValue) ? "---" : std::to_string(res.m_oldValue).c_str(),
+                           res.m_newValue,
+                           (-1 == res.m_readBack) ? "---" : std::to_string(res.m_readBack).c_str(),
+                           statusToString(res.m_status));
+  }
+  return str;
+}
@@ -0,0 +1,236 @@
+// registerbatch.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef REGISTERBATCH_H
+#define REGISTERBATCH_H
+
+#include <guid.h>
+#include <vscp-client-base.h>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+
+/*!
+  Writes a set of Level I registers to one node as a single transaction.
+
+  Changed registers are grouped into page spans. Before anything is written
+  the spans are read from the device to form a pre-write image. Each span
+  is then written as a block and read back as a block so that write and
+  verification use the multi frame register operations instead of one
+  request/response round trip per register. If any register fails to
+  write or verify the pre-write image can be written back with rollback().
+
+  Spans for one node are written and read back one after the other. A
+  Level I node handles one register request at a time, so the write of
+  the next span is not overlapped with the read back of the current one.
+  The time saved comes from the block operations within a span. Batches
+  for many nodes are pipelined across nodes by CDlgFleetApply.
+*/
+
+class CRegisterBatchWriter {
+
+public:
+  /*!
+    State for a register in the batch
+  */
+  enum class regstatus { PENDING = 0,     // Not written (yet)
+                         VERIFIED,        // Written and read back OK
+                         WRITE_FAILED,    // Block write failed
+                         VERIFY_FAILED,   // Read back value differs or read failed
+                         ROLLED_BACK,     // Pre-write value restored
+                         ROLLBACK_FAILED  // Pre-write value could not be restored
+  };
+
+  /*!
+    Result for one register in the batch
+  */
+  struct regresult {
+    uint16_t m_page;
+    uint8_t m_offset;
+    int m_oldValue;  // Pre-write value or -1 if unknown
+    uint8_t m_newValue;
+    int m_readBack;  // Last read back value or -1 if not read
+    regstatus m_status;
+  };
+
+  /*!
+    A run of registers on a page that is read/written as one block
+  */
+  struct regspan {
+    uint16_t m_page;
+    uint8_t m_offset;
+    uint16_t m_count;
+  };
+
+  /*!
+    Registers that are closer than this are read back in the same
+    block even if the registers in between are not part of the batch.
+  */
+  static const uint8_t MAX_SPAN_GAP = 4;
+
+  CRegisterBatchWriter(CVscpClient& client,
+                       const cguid& guidNode,
+                       const cguid& guidInterface,
+                       uint32_t timeout);
+  ~CRegisterBatchWriter();
+
+  /*!
+    Add a register to the batch. Adding the same register twice
+    replaces the value.
+    @param page Register page
+    @param offset Register offset
+    @param value Value to write
+  */
+  void addRegister(uint16_t page, uint8_t offset, uint8_t value);
+
+  /*!
+    Remove all registers and results from the batch
+  */
+  void clear(void);
+
+  /*!
+    Get number of registers in the batch
+    @return Number of registers
+  */
+  size_t getCount(void) const { return m_results.size(); };
+
+  /*!
+    Read the pre-write image, write all registers and verify them.
+    The batch stops writing on the first failing span so that the
+    remaining spans are left untouched (PENDING).
+    @param statusCallback Optional progress callback (percent, message)
+    @return VSCP_ERROR_SUCCESS if all registers were written and verified.
+  */
+  int write(std::function<void(int, const char*)> statusCallback = nullptr);
+
+  /*!
+    Write the pre-write image back for all registers that was touched
+    by write() and verify the result.
+    @param statusCallback Optional progress callback (percent, message)
+    @return VSCP_ERROR_SUCCESS if the pre-write image was restored.
+  */
+  int rollback(std::function<void(int, const char*)> statusCallback = nullptr);
+
+  /*!
+    Check if a rollback is possible, that is a pre-write image is
+    available and at least one register was not verified.
+    @return True if rollback can be performed.
+  */
+  bool canRollback(void) const;
+
+  /*!
+    Get number of registers with a specific status
+    @param status Status to count
+    @return Number of registers with the status.
+  */
+  size_t getCount(regstatus status) const;
+
+  /*!
+    Get results for all registers ordered on page:offset
+    @return Map with (page << 8) + offset as key.
+  */
+  const std::map<uint32_t, regresult>& getResults(void) const { return m_results; };
+
+  /*!
+    Get the spans the batch is transferred in
+    @return List with spans
+  */
+  const std::deque<regspan>& getSpans(void) const { return m_spans; };
+
+  /*!
+    Get a one line summary of the last operation
+    @return Summary string
+  */
+  std::string getSummary(void) const;
+
+  /*!
+    Get a report with one line per register
+    @return Report string
+  */
+  std::string getReport(void) const;
+
+  /*!
+    Get a readable string for a status code
+    @param status Status to convert
+    @return Status as string
+  */
+  static const char* statusToString(regstatus status);
+
+private:
+  /*!
+    Build the list of spans from the registers in the batch
+  */
+  void buildSpans(void);
+
+  /*!
+    Read a span from the device
+    @param span Span to read
+    @param values Filled with offset/value pairs on success
+    @return VSCP_ERROR_SUCCESS on success
+  */
+  int readSpan(const regspan& span, std::map<uint8_t, uint8_t>& values);
+
+  /*!
+    Write values for a span and read them back.
+    @param span Span to write
+    @param bOld If true write the pre-write image, else the new values
+    @return VSCP_ERROR_SUCCESS if written and verified.
+  */
+  int writeSpan(const regspan& span, bool bOld);
+
+  /// Key for the result map
+  static uint32_t makeKey(uint16_t page, uint8_t offset)
+  {
+    return ((uint32_t)page << 8) + offset;
+  };
+
+  /// Client to use for communication
+  CVscpClient& m_client;
+
+  /// GUID for the node (LSB is node id)
+  cguid m_guidNode;
+
+  /// GUID for the interface the node is on
+  cguid m_guidInterface;
+
+  /// Response timeout in milliseconds
+  uint32_t m_timeout;
+
+  /// True when a pre-write image has been read
+  bool m_bSnapshot;
+
+  /// Per register result
+  std::map<uint32_t, regresult> m_results;
+
+  /// Spans for read/write
+  std::deque<regspan> m_spans;
+};
+
+#endif // REGISTERBATCH_H
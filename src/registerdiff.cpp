@@ -0,0 +1,288 @@
+// registerdiff.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "registerdiff.h"
+
+#include <set>
+#include <string.h>
+
+// ----------------------------------------------------------------------------
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CRegisterImage::CRegisterImage(const std::string& name)
+{
+  m_name = name;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CRegisterImage::~CRegisterImage()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// setReg
+//
+
+void
+CRegisterImage::setReg(uint16_t page, uint8_t offset, uint8_t value)
+{
+  if (offset >= PAGE_SIZE) {
+    return;
+  }
+
+  auto it = m_pages.find(page);
+  if (it == m_pages.end()) {
+    regpage empty;
+    memset(&empty, 0, sizeof(empty));
+    it = m_pages.emplace(page, empty).first;
+  }
+
+  it->second.m_value[offset] = value;
+  it->second.m_valid[offset >> 3] |= (1 << (offset & 7));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getReg
+//
+
+int
+CRegisterImage::getReg(uint16_t page, uint8_t offset) const
+{
+  if (offset >= PAGE_SIZE) {
+    return -1;
+  }
+
+  auto it = m_pages.find(page);
+  if ((it == m_pages.end()) || !(it->second.m_valid[offset >> 3] & (1 << (offset & 7)))) {
+    return -1;
+  }
+
+  return it->second.m_value[offset];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fromUserRegisters
+//
+
+size_t
+CRegisterImage::fromUserRegisters(CUserRegisters& regs)
+{
+  size_t cnt = 0;
+  clear();
+
+  std::set<long>* ppages = regs.getPages();
+  if (nullptr == ppages) {
+    return 0;
+  }
+
+  for (auto page : *ppages) {
+    for (uint8_t offset = 0; offset < PAGE_SIZE; offset++) {
+      int value = regs.getReg(offset, page);
+      if (-1 != value) {
+        setReg((uint16_t)page, offset, (uint8_t)value);
+        cnt++;
+      }
+    }
+  }
+
+  return cnt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// toUserRegisters
+//
+
+size_t
+CRegisterImage::toUserRegisters(CUserRegisters& regs) const
+{
+  size_t cnt = 0;
+
+  for (auto const& item : m_pages) {
+    for (uint8_t offset = 0; offset < PAGE_SIZE; offset++) {
+      if (item.second.m_valid[offset >> 3] & (1 << (offset & 7))) {
+        if (regs.putReg(offset, item.first, item.second.m_value[offset])) {
+          cnt++;
+        }
+      }
+    }
+  }
+
+  return cnt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fromMap
+//
+
+size_t
+CRegisterImage::fromMap(const std::map<uint32_t, uint8_t>& regs)
+{
+  size_t cnt = 0;
+  clear();
+
+  for (auto const& item : regs) {
+    if ((item.first & 0xff) < PAGE_SIZE) {
+      setReg(item.first >> 8, item.first & 0xff, item.second);
+      cnt++;
+    }
+  }
+
+  return cnt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getCount
+//
+
+size_t
+CRegisterImage::getCount(void) const
+{
+  size_t cnt = 0;
+  for (auto const& item : m_pages) {
+    for (size_t i = 0; i < sizeof(item.second.m_valid); i++) {
+      uint8_t mask = item.second.m_valid[i];
+      while (mask) {
+        cnt += (mask & 1);
+        mask >>= 1;
+      }
+    }
+  }
+  return cnt;
+}
+
+// ----------------------------------------------------------------------------
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CRegisterDiff::CRegisterDiff()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CRegisterDiff::~CRegisterDiff()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// compare
+//
+
+int
+CRegisterDiff::compare(const std::vector<const CRegisterImage*>& images, size_t ref, bool bAll)
+{
+  m_rows.clear();
+  m_diffCount.assign(images.size(), 0);
+
+  if (images.empty() || (images.size() > MAX_IMAGES) || (ref >= images.size())) {
+    return VSCP_ERROR_PARAMETER;
+  }
+
+  // Union of all pages
+  std::set<uint16_t> pages;
+  for (auto pimg : images) {
+    for (auto const& item : pimg->getPages()) {
+      pages.insert(item.first);
+    }
+  }
+
+  const size_t cnt = images.size();
+  std::vector<const CRegisterImage::regpage*> ppages(cnt);
+
+  for (auto page : pages) {
+
+    // Page for every image, null if the image does not have it
+    for (size_t i = 0; i < cnt; i++) {
+      auto it   = images[i]->getPages().find(page);
+      ppages[i] = (it == images[i]->getPages().end()) ? nullptr : &it->second;
+    }
+
+    // Skip pages that are identical in all images with a block compare
+    bool bSame = (nullptr != ppages[ref]);
+    for (size_t i = 0; (i < cnt) && bSame; i++) {
+      bSame = (nullptr != ppages[i]) && !memcmp(ppages[i], ppages[ref], sizeof(CRegisterImage::regpage));
+    }
+
+    if (bSame && !bAll) {
+      continue;
+    }
+
+    const CRegisterImage::regpage* pref = ppages[ref];
+    for (uint8_t offset = 0; offset < CRegisterImage::PAGE_SIZE; offset++) {
+
+      uint8_t bit    = 1 << (offset & 7);
+      bool bRefValid = (nullptr != pref) && (pref->m_valid[offset >> 3] & bit);
+      uint8_t refval = (nullptr != pref) ? pref->m_value[offset] : 0;
+      bool bAnyValid = bRefValid;
+      uint64_t mask  = 0;
+
+      for (size_t i = 0; i < cnt; i++) {
+        const CRegisterImage::regpage* p = ppages[i];
+        bool bValid                      = (nullptr != p) && (p->m_valid[offset >> 3] & bit);
+        bAnyValid |= bValid;
+        if ((bValid != bRefValid) || (bValid && (p->m_value[offset] != refval))) {
+          mask |= ((uint64_t)1 << i);
+          m_diffCount[i]++;
+        }
+      }
+
+      // Registers no image knows about are not interesting
+      if (!bAnyValid || (!mask && !bAll)) {
+        continue;
+      }
+
+      diffrow row;
+      row.m_page     = page;
+      row.m_offset   = offset;
+      row.m_diffMask = mask;
+      m_rows.push_back(row);
+    }
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
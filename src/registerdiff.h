@@ -0,0 +1,177 @@
+// registerdiff.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef REGISTERDIFF_H
+#define REGISTERDIFF_H
+
+#include <register.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+/*!
+  Register image for one node or one saved register set.
+
+  Each page is stored packed as 128 values and a bit mask telling which
+  of them are known, so that images can be compared a page at a time.
+*/
+
+class CRegisterImage {
+
+public:
+  /// Number of user registers on a Level I page
+  static const uint16_t PAGE_SIZE = 128;
+
+  /// One page of registers
+  struct regpage {
+    uint8_t m_value[PAGE_SIZE];
+    uint8_t m_valid[PAGE_SIZE / 8];
+  };
+
+  CRegisterImage(const std::string& name = "");
+  ~CRegisterImage();
+
+  /// Name shown for the image (node, file, ...)
+  void setName(const std::string& name) { m_name = name; };
+  const std::string& getName(void) const { return m_name; };
+
+  /*!
+    Remove all registers
+  */
+  void clear(void) { m_pages.clear(); };
+
+  /*!
+    Set a register value. Offsets outside the user area are ignored.
+    @param page Register page
+    @param offset Register offset
+    @param value Register value
+  */
+  void setReg(uint16_t page, uint8_t offset, uint8_t value);
+
+  /*!
+    Get a register value
+    @param page Register page
+    @param offset Register offset
+    @return Value or -1 if the register is not in the image
+  */
+  int getReg(uint16_t page, uint8_t offset) const;
+
+  /*!
+    Fill the image from the registers read from a device
+    @param regs Registers to copy
+    @return Number of registers copied
+  */
+  size_t fromUserRegisters(CUserRegisters& regs);
+
+  /*!
+    Copy the image to a register set so it can be decoded with the
+    register helpers (remote variables, ...)
+    @param regs Registers to write to
+    @return Number of registers copied
+  */
+  size_t toUserRegisters(CUserRegisters& regs) const;
+
+  /*!
+    Fill the image from a register set
+    @param regs Values keyed on (page << 8) + offset
+    @return Number of registers copied
+  */
+  size_t fromMap(const std::map<uint32_t, uint8_t>& regs);
+
+  /*!
+    Get the pages in the image
+    @return Map with pages
+  */
+  const std::map<uint16_t, regpage>& getPages(void) const { return m_pages; };
+
+  /*!
+    Get number of known registers
+    @return Number of registers
+  */
+  size_t getCount(void) const;
+
+private:
+  std::string m_name;
+  std::map<uint16_t, regpage> m_pages;
+};
+
+/*!
+  Page/offset aligned comparison of register images.
+
+  All images are compared against a reference image in one pass over
+  the union of their pages. Pages that are identical in every image are
+  skipped with a block compare. The result is one row per register that
+  differs in at least one image.
+*/
+
+class CRegisterDiff {
+
+public:
+  /// Max number of images that can be compared at once
+  static const size_t MAX_IMAGES = 64;
+
+  /// One register that differs
+  struct diffrow {
+    uint16_t m_page;
+    uint8_t m_offset;
+    uint64_t m_diffMask; // Bit n is set if image n differs from the reference
+  };
+
+  CRegisterDiff();
+  ~CRegisterDiff();
+
+  /*!
+    Compare images
+    @param images Images to compare
+    @param ref Index of the reference image
+    @param bAll If true rows for equal registers are also produced
+    @return VSCP_ERROR_SUCCESS or VSCP_ERROR_PARAMETER if there are too
+            many images or the reference is invalid.
+  */
+  int compare(const std::vector<const CRegisterImage*>& images, size_t ref, bool bAll = false);
+
+  /*!
+    Get the rows from the last compare
+    @return Rows ordered on page:offset
+  */
+  const std::vector<diffrow>& getRows(void) const { return m_rows; };
+
+  /*!
+    Get number of registers that differ from the reference for an image
+    @param idx Image index
+    @return Number of registers
+  */
+  size_t getDiffCount(size_t idx) const { return (idx < m_diffCount.size()) ? m_diffCount[idx] : 0; };
+
+private:
+  std::vector<diffrow> m_rows;
+  std::vector<size_t> m_diffCount;
+};
+
+#endif // REGISTERDIFF_H
@@ -0,0 +1,578 @@
+// registerpipeline.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "registerpipeline.h"
+
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CRegisterPipeline::CRegisterPipeline(CVscpClient& client,
+                                     const cguid& guidInterface,
+                                     uint32_t timeout,
+                                     uint16_t window,
+                                     uint8_t retries)
+  : m_client(client)
+{
+  m_guidInterface = guidInterface;
+  m_bInterface    = false;
+  m_timeout       = timeout;
+  m_window        = window ? window : 1;
+  m_retries       = retries;
+  m_nextId        = 1;
+  m_pending       = 0;
+  m_inflight      = 0;
+  memset(&m_stats, 0, sizeof(m_stats));
+
+  // A null interface GUID means the nodes are reached directly
+  const uint8_t* pguid = m_guidInterface.getGUID();
+  for (int i = 0; i < 16; i++) {
+    if (pguid[i]) {
+      m_bInterface = true;
+      break;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CRegisterPipeline::~CRegisterPipeline()
+{
+  ;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// read
+//
+
+uint32_t
+CRegisterPipeline::read(uint8_t nodeid, uint16_t page, uint8_t offset, uint8_t count, opcallback cb)
+{
+  if (!count) {
+    return 0;
+  }
+
+  queuedop qop;
+  qop.m_op.m_nodeid  = nodeid;
+  qop.m_op.m_bLevel2 = false;
+  qop.m_op.m_reg     = 0;
+  qop.m_op.m_type    = optype::READ;
+  qop.m_op.m_page    = page;
+  qop.m_op.m_offset  = offset;
+  qop.m_op.m_count   = count;
+  qop.m_op.m_data.assign(count, 0);
+  qop.m_cb = cb;
+
+  return enqueue(qop);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write
+//
+
+uint32_t
+CRegisterPipeline::write(uint8_t nodeid,
+                         uint16_t page,
+                         uint8_t offset,
+                         const std::vector<uint8_t>& values,
+                         opcallback cb)
+{
+  if (values.empty() || (values.size() > MAX_WRITE_COUNT)) {
+    return 0;
+  }
+
+  queuedop qop;
+  qop.m_op.m_nodeid  = nodeid;
+  qop.m_op.m_bLevel2 = false;
+  qop.m_op.m_reg     = 0;
+  qop.m_op.m_type    = optype::WRITE;
+  qop.m_op.m_page    = page;
+  qop.m_op.m_offset  = offset;
+  qop.m_op.m_count   = (uint8_t)values.size();
+  qop.m_op.m_data    = values;
+  qop.m_op.m_response.assign(values.size(), 0);
+  qop.m_cb = cb;
+
+  return enqueue(qop);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readLevel2
+//
+
+uint32_t
+CRegisterPipeline::readLevel2(const cguid& guid, uint32_t reg, uint8_t count, opcallback cb)
+{
+  if (!count) {
+    return 0;
+  }
+
+  queuedop qop;
+  qop.m_op.m_nodeid  = guid.getGUID()[15];
+  qop.m_op.m_bLevel2 = true;
+  qop.m_op.m_guid    = guid;
+  qop.m_op.m_reg     = reg;
+  qop.m_op.m_type    = optype::READ;
+  qop.m_op.m_page    = 0;
+  qop.m_op.m_offset  = 0;
+  qop.m_op.m_count   = count;
+  qop.m_op.m_data.assign(count, 0);
+  qop.m_cb = cb;
+
+  return enqueue(qop);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writeLevel2
+//
+
+uint32_t
+CRegisterPipeline::writeLevel2(const cguid& guid,
+                               uint32_t reg,
+                               const std::vector<uint8_t>& values,
+                               opcallback cb)
+{
+  if (values.empty() || (values.size() > 0xff)) {
+    return 0;
+  }
+
+  queuedop qop;
+  qop.m_op.m_nodeid  = guid.getGUID()[15];
+  qop.m_op.m_bLevel2 = true;
+  qop.m_op.m_guid    = guid;
+  qop.m_op.m_reg     = reg;
+  qop.m_op.m_type    = optype::WRITE;
+  qop.m_op.m_page    = 0;
+  qop.m_op.m_offset  = 0;
+  qop.m_op.m_count   = (uint8_t)values.size();
+  qop.m_op.m_data    = values;
+  qop.m_op.m_response.assign(values.size(), 0);
+  qop.m_cb = cb;
+
+  return enqueue(qop);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// enqueue
+//
+
+uint32_t
+CRegisterPipeline::enqueue(queuedop& qop)
+{
+  qop.m_op.m_id       = m_nextId++;
+  qop.m_op.m_received = 0;
+  qop.m_op.m_retries  = 0;
+  qop.m_op.m_status   = opstatus::PENDING;
+
+  std::string key = qop.m_op.m_bLevel2 ? makeKey(qop.m_op.m_guid) : makeKey(qop.m_op.m_nodeid);
+  m_queues[key].push_back(qop);
+  m_pending++;
+
+  return qop.m_op.m_id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// describe
+//
+
+std::string
+CRegisterPipeline::describe(const regop& op)
+{
+  if (op.m_bLevel2) {
+    return vscp_str_format("node %s (0x%08X)", op.m_guid.getAsString().c_str(), op.m_reg);
+  }
+  return vscp_str_format("node %d (%d:%d)", op.m_nodeid, op.m_page, op.m_offset);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sendRequest
+//
+
+int
+CRegisterPipeline::sendRequest(regop& op)
+{
+  vscpEventEx ex;
+  memset(&ex, 0, sizeof(ex));
+  ex.head      = VSCP_PRIORITY_NORMAL;
+  ex.timestamp = vscp_makeTimeStamp();
+  vscp_setEventExDateTimeBlockToNow(&ex);
+
+  // Level II nodes are addressed with their GUID first in the data
+  if (op.m_bLevel2) {
+    ex.vscp_class = VSCP_CLASS2_PROTOCOL;
+    memcpy(ex.data, op.m_guid.getGUID(), 16);
+    ex.data[16] = (op.m_reg >> 24) & 0xff;
+    ex.data[17] = (op.m_reg >> 16) & 0xff;
+    ex.data[18] = (op.m_reg >> 8) & 0xff;
+    ex.data[19] = op.m_reg & 0xff;
+    if (optype::READ == op.m_type) {
+      ex.vscp_type = VSCP2_TYPE_PROTOCOL_READ_REGISTER;
+      ex.data[20] = 0;
+      ex.data[21] = op.m_count;
+      ex.sizeData = 22;
+    }
+    else {
+      ex.vscp_type = VSCP2_TYPE_PROTOCOL_WRITE_REGISTER;
+      memcpy(ex.data + 20, op.m_data.data(), op.m_count);
+      ex.sizeData = 20 + op.m_count;
+    }
+    return send(ex, op, 16);
+  }
+
+  // Frames to a node on an interface are sent as Level I over Level II
+  // with the interface GUID first in the data.
+  uint8_t pos = 0;
+  if (m_bInterface) {
+    ex.vscp_class = VSCP_CLASS2_LEVEL1_PROTOCOL;
+    memcpy(ex.data, m_guidInterface.getGUID(), 16);
+    pos = 16;
+  }
+  else {
+    ex.vscp_class = VSCP_CLASS1_PROTOCOL;
+  }
+
+  ex.data[pos + 0] = op.m_nodeid;
+  ex.data[pos + 1] = (op.m_page >> 8) & 0xff;
+  ex.data[pos + 2] = op.m_page & 0xff;
+  ex.data[pos + 3] = op.m_offset;
+
+  if (optype::READ == op.m_type) {
+    ex.vscp_type     = VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_READ;
+    ex.data[pos + 4] = op.m_count;
+    ex.sizeData      = pos + 5;
+  }
+  else {
+    ex.vscp_type = VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_WRITE;
+    memcpy(ex.data + pos + 4, op.m_data.data(), op.m_count);
+    ex.sizeData = pos + 4 + op.m_count;
+  }
+
+  return send(ex, op, pos);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// send
+//
+
+int
+CRegisterPipeline::send(vscpEventEx& ex, regop& op, uint8_t addrSize)
+{
+  int rv;
+  if (VSCP_ERROR_SUCCESS != (rv = m_client.send(ex))) {
+    spdlog::error("Register pipeline: Failed to send request to {0} rv={1}", describe(op), rv);
+    return rv;
+  }
+
+  m_stats.m_sent++;
+  m_stats.m_sentBytes += ex.sizeData - addrSize;
+  op.m_received = 0;
+  op.m_sent     = std::chrono::steady_clock::now();
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// complete
+//
+
+void
+CRegisterPipeline::complete(const std::string& key, opstatus status)
+{
+  auto it = m_queues.find(key);
+  if ((it == m_queues.end()) || it->second.empty()) {
+    return;
+  }
+
+  // Take the operation off the queue before calling back so the callback
+  // is free to queue more operations for the node.
+  queuedop qop = it->second.front();
+  it->second.pop_front();
+  if (it->second.empty()) {
+    m_queues.erase(it);
+  }
+
+  if (opstatus::ACTIVE == qop.m_op.m_status) {
+    m_inflight--;
+  }
+
+  m_pending--;
+  qop.m_op.m_status = status;
+  if (opstatus::TIMEOUT == status) {
+    m_stats.m_timeouts++;
+  }
+
+  if (nullptr != qop.m_cb) {
+    qop.m_cb(qop.m_op);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// handleEvent
+//
+
+bool
+CRegisterPipeline::handleEvent(const vscpEventEx& ex)
+{
+  // Level II nodes answer with their GUID as origin and the register
+  // address first in data
+  if (VSCP_CLASS2_PROTOCOL == ex.vscp_class) {
+    if ((VSCP2_TYPE_PROTOCOL_READ_WRITE_RESPONSE != ex.vscp_type) || (ex.sizeData < 5)) {
+      return false;
+    }
+    uint32_t reg = ((uint32_t)ex.data[0] << 24) + ((uint32_t)ex.data[1] << 16) +
+                   ((uint32_t)ex.data[2] << 8) + ex.data[3];
+    return handleResponse(std::string((const char*)ex.GUID, 16), reg, ex.data + 4, ex.sizeData - 4);
+  }
+
+  uint16_t vscp_class = ex.vscp_class;
+  const uint8_t* pdata = ex.data;
+  uint16_t sizeData    = ex.sizeData;
+
+  // Level I over Level II have the interface GUID first in data
+  if (VSCP_CLASS2_LEVEL1_PROTOCOL == vscp_class) {
+    if (sizeData < 16) {
+      return false;
+    }
+    vscp_class = VSCP_CLASS1_PROTOCOL;
+    pdata += 16;
+    sizeData -= 16;
+  }
+
+  if ((VSCP_CLASS1_PROTOCOL != vscp_class) ||
+      (VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_RESPONSE != ex.vscp_type) ||
+      (sizeData < 5)) {
+    return false;
+  }
+
+  // Responding node is in the LSB of the GUID. Page and register are
+  // packed so that the register ends up in the low byte.
+  uint32_t reg = ((uint32_t)pdata[1] << 16) + ((uint32_t)pdata[2] << 8) + pdata[3];
+  return handleResponse(makeKey(ex.GUID[15]), reg, pdata + 4, sizeData - 4);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// handleResponse
+//
+
+bool
+CRegisterPipeline::handleResponse(const std::string& key, uint32_t reg, const uint8_t* pvalues, uint16_t cnt)
+{
+  auto it = m_queues.find(key);
+  if ((it == m_queues.end()) || it->second.empty()) {
+    m_stats.m_unmatched++;
+    return false;
+  }
+
+  regop& op = it->second.front().m_op;
+  if (opstatus::ACTIVE != op.m_status) {
+    m_stats.m_unmatched++;
+    return false;
+  }
+
+  uint32_t first = op.m_bLevel2 ? op.m_reg : (((uint32_t)op.m_page << 8) + op.m_offset);
+  uint32_t start = reg - first; // Position of first value in frame
+  if ((reg < first) || (start >= op.m_count)) {
+    m_stats.m_unmatched++;
+    return false;
+  }
+
+  m_stats.m_responses++;
+  m_stats.m_rxBytes += cnt + 4;
+
+  std::vector<uint8_t>& target = (optype::READ == op.m_type) ? op.m_data : op.m_response;
+  for (uint16_t i = 0; (i < cnt) && ((start + i) < op.m_count); i++) {
+    target[start + i] = pvalues[i];
+    op.m_received++;
+  }
+
+  if (op.m_received >= op.m_count) {
+    complete(key, opstatus::DONE);
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// step
+//
+
+size_t
+CRegisterPipeline::step(void)
+{
+  // Handle everything received since last step
+  vscpEventEx ex;
+  while (VSCP_ERROR_SUCCESS == m_client.receive(ex)) {
+    handleEvent(ex);
+  }
+
+  // Resend or fail requests that have not been answered in time
+  auto now = std::chrono::steady_clock::now();
+  std::deque<std::string> timedout;
+  for (auto& item : m_queues) {
+    regop& op = item.second.front().m_op;
+    if (opstatus::ACTIVE != op.m_status) {
+      continue;
+    }
+    if (std::chrono::duration_cast<std::chrono::milliseconds>(now - op.m_sent).count() < (int64_t)m_timeout) {
+      continue;
+    }
+    if (op.m_retries < m_retries) {
+      op.m_retries++;
+      m_stats.m_retransmits++;
+      spdlog::debug("Register pipeline: Resending request to {0} retry {1}", describe(op), op.m_retries);
+      if (VSCP_ERROR_SUCCESS != sendRequest(op)) {
+        timedout.push_back(item.first);
+      }
+    }
+    else {
+      spdlog::warn("Register pipeline: Timeout for {0}", describe(op));
+      timedout.push_back(item.first);
+    }
+  }
+
+  for (const auto& key : timedout) {
+    complete(key, opstatus::TIMEOUT);
+  }
+
+  // Fill the window with requests for nodes that are idle
+  std::deque<std::string> failed;
+  for (auto& item : m_queues) {
+    if (m_inflight >= m_window) {
+      break;
+    }
+    regop& op = item.second.front().m_op;
+    if (opstatus::PENDING != op.m_status) {
+      continue;
+    }
+    if (VSCP_ERROR_SUCCESS != sendRequest(op)) {
+      failed.push_back(item.first);
+      continue;
+    }
+    op.m_status = opstatus::ACTIVE;
+    m_inflight++;
+  }
+
+  for (const auto& key : failed) {
+    complete(key, opstatus::FAILED);
+  }
+
+  return m_pending;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cancel
+//
+
+void
+CRegisterPipeline::cancel(uint8_t nodeid, bool bAll)
+{
+  std::deque<std::string> keys;
+  if (bAll) {
+    for (auto& item : m_queues) {
+      keys.push_back(item.first);
+    }
+  }
+  else {
+    keys.push_back(makeKey(nodeid));
+  }
+
+  for (const auto& key : keys) {
+    cancelKey(key);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cancel
+//
+
+void
+CRegisterPipeline::cancel(const cguid& guid)
+{
+  cancelKey(makeKey(guid));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cancelKey
+//
+
+void
+CRegisterPipeline::cancelKey(const std::string& key)
+{
+  // Callbacks may queue new operations, drain what is there now
+  auto it    = m_queues.find(key);
+  size_t cnt = (it != m_queues.end()) ? it->second.size() : 0;
+  while (cnt--) {
+    complete(key, opstatus::CANCELLED);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clearStats
+//
+
+void
+CRegisterPipeline::clearStats(void)
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// statusToString
+//
+
+const char*
+CRegisterPipeline::statusToString(opstatus status)
+{
+  switch (status) {
+    case opstatus::PENDING:
+      return "Pending";
+    case opstatus::ACTIVE:
+      return "Active";
+    case opstatus::DONE:
+      return "Done";
+    case opstatus::TIMEOUT:
+      return "Timeout";
+    case opstatus::FAILED:
+      return "Failed";
+    case opstatus::CANCELLED:
+      return "Cancelled";
+  }
+  return "Unknown";
+}
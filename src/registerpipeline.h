@@ -0,0 +1,344 @@
+// registerpipeline.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef REGISTERPIPELINE_H
+#define REGISTERPIPELINE_H
+
+#include <guid.h>
+#include <vscp-client-base.h>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/*!
+  Asynchronous register access for many nodes over one connection.
+
+  Register reads and writes are queued per node and sent as extended page
+  read/write frames. A node only ever has one request outstanding (that is
+  all a Level I node can handle) but up to "window" nodes can have a request
+  in flight at the same time. Responses are matched on node id, page and
+  register so that replies from different nodes can arrive interleaved.
+  Requests that are not answered within the timeout are resent up to the
+  configured number of retries.
+
+  Level II nodes are addressed by their full GUID and use the Level II
+  read/write register frames with a 32-bit register address. They share
+  the window with the Level I nodes and are handled the same way.
+
+  The pipeline does not own a thread. Call step() repeatedly, typically
+  from a timer, to send, receive and handle timeouts. Completion is
+  reported through the callback given when an operation is queued.
+*/
+
+class CRegisterPipeline {
+
+public:
+  /// Type of operation
+  enum class optype { READ = 0, WRITE };
+
+  /// State of an operation
+  enum class opstatus { PENDING = 0,  // Queued, not sent
+                        ACTIVE,       // Sent, waiting for response
+                        DONE,         // Response received
+                        TIMEOUT,      // No response after all retries
+                        FAILED,       // Could not be sent
+                        CANCELLED     // Removed by cancel()
+  };
+
+  /*!
+    A register operation. For a read m_data holds the values read, for a
+    write it holds the values to write and m_response the values the node
+    echoed back.
+  */
+  struct regop {
+    uint32_t m_id;
+    uint8_t m_nodeid;     // Level I node id (LSB of GUID for Level II)
+    bool m_bLevel2;       // Level II node addressed with m_guid/m_reg
+    cguid m_guid;         // Level II node GUID
+    uint32_t m_reg;       // Level II register address
+    optype m_type;
+    uint16_t m_page;
+    uint8_t m_offset;
+    uint8_t m_count;
+    std::vector<uint8_t> m_data;
+    std::vector<uint8_t> m_response;
+    uint16_t m_received;  // Number of response bytes received
+    uint8_t m_retries;    // Number of resends done
+    opstatus m_status;
+    std::chrono::steady_clock::time_point m_sent;
+  };
+
+  /*!
+    Completion callback. Called exactly once for every operation
+    when it is done, has timed out, failed or was cancelled.
+  */
+  typedef std::function<void(const regop& op)> opcallback;
+
+  /// Largest number of registers a write request can carry
+  static const uint8_t MAX_WRITE_COUNT = 4;
+
+  /// Level II nodes have the standard registers at the top of the register space
+  static const uint32_t LEVEL2_STDREG_BASE = 0xffffff80;
+
+  /*!
+    Statistics for the pipeline
+  */
+  struct pipelinestats {
+    uint32_t m_sent;         // Request frames sent
+    uint32_t m_responses;    // Response frames matched
+    uint32_t m_retransmits;  // Requests resent after timeout
+    uint32_t m_timeouts;     // Operations that timed out
+    uint32_t m_unmatched;    // Response frames that did not match
+    uint32_t m_sentBytes;    // Level I data bytes in request frames
+    uint32_t m_rxBytes;      // Level I data bytes in matched response frames
+  };
+
+  /*!
+    @param client Connected client to use
+    @param guidInterface Interface nodes are on. All zero for none.
+    @param timeout Response timeout in milliseconds
+    @param window Max number of nodes with a request in flight
+    @param retries Number of resends before an operation times out
+  */
+  CRegisterPipeline(CVscpClient& client,
+                    const cguid& guidInterface,
+                    uint32_t timeout,
+                    uint16_t window  = 8,
+                    uint8_t retries  = 2);
+  ~CRegisterPipeline();
+
+  /*!
+    Queue a read of one or more registers
+    @param nodeid Node to read from
+    @param page Register page
+    @param offset First register
+    @param count Number of registers (1-255)
+    @param cb Completion callback
+    @return Operation id or zero if parameters are invalid.
+  */
+  uint32_t read(uint8_t nodeid, uint16_t page, uint8_t offset, uint8_t count, opcallback cb = nullptr);
+
+  /*!
+    Queue a write of one to four registers
+    @param nodeid Node to write to
+    @param page Register page
+    @param offset First register
+    @param values Values to write (1-4)
+    @param cb Completion callback
+    @return Operation id or zero if parameters are invalid.
+  */
+  uint32_t write(uint8_t nodeid,
+                 uint16_t page,
+                 uint8_t offset,
+                 const std::vector<uint8_t>& values,
+                 opcallback cb = nullptr);
+
+  /*!
+    Queue a read of one or more registers from a Level II node
+    @param guid Node GUID
+    @param reg First register
+    @param count Number of registers (1-255)
+    @param cb Completion callback
+    @return Operation id or zero if parameters are invalid.
+  */
+  uint32_t readLevel2(const cguid& guid, uint32_t reg, uint8_t count, opcallback cb = nullptr);
+
+  /*!
+    Queue a write of one or more registers to a Level II node
+    @param guid Node GUID
+    @param reg First register
+    @param values Values to write (1-255)
+    @param cb Completion callback
+    @return Operation id or zero if parameters are invalid.
+  */
+  uint32_t writeLevel2(const cguid& guid,
+                       uint32_t reg,
+                       const std::vector<uint8_t>& values,
+                       opcallback cb = nullptr);
+
+  /*!
+    Send queued requests, handle received responses and timeouts.
+    @return Number of operations that are not yet completed.
+  */
+  size_t step(void);
+
+  /*!
+    Handle an event received outside of the pipeline, for example from
+    a client receive callback. Events that are not register responses
+    for a node in the pipeline are ignored.
+    @param ex Event to handle
+    @return True if the event completed (part of) an operation.
+  */
+  bool handleEvent(const vscpEventEx& ex);
+
+  /*!
+    Cancel all queued and active operations for a node or for all nodes.
+    Callbacks are called with status CANCELLED.
+    @param nodeid Node to cancel operations for
+    @param bAll If true operations for all nodes are cancelled
+  */
+  void cancel(uint8_t nodeid = 0, bool bAll = true);
+
+  /*!
+    Cancel all queued and active operations for a Level II node.
+    Callbacks are called with status CANCELLED.
+    @param guid Node to cancel operations for
+  */
+  void cancel(const cguid& guid);
+
+  /*!
+    Check if there are no operations left
+    @return True if idle
+  */
+  bool isIdle(void) const { return (0 == m_pending); };
+
+  /*!
+    Get number of operations not yet completed
+    @return Number of operations
+  */
+  size_t getPendingCount(void) const { return m_pending; };
+
+  /*!
+    Set max number of nodes with a request in flight
+    @param window New window size (at least one)
+  */
+  void setWindow(uint16_t window) { m_window = window ? window : 1; };
+
+  /*!
+    Get statistics
+    @return Reference to statistics
+  */
+  const pipelinestats& getStats(void) const { return m_stats; };
+
+  /*!
+    Reset statistics
+  */
+  void clearStats(void);
+
+  /*!
+    Get a readable string for a status code
+    @param status Status to convert
+    @return Status as string
+  */
+  static const char* statusToString(opstatus status);
+
+private:
+  /// A queued operation with its callback
+  struct queuedop {
+    regop m_op;
+    opcallback m_cb;
+  };
+
+  /*!
+    Queue keys. Level I nodes are keyed on the node id (one byte), Level II
+    nodes on the GUID (16 bytes) so the two can never collide.
+  */
+  static std::string makeKey(uint8_t nodeid) { return std::string(1, (char)nodeid); };
+  static std::string makeKey(const cguid& guid) { return std::string((const char*)guid.getGUID(), 16); };
+
+  /// Add an operation to the queue for its node
+  uint32_t enqueue(queuedop& qop);
+
+  /*!
+    Send the request frame for an operation
+    @param op Operation to send
+    @return VSCP_ERROR_SUCCESS if sent
+  */
+  int sendRequest(regop& op);
+
+  /*!
+    Send a request frame and account for it
+    @param ex Frame to send
+    @param op Operation the frame belongs to
+    @param addrSize Size of GUID prefix in data, not counted as payload
+    @return VSCP_ERROR_SUCCESS if sent
+  */
+  int send(vscpEventEx& ex, regop& op, uint8_t addrSize);
+
+  /*!
+    Store values from a response in the active operation for a node
+    @param key Queue key for the responding node
+    @param reg First register in the response
+    @param pvalues Register values
+    @param cnt Number of values
+    @return True if the response matched the active operation.
+  */
+  bool handleResponse(const std::string& key, uint32_t reg, const uint8_t* pvalues, uint16_t cnt);
+
+  /*!
+    Complete the active operation for a node and start the next one
+    @param key Queue key for the node
+    @param status Final status
+  */
+  void complete(const std::string& key, opstatus status);
+
+  /// Cancel all operations queued for a node
+  void cancelKey(const std::string& key);
+
+  /// Node and register of an operation for logging
+  static std::string describe(const regop& op);
+
+  /// Client to use for communication
+  CVscpClient& m_client;
+
+  /// GUID for the interface the nodes are on
+  cguid m_guidInterface;
+
+  /// True if interface GUID is non zero (use Level II wrapped frames)
+  bool m_bInterface;
+
+  /// Response timeout in milliseconds
+  uint32_t m_timeout;
+
+  /// Max number of nodes with a request in flight
+  uint16_t m_window;
+
+  /// Number of resends before timeout
+  uint8_t m_retries;
+
+  /// Next operation id
+  uint32_t m_nextId;
+
+  /// Number of operations not completed
+  size_t m_pending;
+
+  /// Number of nodes with a request in flight
+  uint16_t m_inflight;
+
+  /// Per node operation queues. Front is the active one when sent.
+  std::map<std::string, std::deque<queuedop>> m_queues;
+
+  /// Statistics
+  pipelinestats m_stats;
+};
+
+#endif // REGISTERPIPELINE_H
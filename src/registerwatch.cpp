@@ -0,0 +1,328 @@
+// registerwatch.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "registerpipeline.h"
+#include "registerwatch.h"
+
+#include <chrono>
+
+#include <spdlog/spdlog.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// CTOR
+//
+
+CRegisterWatch::CRegisterWatch(CVscpClient& client,
+                               const cguid& guidInterface,
+                               uint8_t nodeid,
+                               uint32_t timeout,
+                               size_t maxSamples)
+  : m_client(client)
+  , m_bRunning(false)
+  , m_bQuit(false)
+{
+  m_guidInterface = guidInterface;
+  m_nodeid        = nodeid;
+  m_timeout       = timeout;
+  m_maxSamples    = maxSamples ? maxSamples : DEFAULT_SAMPLES;
+  m_rate          = 10;
+  m_bitrate       = 125000;
+  m_stats         = watchstats();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DTOR
+//
+
+CRegisterWatch::~CRegisterWatch()
+{
+  stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// addRegister
+//
+
+void
+CRegisterWatch::addRegister(uint16_t page, uint8_t offset)
+{
+  if (m_bRunning) {
+    return;
+  }
+
+  samplering ring;
+  ring.m_head  = 0;
+  ring.m_count = 0;
+  ring.m_buf.resize(m_maxSamples);
+  m_rings.emplace(makeKey(page, offset), ring);
+
+  buildPlan();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clear
+//
+
+void
+CRegisterWatch::clear(void)
+{
+  if (m_bRunning) {
+    return;
+  }
+
+  m_rings.clear();
+  m_plan.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// buildPlan
+//
+
+void
+CRegisterWatch::buildPlan(void)
+{
+  m_plan.clear();
+
+  // Ring map is ordered on page:offset
+  for (auto const& item : m_rings) {
+    uint16_t page  = item.first >> 8;
+    uint8_t offset = item.first & 0xff;
+    if (m_plan.size()) {
+      regspan& last = m_plan.back();
+      uint16_t end  = last.m_offset + last.m_count; // One past last
+      if ((last.m_page == page) && ((offset - end) <= MAX_SPAN_GAP) && ((offset - last.m_offset + 1) <= 255)) {
+        last.m_count = offset - last.m_offset + 1;
+        continue;
+      }
+    }
+    regspan span;
+    span.m_page   = page;
+    span.m_offset = offset;
+    span.m_count  = 1;
+    m_plan.push_back(span);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// start
+//
+
+int
+CRegisterWatch::start(double rate, uint32_t bitrate)
+{
+  if (m_bRunning) {
+    return VSCP_ERROR_SUCCESS;
+  }
+
+  if (m_plan.empty() || (rate <= 0)) {
+    return VSCP_ERROR_PARAMETER;
+  }
+
+  if (!m_client.isConnected()) {
+    return VSCP_ERROR_CONNECTION;
+  }
+
+  m_rate    = rate;
+  m_bitrate = bitrate ? bitrate : 125000;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& item : m_rings) {
+      item.second.m_head  = 0;
+      item.second.m_count = 0;
+    }
+    m_stats              = watchstats();
+    m_stats.m_targetRate = m_rate;
+  }
+
+  m_bQuit    = false;
+  m_bRunning = true;
+  m_thread   = std::thread(&CRegisterWatch::workerThread, this);
+
+  spdlog::debug("Register watch: Started polling {0} registers in {1} spans on node {2} at {3} Hz",
+                m_rings.size(),
+                m_plan.size(),
+                m_nodeid,
+                m_rate);
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// stop
+//
+
+void
+CRegisterWatch::stop(void)
+{
+  m_bQuit = true;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+  m_bRunning = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getSamples
+//
+
+size_t
+CRegisterWatch::getSamples(uint16_t page, uint8_t offset, std::vector<sample>& samples)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  samples.clear();
+  auto it = m_rings.find(makeKey(page, offset));
+  if (it == m_rings.end()) {
+    return 0;
+  }
+
+  const samplering& ring = it->second;
+  size_t size            = ring.m_buf.size();
+  size_t pos             = (ring.m_head + size - ring.m_count) % size;
+  samples.reserve(ring.m_count);
+  for (size_t i = 0; i < ring.m_count; i++) {
+    samples.push_back(ring.m_buf[(pos + i) % size]);
+  }
+
+  return samples.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getStats
+//
+
+CRegisterWatch::watchstats
+CRegisterWatch::getStats(void)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// workerThread
+//
+
+void
+CRegisterWatch::workerThread(void)
+{
+  typedef std::chrono::steady_clock clock;
+
+  // One node can only have one request in flight and a lost sample is
+  // better replaced by the next cycle than resent.
+  CRegisterPipeline pipeline(m_client, m_guidInterface, m_timeout, 1, 0);
+
+  const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / m_rate));
+  const auto tstart = clock::now();
+  auto nextCycle    = tstart;
+  auto statsStart   = tstart;
+
+  size_t outstanding = 0;
+  uint32_t cycles    = 0; // Cycles since last stats update
+
+  while (!m_bQuit) {
+
+    auto now = clock::now();
+
+    if (now >= nextCycle) {
+      if (outstanding) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_overruns++;
+      }
+      else {
+        for (auto const& span : m_plan) {
+          outstanding++;
+          pipeline.read(m_nodeid, span.m_page, span.m_offset, span.m_count, [&, this](const CRegisterPipeline::regop& op) {
+            outstanding--;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (CRegisterPipeline::opstatus::DONE == op.m_status) {
+              double t = std::chrono::duration<double>(clock::now() - tstart).count();
+              for (uint8_t i = 0; i < op.m_count; i++) {
+                auto it = m_rings.find(makeKey(op.m_page, op.m_offset + i));
+                if (it == m_rings.end()) {
+                  continue; // Gap register
+                }
+                samplering& ring           = it->second;
+                ring.m_buf[ring.m_head]    = { t, op.m_data[i] };
+                ring.m_head                = (ring.m_head + 1) % ring.m_buf.size();
+                if (ring.m_count < ring.m_buf.size()) {
+                  ring.m_count++;
+                }
+              }
+            }
+            else if (CRegisterPipeline::opstatus::CANCELLED != op.m_status) {
+              m_stats.m_timeouts++;
+            }
+            if (!outstanding) {
+              m_stats.m_cycles++;
+              cycles++;
+            }
+          });
+        }
+      }
+
+      // Don't try to catch up after a stall
+      nextCycle += period;
+      if (nextCycle < now) {
+        nextCycle = now + period;
+      }
+    }
+
+    pipeline.step();
+
+    // Update rates about once a second
+    double elapsed = std::chrono::duration<double>(now - statsStart).count();
+    if (elapsed >= 1.0) {
+      const CRegisterPipeline::pipelinestats& ps = pipeline.getStats();
+      double bits = (double)(ps.m_sent + ps.m_responses) * frameBits(0) + (double)(ps.m_sentBytes + ps.m_rxBytes) * 8;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.m_pollRate    = cycles / elapsed;
+        m_stats.m_frameRate   = (ps.m_sent + ps.m_responses) / elapsed;
+        m_stats.m_utilization = (100.0 * bits / elapsed) / m_bitrate;
+      }
+      pipeline.clearStats();
+      cycles     = 0;
+      statsStart = now;
+    }
+
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+  }
+
+  // Callbacks reference locals, make sure none are left
+  pipeline.cancel();
+
+  spdlog::debug("Register watch: Stopped polling node {0}", m_nodeid);
+}
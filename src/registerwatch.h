@@ -0,0 +1,210 @@
+// registerwatch.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef REGISTERWATCH_H
+#define REGISTERWATCH_H
+
+#include <guid.h>
+#include <vscp-client-base.h>
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+  Poll a set of Level I registers on one node at a fixed rate.
+
+  Watched registers are coalesced into a read plan of page spans so that
+  one extended page read fetches several registers. The plan is run on a
+  worker thread through a CRegisterPipeline and every value read is stored
+  in a ring buffer per register that the user interface can copy out at
+  its own pace.
+
+  The worker owns the client while it runs. Nothing else may use the
+  client between start() and stop().
+*/
+
+class CRegisterWatch {
+
+public:
+  /// One polled value
+  struct sample {
+    double m_time;  // Seconds since start()
+    uint8_t m_value;
+  };
+
+  /// A run of registers on a page read with one request
+  struct regspan {
+    uint16_t m_page;
+    uint8_t m_offset;
+    uint8_t m_count;
+  };
+
+  /// Poll statistics, updated about once a second
+  struct watchstats {
+    double m_targetRate;   // Requested poll cycles per second
+    double m_pollRate;     // Achieved poll cycles per second
+    double m_frameRate;    // Frames per second (requests and responses)
+    double m_utilization;  // Estimated link utilization in percent
+    uint32_t m_cycles;     // Completed poll cycles
+    uint32_t m_overruns;   // Cycles skipped because the last was not done
+    uint32_t m_timeouts;   // Span reads that timed out
+  };
+
+  /*!
+    Registers that are closer than this are read in the same span
+    even if the registers in between are not watched.
+  */
+  static const uint8_t MAX_SPAN_GAP = 4;
+
+  /// Default number of samples kept per register
+  static const size_t DEFAULT_SAMPLES = 4096;
+
+  /*!
+    @param client Connected client to use
+    @param guidInterface Interface the node is on
+    @param nodeid Node to poll
+    @param timeout Response timeout in milliseconds
+    @param maxSamples Number of samples kept per register
+  */
+  CRegisterWatch(CVscpClient& client,
+                 const cguid& guidInterface,
+                 uint8_t nodeid,
+                 uint32_t timeout,
+                 size_t maxSamples = DEFAULT_SAMPLES);
+  ~CRegisterWatch();
+
+  /*!
+    Add a register to watch. Not allowed while running.
+    @param page Register page
+    @param offset Register offset
+  */
+  void addRegister(uint16_t page, uint8_t offset);
+
+  /*!
+    Remove all registers and samples. Not allowed while running.
+  */
+  void clear(void);
+
+  /*!
+    Get the read plan for the watched registers
+    @return List with spans
+  */
+  const std::deque<regspan>& getPlan(void) const { return m_plan; };
+
+  /*!
+    Start polling
+    @param rate Poll cycles per second
+    @param bitrate Link bitrate in bits per second used to
+            estimate link utilization
+    @return VSCP_ERROR_SUCCESS if started
+  */
+  int start(double rate, uint32_t bitrate = 125000);
+
+  /*!
+    Stop polling and wait for the worker thread to end
+  */
+  void stop(void);
+
+  /*!
+    Check if the worker is running
+    @return True if running
+  */
+  bool isRunning(void) const { return m_bRunning; };
+
+  /*!
+    Copy the samples for a register, oldest first
+    @param page Register page
+    @param offset Register offset
+    @param samples Filled with samples
+    @return Number of samples
+  */
+  size_t getSamples(uint16_t page, uint8_t offset, std::vector<sample>& samples);
+
+  /*!
+    Get poll statistics
+    @return Copy of the statistics
+  */
+  watchstats getStats(void);
+
+  /*!
+    Estimate the number of bits a Level I frame occupies on a CAN bus
+    (29-bit id, worst case bit stuffing not included)
+    @param sizeData Number of data bytes
+    @return Number of bits
+  */
+  static uint32_t frameBits(uint8_t sizeData) { return 67 + 8 * sizeData; };
+
+private:
+  /// Fixed size sample store for one register
+  struct samplering {
+    std::vector<sample> m_buf;
+    size_t m_head;   // Next position to write
+    size_t m_count;  // Number of valid samples
+  };
+
+  /// Key for the ring map
+  static uint32_t makeKey(uint16_t page, uint8_t offset)
+  {
+    return ((uint32_t)page << 8) + offset;
+  };
+
+  /// Build the read plan from the watched registers
+  void buildPlan(void);
+
+  /// Worker thread
+  void workerThread(void);
+
+  CVscpClient& m_client;
+  cguid m_guidInterface;
+  uint8_t m_nodeid;
+  uint32_t m_timeout;
+  size_t m_maxSamples;
+
+  double m_rate;
+  uint32_t m_bitrate;
+
+  /// Read plan
+  std::deque<regspan> m_plan;
+
+  /// Samples per watched register (protected by m_mutex)
+  std::map<uint32_t, samplering> m_rings;
+
+  /// Statistics (protected by m_mutex)
+  watchstats m_stats;
+
+  std::mutex m_mutex;
+  std::thread m_thread;
+  std::atomic<bool> m_bRunning;
+  std::atomic<bool> m_bQuit;
+};
+
+#endif // REGISTERWATCH_H
@@ -85,6 +85,7 @@ vscpworks::vscpworks(int& argc, char** argv)
   m_mdfAutoSaveInterval = 300;
   m_mdfCumulativeBackups = false;
   m_mdfMaxBackups = 10;
+  m_mqttHistoryBudget = 64;
 
   m_session_timeout   = 1000;
   m_session_maxEvents = -1;
@@ -197,6 +198,9 @@ vscpworks::vscpworks(int& argc, char** argv)
     dir.mkpath("./cache");
     // Make a folder for log data
     dir.mkpath("./logs");
+
+    // Downloaded MDF files are kept between sessions
+    m_mdfCache.setCacheFolder((path + "cache/mdf").toStdString());
   }
 
   m_maxFileLogSize  = 5242880;
@@ -564,6 +568,16 @@ vscpworks::loadSettings(void)
     }
   }
 
+  if (j.contains("mqttHistoryBudget")) {
+    const auto& budget = j["mqttHistoryBudget"];
+    if (budget.is_number_integer()) {
+      int64_t value = budget.get<int64_t>();
+      if ((value > 0) && (value <= 4096)) {
+        m_mqttHistoryBudget = static_cast<uint32_t>(value);
+      }
+    }
+  }
+
   // VSCP event database last load date/time
   // ---------------------------------------
   if (j.contains("last-eventdb-download") && j["last-eventdb-download"].is_number()) {
@@ -720,6 +734,9 @@ vscpworks::writeSettings()
   j["mdfCumulativeBackups"] = m_mdfCumulativeBackups;
   j["mdfMaxBackups"] = m_mdfMaxBackups;
 
+  // * * * MQTT explorer * * *
+  j["mqttHistoryBudget"] = m_mqttHistoryBudget;
+
   QMap<std::string, json>::const_iterator it = m_mapConn.constBegin();
   while (it != m_mapConn.constEnd()) {
     // jj = json::parse((*it).toStdString());
@@ -969,6 +986,12 @@ vscpworks::openVscpWorksDatabase(void)
     return false;
   }
 
+  // Create node inventory table and load it to memory. The inventory is
+  // a convenience so the database is still usable without it.
+  if (!m_nodeInventory.open(m_db_vscp_works)) {
+    spdlog::error("Failed to open node inventory. Continuing without it.");
+  }
+
   // Load known GUID's to memory
   loadGuidTable();
 
@@ -1474,42 +1497,24 @@ vscpworks::downloadMDF(CStandardRegisters& stdregs,
   std::string url = stdregs.getMDF();
   spdlog::trace("URL for MDF = {}", url);
 
-  // create a temporary file name for remote MDF
-  std::string tempMdfFileName;
-  for (int i = 0; i < url.length(); i++) {
-    if ((url[i] == '/') || (url[i] == '\\')) {
-      tempMdfFileName += "_";
-    }
-    else {
-      tempMdfFileName += url[i];
-    }
-  }
-
-  // mkstemp()
-  std::string tempPath =
-    QStandardPaths::writableLocation(QStandardPaths::TempLocation)
-      .toStdString();
-  tempPath += "/";
-  tempPath += tempMdfFileName;
-
-  path = tempPath.c_str();
-  spdlog::debug("Temporary path: {}", tempPath);
-
   if (nullptr != statusCallback) {
     statusCallback(10, "Downloading MDF file...");
   }
 
-  CURLcode curl_rv;
-  curl_rv = mdf.downLoadMDF(url, tempPath);
-  if (CURLE_OK != curl_rv) {
+  // The cache only transfers the file if it is not cached or has changed
+  std::string tempPath;
+  std::string hash;
+  if (VSCP_ERROR_SUCCESS != m_mdfCache.fetch(url, tempPath, hash)) {
     if (nullptr != statusCallback) {
       statusCallback(10, "Failed to download MDF file for device.");
     }
-    spdlog::error("Failed to download MDF {0} curl rv={1}", url, (int)curl_rv);
+    spdlog::error("Failed to download MDF {0}", url);
     QApplication::restoreOverrideCursor();
     return VSCP_ERROR_COMMUNICATION;
   }
 
+  path = tempPath.c_str();
+
   if (nullptr != statusCallback) {
     statusCallback(60, "MDF downloaded.");
   }
@@ -1517,25 +1522,9 @@ vscpworks::downloadMDF(CStandardRegisters& stdregs,
 
   // * * * Parse  MDF * * *
 
+  // A snapshot of the file is loaded instead if there is one
   spdlog::debug("Parsing MDF");
-  int rv = VSCP_ERROR_ERROR;
-  try {
-    rv = mdf.parseMDF(tempPath);
-  }
-  catch (const std::exception &ex) {
-    if (nullptr != statusCallback) {
-      statusCallback(80, "Faild to parse MDF");
-    }
-    spdlog::error("Failed to parse MDF {0}: {1}", tempPath, ex.what());
-    return VSCP_ERROR_PARSING;
-  }
-  catch (...) {
-    if (nullptr != statusCallback) {
-      statusCallback(80, "Faild to parse MDF");
-    }
-    spdlog::error("Failed to parse MDF {0}: Unknown exception", tempPath);
-    return VSCP_ERROR_PARSING;
-  }
+  int rv = m_mdfCache.load(tempPath, hash, mdf);
   if (VSCP_ERROR_SUCCESS != rv) {
     if (nullptr != statusCallback) {
       statusCallback(80, "Faild to parse MDF");
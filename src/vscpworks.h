@@ -38,6 +38,8 @@
 #include <register.h>
 
 #include "cfrmsession.h"
+#include "mdfcache.h"
+#include "nodeinventory.h"
 
 #include <QApplication>
 #include <QByteArray>
@@ -357,6 +359,12 @@ public:
                   QString& path,
                   std::function<void(int, const char*)> statusCallback = nullptr);
 
+  /// Downloaded and parsed MDF's shared by all windows
+  CMdfCache m_mdfCache;
+
+  /// Nodes seen by scans and configuration, shared by all windows
+  CNodeInventory m_nodeInventory;
+
   // ========================================================================
   // ========================================================================
 
@@ -422,6 +430,9 @@ public:
   /// Max number of cumulative MDF backups kept per file (0 = unlimited)
   uint32_t m_mdfMaxBackups;
 
+  /// Memory for message history in MQTT explorer windows (MB)
+  uint32_t m_mqttHistoryBudget;
+
   //**************************************************************************
   //                            LOGGER (SPDLOG)
   //**************************************************************************
@@ -0,0 +1,399 @@
+// mdfcorpus.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifdef WIN32
+#include <pch.h>
+#endif
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include "mdfcorpus.h"
+
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Language codes used for descriptions
+static const char* LANGUAGES[CMdfCorpus::MAX_LANGUAGES] = { "en", "de", "se", "fr", "es", "it", "nl",
+                                                            "da", "fi", "no", "pl", "pt", "cs", "hu",
+                                                            "ro", "tr", "ru", "zh", "ja", "ko" };
+
+// Background colors cycled over registers
+static const char* BGCOLORS[] = { "fff3d4", "ebd69d", "b2f0ff", "e0e0ff", "f0f0ff" };
+
+///////////////////////////////////////////////////////////////////////////////
+// makeText
+//
+// Text for a description in a language
+//
+
+static std::string
+makeText(const std::string& what, uint16_t lang)
+{
+  return "Description of " + what + " (" + LANGUAGES[lang] + "). Synthetic text used by the MDF benchmarks.";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// xmlDescriptions
+//
+
+static void
+xmlDescriptions(std::string& xml, const CMdfCorpus::corpusspec& spec, const std::string& what)
+{
+  for (uint16_t lang = 0; lang < spec.m_languages; lang++) {
+    xml += "<description lang=\"";
+    xml += LANGUAGES[lang];
+    xml += "\">" + makeText(what, lang) + "</description>\n";
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// jsonDescriptions
+//
+
+static json
+jsonDescriptions(const CMdfCorpus::corpusspec& spec, const std::string& what)
+{
+  json descriptions = json::array();
+  for (uint16_t lang = 0; lang < spec.m_languages; lang++) {
+    json desc;
+    desc[LANGUAGES[lang]] = makeText(what, lang);
+    descriptions.push_back(desc);
+  }
+  return descriptions;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// getSpecs
+//
+
+const std::vector<CMdfCorpus::corpusspec>&
+CMdfCorpus::getSpecs(void)
+{
+  static const std::vector<corpusspec> specs = {
+    // name      level        pages  regs  rvars  dm  events  languages
+    { "small", VSCP_LEVEL1, 1, 16, 4, 4, 2, 1 },
+    { "typical", VSCP_LEVEL1, 2, 128, 32, 16, 8, 2 },
+    { "huge", VSCP_LEVEL2, 10, 256, 500, 64, 64, 20 },
+  };
+  return specs;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// remoteVariablePos
+//
+
+void
+CMdfCorpus::remoteVariablePos(const corpusspec& spec, uint16_t idx, uint16_t& page, uint32_t& offset)
+{
+  // Remote variables are 16-bit and are laid out after each other
+  // over the register pages.
+  uint32_t pos = 2 * (uint32_t)idx;
+  page         = (uint16_t)((pos / spec.m_registersPerPage) % spec.m_pages);
+  offset       = pos % spec.m_registersPerPage;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// makeXml
+//
+
+std::string
+CMdfCorpus::makeXml(const corpusspec& spec)
+{
+  std::string xml;
+  std::string name = std::string(spec.m_name);
+
+  xml += "<?xml version = \"1.0\" encoding = \"UTF-8\" ?>\n";
+  xml += "<!-- Synthetic MDF file for the VSCP Works + benchmarks -->\n";
+  xml += "<vscp>\n<module>\n";
+  xml += "<name>benchmark " + name + "</name>\n";
+  xml += "<copyright>(C) 2000-2026 Grodans Paradis AB</copyright>\n";
+  xml += "<level>" + std::to_string(spec.m_level) + "</level>\n";
+  xml += "<model>" + name + "</model>\n";
+  xml += "<version>1</version>\n";
+  xml += "<changed>2026-01-01</changed>\n";
+  xml += "<buffersize>8</buffersize>\n";
+  xmlDescriptions(xml, spec, "module");
+  xml += "<infourl lang=\"en\">https://www.vscp.org</infourl>\n";
+  xml += "<manufacturer>\n<name>Grodans Paradis AB</name>\n";
+  xml += "<address>\n<street>Brattbergavägen 17</street>\n<city>Los</city>\n";
+  xml += "<postcode>82770</postcode>\n<country>Sweden</country>\n</address>\n";
+  xml += "</manufacturer>\n";
+  xml += "<boot>\n<algorithm>1</algorithm>\n<blocksize>8</blocksize>\n<blockcount>4096</blockcount>\n</boot>\n";
+
+  // Registers
+  xml += "<registers>\n";
+  for (uint16_t page = 0; page < spec.m_pages; page++) {
+    for (uint32_t offset = 0; offset < spec.m_registersPerPage; offset++) {
+      std::string what = "register " + std::to_string(page) + ":" + std::to_string(offset);
+      xml += "<reg name=\"" + what + "\" page=\"" + std::to_string(page) + "\" offset=\"" +
+             std::to_string(offset) +
+             "\" span=\"1\" width=\"8\" access=\"rw\" type=\"0\" default=\"0\" min=\"0\" max=\"255\" "
+             "fgcolor=\"0\" bgcolor=\"" +
+             BGCOLORS[offset % (sizeof(BGCOLORS) / sizeof(BGCOLORS[0]))] + "\" >\n";
+      xmlDescriptions(xml, spec, what);
+      xml += "</reg>\n";
+    }
+  }
+  xml += "</registers>\n";
+
+  // Remote variables
+  xml += "<remotevars>\n";
+  for (uint16_t i = 0; i < spec.m_remoteVariables; i++) {
+    uint16_t page;
+    uint32_t offset;
+    remoteVariablePos(spec, i, page, offset);
+    std::string what = "remote variable " + std::to_string(i);
+    xml += "<remotevar name=\"" + what + "\" type=\"5\" default=\"0\" page=\"" + std::to_string(page) +
+           "\" offset=\"" + std::to_string(offset) +
+           "\" access=\"rw\" bitpos=\"0\" fgcolor=\"0\" bgcolor=\"e0e0ff\" >\n";
+    xmlDescriptions(xml, spec, what);
+    xml += "</remotevar>\n";
+  }
+  xml += "</remotevars>\n";
+
+  // Decision matrix is placed on the page after the register pages
+  xml += "<dmatrix level=\"1\" start-page=\"" + std::to_string(spec.m_pages) + "\" start-offset=\"0\" rowcnt=\"" +
+         std::to_string(spec.m_dmRows) + "\" rowsize=\"8\" >\n";
+  for (uint16_t code = 0; code < DM_ACTIONS; code++) {
+    std::string what = "action " + std::to_string(code);
+    xml += "<action name=\"" + what + "\" code=\"" + std::to_string(code) + "\" >\n";
+    xml += "<param name=\"" + what + " parameter\" offset=\"0\" min=\"0\" max=\"255\" >\n";
+    xml += "<valuelist>\n";
+    for (int item = 0; item < 4; item++) {
+      xml += "<item name=\"channel " + std::to_string(item) + "\" value=\"" + std::to_string(item) + "\" >\n";
+      xmlDescriptions(xml, spec, what + " channel " + std::to_string(item));
+      xml += "</item>\n";
+    }
+    xml += "</valuelist>\n";
+    xmlDescriptions(xml, spec, what + " parameter");
+    xml += "</param>\n";
+    xmlDescriptions(xml, spec, what);
+    xml += "</action>\n";
+  }
+  xml += "</dmatrix>\n";
+
+  // Events
+  xml += "<events>\n";
+  for (uint16_t i = 0; i < spec.m_events; i++) {
+    std::string what = "event " + std::to_string(i);
+    xml += "<event name=\"" + what + "\" class=\"20\" type=\"" + std::to_string(i % 64 + 1) +
+           "\" priority=\"4\" dir=\"out\" >\n";
+    xml += "<data name=\"index\" offset=\"0\" >\n";
+    xmlDescriptions(xml, spec, what + " index");
+    xml += "</data>\n<data name=\"zone\" offset=\"1\" >\n";
+    xmlDescriptions(xml, spec, what + " zone");
+    xml += "</data>\n<data name=\"sub zone\" offset=\"2\" >\n";
+    xmlDescriptions(xml, spec, what + " sub zone");
+    xml += "</data>\n";
+    xmlDescriptions(xml, spec, what);
+    xml += "</event>\n";
+  }
+  xml += "</events>\n";
+
+  xml += "</module>\n</vscp>\n";
+  return xml;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// makeJson
+//
+
+std::string
+CMdfCorpus::makeJson(const corpusspec& spec)
+{
+  json module;
+  std::string name = std::string(spec.m_name);
+
+  module["name"]        = "benchmark " + name;
+  module["copyright"]   = "(C) 2000-2026 Grodans Paradis AB";
+  module["level"]       = spec.m_level;
+  module["model"]       = name;
+  module["version"]     = "1";
+  module["changed"]     = "2026-01-01";
+  module["buffersize"]  = 8;
+  module["description"] = jsonDescriptions(spec, "module");
+
+  json infourl;
+  infourl["en"]     = "https://www.vscp.org";
+  module["infourl"] = json::array({ infourl });
+
+  module["manufacturer"]["name"]                = "Grodans Paradis AB";
+  module["manufacturer"]["address"]["street"]   = "Brattbergavägen 17";
+  module["manufacturer"]["address"]["city"]     = "Los";
+  module["manufacturer"]["address"]["postcode"] = "82770";
+  module["manufacturer"]["address"]["country"]  = "Sweden";
+
+  module["boot"]["algorithm"]  = 1;
+  module["boot"]["blocksize"]  = 8;
+  module["boot"]["blockcount"] = 4096;
+
+  // Registers
+  json registers = json::array();
+  for (uint16_t page = 0; page < spec.m_pages; page++) {
+    for (uint32_t offset = 0; offset < spec.m_registersPerPage; offset++) {
+      std::string what = "register " + std::to_string(page) + ":" + std::to_string(offset);
+      json reg;
+      reg["name"]        = what;
+      reg["page"]        = page;
+      reg["offset"]      = offset;
+      reg["span"]        = 1;
+      reg["width"]       = 8;
+      reg["access"]      = "rw";
+      reg["type"]        = "std";
+      reg["default"]     = "0";
+      reg["min"]         = 0;
+      reg["max"]         = 255;
+      reg["fgcolor"]     = "0x0";
+      reg["bgcolor"]     = std::string("0x") + BGCOLORS[offset % (sizeof(BGCOLORS) / sizeof(BGCOLORS[0]))];
+      reg["description"] = jsonDescriptions(spec, what);
+      registers.push_back(reg);
+    }
+  }
+  module["registers"] = registers;
+
+  // Remote variables
+  json remotevars = json::array();
+  for (uint16_t i = 0; i < spec.m_remoteVariables; i++) {
+    uint16_t page;
+    uint32_t offset;
+    remoteVariablePos(spec, i, page, offset);
+    std::string what = "remote variable " + std::to_string(i);
+    json rv;
+    rv["name"]        = what;
+    rv["type"]        = 5;
+    rv["default"]     = "0";
+    rv["page"]        = page;
+    rv["offset"]      = offset;
+    rv["access"]      = "rw";
+    rv["bitpos"]      = 0;
+    rv["fgcolor"]     = "0x0";
+    rv["bgcolor"]     = "0xe0e0ff";
+    rv["description"] = jsonDescriptions(spec, what);
+    remotevars.push_back(rv);
+  }
+  module["remotevars"] = remotevars;
+
+  // Decision matrix is placed on the page after the register pages
+  json dm;
+  dm["level"]        = 1;
+  dm["start-page"]   = spec.m_pages;
+  dm["start-offset"] = 0;
+  dm["rowcnt"]       = spec.m_dmRows;
+  dm["rowsize"]      = 8;
+  json actions       = json::array();
+  for (uint16_t code = 0; code < DM_ACTIONS; code++) {
+    std::string what = "action " + std::to_string(code);
+    json values      = json::array();
+    for (int item = 0; item < 4; item++) {
+      json value;
+      value["name"]        = "channel " + std::to_string(item);
+      value["value"]       = std::to_string(item);
+      value["description"] = jsonDescriptions(spec, what + " channel " + std::to_string(item));
+      values.push_back(value);
+    }
+    json param;
+    param["name"]        = what + " parameter";
+    param["offset"]      = 0;
+    param["min"]         = 0;
+    param["max"]         = 255;
+    param["valuelist"]   = values;
+    param["description"] = jsonDescriptions(spec, what + " parameter");
+
+    json action;
+    action["name"]        = what;
+    action["code"]        = code;
+    action["param"]       = json::array({ param });
+    action["description"] = jsonDescriptions(spec, what);
+    actions.push_back(action);
+  }
+  dm["action"]      = actions;
+  module["dmatrix"] = dm;
+
+  // Events
+  json events = json::array();
+  for (uint16_t i = 0; i < spec.m_events; i++) {
+    const char* names[] = { "index", "zone", "sub zone" };
+    std::string what    = "event " + std::to_string(i);
+    json data           = json::array();
+    for (int j = 0; j < 3; j++) {
+      json item;
+      item["name"]        = names[j];
+      item["offset"]      = j;
+      item["description"] = jsonDescriptions(spec, what + " " + names[j]);
+      data.push_back(item);
+    }
+    json ev;
+    ev["name"]        = what;
+    ev["class"]       = 20;
+    ev["type"]        = i % 64 + 1;
+    ev["priority"]    = 4;
+    ev["dir"]         = "out";
+    ev["data"]        = data;
+    ev["description"] = jsonDescriptions(spec, what);
+    events.push_back(ev);
+  }
+  module["events"] = events;
+
+  json root;
+  root["module"] = module;
+  return root.dump(2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write
+//
+
+int
+CMdfCorpus::write(const corpusspec& spec, const std::string& folder, std::string& xmlPath, std::string& jsonPath)
+{
+  QDir dir(QString::fromStdString(folder));
+  xmlPath  = dir.filePath(QString("%1.xml").arg(spec.m_name)).toStdString();
+  jsonPath = dir.filePath(QString("%1.json").arg(spec.m_name)).toStdString();
+
+  const std::string content[] = { makeXml(spec), makeJson(spec) };
+  const std::string* paths[]  = { &xmlPath, &jsonPath };
+  for (int i = 0; i < 2; i++) {
+    QFile file(QString::fromStdString(*paths[i]));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        ((qint64)content[i].size() != file.write(content[i].data(), content[i].size()))) {
+      return VSCP_ERROR_WRITE_ERROR;
+    }
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
@@ -0,0 +1,115 @@
+// mdfcorpus.h
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef MDFCORPUS_H
+#define MDFCORPUS_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+/*!
+  Synthetic MDF files for the benchmarks.
+
+  The corpus is generated from a size description instead of being
+  checked in. Each size is written both as XML and as JSON with the
+  same content so the two parsers can be compared on equal terms.
+*/
+
+class CMdfCorpus {
+
+public:
+  /*!
+    Size of one synthetic MDF
+  */
+  struct corpusspec {
+    const char* m_name;          // Name used for files and in results
+    int m_level;                 // VSCP_LEVEL1 or VSCP_LEVEL2
+    uint16_t m_pages;            // Number of register pages
+    uint16_t m_registersPerPage; // Registers on each page
+    uint16_t m_remoteVariables;  // Number of 16-bit remote variables
+    uint16_t m_dmRows;           // Decision matrix rows
+    uint16_t m_events;           // Number of events
+    uint16_t m_languages;        // Languages for each description
+  };
+
+  /// Number of decision matrix actions
+  static const uint16_t DM_ACTIONS = 8;
+
+  /// Maximum number of languages
+  static const uint16_t MAX_LANGUAGES = 20;
+
+  /*!
+    Get the sizes in the corpus, smallest first
+    @return List with corpus sizes
+  */
+  static const std::vector<corpusspec>& getSpecs(void);
+
+  /*!
+    Generate an MDF on XML format
+    @param spec Size of the MDF
+    @return MDF as a string
+  */
+  static std::string makeXml(const corpusspec& spec);
+
+  /*!
+    Generate an MDF on JSON format
+    @param spec Size of the MDF
+    @return MDF as a string
+  */
+  static std::string makeJson(const corpusspec& spec);
+
+  /*!
+    Write the XML and the JSON version of an MDF to a folder. Files
+    are named after the corpus size.
+    @param spec Size of the MDF
+    @param folder Folder to write the files to
+    @param xmlPath Set to path of the XML file
+    @param jsonPath Set to path of the JSON file
+    @return VSCP_ERROR_SUCCESS on success or VSCP_ERROR_WRITE_ERROR
+            if a file could not be written.
+  */
+  static int write(const corpusspec& spec,
+                   const std::string& folder,
+                   std::string& xmlPath,
+                   std::string& jsonPath);
+
+private:
+  /*!
+    Get the linear register position of a remote variable
+    @param spec Size of the MDF
+    @param idx Index for the remote variable
+    @param page Set to register page
+    @param offset Set to register offset
+  */
+  static void remoteVariablePos(const corpusspec& spec, uint16_t idx, uint16_t& page, uint32_t& offset);
+};
+
+#endif // MDFCORPUS_H
@@ -0,0 +1,389 @@
+// mdfrender_bench.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Times MDF parse, snapshot load and rendering for a synthetic corpus.
+//
+// Usage: mdfrender-bench [-n iterations] [-o results.json] [-b baseline.json] [size...]
+//
+// The corpus (see mdfcorpus.h) is written to a temporary folder as XML
+// and JSON. For each file the benchmark times
+//
+//   parse      - CMDF::parseMDF
+//   snapshot   - CMdfSnapshot::load of the binary snapshot
+//   editor     - CFrmMdf::loadMdf, the MDF editor tree
+//   nodeconfig - CFrmNodeConfig register, remote variable and
+//                decision matrix views
+//
+// Windows are rendered on the offscreen platform unless QT_QPA_PLATFORM
+// is set. Median and minimum times are written as JSON so that results
+// from two commits can be compared. With -b a baseline written by an
+// earlier run is read and the change for each timing is printed.
+//
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include <mdf.h>
+
+#include "cfrmmdf.h"
+#include "cfrmnodeconfig.h"
+#include "mdfcorpus.h"
+#include "mdfsnapshot.h"
+#include "vscpworks.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QSysInfo>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+// Default number of timed runs per file and step
+#define BENCH_ITERATIONS 5
+
+// Timed steps in the order they are reported
+static const char* STEPS[] = { "parse", "snapshot", "editor", "nodeconfig" };
+
+///////////////////////////////////////////////////////////////////////////////
+// readFile
+//
+
+static QByteArray
+readFile(const std::string& path)
+{
+  QFile file(QString::fromStdString(path));
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QByteArray();
+  }
+  return file.readAll();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// timeIt
+//
+// Run a step the given number of times and return the median and minimum
+// time in milliseconds. Returns false if a run fails.
+//
+
+template<typename F>
+static bool
+timeIt(int iterations, F step, json& result)
+{
+  std::vector<double> samples;
+  for (int i = 0; i < iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    if (!step()) {
+      return false;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    samples.push_back(elapsed.count());
+  }
+
+  std::sort(samples.begin(), samples.end());
+  result["median_ms"] = samples[samples.size() / 2];
+  result["min_ms"]    = samples.front();
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// benchFile
+//
+// Time all steps for one corpus file
+//
+
+static int
+benchFile(const std::string& path, const std::string& snapFolder, int iterations, json& result)
+{
+  QByteArray content = readFile(path);
+  std::string hash   = QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex().toStdString();
+  std::string snapPath =
+    QDir(QString::fromStdString(snapFolder)).filePath(QString::fromStdString(hash + CMdfSnapshot::EXTENSION)).toStdString();
+
+  CMDF mdf;
+  if ((VSCP_ERROR_SUCCESS != mdf.parseMDF(path)) || (VSCP_ERROR_SUCCESS != CMdfSnapshot::save(mdf, snapPath, hash))) {
+    fprintf(stderr, "%s: Failed to parse or to write snapshot\n", path.c_str());
+    return VSCP_ERROR_PARSING;
+  }
+
+  result["bytes"]      = content.size();
+  result["registers"]  = mdf.getRegisterList()->size();
+  result["remotevars"] = mdf.getRemoteVariableList()->size();
+
+  json& steps = result["steps"];
+
+  if (!timeIt(
+        iterations,
+        [&path]() {
+          CMDF m;
+          return (VSCP_ERROR_SUCCESS == m.parseMDF(path));
+        },
+        steps["parse"])) {
+    return VSCP_ERROR_PARSING;
+  }
+
+  if (!timeIt(
+        iterations,
+        [&snapPath, &hash]() {
+          CMDF m;
+          return (VSCP_ERROR_SUCCESS == CMdfSnapshot::load(snapPath, hash, m));
+        },
+        steps["snapshot"])) {
+    return VSCP_ERROR_PARSING;
+  }
+
+  // The tree is painted once after it is built so that the delayed
+  // layout of the view is part of the measurement.
+  {
+    CFrmMdf frm(nullptr, path.c_str());
+    frm.show();
+    if (!frm.openMdfFromPath(QString::fromStdString(path)) ||
+        !timeIt(
+          iterations,
+          [&frm]() {
+            frm.loadMdf();
+            frm.repaint();
+            return true;
+          },
+          steps["editor"])) {
+      return VSCP_ERROR_ERROR;
+    }
+  }
+
+  // The node configuration window has no connection so register values
+  // are unknown. This is the same work as a render after a full read.
+  {
+    json conn;
+    conn["type"] = static_cast<int>(CVscpClient::connType::NONE);
+    conn["name"] = "benchmark";
+
+    CFrmNodeConfig frm(nullptr, &conn);
+    frm.show();
+    if ((VSCP_ERROR_SUCCESS != frm.loadLocalMdf(path)) ||
+        !timeIt(
+          iterations,
+          [&frm]() {
+            bool rv = (VSCP_ERROR_SUCCESS == frm.renderRegisterTree()) && frm.renderRemoteVariables() &&
+                      frm.renderDecisionMatrix();
+            frm.repaint();
+            return rv;
+          },
+          steps["nodeconfig"])) {
+      return VSCP_ERROR_ERROR;
+    }
+  }
+
+  return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// findResult
+//
+// Find the result for a corpus file in a list of results
+//
+
+static const json*
+findResult(const json& results, const std::string& corpus, const std::string& format)
+{
+  for (const auto& item : results) {
+    if ((item.value("corpus", "") == corpus) && (item.value("format", "") == format)) {
+      return &item;
+    }
+  }
+  return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// main
+//
+
+int
+main(int argc, char* argv[])
+{
+  int iterations = BENCH_ITERATIONS;
+  std::string outPath;
+  std::string baselinePath;
+  std::vector<std::string> sizes;
+
+  // Must be set before the application object is created
+  if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && ((i + 1) < argc)) {
+      iterations = atoi(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "-o") && ((i + 1) < argc)) {
+      outPath = QFileInfo(argv[++i]).absoluteFilePath().toStdString();
+    }
+    else if (!strcmp(argv[i], "-b") && ((i + 1) < argc)) {
+      baselinePath = QFileInfo(argv[++i]).absoluteFilePath().toStdString();
+    }
+    else {
+      sizes.push_back(argv[i]);
+    }
+  }
+
+  if (iterations < 1) {
+    fprintf(stderr, "usage: mdfrender-bench [-n iterations] [-o results.json] [-b baseline.json] [size...]\n");
+    return 2;
+  }
+
+  // Paths are resolved above as the application changes to the home folder
+  vscpworks app(argc, argv);
+  QCoreApplication::setOrganizationName("VSCP");
+
+  spdlog::set_level(spdlog::level::off);
+
+  // Fixed view settings so runs on different machines are comparable
+  app.m_config_base           = numerical_base::HEX;
+  app.m_config_bDisableColors = false;
+  app.m_mdfAutoSaveEnabled    = false;
+
+  json baseline;
+  if (!baselinePath.empty()) {
+    QByteArray data = readFile(baselinePath);
+    baseline        = json::parse(data.toStdString(), nullptr, false);
+    if (baseline.is_discarded() || !baseline.contains("results")) {
+      fprintf(stderr, "%s: Not a benchmark result file\n", baselinePath.c_str());
+      return 2;
+    }
+  }
+
+  QTemporaryDir tmp;
+  if (!tmp.isValid()) {
+    fprintf(stderr, "Failed to create temporary folder\n");
+    return 1;
+  }
+
+  int rv                = 0;
+  json results          = json::array();
+  std::string tmpFolder = tmp.path().toStdString();
+
+  printf("%-8s %-5s %10s", "size", "fmt", "bytes");
+  for (const char* step : STEPS) {
+    printf(" %12s", (std::string(step) + " ms").c_str());
+  }
+  printf("\n");
+
+  for (const auto& spec : CMdfCorpus::getSpecs()) {
+
+    if (!sizes.empty() && (sizes.end() == std::find(sizes.begin(), sizes.end(), spec.m_name))) {
+      continue;
+    }
+
+    std::string paths[2];
+    if (VSCP_ERROR_SUCCESS != CMdfCorpus::write(spec, tmpFolder, paths[0], paths[1])) {
+      fprintf(stderr, "%s: Failed to write corpus\n", spec.m_name);
+      rv = 1;
+      continue;
+    }
+
+    for (const auto& path : paths) {
+      json result;
+      result["corpus"] = spec.m_name;
+      result["format"] = QFileInfo(QString::fromStdString(path)).suffix().toStdString();
+
+      if (VSCP_ERROR_SUCCESS != benchFile(path, tmpFolder, iterations, result)) {
+        rv = 1;
+        continue;
+      }
+
+      printf("%-8s %-5s %10lld",
+             spec.m_name,
+             result["format"].get<std::string>().c_str(),
+             (long long)result["bytes"].get<int64_t>());
+      for (const char* step : STEPS) {
+        printf(" %12.3f", result["steps"][step]["median_ms"].get<double>());
+      }
+      printf("\n");
+
+      // Change compared with the baseline, negative is faster
+      const json* pbase = nullptr;
+      if (!baseline.is_null()) {
+        pbase = findResult(baseline["results"],
+                           result["corpus"].get<std::string>(),
+                           result["format"].get<std::string>());
+      }
+      if (nullptr != pbase) {
+        printf("%-8s %-5s %10s", "", "", "change");
+        for (const char* step : STEPS) {
+          double before = 0;
+          if (pbase->contains("steps") && (*pbase)["steps"].contains(step)) {
+            before = (*pbase)["steps"][step].value("median_ms", 0.0);
+          }
+          double now = result["steps"][step]["median_ms"].get<double>();
+          if (before > 0) {
+            printf(" %+11.1f%%", 100.0 * (now - before) / before);
+          }
+          else {
+            printf(" %12s", "-");
+          }
+        }
+        printf("\n");
+      }
+
+      results.push_back(result);
+    }
+  }
+
+  if (!outPath.empty()) {
+    json out;
+    out["benchmark"]  = "mdfrender";
+    out["iterations"] = iterations;
+    out["platform"]   = QGuiApplication::platformName().toStdString();
+    out["qt"]         = qVersion();
+    out["system"]     = QSysInfo::prettyProductName().toStdString();
+    out["cpu"]        = QSysInfo::currentCpuArchitecture().toStdString();
+    out["results"]    = results;
+
+    QFile file(QString::fromStdString(outPath));
+    std::string str = out.dump(2);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        ((qint64)str.size() != file.write(str.data(), str.size()))) {
+      fprintf(stderr, "%s: Failed to write results\n", outPath.c_str());
+      rv = 1;
+    }
+  }
+
+  return rv;
+}
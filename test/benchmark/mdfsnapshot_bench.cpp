@@ -0,0 +1,190 @@
+// mdfsnapshot_bench.cpp
+//
+// This file is part of the VSCP (https://www.vscp.org)
+//
+// The MIT License (MIT)
+//
+// Copyright (C) 2000-2026 Ake Hedman, Grodans Paradis AB
+// <info@grodansparadis.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Compares parsing MDF files with loading their binary snapshot.
+//
+// Usage: mdfsnapshot-bench [-n iterations] file...
+//
+// Each file is parsed, a snapshot is written to a temporary folder and
+// then parse and snapshot load are timed. The snapshot of the loaded MDF
+// is compared with the snapshot of the parsed MDF to check that nothing
+// is lost on the way.
+//
+
+#include <vscp.h>
+#include <vscphelper.h>
+
+#include <mdf.h>
+
+#include "mdfsnapshot.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <spdlog/spdlog.h>
+
+// Default number of timed loads per file
+#define BENCH_ITERATIONS 20
+
+///////////////////////////////////////////////////////////////////////////////
+// readFile
+//
+
+static QByteArray
+readFile(const std::string& path)
+{
+  QFile file(QString::fromStdString(path));
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QByteArray();
+  }
+  return file.readAll();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// timeIt
+//
+// Run a load the given number of times and return mean time in milliseconds
+// or a negative value if a load fails.
+//
+
+template<typename F>
+static double
+timeIt(int iterations, F load)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    if (!load()) {
+      return -1;
+    }
+  }
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// main
+//
+
+int
+main(int argc, char* argv[])
+{
+  int iterations = BENCH_ITERATIONS;
+  std::vector<std::string> files;
+
+  spdlog::set_level(spdlog::level::off);
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && ((i + 1) < argc)) {
+      iterations = atoi(argv[++i]);
+    }
+    else {
+      files.push_back(argv[i]);
+    }
+  }
+
+  if (files.empty() || (iterations < 1)) {
+    fprintf(stderr, "usage: mdfsnapshot-bench [-n iterations] file...\n");
+    return 2;
+  }
+
+  QTemporaryDir tmp;
+  if (!tmp.isValid()) {
+    fprintf(stderr, "Failed to create temporary folder\n");
+    return 1;
+  }
+
+  int rv = 0;
+
+  printf("%-24s %-6s %10s %10s %12s %12s %8s\n", "file", "format", "source", "snapshot", "parse ms", "snapshot ms", "speedup");
+
+  for (const auto& path : files) {
+    QFileInfo info(QString::fromStdString(path));
+    std::string name   = info.fileName().toStdString();
+    std::string format = info.suffix().toLower().toStdString();
+
+    QByteArray content = readFile(path);
+    if (content.isEmpty()) {
+      fprintf(stderr, "%s: Failed to read file\n", path.c_str());
+      rv = 1;
+      continue;
+    }
+
+    std::string hash     = QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex().toStdString();
+    std::string snapPath = tmp.filePath(QString::fromStdString(hash + CMdfSnapshot::EXTENSION)).toStdString();
+    std::string snapCopy = tmp.filePath(QString::fromStdString(hash + ".copy")).toStdString();
+
+    CMDF mdf;
+    if ((VSCP_ERROR_SUCCESS != mdf.parseMDF(path)) || (VSCP_ERROR_SUCCESS != CMdfSnapshot::save(mdf, snapPath, hash))) {
+      fprintf(stderr, "%s: Failed to parse or to write snapshot\n", path.c_str());
+      rv = 1;
+      continue;
+    }
+
+    // A snapshot of the loaded MDF must be identical to the original
+    CMDF loaded;
+    if ((VSCP_ERROR_SUCCESS != CMdfSnapshot::load(snapPath, hash, loaded)) ||
+        (VSCP_ERROR_SUCCESS != CMdfSnapshot::save(loaded, snapCopy, hash)) ||
+        (readFile(snapPath) != readFile(snapCopy))) {
+      fprintf(stderr, "%s: Snapshot does not survive a round trip\n", path.c_str());
+      rv = 1;
+      continue;
+    }
+
+    double parseTime = timeIt(iterations, [&path]() {
+      CMDF m;
+      return (VSCP_ERROR_SUCCESS == m.parseMDF(path));
+    });
+
+    double snapTime = timeIt(iterations, [&snapPath, &hash]() {
+      CMDF m;
+      return (VSCP_ERROR_SUCCESS == CMdfSnapshot::load(snapPath, hash, m));
+    });
+
+    printf("%-24s %-6s %10lld %10lld %12.3f %12.3f %7.1fx\n",
+           name.c_str(),
+           format.c_str(),
+           (long long)content.size(),
+           (long long)QFileInfo(QString::fromStdString(snapPath)).size(),
+           parseTime,
+           snapTime,
+           (snapTime > 0) ? (parseTime / snapTime) : 0.0);
+  }
+
+  return rv;
+}